@@ -0,0 +1,126 @@
+#pragma once
+
+#include "cpu/image.h"
+#include "geometry.h"
+
+#include <cstdint>
+#include <initializer_list>
+#include <string>
+#include <vector>
+
+// common options of all benchmarks, set from the command line
+struct BenchmarkOptions
+{
+    uint32_t width = 1024;
+    uint32_t height = 768;
+    uint32_t frames = 60;
+    // 0 = one thread per hardware thread
+    uint32_t threads = 0;
+    // width and height of the image streamed from disk by the streaming benchmark
+    uint32_t streamSize = 65536;
+};
+
+/**
+ * Renders a synthetic test scene at the given time (in seconds).
+ *
+ * The scene consists of a dark gradient background and a number of bright discs orbiting the image center
+ * (one rotation in approx. 10 seconds, like the model in the interactive application), so that only parts of
+ * the image pass the bloom threshold and consecutive frames are similar.
+ */
+void RenderSyntheticScene(uint32_t width, uint32_t height, float time, ImageRGBA32F& scene);
+
+/**
+ * Grid of UV spheres in a cube around the origin (about the size of data/mesh.obj), several layers deep so that most
+ * of the spheres are hidden behind the front layer. The layers are ordered from front to back as seen from the camera
+ * of the application (like a renderer that sorts its draw calls), or from back to front (worst case for overdraw).
+ */
+void CreateSphereGrid(uint32_t spheresPerAxis, uint32_t rings, bool frontToBack, std::vector<VertexPosNormal>& mesh);
+
+// prints a line of a result table: name followed by the values (formatted with four decimals)
+void PrintBenchmarkRow(const std::string& name, std::initializer_list<double> values);
+
+// baseline PNG encoder for comparison: adaptive row filters and a single deflate block with fixed Huffman codes and
+// greedy LZ77 matching (like stb_image_write, without zlib)
+void EncodePng(const ImageRGBA8& image, std::vector<uint8_t>& output);
+
+///////////////////////
+// benchmarks, each returns the exit code of the program
+
+// temporally amortized bloom vs. full recompute (time per frame and error)
+int RunTemporalBloomBenchmark(const BenchmarkOptions& options);
+
+// dirty-tile incremental bloom vs. full recompute on partially static scenes
+int RunIncrementalBloomBenchmark(const BenchmarkOptions& options);
+
+// sparse bloom (blur restricted to tiles near pixels above the threshold) vs. dense passes for several thresholds
+int RunSparseBloomBenchmark(const BenchmarkOptions& options);
+
+// FFT vs. direct 2D convolution of the thresholded image with star kernels of increasing size
+int RunFftConvolutionBenchmark(const BenchmarkOptions& options);
+
+// low-rank separable approximation of non-separable kernels: accuracy and cost vs. rank and direct 2D convolution
+int RunSeparableKernelBenchmark(const BenchmarkOptions& options);
+
+// summed-area table build throughput and precision, and variable radius box blur throughput
+int RunSummedAreaTableBenchmark(const BenchmarkOptions& options);
+
+// fixed-point RGBA8 bloom vs. float passes (time per pass, error against the analytical bound, fails if exceeded)
+int RunFixedPointBloomBenchmark(const BenchmarkOptions& options);
+
+// out-of-core streaming bloom: check against ApplyBloom() and throughput on a large synthetic image streamed from disk
+int RunStreamingBloomBenchmark(const BenchmarkOptions& options);
+
+// frames/s and stage utilization of the decode / bloom / encode pipeline for an increasing number of bloom threads
+int RunBatchBloomBenchmark(const BenchmarkOptions& options);
+
+// sustained frames/s of the double-buffered raw RGBA / Y4M stream processing at 1080p and 4K
+int RunFrameStreamBenchmark(const BenchmarkOptions& options);
+
+// render thread frame time with synchronous readback vs. the non-stalling capture ring of increasing depth
+int RunCaptureBenchmark(const BenchmarkOptions& options);
+
+// QOI encode / decode throughput and compression ratio on rendered bloom frames vs. a baseline PNG encoder
+int RunQoiBenchmark(const BenchmarkOptions& options);
+
+// publish cost, throughput and latency of the shared memory frame ring with a consumer process (POSIX only)
+int RunSharedMemoryBenchmark(const BenchmarkOptions& options);
+
+// frame time of the tiled software rasterizer on data/mesh.obj for an increasing number of threads
+int RunRasterizerBenchmark(const BenchmarkOptions& options);
+
+// SoA Blinn-Phong shading kernel vs. the scalar reference (time per frame and max. error for several shininess values)
+int RunPhongBenchmark(const BenchmarkOptions& options);
+
+// Hi-Z rejection of triangles and 8x8 pixel blocks in the software rasterizer: rejection rate and raster time saved
+int RunHierarchicalDepthBenchmark(const BenchmarkOptions& options);
+
+// visibility buffer vs. forward shading in the software rasterizer: frame time and shading invocations per covered pixel
+int RunVisibilityBufferBenchmark(const BenchmarkOptions& options);
+
+// adaptive shading rate in the visibility buffer mode: shading work saved and image error against full rate shading
+int RunShadingRateBenchmark(const BenchmarkOptions& options);
+
+// AVX2 prefilter of back faces, degenerate, off-screen and sub-pixel triangles: setup throughput with and without it
+int RunPrefilterBenchmark(const BenchmarkOptions& options);
+
+// masked software occlusion culling of the instances of cluttered scenes: cull rate and cost per frame
+int RunOcclusionCullingBenchmark(const BenchmarkOptions& options);
+
+// the frame of the application recorded through the render backend abstraction and executed by the CPU device: per-pass times
+int RunRenderBackendBenchmark(const BenchmarkOptions& options);
+
+// frame graph of the application and of a bloom pyramid on the dry run device: transient memory without and with aliasing
+int RunFrameGraphBenchmark(const BenchmarkOptions& options);
+
+// render target pool of the frame graph across frames and resizes on the dry run device: hits, misses, evictions and memory held
+int RunTexturePoolBenchmark(const BenchmarkOptions& options);
+
+// calls per frame of the application frame with and without the redundant state filter, fails if the image changes
+int RunStateCacheBenchmark(const BenchmarkOptions& options);
+
+// dynamic resolution controller on synthetic GPU frame time traces, fails if a trace does not reach its expected scale,
+// the scale leaves [min. scale, max. scale], the cooldown is not respected or the scale oscillates at the budget
+int RunDynamicResolutionBenchmark(const BenchmarkOptions& options);
+
+//
+///////////////////////
@@ -0,0 +1,48 @@
+#pragma once
+
+// constant buffer layouts of the post-processing shaders, shared by the D3D11 and the CPU implementation
+
+struct ThresholdParams
+{
+    alignas(16) float threshold;
+    int outputSize[2];  // size of the half-res output region in pixels
+    int tileCountX;     // number of tiles per row of the tile mask
+};
+
+struct CompositeParams
+{
+    // scale from the output texture coordinates to the rendered region of the scene and bloom textures
+    alignas(16) float uvScale[2];
+    // max. texture coordinate for sampling the bloom texture (center of the last rendered texel)
+    float bloomUVMax[2];
+    float coefficient;
+};
+
+// (GAUSSIAN_RADIUS + 1) must be multiple of 4 because of the way we set up the shader
+#define GAUSSIAN_RADIUS 7
+
+struct BlurParams
+{
+    alignas(16) float coefficients[GAUSSIAN_RADIUS + 1];
+    int radius;     // must be <= MAX_GAUSSIAN_RADIUS
+    int direction;  // 0 = horizontal, 1 = vertical
+    int size[2];    // size of the half-res region to blur in pixels
+};
+
+// size of the square tiles (= compute shader thread groups) of the sparse bloom passes
+#define BLOOM_TILE_SIZE 8
+
+struct TileClassifyParams
+{
+    alignas(16) int tileCount[2];
+    int tileRadius;     // blur radius in tiles
+};
+
+/**
+ * Computes the coefficients of a discrete Gaussian kernel with the given sigma.
+ *
+ * Notes:
+ * - the coefficients are normalized so that the full kernel of size (2 * radius + 1) sums up to 1
+ * - radius is clamped to GAUSSIAN_RADIUS, direction and size are not modified
+ */
+void ComputeGaussianBlurParams(float sigma, int radius, BlurParams& params);
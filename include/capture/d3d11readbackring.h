@@ -0,0 +1,44 @@
+#pragma once
+
+#include <d3d11.h>
+
+#include "capture/framecapture.h"
+
+/**
+ * ReadbackRing with staging textures: Copy() records a CopySubresourceRegion() from the source texture, Map() maps
+ * the staging texture for reading.
+ *
+ * Notes:
+ * - the multithread protection of the device context is enabled, since Map() is called from the readback thread of FrameCapture
+ * - the source texture must have the format of the staging textures (the region is clamped to width x height)
+ */
+class D3D11ReadbackRing : public ReadbackRing
+{
+public:
+    D3D11ReadbackRing(ID3D11Device* device, ID3D11DeviceContext* deviceContext, DXGI_FORMAT format, uint32_t width, uint32_t height, uint32_t slotCount);
+    ~D3D11ReadbackRing() override;
+
+    // no copy or move operations allowed
+    D3D11ReadbackRing(const D3D11ReadbackRing& other) = delete;
+    D3D11ReadbackRing(D3D11ReadbackRing&& other) = delete;
+    D3D11ReadbackRing& operator=(const D3D11ReadbackRing& other) = delete;
+    D3D11ReadbackRing& operator=(D3D11ReadbackRing&& other) = delete;
+
+    // texture copied by the following Copy() calls (not referenced)
+    void SetSource(ID3D11Texture2D* source) noexcept { m_source = source; }
+
+    uint32_t GetSlotCount() const noexcept override { return static_cast<uint32_t>(m_stagingTextures.size()); }
+    uint32_t GetWidth() const noexcept override { return m_width; }
+    uint32_t GetHeight() const noexcept override { return m_height; }
+
+    void Copy(uint32_t slot) override;
+    const uint8_t* Map(uint32_t slot, size_t& rowPitch) override;
+    void Unmap(uint32_t slot) override;
+
+private:
+    ID3D11DeviceContext* m_deviceContext;
+    ID3D11Texture2D* m_source;
+    std::vector<ID3D11Texture2D*> m_stagingTextures;
+    uint32_t m_width;
+    uint32_t m_height;
+};
@@ -0,0 +1,171 @@
+#pragma once
+
+#include "cpu/image.h"
+#include "util/boundedqueue.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * Ring of readback buffers (e.g., staging textures) for copying frames from the render target to the CPU.
+ *
+ * Copy() is called on the render thread and must not wait for the copy to finish. Map() and Unmap() are called on
+ * the readback thread of FrameCapture, Map() may wait until the copy of the slot is done.
+ */
+class ReadbackRing
+{
+public:
+    virtual ~ReadbackRing() = default;
+
+    virtual uint32_t GetSlotCount() const noexcept = 0;
+    virtual uint32_t GetWidth() const noexcept = 0;
+    virtual uint32_t GetHeight() const noexcept = 0;
+
+    // starts copying the current frame into the given slot
+    virtual void Copy(uint32_t slot) = 0;
+
+    // waits for the copy into slot, returns the pixels and the distance between two rows in bytes (nullptr on error)
+    virtual const uint8_t* Map(uint32_t slot, size_t& rowPitch) = 0;
+    virtual void Unmap(uint32_t slot) = 0;
+};
+
+/**
+ * ReadbackRing on the CPU: Copy() copies the given image, Map() can simulate the latency of a GPU copy.
+ *
+ * Used to test and benchmark FrameCapture without a GPU.
+ */
+class CpuReadbackRing : public ReadbackRing
+{
+public:
+    CpuReadbackRing(const ImageRGBA8& source, uint32_t slotCount, float copyLatencyMilliseconds = 0.f);
+
+    uint32_t GetSlotCount() const noexcept override { return static_cast<uint32_t>(m_slots.size()); }
+    uint32_t GetWidth() const noexcept override { return m_source.width; }
+    uint32_t GetHeight() const noexcept override { return m_source.height; }
+
+    void Copy(uint32_t slot) override;
+    const uint8_t* Map(uint32_t slot, size_t& rowPitch) override;
+    void Unmap(uint32_t slot) override;
+
+private:
+    struct Slot
+    {
+        ImageRGBA8 image;
+        std::chrono::steady_clock::time_point readyTime;
+    };
+
+    const ImageRGBA8& m_source;
+    std::vector<Slot> m_slots;
+    std::chrono::duration<float, std::milli> m_copyLatency;
+};
+
+/**
+ * Non-stalling frame capture.
+ *
+ * Each captured frame is copied into the next slot of the readback ring. The slot is only handed to the readback
+ * thread after (slot count - 1) more frames have been captured, so that the copy has finished by the time it is
+ * mapped and the render thread never waits for the GPU. The readback thread copies the mapped pixels into an image,
+ * and a pool of encoder threads passes the images to the frame handler (e.g., encoding and writing them).
+ *
+ * Notes:
+ * - if the slot of a new frame is still in use (readback or encoders too slow), the frame is dropped instead of waiting
+ * - the images passed to the handler are recycled, the handler must not keep references to them
+ * - the frame handler is called from several encoder threads at the same time
+ */
+class FrameCapture
+{
+public:
+    // called by the encoder threads with the index of the captured frame (counted from 0)
+    using FrameHandler = std::function<void(uint64_t frameIndex, const ImageRGBA8& image)>;
+
+    struct Settings
+    {
+        uint32_t encoderThreads = 2;
+        // max. number of images waiting for or being processed by the encoders
+        uint32_t maxQueuedImages = 4;
+    };
+
+    struct Stats
+    {
+        uint64_t framesCaptured;
+        uint64_t framesDropped;
+        uint64_t framesEncoded;
+        // time spent in Capture() on the render thread
+        double captureMilliseconds;
+        double readbackMilliseconds;
+        double encodeMilliseconds;
+    };
+
+    FrameCapture(ReadbackRing& ring, FrameHandler handler);
+    FrameCapture(ReadbackRing& ring, FrameHandler handler, const Settings& settings);
+    // waits until all captured frames have been encoded
+    ~FrameCapture();
+
+    // no copy or move operations allowed
+    FrameCapture(const FrameCapture& other) = delete;
+    FrameCapture(FrameCapture&& other) = delete;
+    FrameCapture& operator=(const FrameCapture& other) = delete;
+    FrameCapture& operator=(FrameCapture&& other) = delete;
+
+    // called on the render thread once per frame after the frame has been rendered, returns false if the frame was dropped
+    bool Capture();
+
+    // hands all pending slots to the readback thread and waits until all frames have been encoded
+    void Flush();
+
+    Stats GetStats() const;
+
+private:
+    enum class SlotState
+    {
+        Free,
+        // the copy has been issued, the slot waits for (slot count - 1) more frames
+        Copied,
+        // handed to the readback thread
+        Reading
+    };
+
+    struct Slot
+    {
+        SlotState state = SlotState::Free;
+        uint64_t frameIndex = 0;
+    };
+
+    struct EncodeJob
+    {
+        uint64_t frameIndex = 0;
+        ImageRGBA8 image;
+    };
+
+    // hands the slots that have been copied at least (slot count - 1) frames ago to the readback thread (m_mutex locked)
+    void SubmitCopiedSlots(uint64_t maxFrameIndex);
+
+    void ReadbackLoop();
+    void EncodeLoop();
+
+    ReadbackRing& m_ring;
+    FrameHandler m_handler;
+
+    // guards the slot states and the statistics, which are changed by all threads
+    mutable std::mutex m_mutex;
+    std::condition_variable m_allEncoded;
+    std::vector<Slot> m_slots;
+    uint64_t m_nextFrameIndex;
+    // frames that have been copied but not encoded or dropped yet
+    uint64_t m_framesInFlight;
+    Stats m_stats;
+
+    BoundedQueue<uint32_t> m_readbackSlots;
+    BoundedQueue<EncodeJob> m_encodeJobs;
+    // recycled images for the encode jobs
+    BoundedQueue<ImageRGBA8> m_freeImages;
+
+    std::thread m_readbackThread;
+    std::vector<std::thread> m_encoderThreads;
+};
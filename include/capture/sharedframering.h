@@ -0,0 +1,164 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/**
+ * Ring of RGBA8 frames in a POSIX shared memory object, written by one process and read by any number of others.
+ *
+ * Layout (all offsets in bytes, the object is created with shm_open() under the given name, e.g. "/bloom_frames"):
+ * - SharedFrameRingHeader at offset 0
+ * - slot i at SHARED_FRAME_RING_HEADER_SIZE + i * slotStride: SharedFrameSlotHeader followed (at offset
+ *   SHARED_FRAME_SLOT_HEADER_SIZE) by height rows of width * 4 bytes
+ *
+ * The header and the slot headers are lock-free: frame n is written into slot n % slotCount. The writer stores
+ * (n << 1) in the state of the slot before touching the pixels and (n << 1) | 1 (ready) afterwards, then sets
+ * publishedFrames to n + 1. A reader maps the object read-only and reads the pixels in place. It checks that the
+ * state still holds the same value afterwards, otherwise the frame has been overwritten while it was read.
+ *
+ * Notes:
+ * - the writer never waits for readers, a reader that falls more than slotCount frames behind skips frames
+ * - timestamps are taken from std::chrono::steady_clock (CLOCK_MONOTONIC on Linux), so readers can measure latency
+ * - only available on POSIX systems, Create() and Open() fail on Windows
+ */
+constexpr uint32_t SHARED_FRAME_RING_MAGIC = 0x524d4c42;  // "BLMR"
+constexpr uint32_t SHARED_FRAME_RING_VERSION = 1;
+constexpr size_t SHARED_FRAME_RING_HEADER_SIZE = 4096;
+constexpr size_t SHARED_FRAME_SLOT_HEADER_SIZE = 64;
+
+struct SharedFrameRingHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t width;
+    uint32_t height;
+    uint32_t slotCount;
+    uint32_t rowPitch;
+    uint64_t slotStride;
+    // written by the writer only, on its own cache line
+    alignas(64) std::atomic<uint64_t> publishedFrames;
+    std::atomic<uint32_t> closed;
+};
+
+struct SharedFrameSlotHeader
+{
+    // (frame number << 1) | ready
+    std::atomic<uint64_t> state;
+    // time of publishing in nanoseconds of std::chrono::steady_clock
+    uint64_t timestampNanoseconds;
+};
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "the shared frame ring needs lock-free 64-bit atomics");
+static_assert(sizeof(SharedFrameRingHeader) <= SHARED_FRAME_RING_HEADER_SIZE, "header does not fit");
+static_assert(sizeof(SharedFrameSlotHeader) <= SHARED_FRAME_SLOT_HEADER_SIZE, "slot header does not fit");
+
+// current time of std::chrono::steady_clock in nanoseconds (as stored in the slot headers)
+uint64_t GetSharedFrameTimestamp() noexcept;
+
+// writing side of the ring (one writer per ring)
+class SharedFrameRingWriter
+{
+public:
+    SharedFrameRingWriter() = default;
+    // closes the ring
+    ~SharedFrameRingWriter();
+
+    // no copy or move operations allowed
+    SharedFrameRingWriter(const SharedFrameRingWriter& other) = delete;
+    SharedFrameRingWriter(SharedFrameRingWriter&& other) = delete;
+    SharedFrameRingWriter& operator=(const SharedFrameRingWriter& other) = delete;
+    SharedFrameRingWriter& operator=(SharedFrameRingWriter&& other) = delete;
+
+    // creates the shared memory object, an existing object with the same name is replaced (its readers see it closed)
+    bool Create(const std::string& name, uint32_t width, uint32_t height, uint32_t slotCount);
+
+    // returns the pixels of the slot for the next frame (width * 4 bytes per row), readers do not see it until Publish()
+    uint8_t* BeginFrame() noexcept;
+    void Publish() noexcept;
+
+    // copies tightly packed RGBA8 pixels into the next slot and publishes it
+    void Publish(const uint8_t* pixels) noexcept;
+
+    // marks the ring as closed for the readers and removes the name, readers keep their mapping
+    void Close() noexcept;
+
+    bool IsOpen() const noexcept { return m_header != nullptr; }
+    uint64_t GetPublishedFrames() const noexcept { return m_nextFrame; }
+
+private:
+    SharedFrameSlotHeader* GetSlot(uint64_t frame) const noexcept;
+
+    std::string m_name;
+    SharedFrameRingHeader* m_header = nullptr;
+    size_t m_size = 0;
+    uint64_t m_nextFrame = 0;
+};
+
+// reading side of the ring (reference consumer, see bloom_shm_consumer)
+class SharedFrameRingReader
+{
+public:
+    enum class Status
+    {
+        Frame,
+        Timeout,
+        // the writer has closed the ring and all published frames have been read
+        Closed
+    };
+
+    struct Frame
+    {
+        const uint8_t* pixels;
+        uint64_t frameNumber;
+        uint64_t timestampNanoseconds;
+    };
+
+    struct Stats
+    {
+        uint64_t framesRead;
+        // frames that were overwritten before they could be read
+        uint64_t framesSkipped;
+        // frames that were overwritten while they were read (Release() returned false)
+        uint64_t framesTorn;
+    };
+
+    SharedFrameRingReader() = default;
+    ~SharedFrameRingReader();
+
+    // no copy or move operations allowed
+    SharedFrameRingReader(const SharedFrameRingReader& other) = delete;
+    SharedFrameRingReader(SharedFrameRingReader&& other) = delete;
+    SharedFrameRingReader& operator=(const SharedFrameRingReader& other) = delete;
+    SharedFrameRingReader& operator=(SharedFrameRingReader&& other) = delete;
+
+    // maps an existing ring, reading starts with the latest published frame
+    bool Open(const std::string& name);
+
+    /**
+     * Waits for the next frame (in order, unless frames have been overwritten already).
+     *
+     * Notes:
+     * - polls the header: yields the thread for the first millisecond, then sleeps for 100 microseconds between polls
+     * - the pixels point into the shared memory and are only valid if Release() returns true
+     */
+    Status WaitForFrame(Frame& frame, float timeoutMilliseconds);
+
+    // true if the frame has not been overwritten while it was read
+    bool Release(const Frame& frame);
+
+    uint32_t GetWidth() const noexcept { return m_header ? m_header->width : 0; }
+    uint32_t GetHeight() const noexcept { return m_header ? m_header->height : 0; }
+    uint32_t GetSlotCount() const noexcept { return m_header ? m_header->slotCount : 0; }
+    const Stats& GetStats() const noexcept { return m_stats; }
+
+private:
+    void Unmap() noexcept;
+    const SharedFrameSlotHeader* GetSlot(uint64_t frame) const noexcept;
+
+    const SharedFrameRingHeader* m_header = nullptr;
+    size_t m_size = 0;
+    uint64_t m_nextFrame = 0;
+    Stats m_stats = { };
+};
@@ -0,0 +1,72 @@
+#pragma once
+
+#include "cpu/bloom.h"
+#include "cpu/image.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+/**
+ * Applies the bloom post-process to a sequence of 8-bit frames (e.g., the images of a directory).
+ *
+ * The frames flow through three stages: decode, bloom (ApplyBloom() on the float image) and encode. Each stage
+ * has its own worker threads, and the stages are connected by bounded queues, so that I/O of some frames overlaps
+ * with the bloom of others while the number of frames in flight stays limited. Each bloom worker processes whole
+ * frames with its own buffers, i.e., frames are distributed over the threads instead of the rows of a single frame.
+ *
+ * Notes:
+ * - frames are encoded in the order they finish, not necessarily in the order of their indices
+ * - a frame that cannot be decoded or encoded is counted as failed, the remaining frames are still processed (also if
+ *   a stage throws, e.g., std::bad_alloc, the exception is reported with the index of the frame)
+ */
+class BatchBloomPipeline
+{
+public:
+    struct Settings
+    {
+        // worker threads per stage, 0 = one per hardware thread
+        uint32_t decodeThreads = 1;
+        uint32_t bloomThreads = 0;
+        uint32_t encodeThreads = 1;
+        // max. number of frames waiting in each of the two queues
+        uint32_t queueCapacity = 4;
+    };
+
+    struct StageStats
+    {
+        uint32_t threads;
+        // time spent in the stage function summed over all threads (without waiting for the queues)
+        double busyMilliseconds;
+        // busy time / (threads * total time)
+        double utilization;
+    };
+
+    struct Stats
+    {
+        size_t framesProcessed;
+        size_t framesFailed;
+        double milliseconds;
+        double framesPerSecond;
+        StageStats decode;
+        StageStats bloom;
+        StageStats encode;
+    };
+
+    // called from the worker threads of the stage, return false on error
+    using DecodeFunction = std::function<bool(size_t frameIndex, ImageRGBA8& image)>;
+    using EncodeFunction = std::function<bool(size_t frameIndex, const ImageRGBA8& image)>;
+
+    BatchBloomPipeline() noexcept;
+    explicit BatchBloomPipeline(const Settings& settings) noexcept;
+
+    // processes the frames [0, frameCount), returns true if all frames have been processed successfully
+    bool Run(size_t frameCount, const BloomSettings& bloomSettings, const DecodeFunction& decode, const EncodeFunction& encode);
+
+    const Settings& GetSettings() const noexcept { return m_settings; }
+    const Stats& GetLastStats() const noexcept { return m_stats; }
+
+private:
+    Settings m_settings;
+    Stats m_stats;
+};
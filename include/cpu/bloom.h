@@ -0,0 +1,140 @@
+#pragma once
+
+#include "bloomparams.h"
+#include "cpu/image.h"
+
+#include <cmath>
+#include <cstdint>
+
+class ThreadPool;
+
+// parameters of the bloom post-process (the defaults are the values used by RenderFrame())
+struct BloomSettings
+{
+    float threshold;
+    float compositeCoefficient;
+    // the direction and size members are ignored by the CPU implementation
+    BlurParams blurParams;
+};
+
+BloomSettings CreateDefaultBloomSettings();
+
+// half-res intermediate images, equivalent to renderTargets[1] and renderTargets[2]
+struct BloomBuffers
+{
+    // thresholded image, and the final bloom after the vertical pass
+    ImageRGBA32F bloom;
+    // result of the horizontal pass
+    ImageRGBA32F temp;
+};
+
+///////////////////////
+// per-pixel kernels, these mirror the compute and pixel shaders exactly
+
+// texel fetch with the out-of-bounds behavior of D3D11 (zero outside of the image)
+inline ColorRGBA32F LoadOrZero(const ImageRGBA32F& image, int x, int y) noexcept
+{
+    if (x < 0 || y < 0 || x >= static_cast<int>(image.width) || y >= static_cast<int>(image.height))
+    {
+        return ColorRGBA32F{ 0.f, 0.f, 0.f, 0.f };
+    }
+    return image.At(static_cast<uint32_t>(x), static_cast<uint32_t>(y));
+}
+
+// thresholddownsample.hlsl for the half-res output pixel (x, y)
+inline ColorRGBA32F ThresholdAndDownsamplePixel(const ImageRGBA32F& input, float threshold, int x, int y) noexcept
+{
+    const ColorRGBA32F c00 = LoadOrZero(input, 2 * x, 2 * y);
+    const ColorRGBA32F c10 = LoadOrZero(input, 2 * x + 1, 2 * y);
+    const ColorRGBA32F c01 = LoadOrZero(input, 2 * x, 2 * y + 1);
+    const ColorRGBA32F c11 = LoadOrZero(input, 2 * x + 1, 2 * y + 1);
+
+    // bilinear interpolation for downsampling
+    const float r = 0.25f * (c00.r + c10.r + c01.r + c11.r);
+    const float g = 0.25f * (c00.g + c10.g + c01.g + c11.g);
+    const float b = 0.25f * (c00.b + c10.b + c01.b + c11.b);
+
+    // thresholding on downsampled value
+    const float intensityTest = (std::sqrt(r * r + g * g + b * b) > threshold) ? 1.f : 0.f;
+
+    return ColorRGBA32F{ intensityTest * r, intensityTest * g, intensityTest * b, 1.f };
+}
+
+// ThresholdAndDownsamplePixel() for the half-res pixel x computed from the two given scene rows (all four inputs have to be inside of the image)
+inline ColorRGBA32F ThresholdAndDownsamplePixel(const ColorRGBA32F* row0, const ColorRGBA32F* row1, float threshold, int x) noexcept
+{
+    const ColorRGBA32F& c00 = row0[2 * x];
+    const ColorRGBA32F& c10 = row0[2 * x + 1];
+    const ColorRGBA32F& c01 = row1[2 * x];
+    const ColorRGBA32F& c11 = row1[2 * x + 1];
+
+    const float r = 0.25f * (c00.r + c10.r + c01.r + c11.r);
+    const float g = 0.25f * (c00.g + c10.g + c01.g + c11.g);
+    const float b = 0.25f * (c00.b + c10.b + c01.b + c11.b);
+
+    const float intensityTest = (std::sqrt(r * r + g * g + b * b) > threshold) ? 1.f : 0.f;
+
+    return ColorRGBA32F{ intensityTest * r, intensityTest * g, intensityTest * b, 1.f };
+}
+
+// blur.hlsl for pixel (x, y) in the given direction (0 = horizontal, 1 = vertical)
+inline ColorRGBA32F BlurPixel(const ImageRGBA32F& input, const BlurParams& params, int direction, int x, int y) noexcept
+{
+    const int dx = 1 - direction;
+    const int dy = direction;
+
+    ColorRGBA32F accumulatedValue = { 0.f, 0.f, 0.f, 0.f };
+    for (int i = -params.radius; i <= params.radius; ++i)
+    {
+        const float coefficient = params.coefficients[i < 0 ? -i : i];
+        const ColorRGBA32F value = LoadOrZero(input, x + i * dx, y + i * dy);
+
+        accumulatedValue.r += coefficient * value.r;
+        accumulatedValue.g += coefficient * value.g;
+        accumulatedValue.b += coefficient * value.b;
+        accumulatedValue.a += coefficient * value.a;
+    }
+
+    return accumulatedValue;
+}
+
+// bilinear sample with clamp addressing at texel coordinates (u, v), texel centers are at (x + 0.5, y + 0.5)
+ColorRGBA32F SampleBilinearClamp(const ImageRGBA32F& image, float u, float v) noexcept;
+
+//
+///////////////////////
+
+// thresholddownsample.hlsl: output is resized to half the size of input
+void ThresholdAndDownsample(const ImageRGBA32F& input, float threshold, ImageRGBA32F& output, ThreadPool* pool = nullptr);
+
+// blur.hlsl: output is resized to the size of input
+void Blur(const ImageRGBA32F& input, const BlurParams& params, int direction, ImageRGBA32F& output, ThreadPool* pool = nullptr);
+
+/**
+ * quadcomposite.hlsl: output = scene + coefficient * bloom with bilinear upsampling of the bloom image.
+ *
+ * Notes:
+ * - output is resized to the size of scene
+ * - bloom is sampled with clamp addressing like the default sampler state
+ */
+void Composite(const ImageRGBA32F& scene, const ImageRGBA32F& bloom, float coefficient, ImageRGBA32F& output, ThreadPool* pool = nullptr);
+
+// the two bloom rows and the interpolation weight between them sampled by Composite() for output row y
+struct CompositeRowSource
+{
+    uint32_t row0;
+    uint32_t row1;
+    float weight;
+};
+
+CompositeRowSource ComputeCompositeRowSource(uint32_t sceneHeight, uint32_t bloomHeight, uint32_t y) noexcept;
+
+// Composite() for a single row, bloomRow0 / bloomRow1 and weight as given by ComputeCompositeRowSource()
+void CompositeRow(const ColorRGBA32F* sceneRow, uint32_t sceneWidth, const ColorRGBA32F* bloomRow0, const ColorRGBA32F* bloomRow1,
+    uint32_t bloomWidth, float weight, float coefficient, ColorRGBA32F* outputRow) noexcept;
+
+// threshold, downsample and blur the scene, the result is stored in buffers.bloom
+void ComputeBloom(const ImageRGBA32F& scene, const BloomSettings& settings, BloomBuffers& buffers, ThreadPool* pool = nullptr);
+
+// the complete post-process of RenderFrame(): ComputeBloom() followed by Composite()
+void ApplyBloom(const ImageRGBA32F& scene, const BloomSettings& settings, BloomBuffers& buffers, ImageRGBA32F& output, ThreadPool* pool = nullptr);
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class ThreadPool;
+
+// 2D array of complex numbers in split format (separate planes for the real and imaginary parts)
+struct ComplexPlane
+{
+    uint32_t rows = 0;
+    uint32_t columns = 0;
+    // floats per row, padded to a multiple of the SIMD width (the padding is kept at zero)
+    uint32_t stride = 0;
+    std::vector<float> re;
+    std::vector<float> im;
+
+    void Resize(uint32_t newRows, uint32_t newColumns);
+
+    float* Re(uint32_t row) noexcept { return re.data() + static_cast<size_t>(row) * stride; }
+    const float* Re(uint32_t row) const noexcept { return re.data() + static_cast<size_t>(row) * stride; }
+    float* Im(uint32_t row) noexcept { return im.data() + static_cast<size_t>(row) * stride; }
+    const float* Im(uint32_t row) const noexcept { return im.data() + static_cast<size_t>(row) * stride; }
+};
+
+/**
+ * Radix-2 FFT of a real 2D signal of width x height samples (both powers of two, height >= 4).
+ *
+ * The transform along y packs pairs of rows into one complex row (real-to-complex), so only height / 2 + 1
+ * rows of the spectrum are computed. All 1D transforms run along the rows of a plane, i.e., each butterfly
+ * combines two complete rows, which is vectorized over the columns and parallelized over column chunks.
+ *
+ * Notes:
+ * - the spectrum is stored transposed: width rows (frequencies in x) x (height / 2 + 1) columns (frequencies in y)
+ * - Inverse(Forward(x)) = x, i.e., the inverse includes the 1 / (width * height) normalization
+ */
+class RealFft2D
+{
+public:
+    RealFft2D(uint32_t width, uint32_t height);
+
+    uint32_t GetWidth() const noexcept { return m_width; }
+    uint32_t GetHeight() const noexcept { return m_height; }
+
+    // input has height rows of width tightly packed samples
+    void Forward(const std::vector<float>& input, ComplexPlane& spectrum, ThreadPool* pool = nullptr);
+
+    // the contents of spectrum are destroyed, output is resized to width * height samples
+    void Inverse(ComplexPlane& spectrum, std::vector<float>& output, ThreadPool* pool = nullptr);
+
+private:
+    uint32_t m_width;
+    uint32_t m_height;
+
+    // twiddle factors exp(-2 pi i k / n) for the complex transforms along y (n = height / 2) and x (n = width)
+    std::vector<float> m_twiddlesYRe;
+    std::vector<float> m_twiddlesYIm;
+    std::vector<float> m_twiddlesXRe;
+    std::vector<float> m_twiddlesXIm;
+    // exp(-2 pi i k / height) for the real-to-complex post-processing
+    std::vector<float> m_realTwiddlesRe;
+    std::vector<float> m_realTwiddlesIm;
+
+    // (height / 2 + 1) x width intermediate result, not transposed
+    ComplexPlane m_rows;
+};
+
+// smallest power of two >= value
+uint32_t NextPowerOfTwo(uint32_t value) noexcept;
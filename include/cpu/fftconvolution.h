@@ -0,0 +1,64 @@
+#pragma once
+
+#include "cpu/bloom.h"
+#include "cpu/fft.h"
+#include "cpu/image.h"
+#include "cpu/kernel.h"
+
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+class ThreadPool;
+
+/**
+ * 2D convolution with arbitrary kernels in the frequency domain.
+ *
+ * The cost is independent of the kernel size (apart from the padding), which makes it suitable for large
+ * non-separable bloom kernels like lens PSFs or starbursts where Convolve2D() is far too slow. The result
+ * is the same as Convolve2D() up to floating point error.
+ *
+ * Notes:
+ * - the image is zero-padded to power-of-two sizes that are large enough to avoid wrap-around
+ * - the spectra of the kernels are cached, keyed by the kernel weights and the FFT size
+ */
+class FftConvolver
+{
+public:
+    struct Stats
+    {
+        // size of the padded FFT
+        uint32_t fftWidth;
+        uint32_t fftHeight;
+        // false if the kernel spectrum had to be computed in this call
+        bool kernelCacheHit;
+    };
+
+    FftConvolver();
+    ~FftConvolver();
+
+    // same contract as Convolve2D(): zero outside of input, RGB only, output alpha is 1
+    void Convolve(const ImageRGBA32F& input, const Kernel2D& kernel, ImageRGBA32F& output, ThreadPool* pool = nullptr);
+
+    void ClearKernelCache() noexcept { m_kernelCache.clear(); }
+    size_t GetKernelCacheSize() const noexcept { return m_kernelCache.size(); }
+
+    const Stats& GetLastStats() const noexcept { return m_stats; }
+
+private:
+    // returns the spectrum of the kernel for the current FFT size, computed on a cache miss
+    const ComplexPlane& GetKernelSpectrum(const Kernel2D& kernel, ThreadPool* pool);
+
+    std::unique_ptr<RealFft2D> m_fft;
+    std::unordered_map<uint64_t, ComplexPlane> m_kernelCache;
+
+    // padded real input / output of one channel and its spectrum
+    std::vector<float> m_plane;
+    ComplexPlane m_spectrum;
+
+    Stats m_stats;
+};
+
+// threshold and downsample the scene, then convolve with kernel instead of the separable blur (result in buffers.bloom)
+void ComputeFftBloom(const ImageRGBA32F& scene, float threshold, const Kernel2D& kernel, FftConvolver& convolver, BloomBuffers& buffers, ThreadPool* pool = nullptr);
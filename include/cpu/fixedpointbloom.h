@@ -0,0 +1,93 @@
+#pragma once
+
+#include "bloomparams.h"
+#include "cpu/image.h"
+
+#include <cstdint>
+
+class ThreadPool;
+
+/**
+ * Blur parameters for RGBA8 images: the coefficients of BlurParams in Q15 fixed point.
+ *
+ * Notes:
+ * - the coefficients are rounded to the nearest representable value, the center is adjusted afterwards so that
+ *   the sum of the kernel matches the float kernel as closely as possible (i.e., brightness is preserved)
+ */
+struct FixedPointBlurParams
+{
+    int16_t coefficients[GAUSSIAN_RADIUS + 1];
+    int radius;
+};
+
+FixedPointBlurParams ComputeFixedPointBlurParams(const BlurParams& params) noexcept;
+
+/**
+ * Upper bound for the error of ComputeBloom() on RGBA8 compared to the float passes on the same input, in units of 1/255.
+ *
+ * The bound adds up the rounding of the downsampled values, and for each blur pass the quantization of the
+ * coefficients, the rounding of the fixed-point multiplications, the rounding of the result to 8 bits and the
+ * error of its input.
+ */
+double ComputeFixedPointBloomErrorBound(const BlurParams& params) noexcept;
+
+/**
+ * Upper bound for the error of Composite() on RGBA8 compared to the float Composite() on the same inputs (with the
+ * result saturated to [0, 1] like an UNORM render target), in units of 1/255.
+ *
+ * Notes:
+ * - the coefficient is stored in Q13 fixed point, i.e., it is clamped to [0, 4)
+ */
+double ComputeFixedPointCompositeErrorBound(float coefficient) noexcept;
+
+// true if the passes use SSSE3 on this CPU (checked once), otherwise the scalar versions are used
+bool IsFixedPointSimdSupported() noexcept;
+
+// half-res intermediate images of the RGBA8 bloom, like BloomBuffers
+struct BloomBuffersRGBA8
+{
+    ImageRGBA8 bloom;
+    ImageRGBA8 temp;
+};
+
+///////////////////////
+// fixed-point versions of the passes in cpu/bloom.h for RGBA8 images
+//
+// Pixels are expanded to 16 bits with 7 fractional bits and multiplied with the Q15 coefficients with
+// rounding (pmulhrsw, SSSE3), eight channels at a time. The result is rounded and saturated back to 8 bits.
+// CPUs without SSSE3 use the scalar versions of the passes, which give the same results bit for bit.
+
+// thresholddownsample.hlsl with an exact integer threshold test, output is resized to half the size of input
+void ThresholdAndDownsample(const ImageRGBA8& input, float threshold, ImageRGBA8& output, ThreadPool* pool = nullptr);
+
+// scalar version of the threshold and downsample for output pixel (x, y), bit-exact with the SIMD implementation
+ColorRGBA8 ThresholdAndDownsamplePixel(const ImageRGBA8& input, float threshold, int x, int y) noexcept;
+
+// scalar version of the fixed-point blur for pixel (x, y), bit-exact with the SIMD implementation
+ColorRGBA8 BlurPixel(const ImageRGBA8& input, const FixedPointBlurParams& params, int direction, int x, int y) noexcept;
+
+// blur.hlsl, output is resized to the size of input
+void Blur(const ImageRGBA8& input, const FixedPointBlurParams& params, int direction, ImageRGBA8& output, ThreadPool* pool = nullptr);
+
+/**
+ * quadcomposite.hlsl: output = scene + coefficient * bloom with bilinear upsampling of the bloom image.
+ *
+ * Notes:
+ * - output is resized to the size of scene, the result is saturated to 8 bits like writing to the back buffer
+ * - the bloom rows are interpolated with Q15 weights to 16 bits with 7 fractional bits, then the columns, and the
+ *   result is multiplied with the Q13 coefficient and added to the scene
+ */
+void Composite(const ImageRGBA8& scene, const ImageRGBA8& bloom, float coefficient, ImageRGBA8& output, ThreadPool* pool = nullptr);
+
+// scalar version of the composite for pixel (x, y), bit-exact with the SIMD implementation
+ColorRGBA8 CompositePixel(const ImageRGBA8& scene, const ImageRGBA8& bloom, float coefficient, uint32_t x, uint32_t y) noexcept;
+
+// threshold, downsample and blur the scene, the result is stored in buffers.bloom
+void ComputeBloom(const ImageRGBA8& scene, float threshold, const FixedPointBlurParams& params, BloomBuffersRGBA8& buffers, ThreadPool* pool = nullptr);
+
+// ComputeBloom() followed by Composite()
+void ApplyBloom(const ImageRGBA8& scene, float threshold, const FixedPointBlurParams& params, float coefficient, BloomBuffersRGBA8& buffers,
+    ImageRGBA8& output, ThreadPool* pool = nullptr);
+
+//
+///////////////////////
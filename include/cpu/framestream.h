@@ -0,0 +1,105 @@
+#pragma once
+
+#include "cpu/bloom.h"
+#include "cpu/image.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+class ThreadPool;
+
+enum class FrameStreamFormat
+{
+    // frames of width * height RGBA8 pixels without any header (ffmpeg -f rawvideo -pix_fmt rgba)
+    RawRGBA,
+    // YUV4MPEG2 with 8-bit 4:2:0 or 4:4:4 frames (ffmpeg -f yuv4mpegpipe)
+    Y4M
+};
+
+// max. width and height of the frames of a stream (the max. texture size of D3D11), larger headers are rejected
+constexpr uint32_t MAX_FRAME_STREAM_SIZE = 16384;
+
+// layout of the frames of a stream
+struct FrameStreamHeader
+{
+    FrameStreamFormat format = FrameStreamFormat::RawRGBA;
+    uint32_t width = 0;
+    uint32_t height = 0;
+    // Y4M only: 4:2:0 or 4:4:4 chroma, full instead of limited (video) range, and the header line to write to the output
+    bool chromaSubsampled = true;
+    bool fullRange = false;
+    std::string y4mHeader;
+
+    // size of a frame in bytes (without the FRAME line of Y4M)
+    size_t GetFrameSize() const noexcept;
+};
+
+// parses the YUV4MPEG2 header line from the stream, returns false if it is missing or the format is not supported
+// (including sizes that are 0, larger than MAX_FRAME_STREAM_SIZE, or odd with 4:2:0 chroma)
+bool ReadY4MHeader(std::istream& input, FrameStreamHeader& header);
+
+// reads the next frame (including the FRAME line of Y4M) into data (GetFrameSize() bytes), returns false at the end of the stream
+bool ReadFrame(std::istream& input, const FrameStreamHeader& header, uint8_t* data);
+
+// writes the header (Y4M only) or a frame (including the FRAME line of Y4M)
+bool WriteFrameStreamHeader(std::ostream& output, const FrameStreamHeader& header);
+bool WriteFrame(std::ostream& output, const FrameStreamHeader& header, const uint8_t* data);
+
+/**
+ * Conversion between the frame data and float RGBA images (image is resized).
+ *
+ * YUV is converted with the BT.601 matrix. Subsampled chroma is replicated when decoding and averaged over 2 x 2
+ * pixels when encoding. Alpha is 1 for Y4M frames.
+ */
+void DecodeFrame(const FrameStreamHeader& header, const uint8_t* data, ImageRGBA32F& image, ThreadPool* pool = nullptr);
+void EncodeFrame(const FrameStreamHeader& header, const ImageRGBA32F& image, uint8_t* data, ThreadPool* pool = nullptr);
+
+/**
+ * Applies the bloom to all frames of a stream (e.g., stdin to stdout in a video pipeline).
+ *
+ * Reading and writing run on their own threads with two frame buffers each, so that the I/O of the next and the
+ * previous frame overlaps with the bloom of the current one. All buffers are allocated up front: at steady state a
+ * frame is read once into a read buffer, decoded from there into the float scene, and encoded into a write buffer.
+ * The bloom itself runs on the given pool.
+ */
+class FrameStreamProcessor
+{
+public:
+    struct Stats
+    {
+        size_t frames;
+        double milliseconds;
+        double framesPerSecond;
+        // busy time of the reader thread, the compute thread (decode, bloom and encode) and the writer thread
+        double readMilliseconds;
+        double computeMilliseconds;
+        double writeMilliseconds;
+    };
+
+    // called on the writer thread with each processed frame (GetFrameSize() bytes), returns false if writing failed
+    using FrameWriteFunction = std::function<bool(const uint8_t* data)>;
+
+    // processes frames until the input ends, returns false if the header is invalid or writing failed
+    bool Process(std::istream& input, std::ostream& output, const FrameStreamHeader& header, const BloomSettings& settings, ThreadPool* pool = nullptr);
+
+    // same as above, but the frames are passed to writeFrame instead of a stream (e.g., a shared memory ring)
+    bool Process(std::istream& input, const FrameWriteFunction& writeFrame, const FrameStreamHeader& header, const BloomSettings& settings,
+        ThreadPool* pool = nullptr);
+
+    const Stats& GetLastStats() const noexcept { return m_stats; }
+
+private:
+    // two read and two write buffers
+    std::vector<uint8_t> m_readBuffers[2];
+    std::vector<uint8_t> m_writeBuffers[2];
+
+    ImageRGBA32F m_scene;
+    ImageRGBA32F m_output;
+    BloomBuffers m_buffers;
+
+    Stats m_stats = { };
+};
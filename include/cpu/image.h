@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// RGBA color with 32-bit float channels (equivalent to DXGI_FORMAT_R32G32B32A32_FLOAT)
+struct ColorRGBA32F
+{
+    float r, g, b, a;
+};
+
+// RGBA color with 8-bit unsigned normalized channels (equivalent to DXGI_FORMAT_R8G8B8A8_UNORM)
+struct ColorRGBA8
+{
+    uint8_t r, g, b, a;
+};
+
+// simple image with tightly packed rows
+template <typename PixelType>
+struct Image
+{
+    uint32_t width = 0;
+    uint32_t height = 0;
+    std::vector<PixelType> pixels;
+
+    void Resize(uint32_t newWidth, uint32_t newHeight)
+    {
+        width = newWidth;
+        height = newHeight;
+        pixels.resize(static_cast<size_t>(width) * height);
+    }
+
+    bool HasSize(uint32_t otherWidth, uint32_t otherHeight) const noexcept
+    {
+        return width == otherWidth && height == otherHeight;
+    }
+
+    PixelType* Row(uint32_t y) noexcept { return pixels.data() + static_cast<size_t>(y) * width; }
+    const PixelType* Row(uint32_t y) const noexcept { return pixels.data() + static_cast<size_t>(y) * width; }
+
+    PixelType& At(uint32_t x, uint32_t y) noexcept { return Row(y)[x]; }
+    const PixelType& At(uint32_t x, uint32_t y) const noexcept { return Row(y)[x]; }
+};
+
+using ImageRGBA32F = Image<ColorRGBA32F>;
+using ImageRGBA8 = Image<ColorRGBA8>;
+
+// conversion with rounding and saturation to [0, 1] (like writing to an UNORM render target), output is resized
+void ConvertImage(const ImageRGBA32F& input, ImageRGBA8& output);
+void ConvertImage(const ImageRGBA8& input, ImageRGBA32F& output);
+
+// difference between two images over the RGB channels
+struct ImageError
+{
+    double rmse;        // root mean square error
+    double maxError;    // max. absolute error of a single channel
+    double psnr;        // peak signal-to-noise ratio in dB for a peak value of 1 (infinity for identical images)
+};
+
+// computes the error of test against reference, both images must have the same size
+ImageError ComputeImageError(const ImageRGBA32F& reference, const ImageRGBA32F& test);
@@ -0,0 +1,22 @@
+#pragma once
+
+#include "cpu/image.h"
+
+#include <string>
+
+/**
+ * Reads and writes 8-bit images, the format is chosen by the file extension (case insensitive):
+ * - .ppm: binary PPM (P6) with max. value 255, alpha is set to 255 on reading and dropped on writing
+ * - .pam: PAM (P7) with tuple type RGB_ALPHA or RGB and max. value 255
+ * - .rgba: raw RGBA8 (see RawImageFileReader)
+ * - .qoi: lossless QOI (see QoiEncoder)
+ *
+ * Notes:
+ * - these formats need no external library and can be produced by ffmpeg (ImageMagick for all but .rgba)
+ * - functions return false if the file cannot be accessed or has an unsupported format
+ */
+bool ReadImageFile(const std::string& path, ImageRGBA8& image);
+bool WriteImageFile(const std::string& path, const ImageRGBA8& image);
+
+// true if the extension of path is supported by ReadImageFile() and WriteImageFile()
+bool IsSupportedImageFile(const std::string& path);
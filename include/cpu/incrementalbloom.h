@@ -0,0 +1,73 @@
+#pragma once
+
+#include "cpu/bloom.h"
+#include "cpu/image.h"
+
+#include <cstdint>
+#include <vector>
+
+class ThreadPool;
+
+/**
+ * Threshold and blur passes that are only recomputed where the scene changed.
+ *
+ * The half-res image is divided into square tiles. Each frame, the corresponding scene regions are hashed and
+ * compared to the previous frame. Changed tiles are thresholded again, the horizontal blur is recomputed for
+ * them and their neighbors within the blur radius in x, and the vertical blur for those tiles and their
+ * neighbors within the blur radius in y. The result is identical to a full recompute. If neither the scene
+ * nor the settings changed, the frame is skipped entirely.
+ */
+class IncrementalBloom
+{
+public:
+    struct Stats
+    {
+        uint32_t tilesTotal;
+        // tiles whose scene region changed
+        uint32_t tilesChanged;
+        // tiles recomputed by the three passes (changed tiles plus the blur apron)
+        uint32_t tilesThresholded;
+        uint32_t tilesBlurredHorizontal;
+        uint32_t tilesBlurredVertical;
+        // true if nothing changed and the previous bloom was returned as is
+        bool frameSkipped;
+    };
+
+    // tileSize is given in half-res pixels
+    explicit IncrementalBloom(uint32_t tileSize = 16);
+
+    // updates the bloom for the current frame and returns it (half the size of the scene)
+    const ImageRGBA32F& Process(const ImageRGBA32F& scene, const BloomSettings& settings, ThreadPool* pool = nullptr);
+
+    // discards all cached data so that the next frame is computed in full
+    void Reset() noexcept;
+
+    const Stats& GetLastFrameStats() const noexcept { return m_stats; }
+
+private:
+    // detects the changed tiles, returns their number
+    uint32_t DetectChangedTiles(const ImageRGBA32F& scene, ThreadPool* pool);
+
+    // returns the tiles in mask dilated by the given number of tiles in x and y
+    std::vector<uint8_t> DilateTiles(const std::vector<uint8_t>& mask, uint32_t dilationX, uint32_t dilationY) const;
+
+    // calls func(x, y) for all pixels of the tiles set in mask, returns the number of tiles
+    template <typename PixelFunc>
+    uint32_t ForEachTilePixel(const std::vector<uint8_t>& mask, ThreadPool* pool, const PixelFunc& func);
+
+    uint32_t m_tileSize;
+    uint32_t m_tilesX;
+    uint32_t m_tilesY;
+
+    // per tile: hash of the scene region in the last frame, and whether it changed in the current frame
+    std::vector<uint64_t> m_tileHashes;
+    std::vector<uint8_t> m_changedTiles;
+    uint64_t m_settingsHash;
+    bool m_hasHistory;
+
+    ImageRGBA32F m_thresholded;
+    ImageRGBA32F m_horizontal;
+    ImageRGBA32F m_bloom;
+
+    Stats m_stats;
+};
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "bloomparams.h"
+#include "cpu/image.h"
+
+#include <cstdint>
+
+class ThreadPool;
+
+// 2D filter kernel with odd width and height, the center weight is at (width / 2, height / 2)
+using Kernel2D = Image<float>;
+
+// outer product of the 1D Gaussian in params, i.e., the kernel applied by the two passes of blur.hlsl
+Kernel2D CreateGaussianKernel2D(const BlurParams& params);
+
+/**
+ * Starburst lens kernel: a small Gaussian core with rayCount thin rays fading out towards the radius.
+ *
+ * Notes:
+ * - the kernel is normalized to a sum of 1
+ * - rays start at angle 0 and are distributed evenly, so an even rayCount gives a point-symmetric star
+ */
+Kernel2D CreateStarKernel(uint32_t radius, uint32_t rayCount);
+
+// anamorphic streak: a wide line with a Gaussian falloff across it, rotated counter-clockwise by angle (in radians), normalized to a sum of 1
+Kernel2D CreateStreakKernel(uint32_t radiusX, uint32_t radiusY, float angle = 0.f);
+
+// scales the weights to a sum of 1 (does nothing if the sum is zero)
+void NormalizeKernel(Kernel2D& kernel);
+
+/**
+ * Direct 2D convolution: output(x, y) = sum over (i, j) of kernel(i, j) * input(x - i, y - j), with (i, j) relative to the kernel center.
+ *
+ * Notes:
+ * - input is zero outside of the image (same as the texel fetches of blur.hlsl)
+ * - only the RGB channels are convolved, the output alpha is 1
+ * - output is resized to the size of input
+ * - zero weights are skipped, so the cost is proportional to the number of non-zero weights
+ */
+void Convolve2D(const ImageRGBA32F& input, const Kernel2D& kernel, ImageRGBA32F& output, ThreadPool* pool = nullptr);
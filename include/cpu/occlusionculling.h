@@ -0,0 +1,124 @@
+#pragma once
+
+#include "cpu/phong.h"
+#include "geometry.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class ThreadPool;
+
+// axis-aligned bounding box of an instance in model space
+struct BoundingBox
+{
+    float min[3];
+    float max[3];
+};
+
+/**
+ * Masked software occlusion culling: occluder triangles are rasterized into a low resolution masked depth buffer, and
+ * the bounding boxes of instances are tested against it before they are drawn.
+ *
+ * The buffer is made of tiles of 32x8 pixels, each with a coverage mask of one bit per pixel and two depth values
+ * instead of a depth per pixel (like "Masked Software Occlusion Culling", Andersson et al. 2016): z0 is the max.
+ * depth of the whole tile, z1 the max. depth of the pixels in the mask. A triangle is rasterized with AVX2 one tile
+ * row at a time (8 pixel rows in 8 lanes): the covered pixel range of each row is computed from the edges and turned
+ * into a 32-bit mask, and the max. depth of the triangle in the tile is computed conservatively from its depth plane.
+ * The coverage is merged into the mask if the triangle is in front of z0. If it lies much farther behind z1 than z0,
+ * the old mask is discarded instead. Once the mask is full, its depth becomes the new z0 and the mask is cleared.
+ *
+ * A bounding box is projected to a screen rectangle and its min. depth (the nearest corner). It is occluded if in each
+ * tile it overlaps, its min. depth is not less than z0, or not less than z1 and the rectangle lies inside the mask.
+ *
+ * Both phases run in parallel: chunks of occluder triangles are set up and binned into tile rows, then the tile rows
+ * are rasterized, each one going through the bins of all chunks in submission order (so the result does not depend on
+ * the number of threads). The bounding boxes are tested in chunks as well.
+ *
+ * Notes:
+ * - occluders are triangle lists (the normals are ignored), clockwise triangles are front faces and back faces are culled
+ * - occluder triangles crossing the near plane are skipped, boxes crossing it are always visible
+ * - coverage is sampled at the pixel centers like in D3D11, so occluders may hide parts of a box that are thinner than
+ *   a pixel of the low resolution buffer
+ * - without AVX2, the same algorithm runs with scalar code
+ */
+class OcclusionCuller
+{
+public:
+    struct Stats
+    {
+        size_t occluderTriangles;
+        // back faces, degenerate triangles, and triangles crossing the near plane or outside the viewport
+        size_t occluderTrianglesCulled;
+        size_t boxesTested;
+        size_t boxesOutsideFrustum;
+        size_t boxesOccluded;
+        double rasterMilliseconds;
+        double testMilliseconds;
+    };
+
+    static constexpr uint32_t TILE_WIDTH = 32;
+    static constexpr uint32_t TILE_HEIGHT = 8;
+
+    OcclusionCuller() = default;
+
+    /**
+     * Clears the masked depth buffer to width x height pixels and rasterizes the occluders transformed by
+     * modelViewProj (to clip space, e.g. proj * view * model).
+     *
+     * Notes:
+     * - starts a new frame: the stats are reset
+     * - width and height are limited to 16384
+     */
+    void RenderOccluders(const std::vector<VertexPosNormal>& occluders, const Matrix4x4& modelViewProj, uint32_t width, uint32_t height,
+        ThreadPool* pool = nullptr);
+
+    // tests the boxes (transformed by modelViewProj) against the occluders of the frame, visible[i] = 0 if box i is culled
+    void TestBoxes(const std::vector<BoundingBox>& boxes, const Matrix4x4& modelViewProj, std::vector<uint8_t>& visible, ThreadPool* pool = nullptr);
+
+    const Stats& GetLastStats() const noexcept { return m_stats; }
+
+private:
+    struct Tile
+    {
+        // one row of 32 pixels per element, bit i = pixel i
+        uint32_t mask[TILE_HEIGHT];
+        float z0;
+        float z1;
+    };
+
+    // occluder triangle after the setup
+    struct Triangle
+    {
+        // edge functions a * x + b * y + c, positive inside
+        float edgeA[3];
+        float edgeB[3];
+        float edgeC[3];
+        // depth plane z = depthA * x + depthB * y + depthC and the max. depth of the vertices
+        float depthA, depthB, depthC;
+        float maxZ;
+        // bounding box in pixels, clamped to the viewport
+        float minX, minY, maxX, maxY;
+    };
+
+    struct Chunk
+    {
+        std::vector<Triangle> triangles;
+        // triangle indices per tile row
+        std::vector<std::vector<uint32_t>> bins;
+        size_t trianglesCulled;
+    };
+
+    void SetUpChunk(const std::vector<VertexPosNormal>& occluders, const Matrix4x4& modelViewProj, size_t chunkIndex);
+    void RasterizeTileRow(uint32_t tileRow);
+    bool IsBoxVisible(const BoundingBox& box, const Matrix4x4& modelViewProj, bool& outsideFrustum) const noexcept;
+
+    uint32_t m_width = 0;
+    uint32_t m_height = 0;
+    uint32_t m_tilesX = 0;
+    uint32_t m_tilesY = 0;
+
+    std::vector<Tile> m_tiles;
+    std::vector<Chunk> m_chunks;
+    Stats m_stats = { };
+};
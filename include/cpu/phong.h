@@ -0,0 +1,105 @@
+#pragma once
+
+#include "cpu/image.h"
+#include "geometry.h"
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * 4x4 matrix in the layout of the Transformations constant buffer.
+ *
+ * The application stores the transposed DirectX matrices, so row i of m is column i of the DirectX matrix, and
+ * points are transformed as column vectors (p' = M * p).
+ */
+struct Matrix4x4
+{
+    float m[4][4];
+};
+
+// CPU versions of the constant buffers of phong.hlsl, the Transformations, LightSource and Material structs can be copied into them
+struct SceneTransforms
+{
+    Matrix4x4 model;
+    Matrix4x4 view;
+    Matrix4x4 proj;
+};
+
+struct SceneLight
+{
+    // light position in view space
+    float position[4];
+    // RGB color and the light power in the w-coordinate
+    float colorAndPower[4];
+};
+
+struct SceneMaterial
+{
+    float ambient[4];
+    float diffuse[4];
+    // rgb contains color, w-coordinate contains specular exponent
+    float specularAndShininess[4];
+};
+
+// a * b in the layout above, i.e., b is applied first
+Matrix4x4 MultiplyMatrices(const Matrix4x4& a, const Matrix4x4& b) noexcept;
+
+/**
+ * Transforms, light source and material of the application after the model has been rotated for the given time.
+ *
+ * Notes:
+ * - same camera, projection, light, and material as in InitRenderData() and UpdateTick()
+ * - UpdateTick() transforms the light position with the transposed view matrix, which is reproduced here
+ */
+void SetUpDefaultScene(uint32_t width, uint32_t height, float timeMilliseconds, SceneTransforms& transforms, SceneLight& light,
+    SceneMaterial& material) noexcept;
+
+// output of VSMain
+struct ShadedVertex
+{
+    // clip space position
+    float position[4];
+    float viewPosition[3];
+    float viewNormal[3];
+};
+
+// matrices of VSMain, computed once per draw (the normal matrix is the upper 3x3 part of modelView)
+struct VertexShaderConstants
+{
+    Matrix4x4 modelView;
+    Matrix4x4 proj;
+};
+
+VertexShaderConstants ComputeVertexShaderConstants(const SceneTransforms& transforms) noexcept;
+
+// VSMain
+ShadedVertex ShadeVertex(const VertexShaderConstants& constants, const VertexPosNormal& vertex) noexcept;
+
+// PSMain: Blinn-Phong lighting for a view space position and (not normalized) normal
+ColorRGBA32F ShadeBlinnPhong(const SceneLight& light, const SceneMaterial& material, const float viewPosition[3], const float viewNormal[3]) noexcept;
+
+/**
+ * PSMain for a batch of pixels in SoA form: viewPosition[i] and viewNormal[i] point to the i-th coordinate of count
+ * pixels, the RGB colors are written to color[0..2] (alpha is always 1).
+ *
+ * With AVX2 (checked at runtime), 8 pixels are shaded at once with approximations instead of the exact functions:
+ * - normalization with _mm256_rsqrt_ps() and one Newton-Raphson step (relative error below 2^-21)
+ * - pow(x, s) = exp2(s * log2(x)): log2 of the mantissa in [sqrt(0.5), sqrt(2)) with the series of atanh up to t^7
+ *   (absolute error below 2e-7), exp2 of the fractional part in [-0.5, 0.5] with the Taylor series up to degree 6
+ *   (relative error below 3e-7), so the relative error of the specular term is below
+ *   3e-7 + ln(2) * (s * 2e-7 + |s * log2(x)| * 2^-23), e.g. 1e-5 for s = 24 and x >= 0.1 (terms below 2^-100 are flushed to 0)
+ * Without AVX2, ShadeBlinnPhong() is called for each pixel.
+ *
+ * Notes:
+ * - the arrays do not need to be aligned
+ * - the result differs from ShadeBlinnPhong() by approx. (1 + s / 8) * 1e-6 * max(1, |color|) per channel, except for
+ *   pixels with dot(n, l) close to 0, where the specular term of PSMain is not continuous
+ */
+void ShadeBlinnPhongSoA(const SceneLight& light, const SceneMaterial& material, const float* const viewPosition[3], const float* const viewNormal[3],
+    size_t count, float* const color[3]) noexcept;
+
+// true if ShadeBlinnPhongSoA() uses the AVX2 kernel on this CPU
+bool IsSimdShadingSupported() noexcept;
+
+// true if the CPU and the OS support AVX2 (checked once)
+bool IsAvx2Supported() noexcept;
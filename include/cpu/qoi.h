@@ -0,0 +1,45 @@
+#pragma once
+
+#include "cpu/image.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class ThreadPool;
+
+/**
+ * Lossless encoder for the QOI image format (https://qoiformat.org), fast enough for capturing every frame.
+ *
+ * The image is split into stripes of rows that are encoded in parallel. Each stripe starts with the last pixel of
+ * the previous stripe as the previous pixel and an empty color index, and only uses index entries it has written
+ * itself. This way the concatenated stripes form a standard QOI stream that any decoder can read, and the output
+ * does not depend on the number of threads. The hashes for the color index are computed four pixels at a time and
+ * runs are detected by comparing four pixels at once (SSE2).
+ *
+ * Notes:
+ * - the header declares 4 channels and the sRGB color space
+ * - the stripe buffers are kept between calls
+ */
+class QoiEncoder
+{
+public:
+    // output is resized to the size of the encoded image
+    void Encode(const ImageRGBA8& image, std::vector<uint8_t>& output, ThreadPool* pool = nullptr);
+
+private:
+    struct Stripe
+    {
+        std::vector<uint8_t> data;
+        std::vector<uint8_t> hashes;
+        size_t size = 0;
+    };
+
+    std::vector<Stripe> m_stripes;
+};
+
+// straightforward single-threaded encoder as in the QOI reference implementation (used for comparison)
+void EncodeQoiReference(const ImageRGBA8& image, std::vector<uint8_t>& output);
+
+// decodes a QOI image with 3 or 4 channels (alpha is 255 for 3 channels), returns false if the data is invalid
+bool DecodeQoi(const uint8_t* data, size_t size, ImageRGBA8& image);
@@ -0,0 +1,174 @@
+#pragma once
+
+#include "cpu/image.h"
+#include "cpu/phong.h"
+#include "geometry.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class ThreadPool;
+
+struct RasterizerSettings
+{
+    // reject triangles and 8x8 pixel blocks that lie behind the max. depth of the tile or the block (Hi-Z)
+    bool hierarchicalDepth = true;
+    // rasterize triangle indices into a visibility buffer and shade each covered pixel once afterwards (instead of
+    // shading each pixel that passes the depth test)
+    bool visibilityBuffer = false;
+    // adaptive shading rate in visibility buffer mode: blocks of 4x4 or 2x2 pixels are shaded once if the variance of
+    // their normals and relative depths is below the threshold and they are not part of a specular highlight (0 = off)
+    float shadingRateThreshold = 0.f;
+    // reject back faces, degenerate, off-screen and sub-pixel triangles 8 at a time with AVX2 before the setup (if
+    // supported by the CPU)
+    bool prefilterTriangles = true;
+};
+
+/**
+ * Tiled, multithreaded software rasterizer for the scene pass (first pass of RenderFrame(), see phong.h).
+ *
+ * Follows the D3D11 rules of the pass:
+ * - triangles are clipped against the near and far planes (DepthClipEnable) and a guard band around the viewport
+ * - vertices are snapped to 1/256 pixel, covered pixel centers are found with fixed-point edge functions and the
+ *   top-left rule
+ * - back faces are culled like with defaultRasterizerState (CULL_BACK, clockwise triangles are front faces)
+ * - depth is quantized to 24 bits like D24_UNORM, cleared to 1, and tested with LESS
+ * - colors are saturated like in the R8G8B8A8_UNORM render target, the background is (0, 0, 0, 1)
+ * - pixels that pass the depth test are collected per tile and shaded in batches with ShadeBlinnPhongSoA()
+ *
+ * The tiles are rasterized in blocks of 8x8 pixels. Each tile keeps the min. and max. depth of its blocks up to date
+ * while it is written. A triangle whose min. depth is not less than the max. depth of the tile, or the part of a
+ * triangle in a block that is not less than the max. depth of the block, is rejected without per-pixel work. If its
+ * max. depth is less than the min. depth of the block, the per-pixel depth test is skipped. The depth bounds of a
+ * triangle are widened by a few depth units, so the result is exactly the same as without the hierarchy.
+ *
+ * In visibility buffer mode, the tiles are first rasterized without shading: only the depth and the index of the
+ * triangle in the vertex buffer (like SV_PrimitiveID) are written. Then each covered pixel of the tile is shaded once:
+ * the vertices of its triangle are fetched from the vertex buffer and transformed again, and the perspective correct
+ * barycentrics of the pixel center are reconstructed from their snapped screen positions. The colors only differ from
+ * the forward path by rounding, except for clipped triangles (the unsnapped positions are used for them).
+ *
+ * With an adaptive shading rate, the visibility buffer is shaded in blocks of 4x4 pixels. A block is shaded once (with
+ * the mean attributes of its corners, the color is written to all of its pixels) if it is completely covered, the
+ * variance of the unit normals and of the relative view space depth at its corners is below the threshold, and the
+ * specular term at its center is small. Otherwise, its quarters are tested the same way, and the remaining pixels are
+ * shaded per pixel. So silhouettes, creases and specular highlights keep the full shading rate.
+ *
+ * Before the setup, the triangles can be prefiltered with AVX2: the positions of 8 triangles at a time are transformed
+ * to clip space and snapped like in the setup, and back faces, degenerate triangles, triangles outside of one of the
+ * clip planes, and triangles whose bounding box contains no pixel center are rejected. The tests are done with the same
+ * floating-point operations as the setup (the area in double precision, which is exact for the snapped positions), so
+ * exactly the same triangles are culled. Only the compact list of the remaining triangles goes through the setup.
+ *
+ * A frame has two parallel phases. First, chunks of triangles are transformed, clipped, set up, and binned into
+ * screen tiles (each chunk has its own bins). Then the tiles are rasterized in parallel, each one going through the
+ * bins of all chunks in submission order, so the image does not depend on the number of threads.
+ *
+ * Notes:
+ * - the vertices are a triangle list as drawn with Draw() (objModelMesh)
+ * - width and height are limited to 16384 (max. D3D11 texture size)
+ */
+class SoftwareRasterizer
+{
+public:
+    struct Stats
+    {
+        size_t triangles;
+        // back faces, degenerate triangles, and triangles outside the view frustum or between pixel centers
+        size_t trianglesCulled;
+        // triangles that needed clipping
+        size_t trianglesClipped;
+        // culled triangles that were already rejected by the prefilter
+        size_t trianglesPrefiltered;
+        // sum of the number of tiles over all set up triangles
+        size_t binnedTriangles;
+        // pixel shader invocations: pixels that passed the depth test, or covered pixels in visibility buffer mode
+        size_t pixelsShaded;
+        // covered pixels that were shaded at a coarse rate (in blocks of 4x4 or 2x2 pixels)
+        size_t pixelsShadedCoarse;
+        // triangles rejected by the max. depth of a tile (counted per tile like binnedTriangles)
+        size_t trianglesOccluded;
+        // 8x8 pixel blocks covered by triangles that were tested against the max. depth of the block, and the rejected ones
+        size_t blocksTested;
+        size_t blocksOccluded;
+        double setupMilliseconds;
+        double rasterMilliseconds;
+    };
+
+    // visibility buffer value of pixels that are not covered by a triangle
+    static constexpr uint32_t NO_PRIMITIVE = ~0u;
+
+    SoftwareRasterizer() = default;
+    explicit SoftwareRasterizer(const RasterizerSettings& settings);
+
+    void Render(const std::vector<VertexPosNormal>& vertices, const SceneTransforms& transforms, const SceneLight& light,
+        const SceneMaterial& material, uint32_t width, uint32_t height, ImageRGBA32F& color, ThreadPool* pool = nullptr);
+
+    // 24-bit depth values of the last frame (row by row)
+    const std::vector<uint32_t>& GetDepthBuffer() const noexcept { return m_depth; }
+    // triangle indices of the last frame in visibility buffer mode (row by row)
+    const std::vector<uint32_t>& GetVisibilityBuffer() const noexcept { return m_visibility; }
+    const Stats& GetLastStats() const noexcept { return m_stats; }
+    const RasterizerSettings& GetSettings() const noexcept { return m_settings; }
+
+private:
+    // triangle after clipping and setup
+    struct Triangle
+    {
+        // fixed-point screen positions
+        int32_t x[3];
+        int32_t y[3];
+        // twice the area in fixed-point units
+        int64_t area;
+        // covered pixel range, clamped to the viewport
+        int32_t minX, minY, maxX, maxY;
+        // depth range of the vertices
+        float minZ, maxZ;
+        // depth in [0, 1], 1 / w and the attributes of the vertices
+        float z[3];
+        float invW[3];
+        float viewPosition[3][3];
+        float viewNormal[3][3];
+        // index of the (unclipped) triangle in the vertex buffer
+        uint32_t primitiveId;
+    };
+
+    struct Chunk
+    {
+        std::vector<Triangle> triangles;
+        // triangle indices per tile
+        std::vector<std::vector<uint32_t>> bins;
+        size_t trianglesCulled;
+        size_t trianglesClipped;
+        size_t trianglesPrefiltered;
+        size_t binnedTriangles;
+        // indices of the triangles that passed the prefilter
+        std::vector<uint32_t> candidates;
+    };
+
+    // state of the tile that is rasterized by a thread (defined in rasterizer.cpp)
+    struct TileContext;
+
+    void SetUpChunk(const std::vector<VertexPosNormal>& vertices, const VertexShaderConstants& constants, size_t chunkIndex);
+    void SetUpTriangle(const ShadedVertex& v0, const ShadedVertex& v1, const ShadedVertex& v2, uint32_t primitiveId, Chunk& chunk);
+    void RasterizeTile(uint32_t tileIndex, const std::vector<VertexPosNormal>& vertices, const VertexShaderConstants& constants,
+        const SceneLight& light, const SceneMaterial& material, ImageRGBA32F& color, Stats& stats);
+    void RasterizeTriangle(const Triangle& triangle, TileContext& tile, const SceneLight& light, const SceneMaterial& material, ImageRGBA32F& color);
+    // second pass of the visibility buffer mode
+    void ShadeVisibilityBuffer(TileContext& tile, const std::vector<VertexPosNormal>& vertices, const VertexShaderConstants& constants,
+        const SceneLight& light, const SceneMaterial& material, ImageRGBA32F& color);
+    // recomputes the max. depth of a block of the tile from the depth buffer
+    void UpdateBlockMaxDepth(TileContext& tile, uint32_t block) const noexcept;
+
+    RasterizerSettings m_settings;
+    uint32_t m_width = 0;
+    uint32_t m_height = 0;
+    uint32_t m_tilesX = 0;
+    uint32_t m_tilesY = 0;
+
+    std::vector<Chunk> m_chunks;
+    std::vector<uint32_t> m_depth;
+    std::vector<uint32_t> m_visibility;
+    Stats m_stats = { };
+};
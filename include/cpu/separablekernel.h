@@ -0,0 +1,51 @@
+#pragma once
+
+#include "cpu/image.h"
+#include "cpu/kernel.h"
+
+#include <cstdint>
+#include <vector>
+
+class ThreadPool;
+
+// rank-1 term of a separable approximation: kernel(i, j) = horizontal[i] * vertical[j]
+struct SeparableTerm
+{
+    std::vector<float> horizontal;
+    std::vector<float> vertical;
+};
+
+/**
+ * Approximation of a 2D kernel by a sum of separable terms, each of which can be applied as a horizontal and a
+ * vertical 1D pass like the two passes of blur.hlsl.
+ */
+struct SeparableKernel
+{
+    uint32_t width = 0;
+    uint32_t height = 0;
+    std::vector<SeparableTerm> terms;
+    // all singular values of the kernel in descending order (not only those of the used terms)
+    std::vector<double> singularValues;
+    // relative Frobenius norm of the difference to the original kernel
+    double relativeError = 0.0;
+};
+
+/**
+ * Decomposes kernel into separable terms with a singular value decomposition (one-sided Jacobi in double precision).
+ *
+ * The rank is the smallest one with a relative error (Frobenius norm) of at most tolerance, but not more than
+ * maxRank terms (0 = no limit). The truncated SVD is the best approximation of a given rank in this norm.
+ */
+SeparableKernel DecomposeKernel(const Kernel2D& kernel, double tolerance, uint32_t maxRank = 0);
+
+// evaluates the sum of the terms as a 2D kernel
+Kernel2D ReconstructKernel(const SeparableKernel& kernel);
+
+/**
+ * Applies the separable approximation: a horizontal and a vertical pass per term, accumulated into output.
+ *
+ * Notes:
+ * - same contract as Convolve2D(): zero outside of input, RGB only, output alpha is 1
+ * - temp holds the result of the horizontal passes, output and temp are resized to the size of input
+ */
+void ConvolveSeparable(const ImageRGBA32F& input, const SeparableKernel& kernel, ImageRGBA32F& temp, ImageRGBA32F& output, ThreadPool* pool = nullptr);
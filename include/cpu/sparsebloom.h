@@ -0,0 +1,68 @@
+#pragma once
+
+#include "bloomparams.h"
+#include "cpu/bloom.h"
+#include "cpu/image.h"
+
+#include <cstdint>
+#include <vector>
+
+class ThreadPool;
+
+// compacted lists of packed tile coordinates (x | y << 16), like the buffers written by tileclassify.hlsl
+struct BloomTileLists
+{
+    uint32_t tilesX = 0;
+    uint32_t tilesY = 0;
+    // tiles that need the horizontal and the vertical blur pass
+    std::vector<uint32_t> horizontal;
+    std::vector<uint32_t> vertical;
+};
+
+/**
+ * tileclassify.hlsl: builds the tile lists of the two blur passes from the per-tile bright mask.
+ *
+ * Notes:
+ * - a tile needs the horizontal pass if a bright tile is within tileRadius tiles in the same row
+ * - a tile needs the vertical pass if a bright tile is within tileRadius tiles in x and y
+ * - the lists are sorted in row-major order (the order on the GPU is arbitrary)
+ */
+void ClassifyBloomTiles(const std::vector<uint8_t>& brightMask, uint32_t tilesX, uint32_t tilesY, uint32_t tileRadius, BloomTileLists& lists);
+
+/**
+ * Threshold and blur passes that skip the parts of the image without any pixels above the threshold.
+ *
+ * The CPU counterpart of the sparse GPU path: the threshold pass marks all BLOOM_TILE_SIZE tiles containing
+ * a bright pixel, and the blur passes only process the tiles within the blur radius of such a tile. All other
+ * tiles are zero after the blur in any case, so the RGB result is identical to ComputeBloom() (the alpha
+ * channel of skipped tiles keeps the value 1 written by the threshold pass).
+ */
+class SparseBloom
+{
+public:
+    struct Stats
+    {
+        uint32_t tilesTotal;
+        // tiles containing at least one pixel above the threshold
+        uint32_t tilesBright;
+        uint32_t tilesBlurredHorizontal;
+        uint32_t tilesBlurredVertical;
+        // pixels not processed by the two blur passes compared to the dense passes (counted in full tiles)
+        uint64_t pixelsSkipped;
+    };
+
+    // updates buffers.bloom like ComputeBloom()
+    void Process(const ImageRGBA32F& scene, const BloomSettings& settings, BloomBuffers& buffers, ThreadPool* pool = nullptr);
+
+    const Stats& GetLastFrameStats() const noexcept { return m_stats; }
+    const BloomTileLists& GetTileLists() const noexcept { return m_tileLists; }
+
+private:
+    // calls func(x, y) for all pixels of the tiles in the list
+    template <typename PixelFunc>
+    void ForEachTilePixel(const std::vector<uint32_t>& tiles, uint32_t width, uint32_t height, ThreadPool* pool, const PixelFunc& func);
+
+    std::vector<uint8_t> m_brightMask;
+    BloomTileLists m_tileLists;
+    Stats m_stats = { };
+};
@@ -0,0 +1,158 @@
+#pragma once
+
+#include "cpu/bloom.h"
+#include "cpu/image.h"
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+class ThreadPool;
+
+// sequential source of image rows (top to bottom)
+class RowReader
+{
+public:
+    virtual ~RowReader() = default;
+
+    virtual uint32_t GetWidth() const noexcept = 0;
+    virtual uint32_t GetHeight() const noexcept = 0;
+
+    // reads the next count rows into pixels (count * width pixels), returns false on error
+    virtual bool ReadRows(uint32_t count, ColorRGBA32F* pixels) = 0;
+};
+
+// sequential destination of image rows (top to bottom)
+class RowWriter
+{
+public:
+    virtual ~RowWriter() = default;
+
+    // writes the next count rows from pixels (count * width pixels), returns false on error
+    virtual bool WriteRows(uint32_t count, const ColorRGBA32F* pixels) = 0;
+};
+
+// rows of an image in memory
+class ImageRowReader : public RowReader
+{
+public:
+    explicit ImageRowReader(const ImageRGBA32F& image) noexcept;
+
+    uint32_t GetWidth() const noexcept override { return m_image.width; }
+    uint32_t GetHeight() const noexcept override { return m_image.height; }
+    bool ReadRows(uint32_t count, ColorRGBA32F* pixels) override;
+
+private:
+    const ImageRGBA32F& m_image;
+    uint32_t m_nextRow;
+};
+
+// appends rows to an image in memory (which is resized to width x height first)
+class ImageRowWriter : public RowWriter
+{
+public:
+    ImageRowWriter(ImageRGBA32F& image, uint32_t width, uint32_t height);
+
+    bool WriteRows(uint32_t count, const ColorRGBA32F* pixels) override;
+
+private:
+    ImageRGBA32F& m_image;
+    uint32_t m_nextRow;
+};
+
+/**
+ * Raw RGBA8 image file: a 12 byte header (magic "RGBA", width, height as little-endian uint32) followed by the rows.
+ *
+ * The pixels are converted to float when reading, and rounded and saturated to [0, 1] when writing.
+ */
+class RawImageFileReader : public RowReader
+{
+public:
+    // opens the file and reads the header, returns false on error
+    bool Open(const std::string& path);
+
+    uint32_t GetWidth() const noexcept override { return m_width; }
+    uint32_t GetHeight() const noexcept override { return m_height; }
+    bool ReadRows(uint32_t count, ColorRGBA32F* pixels) override;
+
+private:
+    std::ifstream m_file;
+    uint32_t m_width = 0;
+    uint32_t m_height = 0;
+    std::vector<ColorRGBA8> m_buffer;
+};
+
+class RawImageFileWriter : public RowWriter
+{
+public:
+    // creates the file and writes the header, returns false on error
+    bool Open(const std::string& path, uint32_t width, uint32_t height);
+
+    // flushes and closes the file, returns false on error
+    bool Close();
+
+    bool WriteRows(uint32_t count, const ColorRGBA32F* pixels) override;
+    bool WriteRows(uint32_t count, const ColorRGBA8* pixels);
+
+private:
+    std::ofstream m_file;
+    uint32_t m_width = 0;
+    std::vector<ColorRGBA8> m_buffer;
+};
+
+/**
+ * Out-of-core bloom: ApplyBloom() on images that are streamed row by row instead of being held in memory.
+ *
+ * The half-res image is processed in bands of rows. Scene rows are read as the threshold pass needs them, each
+ * thresholded row is blurred horizontally right away, and the vertical blur and composite of a row are done as
+ * soon as all rows within the blur radius are available. Finished output rows are written immediately. Only
+ * ring buffers of O(band size + radius) rows are held, i.e., the memory is O(width * radius) instead of
+ * O(width * height). The result is identical to ApplyBloom().
+ *
+ * Notes:
+ * - the passes of each band run in parallel on the rows of the band, reading and writing happen in between
+ * - the scene has to be at least 2 x 2 pixels
+ */
+class StreamingBloom
+{
+public:
+    struct Stats
+    {
+        uint64_t rowsRead;
+        uint64_t rowsWritten;
+        // size of all buffers held during the last Process() call
+        size_t workingSetBytes;
+    };
+
+    // bandRows is given in half-res rows
+    explicit StreamingBloom(uint32_t bandRows = 16);
+
+    // returns false if reading or writing failed
+    bool Process(RowReader& reader, const BloomSettings& settings, RowWriter& writer, ThreadPool* pool = nullptr);
+
+    const Stats& GetLastStats() const noexcept { return m_stats; }
+
+private:
+    // ring buffer of image rows, row y is stored in slot y % capacity
+    struct RowRing
+    {
+        uint32_t width = 0;
+        uint32_t capacity = 0;
+        std::vector<ColorRGBA32F> pixels;
+
+        void Resize(uint32_t newWidth, uint32_t newCapacity);
+        ColorRGBA32F* Row(uint32_t y) noexcept { return pixels.data() + static_cast<size_t>(y % capacity) * width; }
+    };
+
+    uint32_t m_bandRows;
+
+    RowRing m_sceneRows;
+    RowRing m_horizontalRows;
+    RowRing m_bloomRows;
+    // thresholded rows of the current band, and the output rows written after each band
+    ImageRGBA32F m_thresholdedRows;
+    std::vector<ColorRGBA32F> m_outputRows;
+
+    Stats m_stats;
+};
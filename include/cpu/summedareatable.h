@@ -0,0 +1,78 @@
+#pragma once
+
+#include "cpu/image.h"
+
+#include <cstdint>
+
+class ThreadPool;
+
+// RGBA color with 64-bit float channels
+struct ColorRGBA64F
+{
+    double r, g, b, a;
+};
+
+// accumulator precision of a summed-area table
+enum class SatPrecision
+{
+    // plain float sums: fastest, but the error grows with the image size (the sums become large)
+    Float,
+    // float sums with a second float holding the rounding error (compensated / double-float addition)
+    Compensated,
+    // double sums: twice the memory of Float, same as Compensated
+    Double
+};
+
+/**
+ * Summed-area table of an RGBA image: the sum over any axis-aligned box can be evaluated with four lookups.
+ *
+ * The table is built with a parallel prefix sum over the rows followed by one over the columns, both
+ * vectorized with SSE (one pixel per register for floats, two registers for doubles).
+ *
+ * Notes:
+ * - the table has an additional zero row and column, i.e., entry (x, y) is the sum over [0, x) x [0, y)
+ * - the compensated mode relies on strict IEEE float semantics, it must not be compiled with /fp:fast or -ffast-math
+ */
+class SummedAreaTable
+{
+public:
+    void Build(const ImageRGBA32F& image, SatPrecision precision, ThreadPool* pool = nullptr);
+
+    // sum over [x0, x1) x [y0, y1) with the box clamped to the image (zero outside)
+    ColorRGBA64F Sum(int x0, int y0, int x1, int y1) const noexcept;
+
+    uint32_t GetWidth() const noexcept { return m_width; }
+    uint32_t GetHeight() const noexcept { return m_height; }
+    SatPrecision GetPrecision() const noexcept { return m_precision; }
+
+private:
+    ColorRGBA64F Fetch(uint32_t x, uint32_t y) const noexcept;
+
+    SatPrecision m_precision = SatPrecision::Float;
+    uint32_t m_width = 0;
+    uint32_t m_height = 0;
+
+    // Float and Compensated (m_floatTable holds the high, m_compensationTable the low part of the sums)
+    Image<ColorRGBA32F> m_floatTable;
+    Image<ColorRGBA32F> m_compensationTable;
+    // Double
+    Image<ColorRGBA64F> m_doubleTable;
+};
+
+/**
+ * Box blur with a per-pixel radius: output(x, y) is the average over the (2r + 1) x (2r + 1) box around (x, y) with r = radius(x, y).
+ *
+ * Notes:
+ * - fractional radii interpolate linearly between the two adjacent integer radii, so that the blur changes smoothly
+ * - the image is zero outside (like the texel fetches of blur.hlsl), boxes are not renormalized at the borders
+ * - radius must have the size of the table, output is resized accordingly
+ * - only the RGB channels are blurred, the output alpha is 1
+ */
+void VariableBoxBlur(const SummedAreaTable& table, const Image<float>& radius, ImageRGBA32F& output, ThreadPool* pool = nullptr);
+
+// iterations box blurs (each with a new table of the previous result), approximates a Gaussian for iterations >= 3
+void VariableIteratedBoxBlur(const ImageRGBA32F& input, const Image<float>& radius, uint32_t iterations, SatPrecision precision,
+    SummedAreaTable& table, ImageRGBA32F& output, ThreadPool* pool = nullptr);
+
+// box radius for which iterations box blurs have the variance of a Gaussian with the given sigma
+float ComputeBoxRadiusForGaussian(float sigma, uint32_t iterations) noexcept;
@@ -0,0 +1,82 @@
+#pragma once
+
+#include "cpu/bloom.h"
+#include "cpu/image.h"
+
+#include <cstdint>
+
+class ThreadPool;
+
+// pattern of the pixels that are recomputed in a frame
+enum class TemporalPattern
+{
+    // bands of tileSize rows, band i is updated in frame (i mod period)
+    InterleavedRows,
+    // square tiles of tileSize pixels in an ordered dither pattern (period must be 1, 2 or 4)
+    Checkerboard
+};
+
+struct TemporalBloomSettings
+{
+    TemporalPattern pattern = TemporalPattern::InterleavedRows;
+    // number of frames after which every pixel has been recomputed once
+    uint32_t period = 2;
+    // size of the rows bands or tiles in half-res pixels
+    uint32_t tileSize = 1;
+    // weight of the (reprojected) history for the recomputed pixels, 0 replaces them with the new value
+    float historyWeight = 0.f;
+};
+
+/**
+ * Temporally amortized threshold and blur passes.
+ *
+ * Each frame only the pixels of the current phase of the update pattern are recomputed. All three passes
+ * (threshold, horizontal and vertical blur) only write the pixels of the pattern, but read from persistent
+ * buffers, i.e., neighbors that are not part of the pattern contribute values of earlier frames. Pixels
+ * outside of the pattern keep the bloom of the previous frame, which can optionally be reprojected with a
+ * per-pixel motion vector field.
+ */
+class TemporalBloom
+{
+public:
+    struct Stats
+    {
+        uint64_t pixelsTotal;
+        uint64_t pixelsUpdated;
+    };
+
+    explicit TemporalBloom(const TemporalBloomSettings& settings);
+
+    /**
+     * Updates the bloom for the current frame and returns it (half the size of the scene).
+     *
+     * Notes:
+     * - motionVectors is optional and has to have the size of the bloom image; r and g contain the offset in half-res pixels
+     *   from the previous to the current frame (the pixel p of the current frame was at p - (r, g) in the previous frame)
+     * - the first frame and frames after a size change are computed in full
+     */
+    const ImageRGBA32F& Process(const ImageRGBA32F& scene, const BloomSettings& settings, const ImageRGBA32F* motionVectors = nullptr, ThreadPool* pool = nullptr);
+
+    // discards the history so that the next frame is computed in full
+    void Reset() noexcept;
+
+    const Stats& GetLastFrameStats() const noexcept { return m_stats; }
+    const TemporalBloomSettings& GetSettings() const noexcept { return m_settings; }
+
+private:
+    bool IsUpdated(uint32_t x, uint32_t y, uint32_t phase) const noexcept;
+    void Reproject(const ImageRGBA32F& motionVectors, ThreadPool* pool);
+
+    TemporalBloomSettings m_settings;
+
+    // persistent intermediate results of the threshold and horizontal blur passes
+    ImageRGBA32F m_thresholded;
+    ImageRGBA32F m_horizontal;
+    // bloom of the current and the previous frame (the latter is only needed for reprojection)
+    ImageRGBA32F m_bloom;
+    ImageRGBA32F m_history;
+
+    uint32_t m_frameIndex;
+    bool m_hasHistory;
+    Stats m_stats;
+};
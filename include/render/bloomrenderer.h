@@ -0,0 +1,135 @@
+#pragma once
+
+#include "bloomparams.h"
+#include "cpu/phong.h"
+#include "geometry.h"
+#include "render/framegraph.h"
+#include "render/renderdevice.h"
+#include "util/resolution.h"
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// everything a frame of BloomRenderer depends on
+struct BloomFrameInputs
+{
+    SceneTransforms transforms;
+    SceneLight light;
+    // internal resolution the scene and bloom are rendered with (<= output resolution)
+    Resolution renderResolution;
+    float threshold;
+    // direction and size are set by the renderer for each blur pass
+    BlurParams blurParams;
+    float compositeCoefficient;
+    // only blur the tiles close to pixels passing the threshold
+    bool sparseBloom;
+};
+
+/**
+ * The frame of the application recorded through RenderDevice and RenderContext, so that it runs on D3D11 as well as
+ * on the CPU backend.
+ *
+ * Render() records the scene pass (the Blinn-Phong shaded mesh with depth test), the threshold and downsample pass,
+ * the tile classification of the sparse bloom, the two blur passes and the composition into the back buffer into a
+ * FrameGraph, which binds and unbinds the render targets and encloses each pass in BeginPass() and EndPass(). The
+ * render targets are transient textures of the graph with the output resolution, but the scene and bloom only cover
+ * the upper left part of size renderResolution.
+ *
+ * Notes:
+ * - the shaders are loaded from the shaders directory (relative to the working directory)
+ * - Render() does not call Present(), so that the caller can copy the back buffer before (e.g., for the capture)
+ */
+class BloomRenderer
+{
+public:
+    BloomRenderer() = default;
+    ~BloomRenderer();
+
+    // no copy or move operations allowed
+    BloomRenderer(const BloomRenderer&) = delete;
+    BloomRenderer(BloomRenderer&&) = delete;
+    BloomRenderer& operator=(const BloomRenderer&) = delete;
+    BloomRenderer& operator=(BloomRenderer&&) = delete;
+
+    // creates all resources, returns false (after printing the resource that could not be created) on error
+    bool Initialize(RenderDevice& device, const Resolution& outputResolution, const std::vector<VertexPosNormal>& mesh, const SceneMaterial& material);
+
+    // recreates the tile buffers for a new output resolution (the back buffer has to be resized by the caller), the
+    // render targets of the new size are acquired from the texture pool in the next Render()
+    bool Resize(const Resolution& outputResolution);
+
+    // releases all resources, called by the destructor as well
+    void Release();
+
+    void Render(RenderContext& context, const BloomFrameInputs& inputs);
+
+    const Resolution& GetOutputResolution() const noexcept { return m_outputResolution; }
+
+    // the graph of the last Render(), e.g., for its statistics or to disable the aliasing (only valid after Initialize())
+    FrameGraph& GetFrameGraph() noexcept { return *m_frameGraph; }
+    // pool of the render targets, Render() ends a frame of the pool (only valid after Initialize())
+    TexturePool& GetTexturePool() noexcept { return *m_texturePool; }
+
+private:
+    // structured buffer of uints with views for reading and writing in compute shaders
+    struct StructuredBuffer
+    {
+        BufferHandle buffer;
+        ViewHandle shaderResourceView;
+        ViewHandle unorderedAccessView;
+    };
+
+    bool CreateTileBuffers();
+    void ReleaseTileBuffers();
+    bool CreateStructuredBuffer(uint32_t elementCount, StructuredBuffer& structuredBuffer);
+    void ReleaseStructuredBuffer(StructuredBuffer& structuredBuffer);
+    // creates a dynamic constant buffer, optionally with initial contents
+    BufferHandle CreateConstantBuffer(uint32_t size, const void* initialData = nullptr);
+
+    RenderDevice* m_device = nullptr;
+    Resolution m_outputResolution = { 0, 0 };
+
+    // shaders
+    ShaderHandle m_modelVertexShader = ShaderHandle::Null;
+    ShaderHandle m_modelPixelShader = ShaderHandle::Null;
+    ShaderHandle m_quadCompositeVertexShader = ShaderHandle::Null;
+    ShaderHandle m_quadCompositePixelShader = ShaderHandle::Null;
+    ShaderHandle m_thresholdDownsampleShader = ShaderHandle::Null;
+    ShaderHandle m_blurShader = ShaderHandle::Null;
+    ShaderHandle m_blurTilesShader = ShaderHandle::Null;
+    ShaderHandle m_tileClassifyShader = ShaderHandle::Null;
+
+    // passes of the frame and the pool of its render targets (kept across frames and resizes)
+    std::unique_ptr<TexturePool> m_texturePool;
+    std::unique_ptr<FrameGraph> m_frameGraph;
+
+    // sparse bloom: per-tile flag, compacted tile lists and DispatchIndirect() arguments of the two blur passes
+    StructuredBuffer m_tileMaskBuffer = { };
+    StructuredBuffer m_horizontalTileBuffer = { };
+    StructuredBuffer m_verticalTileBuffer = { };
+    BufferHandle m_dispatchArgsBuffer = BufferHandle::Null;
+    ViewHandle m_dispatchArgsView = ViewHandle::Null;
+
+    // states
+    DepthStencilStateHandle m_depthStencilStateWithDepthTest = DepthStencilStateHandle::Null;
+    DepthStencilStateHandle m_depthStencilStateWithoutDepthTest = DepthStencilStateHandle::Null;
+    SamplerStateHandle m_defaultSamplerState = SamplerStateHandle::Null;
+    RasterizerStateHandle m_defaultRasterizerState = RasterizerStateHandle::Null;
+
+    // meshes
+    BufferHandle m_modelVertexBuffer = BufferHandle::Null;
+    InputLayoutHandle m_modelInputLayout = InputLayoutHandle::Null;
+    uint32_t m_modelVertexCount = 0;
+    BufferHandle m_quadVertexBuffer = BufferHandle::Null;
+    InputLayoutHandle m_quadInputLayout = InputLayoutHandle::Null;
+
+    // constant buffers
+    BufferHandle m_transformConstantBuffer = BufferHandle::Null;
+    BufferHandle m_lightSourceConstantBuffer = BufferHandle::Null;
+    BufferHandle m_materialConstantBuffer = BufferHandle::Null;
+    BufferHandle m_thresholdConstantBuffer = BufferHandle::Null;
+    BufferHandle m_tileClassifyConstantBuffer = BufferHandle::Null;
+    BufferHandle m_blurConstantBuffer = BufferHandle::Null;
+    BufferHandle m_compositionConstantBuffer = BufferHandle::Null;
+};
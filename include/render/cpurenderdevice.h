@@ -0,0 +1,234 @@
+#pragma once
+
+#include "cpu/image.h"
+#include "cpu/rasterizer.h"
+#include "render/handletable.h"
+#include "render/renderdevice.h"
+#include "util/timer.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class ThreadPool;
+
+/**
+ * RenderDevice that executes the frame on the CPU, e.g., to run the renderer headless or on other platforms.
+ *
+ * The shaders of the renderer are mapped to the CPU kernels that mirror them (see cpu/bloom.h):
+ * - thresholddownsample.hlsl, blur.hlsl (Blur and BlurTiles) and tileclassify.hlsl run per thread group like the
+ *   compute shaders, the groups are distributed over the thread pool
+ * - draws with phong.hlsl are rendered by the SoftwareRasterizer into the viewport, pixels not covered by the mesh
+ *   get the background color (0, 0, 0, 1) the scene pass clears to
+ * - draws with quadcomposite.hlsl are fullscreen quads (the vertex buffer is not read), shaded per pixel with
+ *   bilinear clamp sampling like the default sampler state
+ * CreateShader() fails for other shaders.
+ *
+ * Notes:
+ * - textures are stored with 32-bit float channels, so unlike on the GPU the UNORM formats are not quantized (the
+ *   software rasterizer saturates the colors like the render target)
+ * - the depth-stencil and rasterizer states of the scene pass are implied by the rasterizer (depth test with LESS,
+ *   back-face culling), and depth buffers are not stored: each draw starts with a depth buffer cleared to 1
+ * - ClassifyTiles runs serially, so the tile lists are in row-major order (on the GPU the order is arbitrary)
+ * - out-of-bounds writes are discarded and out-of-bounds reads return zero like on D3D11
+ */
+class CpuRenderDevice : public RenderDevice
+{
+public:
+    // backbuffer of width x height with R8G8B8A8UnormSrgb, pool may be nullptr
+    CpuRenderDevice(uint32_t width, uint32_t height, ThreadPool* pool = nullptr);
+
+    // no copy or move operations allowed
+    CpuRenderDevice(const CpuRenderDevice&) = delete;
+    CpuRenderDevice(CpuRenderDevice&&) = delete;
+    CpuRenderDevice& operator=(const CpuRenderDevice&) = delete;
+    CpuRenderDevice& operator=(CpuRenderDevice&&) = delete;
+
+    BufferHandle CreateBuffer(const BufferDesc& desc, const void* initialData = nullptr) override;
+    TextureHandle CreateTexture(const TextureDesc& desc) override;
+    ViewHandle CreateView(TextureHandle texture, ViewType type) override;
+    ViewHandle CreateView(BufferHandle buffer, ViewType type) override;
+    ShaderHandle CreateShader(const ShaderDesc& desc) override;
+    InputLayoutHandle CreateInputLayout(ShaderHandle vertexShader, const std::vector<VertexElement>& elements) override;
+    DepthStencilStateHandle CreateDepthStencilState(const DepthStencilDesc& desc) override;
+    SamplerStateHandle CreateSamplerState(const SamplerDesc& desc) override;
+    RasterizerStateHandle CreateRasterizerState(const RasterizerDesc& desc) override;
+
+    void Release(BufferHandle buffer) override;
+    void Release(TextureHandle texture) override;
+    void Release(ViewHandle view) override;
+    void Release(ShaderHandle shader) override;
+    void Release(InputLayoutHandle inputLayout) override;
+    void Release(DepthStencilStateHandle state) override;
+    void Release(SamplerStateHandle state) override;
+    void Release(RasterizerStateHandle state) override;
+
+    const BufferDesc* GetDesc(BufferHandle buffer) const noexcept override;
+    const TextureDesc* GetDesc(TextureHandle texture) const noexcept override;
+
+    ViewHandle GetBackBufferView() const noexcept override { return m_backBufferView; }
+    bool ResizeBackBuffer(uint32_t width, uint32_t height) override;
+
+    // the image of the last Present() (linear colors, the sRGB conversion of the swapchain is not applied)
+    const ImageRGBA32F& GetPresentedImage() const noexcept { return m_presentedImage; }
+
+    // contents of a texture or buffer, nullptr for invalid handles
+    const ImageRGBA32F* GetTextureImage(TextureHandle texture) const noexcept;
+    const std::vector<uint8_t>* GetBufferData(BufferHandle buffer) const noexcept;
+
+    // number of live objects of all types (resources, views, shaders and states, including the back buffer and its view)
+    size_t GetObjectCount() const noexcept;
+
+private:
+    friend class CpuRenderContext;
+
+    // the HLSL functions the CPU kernels replace
+    enum class Kernel
+    {
+        ThresholdAndDownsample,
+        Blur,
+        BlurTiles,
+        ClassifyTiles,
+        PhongVertex,
+        PhongPixel,
+        QuadCompositeVertex,
+        QuadCompositePixel
+    };
+
+    struct Buffer
+    {
+        BufferDesc desc;
+        std::vector<uint8_t> data;
+    };
+
+    struct Texture
+    {
+        TextureDesc desc;
+        ImageRGBA32F image;
+    };
+
+    struct View
+    {
+        ViewType type;
+        // the view refers to either a texture or a buffer
+        TextureHandle texture;
+        BufferHandle buffer;
+    };
+
+    struct Shader
+    {
+        ShaderDesc desc;
+        Kernel kernel;
+    };
+
+    ThreadPool* m_pool;
+
+    HandleTable<BufferHandle, Buffer> m_buffers;
+    HandleTable<TextureHandle, Texture> m_textures;
+    HandleTable<ViewHandle, View> m_views;
+    HandleTable<ShaderHandle, Shader> m_shaders;
+    HandleTable<InputLayoutHandle, std::vector<VertexElement>> m_inputLayouts;
+    HandleTable<DepthStencilStateHandle, DepthStencilDesc> m_depthStencilStates;
+    HandleTable<SamplerStateHandle, SamplerDesc> m_samplerStates;
+    HandleTable<RasterizerStateHandle, RasterizerDesc> m_rasterizerStates;
+
+    TextureHandle m_backBuffer;
+    ViewHandle m_backBufferView;
+    ImageRGBA32F m_presentedImage;
+};
+
+/**
+ * RenderContext of a CpuRenderDevice: each command is executed immediately, the pass timings are the CPU times of
+ * the commands between BeginPass() and EndPass().
+ */
+class CpuRenderContext : public RenderContext
+{
+public:
+    explicit CpuRenderContext(CpuRenderDevice& device);
+
+    // no copy or move operations allowed
+    CpuRenderContext(const CpuRenderContext&) = delete;
+    CpuRenderContext(CpuRenderContext&&) = delete;
+    CpuRenderContext& operator=(const CpuRenderContext&) = delete;
+    CpuRenderContext& operator=(CpuRenderContext&&) = delete;
+
+    void SetViewport(float width, float height) override;
+    void SetRasterizerState(RasterizerStateHandle state) override;
+    void SetRenderTargets(uint32_t count, const ViewHandle* renderTargets, ViewHandle depthStencil) override;
+    void SetDepthStencilState(DepthStencilStateHandle state) override;
+    void SetShader(ShaderStage stage, ShaderHandle shader) override;
+    void SetInputLayout(InputLayoutHandle inputLayout) override;
+    void SetVertexBuffer(BufferHandle buffer, uint32_t stride, uint32_t offset) override;
+    void SetPrimitiveTopology(PrimitiveTopology topology) override;
+
+    void SetConstantBuffers(ShaderStage stage, uint32_t slot, uint32_t count, const BufferHandle* buffers) override;
+    void SetShaderResources(ShaderStage stage, uint32_t slot, uint32_t count, const ViewHandle* views) override;
+    void SetUnorderedAccessViews(uint32_t slot, uint32_t count, const ViewHandle* views) override;
+    void SetSamplers(ShaderStage stage, uint32_t slot, uint32_t count, const SamplerStateHandle* samplers) override;
+
+    void ClearRenderTarget(ViewHandle renderTarget, const float color[4]) override;
+    void ClearDepth(ViewHandle depthStencil, float depth) override;
+    void ClearUnorderedAccessView(ViewHandle view, const float values[4]) override;
+
+    void UpdateBuffer(BufferHandle buffer, const void* data, size_t size) override;
+
+    void Dispatch(uint32_t groupsX, uint32_t groupsY, uint32_t groupsZ) override;
+    void DispatchIndirect(BufferHandle arguments, uint32_t offset) override;
+    void Draw(uint32_t vertexCount) override;
+
+    void BeginPass(const char* name) override;
+    void EndPass() override;
+    void Present() override;
+
+    const std::vector<PassTiming>& GetPassTimings() const noexcept override { return m_lastFrameTimings; }
+
+    // the scene pass rasterizer, e.g., for its stats
+    const SoftwareRasterizer& GetRasterizer() const noexcept { return m_rasterizer; }
+
+private:
+    static constexpr uint32_t SLOT_COUNT = 8;
+    static constexpr uint32_t STAGE_COUNT = 3;
+
+    struct StageBindings
+    {
+        ShaderHandle shader;
+        BufferHandle constantBuffers[SLOT_COUNT];
+        ViewHandle shaderResources[SLOT_COUNT];
+        SamplerStateHandle samplers[SLOT_COUNT];
+    };
+
+    // resources bound to the slots, nullptr if nothing (valid) is bound
+    const ImageRGBA32F* GetShaderResourceImage(ShaderStage stage, uint32_t slot) const noexcept;
+    const std::vector<uint8_t>* GetShaderResourceBuffer(ShaderStage stage, uint32_t slot) const noexcept;
+    ImageRGBA32F* GetUnorderedAccessImage(uint32_t slot) noexcept;
+    std::vector<uint8_t>* GetUnorderedAccessBuffer(uint32_t slot) noexcept;
+    ImageRGBA32F* GetRenderTargetImage() noexcept;
+    // copies the constant buffer into constants if it is bound and large enough
+    template <typename T>
+    bool GetConstants(ShaderStage stage, uint32_t slot, T& constants) const noexcept;
+
+    void DispatchThresholdAndDownsample(uint32_t groupsX, uint32_t groupsY);
+    void DispatchBlur(uint32_t groupsX, uint32_t groupsY, bool tiles);
+    void DispatchClassifyTiles(uint32_t groupsX);
+    void DrawPhong(uint32_t vertexCount);
+    void DrawQuadComposite();
+
+    CpuRenderDevice& m_device;
+
+    float m_viewport[2];
+    ViewHandle m_renderTarget;
+    StageBindings m_stages[STAGE_COUNT];
+    ViewHandle m_unorderedAccessViews[SLOT_COUNT];
+    BufferHandle m_vertexBuffer;
+    uint32_t m_vertexStride;
+    uint32_t m_vertexOffset;
+
+    SoftwareRasterizer m_rasterizer;
+    std::vector<VertexPosNormal> m_vertices;
+    ImageRGBA32F m_sceneColor;
+
+    const char* m_passName;
+    Timer m_passTimer;
+    std::vector<PassTiming> m_frameTimings;
+    std::vector<PassTiming> m_lastFrameTimings;
+};
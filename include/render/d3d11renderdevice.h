@@ -0,0 +1,195 @@
+#pragma once
+
+#include <d3d11.h>
+
+#include "render/handletable.h"
+#include "render/renderdevice.h"
+
+#include <array>
+#include <string>
+#include <vector>
+
+/**
+ * RenderDevice on top of D3D11 with a swapchain for a window.
+ *
+ * The shaders are compiled with D3DX11CompileFromFile() (vs_4_0, ps_4_0 and cs_5_0), compile errors are written to
+ * the debug output.
+ */
+class D3D11RenderDevice : public RenderDevice
+{
+public:
+    // creates the device, the device context and a swapchain with an sRGB back buffer for the window
+    explicit D3D11RenderDevice(HWND window);
+    ~D3D11RenderDevice() override;
+
+    // no copy or move operations allowed
+    D3D11RenderDevice(const D3D11RenderDevice&) = delete;
+    D3D11RenderDevice(D3D11RenderDevice&&) = delete;
+    D3D11RenderDevice& operator=(const D3D11RenderDevice&) = delete;
+    D3D11RenderDevice& operator=(D3D11RenderDevice&&) = delete;
+
+    // false if the device or the back buffer could not be created
+    bool IsValid() const noexcept { return m_device != nullptr && m_backBufferView != ViewHandle::Null; }
+
+    BufferHandle CreateBuffer(const BufferDesc& desc, const void* initialData = nullptr) override;
+    TextureHandle CreateTexture(const TextureDesc& desc) override;
+    ViewHandle CreateView(TextureHandle texture, ViewType type) override;
+    ViewHandle CreateView(BufferHandle buffer, ViewType type) override;
+    ShaderHandle CreateShader(const ShaderDesc& desc) override;
+    InputLayoutHandle CreateInputLayout(ShaderHandle vertexShader, const std::vector<VertexElement>& elements) override;
+    DepthStencilStateHandle CreateDepthStencilState(const DepthStencilDesc& desc) override;
+    SamplerStateHandle CreateSamplerState(const SamplerDesc& desc) override;
+    RasterizerStateHandle CreateRasterizerState(const RasterizerDesc& desc) override;
+
+    void Release(BufferHandle buffer) override;
+    void Release(TextureHandle texture) override;
+    void Release(ViewHandle view) override;
+    void Release(ShaderHandle shader) override;
+    void Release(InputLayoutHandle inputLayout) override;
+    void Release(DepthStencilStateHandle state) override;
+    void Release(SamplerStateHandle state) override;
+    void Release(RasterizerStateHandle state) override;
+
+    const BufferDesc* GetDesc(BufferHandle buffer) const noexcept override;
+    const TextureDesc* GetDesc(TextureHandle texture) const noexcept override;
+
+    ViewHandle GetBackBufferView() const noexcept override { return m_backBufferView; }
+    bool ResizeBackBuffer(uint32_t width, uint32_t height) override;
+
+    // for code that works with D3D11 directly (e.g., the frame capture)
+    ID3D11Device* GetDevice() const noexcept { return m_device; }
+    ID3D11DeviceContext* GetDeviceContext() const noexcept { return m_deviceContext; }
+    IDXGISwapChain* GetSwapChain() const noexcept { return m_swapchain; }
+
+private:
+    friend class D3D11RenderContext;
+
+    struct Buffer
+    {
+        BufferDesc desc;
+        ID3D11Buffer* buffer;
+    };
+
+    struct Texture
+    {
+        TextureDesc desc;
+        ID3D11Texture2D* texture;
+    };
+
+    // the view interface matching the type (ID3D11RenderTargetView, ID3D11DepthStencilView, ...)
+    struct View
+    {
+        ViewType type;
+        ID3D11View* view;
+    };
+
+    // the shader interface matching the stage (ID3D11VertexShader, ...), the blob is kept for the input layouts
+    struct Shader
+    {
+        ShaderDesc desc;
+        ID3D10Blob* blob;
+        ID3D11DeviceChild* shader;
+    };
+
+    IDXGISwapChain* m_swapchain;
+    ID3D11Device* m_device;
+    ID3D11DeviceContext* m_deviceContext;
+
+    HandleTable<BufferHandle, Buffer> m_buffers;
+    HandleTable<TextureHandle, Texture> m_textures;
+    HandleTable<ViewHandle, View> m_views;
+    HandleTable<ShaderHandle, Shader> m_shaders;
+    HandleTable<InputLayoutHandle, ID3D11InputLayout*> m_inputLayouts;
+    HandleTable<DepthStencilStateHandle, ID3D11DepthStencilState*> m_depthStencilStates;
+    HandleTable<SamplerStateHandle, ID3D11SamplerState*> m_samplerStates;
+    HandleTable<RasterizerStateHandle, ID3D11RasterizerState*> m_rasterizerStates;
+
+    ViewHandle m_backBufferView;
+};
+
+/**
+ * RenderContext recording into the immediate context of a D3D11RenderDevice.
+ *
+ * The passes are timed with timestamp queries. The queries of the last FRAME_QUERY_COUNT frames are kept in a ring
+ * and read without flushing once they are available, so measuring never stalls the CPU. If the queries of a frame are
+ * still not available when their slot is needed again, its timings are dropped.
+ */
+class D3D11RenderContext : public RenderContext
+{
+public:
+    static constexpr size_t FRAME_QUERY_COUNT = 4;
+
+    explicit D3D11RenderContext(D3D11RenderDevice& device);
+    ~D3D11RenderContext() override;
+
+    // no copy or move operations allowed
+    D3D11RenderContext(const D3D11RenderContext&) = delete;
+    D3D11RenderContext(D3D11RenderContext&&) = delete;
+    D3D11RenderContext& operator=(const D3D11RenderContext&) = delete;
+    D3D11RenderContext& operator=(D3D11RenderContext&&) = delete;
+
+    void SetViewport(float width, float height) override;
+    void SetRasterizerState(RasterizerStateHandle state) override;
+    void SetRenderTargets(uint32_t count, const ViewHandle* renderTargets, ViewHandle depthStencil) override;
+    void SetDepthStencilState(DepthStencilStateHandle state) override;
+    void SetShader(ShaderStage stage, ShaderHandle shader) override;
+    void SetInputLayout(InputLayoutHandle inputLayout) override;
+    void SetVertexBuffer(BufferHandle buffer, uint32_t stride, uint32_t offset) override;
+    void SetPrimitiveTopology(PrimitiveTopology topology) override;
+
+    void SetConstantBuffers(ShaderStage stage, uint32_t slot, uint32_t count, const BufferHandle* buffers) override;
+    void SetShaderResources(ShaderStage stage, uint32_t slot, uint32_t count, const ViewHandle* views) override;
+    void SetUnorderedAccessViews(uint32_t slot, uint32_t count, const ViewHandle* views) override;
+    void SetSamplers(ShaderStage stage, uint32_t slot, uint32_t count, const SamplerStateHandle* samplers) override;
+
+    void ClearRenderTarget(ViewHandle renderTarget, const float color[4]) override;
+    void ClearDepth(ViewHandle depthStencil, float depth) override;
+    void ClearUnorderedAccessView(ViewHandle view, const float values[4]) override;
+
+    void UpdateBuffer(BufferHandle buffer, const void* data, size_t size) override;
+
+    void Dispatch(uint32_t groupsX, uint32_t groupsY, uint32_t groupsZ) override;
+    void DispatchIndirect(BufferHandle arguments, uint32_t offset) override;
+    void Draw(uint32_t vertexCount) override;
+
+    void BeginPass(const char* name) override;
+    void EndPass() override;
+    void Present() override;
+
+    const std::vector<PassTiming>& GetPassTimings() const noexcept override { return m_lastFrameTimings; }
+
+private:
+    static constexpr uint32_t MAX_SLOTS = 8;
+
+    struct PassQueries
+    {
+        std::string name;
+        ID3D11Query* begin;
+        ID3D11Query* end;
+    };
+
+    struct FrameQueries
+    {
+        ID3D11Query* disjoint = nullptr;
+        // the queries are kept and reused, only the first passCount are used by the frame
+        std::vector<PassQueries> passes;
+        size_t passCount = 0;
+        bool pending = false;
+    };
+
+    // view of the given type, nullptr for the null handle or a view of another type
+    template <typename ViewInterface>
+    ViewInterface* GetView(ViewHandle view, ViewType type) const noexcept;
+    ID3D11Buffer* GetBuffer(BufferHandle buffer) const noexcept;
+
+    // reads the timings of the pending frames that are available, oldest first
+    void ResolveTimings();
+
+    D3D11RenderDevice& m_device;
+    ID3D11DeviceContext* m_deviceContext;
+
+    std::array<FrameQueries, FRAME_QUERY_COUNT> m_frames;
+    size_t m_currentFrame;
+    bool m_frameBegun;
+    std::vector<PassTiming> m_lastFrameTimings;
+};
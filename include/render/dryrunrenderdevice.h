@@ -0,0 +1,169 @@
+#pragma once
+
+#include "render/handletable.h"
+#include "render/renderdevice.h"
+#include "util/timer.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * RenderDevice that only keeps the descriptions of the resources, e.g., to measure the memory of a frame or to check
+ * the bindings of a renderer without a GPU.
+ *
+ * The memory of a texture is width * height * texel size and the memory of a buffer its size (without the padding
+ * of a driver). Every shader can be created, nothing is executed.
+ */
+class DryRunRenderDevice : public RenderDevice
+{
+public:
+    // backbuffer of width x height with R8G8B8A8UnormSrgb
+    DryRunRenderDevice(uint32_t width, uint32_t height);
+
+    // no copy or move operations allowed
+    DryRunRenderDevice(const DryRunRenderDevice&) = delete;
+    DryRunRenderDevice(DryRunRenderDevice&&) = delete;
+    DryRunRenderDevice& operator=(const DryRunRenderDevice&) = delete;
+    DryRunRenderDevice& operator=(DryRunRenderDevice&&) = delete;
+
+    BufferHandle CreateBuffer(const BufferDesc& desc, const void* initialData = nullptr) override;
+    TextureHandle CreateTexture(const TextureDesc& desc) override;
+    ViewHandle CreateView(TextureHandle texture, ViewType type) override;
+    ViewHandle CreateView(BufferHandle buffer, ViewType type) override;
+    ShaderHandle CreateShader(const ShaderDesc& desc) override;
+    InputLayoutHandle CreateInputLayout(ShaderHandle vertexShader, const std::vector<VertexElement>& elements) override;
+    DepthStencilStateHandle CreateDepthStencilState(const DepthStencilDesc& desc) override;
+    SamplerStateHandle CreateSamplerState(const SamplerDesc& desc) override;
+    RasterizerStateHandle CreateRasterizerState(const RasterizerDesc& desc) override;
+
+    void Release(BufferHandle buffer) override;
+    void Release(TextureHandle texture) override;
+    void Release(ViewHandle view) override;
+    void Release(ShaderHandle shader) override;
+    void Release(InputLayoutHandle inputLayout) override;
+    void Release(DepthStencilStateHandle state) override;
+    void Release(SamplerStateHandle state) override;
+    void Release(RasterizerStateHandle state) override;
+
+    const BufferDesc* GetDesc(BufferHandle buffer) const noexcept override;
+    const TextureDesc* GetDesc(TextureHandle texture) const noexcept override;
+
+    ViewHandle GetBackBufferView() const noexcept override { return m_backBufferView; }
+    bool ResizeBackBuffer(uint32_t width, uint32_t height) override;
+
+    // bytes of the live textures and buffers, and the maximum since the creation or the last ResetPeakMemory()
+    uint64_t GetMemory() const noexcept { return m_memory; }
+    uint64_t GetPeakMemory() const noexcept { return m_peakMemory; }
+    void ResetPeakMemory() noexcept { m_peakMemory = m_memory; }
+
+    // number of live objects of all types (resources, views, shaders and states, including the back buffer and its view)
+    size_t GetObjectCount() const noexcept;
+
+private:
+    friend class DryRunRenderContext;
+
+    struct View
+    {
+        ViewType type;
+        // the view refers to either a texture or a buffer
+        TextureHandle texture;
+        BufferHandle buffer;
+    };
+
+    void AddMemory(uint64_t bytes) noexcept;
+
+    HandleTable<BufferHandle, BufferDesc> m_buffers;
+    HandleTable<TextureHandle, TextureDesc> m_textures;
+    HandleTable<ViewHandle, View> m_views;
+    HandleTable<ShaderHandle, ShaderDesc> m_shaders;
+    HandleTable<InputLayoutHandle, std::vector<VertexElement>> m_inputLayouts;
+    HandleTable<DepthStencilStateHandle, DepthStencilDesc> m_depthStencilStates;
+    HandleTable<SamplerStateHandle, SamplerDesc> m_samplerStates;
+    HandleTable<RasterizerStateHandle, RasterizerDesc> m_rasterizerStates;
+
+    TextureHandle m_backBuffer;
+    ViewHandle m_backBufferView;
+
+    uint64_t m_memory;
+    uint64_t m_peakMemory;
+};
+
+/**
+ * RenderContext of a DryRunRenderDevice that only tracks the bindings.
+ *
+ * A binding that D3D11 would drop or that unbinds another view is counted (and printed) as a hazard: a resource bound
+ * as SRV while it is bound as UAV, render target or depth-stencil target, the reverse, and DispatchIndirect() with
+ * arguments that are bound as UAV. The pass timings are the CPU times of recording the passes.
+ */
+class DryRunRenderContext : public RenderContext
+{
+public:
+    explicit DryRunRenderContext(DryRunRenderDevice& device);
+
+    // no copy or move operations allowed
+    DryRunRenderContext(const DryRunRenderContext&) = delete;
+    DryRunRenderContext(DryRunRenderContext&&) = delete;
+    DryRunRenderContext& operator=(const DryRunRenderContext&) = delete;
+    DryRunRenderContext& operator=(DryRunRenderContext&&) = delete;
+
+    void SetViewport(float width, float height) override;
+    void SetRasterizerState(RasterizerStateHandle state) override;
+    void SetRenderTargets(uint32_t count, const ViewHandle* renderTargets, ViewHandle depthStencil) override;
+    void SetDepthStencilState(DepthStencilStateHandle state) override;
+    void SetShader(ShaderStage stage, ShaderHandle shader) override;
+    void SetInputLayout(InputLayoutHandle inputLayout) override;
+    void SetVertexBuffer(BufferHandle buffer, uint32_t stride, uint32_t offset) override;
+    void SetPrimitiveTopology(PrimitiveTopology topology) override;
+
+    void SetConstantBuffers(ShaderStage stage, uint32_t slot, uint32_t count, const BufferHandle* buffers) override;
+    void SetShaderResources(ShaderStage stage, uint32_t slot, uint32_t count, const ViewHandle* views) override;
+    void SetUnorderedAccessViews(uint32_t slot, uint32_t count, const ViewHandle* views) override;
+    void SetSamplers(ShaderStage stage, uint32_t slot, uint32_t count, const SamplerStateHandle* samplers) override;
+
+    void ClearRenderTarget(ViewHandle renderTarget, const float color[4]) override;
+    void ClearDepth(ViewHandle depthStencil, float depth) override;
+    void ClearUnorderedAccessView(ViewHandle view, const float values[4]) override;
+
+    void UpdateBuffer(BufferHandle buffer, const void* data, size_t size) override;
+
+    void Dispatch(uint32_t groupsX, uint32_t groupsY, uint32_t groupsZ) override;
+    void DispatchIndirect(BufferHandle arguments, uint32_t offset) override;
+    void Draw(uint32_t vertexCount) override;
+
+    void BeginPass(const char* name) override;
+    void EndPass() override;
+    void Present() override;
+
+    const std::vector<PassTiming>& GetPassTimings() const noexcept override { return m_lastFrameTimings; }
+
+    // hazards since the creation of the context
+    size_t GetHazardCount() const noexcept { return m_hazardCount; }
+
+private:
+    static constexpr uint32_t SLOT_COUNT = 8;
+    static constexpr uint32_t STAGE_COUNT = 3;
+    // the memory a view refers to: texture handle or buffer handle | BUFFER_RESOURCE, 0 for the null view
+    static constexpr uint32_t BUFFER_RESOURCE = 0x80000000u;
+
+    uint32_t GetResource(ViewHandle view) const noexcept;
+    bool IsBoundAsShaderResource(uint32_t resource) const noexcept;
+    bool IsBoundAsUnorderedAccess(uint32_t resource) const noexcept;
+    bool IsBoundAsRenderTarget(uint32_t resource) const noexcept;
+    void ReportHazard(const char* description);
+
+    DryRunRenderDevice& m_device;
+
+    // bound resources (see GetResource())
+    uint32_t m_shaderResources[STAGE_COUNT][SLOT_COUNT];
+    uint32_t m_unorderedAccess[SLOT_COUNT];
+    uint32_t m_renderTargets[SLOT_COUNT];
+    uint32_t m_depthStencil;
+
+    size_t m_hazardCount;
+
+    const char* m_passName;
+    Timer m_passTimer;
+    std::vector<PassTiming> m_frameTimings;
+    std::vector<PassTiming> m_lastFrameTimings;
+};
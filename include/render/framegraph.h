@@ -0,0 +1,207 @@
+#pragma once
+
+#include "render/renderdevice.h"
+#include "render/texturepool.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+// resource of a FrameGraph, only valid until the next Reset()
+enum class FrameGraphResource : uint32_t { Null = 0 };
+
+// views of a resource imported into a FrameGraph, views that are not needed may be null
+struct FrameGraphViews
+{
+    ViewHandle renderTarget = ViewHandle::Null;
+    ViewHandle depthStencil = ViewHandle::Null;
+    ViewHandle shaderResource = ViewHandle::Null;
+    ViewHandle unorderedAccess = ViewHandle::Null;
+};
+
+// counts of the last Compile() and Execute()
+struct FrameGraphStatistics
+{
+    size_t passCount = 0;
+    // passes whose writes are not used by a later pass or an imported resource
+    size_t culledPassCount = 0;
+    size_t transientCount = 0;
+    // textures the transient resources are mapped to (== transientCount without aliasing)
+    size_t physicalCount = 0;
+    // texel bytes of the transient resources, each in its own texture and after aliasing
+    uint64_t transientBytes = 0;
+    uint64_t physicalBytes = 0;
+    // bind calls of Execute(), the unbind calls only set null views
+    size_t bindCalls = 0;
+    size_t unbindCalls = 0;
+};
+
+/**
+ * The passes of a frame with the resources they read and write.
+ *
+ * The passes are recorded every frame: Reset(), create or import the resources, AddPass() for each pass and declare
+ * its accesses, then Compile() and Execute(). Execute() binds the shader resources, UAVs, render targets and
+ * depth-stencil target declared by a pass before calling its function, which only sets the shaders, constant buffers
+ * and states and issues the work. Views of the resources (e.g., for clears) are available through GetView().
+ *
+ * Compile()
+ * - culls passes that do not contribute to an imported resource, the other passes run in the order they were added
+ *   (the dependencies of the accesses only point to earlier passes)
+ * - assigns the transient textures to physical textures: with aliasing, transient textures with the same description
+ *   whose lifetimes (first to last pass accessing them) do not overlap share one texture
+ *
+ * Execute() derives the unbinds from the accesses, so that no resource is bound for reading and writing at the same
+ * time (D3D11 would unbind one of them): before a pass, slots that hold a resource the pass writes (SRVs) or reads
+ * (UAVs, render targets) are set to null unless the pass binds the slot anyway. Views bound to the same physical
+ * texture are treated as the same resource. After the last pass all slots are set to null, so that the textures can be
+ * aliased differently in the next frame.
+ *
+ * Notes:
+ * - the physical textures are acquired from a TexturePool by Compile() and given back by the next Compile(), so
+ *   they are reused by the next frame (and by other users of the pool)
+ * - a write is assumed to keep the parts of the resource it does not cover, so a transient resource must be written
+ *   before it is read (Compile() fails otherwise), but its contents from an earlier frame are undefined
+ * - the memory of a texture is width * height * texel size (without the padding of the driver)
+ */
+class FrameGraph
+{
+public:
+    // number of slots per stage the graph tracks (SRVs, UAVs and render targets)
+    static constexpr uint32_t MAX_SLOTS = 8;
+
+    // declares the accesses of a pass, returned by AddPass()
+    class PassBuilder
+    {
+    public:
+        PassBuilder& ReadShaderResource(FrameGraphResource resource, ShaderStage stage, uint32_t slot);
+        // compute shader UAV, the pass may read the previous contents
+        PassBuilder& WriteUnorderedAccess(FrameGraphResource resource, uint32_t slot);
+        PassBuilder& WriteRenderTarget(FrameGraphResource resource, uint32_t slot);
+        PassBuilder& WriteDepthStencil(FrameGraphResource resource);
+        // accesses without binding, e.g., the arguments of DispatchIndirect(), clears or UpdateBuffer()
+        PassBuilder& Read(FrameGraphResource resource);
+        PassBuilder& Write(FrameGraphResource resource);
+
+    private:
+        friend class FrameGraph;
+
+        PassBuilder(FrameGraph& graph, size_t pass) noexcept : m_graph(graph), m_pass(pass) { }
+
+        FrameGraph& m_graph;
+        size_t m_pass;
+    };
+
+    explicit FrameGraph(TexturePool& pool);
+    // releases the physical textures to the pool
+    ~FrameGraph();
+
+    // no copy or move operations allowed
+    FrameGraph(const FrameGraph&) = delete;
+    FrameGraph(FrameGraph&&) = delete;
+    FrameGraph& operator=(const FrameGraph&) = delete;
+    FrameGraph& operator=(FrameGraph&&) = delete;
+
+    // removes all passes and resources (the physical textures are kept)
+    void Reset();
+
+    // texture that only lives during the frame, the graph creates the views of its bind flags
+    FrameGraphResource CreateTexture(const char* name, const TextureDesc& desc);
+    // texture or buffer owned by the caller
+    FrameGraphResource Import(const char* name, const FrameGraphViews& views);
+
+    // execute is called by Execute() between BeginPass(name) and EndPass()
+    PassBuilder AddPass(const char* name, std::function<void(RenderContext&)> execute);
+
+    // returns false (after printing the error) if an access is invalid or a physical texture could not be created
+    bool Compile();
+    // runs the passes of the last successful Compile()
+    void Execute(RenderContext& context);
+
+    // view of a resource, only valid during Execute()
+    ViewHandle GetView(FrameGraphResource resource, ViewType type) const noexcept;
+
+    // disabling aliasing gives each transient texture its own physical texture (e.g., to compare the memory)
+    void SetAliasingEnabled(bool enabled) noexcept { m_aliasingEnabled = enabled; }
+    bool IsAliasingEnabled() const noexcept { return m_aliasingEnabled; }
+
+    const FrameGraphStatistics& GetStatistics() const noexcept { return m_statistics; }
+
+    // gives the physical textures back to the pool (e.g., to allow it to evict them)
+    void ReleasePhysicalTextures();
+
+private:
+    enum class Access
+    {
+        ShaderResource,
+        UnorderedAccess,
+        RenderTarget,
+        DepthStencil,
+        Read,
+        Write
+    };
+
+    struct PassAccess
+    {
+        FrameGraphResource resource;
+        Access access;
+        ShaderStage stage;
+        uint32_t slot;
+    };
+
+    struct Pass
+    {
+        std::string name;
+        std::function<void(RenderContext&)> execute;
+        std::vector<PassAccess> accesses;
+        bool culled = false;
+    };
+
+    struct Resource
+    {
+        std::string name;
+        // transient textures have a description, imported resources their views
+        bool imported;
+        TextureDesc desc;
+        FrameGraphViews views;
+        // lifetime in passes (index into m_passes), set by Compile()
+        size_t firstPass;
+        size_t lastPass;
+        // index into m_physicalTextures (transient resources accessed by a pass that is not culled)
+        size_t physical;
+    };
+
+    // all accesses except ShaderResource and Read
+    static bool IsWrite(Access access) noexcept;
+
+    Resource* GetResource(FrameGraphResource resource) noexcept;
+    const Resource* GetResource(FrameGraphResource resource) const noexcept;
+    // identity of the memory behind a resource: the physical texture or the imported resource (> 0)
+    uint32_t GetBindingKey(FrameGraphResource resource) const noexcept;
+
+    // acquires the physical textures of the descriptions from the pool (after releasing the ones of the last frame)
+    bool AssignPhysicalTextures(const std::vector<TextureDesc>& descs, const std::vector<const char*>& names);
+    void BindPassResources(RenderContext& context, const Pass& pass);
+    void UnbindAll(RenderContext& context);
+    // bind the slots [first, last] of resources and update the bound resources, null resources unbind the slots
+    void SetShaderResources(RenderContext& context, ShaderStage stage, uint32_t first, uint32_t last, const FrameGraphResource* resources);
+    void SetUnorderedAccessViews(RenderContext& context, uint32_t first, uint32_t last, const FrameGraphResource* resources);
+    void SetRenderTargets(RenderContext& context, const FrameGraphResource* renderTargets, FrameGraphResource depthStencil);
+
+    TexturePool& m_pool;
+    bool m_aliasingEnabled;
+    bool m_compiled;
+
+    std::vector<Pass> m_passes;
+    std::vector<Resource> m_resources;
+    std::vector<PooledTexture> m_physicalTextures;
+
+    // resources bound to the slots during Execute()
+    FrameGraphResource m_boundShaderResources[3][MAX_SLOTS];
+    FrameGraphResource m_boundUnorderedAccess[MAX_SLOTS];
+    FrameGraphResource m_boundRenderTargets[MAX_SLOTS];
+    FrameGraphResource m_boundDepthStencil;
+
+    FrameGraphStatistics m_statistics;
+};
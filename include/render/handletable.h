@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <utility>
+#include <vector>
+
+/**
+ * Objects of a render device addressed by handles (enum class Handle : uint32_t with Null = 0).
+ *
+ * The handle of an object is its index + 1. The slots of removed objects are reused, so a handle must not be used
+ * after its object has been removed.
+ */
+template <typename Handle, typename T>
+class HandleTable
+{
+public:
+    Handle Add(T object)
+    {
+        if (m_free.empty())
+        {
+            m_objects.emplace_back(std::move(object));
+            return static_cast<Handle>(m_objects.size());
+        }
+
+        const uint32_t index = m_free.back();
+        m_free.pop_back();
+        m_objects[index].emplace(std::move(object));
+        return static_cast<Handle>(index + 1);
+    }
+
+    // nullptr for the null handle and removed objects
+    T* Get(Handle handle) noexcept
+    {
+        const uint32_t id = static_cast<uint32_t>(handle);
+        return (id == 0 || id > m_objects.size() || !m_objects[id - 1]) ? nullptr : &*m_objects[id - 1];
+    }
+
+    const T* Get(Handle handle) const noexcept
+    {
+        return const_cast<HandleTable*>(this)->Get(handle);
+    }
+
+    // returns false if there is no object with this handle
+    bool Remove(Handle handle)
+    {
+        if (Get(handle) == nullptr)
+        {
+            return false;
+        }
+
+        const uint32_t index = static_cast<uint32_t>(handle) - 1;
+        m_objects[index].reset();
+        m_free.push_back(index);
+        return true;
+    }
+
+    // number of objects
+    size_t GetSize() const noexcept { return m_objects.size() - m_free.size(); }
+
+    // calls func(handle, object) for all objects
+    template <typename Func>
+    void ForEach(const Func& func)
+    {
+        for (size_t i = 0; i < m_objects.size(); ++i)
+        {
+            if (m_objects[i])
+            {
+                func(static_cast<Handle>(i + 1), *m_objects[i]);
+            }
+        }
+    }
+
+private:
+    std::vector<std::optional<T>> m_objects;
+    std::vector<uint32_t> m_free;
+};
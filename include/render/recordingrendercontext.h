@@ -0,0 +1,102 @@
+#pragma once
+
+#include "render/renderdevice.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// the functions of RenderContext, each one maps to one D3D11 call
+enum class RenderCall
+{
+    SetViewport,
+    SetRasterizerState,
+    SetRenderTargets,
+    SetDepthStencilState,
+    SetShader,
+    SetInputLayout,
+    SetVertexBuffer,
+    SetPrimitiveTopology,
+    SetConstantBuffers,
+    SetShaderResources,
+    SetUnorderedAccessViews,
+    SetSamplers,
+    ClearRenderTarget,
+    ClearDepth,
+    ClearUnorderedAccessView,
+    UpdateBuffer,
+    Dispatch,
+    DispatchIndirect,
+    Draw,
+    BeginPass,
+    EndPass,
+    Present,
+    Count
+};
+
+// name of the RenderContext function
+const char* GetRenderCallName(RenderCall call) noexcept;
+
+/**
+ * RenderContext that counts the calls of each function per frame and forwards them to another context, e.g., a
+ * DryRunRenderContext to count the calls of a renderer without a GPU.
+ *
+ * The counts of a frame are complete after its Present(), which is counted as part of the frame.
+ */
+class RecordingRenderContext : public RenderContext
+{
+public:
+    using CallCounts = std::array<size_t, static_cast<size_t>(RenderCall::Count)>;
+
+    explicit RecordingRenderContext(RenderContext& target);
+
+    // no copy or move operations allowed
+    RecordingRenderContext(const RecordingRenderContext&) = delete;
+    RecordingRenderContext(RecordingRenderContext&&) = delete;
+    RecordingRenderContext& operator=(const RecordingRenderContext&) = delete;
+    RecordingRenderContext& operator=(RecordingRenderContext&&) = delete;
+
+    void SetViewport(float width, float height) override;
+    void SetRasterizerState(RasterizerStateHandle state) override;
+    void SetRenderTargets(uint32_t count, const ViewHandle* renderTargets, ViewHandle depthStencil) override;
+    void SetDepthStencilState(DepthStencilStateHandle state) override;
+    void SetShader(ShaderStage stage, ShaderHandle shader) override;
+    void SetInputLayout(InputLayoutHandle inputLayout) override;
+    void SetVertexBuffer(BufferHandle buffer, uint32_t stride, uint32_t offset) override;
+    void SetPrimitiveTopology(PrimitiveTopology topology) override;
+
+    void SetConstantBuffers(ShaderStage stage, uint32_t slot, uint32_t count, const BufferHandle* buffers) override;
+    void SetShaderResources(ShaderStage stage, uint32_t slot, uint32_t count, const ViewHandle* views) override;
+    void SetUnorderedAccessViews(uint32_t slot, uint32_t count, const ViewHandle* views) override;
+    void SetSamplers(ShaderStage stage, uint32_t slot, uint32_t count, const SamplerStateHandle* samplers) override;
+
+    void ClearRenderTarget(ViewHandle renderTarget, const float color[4]) override;
+    void ClearDepth(ViewHandle depthStencil, float depth) override;
+    void ClearUnorderedAccessView(ViewHandle view, const float values[4]) override;
+
+    void UpdateBuffer(BufferHandle buffer, const void* data, size_t size) override;
+
+    void Dispatch(uint32_t groupsX, uint32_t groupsY, uint32_t groupsZ) override;
+    void DispatchIndirect(BufferHandle arguments, uint32_t offset) override;
+    void Draw(uint32_t vertexCount) override;
+
+    void BeginPass(const char* name) override;
+    void EndPass() override;
+    void Present() override;
+
+    const std::vector<PassTiming>& GetPassTimings() const noexcept override { return m_target.GetPassTimings(); }
+
+    // counts of the last frame, zero until the first Present()
+    const CallCounts& GetLastFrameCallCounts() const noexcept { return m_lastFrameCounts; }
+    size_t GetLastFrameCallCount(RenderCall call) const noexcept { return m_lastFrameCounts[static_cast<size_t>(call)]; }
+    // all calls of the last frame
+    size_t GetLastFrameCallCount() const noexcept;
+
+private:
+    void Count(RenderCall call) noexcept { ++m_frameCounts[static_cast<size_t>(call)]; }
+
+    RenderContext& m_target;
+    CallCounts m_frameCounts;
+    CallCounts m_lastFrameCounts;
+};
@@ -0,0 +1,257 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * Thin abstraction of the parts of ID3D11Device and ID3D11DeviceContext used by the renderer, so that the same frame
+ * can be recorded against D3D11 (d3d11renderdevice.h) or executed without a GPU (cpurenderdevice.h).
+ *
+ * Resources are referred to by handles that are only meaningful for the device that created them. Every call of
+ * RenderContext maps to one D3D11 call, the bind calls keep the D3D11 slot semantics (binding a null handle unbinds
+ * the slot). Shaders are identified by their file and entry point like in D3DX11CompileFromFile(), a backend that
+ * cannot compile HLSL maps them to equivalent kernels.
+ */
+
+enum class BufferHandle : uint32_t { Null = 0 };
+enum class TextureHandle : uint32_t { Null = 0 };
+enum class ViewHandle : uint32_t { Null = 0 };
+enum class ShaderHandle : uint32_t { Null = 0 };
+enum class InputLayoutHandle : uint32_t { Null = 0 };
+enum class DepthStencilStateHandle : uint32_t { Null = 0 };
+enum class SamplerStateHandle : uint32_t { Null = 0 };
+enum class RasterizerStateHandle : uint32_t { Null = 0 };
+
+// the DXGI formats used by the renderer
+enum class Format
+{
+    Unknown,
+    R8G8B8A8Unorm,
+    R8G8B8A8UnormSrgb,
+    R32Uint,
+    R32G32Float,
+    R32G32B32Float,
+    R32G32B32A32Float,
+    D24UnormS8Uint
+};
+
+// size of a texel or vertex element in bytes
+uint32_t GetFormatSize(Format format) noexcept;
+
+// bind flags of buffers and textures (same meaning as D3D11_BIND_FLAG), combined with |
+enum BindFlags : uint32_t
+{
+    BIND_VERTEX_BUFFER = 0x1,
+    BIND_CONSTANT_BUFFER = 0x2,
+    BIND_SHADER_RESOURCE = 0x4,
+    BIND_UNORDERED_ACCESS = 0x8,
+    BIND_RENDER_TARGET = 0x10,
+    BIND_DEPTH_STENCIL = 0x20
+};
+
+enum class ViewType
+{
+    RenderTarget,
+    DepthStencil,
+    ShaderResource,
+    UnorderedAccess
+};
+
+enum class ShaderStage
+{
+    Vertex,
+    Pixel,
+    Compute
+};
+
+enum class PrimitiveTopology
+{
+    TriangleList
+};
+
+enum class ComparisonFunc
+{
+    Never,
+    Less,
+    LessEqual,
+    Always
+};
+
+enum class CullMode
+{
+    None,
+    Front,
+    Back
+};
+
+enum class Filter
+{
+    Point,
+    Linear
+};
+
+enum class AddressMode
+{
+    Wrap,
+    Clamp
+};
+
+struct BufferDesc
+{
+    uint32_t size = 0;
+    uint32_t bindFlags = 0;
+    // updated by the CPU with UpdateBuffer() (D3D11_USAGE_DYNAMIC), otherwise the buffer is written by the GPU
+    bool dynamic = false;
+    // element size of structured buffers, 0 for other buffers
+    uint32_t structureStride = 0;
+    // arguments of DispatchIndirect(), the views of the buffer are raw views of 32-bit values
+    bool indirectArgs = false;
+};
+
+struct TextureDesc
+{
+    uint32_t width = 0;
+    uint32_t height = 0;
+    Format format = Format::Unknown;
+    uint32_t bindFlags = 0;
+};
+
+struct ShaderDesc
+{
+    std::string file;
+    std::string entryPoint;
+    ShaderStage stage = ShaderStage::Vertex;
+};
+
+// element of an input layout (per-vertex data in slot 0)
+struct VertexElement
+{
+    std::string semantic;
+    Format format = Format::Unknown;
+    uint32_t offset = 0;
+};
+
+struct DepthStencilDesc
+{
+    bool depthEnable = true;
+    bool depthWrite = true;
+    ComparisonFunc depthFunc = ComparisonFunc::Less;
+};
+
+struct SamplerDesc
+{
+    Filter filter = Filter::Linear;
+    AddressMode addressMode = AddressMode::Clamp;
+    float maxLod = 1.f;
+};
+
+struct RasterizerDesc
+{
+    CullMode cullMode = CullMode::Back;
+    bool depthClip = true;
+};
+
+// GPU (or CPU) time of a pass of the last completed frame
+struct PassTiming
+{
+    std::string name;
+    double milliseconds;
+};
+
+/**
+ * Creates and releases resources (ID3D11Device and the swapchain).
+ *
+ * Notes:
+ * - the Create functions return the null handle on failure
+ * - releasing a resource invalidates its views, they have to be released before
+ */
+class RenderDevice
+{
+public:
+    virtual ~RenderDevice() = default;
+
+    // initialData may be nullptr, otherwise it has to contain desc.size bytes
+    virtual BufferHandle CreateBuffer(const BufferDesc& desc, const void* initialData = nullptr) = 0;
+    virtual TextureHandle CreateTexture(const TextureDesc& desc) = 0;
+    // views have the format of the texture, and cover the whole buffer (structured or raw views)
+    virtual ViewHandle CreateView(TextureHandle texture, ViewType type) = 0;
+    virtual ViewHandle CreateView(BufferHandle buffer, ViewType type) = 0;
+    virtual ShaderHandle CreateShader(const ShaderDesc& desc) = 0;
+    // the layout is validated against the inputs of the given vertex shader
+    virtual InputLayoutHandle CreateInputLayout(ShaderHandle vertexShader, const std::vector<VertexElement>& elements) = 0;
+    virtual DepthStencilStateHandle CreateDepthStencilState(const DepthStencilDesc& desc) = 0;
+    virtual SamplerStateHandle CreateSamplerState(const SamplerDesc& desc) = 0;
+    virtual RasterizerStateHandle CreateRasterizerState(const RasterizerDesc& desc) = 0;
+
+    virtual void Release(BufferHandle buffer) = 0;
+    virtual void Release(TextureHandle texture) = 0;
+    virtual void Release(ViewHandle view) = 0;
+    virtual void Release(ShaderHandle shader) = 0;
+    virtual void Release(InputLayoutHandle inputLayout) = 0;
+    virtual void Release(DepthStencilStateHandle state) = 0;
+    virtual void Release(SamplerStateHandle state) = 0;
+    virtual void Release(RasterizerStateHandle state) = 0;
+
+    virtual const BufferDesc* GetDesc(BufferHandle buffer) const noexcept = 0;
+    virtual const TextureDesc* GetDesc(TextureHandle texture) const noexcept = 0;
+
+    // render target view of the back buffer, the handle stays the same when the back buffer is resized
+    virtual ViewHandle GetBackBufferView() const noexcept = 0;
+    // all render targets have to be unbound before
+    virtual bool ResizeBackBuffer(uint32_t width, uint32_t height) = 0;
+};
+
+/**
+ * Records the commands of a frame (ID3D11DeviceContext).
+ *
+ * BeginPass() and EndPass() enclose the commands of a named pass, the timings of all passes of a frame are available
+ * once the frame has completed (a few frames after Present() on a GPU).
+ */
+class RenderContext
+{
+public:
+    virtual ~RenderContext() = default;
+
+    // viewport at the origin with the depth range [0, 1]
+    virtual void SetViewport(float width, float height) = 0;
+    virtual void SetRasterizerState(RasterizerStateHandle state) = 0;
+    virtual void SetRenderTargets(uint32_t count, const ViewHandle* renderTargets, ViewHandle depthStencil) = 0;
+    virtual void SetDepthStencilState(DepthStencilStateHandle state) = 0;
+    virtual void SetShader(ShaderStage stage, ShaderHandle shader) = 0;
+    virtual void SetInputLayout(InputLayoutHandle inputLayout) = 0;
+    virtual void SetVertexBuffer(BufferHandle buffer, uint32_t stride, uint32_t offset) = 0;
+    virtual void SetPrimitiveTopology(PrimitiveTopology topology) = 0;
+
+    virtual void SetConstantBuffers(ShaderStage stage, uint32_t slot, uint32_t count, const BufferHandle* buffers) = 0;
+    virtual void SetShaderResources(ShaderStage stage, uint32_t slot, uint32_t count, const ViewHandle* views) = 0;
+    // compute shader UAVs
+    virtual void SetUnorderedAccessViews(uint32_t slot, uint32_t count, const ViewHandle* views) = 0;
+    virtual void SetSamplers(ShaderStage stage, uint32_t slot, uint32_t count, const SamplerStateHandle* samplers) = 0;
+
+    virtual void ClearRenderTarget(ViewHandle renderTarget, const float color[4]) = 0;
+    virtual void ClearDepth(ViewHandle depthStencil, float depth) = 0;
+    virtual void ClearUnorderedAccessView(ViewHandle view, const float values[4]) = 0;
+
+    // replaces the contents of the buffer (Map() with WRITE_DISCARD for dynamic buffers, UpdateSubresource() otherwise)
+    virtual void UpdateBuffer(BufferHandle buffer, const void* data, size_t size) = 0;
+
+    virtual void Dispatch(uint32_t groupsX, uint32_t groupsY, uint32_t groupsZ) = 0;
+    // the three group counts are read from the buffer at the given byte offset
+    virtual void DispatchIndirect(BufferHandle arguments, uint32_t offset) = 0;
+    virtual void Draw(uint32_t vertexCount) = 0;
+
+    // passes must not be nested, name has to stay valid until EndPass()
+    virtual void BeginPass(const char* name) = 0;
+    virtual void EndPass() = 0;
+
+    // presents the back buffer and ends the frame
+    virtual void Present() = 0;
+
+    // passes of the last completed frame in the order of BeginPass(), empty until the first frame has completed
+    virtual const std::vector<PassTiming>& GetPassTimings() const noexcept = 0;
+};
+
+// "name ms | name ms | ..." of the given timings, e.g., for the window title
+std::string FormatPassTimings(const std::vector<PassTiming>& timings);
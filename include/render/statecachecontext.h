@@ -0,0 +1,110 @@
+#pragma once
+
+#include "render/renderdevice.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * RenderContext in front of another context that drops binds of the state that is already bound.
+ *
+ * Filtered are the viewport, the rasterizer and depth-stencil states, the shaders, the input layout, the vertex
+ * buffer, the primitive topology, the constant buffers and the samplers. A range of constant buffers or samplers is
+ * trimmed to the slots that change. The views (SRVs, UAVs and render targets) are always forwarded: D3D11 unbinds
+ * views of resources that are bound for writing, so the cache could not know what is bound (the FrameGraph only binds
+ * the views that change anyway).
+ *
+ * Notes:
+ * - the state is kept across frames, since the state of a D3D11 context persists across Present()
+ * - handles of released objects may be reused by the device, Invalidate() has to be called after releasing (or
+ *   recreating) objects that might still be bound, or after the state was changed without going through the cache
+ */
+class StateCacheContext : public RenderContext
+{
+public:
+    explicit StateCacheContext(RenderContext& target);
+
+    // no copy or move operations allowed
+    StateCacheContext(const StateCacheContext&) = delete;
+    StateCacheContext(StateCacheContext&&) = delete;
+    StateCacheContext& operator=(const StateCacheContext&) = delete;
+    StateCacheContext& operator=(StateCacheContext&&) = delete;
+
+    void SetViewport(float width, float height) override;
+    void SetRasterizerState(RasterizerStateHandle state) override;
+    void SetRenderTargets(uint32_t count, const ViewHandle* renderTargets, ViewHandle depthStencil) override;
+    void SetDepthStencilState(DepthStencilStateHandle state) override;
+    void SetShader(ShaderStage stage, ShaderHandle shader) override;
+    void SetInputLayout(InputLayoutHandle inputLayout) override;
+    void SetVertexBuffer(BufferHandle buffer, uint32_t stride, uint32_t offset) override;
+    void SetPrimitiveTopology(PrimitiveTopology topology) override;
+
+    void SetConstantBuffers(ShaderStage stage, uint32_t slot, uint32_t count, const BufferHandle* buffers) override;
+    void SetShaderResources(ShaderStage stage, uint32_t slot, uint32_t count, const ViewHandle* views) override;
+    void SetUnorderedAccessViews(uint32_t slot, uint32_t count, const ViewHandle* views) override;
+    void SetSamplers(ShaderStage stage, uint32_t slot, uint32_t count, const SamplerStateHandle* samplers) override;
+
+    void ClearRenderTarget(ViewHandle renderTarget, const float color[4]) override;
+    void ClearDepth(ViewHandle depthStencil, float depth) override;
+    void ClearUnorderedAccessView(ViewHandle view, const float values[4]) override;
+
+    void UpdateBuffer(BufferHandle buffer, const void* data, size_t size) override;
+
+    void Dispatch(uint32_t groupsX, uint32_t groupsY, uint32_t groupsZ) override;
+    void DispatchIndirect(BufferHandle arguments, uint32_t offset) override;
+    void Draw(uint32_t vertexCount) override;
+
+    void BeginPass(const char* name) override;
+    void EndPass() override;
+    void Present() override;
+
+    const std::vector<PassTiming>& GetPassTimings() const noexcept override { return m_target.GetPassTimings(); }
+
+    // forgets the bound state, the next bind of each state is forwarded
+    void Invalidate() noexcept;
+
+    // binds that were dropped since the creation of the context (trimmed ranges are forwarded)
+    size_t GetDroppedCallCount() const noexcept { return m_droppedCallCount; }
+
+private:
+    static constexpr uint32_t SLOT_COUNT = 8;
+    static constexpr uint32_t STAGE_COUNT = 3;
+
+    // bound state, valid is false until the first bind (and after Invalidate())
+    template <typename T>
+    struct CachedState
+    {
+        T value;
+        bool valid;
+    };
+
+    struct StageState
+    {
+        CachedState<ShaderHandle> shader;
+        CachedState<BufferHandle> constantBuffers[SLOT_COUNT];
+        CachedState<SamplerStateHandle> samplers[SLOT_COUNT];
+    };
+
+    // returns true if the state changed (and updates it)
+    template <typename T>
+    static bool Update(CachedState<T>& state, const T& value) noexcept;
+    // updates the slots of a range and returns the sub-range [first, last] that changed, false if nothing changed
+    // (slots outside of the cache are always forwarded)
+    template <typename T>
+    static bool UpdateRange(CachedState<T>* states, uint32_t slot, uint32_t count, const T* values, uint32_t& first, uint32_t& last) noexcept;
+
+    RenderContext& m_target;
+
+    CachedState<float> m_viewport[2];
+    CachedState<RasterizerStateHandle> m_rasterizerState;
+    CachedState<DepthStencilStateHandle> m_depthStencilState;
+    CachedState<InputLayoutHandle> m_inputLayout;
+    CachedState<BufferHandle> m_vertexBuffer;
+    CachedState<uint32_t> m_vertexStride;
+    CachedState<uint32_t> m_vertexOffset;
+    CachedState<PrimitiveTopology> m_primitiveTopology;
+    StageState m_stages[STAGE_COUNT];
+
+    size_t m_droppedCallCount;
+};
@@ -0,0 +1,98 @@
+#pragma once
+
+#include "render/renderdevice.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// texture of a TexturePool with a view for each of its bind flags (the other views are null)
+struct PooledTexture
+{
+    TextureDesc desc;
+    TextureHandle texture = TextureHandle::Null;
+    ViewHandle renderTarget = ViewHandle::Null;
+    ViewHandle depthStencil = ViewHandle::Null;
+    ViewHandle shaderResource = ViewHandle::Null;
+    ViewHandle unorderedAccess = ViewHandle::Null;
+};
+
+struct TexturePoolStatistics
+{
+    // Acquire() calls served by a texture of the pool and calls that created a texture (since ResetStatistics())
+    size_t hits = 0;
+    size_t misses = 0;
+    // textures released by EndFrame() because they were not used for too long
+    size_t evictions = 0;
+    // textures held by the pool (in use or not) and their memory (width * height * texel size)
+    size_t textureCount = 0;
+    size_t inUseCount = 0;
+    uint64_t bytes = 0;
+};
+
+/**
+ * Recycles textures and their views, e.g., for the transient render targets of a FrameGraph.
+ *
+ * Acquire() returns a texture with the given description that is not in use, or creates one. Release() gives it back
+ * to the pool, where it is kept for later frames (and for returning to an earlier size after a resize). EndFrame()
+ * ends a frame and releases the textures that have not been used for maxUnusedFrames frames.
+ *
+ * Notes:
+ * - the textures are looked up by a hash of their description (width, height, format and bind flags)
+ * - all textures are released by the destructor, also the ones still in use
+ */
+class TexturePool
+{
+public:
+    // frames a texture is kept without being used
+    static constexpr uint32_t DEFAULT_MAX_UNUSED_FRAMES = 8;
+
+    explicit TexturePool(RenderDevice& device, uint32_t maxUnusedFrames = DEFAULT_MAX_UNUSED_FRAMES);
+    ~TexturePool();
+
+    // no copy or move operations allowed
+    TexturePool(const TexturePool&) = delete;
+    TexturePool(TexturePool&&) = delete;
+    TexturePool& operator=(const TexturePool&) = delete;
+    TexturePool& operator=(TexturePool&&) = delete;
+
+    // the texture is null (after printing the error) if it could not be created
+    PooledTexture Acquire(const TextureDesc& desc);
+    // the texture may be acquired again in the same frame
+    void Release(const PooledTexture& texture);
+
+    // releases the textures that have not been acquired or released for maxUnusedFrames frames
+    void EndFrame();
+    // releases all textures that are not in use (e.g., after a resize that will not be undone)
+    void Trim();
+
+    const TexturePoolStatistics& GetStatistics() const noexcept { return m_statistics; }
+    // resets the hits, misses and evictions
+    void ResetStatistics() noexcept;
+
+private:
+    struct Entry
+    {
+        PooledTexture texture;
+        bool inUse;
+        // frame of the last Acquire() or Release()
+        uint64_t lastUsedFrame;
+    };
+
+    static uint64_t GetKey(const TextureDesc& desc) noexcept;
+    // releases the texture and removes it from its bucket
+    void Destroy(std::vector<Entry>& bucket, size_t index);
+    // removes the entries that match from all buckets
+    template <typename Predicate>
+    void DestroyIf(const Predicate& predicate);
+
+    RenderDevice& m_device;
+    uint32_t m_maxUnusedFrames;
+    uint64_t m_frame;
+
+    // textures by the hash of their description, a bucket may contain textures of different descriptions
+    std::unordered_map<uint64_t, std::vector<Entry>> m_textures;
+
+    TexturePoolStatistics m_statistics;
+};
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+/**
+ * Blocking FIFO queue with a fixed capacity for passing work between the threads of a pipeline.
+ *
+ * The items are stored in a ring buffer that is allocated once, so T has to be default constructible.
+ */
+template <typename T>
+class BoundedQueue
+{
+public:
+    explicit BoundedQueue(size_t capacity)
+        : m_items(capacity > 0 ? capacity : 1)
+        , m_first(0)
+        , m_count(0)
+        , m_closed(false)
+    {
+    }
+
+    // no copy or move operations allowed
+    BoundedQueue(const BoundedQueue& other) = delete;
+    BoundedQueue(BoundedQueue&& other) = delete;
+    BoundedQueue& operator=(const BoundedQueue& other) = delete;
+    BoundedQueue& operator=(BoundedQueue&& other) = delete;
+
+    // waits while the queue is full, returns false (and drops value) if the queue has been closed
+    bool Push(T value)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_notFull.wait(lock, [this] { return m_closed || m_count < m_items.size(); });
+        if (m_closed)
+        {
+            return false;
+        }
+
+        m_items[(m_first + m_count) % m_items.size()] = std::move(value);
+        ++m_count;
+        lock.unlock();
+        m_notEmpty.notify_one();
+        return true;
+    }
+
+    // waits while the queue is empty, returns false once the queue has been closed and all items are taken
+    bool Pop(T& value)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_notEmpty.wait(lock, [this] { return m_closed || m_count > 0; });
+        if (m_count == 0)
+        {
+            return false;
+        }
+
+        value = std::move(m_items[m_first]);
+        m_first = (m_first + 1) % m_items.size();
+        --m_count;
+        lock.unlock();
+        m_notFull.notify_one();
+        return true;
+    }
+
+    // no more items will be pushed, waiting threads are released
+    void Close()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_closed = true;
+        }
+        m_notEmpty.notify_all();
+        m_notFull.notify_all();
+    }
+
+private:
+    std::vector<T> m_items;
+    size_t m_first;
+    size_t m_count;
+    std::mutex m_mutex;
+    std::condition_variable m_notEmpty;
+    std::condition_variable m_notFull;
+    bool m_closed;
+};
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+constexpr uint64_t HASH_SEED = 0xcbf29ce484222325ull;
+
+// mixes value into seed (64-bit variant of boost::hash_combine)
+inline uint64_t HashCombine(uint64_t seed, uint64_t value) noexcept
+{
+    return seed ^ (value + 0x9e3779b97f4a7c15ull + (seed << 12) + (seed >> 4));
+}
+
+/**
+ * Non-cryptographic 64-bit hash of a block of memory.
+ *
+ * Processes 32 bytes per step in four independent lanes, which is fast enough to hash render targets every
+ * frame. Note that the hash is computed over the raw bytes, so structs have to be free of uninitialized padding.
+ */
+inline uint64_t HashBytes(const void* data, size_t size, uint64_t seed = HASH_SEED) noexcept
+{
+    constexpr uint64_t MULTIPLIER = 0x100000001b3ull;
+
+    auto mix = [](uint64_t hash, uint64_t word)
+    {
+        hash = (hash ^ word) * MULTIPLIER;
+        return hash ^ (hash >> 29);
+    };
+
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    uint64_t lanes[4] = { seed ^ (size * MULTIPLIER), seed + 1, seed + 2, seed + 3 };
+
+    size_t i = 0;
+    for (; i + 32 <= size; i += 32)
+    {
+        uint64_t words[4];
+        std::memcpy(words, bytes + i, 32);
+        for (int lane = 0; lane < 4; ++lane)
+        {
+            lanes[lane] = mix(lanes[lane], words[lane]);
+        }
+    }
+
+    uint64_t hash = lanes[0];
+    for (int lane = 1; lane < 4; ++lane)
+    {
+        hash = HashCombine(hash, lanes[lane]);
+    }
+    for (; i + 8 <= size; i += 8)
+    {
+        uint64_t word;
+        std::memcpy(&word, bytes + i, 8);
+        hash = mix(hash, word);
+    }
+    for (; i < size; ++i)
+    {
+        hash = (hash ^ bytes[i]) * MULTIPLIER;
+    }
+
+    // final avalanche (from MurmurHash3)
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdull;
+    hash ^= hash >> 33;
+
+    return hash;
+}
+
+template <typename T>
+inline uint64_t HashValue(const T& value, uint64_t seed = HASH_SEED) noexcept
+{
+    return HashBytes(&value, sizeof(T), seed);
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstdint>
+
+struct Resolution
+{
+    uint32_t width;
+    uint32_t height;
+};
+
+// number of thread groups needed to cover threadCount threads (rounds up, so partial groups are dispatched as well)
+constexpr uint32_t DispatchGroupCount(uint32_t threadCount, uint32_t groupSize) noexcept
+{
+    return (threadCount + groupSize - 1) / groupSize;
+}
+
+/**
+ * Computes the internal render resolution for the given output resolution and scale.
+ *
+ * Notes:
+ * - width and height are rounded down to even values so that the half-res bloom targets cover the scene exactly
+ * - the result is clamped to [2, outputSize] in each dimension
+ */
+Resolution ComputeScaledResolution(const Resolution& outputResolution, float scale) noexcept;
+
+// scales the internal resolution with the measured frame times in order to hold a frame time budget
+class DynamicResolutionController
+{
+public:
+    struct Settings
+    {
+        // frame time budget in milliseconds
+        float targetFrameTimeMilliseconds = 1000.f / 60.f;
+        // range for the scale factor applied to width and height
+        float minScale = 0.5f;
+        float maxScale = 1.f;
+        // scales are quantized to multiples of this step so that small fluctuations do not change the resolution
+        float scaleStep = 0.05f;
+        // the resolution is only increased if the smoothed frame time is below (1 - headroom) * budget, and only as far as
+        // the frame time is expected to stay below it
+        float headroom = 0.1f;
+        // weight of the newest frame time in the exponential moving average, in (0, 1]
+        float smoothing = 0.2f;
+        // number of frames to wait after a scale change before the next one (measured frame times lag behind)
+        uint32_t cooldownFrames = 8;
+    };
+
+    DynamicResolutionController() noexcept;
+    explicit DynamicResolutionController(const Settings& settings) noexcept;
+
+    // feeds the measured time of the last frame and returns the scale to be used for the next frame
+    float Update(float frameTimeMilliseconds) noexcept;
+
+    // restarts at the max. scale and discards the frame time history
+    void Reset() noexcept;
+
+    float GetScale() const noexcept { return m_scale; }
+    float GetSmoothedFrameTimeMilliseconds() const noexcept { return m_smoothedFrameTime; }
+    const Settings& GetSettings() const noexcept { return m_settings; }
+
+private:
+    float QuantizeScale(float scale) const noexcept;
+
+    Settings m_settings;
+    float m_scale;
+    float m_smoothedFrameTime;
+    uint32_t m_framesSinceChange;
+    bool m_hasHistory;
+};
\ No newline at end of file
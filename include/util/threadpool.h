@@ -0,0 +1,61 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// fixed-size pool of worker threads for data-parallel CPU work
+class ThreadPool
+{
+public:
+    // threadCount = 0 uses one thread per hardware thread (the calling thread counts as one of them)
+    explicit ThreadPool(size_t threadCount = 0);
+    ~ThreadPool();
+
+    // no copy or move operations allowed
+    ThreadPool(const ThreadPool& other) = delete;
+    ThreadPool(ThreadPool&& other) = delete;
+    ThreadPool& operator=(const ThreadPool& other) = delete;
+    ThreadPool& operator=(ThreadPool&& other) = delete;
+
+    // number of threads working on a ParallelFor (workers + calling thread)
+    size_t GetThreadCount() const noexcept { return m_workers.size() + 1; }
+
+    /**
+     * Splits [begin, end) into chunks of at most grainSize elements and calls func(chunkBegin, chunkEnd) for each of them.
+     *
+     * Notes:
+     * - the calling thread works on chunks as well and the function returns once all chunks are done
+     * - may be called from within a task of the same pool (the calling thread then processes the chunks itself)
+     */
+    void ParallelFor(size_t begin, size_t end, size_t grainSize, const std::function<void(size_t, size_t)>& func);
+
+    // enqueues a task that is executed asynchronously by one of the workers
+    void Submit(std::function<void()> task);
+
+private:
+    void WorkerLoop();
+
+    std::vector<std::thread> m_workers;
+    std::deque<std::function<void()>> m_tasks;
+    std::mutex m_mutex;
+    std::condition_variable m_taskAvailable;
+    bool m_shutdown;
+};
+
+// calls func(chunkBegin, chunkEnd) on the given pool, or serially for the whole range if pool is nullptr
+inline void ParallelFor(ThreadPool* pool, size_t begin, size_t end, size_t grainSize, const std::function<void(size_t, size_t)>& func)
+{
+    if (pool != nullptr)
+    {
+        pool->ParallelFor(begin, end, grainSize, func);
+    }
+    else if (begin < end)
+    {
+        func(begin, end);
+    }
+}
@@ -57,7 +57,7 @@ struct Vec3
 
     static float Length(const Vec3& vec) noexcept
     {
-        return std::sqrtf(Dot(vec, vec));
+        return std::sqrt(Dot(vec, vec));
     }
 
     static Vec3 Cross(const Vec3& a, const Vec3& b) noexcept
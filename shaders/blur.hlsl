@@ -1,6 +1,9 @@
 #define GAUSSIAN_RADIUS 7
+#define BLOOM_TILE_SIZE 8
 
 Texture2D<float4> inputTexture : register(t0);
+// packed tile coordinates (x | y << 16) for BlurTiles
+StructuredBuffer<uint> tileList : register(t1);
 RWTexture2D<float4> outputTexture : register(u0);
 
 cbuffer BlurParams : register(b0)
@@ -9,12 +12,17 @@ cbuffer BlurParams : register(b0)
     float4 coefficients[(GAUSSIAN_RADIUS + 1) / 4];
     // radius <= GAUSSIAN_RADIUS, direction 0 = horizontal, 1 = vertical
     int2 radiusAndDirection;
+    // size of the region to blur, texels outside of it are treated as zero
+    int2 size;
 }
 
-[numthreads(8, 8, 1)]
-void Blur(uint3 groupID : SV_GroupID, uint3 groupThreadID : SV_GroupThreadID, uint groupIndex : SV_GroupIndex, uint3 dispatchID : SV_DispatchThreadID)
+void BlurPixel(int2 pixel)
 {
-    int2 pixel = int2(dispatchID.x, dispatchID.y);
+    // the last thread groups may extend beyond the region
+    if (any(pixel >= size))
+    {
+        return;
+    }
 
     int radius = radiusAndDirection.x;
     int2 dir = int2(1 - radiusAndDirection.y, radiusAndDirection.y);
@@ -24,8 +32,27 @@ void Blur(uint3 groupID : SV_GroupID, uint3 groupThreadID : SV_GroupThreadID, ui
     for (int i = -radius; i <= radius; ++i)
     {
         uint cIndex = (uint) abs(i);
-        accumulatedValue += coefficients[cIndex >> 2][cIndex & 3] * inputTexture[mad(i, dir, pixel)];
+        int2 samplePixel = mad(i, dir, pixel);
+        // the texture may be larger than the region (dynamic resolution), so we cannot rely on out-of-bounds reads returning zero
+        float inside = (float) all(samplePixel >= 0 && samplePixel < size);
+        accumulatedValue += inside * coefficients[cIndex >> 2][cIndex & 3] * inputTexture[samplePixel];
     }
 
     outputTexture[pixel] = accumulatedValue;
-}
\ No newline at end of file
+}
+
+[numthreads(8, 8, 1)]
+void Blur(uint3 groupID : SV_GroupID, uint3 groupThreadID : SV_GroupThreadID, uint groupIndex : SV_GroupIndex, uint3 dispatchID : SV_DispatchThreadID)
+{
+    BlurPixel(int2(dispatchID.x, dispatchID.y));
+}
+
+// sparse variant: one thread group per entry of tileList, dispatched indirectly with the number of tiles
+[numthreads(BLOOM_TILE_SIZE, BLOOM_TILE_SIZE, 1)]
+void BlurTiles(uint3 groupID : SV_GroupID, uint3 groupThreadID : SV_GroupThreadID)
+{
+    uint packedTile = tileList[groupID.x];
+    int2 tile = int2(packedTile & 0xffff, packedTile >> 16);
+
+    BlurPixel(tile * BLOOM_TILE_SIZE + int2(groupThreadID.xy));
+}
@@ -15,6 +15,10 @@ Texture2D tex1 : register(t1);
 
 cbuffer CompositeParams: register(b0)
 {
+    // scale from output texture coordinates to the rendered region of tex0 and tex1
+    float2 uvScale;
+    // max. texture coordinate for tex1 so that bilinear filtering does not pick up texels outside of the rendered region
+    float2 bloomUVMax;
     float coefficient;
 }
 
@@ -33,6 +37,9 @@ VertexPosTexCoordOut VSMain(VertexPosTexCoordIn v)
 // pixel shader
 float4 PSMain(VertexPosTexCoordOut p) : SV_TARGET
 {
+    float2 sceneUV = p.tex * uvScale;
+    float2 bloomUV = min(sceneUV, bloomUVMax);
+
     // output: tex0 + coefficient * tex1
-    return mad(coefficient, tex1.Sample(texSampler, p.tex), tex0.Sample(texSampler, p.tex));
+    return mad(coefficient, tex1.Sample(texSampler, bloomUV), tex0.Sample(texSampler, sceneUV));
 }
\ No newline at end of file
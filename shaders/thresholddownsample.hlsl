@@ -1,25 +1,55 @@
 Texture2D<float4> inputTexture : register(t0);
 RWTexture2D<float4> outputTexture : register(u0);
+// per 8x8 tile: 1 if any pixel of the tile passed the threshold (optional, writes are discarded if nothing is bound)
+RWStructuredBuffer<uint> tileMask : register(u1);
 
 cbuffer ThresholdParams: register(b0)
 {
     float threshold;
+    // size of the half-res output region
+    int2 outputSize;
+    // number of tiles (= thread groups) per row of tileMask
+    int tileCountX;
 }
 
+groupshared uint anyBrightPixel;
+
 [numthreads(8, 8, 1)]
 void ThresholdAndDownsample(uint3 groupID : SV_GroupID, uint3 groupThreadID : SV_GroupThreadID, uint groupIndex : SV_GroupIndex, uint3 dispatchID : SV_DispatchThreadID)
 {
+    if (groupIndex == 0)
+    {
+        anyBrightPixel = 0;
+    }
+    GroupMemoryBarrierWithGroupSync();
+
     // output pixel in half resolution
     uint2 pixel = uint2(dispatchID.x, dispatchID.y);
 
-    // bilinear interpolation for downsampling
-    uint2 inPixel = pixel * 2;
-    float4 hIntensity0 = lerp(inputTexture[inPixel], inputTexture[inPixel + uint2(1, 0)], 0.5);
-    float4 hIntensity1 = lerp(inputTexture[inPixel + uint2(0, 1)], inputTexture[inPixel + uint2(1, 1)], 0.5);
-    float4 intensity = lerp(hIntensity0, hIntensity1, 0.5);
+    // the last thread groups may extend beyond the output region
+    // (no early return here since all threads of the group have to reach the barrier below)
+    if (all(pixel < (uint2) outputSize))
+    {
+        // bilinear interpolation for downsampling
+        uint2 inPixel = pixel * 2;
+        float4 hIntensity0 = lerp(inputTexture[inPixel], inputTexture[inPixel + uint2(1, 0)], 0.5);
+        float4 hIntensity1 = lerp(inputTexture[inPixel + uint2(0, 1)], inputTexture[inPixel + uint2(1, 1)], 0.5);
+        float4 intensity = lerp(hIntensity0, hIntensity1, 0.5);
+
+        // thresholding on downsampled value
+        float intensityTest = (float)(length(intensity.rgb) > threshold);
 
-    // thresholding on downsampled value
-    float intensityTest = (float)(length(intensity.rgb) > threshold);
+        outputTexture[pixel] = float4(intensityTest * intensity. rgb, 1.0);
 
-    outputTexture[pixel] = float4(intensityTest * intensity. rgb, 1.0);
-}
\ No newline at end of file
+        if (intensityTest > 0.0)
+        {
+            InterlockedOr(anyBrightPixel, 1);
+        }
+    }
+    GroupMemoryBarrierWithGroupSync();
+
+    if (groupIndex == 0)
+    {
+        tileMask[groupID.y * tileCountX + groupID.x] = anyBrightPixel;
+    }
+}
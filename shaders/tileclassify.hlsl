@@ -0,0 +1,56 @@
+// per tile: 1 if any pixel of the tile passed the threshold
+StructuredBuffer<uint> tileMask : register(t0);
+
+// compacted lists of packed tile coordinates (x | y << 16) for the horizontal and vertical blur pass
+RWStructuredBuffer<uint> horizontalTiles : register(u0);
+RWStructuredBuffer<uint> verticalTiles : register(u1);
+// two sets of DispatchIndirect() arguments (horizontal at offset 0, vertical at offset 12), the x-counts have to be reset to 0
+RWByteAddressBuffer dispatchArgs : register(u2);
+
+cbuffer TileClassifyParams : register(b0)
+{
+    int2 tileCount;
+    // blur radius in tiles
+    int tileRadius;
+}
+
+[numthreads(64, 1, 1)]
+void ClassifyTiles(uint3 dispatchID : SV_DispatchThreadID)
+{
+    int tileIndex = (int) dispatchID.x;
+    if (tileIndex >= tileCount.x * tileCount.y)
+    {
+        return;
+    }
+
+    int2 tile = int2(tileIndex % tileCount.x, tileIndex / tileCount.x);
+
+    // the horizontal pass is needed for tiles within the radius of a bright tile in x, the vertical pass in x and y
+    bool horizontal = false;
+    bool vertical = false;
+    for (int dy = -tileRadius; dy <= tileRadius; ++dy)
+    {
+        for (int dx = -tileRadius; dx <= tileRadius; ++dx)
+        {
+            int2 neighbor = tile + int2(dx, dy);
+            if (all(neighbor >= 0 && neighbor < tileCount) && tileMask[neighbor.y * tileCount.x + neighbor.x] != 0)
+            {
+                vertical = true;
+                horizontal = horizontal || (dy == 0);
+            }
+        }
+    }
+
+    uint packedTile = (uint) tile.x | ((uint) tile.y << 16);
+    uint slot;
+    if (horizontal)
+    {
+        dispatchArgs.InterlockedAdd(0, 1, slot);
+        horizontalTiles[slot] = packedTile;
+    }
+    if (vertical)
+    {
+        dispatchArgs.InterlockedAdd(12, 1, slot);
+        verticalTiles[slot] = packedTile;
+    }
+}
@@ -0,0 +1,397 @@
+#include "capture/sharedframering.h"
+#include "cpu/batchbloom.h"
+#include "cpu/framestream.h"
+#include "cpu/imagefile.h"
+#include "util/threadpool.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#endif
+
+namespace
+{
+    struct BatchOptions
+    {
+        std::string input;
+        std::string outputDirectory;
+        // extension of the output files (without the dot), empty = same as the input file
+        std::string outputFormat;
+        // first index of a frame sequence
+        uint32_t firstFrame = 0;
+        float threshold;
+        float compositeCoefficient;
+        float sigma = 10.f;
+        int radius = GAUSSIAN_RADIUS;
+        BatchBloomPipeline::Settings pipelineSettings;
+        // stream mode (input and output "-"): frame size of raw RGBA frames (0 = Y4M), threads for the bloom
+        uint32_t streamWidth = 0;
+        uint32_t streamHeight = 0;
+        uint32_t streamThreads = 0;
+        // stream mode with the output "shm:<name>": number of slots of the shared memory ring
+        uint32_t sharedMemorySlots = 3;
+    };
+
+    // prefix of the output for publishing the frames of stream mode in a shared memory ring
+    constexpr char SHARED_MEMORY_PREFIX[] = "shm:";
+
+    bool IsStreamMode(const BatchOptions& options)
+    {
+        return options.input == "-";
+    }
+
+    // name of the shared memory object for the output, empty if the output is not a shared memory ring
+    std::string GetSharedMemoryName(const BatchOptions& options)
+    {
+        const size_t prefixLength = sizeof(SHARED_MEMORY_PREFIX) - 1;
+        if (options.outputDirectory.compare(0, prefixLength, SHARED_MEMORY_PREFIX) != 0)
+        {
+            return std::string();
+        }
+        return options.outputDirectory.substr(prefixLength);
+    }
+
+    void PrintUsage()
+    {
+        std::cerr << "usage: bloom_batch <input> <output directory> [options]\n"
+            "       bloom_batch - - [--size WxH] [--threads N] [bloom options]\n"
+            "       bloom_batch - shm:/<name> --size WxH [--slots N] [--threads N] [bloom options]\n\n"
+            "input is either a directory (all .ppm, .pam, .rgba and .qoi files are processed) or a frame sequence with a run of #\n"
+            "as the placeholder for the zero-padded frame index (e.g. frames/shot_####.ppm)\n\n"
+            "with - - frames are read from stdin and written to stdout: raw RGBA frames of the given size\n"
+            "(ffmpeg -f rawvideo -pix_fmt rgba) or, without --size, Y4M with 8-bit 4:2:0 or 4:4:4 frames (ffmpeg -f yuv4mpegpipe)\n\n"
+            "with shm:/<name> as the output, the raw RGBA frames are published in a POSIX shared memory ring instead of stdout\n"
+            "for other processes (see bloom_shm_consumer)\n\n"
+            "options:\n"
+            "  --threshold T        bloom threshold (default 0.5)\n"
+            "  --coefficient C      composite coefficient (default 0.75)\n"
+            "  --sigma S            sigma of the Gaussian blur in half-res pixels (default 10)\n"
+            "  --radius R           radius of the Gaussian blur in half-res pixels, at most " << GAUSSIAN_RADIUS << " (default " << GAUSSIAN_RADIUS << ")\n"
+            "  --first N            first index of a frame sequence (default 0)\n"
+            "  --format F           format of the output files: ppm, pam, rgba or qoi (default: same as the input)\n"
+            "  --decode-threads N   worker threads for decoding (default 1)\n"
+            "  --bloom-threads N    worker threads for the bloom, 0 = one per hardware thread (default 0)\n"
+            "  --encode-threads N   worker threads for encoding (default 1)\n"
+            "  --queue N            max. number of frames waiting between two stages (default 4)\n"
+            "  --size WxH           stream mode: size of the raw RGBA frames\n"
+            "  --threads N          stream mode: threads for the bloom, 0 = one per hardware thread (default 0)\n"
+            "  --slots N            stream mode: number of frames in the shared memory ring (default 3)\n";
+    }
+
+    // expands a frame sequence pattern with a run of '#' for the given index, returns an empty string if there is no '#'
+    std::string ExpandFramePattern(const std::string& pattern, uint32_t index)
+    {
+        const size_t begin = pattern.find('#');
+        if (begin == std::string::npos)
+        {
+            return std::string();
+        }
+        const size_t end = pattern.find_first_not_of('#', begin);
+        const size_t digits = ((end == std::string::npos) ? pattern.size() : end) - begin;
+
+        std::string number = std::to_string(index);
+        if (number.size() < digits)
+        {
+            number.insert(0, digits - number.size(), '0');
+        }
+        return pattern.substr(0, begin) + number + pattern.substr(begin + digits);
+    }
+
+    // collects the input files, a frame sequence ends at the first missing index
+    std::vector<std::string> CollectInputFiles(const BatchOptions& options)
+    {
+        std::vector<std::string> files;
+        std::error_code errorCode;
+        if (std::filesystem::is_directory(options.input, errorCode))
+        {
+            for (const std::filesystem::directory_entry& entry : std::filesystem::directory_iterator(options.input, errorCode))
+            {
+                const std::string path = entry.path().string();
+                if (entry.is_regular_file(errorCode) && IsSupportedImageFile(path))
+                {
+                    files.push_back(path);
+                }
+            }
+            std::sort(files.begin(), files.end());
+        }
+        else
+        {
+            for (uint32_t index = options.firstFrame; ; ++index)
+            {
+                const std::string path = ExpandFramePattern(options.input, index);
+                if (path.empty() || !std::filesystem::is_regular_file(path, errorCode))
+                {
+                    break;
+                }
+                files.push_back(path);
+            }
+        }
+        return files;
+    }
+
+    bool ParseOptions(int argc, char* argv[], BatchOptions& options)
+    {
+        if (argc < 3)
+        {
+            return false;
+        }
+
+        const BloomSettings defaultSettings = CreateDefaultBloomSettings();
+        options.threshold = defaultSettings.threshold;
+        options.compositeCoefficient = defaultSettings.compositeCoefficient;
+        options.input = argv[1];
+        options.outputDirectory = argv[2];
+
+        for (int i = 3; i + 1 < argc; i += 2)
+        {
+            const char* value = argv[i + 1];
+            const uint32_t count = static_cast<uint32_t>(std::strtoul(value, nullptr, 10));
+
+            if (std::strcmp(argv[i], "--threshold") == 0)
+            {
+                options.threshold = std::strtof(value, nullptr);
+            }
+            else if (std::strcmp(argv[i], "--coefficient") == 0)
+            {
+                options.compositeCoefficient = std::strtof(value, nullptr);
+            }
+            else if (std::strcmp(argv[i], "--sigma") == 0)
+            {
+                options.sigma = std::strtof(value, nullptr);
+            }
+            else if (std::strcmp(argv[i], "--radius") == 0)
+            {
+                options.radius = static_cast<int>(count);
+            }
+            else if (std::strcmp(argv[i], "--first") == 0)
+            {
+                options.firstFrame = count;
+            }
+            else if (std::strcmp(argv[i], "--format") == 0)
+            {
+                options.outputFormat = value;
+            }
+            else if (std::strcmp(argv[i], "--decode-threads") == 0)
+            {
+                options.pipelineSettings.decodeThreads = count;
+            }
+            else if (std::strcmp(argv[i], "--bloom-threads") == 0)
+            {
+                options.pipelineSettings.bloomThreads = count;
+            }
+            else if (std::strcmp(argv[i], "--encode-threads") == 0)
+            {
+                options.pipelineSettings.encodeThreads = count;
+            }
+            else if (std::strcmp(argv[i], "--queue") == 0)
+            {
+                options.pipelineSettings.queueCapacity = count;
+            }
+            else if (std::strcmp(argv[i], "--size") == 0)
+            {
+                char* end = nullptr;
+                options.streamWidth = static_cast<uint32_t>(std::strtoul(value, &end, 10));
+                options.streamHeight = (*end == 'x') ? static_cast<uint32_t>(std::strtoul(end + 1, nullptr, 10)) : 0;
+                if (options.streamWidth < 2 || options.streamHeight < 2 || options.streamWidth > MAX_FRAME_STREAM_SIZE
+                    || options.streamHeight > MAX_FRAME_STREAM_SIZE)
+                {
+                    std::cerr << "Invalid frame size " << value << "\n";
+                    return false;
+                }
+            }
+            else if (std::strcmp(argv[i], "--threads") == 0)
+            {
+                options.streamThreads = count;
+            }
+            else if (std::strcmp(argv[i], "--slots") == 0)
+            {
+                options.sharedMemorySlots = std::max(count, 1u);
+            }
+            else
+            {
+                std::cerr << "Unknown option " << argv[i] << "\n";
+                return false;
+            }
+        }
+
+        if (IsStreamMode(options) != (options.outputDirectory == "-" || !GetSharedMemoryName(options).empty()))
+        {
+            std::cerr << "stream mode needs - as input and - or shm:/<name> as output\n";
+            return false;
+        }
+        if (!GetSharedMemoryName(options).empty() && options.streamWidth == 0)
+        {
+            std::cerr << "the shared memory output needs raw RGBA frames (--size WxH)\n";
+            return false;
+        }
+        if (!(options.sigma > 0.f))
+        {
+            std::cerr << "sigma has to be positive\n";
+            return false;
+        }
+        if (!options.outputFormat.empty() && !IsSupportedImageFile("." + options.outputFormat))
+        {
+            std::cerr << "Unsupported output format " << options.outputFormat << "\n";
+            return false;
+        }
+        return true;
+    }
+
+    BloomSettings CreateBloomSettings(const BatchOptions& options)
+    {
+        BloomSettings bloomSettings = CreateDefaultBloomSettings();
+        bloomSettings.threshold = options.threshold;
+        bloomSettings.compositeCoefficient = options.compositeCoefficient;
+        ComputeGaussianBlurParams(options.sigma, options.radius, bloomSettings.blurParams);
+        return bloomSettings;
+    }
+
+    // stdin to stdout, the statistics are printed to stderr
+    int RunStreamMode(const BatchOptions& options)
+    {
+#ifdef _WIN32
+        _setmode(_fileno(stdin), _O_BINARY);
+        _setmode(_fileno(stdout), _O_BINARY);
+#endif
+        std::ios::sync_with_stdio(false);
+
+        FrameStreamHeader header;
+        if (options.streamWidth > 0)
+        {
+            header.format = FrameStreamFormat::RawRGBA;
+            header.width = options.streamWidth;
+            header.height = options.streamHeight;
+        }
+        else if (!ReadY4MHeader(std::cin, header))
+        {
+            std::cerr << "Invalid or unsupported Y4M header on stdin (use --size WxH for raw RGBA frames)\n";
+            return -1;
+        }
+
+        ThreadPool pool(options.streamThreads);
+        FrameStreamProcessor processor;
+        bool success = false;
+        const std::string sharedMemoryName = GetSharedMemoryName(options);
+        if (sharedMemoryName.empty())
+        {
+            success = processor.Process(std::cin, std::cout, header, CreateBloomSettings(options), &pool);
+        }
+        else
+        {
+            SharedFrameRingWriter ring;
+            if (!ring.Create(sharedMemoryName, header.width, header.height, options.sharedMemorySlots))
+            {
+                std::cerr << "Could not create the shared memory ring " << sharedMemoryName << "\n";
+                return -1;
+            }
+
+            // readers never block the writer, so publishing cannot fail
+            success = processor.Process(std::cin, [&](const uint8_t* data)
+            {
+                ring.Publish(data);
+                return true;
+            },
+            header, CreateBloomSettings(options), &pool);
+        }
+
+        const FrameStreamProcessor::Stats& stats = processor.GetLastStats();
+        std::fprintf(stderr, "%zu frames (%ux%u) in %.1f ms: %.2f frames/s, busy: read %.1f ms, compute %.1f ms, write %.1f ms\n",
+            stats.frames, header.width, header.height, stats.milliseconds, stats.framesPerSecond, stats.readMilliseconds,
+            stats.computeMilliseconds, stats.writeMilliseconds);
+
+        if (!success)
+        {
+            std::cerr << "Could not write to stdout\n";
+        }
+        return success ? 0 : 1;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    BatchOptions options;
+    if (!ParseOptions(argc, argv, options))
+    {
+        PrintUsage();
+        return -1;
+    }
+
+    if (IsStreamMode(options))
+    {
+        return RunStreamMode(options);
+    }
+
+    const std::vector<std::string> inputFiles = CollectInputFiles(options);
+    if (inputFiles.empty())
+    {
+        std::cerr << "No input files found for " << options.input << "\n";
+        return -1;
+    }
+
+    std::error_code errorCode;
+    std::filesystem::create_directories(options.outputDirectory, errorCode);
+    if (!std::filesystem::is_directory(options.outputDirectory, errorCode))
+    {
+        std::cerr << "Could not create the output directory " << options.outputDirectory << "\n";
+        return -1;
+    }
+
+    // output files keep the name of the input file (and its extension, unless another format is given)
+    std::vector<std::string> outputFiles;
+    outputFiles.reserve(inputFiles.size());
+    for (const std::string& inputFile : inputFiles)
+    {
+        std::filesystem::path outputFile = std::filesystem::path(options.outputDirectory) / std::filesystem::path(inputFile).filename();
+        if (!options.outputFormat.empty())
+        {
+            outputFile.replace_extension(options.outputFormat);
+        }
+        outputFiles.push_back(outputFile.string());
+    }
+
+    BatchBloomPipeline pipeline(options.pipelineSettings);
+    const bool success = pipeline.Run(inputFiles.size(), CreateBloomSettings(options),
+        [&](size_t frameIndex, ImageRGBA8& image)
+        {
+            if (!ReadImageFile(inputFiles[frameIndex], image))
+            {
+                std::cerr << "Could not read " << inputFiles[frameIndex] << "\n";
+                return false;
+            }
+            return true;
+        },
+        [&](size_t frameIndex, const ImageRGBA8& image)
+        {
+            if (!WriteImageFile(outputFiles[frameIndex], image))
+            {
+                std::cerr << "Could not write " << outputFiles[frameIndex] << "\n";
+                return false;
+            }
+            return true;
+        });
+
+    const BatchBloomPipeline::Stats& stats = pipeline.GetLastStats();
+    std::printf("%zu frames processed, %zu failed in %.1f ms: %.2f frames/s\n", stats.framesProcessed, stats.framesFailed,
+        stats.milliseconds, stats.framesPerSecond);
+    std::printf("%-12s %8s %12s %12s\n", "stage", "threads", "busy ms", "utilization");
+
+    auto printStage = [](const char* name, const BatchBloomPipeline::StageStats& stage)
+    {
+        std::printf("%-12s %8u %12.1f %11.1f%%\n", name, stage.threads, stage.busyMilliseconds, 100.0 * stage.utilization);
+    };
+    printStage("decode", stats.decode);
+    printStage("bloom", stats.bloom);
+    printStage("encode", stats.encode);
+
+    return success ? 0 : 1;
+}
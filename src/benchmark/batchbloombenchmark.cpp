@@ -0,0 +1,75 @@
+#include "benchmark/benchmark.h"
+
+#include "cpu/batchbloom.h"
+#include "cpu/bloom.h"
+#include "util/hash.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+int RunBatchBloomBenchmark(const BenchmarkOptions& options)
+{
+    const uint32_t hardwareThreads = std::max(1u, std::thread::hardware_concurrency());
+    const uint32_t maxThreads = (options.threads > 0) ? options.threads : hardwareThreads;
+    const BloomSettings bloomSettings = CreateDefaultBloomSettings();
+
+    std::printf("batch bloom pipeline: %ux%u, %u frames, up to %u bloom threads (%u hardware threads)\n", options.width,
+        options.height, options.frames, maxThreads, hardwareThreads);
+    std::printf("%-32s %12s %12s %12s %12s %12s\n", "bloom threads", "frames/s", "speedup", "decode %", "bloom %", "encode %");
+
+    // a few distinct frames in memory, so that the benchmark measures the pipeline instead of the disk
+    const uint32_t sourceFrameCount = 8;
+    std::vector<ImageRGBA8> sourceFrames(sourceFrameCount);
+    ImageRGBA32F scene;
+    for (uint32_t i = 0; i < sourceFrameCount; ++i)
+    {
+        RenderSyntheticScene(options.width, options.height, i / 60.f, scene);
+        ConvertImage(scene, sourceFrames[i]);
+    }
+
+    double singleThreadFramesPerSecond = 0.0;
+    for (uint32_t threads = 1; ; threads = std::min(2 * threads, maxThreads))
+    {
+        BatchBloomPipeline::Settings settings;
+        settings.bloomThreads = threads;
+        BatchBloomPipeline pipeline(settings);
+
+        // the hash keeps the encode stage from being optimized away
+        std::atomic<uint64_t> checksum(0);
+        const bool success = pipeline.Run(options.frames, bloomSettings,
+            [&](size_t frameIndex, ImageRGBA8& image)
+            {
+                image = sourceFrames[frameIndex % sourceFrameCount];
+                return true;
+            },
+            [&](size_t, const ImageRGBA8& image)
+            {
+                checksum ^= HashBytes(image.pixels.data(), image.pixels.size() * sizeof(ColorRGBA8));
+                return true;
+            });
+
+        if (!success)
+        {
+            std::printf("pipeline failed\n");
+            return 1;
+        }
+
+        const BatchBloomPipeline::Stats& stats = pipeline.GetLastStats();
+        if (threads == 1)
+        {
+            singleThreadFramesPerSecond = stats.framesPerSecond;
+        }
+        PrintBenchmarkRow(std::to_string(threads), { stats.framesPerSecond, stats.framesPerSecond / std::max(singleThreadFramesPerSecond, 1e-6),
+            100.0 * stats.decode.utilization, 100.0 * stats.bloom.utilization, 100.0 * stats.encode.utilization });
+
+        if (threads == maxThreads)
+        {
+            break;
+        }
+    }
+
+    return 0;
+}
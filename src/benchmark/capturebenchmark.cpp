@@ -0,0 +1,118 @@
+#include "benchmark/benchmark.h"
+
+#include "capture/framecapture.h"
+#include "cpu/bloom.h"
+#include "cpu/imagefile.h"
+#include "util/threadpool.h"
+#include "util/timer.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <string>
+#include <system_error>
+
+namespace
+{
+    // simulated time between issuing the copy to the staging texture and the data being available on the CPU
+    constexpr float COPY_LATENCY_MILLISECONDS = 4.f;
+}
+
+int RunCaptureBenchmark(const BenchmarkOptions& options)
+{
+    ThreadPool pool(options.threads);
+    const BloomSettings bloomSettings = CreateDefaultBloomSettings();
+
+    std::error_code errorCode;
+    const std::filesystem::path directory = std::filesystem::temp_directory_path(errorCode) / "bloom_capture_benchmark";
+    std::filesystem::create_directories(directory, errorCode);
+
+    std::printf("frame capture: %ux%u, %u frames, %zu threads, %.1f ms copy latency, frames written to %s\n", options.width,
+        options.height, options.frames, pool.GetThreadCount(), COPY_LATENCY_MILLISECONDS, directory.string().c_str());
+    std::printf("%-32s %12s %12s %12s %12s %12s\n", "mode", "frame ms", "max ms", "capture ms", "captured", "dropped");
+
+    ImageRGBA32F scene;
+    ImageRGBA32F output;
+    BloomBuffers buffers;
+    ImageRGBA8 frame;
+
+    auto writeFrame = [&](uint64_t frameIndex, const ImageRGBA8& image)
+    {
+        WriteImageFile((directory / ("frame_" + std::to_string(frameIndex) + ".pam")).string(), image);
+    };
+
+    // renders a frame on the "render thread" and returns the time including the capture
+    auto runFrames = [&](const char* name, auto&& captureFrame, auto&& getStats)
+    {
+        double totalMilliseconds = 0.0;
+        double maxMilliseconds = 0.0;
+        double captureMilliseconds = 0.0;
+        for (uint32_t i = 0; i < options.frames; ++i)
+        {
+            Timer timer;
+            timer.Start();
+            RenderSyntheticScene(options.width, options.height, i / 60.f, scene);
+            ApplyBloom(scene, bloomSettings, buffers, output, &pool);
+            ConvertImage(output, frame);
+
+            Timer captureTimer;
+            captureTimer.Start();
+            captureFrame();
+            captureTimer.Stop();
+            timer.Stop();
+
+            totalMilliseconds += timer.GetElapsedTimeMilliseconds();
+            maxMilliseconds = std::max<double>(maxMilliseconds, timer.GetElapsedTimeMilliseconds());
+            captureMilliseconds += captureTimer.GetElapsedTimeMilliseconds();
+        }
+
+        const double frames = std::max(options.frames, 1u);
+        uint64_t captured = 0;
+        uint64_t dropped = 0;
+        getStats(captured, dropped);
+        PrintBenchmarkRow(name, { totalMilliseconds / frames, maxMilliseconds, captureMilliseconds / frames,
+            static_cast<double>(captured), static_cast<double>(dropped) });
+    };
+
+    // 1. no capture
+    runFrames("no capture", [] { }, [](uint64_t&, uint64_t&) { });
+
+    // 2. synchronous: map right after the copy and write the frame on the render thread
+    {
+        CpuReadbackRing ring(frame, 1, COPY_LATENCY_MILLISECONDS);
+        ImageRGBA8 image;
+        uint64_t frameIndex = 0;
+        runFrames("synchronous map + write", [&]
+        {
+            ring.Copy(0);
+            size_t rowPitch = 0;
+            const uint8_t* pixels = ring.Map(0, rowPitch);
+            image.Resize(ring.GetWidth(), ring.GetHeight());
+            std::copy(pixels, pixels + rowPitch * image.height, reinterpret_cast<uint8_t*>(image.pixels.data()));
+            ring.Unmap(0);
+            writeFrame(frameIndex++, image);
+        },
+        [&](uint64_t& captured, uint64_t&) { captured = frameIndex; });
+    }
+
+    // 3. readback ring of increasing depth
+    for (uint32_t slotCount = 1; slotCount <= 4; ++slotCount)
+    {
+        CpuReadbackRing ring(frame, slotCount, COPY_LATENCY_MILLISECONDS);
+        FrameCapture::Stats stats = { };
+        {
+            FrameCapture capture(ring, writeFrame);
+            runFrames(("ring, " + std::to_string(slotCount) + " slots").c_str(), [&] { capture.Capture(); },
+                [&](uint64_t& captured, uint64_t& dropped)
+                {
+                    capture.Flush();
+                    stats = capture.GetStats();
+                    captured = stats.framesEncoded;
+                    dropped = stats.framesDropped;
+                });
+        }
+    }
+
+    std::filesystem::remove_all(directory, errorCode);
+    return 0;
+}
@@ -0,0 +1,86 @@
+#include "benchmark/benchmark.h"
+
+#include "cpu/bloom.h"
+#include "cpu/fftconvolution.h"
+#include "cpu/kernel.h"
+#include "util/threadpool.h"
+#include "util/timer.h"
+
+#include <algorithm>
+#include <cstdio>
+
+int RunFftConvolutionBenchmark(const BenchmarkOptions& options)
+{
+    ThreadPool pool(options.threads);
+    const BloomSettings bloomSettings = CreateDefaultBloomSettings();
+
+    // thresholded half-res input, like the input of the blur passes
+    ImageRGBA32F scene;
+    ImageRGBA32F thresholded;
+    RenderSyntheticScene(options.width, options.height, 0.f, scene);
+    ThresholdAndDownsample(scene, bloomSettings.threshold, thresholded, &pool);
+
+    std::printf("FFT convolution: %ux%u (half-res %ux%u), 8-ray star kernels, %zu threads\n", options.width, options.height,
+        thresholded.width, thresholded.height, pool.GetThreadCount());
+    std::printf("%-32s %12s %12s %12s %12s %12s %12s\n", "radius", "taps", "spatial ms", "fft ms", "fft cold ms", "speedup", "max error");
+
+    // direct convolution gets very slow for large kernels, so it is run fewer times
+    const uint32_t spatialRuns = std::max(std::min(options.frames, 3u), 1u);
+    const uint32_t fftRuns = std::max(options.frames, 1u);
+
+    const uint32_t radii[] = { 2, 4, 8, 16, 32, 64, 128 };
+    uint32_t crossoverRadius = 0;
+
+    ImageRGBA32F spatialResult;
+    ImageRGBA32F fftResult;
+    for (uint32_t radius : radii)
+    {
+        const Kernel2D kernel = CreateStarKernel(radius, 8);
+        const size_t taps = std::count_if(kernel.pixels.begin(), kernel.pixels.end(), [](float weight) { return weight != 0.f; });
+
+        Timer timer;
+        timer.Start();
+        for (uint32_t run = 0; run < spatialRuns; ++run)
+        {
+            Convolve2D(thresholded, kernel, spatialResult, &pool);
+        }
+        timer.Stop();
+        const double spatialMilliseconds = timer.GetElapsedTimeMilliseconds() / spatialRuns;
+
+        // the first call computes the plan and the kernel spectrum, later calls hit the kernel cache
+        FftConvolver convolver;
+        timer.Start();
+        convolver.Convolve(thresholded, kernel, fftResult, &pool);
+        timer.Stop();
+        const double coldMilliseconds = timer.GetElapsedTimeMilliseconds();
+
+        timer.Start();
+        for (uint32_t run = 0; run < fftRuns; ++run)
+        {
+            convolver.Convolve(thresholded, kernel, fftResult, &pool);
+        }
+        timer.Stop();
+        const double fftMilliseconds = timer.GetElapsedTimeMilliseconds() / fftRuns;
+
+        if (crossoverRadius == 0 && fftMilliseconds < spatialMilliseconds)
+        {
+            crossoverRadius = radius;
+        }
+
+        char name[64];
+        std::snprintf(name, sizeof(name), "%u (fft %ux%u)", radius, convolver.GetLastStats().fftWidth, convolver.GetLastStats().fftHeight);
+        PrintBenchmarkRow(name, { static_cast<double>(taps), spatialMilliseconds, fftMilliseconds, coldMilliseconds,
+            spatialMilliseconds / std::max(fftMilliseconds, 1e-6), ComputeImageError(spatialResult, fftResult).maxError });
+    }
+
+    if (crossoverRadius != 0)
+    {
+        std::printf("FFT convolution is faster from radius %u on\n", crossoverRadius);
+    }
+    else
+    {
+        std::printf("FFT convolution is not faster for any of the tested radii\n");
+    }
+
+    return 0;
+}
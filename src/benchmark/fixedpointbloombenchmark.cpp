@@ -0,0 +1,181 @@
+#include "benchmark/benchmark.h"
+
+#include "cpu/bloom.h"
+#include "cpu/fixedpointbloom.h"
+#include "util/threadpool.h"
+#include "util/timer.h"
+
+#include <algorithm>
+#include <cstdio>
+
+namespace
+{
+    // compares the image of a pass with the scalar version of each pixel
+    template <typename PixelFunction>
+    bool MatchesScalar(const ImageRGBA8& image, const PixelFunction& scalarPixel)
+    {
+        for (uint32_t y = 0; y < image.height; ++y)
+        {
+            for (uint32_t x = 0; x < image.width; ++x)
+            {
+                const ColorRGBA8 expected = scalarPixel(x, y);
+                const ColorRGBA8& actual = image.At(x, y);
+                if (expected.r != actual.r || expected.g != actual.g || expected.b != actual.b || expected.a != actual.a)
+                {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    // saturates the float image to [0, 1] like writing it to an UNORM render target
+    void Saturate(ImageRGBA32F& image)
+    {
+        for (ColorRGBA32F& value : image.pixels)
+        {
+            value = ColorRGBA32F{ std::clamp(value.r, 0.f, 1.f), std::clamp(value.g, 0.f, 1.f), std::clamp(value.b, 0.f, 1.f), std::clamp(value.a, 0.f, 1.f) };
+        }
+    }
+}
+
+int RunFixedPointBloomBenchmark(const BenchmarkOptions& options)
+{
+    ThreadPool pool(options.threads);
+    const BloomSettings bloomSettings = CreateDefaultBloomSettings();
+    const FixedPointBlurParams fixedParams = ComputeFixedPointBlurParams(bloomSettings.blurParams);
+    const double errorBound = ComputeFixedPointBloomErrorBound(bloomSettings.blurParams);
+    const double compositeErrorBound = ComputeFixedPointCompositeErrorBound(bloomSettings.compositeCoefficient);
+
+    std::printf("fixed-point RGBA8 bloom: %ux%u, %u frames, %zu threads, SSSE3: %s, error bound %.4f / 255 (composite %.4f / 255)\n", options.width,
+        options.height, options.frames, pool.GetThreadCount(), IsFixedPointSimdSupported() ? "yes" : "no (scalar)", errorBound, compositeErrorBound);
+    std::printf("%-32s %12s %12s %12s %12s\n", "pass", "float ms", "RGBA8 ms", "speedup", "MPixel/s");
+
+    ImageRGBA32F floatScene;
+    ImageRGBA8 scene;
+    BloomBuffers floatBuffers;
+    BloomBuffersRGBA8 fixedBuffers;
+    ImageRGBA32F floatOutput;
+    ImageRGBA8 fixedOutput;
+    ImageRGBA32F fixedResult;
+    ImageRGBA32F compositeReference;
+    ImageRGBA8 blurInput;
+
+    constexpr int PASS_COUNT = 4;
+    double floatMilliseconds[PASS_COUNT] = { };
+    double fixedMilliseconds[PASS_COUNT] = { };
+    double maxError = 0.0;
+    double maxCompositeError = 0.0;
+    bool simdMatchesScalar = true;
+
+    for (uint32_t frame = 0; frame < options.frames; ++frame)
+    {
+        // both paths work on the same quantized scene
+        RenderSyntheticScene(options.width, options.height, frame / 60.f, floatScene);
+        ConvertImage(floatScene, scene);
+        ConvertImage(scene, floatScene);
+
+        Timer timer;
+        timer.Start();
+        ThresholdAndDownsample(floatScene, bloomSettings.threshold, floatBuffers.bloom, &pool);
+        timer.Stop();
+        floatMilliseconds[0] += timer.GetElapsedTimeMilliseconds();
+        timer.Start();
+        Blur(floatBuffers.bloom, bloomSettings.blurParams, 0, floatBuffers.temp, &pool);
+        timer.Stop();
+        floatMilliseconds[1] += timer.GetElapsedTimeMilliseconds();
+        timer.Start();
+        Blur(floatBuffers.temp, bloomSettings.blurParams, 1, floatBuffers.bloom, &pool);
+        timer.Stop();
+        floatMilliseconds[2] += timer.GetElapsedTimeMilliseconds();
+        timer.Start();
+        Composite(floatScene, floatBuffers.bloom, bloomSettings.compositeCoefficient, floatOutput, &pool);
+        timer.Stop();
+        floatMilliseconds[3] += timer.GetElapsedTimeMilliseconds();
+
+        timer.Start();
+        ThresholdAndDownsample(scene, bloomSettings.threshold, fixedBuffers.bloom, &pool);
+        timer.Stop();
+        fixedMilliseconds[0] += timer.GetElapsedTimeMilliseconds();
+
+        // the SIMD passes have to match the scalar versions bit by bit
+        if (frame == 0)
+        {
+            simdMatchesScalar = simdMatchesScalar && MatchesScalar(fixedBuffers.bloom, [&](uint32_t x, uint32_t y)
+            {
+                return ThresholdAndDownsamplePixel(scene, bloomSettings.threshold, static_cast<int>(x), static_cast<int>(y));
+            });
+        }
+
+        timer.Start();
+        Blur(fixedBuffers.bloom, fixedParams, 0, fixedBuffers.temp, &pool);
+        timer.Stop();
+        fixedMilliseconds[1] += timer.GetElapsedTimeMilliseconds();
+
+        if (frame == 0)
+        {
+            simdMatchesScalar = simdMatchesScalar && MatchesScalar(fixedBuffers.temp, [&](uint32_t x, uint32_t y)
+            {
+                return BlurPixel(fixedBuffers.bloom, fixedParams, 0, static_cast<int>(x), static_cast<int>(y));
+            });
+        }
+
+        timer.Start();
+        Blur(fixedBuffers.temp, fixedParams, 1, fixedBuffers.bloom, &pool);
+        timer.Stop();
+        fixedMilliseconds[2] += timer.GetElapsedTimeMilliseconds();
+
+        if (frame == 0)
+        {
+            simdMatchesScalar = simdMatchesScalar && MatchesScalar(fixedBuffers.bloom, [&](uint32_t x, uint32_t y)
+            {
+                return BlurPixel(fixedBuffers.temp, fixedParams, 1, static_cast<int>(x), static_cast<int>(y));
+            });
+        }
+
+        timer.Start();
+        Composite(scene, fixedBuffers.bloom, bloomSettings.compositeCoefficient, fixedOutput, &pool);
+        timer.Stop();
+        fixedMilliseconds[3] += timer.GetElapsedTimeMilliseconds();
+
+        if (frame == 0)
+        {
+            simdMatchesScalar = simdMatchesScalar && MatchesScalar(fixedOutput, [&](uint32_t x, uint32_t y)
+            {
+                return CompositePixel(scene, fixedBuffers.bloom, bloomSettings.compositeCoefficient, x, y);
+            });
+        }
+
+        ConvertImage(fixedBuffers.bloom, fixedResult);
+        maxError = std::max(maxError, 255.0 * ComputeImageError(floatBuffers.bloom, fixedResult).maxError);
+
+        // the composite is compared on the same inputs, i.e., with the RGBA8 bloom
+        Composite(floatScene, fixedResult, bloomSettings.compositeCoefficient, compositeReference, &pool);
+        Saturate(compositeReference);
+        ConvertImage(fixedOutput, fixedResult);
+        maxCompositeError = std::max(maxCompositeError, 255.0 * ComputeImageError(compositeReference, fixedResult).maxError);
+    }
+
+    const char* passNames[PASS_COUNT] = { "threshold + downsample", "horizontal blur", "vertical blur", "composite" };
+    const double frames = std::max(options.frames, 1u);
+    const double halfResPixels = static_cast<double>(options.width / 2) * (options.height / 2);
+    const double passPixels[PASS_COUNT] = { halfResPixels, halfResPixels, halfResPixels, static_cast<double>(options.width) * options.height };
+    double floatTotal = 0.0;
+    double fixedTotal = 0.0;
+    for (int pass = 0; pass < PASS_COUNT; ++pass)
+    {
+        const double floatTime = floatMilliseconds[pass] / frames;
+        const double fixedTime = fixedMilliseconds[pass] / frames;
+        floatTotal += floatTime;
+        fixedTotal += fixedTime;
+        PrintBenchmarkRow(passNames[pass], { floatTime, fixedTime, floatTime / std::max(fixedTime, 1e-6), passPixels[pass] / (1000.0 * std::max(fixedTime, 1e-6)) });
+    }
+    const double outputPixels = static_cast<double>(options.width) * options.height;
+    PrintBenchmarkRow("total", { floatTotal, fixedTotal, floatTotal / std::max(fixedTotal, 1e-6), outputPixels / (1000.0 * std::max(fixedTotal, 1e-6)) });
+
+    const bool withinBounds = maxError <= errorBound && maxCompositeError <= compositeErrorBound;
+    std::printf("SIMD matches scalar: %s, max. error %.4f / 255 within bound %.4f / 255, composite %.4f / 255 within bound %.4f / 255: %s\n",
+        simdMatchesScalar ? "yes" : "no", maxError, errorBound, maxCompositeError, compositeErrorBound, withinBounds ? "yes" : "no");
+
+    return (simdMatchesScalar && withinBounds) ? 0 : 1;
+}
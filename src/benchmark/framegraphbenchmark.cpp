@@ -0,0 +1,222 @@
+#include "benchmark/benchmark.h"
+
+#include "cpu/bloom.h"
+#include "geometry.h"
+#include "render/bloomrenderer.h"
+#include "render/dryrunrenderdevice.h"
+#include "render/framegraph.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace
+{
+    // levels of the synthetic bloom pyramid
+    constexpr uint32_t PYRAMID_LEVELS = 5;
+
+    struct FrameGraphResult
+    {
+        FrameGraphStatistics statistics;
+        // peak transient memory of the dry run (device peak above the memory before the frame)
+        uint64_t measuredBytes;
+        // the second frame has to reuse the textures of the first one
+        bool reused;
+    };
+
+    double ToMegabytes(uint64_t bytes) noexcept
+    {
+        return static_cast<double>(bytes) / (1024.0 * 1024.0);
+    }
+
+    // two frames of BloomRenderer on the dry run device
+    bool RunBloomFrames(const BenchmarkOptions& options, const std::vector<VertexPosNormal>& mesh, bool sparse, bool aliasing,
+        DryRunRenderDevice& device, DryRunRenderContext& context, FrameGraphResult& result)
+    {
+        SceneTransforms transforms;
+        SceneLight light;
+        SceneMaterial material;
+        SetUpDefaultScene(options.width, options.height, 0.f, transforms, light, material);
+
+        BloomRenderer renderer;
+        if (!renderer.Initialize(device, { options.width, options.height }, mesh, material))
+        {
+            return false;
+        }
+        renderer.GetFrameGraph().SetAliasingEnabled(aliasing);
+
+        const BloomSettings settings = CreateDefaultBloomSettings();
+        BloomFrameInputs inputs;
+        inputs.transforms = transforms;
+        inputs.light = light;
+        inputs.renderResolution = { options.width, options.height };
+        inputs.threshold = settings.threshold;
+        inputs.blurParams = settings.blurParams;
+        inputs.compositeCoefficient = settings.compositeCoefficient;
+        inputs.sparseBloom = sparse;
+
+        const uint64_t baseMemory = device.GetMemory();
+        device.ResetPeakMemory();
+        renderer.Render(context, inputs);
+        context.Present();
+        result.statistics = renderer.GetFrameGraph().GetStatistics();
+        result.measuredBytes = device.GetPeakMemory() - baseMemory;
+
+        const uint64_t firstFrameMemory = device.GetMemory();
+        renderer.Render(context, inputs);
+        context.Present();
+        result.reused = (device.GetMemory() == firstFrameMemory && device.GetPeakMemory() - baseMemory == result.measuredBytes);
+        return true;
+    }
+
+    // bloom over a pyramid of half resolution levels: per level downsample, horizontal and vertical blur, then the
+    // levels are upsampled and added from the smallest one up and composited, like the bloom of many engines
+    void AddPyramidPasses(FrameGraph& graph, const RenderDevice& device, const BenchmarkOptions& options)
+    {
+        auto dispatch = [](RenderContext& context) { context.Dispatch(1, 1, 1); };
+
+        TextureDesc sceneDesc;
+        sceneDesc.width = options.width;
+        sceneDesc.height = options.height;
+        sceneDesc.format = Format::R8G8B8A8Unorm;
+        sceneDesc.bindFlags = BIND_RENDER_TARGET | BIND_SHADER_RESOURCE;
+        const FrameGraphResource scene = graph.CreateTexture("scene", sceneDesc);
+        graph.AddPass("scene", [](RenderContext& context) { context.Draw(3); }).WriteRenderTarget(scene, 0);
+
+        FrameGraphResource blurred[PYRAMID_LEVELS];
+        FrameGraphResource input = scene;
+        TextureDesc levelDesc;
+        levelDesc.format = Format::R8G8B8A8Unorm;
+        levelDesc.bindFlags = BIND_SHADER_RESOURCE | BIND_UNORDERED_ACCESS;
+        for (uint32_t level = 0; level < PYRAMID_LEVELS; ++level)
+        {
+            levelDesc.width = std::max(options.width >> (level + 1), 1u);
+            levelDesc.height = std::max(options.height >> (level + 1), 1u);
+            const FrameGraphResource downsampled = graph.CreateTexture("downsampled", levelDesc);
+            const FrameGraphResource horizontal = graph.CreateTexture("blurred horizontally", levelDesc);
+            blurred[level] = graph.CreateTexture("blurred", levelDesc);
+
+            graph.AddPass("downsample", dispatch).ReadShaderResource(input, ShaderStage::Compute, 0).WriteUnorderedAccess(downsampled, 0);
+            graph.AddPass("blur horizontal", dispatch).ReadShaderResource(downsampled, ShaderStage::Compute, 0).WriteUnorderedAccess(horizontal, 0);
+            graph.AddPass("blur vertical", dispatch).ReadShaderResource(horizontal, ShaderStage::Compute, 0).WriteUnorderedAccess(blurred[level], 0);
+            input = blurred[level];
+        }
+
+        FrameGraphResource upsampled = blurred[PYRAMID_LEVELS - 1];
+        for (uint32_t level = PYRAMID_LEVELS - 1; level-- > 0;)
+        {
+            levelDesc.width = std::max(options.width >> (level + 1), 1u);
+            levelDesc.height = std::max(options.height >> (level + 1), 1u);
+            const FrameGraphResource sum = graph.CreateTexture("upsampled", levelDesc);
+            graph.AddPass("upsample", dispatch)
+                .ReadShaderResource(blurred[level], ShaderStage::Compute, 0)
+                .ReadShaderResource(upsampled, ShaderStage::Compute, 1)
+                .WriteUnorderedAccess(sum, 0);
+            upsampled = sum;
+        }
+
+        // a debug view nobody reads, culled by Compile()
+        const FrameGraphResource debugView = graph.CreateTexture("debug view", sceneDesc);
+        graph.AddPass("debug view", [](RenderContext& context) { context.Draw(3); })
+            .ReadShaderResource(upsampled, ShaderStage::Pixel, 0)
+            .WriteRenderTarget(debugView, 0);
+
+        FrameGraphViews backBufferViews;
+        backBufferViews.renderTarget = device.GetBackBufferView();
+        graph.AddPass("composite", [](RenderContext& context) { context.Draw(3); })
+            .ReadShaderResource(scene, ShaderStage::Pixel, 0)
+            .ReadShaderResource(upsampled, ShaderStage::Pixel, 1)
+            .WriteRenderTarget(graph.Import("back buffer", backBufferViews), 0);
+    }
+
+    bool RunPyramidFrames(const BenchmarkOptions& options, bool aliasing, DryRunRenderDevice& device, DryRunRenderContext& context,
+        FrameGraphResult& result)
+    {
+        TexturePool pool(device);
+        FrameGraph graph(pool);
+        graph.SetAliasingEnabled(aliasing);
+
+        const uint64_t baseMemory = device.GetMemory();
+        device.ResetPeakMemory();
+        uint64_t firstFrameMemory = 0;
+        for (int frame = 0; frame < 2; ++frame)
+        {
+            graph.Reset();
+            AddPyramidPasses(graph, device, options);
+            if (!graph.Compile())
+            {
+                return false;
+            }
+            graph.Execute(context);
+            context.Present();
+            pool.EndFrame();
+
+            if (frame == 0)
+            {
+                result.statistics = graph.GetStatistics();
+                result.measuredBytes = device.GetPeakMemory() - baseMemory;
+                firstFrameMemory = device.GetMemory();
+            }
+        }
+        result.reused = (device.GetMemory() == firstFrameMemory && device.GetPeakMemory() - baseMemory == result.measuredBytes);
+        return true;
+    }
+}
+
+int RunFrameGraphBenchmark(const BenchmarkOptions& options)
+{
+    std::vector<VertexPosNormal> mesh;
+    if (!LoadObjFile("data/mesh.obj", mesh))
+    {
+        std::cerr << "Could not load data/mesh.obj (run the benchmark from the repository root)\n";
+        return -1;
+    }
+
+    std::printf("frame graph: dry run of the passes, %ux%u, transient memory without and with aliasing\n", options.width, options.height);
+
+    DryRunRenderDevice device(options.width, options.height);
+    DryRunRenderContext context(device);
+
+    std::printf("%-32s %12s %12s %12s %12s %12s %12s %12s\n", "graph", "passes", "culled", "transients", "textures", "MB", "measured MB",
+        "bind/unbind");
+
+    bool passed = true;
+    const char* const graphNames[3] = { "bloom dense", "bloom sparse", "pyramid" };
+    for (int graph = 0; graph < 3; ++graph)
+    {
+        FrameGraphResult results[2];
+        for (int aliasing = 0; aliasing < 2; ++aliasing)
+        {
+            const bool succeeded = (graph < 2) ? RunBloomFrames(options, mesh, graph == 1, aliasing != 0, device, context, results[aliasing])
+                                               : RunPyramidFrames(options, aliasing != 0, device, context, results[aliasing]);
+            if (!succeeded)
+            {
+                return 1;
+            }
+
+            const FrameGraphStatistics& statistics = results[aliasing].statistics;
+            const std::string name = std::string(graphNames[graph]) + (aliasing ? ", aliased" : "");
+            std::printf("%-32s %12zu %12zu %12zu %12zu %12.2f %12.2f %7zu/%-4zu\n", name.c_str(), statistics.passCount, statistics.culledPassCount,
+                statistics.transientCount, statistics.physicalCount, ToMegabytes(statistics.physicalBytes), ToMegabytes(results[aliasing].measuredBytes),
+                statistics.bindCalls, statistics.unbindCalls);
+
+            // the dry run has to allocate exactly the predicted memory, once
+            passed = passed && results[aliasing].measuredBytes == statistics.physicalBytes && results[aliasing].reused;
+        }
+
+        passed = passed && results[1].statistics.physicalBytes <= results[0].statistics.physicalBytes;
+        if (graph == 2)
+        {
+            // each level of the pyramid needs two textures instead of four, and the debug view is culled
+            passed = passed && results[1].statistics.physicalBytes < results[0].statistics.physicalBytes && results[1].statistics.culledPassCount == 1;
+        }
+    }
+
+    const bool noHazards = (context.GetHazardCount() == 0);
+    std::printf("\nMB: peak transient memory of the graph, measured: allocated by the dry run device (width * height * texel size)\n");
+    std::printf("binding hazards: %zu, measured memory as predicted and textures reused in the next frame: %s\n", context.GetHazardCount(),
+        passed ? "yes" : "NO");
+    return (passed && noHazards) ? 0 : 1;
+}
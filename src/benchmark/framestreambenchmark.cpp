@@ -0,0 +1,143 @@
+#include "benchmark/benchmark.h"
+
+#include "cpu/bloom.h"
+#include "cpu/framestream.h"
+#include "util/threadpool.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <istream>
+#include <ostream>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+namespace
+{
+    // input stream with the header followed by the same encoded frame over and over, without holding all frames in memory
+    class RepeatedFrameBuffer : public std::streambuf
+    {
+    public:
+        RepeatedFrameBuffer(const std::string& header, const std::vector<uint8_t>& frame, bool frameLines, uint32_t frameCount)
+            : m_header(header)
+            , m_frame(reinterpret_cast<const char*>(frame.data()), frame.size())
+            , m_frameLines(frameLines)
+            , m_framesLeft(frameCount)
+            , m_segment(0)
+        {
+            SetSegment(m_header);
+        }
+
+    protected:
+        int_type underflow() override
+        {
+            // segments: header, then (FRAME line,) frame data for each frame
+            while (gptr() == egptr())
+            {
+                if (m_framesLeft == 0)
+                {
+                    return traits_type::eof();
+                }
+
+                if (m_frameLines && m_segment != 1)
+                {
+                    m_segment = 1;
+                    SetSegment(m_frameLine);
+                }
+                else
+                {
+                    m_segment = 2;
+                    --m_framesLeft;
+                    SetSegment(m_frame);
+                }
+            }
+            return traits_type::to_int_type(*gptr());
+        }
+
+    private:
+        void SetSegment(const std::string& data)
+        {
+            char* begin = const_cast<char*>(data.data());
+            setg(begin, begin, begin + data.size());
+        }
+
+        const std::string m_header;
+        const std::string m_frame;
+        const std::string m_frameLine = "FRAME\n";
+        const bool m_frameLines;
+        uint32_t m_framesLeft;
+        int m_segment;
+    };
+
+    // discards all output
+    class NullBuffer : public std::streambuf
+    {
+    protected:
+        int_type overflow(int_type c) override { return traits_type::not_eof(c); }
+        std::streamsize xsputn(const char*, std::streamsize count) override { return count; }
+    };
+}
+
+int RunFrameStreamBenchmark(const BenchmarkOptions& options)
+{
+    ThreadPool pool(options.threads);
+    const BloomSettings bloomSettings = CreateDefaultBloomSettings();
+
+    std::printf("frame stream: %u frames, %zu threads, streams in memory\n", options.frames, pool.GetThreadCount());
+    std::printf("%-32s %12s %12s %12s %12s %12s\n", "format", "frames/s", "ms/frame", "read ms", "compute ms", "write ms");
+
+    struct StreamConfig
+    {
+        const char* name;
+        FrameStreamFormat format;
+        uint32_t width;
+        uint32_t height;
+    };
+    const StreamConfig configs[] = {
+        { "RGBA 1920x1080", FrameStreamFormat::RawRGBA, 1920, 1080 },
+        { "Y4M 4:2:0 1920x1080", FrameStreamFormat::Y4M, 1920, 1080 },
+        { "RGBA 3840x2160", FrameStreamFormat::RawRGBA, 3840, 2160 },
+        { "Y4M 4:2:0 3840x2160", FrameStreamFormat::Y4M, 3840, 2160 },
+    };
+
+    ImageRGBA32F scene;
+    FrameStreamProcessor processor;
+    for (const StreamConfig& config : configs)
+    {
+        FrameStreamHeader header;
+        header.format = config.format;
+        header.width = config.width;
+        header.height = config.height;
+        header.y4mHeader = "YUV4MPEG2 W" + std::to_string(config.width) + " H" + std::to_string(config.height) + " F60:1 Ip A1:1 C420jpeg\n";
+
+        RenderSyntheticScene(config.width, config.height, 0.f, scene);
+        std::vector<uint8_t> frame(header.GetFrameSize());
+        EncodeFrame(header, scene, frame.data(), &pool);
+
+        RepeatedFrameBuffer inputBuffer(config.format == FrameStreamFormat::Y4M ? header.y4mHeader : std::string(), frame,
+            config.format == FrameStreamFormat::Y4M, options.frames);
+        NullBuffer outputBuffer;
+        std::istream input(&inputBuffer);
+        std::ostream output(&outputBuffer);
+
+        // parse the header like the command line tool does
+        if (config.format == FrameStreamFormat::Y4M && !ReadY4MHeader(input, header))
+        {
+            std::printf("invalid Y4M header\n");
+            return 1;
+        }
+
+        if (!processor.Process(input, output, header, bloomSettings, &pool) || processor.GetLastStats().frames != options.frames)
+        {
+            std::printf("processing %s failed\n", config.name);
+            return 1;
+        }
+
+        const FrameStreamProcessor::Stats& stats = processor.GetLastStats();
+        const double frames = std::max<double>(static_cast<double>(stats.frames), 1.0);
+        PrintBenchmarkRow(config.name, { stats.framesPerSecond, stats.milliseconds / frames, stats.readMilliseconds / frames,
+            stats.computeMilliseconds / frames, stats.writeMilliseconds / frames });
+    }
+
+    return 0;
+}
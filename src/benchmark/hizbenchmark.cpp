@@ -0,0 +1,96 @@
+#include "benchmark/benchmark.h"
+
+#include "cpu/rasterizer.h"
+#include "geometry.h"
+#include "util/threadpool.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+int RunHierarchicalDepthBenchmark(const BenchmarkOptions& options)
+{
+    struct Mesh
+    {
+        std::string name;
+        std::vector<VertexPosNormal> vertices;
+    };
+    std::vector<Mesh> meshes(4);
+    meshes[0].name = "data/mesh.obj";
+    if (!LoadObjFile("data/mesh.obj", meshes[0].vertices))
+    {
+        std::cerr << "Could not load data/mesh.obj (run the benchmark from the repository root)\n";
+        return -1;
+    }
+    meshes[1].name = "spheres 3x3x3";
+    CreateSphereGrid(3, 16, true, meshes[1].vertices);
+    meshes[2].name = "spheres 6x6x6";
+    CreateSphereGrid(6, 16, true, meshes[2].vertices);
+    meshes[3].name = "spheres 8x8x8";
+    CreateSphereGrid(8, 24, true, meshes[3].vertices);
+
+    ThreadPool pool(options.threads);
+    std::printf("Hi-Z rejection: %ux%u, %u frames, %zu threads\n", options.width, options.height, options.frames, pool.GetThreadCount());
+    std::printf("%-32s %12s %12s %12s %12s %12s %12s\n", "mesh", "triangles", "raster ms", "Hi-Z ms", "saved %", "tri. rej. %", "block rej. %");
+
+    SoftwareRasterizer rasterizer(RasterizerSettings{ false });
+    SoftwareRasterizer hierarchicalRasterizer(RasterizerSettings{ true });
+    SceneTransforms transforms;
+    SceneLight light;
+    SceneMaterial material;
+    ImageRGBA32F reference;
+    ImageRGBA32F color;
+    bool identical = true;
+
+    for (const Mesh& mesh : meshes)
+    {
+        double milliseconds = 0.0;
+        double hierarchicalMilliseconds = 0.0;
+        double binnedTriangles = 0.0;
+        double trianglesOccluded = 0.0;
+        double blocksTested = 0.0;
+        double blocksOccluded = 0.0;
+
+        for (uint32_t i = 0; i < options.frames; ++i)
+        {
+            SetUpDefaultScene(options.width, options.height, i * 1000.f / 60.f, transforms, light, material);
+
+            // the order alternates, so that neither one benefits from the caches warmed up by the other one
+            for (int pass = 0; pass < 2; ++pass)
+            {
+                if ((pass + i) % 2 == 0)
+                {
+                    rasterizer.Render(mesh.vertices, transforms, light, material, options.width, options.height, reference, &pool);
+                }
+                else
+                {
+                    hierarchicalRasterizer.Render(mesh.vertices, transforms, light, material, options.width, options.height, color, &pool);
+                }
+            }
+
+            milliseconds += rasterizer.GetLastStats().rasterMilliseconds;
+            const SoftwareRasterizer::Stats& stats = hierarchicalRasterizer.GetLastStats();
+            hierarchicalMilliseconds += stats.rasterMilliseconds;
+            binnedTriangles += static_cast<double>(stats.binnedTriangles);
+            trianglesOccluded += static_cast<double>(stats.trianglesOccluded);
+            blocksTested += static_cast<double>(stats.blocksTested);
+            blocksOccluded += static_cast<double>(stats.blocksOccluded);
+
+            // rejection is conservative, so the images and depth buffers have to be the same
+            identical = identical && std::memcmp(reference.pixels.data(), color.pixels.data(), color.pixels.size() * sizeof(ColorRGBA32F)) == 0 &&
+                rasterizer.GetDepthBuffer() == hierarchicalRasterizer.GetDepthBuffer();
+        }
+
+        const double frames = std::max(options.frames, 1u);
+        PrintBenchmarkRow(mesh.name, { static_cast<double>(mesh.vertices.size() / 3), milliseconds / frames, hierarchicalMilliseconds / frames,
+            100.0 * (1.0 - hierarchicalMilliseconds / std::max(milliseconds, 1e-6)), 100.0 * trianglesOccluded / std::max(binnedTriangles, 1.0),
+            100.0 * blocksOccluded / std::max(blocksTested, 1.0) });
+    }
+
+    std::printf("\ntriangles are rejected per tile (of all binned triangles), blocks of 8x8 pixels per covered block of the remaining triangles\n");
+    std::printf("same image and depth with Hi-Z: %s\n", identical ? "yes" : "NO");
+    return identical ? 0 : 1;
+}
@@ -0,0 +1,129 @@
+#include "benchmark/benchmark.h"
+
+#include "cpu/bloom.h"
+#include "cpu/incrementalbloom.h"
+#include "util/threadpool.h"
+#include "util/timer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+namespace
+{
+    constexpr float FRAME_TIME = 1.f / 60.f;
+
+    // static background (the synthetic scene at time 0) with a number of small discs moving in the upper left quadrant
+    void RenderPartiallyStaticScene(const ImageRGBA32F& background, uint32_t movingDiscs, uint32_t frame, ImageRGBA32F& scene)
+    {
+        scene = background;
+
+        const float minExtent = static_cast<float>(std::min(scene.width, scene.height));
+        const float radius = 0.02f * minExtent;
+        for (uint32_t i = 0; i < movingDiscs; ++i)
+        {
+            float angle = 6.2831853f * (0.5f * frame * FRAME_TIME + static_cast<float>(i) / movingDiscs);
+            float centerX = 0.25f * scene.width + 0.1f * minExtent * std::cos(angle);
+            float centerY = 0.25f * scene.height + 0.1f * minExtent * std::sin(angle);
+
+            const uint32_t x0 = static_cast<uint32_t>(std::max(centerX - radius, 0.f));
+            const uint32_t y0 = static_cast<uint32_t>(std::max(centerY - radius, 0.f));
+            const uint32_t x1 = std::min(static_cast<uint32_t>(centerX + radius) + 1, scene.width);
+            const uint32_t y1 = std::min(static_cast<uint32_t>(centerY + radius) + 1, scene.height);
+            for (uint32_t y = y0; y < y1; ++y)
+            {
+                for (uint32_t x = x0; x < x1; ++x)
+                {
+                    float dx = static_cast<float>(x) - centerX;
+                    float dy = static_cast<float>(y) - centerY;
+                    if (dx * dx + dy * dy < radius * radius)
+                    {
+                        scene.At(x, y) = ColorRGBA32F{ 1.f, 0.8f, 0.4f, 1.f };
+                    }
+                }
+            }
+        }
+    }
+}
+
+int RunIncrementalBloomBenchmark(const BenchmarkOptions& options)
+{
+    ThreadPool pool(options.threads);
+    const BloomSettings bloomSettings = CreateDefaultBloomSettings();
+
+    ImageRGBA32F background;
+    RenderSyntheticScene(options.width, options.height, 0.f, background);
+
+    std::printf("incremental bloom: %ux%u, %u frames, %zu threads\n", options.width, options.height, options.frames, pool.GetThreadCount());
+    std::printf("%-32s %12s %12s %12s %12s %12s %12s\n", "scene", "full ms", "incr. ms", "speedup", "tiles %", "skipped %", "max error");
+
+    // number of moving discs, ~0u = the fully animated synthetic scene
+    const uint32_t scenarios[] = { 0, 1, 4, 16, ~0u };
+
+    ImageRGBA32F scene;
+    BloomBuffers referenceBuffers;
+    for (uint32_t movingDiscs : scenarios)
+    {
+        IncrementalBloom incrementalBloom;
+
+        double fullMilliseconds = 0.0;
+        double incrementalMilliseconds = 0.0;
+        double recomputedTiles = 0.0;
+        uint32_t skippedFrames = 0;
+        double maxError = 0.0;
+
+        for (uint32_t frame = 0; frame < options.frames; ++frame)
+        {
+            if (movingDiscs == ~0u)
+            {
+                RenderSyntheticScene(options.width, options.height, frame * FRAME_TIME, scene);
+            }
+            else
+            {
+                RenderPartiallyStaticScene(background, movingDiscs, frame, scene);
+            }
+
+            Timer timer;
+            timer.Start();
+            ComputeBloom(scene, bloomSettings, referenceBuffers, &pool);
+            timer.Stop();
+            fullMilliseconds += timer.GetElapsedTimeMilliseconds();
+
+            timer.Start();
+            const ImageRGBA32F& bloom = incrementalBloom.Process(scene, bloomSettings, &pool);
+            timer.Stop();
+
+            // the first frame is always a full recompute, we only measure the steady state
+            if (frame == 0)
+            {
+                fullMilliseconds = 0.0;
+                continue;
+            }
+            incrementalMilliseconds += timer.GetElapsedTimeMilliseconds();
+
+            const IncrementalBloom::Stats& stats = incrementalBloom.GetLastFrameStats();
+            recomputedTiles += static_cast<double>(stats.tilesBlurredVertical) / std::max(stats.tilesTotal, 1u);
+            skippedFrames += stats.frameSkipped ? 1 : 0;
+
+            maxError = std::max(maxError, ComputeImageError(referenceBuffers.bloom, bloom).maxError);
+        }
+
+        const double frames = std::max(options.frames, 2u) - 1.0;
+        fullMilliseconds /= frames;
+        incrementalMilliseconds /= frames;
+
+        char name[64];
+        if (movingDiscs == ~0u)
+        {
+            std::snprintf(name, sizeof(name), "fully animated");
+        }
+        else
+        {
+            std::snprintf(name, sizeof(name), "static + %u moving disc(s)", movingDiscs);
+        }
+        PrintBenchmarkRow(name, { fullMilliseconds, incrementalMilliseconds, fullMilliseconds / std::max(incrementalMilliseconds, 1e-6),
+            100.0 * recomputedTiles / frames, 100.0 * skippedFrames / frames, maxError });
+    }
+
+    return 0;
+}
@@ -0,0 +1,106 @@
+#include "benchmark/benchmark.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+namespace
+{
+    struct Benchmark
+    {
+        const char* name;
+        const char* description;
+        int (*run)(const BenchmarkOptions& options);
+    };
+
+    const Benchmark benchmarks[] = {
+        { "temporal", "temporally amortized bloom vs. full recompute", RunTemporalBloomBenchmark },
+        { "incremental", "dirty-tile incremental bloom on partially static scenes", RunIncrementalBloomBenchmark },
+        { "sparse", "sparse bloom restricted to tiles near bright pixels", RunSparseBloomBenchmark },
+        { "fft", "FFT vs. direct convolution with large non-separable kernels", RunFftConvolutionBenchmark },
+        { "separable", "low-rank separable approximation of non-separable kernels", RunSeparableKernelBenchmark },
+        { "sat", "summed-area table with per-pixel variable radius box blur", RunSummedAreaTableBenchmark },
+        { "fixedpoint", "fixed-point 16-bit SIMD bloom on RGBA8 images", RunFixedPointBloomBenchmark },
+        { "streaming", "out-of-core streaming bloom on a large image on disk", RunStreamingBloomBenchmark },
+        { "batch", "scaling of the batch bloom pipeline with the number of threads", RunBatchBloomBenchmark },
+        { "framestream", "raw RGBA / Y4M frame streams as used for stdin / stdout", RunFrameStreamBenchmark },
+        { "capture", "non-stalling frame capture with a readback ring", RunCaptureBenchmark },
+        { "qoi", "lossless QOI encoding of rendered frames vs. PNG", RunQoiBenchmark },
+        { "sharedmemory", "shared memory frame ring with a consumer process", RunSharedMemoryBenchmark },
+        { "rasterizer", "tiled software rasterizer for the Blinn-Phong scene pass", RunRasterizerBenchmark },
+        { "phong", "8-wide SIMD Blinn-Phong shading vs. the scalar reference", RunPhongBenchmark },
+        { "hiz", "hierarchical depth rejection in the software rasterizer", RunHierarchicalDepthBenchmark },
+        { "visibility", "visibility buffer vs. forward shading in the software rasterizer", RunVisibilityBufferBenchmark },
+        { "shadingrate", "adaptive shading rate vs. full rate shading in the software rasterizer", RunShadingRateBenchmark },
+        { "prefilter", "SIMD triangle prefilter before the setup of the software rasterizer", RunPrefilterBenchmark },
+        { "occlusion", "masked software occlusion culling of instances in cluttered scenes", RunOcclusionCullingBenchmark },
+        { "backend", "the application frame executed headless by the CPU render backend", RunRenderBackendBenchmark },
+        { "framegraph", "transient texture aliasing and derived unbinds of the frame graph", RunFrameGraphBenchmark },
+        { "texturepool", "pooled render targets recycled across frames and resizes", RunTexturePoolBenchmark },
+        { "statecache", "redundant state changes dropped in front of the render context", RunStateCacheBenchmark },
+        { "resolution", "dynamic resolution controller on synthetic GPU frame time traces", RunDynamicResolutionBenchmark },
+    };
+
+    void PrintUsage()
+    {
+        std::cerr << "usage: bloom_benchmark <benchmark> [--width W] [--height H] [--frames N] [--threads T] [--stream-size S]\n\nbenchmarks:\n";
+        for (const Benchmark& benchmark : benchmarks)
+        {
+            std::cerr << "  " << benchmark.name << ": " << benchmark.description << "\n";
+        }
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc < 2)
+    {
+        PrintUsage();
+        return -1;
+    }
+
+    BenchmarkOptions options;
+    for (int i = 2; i + 1 < argc; i += 2)
+    {
+        uint32_t value = static_cast<uint32_t>(std::strtoul(argv[i + 1], nullptr, 10));
+
+        if (std::strcmp(argv[i], "--width") == 0)
+        {
+            options.width = value;
+        }
+        else if (std::strcmp(argv[i], "--height") == 0)
+        {
+            options.height = value;
+        }
+        else if (std::strcmp(argv[i], "--frames") == 0)
+        {
+            options.frames = value;
+        }
+        else if (std::strcmp(argv[i], "--threads") == 0)
+        {
+            options.threads = value;
+        }
+        else if (std::strcmp(argv[i], "--stream-size") == 0)
+        {
+            options.streamSize = value;
+        }
+        else
+        {
+            std::cerr << "Unknown option " << argv[i] << "\n";
+            PrintUsage();
+            return -1;
+        }
+    }
+
+    for (const Benchmark& benchmark : benchmarks)
+    {
+        if (std::strcmp(argv[1], benchmark.name) == 0)
+        {
+            return benchmark.run(options);
+        }
+    }
+
+    std::cerr << "Unknown benchmark " << argv[1] << "\n";
+    PrintUsage();
+    return -1;
+}
@@ -0,0 +1,213 @@
+#include "benchmark/benchmark.h"
+
+#include "cpu/occlusionculling.h"
+#include "cpu/rasterizer.h"
+#include "geometry.h"
+#include "util/threadpool.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    // resolution of the masked depth buffer relative to the viewport
+    constexpr uint32_t CULLING_RESOLUTION_DIVISOR = 4;
+
+    struct ClutteredScene
+    {
+        std::string name;
+        // boxes of the buildings, which are the occluders as well
+        std::vector<VertexPosNormal> occluders;
+        // bounding boxes of all instances (buildings and props) and their 12 triangles each in the same order
+        std::vector<BoundingBox> boxes;
+        std::vector<VertexPosNormal> mesh;
+    };
+
+    // 12 triangles of the box, clockwise seen from the outside
+    void AddBox(const BoundingBox& box, std::vector<VertexPosNormal>& mesh)
+    {
+        const float* l = box.min;
+        const float* h = box.max;
+        const float dx = h[0] - l[0];
+        const float dy = h[1] - l[1];
+        const float dz = h[2] - l[2];
+        // corner, two edges and the normal of each face (the cross product of the edges points outwards)
+        const float faces[6][4][3] = {
+            { { h[0], h[1], l[2] }, { 0.f, 0.f, dz }, { 0.f, -dy, 0.f }, { 1.f, 0.f, 0.f } },
+            { { l[0], h[1], h[2] }, { 0.f, 0.f, -dz }, { 0.f, -dy, 0.f }, { -1.f, 0.f, 0.f } },
+            { { l[0], h[1], h[2] }, { dx, 0.f, 0.f }, { 0.f, 0.f, -dz }, { 0.f, 1.f, 0.f } },
+            { { l[0], l[1], l[2] }, { dx, 0.f, 0.f }, { 0.f, 0.f, dz }, { 0.f, -1.f, 0.f } },
+            { { h[0], h[1], h[2] }, { -dx, 0.f, 0.f }, { 0.f, -dy, 0.f }, { 0.f, 0.f, 1.f } },
+            { { l[0], h[1], l[2] }, { dx, 0.f, 0.f }, { 0.f, -dy, 0.f }, { 0.f, 0.f, -1.f } } };
+
+        for (const auto& face : faces)
+        {
+            auto corner = [&](float u, float v)
+            {
+                return VertexPosNormal{ face[0][0] + u * face[1][0] + v * face[2][0], face[0][1] + u * face[1][1] + v * face[2][1],
+                    face[0][2] + u * face[1][2] + v * face[2][2], face[3][0], face[3][1], face[3][2] };
+            };
+            mesh.insert(mesh.end(), { corner(0.f, 0.f), corner(1.f, 0.f), corner(1.f, 1.f), corner(0.f, 0.f), corner(1.f, 1.f), corner(0.f, 1.f) });
+        }
+    }
+
+    /**
+     * City of blocksPerAxis x blocksPerAxis buildings of random size and height on the ground plane around the origin,
+     * with small props scattered in the streets around them. Seen from the camera of the application, the buildings in
+     * front hide many of the props and part of the buildings behind them.
+     */
+    void CreateClutteredScene(uint32_t blocksPerAxis, uint32_t propsPerBlock, ClutteredScene& scene)
+    {
+        const float extent = 1.2f;
+        const float ground = -0.2f;
+        const float cell = extent / blocksPerAxis;
+        std::mt19937 random(1);
+        std::uniform_real_distribution<float> uniform(0.f, 1.f);
+
+        scene.name = "city " + std::to_string(blocksPerAxis) + "x" + std::to_string(blocksPerAxis);
+        scene.occluders.clear();
+        scene.boxes.clear();
+        scene.mesh.clear();
+        for (uint32_t i = 0; i < blocksPerAxis * blocksPerAxis; ++i)
+        {
+            const float cellX = (i % blocksPerAxis) * cell - 0.5f * extent;
+            const float cellZ = (i / blocksPerAxis) * cell - 0.5f * extent;
+
+            const float sizeX = (0.5f + 0.3f * uniform(random)) * cell;
+            const float sizeZ = (0.5f + 0.3f * uniform(random)) * cell;
+            const float x = cellX + 0.5f * (cell - sizeX);
+            const float z = cellZ + 0.5f * (cell - sizeZ);
+            const BoundingBox building = { { x, ground, z }, { x + sizeX, ground + 0.05f + 0.25f * uniform(random), z + sizeZ } };
+            scene.boxes.push_back(building);
+            AddBox(building, scene.occluders);
+
+            for (uint32_t p = 0; p < propsPerBlock; ++p)
+            {
+                // in the street around the building
+                const float size = (0.04f + 0.05f * uniform(random)) * cell;
+                float propX = 0.f;
+                float propZ = 0.f;
+                do
+                {
+                    propX = cellX + uniform(random) * (cell - size);
+                    propZ = cellZ + uniform(random) * (cell - size);
+                } while (propX + size > x && propX < x + sizeX && propZ + size > z && propZ < z + sizeZ);
+                scene.boxes.push_back(BoundingBox{ { propX, ground, propZ }, { propX + size, ground + (0.5f + uniform(random)) * size, propZ + size } });
+            }
+        }
+        for (const BoundingBox& box : scene.boxes)
+        {
+            AddBox(box, scene.mesh);
+        }
+    }
+}
+
+int RunOcclusionCullingBenchmark(const BenchmarkOptions& options)
+{
+    std::vector<ClutteredScene> scenes(3);
+    CreateClutteredScene(8, 32, scenes[0]);
+    CreateClutteredScene(16, 16, scenes[1]);
+    CreateClutteredScene(32, 8, scenes[2]);
+
+    // 1, 2, 4, ... threads up to the given number of threads (default: hardware threads)
+    const uint32_t maxThreads = (options.threads > 0) ? options.threads : std::max(std::thread::hardware_concurrency(), 1u);
+    std::vector<uint32_t> threadCounts;
+    for (uint32_t threads = 1; threads < maxThreads; threads *= 2)
+    {
+        threadCounts.push_back(threads);
+    }
+    threadCounts.push_back(maxThreads);
+
+    const uint32_t width = std::max(options.width / CULLING_RESOLUTION_DIVISOR, 1u);
+    const uint32_t height = std::max(options.height / CULLING_RESOLUTION_DIVISOR, 1u);
+    std::printf("masked occlusion culling: %ux%u masked depth buffer, %ux%u reference, %u frames, AVX2: %s\n", width, height, options.width,
+        options.height, options.frames, IsAvx2Supported() ? "yes" : "no");
+    std::printf("%-32s %12s %12s %12s %12s %12s %12s %12s\n", "scene, threads", "instances", "culled %", "hidden %", "false culls", "raster ms",
+        "test ms", "frame ms");
+
+    RasterizerSettings referenceSettings;
+    referenceSettings.visibilityBuffer = true;
+    SoftwareRasterizer referenceRasterizer(referenceSettings);
+    OcclusionCuller culler;
+    SceneTransforms transforms;
+    SceneLight light;
+    SceneMaterial material;
+    ImageRGBA32F color;
+    std::vector<uint8_t> visible;
+    bool independentOfThreads = true;
+
+    for (const ClutteredScene& scene : scenes)
+    {
+        const size_t instances = scene.boxes.size();
+        // instances that cover a pixel of the full resolution image, and the culling result of the first thread count per frame
+        std::vector<std::vector<uint8_t>> referenceVisible(options.frames);
+        std::vector<std::vector<uint8_t>> firstVisible(options.frames);
+
+        for (uint32_t threads : threadCounts)
+        {
+            ThreadPool pool(threads);
+            double culled = 0.0;
+            double hidden = 0.0;
+            double falseCulls = 0.0;
+            double rasterMilliseconds = 0.0;
+            double testMilliseconds = 0.0;
+
+            for (uint32_t i = 0; i < options.frames; ++i)
+            {
+                SetUpDefaultScene(options.width, options.height, i * 1000.f / 60.f, transforms, light, material);
+                const Matrix4x4 modelViewProj = MultiplyMatrices(transforms.proj, MultiplyMatrices(transforms.view, transforms.model));
+
+                if (threads == threadCounts.front())
+                {
+                    referenceRasterizer.Render(scene.mesh, transforms, light, material, options.width, options.height, color, &pool);
+                    referenceVisible[i].assign(instances, 0);
+                    for (uint32_t primitive : referenceRasterizer.GetVisibilityBuffer())
+                    {
+                        if (primitive != SoftwareRasterizer::NO_PRIMITIVE)
+                        {
+                            referenceVisible[i][primitive / 12] = 1;
+                        }
+                    }
+                }
+
+                culler.RenderOccluders(scene.occluders, modelViewProj, width, height, &pool);
+                culler.TestBoxes(scene.boxes, modelViewProj, visible, &pool);
+
+                const OcclusionCuller::Stats& stats = culler.GetLastStats();
+                rasterMilliseconds += stats.rasterMilliseconds;
+                testMilliseconds += stats.testMilliseconds;
+                culled += static_cast<double>(stats.boxesOutsideFrustum + stats.boxesOccluded);
+                for (size_t instance = 0; instance < instances; ++instance)
+                {
+                    hidden += referenceVisible[i][instance] ? 0.0 : 1.0;
+                    falseCulls += (referenceVisible[i][instance] && !visible[instance]) ? 1.0 : 0.0;
+                }
+
+                // the result has to be the same for every number of threads
+                if (threads == threadCounts.front())
+                {
+                    firstVisible[i] = visible;
+                }
+                else
+                {
+                    independentOfThreads = independentOfThreads && firstVisible[i] == visible;
+                }
+            }
+
+            const double frames = std::max(options.frames, 1u);
+            PrintBenchmarkRow(scene.name + ", " + std::to_string(threads), { static_cast<double>(instances), 100.0 * culled / (instances * frames),
+                100.0 * hidden / (instances * frames), falseCulls / frames, rasterMilliseconds / frames, testMilliseconds / frames,
+                (rasterMilliseconds + testMilliseconds) / frames });
+        }
+    }
+
+    std::printf("\nculled instances (outside of the view frustum or occluded by the buildings), instances that do not cover a pixel of\n");
+    std::printf("the reference image (ideal cull rate), visible instances culled per frame (thinner than a pixel of the masked depth\n");
+    std::printf("buffer where they are visible), time to rasterize the occluders and to test the bounding boxes\n");
+    std::printf("culling result independent of the thread count: %s\n", independentOfThreads ? "yes" : "NO");
+    return independentOfThreads ? 0 : 1;
+}
@@ -0,0 +1,104 @@
+#include "benchmark/benchmark.h"
+
+#include "cpu/phong.h"
+#include "util/timer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+int RunPhongBenchmark(const BenchmarkOptions& options)
+{
+    // one frame worth of pixels with random view space positions in front of the camera and random (not normalized) normals
+    const size_t pixelCount = static_cast<size_t>(options.width) * options.height;
+    std::vector<float> attributes[6];
+    std::mt19937 random(1);
+    std::uniform_real_distribution<float> depth(0.1f, 2.f);
+    std::uniform_real_distribution<float> unit(-1.f, 1.f);
+    std::uniform_real_distribution<float> normalLength(0.5f, 2.f);
+    for (std::vector<float>& attribute : attributes)
+    {
+        attribute.resize(pixelCount);
+    }
+    for (size_t i = 0; i < pixelCount; ++i)
+    {
+        const float z = depth(random);
+        attributes[0][i] = unit(random) * z;
+        attributes[1][i] = unit(random) * z;
+        attributes[2][i] = z;
+
+        float normal[3] = { unit(random), unit(random), unit(random) };
+        const float scale = normalLength(random) / std::max(std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]), 1e-3f);
+        for (int c = 0; c < 3; ++c)
+        {
+            attributes[3 + c][i] = normal[c] * scale;
+        }
+    }
+    const float* const viewPosition[3] = { attributes[0].data(), attributes[1].data(), attributes[2].data() };
+    const float* const viewNormal[3] = { attributes[3].data(), attributes[4].data(), attributes[5].data() };
+
+    std::vector<float> colors[3];
+    for (std::vector<float>& channel : colors)
+    {
+        channel.resize(pixelCount);
+    }
+    float* const color[3] = { colors[0].data(), colors[1].data(), colors[2].data() };
+    std::vector<ColorRGBA32F> reference(pixelCount);
+
+    SceneTransforms transforms;
+    SceneLight light;
+    SceneMaterial material;
+    SetUpDefaultScene(options.width, options.height, 0.f, transforms, light, material);
+
+    std::printf("Blinn-Phong shading: %zu pixels, %u frames, AVX2 kernel: %s\n", pixelCount, options.frames, IsSimdShadingSupported() ? "yes" : "no (scalar fallback)");
+    std::printf("%-32s %12s %12s %12s %12s\n", "shininess", "scalar ms", "SoA ms", "speedup", "error 1e-6");
+
+    // error relative to max(1, |reference|), the tolerance grows with the shininess, see ShadeBlinnPhongSoA()
+    bool withinTolerance = true;
+    for (float shininess : { 1.f, 8.f, 24.f, 128.f })
+    {
+        material.specularAndShininess[3] = shininess;
+
+        Timer timer;
+        double scalarMilliseconds = 0.0;
+        double simdMilliseconds = 0.0;
+        for (uint32_t frame = 0; frame < options.frames; ++frame)
+        {
+            timer.Start();
+            for (size_t i = 0; i < pixelCount; ++i)
+            {
+                const float position[3] = { viewPosition[0][i], viewPosition[1][i], viewPosition[2][i] };
+                const float normal[3] = { viewNormal[0][i], viewNormal[1][i], viewNormal[2][i] };
+                reference[i] = ShadeBlinnPhong(light, material, position, normal);
+            }
+            timer.Stop();
+            scalarMilliseconds += timer.GetElapsedTimeMilliseconds();
+
+            timer.Start();
+            ShadeBlinnPhongSoA(light, material, viewPosition, viewNormal, pixelCount, color);
+            timer.Stop();
+            simdMilliseconds += timer.GetElapsedTimeMilliseconds();
+        }
+
+        double maxError = 0.0;
+        for (size_t i = 0; i < pixelCount; ++i)
+        {
+            const float expected[3] = { reference[i].r, reference[i].g, reference[i].b };
+            for (int c = 0; c < 3; ++c)
+            {
+                maxError = std::max(maxError, std::abs(static_cast<double>(color[c][i]) - expected[c]) / std::max(1.0, std::abs(static_cast<double>(expected[c]))));
+            }
+        }
+        withinTolerance = withinTolerance && maxError <= (1.0 + shininess / 8.0) * 1e-6;
+
+        const double frames = std::max(options.frames, 1u);
+        PrintBenchmarkRow(std::to_string(static_cast<int>(shininess)), { scalarMilliseconds / frames, simdMilliseconds / frames,
+            scalarMilliseconds / std::max(simdMilliseconds, 1e-6), maxError * 1e6 });
+    }
+
+    std::printf("\nSoA kernel within tolerance of the scalar reference: %s\n", withinTolerance ? "yes" : "NO");
+    return withinTolerance ? 0 : 1;
+}
@@ -0,0 +1,314 @@
+#include "benchmark/benchmark.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+namespace
+{
+    constexpr uint32_t WINDOW_SIZE = 32768;
+    constexpr uint32_t HASH_BITS = 15;
+    constexpr uint32_t MIN_MATCH = 3;
+    constexpr uint32_t MAX_MATCH = 258;
+    // max. number of earlier positions compared for each match (speed vs. compression ratio)
+    constexpr uint32_t MAX_CHAIN = 32;
+
+    constexpr uint16_t LENGTH_BASE[29] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+    constexpr uint8_t LENGTH_EXTRA[29] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+    constexpr uint16_t DISTANCE_BASE[30] = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073,
+        4097, 6145, 8193, 12289, 16385, 24577 };
+    constexpr uint8_t DISTANCE_EXTRA[30] = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+
+    // deflate stores bits starting with the least significant one
+    class BitWriter
+    {
+    public:
+        explicit BitWriter(std::vector<uint8_t>& output) : m_output(output) { }
+
+        void WriteBits(uint32_t bits, uint32_t count)
+        {
+            m_buffer |= static_cast<uint64_t>(bits) << m_count;
+            m_count += count;
+            while (m_count >= 8)
+            {
+                m_output.push_back(static_cast<uint8_t>(m_buffer));
+                m_buffer >>= 8;
+                m_count -= 8;
+            }
+        }
+
+        // Huffman codes are stored starting with the most significant bit
+        void WriteCode(uint32_t code, uint32_t length)
+        {
+            uint32_t reversed = 0;
+            for (uint32_t i = 0; i < length; ++i)
+            {
+                reversed = (reversed << 1) | ((code >> i) & 1);
+            }
+            WriteBits(reversed, length);
+        }
+
+        void Flush()
+        {
+            if (m_count > 0)
+            {
+                WriteBits(0, 8 - m_count);
+            }
+        }
+
+    private:
+        std::vector<uint8_t>& m_output;
+        uint64_t m_buffer = 0;
+        uint32_t m_count = 0;
+    };
+
+    // literal / length symbol with the fixed Huffman code of deflate
+    void WriteFixedSymbol(BitWriter& writer, uint32_t symbol)
+    {
+        if (symbol < 144)
+        {
+            writer.WriteCode(0x30 + symbol, 8);
+        }
+        else if (symbol < 256)
+        {
+            writer.WriteCode(0x190 + symbol - 144, 9);
+        }
+        else if (symbol < 280)
+        {
+            writer.WriteCode(symbol - 256, 7);
+        }
+        else
+        {
+            writer.WriteCode(0xc0 + symbol - 280, 8);
+        }
+    }
+
+    void WriteMatch(BitWriter& writer, uint32_t length, uint32_t distance)
+    {
+        uint32_t lengthCode = 0;
+        while (lengthCode + 1 < 29 && LENGTH_BASE[lengthCode + 1] <= length)
+        {
+            ++lengthCode;
+        }
+        WriteFixedSymbol(writer, 257 + lengthCode);
+        writer.WriteBits(length - LENGTH_BASE[lengthCode], LENGTH_EXTRA[lengthCode]);
+
+        uint32_t distanceCode = 0;
+        while (distanceCode + 1 < 30 && DISTANCE_BASE[distanceCode + 1] <= distance)
+        {
+            ++distanceCode;
+        }
+        writer.WriteCode(distanceCode, 5);
+        writer.WriteBits(distance - DISTANCE_BASE[distanceCode], DISTANCE_EXTRA[distanceCode]);
+    }
+
+    uint32_t HashBytes3(const uint8_t* data)
+    {
+        const uint32_t value = data[0] | (data[1] << 8) | (data[2] << 16);
+        return (value * 2654435761u) >> (32 - HASH_BITS);
+    }
+
+    // zlib stream with a single deflate block using the fixed Huffman codes and greedy LZ77 matching
+    void Deflate(const std::vector<uint8_t>& data, std::vector<uint8_t>& output)
+    {
+        output.push_back(0x78);
+        output.push_back(0x01);
+
+        BitWriter writer(output);
+        writer.WriteBits(1, 1);  // final block
+        writer.WriteBits(1, 2);  // fixed Huffman codes
+
+        std::vector<int32_t> head(size_t(1) << HASH_BITS, -1);
+        std::vector<int32_t> previous(WINDOW_SIZE, -1);
+        auto insert = [&](size_t position)
+        {
+            const uint32_t hash = HashBytes3(&data[position]);
+            previous[position % WINDOW_SIZE] = head[hash];
+            head[hash] = static_cast<int32_t>(position);
+        };
+
+        const size_t size = data.size();
+        size_t i = 0;
+        while (i < size)
+        {
+            uint32_t bestLength = 0;
+            uint32_t bestDistance = 0;
+            if (i + MIN_MATCH <= size)
+            {
+                const uint32_t maxLength = static_cast<uint32_t>(std::min<size_t>(MAX_MATCH, size - i));
+                int32_t candidate = head[HashBytes3(&data[i])];
+                for (uint32_t chain = 0; chain < MAX_CHAIN && candidate >= 0 && i - candidate <= WINDOW_SIZE; ++chain)
+                {
+                    uint32_t length = 0;
+                    while (length < maxLength && data[candidate + length] == data[i + length])
+                    {
+                        ++length;
+                    }
+                    if (length > bestLength)
+                    {
+                        bestLength = length;
+                        bestDistance = static_cast<uint32_t>(i - candidate);
+                        if (length == maxLength)
+                        {
+                            break;
+                        }
+                    }
+                    candidate = previous[candidate % WINDOW_SIZE];
+                }
+            }
+
+            if (bestLength >= MIN_MATCH)
+            {
+                WriteMatch(writer, bestLength, bestDistance);
+                for (size_t end = i + bestLength; i < end; ++i)
+                {
+                    if (i + MIN_MATCH <= size)
+                    {
+                        insert(i);
+                    }
+                }
+            }
+            else
+            {
+                WriteFixedSymbol(writer, data[i]);
+                if (i + MIN_MATCH <= size)
+                {
+                    insert(i);
+                }
+                ++i;
+            }
+        }
+
+        WriteFixedSymbol(writer, 256);
+        writer.Flush();
+
+        uint32_t a = 1;
+        uint32_t b = 0;
+        for (uint8_t value : data)
+        {
+            a = (a + value) % 65521;
+            b = (b + a) % 65521;
+        }
+        const uint32_t adler = (b << 16) | a;
+        for (int shift = 24; shift >= 0; shift -= 8)
+        {
+            output.push_back(static_cast<uint8_t>(adler >> shift));
+        }
+    }
+
+    uint32_t Crc32(const uint8_t* data, size_t size)
+    {
+        static const std::vector<uint32_t> table = []
+        {
+            std::vector<uint32_t> values(256);
+            for (uint32_t n = 0; n < 256; ++n)
+            {
+                uint32_t c = n;
+                for (int k = 0; k < 8; ++k)
+                {
+                    c = (c & 1) ? 0xedb88320u ^ (c >> 1) : c >> 1;
+                }
+                values[n] = c;
+            }
+            return values;
+        }();
+
+        uint32_t crc = 0xffffffffu;
+        for (size_t i = 0; i < size; ++i)
+        {
+            crc = table[(crc ^ data[i]) & 0xff] ^ (crc >> 8);
+        }
+        return crc ^ 0xffffffffu;
+    }
+
+    void WriteBigEndian(uint32_t value, std::vector<uint8_t>& output)
+    {
+        for (int shift = 24; shift >= 0; shift -= 8)
+        {
+            output.push_back(static_cast<uint8_t>(value >> shift));
+        }
+    }
+
+    void WriteChunk(const char* type, const std::vector<uint8_t>& data, std::vector<uint8_t>& output)
+    {
+        WriteBigEndian(static_cast<uint32_t>(data.size()), output);
+        const size_t start = output.size();
+        output.insert(output.end(), type, type + 4);
+        output.insert(output.end(), data.begin(), data.end());
+        WriteBigEndian(Crc32(output.data() + start, output.size() - start), output);
+    }
+
+    uint8_t PaethPredictor(int a, int b, int c)
+    {
+        const int p = a + b - c;
+        const int pa = std::abs(p - a);
+        const int pb = std::abs(p - b);
+        const int pc = std::abs(p - c);
+        return static_cast<uint8_t>((pa <= pb && pa <= pc) ? a : (pb <= pc) ? b : c);
+    }
+}
+
+void EncodePng(const ImageRGBA8& image, std::vector<uint8_t>& output)
+{
+    const size_t rowSize = static_cast<size_t>(image.width) * 4;
+
+    // each row uses the filter with the smallest sum of absolute (signed) values
+    std::vector<uint8_t> filtered;
+    filtered.reserve((rowSize + 1) * image.height);
+    std::vector<uint8_t> candidate(rowSize);
+    std::vector<uint8_t> best(rowSize);
+    const std::vector<uint8_t> zeroRow(rowSize, 0);
+    for (uint32_t y = 0; y < image.height; ++y)
+    {
+        const uint8_t* row = reinterpret_cast<const uint8_t*>(image.Row(y));
+        const uint8_t* above = (y > 0) ? reinterpret_cast<const uint8_t*>(image.Row(y - 1)) : zeroRow.data();
+
+        uint32_t bestFilter = 0;
+        uint64_t bestCost = UINT64_MAX;
+        for (uint32_t filter = 0; filter < 5; ++filter)
+        {
+            uint64_t cost = 0;
+            for (size_t x = 0; x < rowSize; ++x)
+            {
+                const int left = (x >= 4) ? row[x - 4] : 0;
+                const int upperLeft = (x >= 4) ? above[x - 4] : 0;
+                int prediction = 0;
+                switch (filter)
+                {
+                case 1: prediction = left; break;
+                case 2: prediction = above[x]; break;
+                case 3: prediction = (left + above[x]) / 2; break;
+                case 4: prediction = PaethPredictor(left, above[x], upperLeft); break;
+                default: break;
+                }
+                candidate[x] = static_cast<uint8_t>(row[x] - prediction);
+                cost += std::abs(static_cast<int8_t>(candidate[x]));
+            }
+
+            if (cost < bestCost)
+            {
+                bestCost = cost;
+                bestFilter = filter;
+                best.swap(candidate);
+            }
+        }
+
+        filtered.push_back(static_cast<uint8_t>(bestFilter));
+        filtered.insert(filtered.end(), best.begin(), best.end());
+    }
+
+    output.clear();
+    const uint8_t signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n' };
+    output.insert(output.end(), signature, signature + 8);
+
+    std::vector<uint8_t> header;
+    WriteBigEndian(image.width, header);
+    WriteBigEndian(image.height, header);
+    header.insert(header.end(), { 8, 6, 0, 0, 0 });  // 8 bits per channel, RGBA, deflate, adaptive filtering, no interlace
+    WriteChunk("IHDR", header, output);
+
+    std::vector<uint8_t> compressed;
+    Deflate(filtered, compressed);
+    WriteChunk("IDAT", compressed, output);
+    WriteChunk("IEND", { }, output);
+}
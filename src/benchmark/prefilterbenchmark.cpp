@@ -0,0 +1,99 @@
+#include "benchmark/benchmark.h"
+
+#include "cpu/rasterizer.h"
+#include "geometry.h"
+#include "util/threadpool.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+int RunPrefilterBenchmark(const BenchmarkOptions& options)
+{
+    struct Mesh
+    {
+        std::string name;
+        std::vector<VertexPosNormal> vertices;
+    };
+    std::vector<Mesh> meshes(3);
+    meshes[0].name = "data/mesh.obj";
+    if (!LoadObjFile("data/mesh.obj", meshes[0].vertices))
+    {
+        std::cerr << "Could not load data/mesh.obj (run the benchmark from the repository root)\n";
+        return -1;
+    }
+    // the finer the spheres, the more triangles fall between the pixel centers
+    meshes[1].name = "spheres 6x6x6, 16 rings";
+    CreateSphereGrid(6, 16, true, meshes[1].vertices);
+    meshes[2].name = "spheres 6x6x6, 48 rings";
+    CreateSphereGrid(6, 48, true, meshes[2].vertices);
+
+    ThreadPool pool(options.threads);
+    std::printf("triangle prefilter: %ux%u, %u frames, %zu threads, AVX2: %s\n", options.width, options.height, options.frames, pool.GetThreadCount(),
+        IsAvx2Supported() ? "yes" : "no (prefilter disabled)");
+    std::printf("%-32s %12s %12s %12s %12s %12s %12s\n", "mesh", "triangles", "culled %", "prefilt. %", "Mtri/s", "Mtri/s filt.", "speedup");
+
+    RasterizerSettings prefilterSettings;
+    prefilterSettings.prefilterTriangles = true;
+    RasterizerSettings settings;
+    settings.prefilterTriangles = false;
+    SoftwareRasterizer rasterizer(settings);
+    SoftwareRasterizer prefilterRasterizer(prefilterSettings);
+    SceneTransforms transforms;
+    SceneLight light;
+    SceneMaterial material;
+    ImageRGBA32F reference;
+    ImageRGBA32F color;
+    bool identical = true;
+
+    for (const Mesh& mesh : meshes)
+    {
+        double milliseconds = 0.0;
+        double prefilterMilliseconds = 0.0;
+        double trianglesCulled = 0.0;
+        double trianglesPrefiltered = 0.0;
+
+        for (uint32_t i = 0; i < options.frames; ++i)
+        {
+            SetUpDefaultScene(options.width, options.height, i * 1000.f / 60.f, transforms, light, material);
+
+            // the order alternates, so that neither one benefits from the caches warmed up by the other one
+            for (int pass = 0; pass < 2; ++pass)
+            {
+                if ((pass + i) % 2 == 0)
+                {
+                    rasterizer.Render(mesh.vertices, transforms, light, material, options.width, options.height, reference, &pool);
+                }
+                else
+                {
+                    prefilterRasterizer.Render(mesh.vertices, transforms, light, material, options.width, options.height, color, &pool);
+                }
+            }
+
+            const SoftwareRasterizer::Stats& stats = rasterizer.GetLastStats();
+            const SoftwareRasterizer::Stats& prefilterStats = prefilterRasterizer.GetLastStats();
+            milliseconds += stats.setupMilliseconds;
+            prefilterMilliseconds += prefilterStats.setupMilliseconds;
+            trianglesCulled += static_cast<double>(prefilterStats.trianglesCulled);
+            trianglesPrefiltered += static_cast<double>(prefilterStats.trianglesPrefiltered);
+
+            // the prefilter only rejects triangles the setup would cull, so everything has to be the same
+            identical = identical && stats.trianglesCulled == prefilterStats.trianglesCulled && stats.binnedTriangles == prefilterStats.binnedTriangles &&
+                std::memcmp(reference.pixels.data(), color.pixels.data(), color.pixels.size() * sizeof(ColorRGBA32F)) == 0 &&
+                rasterizer.GetDepthBuffer() == prefilterRasterizer.GetDepthBuffer();
+        }
+
+        const double frames = std::max(options.frames, 1u);
+        const double triangles = static_cast<double>(mesh.vertices.size() / 3);
+        PrintBenchmarkRow(mesh.name, { triangles, 100.0 * trianglesCulled / (triangles * frames), 100.0 * trianglesPrefiltered / (triangles * frames),
+            triangles * frames / std::max(milliseconds, 1e-6) / 1000.0, triangles * frames / std::max(prefilterMilliseconds, 1e-6) / 1000.0,
+            milliseconds / std::max(prefilterMilliseconds, 1e-6) });
+    }
+
+    std::printf("\nculled and prefiltered triangles of all triangles, triangles per second of the setup and binning phase\n");
+    std::printf("same triangles, image and depth with the prefilter: %s\n", identical ? "yes" : "NO");
+    return identical ? 0 : 1;
+}
@@ -0,0 +1,80 @@
+#include "benchmark/benchmark.h"
+
+#include "cpu/bloom.h"
+#include "cpu/qoi.h"
+#include "util/threadpool.h"
+#include "util/timer.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+int RunQoiBenchmark(const BenchmarkOptions& options)
+{
+    ThreadPool pool(options.threads);
+    const BloomSettings bloomSettings = CreateDefaultBloomSettings();
+
+    std::printf("QOI encoding: %ux%u, %u bloom frames, %zu threads\n", options.width, options.height, options.frames, pool.GetThreadCount());
+    std::printf("%-32s %12s %12s %12s\n", "codec", "ms", "MB/s", "ratio");
+
+    ImageRGBA32F scene;
+    ImageRGBA32F output;
+    BloomBuffers buffers;
+    ImageRGBA8 frame;
+    ImageRGBA8 decoded;
+
+    QoiEncoder encoder;
+    std::vector<uint8_t> encoded;
+    std::vector<uint8_t> stripeEncoded;
+
+    enum { PNG, QOI_REFERENCE, QOI_SINGLE_THREAD, QOI_MULTITHREADED, QOI_DECODE, CODEC_COUNT };
+    const char* names[CODEC_COUNT] = { "PNG (fixed Huffman)", "QOI reference", "QOI SIMD, 1 thread", "QOI SIMD, all threads", "QOI decode" };
+    double milliseconds[CODEC_COUNT] = { };
+    double encodedBytes[CODEC_COUNT] = { };
+    bool roundTripExact = true;
+    bool independentOfThreads = true;
+
+    for (uint32_t i = 0; i < options.frames; ++i)
+    {
+        RenderSyntheticScene(options.width, options.height, i / 60.f, scene);
+        ApplyBloom(scene, bloomSettings, buffers, output, &pool);
+        ConvertImage(output, frame);
+
+        auto measure = [&](int codec, auto&& encode)
+        {
+            Timer timer;
+            timer.Start();
+            encode();
+            timer.Stop();
+            milliseconds[codec] += timer.GetElapsedTimeMilliseconds();
+            encodedBytes[codec] += static_cast<double>(encoded.size());
+        };
+
+        measure(PNG, [&] { EncodePng(frame, encoded); });
+        measure(QOI_REFERENCE, [&] { EncodeQoiReference(frame, encoded); });
+        measure(QOI_SINGLE_THREAD, [&] { encoder.Encode(frame, encoded); });
+        stripeEncoded = encoded;
+        measure(QOI_MULTITHREADED, [&] { encoder.Encode(frame, encoded, &pool); });
+        independentOfThreads = independentOfThreads && encoded == stripeEncoded;
+
+        // the decoded image has to match the frame exactly
+        measure(QOI_DECODE, [&] { roundTripExact = DecodeQoi(encoded.data(), encoded.size(), decoded) && roundTripExact; });
+        roundTripExact = roundTripExact && decoded.width == frame.width && decoded.height == frame.height &&
+            std::memcmp(decoded.pixels.data(), frame.pixels.data(), frame.pixels.size() * sizeof(ColorRGBA8)) == 0;
+    }
+
+    // throughput and ratio refer to the uncompressed RGBA8 frames
+    const double frames = std::max(options.frames, 1u);
+    const double rawBytes = static_cast<double>(frame.pixels.size() * sizeof(ColorRGBA8)) * frames;
+    for (int codec = 0; codec < CODEC_COUNT; ++codec)
+    {
+        const double bytes = (codec == QOI_DECODE) ? encodedBytes[QOI_MULTITHREADED] : encodedBytes[codec];
+        PrintBenchmarkRow(names[codec], { milliseconds[codec] / frames, rawBytes / 1000.0 / std::max(milliseconds[codec], 1e-6),
+            rawBytes / std::max(bytes, 1.0) });
+    }
+
+    std::printf("\nstripe output independent of the thread count: %s, lossless round trip: %s\n", independentOfThreads ? "yes" : "NO",
+        roundTripExact ? "yes" : "NO");
+    return (independentOfThreads && roundTripExact) ? 0 : 1;
+}
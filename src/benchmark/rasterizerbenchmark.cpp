@@ -0,0 +1,89 @@
+#include "benchmark/benchmark.h"
+
+#include "cpu/rasterizer.h"
+#include "geometry.h"
+#include "util/threadpool.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+int RunRasterizerBenchmark(const BenchmarkOptions& options)
+{
+    std::vector<VertexPosNormal> mesh;
+    if (!LoadObjFile("data/mesh.obj", mesh))
+    {
+        std::cerr << "Could not load data/mesh.obj (run the benchmark from the repository root)\n";
+        return -1;
+    }
+
+    // 1, 2, 4, ... threads up to the given number of threads (default: hardware threads)
+    const uint32_t maxThreads = (options.threads > 0) ? options.threads : std::max(std::thread::hardware_concurrency(), 1u);
+    std::vector<uint32_t> threadCounts;
+    for (uint32_t threads = 1; threads < maxThreads; threads *= 2)
+    {
+        threadCounts.push_back(threads);
+    }
+    threadCounts.push_back(maxThreads);
+
+    std::printf("software rasterizer: %ux%u, %zu triangles, %u frames\n", options.width, options.height, mesh.size() / 3, options.frames);
+    std::printf("%-32s %12s %12s %12s %12s %12s\n", "threads", "frame ms", "speedup", "setup ms", "raster ms", "pixels");
+
+    SoftwareRasterizer rasterizer;
+    SceneTransforms transforms;
+    SceneLight light;
+    SceneMaterial material;
+    ImageRGBA32F color;
+    std::vector<ImageRGBA32F> referenceFrames(options.frames);
+    bool independentOfThreads = true;
+    double singleThreadMilliseconds = 0.0;
+    SoftwareRasterizer::Stats lastStats = { };
+
+    for (uint32_t threads : threadCounts)
+    {
+        ThreadPool pool(threads);
+        double setupMilliseconds = 0.0;
+        double rasterMilliseconds = 0.0;
+        double pixelsShaded = 0.0;
+
+        for (uint32_t i = 0; i < options.frames; ++i)
+        {
+            // same animation as the application at 60 frames/s
+            SetUpDefaultScene(options.width, options.height, i * 1000.f / 60.f, transforms, light, material);
+            rasterizer.Render(mesh, transforms, light, material, options.width, options.height, color, &pool);
+
+            lastStats = rasterizer.GetLastStats();
+            setupMilliseconds += lastStats.setupMilliseconds;
+            rasterMilliseconds += lastStats.rasterMilliseconds;
+            pixelsShaded += static_cast<double>(lastStats.pixelsShaded);
+
+            // the image has to be the same for every number of threads
+            if (threads == threadCounts.front())
+            {
+                referenceFrames[i] = color;
+            }
+            else
+            {
+                independentOfThreads = independentOfThreads && std::memcmp(referenceFrames[i].pixels.data(), color.pixels.data(),
+                    color.pixels.size() * sizeof(ColorRGBA32F)) == 0;
+            }
+        }
+
+        const double frames = std::max(options.frames, 1u);
+        const double frameMilliseconds = (setupMilliseconds + rasterMilliseconds) / frames;
+        if (threads == threadCounts.front())
+        {
+            singleThreadMilliseconds = frameMilliseconds;
+        }
+        PrintBenchmarkRow(std::to_string(threads), { frameMilliseconds, singleThreadMilliseconds / std::max(frameMilliseconds, 1e-6),
+            setupMilliseconds / frames, rasterMilliseconds / frames, pixelsShaded / frames });
+    }
+
+    std::printf("\nlast frame: %zu triangles culled, %zu clipped, %zu tile bins\n", lastStats.trianglesCulled, lastStats.trianglesClipped,
+        lastStats.binnedTriangles);
+    std::printf("image independent of the thread count: %s\n", independentOfThreads ? "yes" : "NO");
+    return independentOfThreads ? 0 : 1;
+}
@@ -0,0 +1,129 @@
+#include "benchmark/benchmark.h"
+
+#include "cpu/bloom.h"
+#include "cpu/rasterizer.h"
+#include "geometry.h"
+#include "render/bloomrenderer.h"
+#include "render/cpurenderdevice.h"
+#include "util/threadpool.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace
+{
+    // the CPU backend only differs from the CPU reference by the rounding of the texture coordinates in the composition
+    constexpr double MAX_IMAGE_ERROR = 1e-4;
+}
+
+int RunRenderBackendBenchmark(const BenchmarkOptions& options)
+{
+    std::vector<VertexPosNormal> mesh;
+    if (!LoadObjFile("data/mesh.obj", mesh))
+    {
+        std::cerr << "Could not load data/mesh.obj (run the benchmark from the repository root)\n";
+        return -1;
+    }
+
+    ThreadPool pool(options.threads);
+    std::printf("render backend: BloomRenderer on the CPU device, %ux%u, %u frames, %zu threads\n", options.width, options.height, options.frames,
+        pool.GetThreadCount());
+
+    SceneTransforms transforms;
+    SceneLight light;
+    SceneMaterial material;
+    SetUpDefaultScene(options.width, options.height, 0.f, transforms, light, material);
+
+    CpuRenderDevice device(options.width, options.height, &pool);
+    CpuRenderContext context(device);
+    BloomRenderer renderer;
+    const Resolution outputResolution = { options.width, options.height };
+    if (!renderer.Initialize(device, outputResolution, mesh, material))
+    {
+        return 1;
+    }
+
+    // reference: the software rasterizer followed by the CPU bloom
+    const BloomSettings settings = CreateDefaultBloomSettings();
+    SoftwareRasterizer rasterizer;
+    BloomBuffers buffers;
+    ImageRGBA32F scene;
+    ImageRGBA32F reference;
+
+    BloomFrameInputs inputs;
+    inputs.renderResolution = outputResolution;
+    inputs.threshold = settings.threshold;
+    inputs.blurParams = settings.blurParams;
+    inputs.compositeCoefficient = settings.compositeCoefficient;
+
+    // per-pass times of the dense and the sparse bloom
+    std::vector<std::string> passNames;
+    std::vector<double> passMilliseconds[2];
+    double maxError = 0.0;
+
+    for (uint32_t i = 0; i < options.frames; ++i)
+    {
+        SetUpDefaultScene(options.width, options.height, i * 1000.f / 60.f, transforms, light, material);
+        inputs.transforms = transforms;
+        inputs.light = light;
+
+        rasterizer.Render(mesh, transforms, light, material, options.width, options.height, scene, &pool);
+        ApplyBloom(scene, settings, buffers, reference, &pool);
+
+        // sparse first, so that the passes are listed in the order of the frame
+        for (int sparse = 1; sparse >= 0; --sparse)
+        {
+            inputs.sparseBloom = (sparse != 0);
+            renderer.Render(context, inputs);
+            context.Present();
+
+            for (const PassTiming& timing : context.GetPassTimings())
+            {
+                const size_t pass = std::find(passNames.begin(), passNames.end(), timing.name) - passNames.begin();
+                if (pass == passNames.size())
+                {
+                    passNames.push_back(timing.name);
+                    passMilliseconds[0].push_back(0.0);
+                    passMilliseconds[1].push_back(0.0);
+                }
+                passMilliseconds[sparse][pass] += timing.milliseconds;
+            }
+
+            maxError = std::max(maxError, ComputeImageError(reference, device.GetPresentedImage()).maxError);
+        }
+    }
+
+    std::printf("%-32s %12s %12s\n", "pass", "dense ms", "sparse ms");
+    const double frames = std::max(options.frames, 1u);
+    double frameMilliseconds[2] = { 0.0, 0.0 };
+    for (size_t pass = 0; pass < passNames.size(); ++pass)
+    {
+        PrintBenchmarkRow(passNames[pass], { passMilliseconds[0][pass] / frames, passMilliseconds[1][pass] / frames });
+        frameMilliseconds[0] += passMilliseconds[0][pass] / frames;
+        frameMilliseconds[1] += passMilliseconds[1][pass] / frames;
+    }
+    PrintBenchmarkRow("frame", { frameMilliseconds[0], frameMilliseconds[1] });
+
+    // a frame at a lower internal resolution and after resizing the output has to render as well
+    inputs.renderResolution = ComputeScaledResolution(outputResolution, 0.75f);
+    renderer.Render(context, inputs);
+    context.Present();
+    const Resolution resized = { std::max(options.width / 2, 2u), std::max(options.height / 2, 2u) };
+    const bool resizeSucceeded = device.ResizeBackBuffer(resized.width, resized.height) && renderer.Resize(resized);
+    inputs.renderResolution = resized;
+    renderer.Render(context, inputs);
+    context.Present();
+
+    // only the back buffer and its view are left after releasing the renderer
+    renderer.Release();
+    const bool noLeaks = (device.GetObjectCount() == 2);
+
+    const bool passed = maxError <= MAX_IMAGE_ERROR && resizeSucceeded && noLeaks;
+    std::printf("\nCPU time of the passes recorded through RenderContext, image compared to the software rasterizer and ApplyBloom()\n");
+    std::printf("max. error: %g (tolerance %g), resize: %s, all objects released: %s\n", maxError, MAX_IMAGE_ERROR, resizeSucceeded ? "yes" : "NO",
+        noLeaks ? "yes" : "NO");
+    return passed ? 0 : 1;
+}
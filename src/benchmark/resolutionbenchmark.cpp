@@ -0,0 +1,183 @@
+#include "benchmark/benchmark.h"
+
+#include "util/resolution.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+
+namespace
+{
+    // synthetic GPU time of a frame: a fixed part and a part proportional to the pixel count (scale^2), with a
+    // relative noise of up to +-noise
+    struct FrameCost
+    {
+        uint32_t frames;
+        float fixedMilliseconds;
+        float fullResolutionMilliseconds;
+        float noise;
+    };
+
+    // expected scale at the end of a trace
+    enum class Expectation
+    {
+        // below the max. scale with the frames within the budget (up to the noise)
+        StepDown,
+        // at the max. scale after having been below it
+        Recover,
+        // clamped to the min. scale
+        MinScale,
+        // never changed from the max. scale
+        Unchanged,
+        // below the max. scale, without reversals and without changes in the second half of the last phase
+        Settle
+    };
+
+    struct Trace
+    {
+        const char* name;
+        Expectation expectation;
+        std::vector<FrameCost> phases;
+    };
+
+    struct TraceResult
+    {
+        uint32_t frames;
+        uint32_t scaleChanges;
+        // changes in the opposite direction of the previous change
+        uint32_t reversals;
+        // changes after the first half of the last phase
+        uint32_t lateChanges;
+        float minScale;
+        float maxScale;
+        float finalScale;
+        float finalFrameTime;
+        // a change happened before the cooldown was over
+        bool cooldownViolated;
+        // the scale left [minScale, maxScale] of the settings
+        bool outOfRange;
+    };
+
+    // deterministic noise in [-1, 1]
+    class NoiseGenerator
+    {
+    public:
+        float Next() noexcept
+        {
+            m_state = m_state * 1664525u + 1013904223u;
+            return static_cast<float>(m_state >> 8) / static_cast<float>(1u << 23) - 1.f;
+        }
+
+    private:
+        uint32_t m_state = 12345u;
+    };
+
+    TraceResult RunTrace(const Trace& trace, const DynamicResolutionController::Settings& settings)
+    {
+        DynamicResolutionController controller(settings);
+        NoiseGenerator noise;
+
+        TraceResult result = { };
+        result.minScale = controller.GetScale();
+        result.maxScale = controller.GetScale();
+
+        uint32_t framesSinceChange = 0;
+        int lastDirection = 0;
+        for (size_t phase = 0; phase < trace.phases.size(); ++phase)
+        {
+            const FrameCost& cost = trace.phases[phase];
+            for (uint32_t frame = 0; frame < cost.frames; ++frame)
+            {
+                // the frame is rendered with the current scale, its time decides the scale of the next one
+                const float scale = controller.GetScale();
+                const float frameTime = (cost.fixedMilliseconds + cost.fullResolutionMilliseconds * scale * scale) * (1.f + cost.noise * noise.Next());
+                const float newScale = controller.Update(frameTime);
+                ++framesSinceChange;
+                ++result.frames;
+
+                if (newScale != scale)
+                {
+                    const int direction = (newScale > scale) ? 1 : -1;
+                    result.reversals += (lastDirection != 0 && direction != lastDirection) ? 1 : 0;
+                    result.cooldownViolated = result.cooldownViolated || framesSinceChange < settings.cooldownFrames;
+                    result.lateChanges += (phase + 1 == trace.phases.size() && frame >= cost.frames / 2) ? 1 : 0;
+                    ++result.scaleChanges;
+                    lastDirection = direction;
+                    framesSinceChange = 0;
+                }
+
+                result.outOfRange = result.outOfRange || newScale < settings.minScale || newScale > settings.maxScale;
+                result.minScale = std::min(result.minScale, newScale);
+                result.maxScale = std::max(result.maxScale, newScale);
+                result.finalFrameTime = frameTime;
+            }
+        }
+
+        result.finalScale = controller.GetScale();
+        return result;
+    }
+
+    bool MeetsExpectation(const Trace& trace, const TraceResult& result, const DynamicResolutionController::Settings& settings)
+    {
+        // every trace: the scale stays in range and the cooldown is respected
+        if (result.outOfRange || result.cooldownViolated)
+        {
+            return false;
+        }
+
+        const float budget = settings.targetFrameTimeMilliseconds;
+        switch (trace.expectation)
+        {
+        case Expectation::StepDown:
+            return result.finalScale < settings.maxScale && result.finalFrameTime <= budget * (1.f + trace.phases.back().noise);
+        case Expectation::Recover:
+            return result.finalScale == settings.maxScale && result.minScale < settings.maxScale;
+        case Expectation::MinScale:
+            return result.finalScale == settings.minScale;
+        case Expectation::Unchanged:
+            return result.scaleChanges == 0;
+        case Expectation::Settle:
+            return result.finalScale < settings.maxScale && result.reversals == 0 && result.lateChanges == 0;
+        }
+        return false;
+    }
+}
+
+int RunDynamicResolutionBenchmark(const BenchmarkOptions&)
+{
+    const DynamicResolutionController::Settings settings;
+    const float budget = settings.targetFrameTimeMilliseconds;
+
+    // frame costs relative to the budget: 2 ms that do not scale with the resolution, the rest does
+    const float fixed = 2.f;
+    auto fullResolutionCost = [&](float frameTimeAtFullResolution) { return frameTimeAtFullResolution - fixed; };
+    // the cost at which the frame time is exactly the budget at a scale of 0.8
+    const float atBudgetCost = (budget - fixed) / (0.8f * 0.8f);
+
+    const Trace traces[] = {
+        { "over budget", Expectation::StepDown, { { 240, fixed, fullResolutionCost(1.8f * budget), 0.05f } } },
+        { "recovery", Expectation::Recover, { { 240, fixed, fullResolutionCost(1.8f * budget), 0.05f }, { 240, fixed, fullResolutionCost(0.5f * budget), 0.05f } } },
+        { "far over budget", Expectation::MinScale, { { 240, fixed, fullResolutionCost(20.f * budget), 0.05f } } },
+        { "far under budget", Expectation::Unchanged, { { 240, fixed, fullResolutionCost(0.1f * budget), 0.05f } } },
+        { "under budget within headroom", Expectation::Unchanged, { { 480, fixed, fullResolutionCost(0.95f * budget), 0.03f } } },
+        { "at the budget", Expectation::Settle, { { 960, fixed, atBudgetCost, 0.03f } } } };
+
+    std::printf("dynamic resolution: synthetic GPU time traces, budget %.2f ms, scale [%.2f, %.2f] in steps of %.2f, headroom %.2f, cooldown %u frames\n",
+        budget, settings.minScale, settings.maxScale, settings.scaleStep, settings.headroom, settings.cooldownFrames);
+    std::printf("%-32s %12s %12s %12s %12s %12s %12s %12s %12s\n", "trace", "frames", "changes", "reversals", "min. scale", "max. scale", "final scale",
+        "final ms", "passed");
+
+    bool passed = true;
+    for (const Trace& trace : traces)
+    {
+        const TraceResult result = RunTrace(trace, settings);
+        const bool tracePassed = MeetsExpectation(trace, result, settings);
+        PrintBenchmarkRow(trace.name, { static_cast<double>(result.frames), static_cast<double>(result.scaleChanges), static_cast<double>(result.reversals),
+            result.minScale, result.maxScale, result.finalScale, result.finalFrameTime, tracePassed ? 1.0 : 0.0 });
+        passed = passed && tracePassed;
+    }
+
+    std::printf("\nchanges: scale changes, reversals: changes in the opposite direction of the previous one, final ms: time of the last frame\n");
+    std::printf("all traces as expected: %s\n", passed ? "yes" : "NO");
+    return passed ? 0 : 1;
+}
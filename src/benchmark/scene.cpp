@@ -0,0 +1,107 @@
+#include "benchmark/benchmark.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+void RenderSyntheticScene(uint32_t width, uint32_t height, float time, ImageRGBA32F& scene)
+{
+    constexpr int NUM_DISCS = 6;
+    constexpr float TWO_PI = 6.2831853f;
+
+    scene.Resize(width, height);
+
+    const float centerX = 0.5f * static_cast<float>(width);
+    const float centerY = 0.5f * static_cast<float>(height);
+    const float minExtent = static_cast<float>(std::min(width, height));
+
+    // disc centers orbit the image center
+    float discX[NUM_DISCS];
+    float discY[NUM_DISCS];
+    float discRadiusSq[NUM_DISCS];
+    for (int i = 0; i < NUM_DISCS; ++i)
+    {
+        float angle = TWO_PI * (0.1f * time + static_cast<float>(i) / NUM_DISCS);
+        float orbit = minExtent * (0.15f + 0.05f * static_cast<float>(i % 3));
+        float radius = minExtent * (0.02f + 0.01f * static_cast<float>(i % 2));
+
+        discX[i] = centerX + orbit * std::cos(angle);
+        discY[i] = centerY + orbit * std::sin(angle);
+        discRadiusSq[i] = radius * radius;
+    }
+
+    for (uint32_t y = 0; y < height; ++y)
+    {
+        ColorRGBA32F* row = scene.Row(y);
+        const float fy = static_cast<float>(y);
+        const float gradient = 0.1f + 0.2f * fy / static_cast<float>(height);
+
+        for (uint32_t x = 0; x < width; ++x)
+        {
+            const float fx = static_cast<float>(x);
+            ColorRGBA32F color = { gradient, gradient, 0.5f * gradient + 0.05f, 1.f };
+
+            for (int i = 0; i < NUM_DISCS; ++i)
+            {
+                float dx = fx - discX[i];
+                float dy = fy - discY[i];
+                float distanceSq = dx * dx + dy * dy;
+                if (distanceSq < discRadiusSq[i])
+                {
+                    // bright, slightly falling off towards the border
+                    float intensity = 1.f - 0.5f * distanceSq / discRadiusSq[i];
+                    color = ColorRGBA32F{ intensity, intensity * 0.9f, intensity * 0.6f, 1.f };
+                }
+            }
+
+            row[x] = color;
+        }
+    }
+}
+
+void CreateSphereGrid(uint32_t spheresPerAxis, uint32_t rings, bool frontToBack, std::vector<VertexPosNormal>& mesh)
+{
+    const float pi = 3.14159265f;
+    const uint32_t slices = 2 * rings;
+    const float spacing = 0.7f / spheresPerAxis;
+    const float radius = 0.6f * spacing;
+
+    auto vertex = [&](const float center[3], uint32_t ring, uint32_t slice)
+    {
+        const float theta = pi * ring / rings;
+        const float phi = 2.f * pi * slice / slices;
+        const float n[3] = { std::sin(theta) * std::cos(phi), std::cos(theta), std::sin(theta) * std::sin(phi) };
+        return VertexPosNormal{ center[0] + radius * n[0], center[1] + radius * n[1], center[2] + radius * n[2], n[0], n[1], n[2] };
+    };
+
+    mesh.clear();
+    for (uint32_t i = 0; i < spheresPerAxis * spheresPerAxis * spheresPerAxis; ++i)
+    {
+        // the camera looks along -z, so the front layer has the largest z
+        const uint32_t layer = frontToBack ? i / spheresPerAxis / spheresPerAxis : spheresPerAxis - 1 - i / spheresPerAxis / spheresPerAxis;
+        const float center[3] = { (i % spheresPerAxis + 0.5f) * spacing - 0.35f, (i / spheresPerAxis % spheresPerAxis + 0.5f) * spacing - 0.35f,
+            0.35f - (layer + 0.5f) * spacing };
+        for (uint32_t ring = 0; ring < rings; ++ring)
+        {
+            for (uint32_t slice = 0; slice < slices; ++slice)
+            {
+                // clockwise seen from the outside
+                const VertexPosNormal v00 = vertex(center, ring, slice);
+                const VertexPosNormal v01 = vertex(center, ring, slice + 1);
+                const VertexPosNormal v10 = vertex(center, ring + 1, slice);
+                const VertexPosNormal v11 = vertex(center, ring + 1, slice + 1);
+                mesh.insert(mesh.end(), { v00, v01, v11, v00, v11, v10 });
+            }
+        }
+    }
+}
+
+void PrintBenchmarkRow(const std::string& name, std::initializer_list<double> values)
+{
+    std::printf("%-32s", name.c_str());
+    for (double value : values)
+    {
+        std::printf(" %12.4f", value);
+    }
+    std::printf("\n");
+}
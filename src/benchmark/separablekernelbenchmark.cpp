@@ -0,0 +1,84 @@
+#include "benchmark/benchmark.h"
+
+#include "cpu/bloom.h"
+#include "cpu/kernel.h"
+#include "cpu/separablekernel.h"
+#include "util/threadpool.h"
+#include "util/timer.h"
+
+#include <algorithm>
+#include <cstdio>
+
+namespace
+{
+    struct TestKernel
+    {
+        const char* name;
+        Kernel2D kernel;
+    };
+}
+
+int RunSeparableKernelBenchmark(const BenchmarkOptions& options)
+{
+    ThreadPool pool(options.threads);
+    const BloomSettings bloomSettings = CreateDefaultBloomSettings();
+    const uint32_t runs = std::max(std::min(options.frames, 5u), 1u);
+
+    ImageRGBA32F scene;
+    ImageRGBA32F thresholded;
+    RenderSyntheticScene(options.width, options.height, 0.f, scene);
+    ThresholdAndDownsample(scene, bloomSettings.threshold, thresholded, &pool);
+
+    const TestKernel testKernels[] = {
+        { "gaussian r7", CreateGaussianKernel2D(bloomSettings.blurParams) },
+        { "streak 32x4", CreateStreakKernel(32, 4) },
+        { "streak 32x4 rotated 30 deg", CreateStreakKernel(32, 4, 0.5235988f) },
+        { "star r16, 4 rays", CreateStarKernel(16, 4) },
+        { "star r32, 6 rays", CreateStarKernel(32, 6) },
+    };
+    const double tolerances[] = { 1e-1, 3e-2, 1e-2, 3e-3, 1e-3 };
+
+    std::printf("separable approximation: %ux%u (half-res %ux%u), %zu threads\n", options.width, options.height,
+        thresholded.width, thresholded.height, pool.GetThreadCount());
+    std::printf("%-32s %12s %12s %12s %12s %12s %12s %12s\n", "kernel / tolerance", "rank", "kernel err", "image err",
+        "sep. ms", "direct ms", "speedup", "decomp. ms");
+
+    ImageRGBA32F directResult;
+    ImageRGBA32F separableResult;
+    ImageRGBA32F temp;
+    for (const TestKernel& testKernel : testKernels)
+    {
+        Timer timer;
+        timer.Start();
+        for (uint32_t run = 0; run < runs; ++run)
+        {
+            Convolve2D(thresholded, testKernel.kernel, directResult, &pool);
+        }
+        timer.Stop();
+        const double directMilliseconds = timer.GetElapsedTimeMilliseconds() / runs;
+
+        for (double tolerance : tolerances)
+        {
+            timer.Start();
+            const SeparableKernel separable = DecomposeKernel(testKernel.kernel, tolerance);
+            timer.Stop();
+            const double decompositionMilliseconds = timer.GetElapsedTimeMilliseconds();
+
+            timer.Start();
+            for (uint32_t run = 0; run < runs; ++run)
+            {
+                ConvolveSeparable(thresholded, separable, temp, separableResult, &pool);
+            }
+            timer.Stop();
+            const double separableMilliseconds = timer.GetElapsedTimeMilliseconds() / runs;
+
+            char name[64];
+            std::snprintf(name, sizeof(name), "%s / %g", testKernel.name, tolerance);
+            PrintBenchmarkRow(name, { static_cast<double>(separable.terms.size()), separable.relativeError,
+                ComputeImageError(directResult, separableResult).maxError, separableMilliseconds, directMilliseconds,
+                directMilliseconds / std::max(separableMilliseconds, 1e-6), decompositionMilliseconds });
+        }
+    }
+
+    return 0;
+}
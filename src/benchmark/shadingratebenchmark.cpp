@@ -0,0 +1,109 @@
+#include "benchmark/benchmark.h"
+
+#include "cpu/rasterizer.h"
+#include "geometry.h"
+#include "util/threadpool.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <vector>
+
+int RunShadingRateBenchmark(const BenchmarkOptions& options)
+{
+    struct Mesh
+    {
+        std::string name;
+        std::vector<VertexPosNormal> vertices;
+    };
+    std::vector<Mesh> meshes(2);
+    meshes[0].name = "mesh.obj";
+    if (!LoadObjFile("data/mesh.obj", meshes[0].vertices))
+    {
+        std::cerr << "Could not load data/mesh.obj (run the benchmark from the repository root)\n";
+        return -1;
+    }
+    meshes[1].name = "spheres 3x3x3";
+    CreateSphereGrid(3, 16, true, meshes[1].vertices);
+
+    ThreadPool pool(options.threads);
+    std::printf("adaptive shading rate: %ux%u, %u frames, %zu threads\n", options.width, options.height, options.frames, pool.GetThreadCount());
+    std::printf("%-32s %12s %12s %12s %12s %12s %12s %12s\n", "mesh, threshold", "sh/px", "saved %", "coarse %", "full ms", "adaptive ms",
+        "max. error", "mean error");
+
+    RasterizerSettings fullRateSettings;
+    fullRateSettings.visibilityBuffer = true;
+    SoftwareRasterizer fullRateRasterizer(fullRateSettings);
+    SceneTransforms transforms;
+    SceneLight light;
+    SceneMaterial material;
+    ImageRGBA32F reference;
+    ImageRGBA32F color;
+
+    for (const Mesh& mesh : meshes)
+    {
+        for (float threshold : { 1e-4f, 1e-3f, 1e-2f })
+        {
+            RasterizerSettings settings = fullRateSettings;
+            settings.shadingRateThreshold = threshold;
+            SoftwareRasterizer rasterizer(settings);
+
+            double fullRateMilliseconds = 0.0;
+            double milliseconds = 0.0;
+            double pixelsShaded = 0.0;
+            double pixelsShadedCoarse = 0.0;
+            double coveredPixels = 0.0;
+            double maxError = 0.0;
+            double errorSum = 0.0;
+
+            for (uint32_t i = 0; i < options.frames; ++i)
+            {
+                SetUpDefaultScene(options.width, options.height, i * 1000.f / 60.f, transforms, light, material);
+
+                // the order alternates, so that neither one benefits from the caches warmed up by the other one
+                for (int pass = 0; pass < 2; ++pass)
+                {
+                    if ((pass + i) % 2 == 0)
+                    {
+                        fullRateRasterizer.Render(mesh.vertices, transforms, light, material, options.width, options.height, reference, &pool);
+                    }
+                    else
+                    {
+                        rasterizer.Render(mesh.vertices, transforms, light, material, options.width, options.height, color, &pool);
+                    }
+                }
+
+                const SoftwareRasterizer::Stats& fullRateStats = fullRateRasterizer.GetLastStats();
+                const SoftwareRasterizer::Stats& stats = rasterizer.GetLastStats();
+                fullRateMilliseconds += fullRateStats.setupMilliseconds + fullRateStats.rasterMilliseconds;
+                milliseconds += stats.setupMilliseconds + stats.rasterMilliseconds;
+                // every covered pixel is shaded once at the full rate
+                coveredPixels += static_cast<double>(fullRateStats.pixelsShaded);
+                pixelsShaded += static_cast<double>(stats.pixelsShaded);
+                pixelsShadedCoarse += static_cast<double>(stats.pixelsShadedCoarse);
+
+                // error of the covered pixels against full rate shading
+                for (size_t p = 0; p < color.pixels.size(); ++p)
+                {
+                    const double error = std::max({ std::abs(color.pixels[p].r - reference.pixels[p].r), std::abs(color.pixels[p].g - reference.pixels[p].g),
+                        std::abs(color.pixels[p].b - reference.pixels[p].b) });
+                    maxError = std::max(maxError, error);
+                    errorSum += error;
+                }
+            }
+
+            const double frames = std::max(options.frames, 1u);
+            coveredPixels = std::max(coveredPixels, 1.0);
+            char name[64];
+            std::snprintf(name, sizeof(name), "%s, %g", mesh.name.c_str(), threshold);
+            PrintBenchmarkRow(name, { pixelsShaded / coveredPixels, 100.0 * (1.0 - pixelsShaded / coveredPixels), 100.0 * pixelsShadedCoarse / coveredPixels,
+                fullRateMilliseconds / frames, milliseconds / frames, maxError, errorSum / coveredPixels });
+        }
+    }
+
+    std::printf("\nshading invocations per covered pixel, covered pixels shaded at a coarse rate, error of the colors against full rate\n");
+    std::printf("shading (in [0, 1], max. of the RGB channels, mean over the covered pixels)\n");
+    return 0;
+}
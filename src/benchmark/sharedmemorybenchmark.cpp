@@ -0,0 +1,198 @@
+#include "benchmark/benchmark.h"
+
+#include "capture/sharedframering.h"
+#include "cpu/bloom.h"
+#include "util/timer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifndef _WIN32
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+    // frames published for each configuration (per frame of the options)
+    constexpr uint32_t FRAMES_PER_OPTION_FRAME = 10;
+
+    // results of the consumer process, sent back through a pipe
+    struct ConsumerResult
+    {
+        uint64_t framesRead;
+        uint64_t framesSkipped;
+        uint64_t framesTorn;
+        double milliseconds;
+        double meanLatencyMicroseconds;
+        double p99LatencyMicroseconds;
+        double maxLatencyMicroseconds;
+    };
+
+#ifndef _WIN32
+    // reads frames until the writer closes the ring, like bloom_shm_consumer (the pixels are summed up in place)
+    ConsumerResult RunConsumer(const std::string& name, int readyPipe)
+    {
+        ConsumerResult result = { };
+        SharedFrameRingReader reader;
+        const bool opened = reader.Open(name);
+        const char ready = opened ? 1 : 0;
+        if (write(readyPipe, &ready, 1) != 1 || !opened)
+        {
+            return result;
+        }
+
+        const size_t size = static_cast<size_t>(reader.GetWidth()) * reader.GetHeight() * 4;
+        std::vector<double> latencies;
+        uint64_t checksum = 0;
+        Timer timer;
+        timer.Start();
+
+        SharedFrameRingReader::Frame frame;
+        while (reader.WaitForFrame(frame, 5000.f) == SharedFrameRingReader::Status::Frame)
+        {
+            const double latency = (GetSharedFrameTimestamp() - frame.timestampNanoseconds) / 1000.0;
+            uint64_t sum = 0;
+            for (size_t i = 0; i < size; i += 4)
+            {
+                sum += frame.pixels[i + 1];
+            }
+            if (reader.Release(frame))
+            {
+                checksum += sum;
+                latencies.push_back(latency);
+            }
+        }
+        timer.Stop();
+
+        result.framesRead = reader.GetStats().framesRead;
+        result.framesSkipped = reader.GetStats().framesSkipped;
+        result.framesTorn = reader.GetStats().framesTorn;
+        result.milliseconds = timer.GetElapsedTimeMilliseconds();
+        if (!latencies.empty())
+        {
+            std::sort(latencies.begin(), latencies.end());
+            double sum = 0.0;
+            for (double latency : latencies)
+            {
+                sum += latency;
+            }
+            result.meanLatencyMicroseconds = sum / latencies.size();
+            result.p99LatencyMicroseconds = latencies[latencies.size() * 99 / 100];
+            result.maxLatencyMicroseconds = latencies.back();
+        }
+        // keeps the summation from being optimized away
+        result.framesRead += (checksum == UINT64_MAX) ? 1 : 0;
+        return result;
+    }
+#endif
+}
+
+int RunSharedMemoryBenchmark(const BenchmarkOptions& options)
+{
+#ifdef _WIN32
+    (void)options;
+    std::printf("the shared memory frame ring needs POSIX shared memory (Linux)\n");
+    return -1;
+#else
+    // no thread pool: the consumer is forked and the process must not have other threads at that time
+    ImageRGBA32F scene;
+    ImageRGBA32F output;
+    BloomBuffers buffers;
+    ImageRGBA8 frame;
+    RenderSyntheticScene(options.width, options.height, 0.f, scene);
+    ApplyBloom(scene, CreateDefaultBloomSettings(), buffers, output);
+    ConvertImage(output, frame);
+
+    const uint32_t frameCount = std::max(options.frames, 1u) * FRAMES_PER_OPTION_FRAME;
+    const std::string name = "/bloom_benchmark_" + std::to_string(getpid());
+    const double frameBytes = static_cast<double>(frame.pixels.size() * sizeof(ColorRGBA8));
+
+    std::printf("shared memory frame ring: %ux%u, %u frames per run, consumer in a separate process\n", options.width, options.height, frameCount);
+    std::printf("%-32s %12s %12s %12s %12s %12s %12s %12s\n", "mode", "publish ms", "GB/s", "read fps", "mean us", "p99 us", "skipped", "torn");
+
+    // interval = 0: the writer publishes as fast as possible
+    auto run = [&](const std::string& mode, uint32_t slotCount, std::chrono::microseconds interval)
+    {
+        SharedFrameRingWriter ring;
+        int pipes[2];
+        if (!ring.Create(name, frame.width, frame.height, slotCount) || pipe(pipes) != 0)
+        {
+            std::printf("%-32s could not create the ring\n", mode.c_str());
+            return false;
+        }
+
+        std::fflush(stdout);
+        const pid_t child = fork();
+        if (child == 0)
+        {
+            close(pipes[0]);
+            const ConsumerResult result = RunConsumer(name, pipes[1]);
+            const bool success = write(pipes[1], &result, sizeof(result)) == static_cast<ssize_t>(sizeof(result));
+            _exit(success ? 0 : 1);
+        }
+        close(pipes[1]);
+
+        char ready = 0;
+        if (child < 0 || read(pipes[0], &ready, 1) != 1 || ready == 0)
+        {
+            std::printf("%-32s could not start the consumer\n", mode.c_str());
+            close(pipes[0]);
+            if (child > 0)
+            {
+                waitpid(child, nullptr, 0);
+            }
+            return false;
+        }
+
+        double publishMilliseconds = 0.0;
+        auto nextFrameTime = std::chrono::steady_clock::now();
+        for (uint32_t i = 0; i < frameCount; ++i)
+        {
+            if (interval.count() > 0)
+            {
+                nextFrameTime += interval;
+                std::this_thread::sleep_until(nextFrameTime);
+            }
+
+            Timer timer;
+            timer.Start();
+            ring.Publish(reinterpret_cast<const uint8_t*>(frame.pixels.data()));
+            timer.Stop();
+            publishMilliseconds += timer.GetElapsedTimeMilliseconds();
+        }
+        ring.Close();
+
+        ConsumerResult result = { };
+        const bool received = read(pipes[0], &result, sizeof(result)) == static_cast<ssize_t>(sizeof(result));
+        close(pipes[0]);
+        waitpid(child, nullptr, 0);
+        if (!received)
+        {
+            std::printf("%-32s the consumer failed\n", mode.c_str());
+            return false;
+        }
+
+        PrintBenchmarkRow(mode, { publishMilliseconds / frameCount, frameBytes * frameCount / 1e6 / std::max(publishMilliseconds, 1e-6),
+            1000.0 * result.framesRead / std::max(result.milliseconds, 1e-6), result.meanLatencyMicroseconds, result.p99LatencyMicroseconds,
+            static_cast<double>(result.framesSkipped), static_cast<double>(result.framesTorn) });
+        return true;
+    };
+
+    bool success = true;
+    for (uint32_t slotCount : { 2u, 3u, 8u })
+    {
+        success = run("unpaced, " + std::to_string(slotCount) + " slots", slotCount, std::chrono::microseconds(0)) && success;
+    }
+    for (uint32_t intervalMicroseconds : { 16667u, 2000u })
+    {
+        success = run("every " + std::to_string(intervalMicroseconds) + " us, 3 slots", 3, std::chrono::microseconds(intervalMicroseconds)) && success;
+    }
+
+    return success ? 0 : 1;
+#endif
+}
@@ -0,0 +1,74 @@
+#include "benchmark/benchmark.h"
+
+#include "cpu/bloom.h"
+#include "cpu/sparsebloom.h"
+#include "util/threadpool.h"
+#include "util/timer.h"
+
+#include <algorithm>
+#include <cstdio>
+
+int RunSparseBloomBenchmark(const BenchmarkOptions& options)
+{
+    ThreadPool pool(options.threads);
+    const BloomSettings defaultSettings = CreateDefaultBloomSettings();
+
+    std::printf("sparse bloom: %ux%u, %u frames, %zu threads\n", options.width, options.height, options.frames, pool.GetThreadCount());
+    std::printf("%-32s %12s %12s %12s %12s %12s %12s\n", "threshold", "dense ms", "sparse ms", "speedup", "bright %", "skipped %", "max error");
+
+    // higher thresholds leave fewer bright tiles in the synthetic scene
+    const float thresholds[] = { 0.f, 0.25f, 0.5f, 0.75f, 1.f, 2.f };
+
+    ImageRGBA32F scene;
+    BloomBuffers referenceBuffers;
+    BloomBuffers sparseBuffers;
+    for (float threshold : thresholds)
+    {
+        BloomSettings bloomSettings = defaultSettings;
+        bloomSettings.threshold = threshold;
+
+        SparseBloom sparseBloom;
+
+        double denseMilliseconds = 0.0;
+        double sparseMilliseconds = 0.0;
+        double brightTiles = 0.0;
+        double skippedPixels = 0.0;
+        double maxError = 0.0;
+
+        for (uint32_t frame = 0; frame < options.frames; ++frame)
+        {
+            RenderSyntheticScene(options.width, options.height, frame / 60.f, scene);
+
+            Timer timer;
+            timer.Start();
+            ComputeBloom(scene, bloomSettings, referenceBuffers, &pool);
+            timer.Stop();
+            denseMilliseconds += timer.GetElapsedTimeMilliseconds();
+
+            timer.Start();
+            sparseBloom.Process(scene, bloomSettings, sparseBuffers, &pool);
+            timer.Stop();
+            sparseMilliseconds += timer.GetElapsedTimeMilliseconds();
+
+            const SparseBloom::Stats& stats = sparseBloom.GetLastFrameStats();
+            const double tilesTotal = std::max(stats.tilesTotal, 1u);
+            brightTiles += stats.tilesBright / tilesTotal;
+            // both blur passes of the dense path process every tile once
+            skippedPixels += stats.pixelsSkipped / (2.0 * tilesTotal * BLOOM_TILE_SIZE * BLOOM_TILE_SIZE);
+
+            // ComputeImageError() only compares RGB, the alpha of skipped tiles differs by design
+            maxError = std::max(maxError, ComputeImageError(referenceBuffers.bloom, sparseBuffers.bloom).maxError);
+        }
+
+        const double frames = std::max(options.frames, 1u);
+        denseMilliseconds /= frames;
+        sparseMilliseconds /= frames;
+
+        char name[64];
+        std::snprintf(name, sizeof(name), "%.2f", threshold);
+        PrintBenchmarkRow(name, { denseMilliseconds, sparseMilliseconds, denseMilliseconds / std::max(sparseMilliseconds, 1e-6),
+            100.0 * brightTiles / frames, 100.0 * skippedPixels / frames, maxError });
+    }
+
+    return 0;
+}
@@ -0,0 +1,160 @@
+#include "benchmark/benchmark.h"
+
+#include "cpu/bloom.h"
+#include "geometry.h"
+#include "render/bloomrenderer.h"
+#include "render/cpurenderdevice.h"
+#include "render/dryrunrenderdevice.h"
+#include "render/recordingrendercontext.h"
+#include "render/statecachecontext.h"
+#include "util/threadpool.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <iostream>
+#include <vector>
+
+namespace
+{
+    BloomFrameInputs CreateFrameInputs(uint32_t width, uint32_t height, bool sparse)
+    {
+        SceneTransforms transforms;
+        SceneLight light;
+        SceneMaterial material;
+        SetUpDefaultScene(width, height, 0.f, transforms, light, material);
+
+        const BloomSettings settings = CreateDefaultBloomSettings();
+        BloomFrameInputs inputs;
+        inputs.transforms = transforms;
+        inputs.light = light;
+        inputs.renderResolution = { width, height };
+        inputs.threshold = settings.threshold;
+        inputs.blurParams = settings.blurParams;
+        inputs.compositeCoefficient = settings.compositeCoefficient;
+        inputs.sparseBloom = sparse;
+        return inputs;
+    }
+
+    // records frames of the renderer on the dry run device, optionally through the state cache, and returns the call
+    // counts of the last frame
+    bool CountCalls(const BenchmarkOptions& options, const std::vector<VertexPosNormal>& mesh, bool sparse, bool cached,
+        RecordingRenderContext::CallCounts& counts, size_t& hazards)
+    {
+        DryRunRenderDevice device(options.width, options.height);
+        DryRunRenderContext context(device);
+        RecordingRenderContext recorder(context);
+        StateCacheContext stateCache(recorder);
+        RenderContext& target = cached ? static_cast<RenderContext&>(stateCache) : recorder;
+
+        SceneTransforms transforms;
+        SceneLight light;
+        SceneMaterial material;
+        SetUpDefaultScene(options.width, options.height, 0.f, transforms, light, material);
+
+        BloomRenderer renderer;
+        if (!renderer.Initialize(device, { options.width, options.height }, mesh, material))
+        {
+            return false;
+        }
+
+        const BloomFrameInputs inputs = CreateFrameInputs(options.width, options.height, sparse);
+        for (uint32_t frame = 0; frame < std::max(options.frames, 2u); ++frame)
+        {
+            renderer.Render(target, inputs);
+            target.Present();
+        }
+
+        counts = recorder.GetLastFrameCallCounts();
+        hazards = context.GetHazardCount();
+        return true;
+    }
+
+    // the image of the CPU device after a few frames, optionally through the state cache
+    bool RenderImage(const BenchmarkOptions& options, const std::vector<VertexPosNormal>& mesh, bool cached, ThreadPool& pool, ImageRGBA32F& image)
+    {
+        CpuRenderDevice device(options.width, options.height, &pool);
+        CpuRenderContext context(device);
+        StateCacheContext stateCache(context);
+        RenderContext& target = cached ? static_cast<RenderContext&>(stateCache) : context;
+
+        SceneTransforms transforms;
+        SceneLight light;
+        SceneMaterial material;
+        SetUpDefaultScene(options.width, options.height, 0.f, transforms, light, material);
+
+        BloomRenderer renderer;
+        if (!renderer.Initialize(device, { options.width, options.height }, mesh, material))
+        {
+            return false;
+        }
+
+        // sparse and dense frames alternate, so that the cached state has to follow the changing shaders
+        for (int frame = 0; frame < 3; ++frame)
+        {
+            renderer.Render(target, CreateFrameInputs(options.width, options.height, frame != 1));
+            target.Present();
+        }
+
+        image = device.GetPresentedImage();
+        return true;
+    }
+}
+
+int RunStateCacheBenchmark(const BenchmarkOptions& options)
+{
+    std::vector<VertexPosNormal> mesh;
+    if (!LoadObjFile("data/mesh.obj", mesh))
+    {
+        std::cerr << "Could not load data/mesh.obj (run the benchmark from the repository root)\n";
+        return -1;
+    }
+
+    std::printf("state cache: RenderContext calls per frame of BloomRenderer (steady state after %u frames), %ux%u\n", std::max(options.frames, 2u),
+        options.width, options.height);
+
+    RecordingRenderContext::CallCounts counts[2][2];
+    size_t hazards = 0;
+    for (int sparse = 0; sparse < 2; ++sparse)
+    {
+        for (int cached = 0; cached < 2; ++cached)
+        {
+            size_t frameHazards = 0;
+            if (!CountCalls(options, mesh, sparse != 0, cached != 0, counts[sparse][cached], frameHazards))
+            {
+                return 1;
+            }
+            hazards += frameHazards;
+        }
+    }
+
+    std::printf("%-32s %12s %12s %12s %12s\n", "call", "dense", "dense cached", "sparse", "sparse cached");
+    size_t totals[2][2] = { };
+    for (size_t call = 0; call < static_cast<size_t>(RenderCall::Count); ++call)
+    {
+        PrintBenchmarkRow(GetRenderCallName(static_cast<RenderCall>(call)), { static_cast<double>(counts[0][0][call]),
+            static_cast<double>(counts[0][1][call]), static_cast<double>(counts[1][0][call]), static_cast<double>(counts[1][1][call]) });
+        for (int sparse = 0; sparse < 2; ++sparse)
+        {
+            totals[sparse][0] += counts[sparse][0][call];
+            totals[sparse][1] += counts[sparse][1][call];
+        }
+    }
+    PrintBenchmarkRow("total", { static_cast<double>(totals[0][0]), static_cast<double>(totals[0][1]), static_cast<double>(totals[1][0]),
+        static_cast<double>(totals[1][1]) });
+
+    // the cache must not change the image
+    ThreadPool pool(options.threads);
+    ImageRGBA32F reference;
+    ImageRGBA32F cachedImage;
+    if (!RenderImage(options, mesh, false, pool, reference) || !RenderImage(options, mesh, true, pool, cachedImage))
+    {
+        return 1;
+    }
+    const double maxError = ComputeImageError(reference, cachedImage).maxError;
+
+    const bool reduced = totals[0][1] < totals[0][0] && totals[1][1] < totals[1][0];
+    std::printf("\ncalls reaching the context with the cache: %.1f%% (dense), %.1f%% (sparse)\n", 100.0 * totals[0][1] / std::max<size_t>(totals[0][0], 1),
+        100.0 * totals[1][1] / std::max<size_t>(totals[1][0], 1));
+    std::printf("fewer calls: %s, binding hazards: %zu, max. error of the CPU image with the cache: %g\n", reduced ? "yes" : "NO", hazards, maxError);
+    return (reduced && hazards == 0 && maxError == 0.0) ? 0 : 1;
+}
@@ -0,0 +1,141 @@
+#include "benchmark/benchmark.h"
+
+#include "cpu/bloom.h"
+#include "cpu/streamingbloom.h"
+#include "util/threadpool.h"
+#include "util/timer.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <system_error>
+#include <vector>
+
+namespace
+{
+    // rows generated per write of the synthetic input file
+    constexpr uint32_t GENERATE_ROWS = 64;
+
+    // bright discs on a regular grid in front of a dark gradient (RenderSyntheticScene() would need the whole image in memory)
+    void GenerateSyntheticRow(uint32_t width, uint32_t height, uint32_t y, ColorRGBA8* row)
+    {
+        constexpr uint32_t cellSize = 256;
+        constexpr int discRadius = 40;
+
+        const int dy = static_cast<int>(y % cellSize) - static_cast<int>(cellSize / 2);
+        const uint8_t background = static_cast<uint8_t>(64u * y / height);
+        for (uint32_t x = 0; x < width; ++x)
+        {
+            const int dx = static_cast<int>(x % cellSize) - static_cast<int>(cellSize / 2);
+            const bool disc = dx * dx + dy * dy <= discRadius * discRadius;
+            const uint8_t value = disc ? 255 : static_cast<uint8_t>(background + 32u * x / width);
+            row[x] = ColorRGBA8{ value, disc ? static_cast<uint8_t>(128 + (x / cellSize) % 128) : value, value, 255 };
+        }
+    }
+}
+
+int RunStreamingBloomBenchmark(const BenchmarkOptions& options)
+{
+    ThreadPool pool(options.threads);
+    const BloomSettings bloomSettings = CreateDefaultBloomSettings();
+
+    std::printf("streaming bloom: %ux%u in memory, %ux%u from disk, %zu threads\n", options.width, options.height,
+        options.streamSize, options.streamSize, pool.GetThreadCount());
+
+    // 1. the streamed result has to match ApplyBloom() for any band size
+    ImageRGBA32F scene;
+    RenderSyntheticScene(options.width, options.height, 0.f, scene);
+
+    BloomBuffers buffers;
+    ImageRGBA32F reference;
+    ApplyBloom(scene, bloomSettings, buffers, reference, &pool);
+
+    std::printf("%-32s %12s %12s %12s\n", "band rows", "max error", "working MB", "image MB");
+    const uint32_t bandSizes[] = { 1, 4, 16, 64 };
+    double maxError = 0.0;
+    ImageRGBA32F streamed;
+    for (uint32_t bandRows : bandSizes)
+    {
+        StreamingBloom streamingBloom(bandRows);
+        ImageRowReader reader(scene);
+        ImageRowWriter writer(streamed, scene.width, scene.height);
+        if (!streamingBloom.Process(reader, bloomSettings, writer, &pool))
+        {
+            std::printf("streaming bloom failed\n");
+            return 1;
+        }
+
+        const double error = ComputeImageError(reference, streamed).maxError;
+        maxError = std::max(maxError, error);
+        PrintBenchmarkRow(std::to_string(bandRows), { error, streamingBloom.GetLastStats().workingSetBytes / 1048576.0,
+            scene.pixels.size() * sizeof(ColorRGBA32F) / 1048576.0 });
+    }
+
+    // 2. throughput on a synthetic RGBA8 image that does not fit into memory as a float image
+    std::error_code errorCode;
+    const std::filesystem::path directory = std::filesystem::temp_directory_path(errorCode);
+    const std::string inputPath = (directory / "bloom_stream_input.rgba").string();
+    const std::string outputPath = (directory / "bloom_stream_output.rgba").string();
+
+    const uint32_t size = std::max(options.streamSize, 2u);
+    const double pixelCount = static_cast<double>(size) * size;
+    const double fileMegabytes = pixelCount * sizeof(ColorRGBA8) / 1048576.0;
+
+    Timer timer;
+    timer.Start();
+    {
+        RawImageFileWriter writer;
+        bool ok = writer.Open(inputPath, size, size);
+        std::vector<ColorRGBA8> rows(static_cast<size_t>(size) * GENERATE_ROWS);
+        for (uint32_t y = 0; ok && y < size; y += GENERATE_ROWS)
+        {
+            const uint32_t count = std::min(GENERATE_ROWS, size - y);
+            ParallelFor(&pool, 0, count, 1, [&](size_t rowBegin, size_t rowEnd)
+            {
+                for (size_t row = rowBegin; row < rowEnd; ++row)
+                {
+                    GenerateSyntheticRow(size, size, y + static_cast<uint32_t>(row), rows.data() + row * size);
+                }
+            });
+            ok = writer.WriteRows(count, rows.data());
+        }
+
+        if (!writer.Close() || !ok)
+        {
+            std::printf("could not write %s\n", inputPath.c_str());
+            std::filesystem::remove(inputPath, errorCode);
+            return 1;
+        }
+    }
+    timer.Stop();
+    const double generateMilliseconds = timer.GetElapsedTimeMilliseconds();
+
+    StreamingBloom streamingBloom;
+    RawImageFileReader reader;
+    RawImageFileWriter writer;
+    timer.Start();
+    bool ok = reader.Open(inputPath) && writer.Open(outputPath, reader.GetWidth(), reader.GetHeight()) &&
+        streamingBloom.Process(reader, bloomSettings, writer, &pool);
+    ok = writer.Close() && ok;
+    timer.Stop();
+    const double processMilliseconds = timer.GetElapsedTimeMilliseconds();
+
+    std::filesystem::remove(inputPath, errorCode);
+    std::filesystem::remove(outputPath, errorCode);
+    if (!ok)
+    {
+        std::printf("streaming bloom from %s to %s failed\n", inputPath.c_str(), outputPath.c_str());
+        return 1;
+    }
+
+    std::printf("%-32s %12s %12s %12s %12s\n", "stage", "ms", "MPixel/s", "MB/s", "working MB");
+    PrintBenchmarkRow("generate input", { generateMilliseconds, pixelCount / (1000.0 * generateMilliseconds),
+        1000.0 * fileMegabytes / generateMilliseconds, 0.0 });
+    PrintBenchmarkRow("streaming bloom", { processMilliseconds, pixelCount / (1000.0 * processMilliseconds),
+        2000.0 * fileMegabytes / processMilliseconds, streamingBloom.GetLastStats().workingSetBytes / 1048576.0 });
+
+    std::printf("file size %.1f MB (%.1f MB as float image), max. error in memory %g\n", fileMegabytes,
+        pixelCount * sizeof(ColorRGBA32F) / 1048576.0, maxError);
+
+    return maxError == 0.0 ? 0 : 1;
+}
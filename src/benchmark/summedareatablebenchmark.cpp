@@ -0,0 +1,209 @@
+#include "benchmark/benchmark.h"
+
+#include "cpu/bloom.h"
+#include "cpu/summedareatable.h"
+#include "util/threadpool.h"
+#include "util/timer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <random>
+
+namespace
+{
+    struct PrecisionMode
+    {
+        const char* name;
+        SatPrecision precision;
+    };
+
+    const PrecisionMode precisionModes[] = {
+        { "float", SatPrecision::Float },
+        { "compensated", SatPrecision::Compensated },
+        { "double", SatPrecision::Double },
+    };
+
+    // max. error of the 8x8 box averages along the last rows and columns (where the sums in the table are largest)
+    double ComputeMaxBoxError(const SummedAreaTable& table, const ImageRGBA32F& image)
+    {
+        constexpr int BOX_SIZE = 8;
+
+        double maxError = 0.0;
+        auto testBox = [&](int x0, int y0)
+        {
+            double reference = 0.0;
+            for (int y = y0; y < y0 + BOX_SIZE; ++y)
+            {
+                for (int x = x0; x < x0 + BOX_SIZE; ++x)
+                {
+                    reference += image.At(static_cast<uint32_t>(x), static_cast<uint32_t>(y)).r;
+                }
+            }
+            const double sum = table.Sum(x0, y0, x0 + BOX_SIZE, y0 + BOX_SIZE).r;
+            maxError = std::max(maxError, std::fabs(sum - reference) / (BOX_SIZE * BOX_SIZE));
+        };
+
+        const int width = static_cast<int>(image.width);
+        const int height = static_cast<int>(image.height);
+        for (int i = 0; i + BOX_SIZE <= std::min(width, height); i += BOX_SIZE)
+        {
+            testBox(i, height - BOX_SIZE);
+            testBox(width - BOX_SIZE, i);
+        }
+        return maxError;
+    }
+
+    // direct evaluation of VariableBoxBlur() for a single pixel
+    ColorRGBA32F DirectBoxAverage(const ImageRGBA32F& image, int x, int y, float radius)
+    {
+        const int r0 = static_cast<int>(radius);
+        const double t = radius - static_cast<float>(r0);
+
+        double averages[2][3] = { };
+        for (int k = 0; k < 2; ++k)
+        {
+            const int r = r0 + k;
+            for (int j = y - r; j <= y + r; ++j)
+            {
+                for (int i = x - r; i <= x + r; ++i)
+                {
+                    if (i >= 0 && j >= 0 && i < static_cast<int>(image.width) && j < static_cast<int>(image.height))
+                    {
+                        const ColorRGBA32F& value = image.At(static_cast<uint32_t>(i), static_cast<uint32_t>(j));
+                        averages[k][0] += value.r;
+                        averages[k][1] += value.g;
+                        averages[k][2] += value.b;
+                    }
+                }
+            }
+            for (double& average : averages[k])
+            {
+                average /= (2.0 * r + 1.0) * (2.0 * r + 1.0);
+            }
+        }
+
+        return ColorRGBA32F{ static_cast<float>(averages[0][0] + t * (averages[1][0] - averages[0][0])),
+            static_cast<float>(averages[0][1] + t * (averages[1][1] - averages[0][1])),
+            static_cast<float>(averages[0][2] + t * (averages[1][2] - averages[0][2])), 1.f };
+    }
+}
+
+int RunSummedAreaTableBenchmark(const BenchmarkOptions& options)
+{
+    ThreadPool pool(options.threads);
+    const uint32_t runs = std::max(std::min(options.frames, 10u), 1u);
+
+    // 1. build throughput and precision on large images with random values in [0, 1]
+    std::printf("summed-area table build: random images, %zu threads\n", pool.GetThreadCount());
+    std::printf("%-32s %12s %12s %12s\n", "size / precision", "build ms", "MPixel/s", "max error");
+
+    std::mt19937 random(1);
+    std::uniform_real_distribution<float> distribution(0.f, 1.f);
+    const uint32_t sizes[] = { 512, 1024, 2048, 4096 };
+
+    SummedAreaTable table;
+    for (uint32_t size : sizes)
+    {
+        ImageRGBA32F image;
+        image.Resize(size, size);
+        for (ColorRGBA32F& pixel : image.pixels)
+        {
+            pixel = ColorRGBA32F{ distribution(random), distribution(random), distribution(random), 1.f };
+        }
+
+        for (const PrecisionMode& mode : precisionModes)
+        {
+            Timer timer;
+            timer.Start();
+            for (uint32_t run = 0; run < runs; ++run)
+            {
+                table.Build(image, mode.precision, &pool);
+            }
+            timer.Stop();
+            const double milliseconds = timer.GetElapsedTimeMilliseconds() / runs;
+
+            char name[64];
+            std::snprintf(name, sizeof(name), "%ux%u / %s", size, size, mode.name);
+            PrintBenchmarkRow(name, { milliseconds, static_cast<double>(size) * size / (1000.0 * std::max(milliseconds, 1e-6)),
+                ComputeMaxBoxError(table, image) });
+        }
+    }
+
+    // 2. variable radius blur of the thresholded half-res scene, the radius increases from 0 at the top to maxRadius at the bottom
+    const BloomSettings bloomSettings = CreateDefaultBloomSettings();
+    ImageRGBA32F scene;
+    ImageRGBA32F thresholded;
+    RenderSyntheticScene(options.width, options.height, 0.f, scene);
+    ThresholdAndDownsample(scene, bloomSettings.threshold, thresholded, &pool);
+
+    // cost of the fixed-radius separable Gaussian for comparison
+    BloomBuffers buffers;
+    Timer timer;
+    timer.Start();
+    for (uint32_t run = 0; run < runs; ++run)
+    {
+        Blur(thresholded, bloomSettings.blurParams, 0, buffers.temp, &pool);
+        Blur(buffers.temp, bloomSettings.blurParams, 1, buffers.bloom, &pool);
+    }
+    timer.Stop();
+    const double gaussianMilliseconds = timer.GetElapsedTimeMilliseconds() / runs;
+
+    std::printf("\nvariable radius blur: half-res %ux%u, radius 0 (top) to max. radius (bottom), separable Gaussian r%d: %.4f ms\n",
+        thresholded.width, thresholded.height, bloomSettings.blurParams.radius, gaussianMilliseconds);
+    std::printf("%-32s %12s %12s %12s %12s\n", "max. radius / precision", "box ms", "3x box ms", "MPixel/s", "max error");
+
+    const float maxRadii[] = { 4.f, 16.f, 64.f };
+
+    Image<float> radius;
+    radius.Resize(thresholded.width, thresholded.height);
+    ImageRGBA32F boxResult;
+    ImageRGBA32F iteratedResult;
+    for (float maxRadius : maxRadii)
+    {
+        for (uint32_t y = 0; y < radius.height; ++y)
+        {
+            std::fill(radius.Row(y), radius.Row(y) + radius.width, maxRadius * static_cast<float>(y) / static_cast<float>(std::max(radius.height - 1, 1u)));
+        }
+
+        for (const PrecisionMode& mode : precisionModes)
+        {
+            timer.Start();
+            for (uint32_t run = 0; run < runs; ++run)
+            {
+                table.Build(thresholded, mode.precision, &pool);
+                VariableBoxBlur(table, radius, boxResult, &pool);
+            }
+            timer.Stop();
+            const double boxMilliseconds = timer.GetElapsedTimeMilliseconds() / runs;
+
+            timer.Start();
+            for (uint32_t run = 0; run < runs; ++run)
+            {
+                VariableIteratedBoxBlur(thresholded, radius, 3, mode.precision, table, iteratedResult, &pool);
+            }
+            timer.Stop();
+            const double iteratedMilliseconds = timer.GetElapsedTimeMilliseconds() / runs;
+
+            // compare a sparse set of pixels to the direct evaluation
+            double maxError = 0.0;
+            for (uint32_t y = 0; y < boxResult.height; y += 7)
+            {
+                for (uint32_t x = 0; x < boxResult.width; x += 7)
+                {
+                    const ColorRGBA32F direct = DirectBoxAverage(thresholded, static_cast<int>(x), static_cast<int>(y), radius.At(x, y));
+                    const ColorRGBA32F& value = boxResult.At(x, y);
+                    maxError = std::max({ maxError, static_cast<double>(std::fabs(direct.r - value.r)),
+                        static_cast<double>(std::fabs(direct.g - value.g)), static_cast<double>(std::fabs(direct.b - value.b)) });
+                }
+            }
+
+            char name[64];
+            std::snprintf(name, sizeof(name), "%.0f / %s", maxRadius, mode.name);
+            PrintBenchmarkRow(name, { boxMilliseconds, iteratedMilliseconds,
+                static_cast<double>(boxResult.width) * boxResult.height / (1000.0 * std::max(boxMilliseconds, 1e-6)), maxError });
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,127 @@
+#include "benchmark/benchmark.h"
+
+#include "cpu/bloom.h"
+#include "cpu/temporalbloom.h"
+#include "util/threadpool.h"
+#include "util/timer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+namespace
+{
+    // the synthetic scene rotates by 0.1 * 2 * pi per second, we simulate 60 frames per second
+    constexpr float FRAME_TIME = 1.f / 60.f;
+    constexpr float ANGLE_PER_FRAME = 0.1f * 6.2831853f * FRAME_TIME;
+
+    // motion vectors of the synthetic scene in half-res pixels (rotation around the image center)
+    void ComputeRotationMotionVectors(uint32_t width, uint32_t height, ImageRGBA32F& motionVectors)
+    {
+        motionVectors.Resize(width, height);
+
+        const float centerX = 0.5f * static_cast<float>(width);
+        const float centerY = 0.5f * static_cast<float>(height);
+        const float cosAngle = std::cos(ANGLE_PER_FRAME);
+        const float sinAngle = std::sin(ANGLE_PER_FRAME);
+
+        for (uint32_t y = 0; y < height; ++y)
+        {
+            for (uint32_t x = 0; x < width; ++x)
+            {
+                // position in the previous frame: rotate back by one frame
+                float dx = static_cast<float>(x) + 0.5f - centerX;
+                float dy = static_cast<float>(y) + 0.5f - centerY;
+                float prevX = cosAngle * dx + sinAngle * dy;
+                float prevY = -sinAngle * dx + cosAngle * dy;
+
+                motionVectors.At(x, y) = ColorRGBA32F{ dx - prevX, dy - prevY, 0.f, 0.f };
+            }
+        }
+    }
+
+    struct Configuration
+    {
+        const char* name;
+        TemporalBloomSettings settings;
+        bool reproject;
+    };
+}
+
+int RunTemporalBloomBenchmark(const BenchmarkOptions& options)
+{
+    ThreadPool pool(options.threads);
+    const BloomSettings bloomSettings = CreateDefaultBloomSettings();
+
+    ImageRGBA32F motionVectors;
+    ComputeRotationMotionVectors(options.width / 2, options.height / 2, motionVectors);
+
+    const Configuration configurations[] = {
+        { "full (period 1)",             { TemporalPattern::InterleavedRows, 1, 1, 0.f }, false },
+        { "rows, period 2",              { TemporalPattern::InterleavedRows, 2, 1, 0.f }, false },
+        { "rows, period 4",              { TemporalPattern::InterleavedRows, 4, 1, 0.f }, false },
+        { "checkerboard 8x8, period 2",  { TemporalPattern::Checkerboard,    2, 8, 0.f }, false },
+        { "checkerboard 8x8, period 4",  { TemporalPattern::Checkerboard,    4, 8, 0.f }, false },
+        { "rows, period 4, reprojected", { TemporalPattern::InterleavedRows, 4, 1, 0.f }, true },
+        { "rows, period 4, blend 0.5",   { TemporalPattern::InterleavedRows, 4, 1, 0.5f }, true },
+    };
+
+    std::printf("temporal bloom: %ux%u, %u frames, %zu threads\n", options.width, options.height, options.frames, pool.GetThreadCount());
+    std::printf("%-32s %12s %12s %12s %12s %12s\n", "configuration", "ms/frame", "speedup", "updated %", "mean RMSE", "max error");
+
+    ImageRGBA32F scene;
+    BloomBuffers referenceBuffers;
+
+    // time of the full recompute, used as baseline for the speedup
+    double referenceMilliseconds = 0.0;
+    {
+        for (uint32_t frame = 0; frame < options.frames; ++frame)
+        {
+            RenderSyntheticScene(options.width, options.height, frame * FRAME_TIME, scene);
+
+            Timer timer;
+            timer.Start();
+            ComputeBloom(scene, bloomSettings, referenceBuffers, &pool);
+            timer.Stop();
+            referenceMilliseconds += timer.GetElapsedTimeMilliseconds();
+        }
+        referenceMilliseconds /= std::max(options.frames, 1u);
+        PrintBenchmarkRow("reference (ComputeBloom)", { referenceMilliseconds, 1.0, 100.0, 0.0, 0.0 });
+    }
+
+    for (const Configuration& configuration : configurations)
+    {
+        TemporalBloom temporalBloom(configuration.settings);
+
+        double milliseconds = 0.0;
+        double rmseSum = 0.0;
+        double maxError = 0.0;
+        double updatedFraction = 0.0;
+
+        for (uint32_t frame = 0; frame < options.frames; ++frame)
+        {
+            RenderSyntheticScene(options.width, options.height, frame * FRAME_TIME, scene);
+
+            Timer timer;
+            timer.Start();
+            const ImageRGBA32F& bloom = temporalBloom.Process(scene, bloomSettings, configuration.reproject ? &motionVectors : nullptr, &pool);
+            timer.Stop();
+            milliseconds += timer.GetElapsedTimeMilliseconds();
+
+            const TemporalBloom::Stats& stats = temporalBloom.GetLastFrameStats();
+            updatedFraction += static_cast<double>(stats.pixelsUpdated) / static_cast<double>(std::max<uint64_t>(stats.pixelsTotal, 1));
+
+            // error against the full recompute of the same frame
+            ComputeBloom(scene, bloomSettings, referenceBuffers, &pool);
+            ImageError error = ComputeImageError(referenceBuffers.bloom, bloom);
+            rmseSum += error.rmse;
+            maxError = std::max(maxError, error.maxError);
+        }
+
+        const double frames = std::max(options.frames, 1u);
+        milliseconds /= frames;
+        PrintBenchmarkRow(configuration.name, { milliseconds, referenceMilliseconds / milliseconds, 100.0 * updatedFraction / frames, rmseSum / frames, maxError });
+    }
+
+    return 0;
+}
@@ -0,0 +1,122 @@
+#include "benchmark/benchmark.h"
+
+#include "cpu/bloom.h"
+#include "geometry.h"
+#include "render/bloomrenderer.h"
+#include "render/dryrunrenderdevice.h"
+#include "render/texturepool.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace
+{
+    // output resolution (relative to the options) and number of frames of a phase of the benchmark
+    struct Phase
+    {
+        const char* name;
+        float scale;
+        uint32_t frames;
+    };
+
+    double ToMegabytes(uint64_t bytes) noexcept
+    {
+        return static_cast<double>(bytes) / (1024.0 * 1024.0);
+    }
+}
+
+int RunTexturePoolBenchmark(const BenchmarkOptions& options)
+{
+    std::vector<VertexPosNormal> mesh;
+    if (!LoadObjFile("data/mesh.obj", mesh))
+    {
+        std::cerr << "Could not load data/mesh.obj (run the benchmark from the repository root)\n";
+        return -1;
+    }
+
+    // long phases outlast the eviction, the short one is undone before its textures are evicted
+    const uint32_t longPhase = std::max(options.frames, 2 * TexturePool::DEFAULT_MAX_UNUSED_FRAMES);
+    const Phase phases[] = {
+        { "initial size", 1.f, longPhase },
+        { "resized to 3/4", 0.75f, 2 },
+        { "back to the initial size", 1.f, longPhase },
+        { "resized to 1/2", 0.5f, longPhase } };
+
+    std::printf("texture pool: render targets of BloomRenderer on the dry run device, %ux%u, eviction after %u unused frames\n", options.width,
+        options.height, TexturePool::DEFAULT_MAX_UNUSED_FRAMES);
+
+    DryRunRenderDevice device(options.width, options.height);
+    DryRunRenderContext context(device);
+
+    SceneTransforms transforms;
+    SceneLight light;
+    SceneMaterial material;
+    SetUpDefaultScene(options.width, options.height, 0.f, transforms, light, material);
+
+    BloomRenderer renderer;
+    if (!renderer.Initialize(device, { options.width, options.height }, mesh, material))
+    {
+        return 1;
+    }
+    TexturePool& pool = renderer.GetTexturePool();
+
+    const BloomSettings settings = CreateDefaultBloomSettings();
+    BloomFrameInputs inputs;
+    inputs.transforms = transforms;
+    inputs.light = light;
+    inputs.threshold = settings.threshold;
+    inputs.blurParams = settings.blurParams;
+    inputs.compositeCoefficient = settings.compositeCoefficient;
+    inputs.sparseBloom = true;
+
+    std::printf("%-32s %12s %12s %12s %12s %12s %12s\n", "phase", "frames", "hits", "misses", "evictions", "held MB", "in use MB");
+
+    bool passed = true;
+    size_t totalHits = 0;
+    size_t totalMisses = 0;
+    for (const Phase& phase : phases)
+    {
+        const Resolution resolution = { std::max(static_cast<uint32_t>(options.width * phase.scale), 2u),
+            std::max(static_cast<uint32_t>(options.height * phase.scale), 2u) };
+        if (resolution.width != renderer.GetOutputResolution().width || resolution.height != renderer.GetOutputResolution().height)
+        {
+            passed = passed && device.ResizeBackBuffer(resolution.width, resolution.height) && renderer.Resize(resolution);
+        }
+        inputs.renderResolution = resolution;
+
+        pool.ResetStatistics();
+        for (uint32_t frame = 0; frame < phase.frames; ++frame)
+        {
+            renderer.Render(context, inputs);
+            context.Present();
+        }
+
+        const TexturePoolStatistics& statistics = pool.GetStatistics();
+        const uint64_t inUseBytes = renderer.GetFrameGraph().GetStatistics().physicalBytes;
+        PrintBenchmarkRow(phase.name, { static_cast<double>(phase.frames), static_cast<double>(statistics.hits), static_cast<double>(statistics.misses),
+            static_cast<double>(statistics.evictions), ToMegabytes(statistics.bytes), ToMegabytes(inUseBytes) });
+        totalHits += statistics.hits;
+        totalMisses += statistics.misses;
+
+        // each size only creates its textures once, returning to a size that is still pooled creates nothing, and
+        // after a long phase the pool only holds the textures of the current size
+        const size_t textureCount = renderer.GetFrameGraph().GetStatistics().physicalCount;
+        passed = passed && statistics.misses == ((&phase == &phases[2]) ? 0 : textureCount);
+        if (phase.frames >= TexturePool::DEFAULT_MAX_UNUSED_FRAMES)
+        {
+            passed = passed && statistics.bytes == inUseBytes && statistics.textureCount == textureCount;
+        }
+    }
+
+    // only the back buffer and its view are left after releasing the renderer (and its pool)
+    renderer.Release();
+    const bool noLeaks = (device.GetObjectCount() == 2);
+
+    std::printf("\nheld MB: textures of the pool at the end of the phase, in use MB: render targets of the last frame\n");
+    std::printf("hit rate: %.4f, textures created as expected: %s, all objects released: %s\n",
+        static_cast<double>(totalHits) / static_cast<double>(std::max<size_t>(totalHits + totalMisses, 1)), passed ? "yes" : "NO", noLeaks ? "yes" : "NO");
+    return (passed && noLeaks && context.GetHazardCount() == 0) ? 0 : 1;
+}
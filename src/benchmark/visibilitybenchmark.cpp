@@ -0,0 +1,110 @@
+#include "benchmark/benchmark.h"
+
+#include "cpu/rasterizer.h"
+#include "geometry.h"
+#include "util/threadpool.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <vector>
+
+int RunVisibilityBufferBenchmark(const BenchmarkOptions& options)
+{
+    struct Mesh
+    {
+        std::string name;
+        std::vector<VertexPosNormal> vertices;
+    };
+    std::vector<Mesh> meshes(3);
+    meshes[0].name = "data/mesh.obj";
+    if (!LoadObjFile("data/mesh.obj", meshes[0].vertices))
+    {
+        std::cerr << "Could not load data/mesh.obj (run the benchmark from the repository root)\n";
+        return -1;
+    }
+    meshes[1].name = "spheres 6x6x6 front to back";
+    CreateSphereGrid(6, 16, true, meshes[1].vertices);
+    meshes[2].name = "spheres 6x6x6 back to front";
+    CreateSphereGrid(6, 16, false, meshes[2].vertices);
+
+    ThreadPool pool(options.threads);
+    std::printf("visibility buffer: %ux%u, %u frames, %zu threads\n", options.width, options.height, options.frames, pool.GetThreadCount());
+    std::printf("%-32s %12s %12s %12s %12s %12s %12s\n", "mesh", "triangles", "forward ms", "vis. ms", "fwd. sh/px", "vis. sh/px", "max. error");
+
+    RasterizerSettings visibilitySettings;
+    visibilitySettings.visibilityBuffer = true;
+    SoftwareRasterizer forwardRasterizer;
+    SoftwareRasterizer visibilityRasterizer(visibilitySettings);
+    SceneTransforms transforms;
+    SceneLight light;
+    SceneMaterial material;
+    ImageRGBA32F reference;
+    ImageRGBA32F color;
+    bool sameVisibility = true;
+    double maxError = 0.0;
+
+    for (const Mesh& mesh : meshes)
+    {
+        double forwardMilliseconds = 0.0;
+        double visibilityMilliseconds = 0.0;
+        double forwardShaded = 0.0;
+        double visibilityShaded = 0.0;
+        double coveredPixels = 0.0;
+        double meshError = 0.0;
+
+        for (uint32_t i = 0; i < options.frames; ++i)
+        {
+            SetUpDefaultScene(options.width, options.height, i * 1000.f / 60.f, transforms, light, material);
+
+            // the order alternates, so that neither one benefits from the caches warmed up by the other one
+            for (int pass = 0; pass < 2; ++pass)
+            {
+                if ((pass + i) % 2 == 0)
+                {
+                    forwardRasterizer.Render(mesh.vertices, transforms, light, material, options.width, options.height, reference, &pool);
+                }
+                else
+                {
+                    visibilityRasterizer.Render(mesh.vertices, transforms, light, material, options.width, options.height, color, &pool);
+                }
+            }
+
+            const SoftwareRasterizer::Stats& forwardStats = forwardRasterizer.GetLastStats();
+            const SoftwareRasterizer::Stats& visibilityStats = visibilityRasterizer.GetLastStats();
+            forwardMilliseconds += forwardStats.setupMilliseconds + forwardStats.rasterMilliseconds;
+            visibilityMilliseconds += visibilityStats.setupMilliseconds + visibilityStats.rasterMilliseconds;
+            forwardShaded += static_cast<double>(forwardStats.pixelsShaded);
+            visibilityShaded += static_cast<double>(visibilityStats.pixelsShaded);
+
+            // both have to find the same visible surface, and each covered pixel is shaded exactly once
+            const std::vector<uint32_t>& visibility = visibilityRasterizer.GetVisibilityBuffer();
+            const size_t covered = visibility.size() - std::count(visibility.begin(), visibility.end(), SoftwareRasterizer::NO_PRIMITIVE);
+            coveredPixels += static_cast<double>(covered);
+            sameVisibility = sameVisibility && forwardRasterizer.GetDepthBuffer() == visibilityRasterizer.GetDepthBuffer() &&
+                visibilityStats.pixelsShaded == covered;
+
+            for (size_t p = 0; p < color.pixels.size(); ++p)
+            {
+                meshError = std::max({ meshError, static_cast<double>(std::abs(color.pixels[p].r - reference.pixels[p].r)),
+                    static_cast<double>(std::abs(color.pixels[p].g - reference.pixels[p].g)),
+                    static_cast<double>(std::abs(color.pixels[p].b - reference.pixels[p].b)) });
+            }
+        }
+
+        const double frames = std::max(options.frames, 1u);
+        coveredPixels = std::max(coveredPixels, 1.0);
+        PrintBenchmarkRow(mesh.name, { static_cast<double>(mesh.vertices.size() / 3), forwardMilliseconds / frames, visibilityMilliseconds / frames,
+            forwardShaded / coveredPixels, visibilityShaded / coveredPixels, meshError });
+        maxError = std::max(maxError, meshError);
+    }
+
+    // the barycentrics are computed differently (and with the unsnapped positions for clipped triangles)
+    const double tolerance = 1.0 / 255.0;
+    std::printf("\nshading invocations per covered pixel, error of the colors against the forward path (in [0, 1])\n");
+    std::printf("same visibility and one shading invocation per covered pixel: %s\n", sameVisibility ? "yes" : "NO");
+    std::printf("max. error below 1/255: %s\n", maxError <= tolerance ? "yes" : "NO");
+    return (sameVisibility && maxError <= tolerance) ? 0 : 1;
+}
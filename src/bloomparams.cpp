@@ -0,0 +1,30 @@
+#include "bloomparams.h"
+
+#include <algorithm>
+#include <cmath>
+
+void ComputeGaussianBlurParams(float sigma, int radius, BlurParams& params)
+{
+    params.radius = std::clamp(radius, 0, GAUSSIAN_RADIUS);
+
+    // compute Gaussian kernel
+    float twoSigmaSq = 2 * sigma * sigma;
+
+    float sum = 0.f;
+    for (int i = 0; i <= GAUSSIAN_RADIUS; ++i)
+    {
+        // we omit the normalization factor here for the discrete version and normalize using the sum afterwards
+        params.coefficients[i] = (i <= params.radius) ? (1.f / sigma) * std::exp(-static_cast<float>(i * i) / twoSigmaSq) : 0.f;
+        // we use each entry twice since we only compute one half of the curve
+        sum += 2 * params.coefficients[i];
+    }
+    // the center (index 0) has been counted twice, so we subtract it once
+    sum -= params.coefficients[0];
+
+    // we normalize all entries using the sum so that the entire kernel gives us a sum of coefficients = 1
+    float normalizationFactor = 1.f / sum;
+    for (int i = 0; i <= GAUSSIAN_RADIUS; ++i)
+    {
+        params.coefficients[i] *= normalizationFactor;
+    }
+}
@@ -0,0 +1,82 @@
+#include "capture/d3d11readbackring.h"
+
+#include <d3d10.h>
+
+#include <algorithm>
+#include <iostream>
+
+D3D11ReadbackRing::D3D11ReadbackRing(ID3D11Device* device, ID3D11DeviceContext* deviceContext, DXGI_FORMAT format, uint32_t width, uint32_t height, uint32_t slotCount)
+    : m_deviceContext(deviceContext)
+    , m_source(nullptr)
+    , m_width(width)
+    , m_height(height)
+{
+    // Map() and Unmap() are called from another thread than the rendering
+    ID3D10Multithread* multithread = nullptr;
+    if (SUCCEEDED(m_deviceContext->QueryInterface(__uuidof(ID3D10Multithread), reinterpret_cast<void**>(&multithread))))
+    {
+        multithread->SetMultithreadProtected(TRUE);
+        multithread->Release();
+    }
+
+    D3D11_TEXTURE2D_DESC textureDesc;
+    ZeroMemory(&textureDesc, sizeof(D3D11_TEXTURE2D_DESC));
+    textureDesc.Width = width;
+    textureDesc.Height = height;
+    textureDesc.MipLevels = 1;
+    textureDesc.ArraySize = 1;
+    textureDesc.Format = format;
+    textureDesc.SampleDesc.Count = 1;
+    textureDesc.Usage = D3D11_USAGE_STAGING;
+    textureDesc.BindFlags = 0;
+    textureDesc.CPUAccessFlags = D3D11_CPU_ACCESS_READ;
+    textureDesc.MiscFlags = 0;
+
+    m_stagingTextures.resize(std::max(slotCount, 1u), nullptr);
+    for (ID3D11Texture2D*& texture : m_stagingTextures)
+    {
+        HRESULT result = device->CreateTexture2D(&textureDesc, NULL, &texture);
+        if (FAILED(result))
+        {
+            std::cerr << "Failed to create staging texture\n";
+            exit(-1);
+        }
+    }
+}
+
+D3D11ReadbackRing::~D3D11ReadbackRing()
+{
+    for (ID3D11Texture2D* texture : m_stagingTextures)
+    {
+        texture->Release();
+    }
+}
+
+void D3D11ReadbackRing::Copy(uint32_t slot)
+{
+    if (m_source == nullptr)
+    {
+        return;
+    }
+
+    D3D11_BOX region = { 0, 0, 0, m_width, m_height, 1 };
+    m_deviceContext->CopySubresourceRegion(m_stagingTextures[slot], 0, 0, 0, 0, m_source, 0, &region);
+}
+
+const uint8_t* D3D11ReadbackRing::Map(uint32_t slot, size_t& rowPitch)
+{
+    // waits for the copy if it is not done yet (which should not happen with enough slots)
+    D3D11_MAPPED_SUBRESOURCE ms;
+    if (FAILED(m_deviceContext->Map(m_stagingTextures[slot], 0, D3D11_MAP_READ, 0, &ms)))
+    {
+        return nullptr;
+    }
+
+    rowPitch = ms.RowPitch;
+    return static_cast<const uint8_t*>(ms.pData);
+}
+
+void D3D11ReadbackRing::Unmap(uint32_t slot)
+{
+    m_deviceContext->Unmap(m_stagingTextures[slot], 0);
+}
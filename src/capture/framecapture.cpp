@@ -0,0 +1,226 @@
+#include "capture/framecapture.h"
+
+#include "util/timer.h"
+
+#include <algorithm>
+#include <cstring>
+
+CpuReadbackRing::CpuReadbackRing(const ImageRGBA8& source, uint32_t slotCount, float copyLatencyMilliseconds)
+    : m_source(source)
+    , m_slots(std::max(slotCount, 1u))
+    , m_copyLatency(copyLatencyMilliseconds)
+{
+}
+
+void CpuReadbackRing::Copy(uint32_t slot)
+{
+    Slot& target = m_slots[slot];
+    target.image = m_source;
+    target.readyTime = std::chrono::steady_clock::now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(m_copyLatency);
+}
+
+const uint8_t* CpuReadbackRing::Map(uint32_t slot, size_t& rowPitch)
+{
+    const Slot& target = m_slots[slot];
+    std::this_thread::sleep_until(target.readyTime);
+
+    rowPitch = static_cast<size_t>(target.image.width) * sizeof(ColorRGBA8);
+    return reinterpret_cast<const uint8_t*>(target.image.pixels.data());
+}
+
+void CpuReadbackRing::Unmap(uint32_t)
+{
+}
+
+FrameCapture::FrameCapture(ReadbackRing& ring, FrameHandler handler)
+    : FrameCapture(ring, std::move(handler), Settings())
+{
+}
+
+FrameCapture::FrameCapture(ReadbackRing& ring, FrameHandler handler, const Settings& settings)
+    : m_ring(ring)
+    , m_handler(std::move(handler))
+    , m_slots(ring.GetSlotCount())
+    , m_nextFrameIndex(0)
+    , m_framesInFlight(0)
+    , m_stats{ }
+    , m_readbackSlots(ring.GetSlotCount())
+    , m_encodeJobs(std::max(settings.maxQueuedImages, 1u))
+    , m_freeImages(std::max(settings.maxQueuedImages, 1u) + std::max(settings.encoderThreads, 1u) + 1)
+{
+    // one image for each job that can be queued or processed at the same time, plus the one of the readback thread
+    const uint32_t encoderThreads = std::max(settings.encoderThreads, 1u);
+    const uint32_t imageCount = std::max(settings.maxQueuedImages, 1u) + encoderThreads + 1;
+    for (uint32_t i = 0; i < imageCount; ++i)
+    {
+        m_freeImages.Push(ImageRGBA8());
+    }
+
+    m_readbackThread = std::thread(&FrameCapture::ReadbackLoop, this);
+    for (uint32_t i = 0; i < encoderThreads; ++i)
+    {
+        m_encoderThreads.emplace_back(&FrameCapture::EncodeLoop, this);
+    }
+}
+
+FrameCapture::~FrameCapture()
+{
+    Flush();
+
+    m_readbackSlots.Close();
+    m_readbackThread.join();
+    m_encodeJobs.Close();
+    for (std::thread& thread : m_encoderThreads)
+    {
+        thread.join();
+    }
+}
+
+bool FrameCapture::Capture()
+{
+    Timer timer;
+    timer.Start();
+
+    const uint32_t slotCount = static_cast<uint32_t>(m_slots.size());
+    const uint64_t frameIndex = m_nextFrameIndex++;
+    const uint32_t slot = static_cast<uint32_t>(frameIndex % slotCount);
+
+    bool captured = false;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_slots[slot].state == SlotState::Free)
+    {
+        // the copy is only issued here, the slot is read back (slotCount - 1) frames later
+        m_ring.Copy(slot);
+        m_slots[slot].state = SlotState::Copied;
+        m_slots[slot].frameIndex = frameIndex;
+        ++m_framesInFlight;
+        ++m_stats.framesCaptured;
+        captured = true;
+    }
+    else
+    {
+        ++m_stats.framesDropped;
+    }
+
+    if (frameIndex + 1 >= slotCount)
+    {
+        SubmitCopiedSlots(frameIndex + 1 - slotCount);
+    }
+
+    timer.Stop();
+    m_stats.captureMilliseconds += timer.GetElapsedTimeMilliseconds();
+    return captured;
+}
+
+void FrameCapture::Flush()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    SubmitCopiedSlots(m_nextFrameIndex);
+    m_allEncoded.wait(lock, [this] { return m_framesInFlight == 0; });
+}
+
+FrameCapture::Stats FrameCapture::GetStats() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_stats;
+}
+
+void FrameCapture::SubmitCopiedSlots(uint64_t maxFrameIndex)
+{
+    // oldest frames first, so that the frames reach the encoders in order
+    while (true)
+    {
+        uint32_t oldestSlot = static_cast<uint32_t>(m_slots.size());
+        for (uint32_t slot = 0; slot < m_slots.size(); ++slot)
+        {
+            const Slot& candidate = m_slots[slot];
+            if (candidate.state == SlotState::Copied && candidate.frameIndex <= maxFrameIndex &&
+                (oldestSlot == m_slots.size() || candidate.frameIndex < m_slots[oldestSlot].frameIndex))
+            {
+                oldestSlot = slot;
+            }
+        }
+
+        if (oldestSlot == m_slots.size())
+        {
+            break;
+        }
+
+        m_slots[oldestSlot].state = SlotState::Reading;
+        // never blocks: the queue has room for all slots
+        m_readbackSlots.Push(oldestSlot);
+    }
+}
+
+void FrameCapture::ReadbackLoop()
+{
+    uint32_t slot;
+    while (m_readbackSlots.Pop(slot))
+    {
+        EncodeJob job;
+        // waits if all images are queued for the encoders, the render thread drops frames in the meantime
+        m_freeImages.Pop(job.image);
+
+        Timer timer;
+        timer.Start();
+
+        const uint32_t width = m_ring.GetWidth();
+        const uint32_t height = m_ring.GetHeight();
+        size_t rowPitch = 0;
+        const uint8_t* pixels = m_ring.Map(slot, rowPitch);
+        if (pixels != nullptr)
+        {
+            job.image.Resize(width, height);
+            for (uint32_t y = 0; y < height; ++y)
+            {
+                std::memcpy(job.image.Row(y), pixels + y * rowPitch, width * sizeof(ColorRGBA8));
+            }
+            m_ring.Unmap(slot);
+        }
+
+        timer.Stop();
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stats.readbackMilliseconds += timer.GetElapsedTimeMilliseconds();
+            job.frameIndex = m_slots[slot].frameIndex;
+            m_slots[slot].state = SlotState::Free;
+
+            if (pixels == nullptr)
+            {
+                ++m_stats.framesDropped;
+                --m_framesInFlight;
+                m_allEncoded.notify_all();
+            }
+        }
+
+        if (pixels != nullptr)
+        {
+            m_encodeJobs.Push(std::move(job));
+        }
+        else
+        {
+            m_freeImages.Push(std::move(job.image));
+        }
+    }
+}
+
+void FrameCapture::EncodeLoop()
+{
+    EncodeJob job;
+    while (m_encodeJobs.Pop(job))
+    {
+        Timer timer;
+        timer.Start();
+        m_handler(job.frameIndex, job.image);
+        timer.Stop();
+
+        m_freeImages.Push(std::move(job.image));
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stats.encodeMilliseconds += timer.GetElapsedTimeMilliseconds();
+        ++m_stats.framesEncoded;
+        --m_framesInFlight;
+        m_allEncoded.notify_all();
+    }
+}
@@ -0,0 +1,274 @@
+#include "capture/sharedframering.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <new>
+#include <thread>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+    constexpr size_t PAGE_SIZE = 4096;
+
+    // polling of WaitForFrame()
+    constexpr auto SPIN_DURATION = std::chrono::milliseconds(1);
+    constexpr auto SLEEP_DURATION = std::chrono::microseconds(100);
+
+    uint64_t GetReadyState(uint64_t frame) noexcept
+    {
+        return (frame << 1) | 1;
+    }
+}
+
+uint64_t GetSharedFrameTimestamp() noexcept
+{
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+SharedFrameRingWriter::~SharedFrameRingWriter()
+{
+    Close();
+}
+
+bool SharedFrameRingWriter::Create(const std::string& name, uint32_t width, uint32_t height, uint32_t slotCount)
+{
+    Close();
+    if (width == 0 || height == 0 || slotCount == 0)
+    {
+        return false;
+    }
+
+#ifdef _WIN32
+    (void)name;
+    return false;
+#else
+    const size_t rowPitch = static_cast<size_t>(width) * 4;
+    const size_t slotStride = (SHARED_FRAME_SLOT_HEADER_SIZE + rowPitch * height + PAGE_SIZE - 1) / PAGE_SIZE * PAGE_SIZE;
+    const size_t size = SHARED_FRAME_RING_HEADER_SIZE + slotStride * slotCount;
+
+    // a new object instead of resizing the old one, which would invalidate the mappings of its readers
+    shm_unlink(name.c_str());
+    const int file = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (file < 0)
+    {
+        return false;
+    }
+    if (ftruncate(file, static_cast<off_t>(size)) != 0)
+    {
+        close(file);
+        shm_unlink(name.c_str());
+        return false;
+    }
+    void* memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, file, 0);
+    close(file);
+    if (memory == MAP_FAILED)
+    {
+        shm_unlink(name.c_str());
+        return false;
+    }
+
+    // the object is zero-initialized, i.e., no slot is ready
+    m_header = new (memory) SharedFrameRingHeader{ SHARED_FRAME_RING_MAGIC, SHARED_FRAME_RING_VERSION, width, height, slotCount,
+        static_cast<uint32_t>(rowPitch), slotStride, { 0 }, { 0 } };
+    for (uint32_t slot = 0; slot < slotCount; ++slot)
+    {
+        new (GetSlot(slot)) SharedFrameSlotHeader{ { 0 }, 0 };
+    }
+
+    m_name = name;
+    m_size = size;
+    m_nextFrame = 0;
+    return true;
+#endif
+}
+
+uint8_t* SharedFrameRingWriter::BeginFrame() noexcept
+{
+    // readers that see this state (or a later one) after reading the pixels discard the frame
+    SharedFrameSlotHeader* slot = GetSlot(m_nextFrame);
+    slot->state.store(m_nextFrame << 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    return reinterpret_cast<uint8_t*>(slot) + SHARED_FRAME_SLOT_HEADER_SIZE;
+}
+
+void SharedFrameRingWriter::Publish() noexcept
+{
+    SharedFrameSlotHeader* slot = GetSlot(m_nextFrame);
+    slot->timestampNanoseconds = GetSharedFrameTimestamp();
+    slot->state.store(GetReadyState(m_nextFrame), std::memory_order_release);
+
+    ++m_nextFrame;
+    m_header->publishedFrames.store(m_nextFrame, std::memory_order_release);
+}
+
+void SharedFrameRingWriter::Publish(const uint8_t* pixels) noexcept
+{
+    std::memcpy(BeginFrame(), pixels, static_cast<size_t>(m_header->rowPitch) * m_header->height);
+    Publish();
+}
+
+void SharedFrameRingWriter::Close() noexcept
+{
+    if (m_header == nullptr)
+    {
+        return;
+    }
+
+    m_header->closed.store(1, std::memory_order_release);
+#ifndef _WIN32
+    munmap(m_header, m_size);
+    shm_unlink(m_name.c_str());
+#endif
+    m_header = nullptr;
+}
+
+SharedFrameSlotHeader* SharedFrameRingWriter::GetSlot(uint64_t frame) const noexcept
+{
+    uint8_t* slots = reinterpret_cast<uint8_t*>(m_header) + SHARED_FRAME_RING_HEADER_SIZE;
+    return reinterpret_cast<SharedFrameSlotHeader*>(slots + (frame % m_header->slotCount) * m_header->slotStride);
+}
+
+SharedFrameRingReader::~SharedFrameRingReader()
+{
+    Unmap();
+}
+
+bool SharedFrameRingReader::Open(const std::string& name)
+{
+    Unmap();
+    m_stats = Stats{ };
+
+#ifdef _WIN32
+    (void)name;
+    return false;
+#else
+    const int file = shm_open(name.c_str(), O_RDONLY, 0);
+    if (file < 0)
+    {
+        return false;
+    }
+    struct stat status;
+    if (fstat(file, &status) != 0 || static_cast<size_t>(status.st_size) < SHARED_FRAME_RING_HEADER_SIZE)
+    {
+        close(file);
+        return false;
+    }
+
+    const size_t size = static_cast<size_t>(status.st_size);
+    void* memory = mmap(nullptr, size, PROT_READ, MAP_SHARED, file, 0);
+    close(file);
+    if (memory == MAP_FAILED)
+    {
+        return false;
+    }
+
+    m_header = static_cast<const SharedFrameRingHeader*>(memory);
+    m_size = size;
+    if (m_header->magic != SHARED_FRAME_RING_MAGIC || m_header->version != SHARED_FRAME_RING_VERSION || m_header->slotCount == 0 ||
+        m_header->rowPitch != m_header->width * 4 || SHARED_FRAME_RING_HEADER_SIZE + m_header->slotStride * m_header->slotCount > size ||
+        m_header->slotStride < SHARED_FRAME_SLOT_HEADER_SIZE + static_cast<uint64_t>(m_header->rowPitch) * m_header->height)
+    {
+        Unmap();
+        return false;
+    }
+
+    const uint64_t published = m_header->publishedFrames.load(std::memory_order_acquire);
+    m_nextFrame = (published > 0) ? published - 1 : 0;
+    return true;
+#endif
+}
+
+SharedFrameRingReader::Status SharedFrameRingReader::WaitForFrame(Frame& frame, float timeoutMilliseconds)
+{
+    if (m_header == nullptr)
+    {
+        return Status::Closed;
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    const auto deadline = start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<float, std::milli>(timeoutMilliseconds));
+    while (true)
+    {
+        // read the closed flag first, so that frames published right before closing are not missed
+        const bool closed = m_header->closed.load(std::memory_order_acquire) != 0;
+        const uint64_t published = m_header->publishedFrames.load(std::memory_order_acquire);
+        if (published > m_nextFrame)
+        {
+            // older frames have been overwritten, the oldest one in the ring may be overwritten right now (see below)
+            const uint64_t oldest = (published > m_header->slotCount) ? published - m_header->slotCount : 0;
+            const uint64_t frameNumber = std::max(m_nextFrame, oldest);
+            m_stats.framesSkipped += frameNumber - m_nextFrame;
+            m_nextFrame = frameNumber + 1;
+
+            const SharedFrameSlotHeader* slot = GetSlot(frameNumber);
+            if (slot->state.load(std::memory_order_acquire) == GetReadyState(frameNumber))
+            {
+                frame.pixels = reinterpret_cast<const uint8_t*>(slot) + SHARED_FRAME_SLOT_HEADER_SIZE;
+                frame.frameNumber = frameNumber;
+                frame.timestampNanoseconds = slot->timestampNanoseconds;
+                return Status::Frame;
+            }
+
+            // overwritten in the meantime, try the next one
+            ++m_stats.framesSkipped;
+            continue;
+        }
+
+        if (closed)
+        {
+            return Status::Closed;
+        }
+
+        const auto now = std::chrono::steady_clock::now();
+        if (now >= deadline)
+        {
+            return Status::Timeout;
+        }
+        if (now - start < SPIN_DURATION)
+        {
+            std::this_thread::yield();
+        }
+        else
+        {
+            std::this_thread::sleep_for(SLEEP_DURATION);
+        }
+    }
+}
+
+bool SharedFrameRingReader::Release(const Frame& frame)
+{
+    // the pixel reads must not move past the check of the state
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (GetSlot(frame.frameNumber)->state.load(std::memory_order_relaxed) != GetReadyState(frame.frameNumber))
+    {
+        ++m_stats.framesTorn;
+        return false;
+    }
+
+    ++m_stats.framesRead;
+    return true;
+}
+
+void SharedFrameRingReader::Unmap() noexcept
+{
+#ifndef _WIN32
+    if (m_header != nullptr)
+    {
+        munmap(const_cast<SharedFrameRingHeader*>(m_header), m_size);
+    }
+#endif
+    m_header = nullptr;
+}
+
+const SharedFrameSlotHeader* SharedFrameRingReader::GetSlot(uint64_t frame) const noexcept
+{
+    const uint8_t* slots = reinterpret_cast<const uint8_t*>(m_header) + SHARED_FRAME_RING_HEADER_SIZE;
+    return reinterpret_cast<const SharedFrameSlotHeader*>(slots + (frame % m_header->slotCount) * m_header->slotStride);
+}
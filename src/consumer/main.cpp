@@ -0,0 +1,186 @@
+#include "capture/sharedframering.h"
+#include "cpu/imagefile.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <system_error>
+#include <thread>
+
+namespace
+{
+    struct ConsumerOptions
+    {
+        std::string name;
+        // 0 = until the writer closes the ring
+        uint64_t frames = 0;
+        // frames are written to this directory as .qoi if it is not empty
+        std::string outputDirectory;
+        uint32_t writeInterval = 1;
+        float timeoutMilliseconds = 5000.f;
+    };
+
+    void PrintUsage()
+    {
+        std::cerr << "usage: bloom_shm_consumer /<name> [options]\n\n"
+            "reference consumer of the shared memory ring written by bloom_batch - shm:/<name>: reads the frames in place and\n"
+            "prints the frames per second and the latency between publishing and reading once per second\n\n"
+            "options:\n"
+            "  --frames N           stop after N frames (default: until the writer closes the ring)\n"
+            "  --output D           write the frames as .qoi to directory D\n"
+            "  --every N            only write every N-th frame (default 1)\n"
+            "  --timeout MS         max. time to wait for the ring and for each frame (default 5000)\n";
+    }
+
+    bool ParseOptions(int argc, char* argv[], ConsumerOptions& options)
+    {
+        if (argc < 2)
+        {
+            return false;
+        }
+
+        options.name = argv[1];
+        for (int i = 2; i + 1 < argc; i += 2)
+        {
+            const char* value = argv[i + 1];
+            if (std::strcmp(argv[i], "--frames") == 0)
+            {
+                options.frames = std::strtoull(value, nullptr, 10);
+            }
+            else if (std::strcmp(argv[i], "--output") == 0)
+            {
+                options.outputDirectory = value;
+            }
+            else if (std::strcmp(argv[i], "--every") == 0)
+            {
+                options.writeInterval = std::max(static_cast<uint32_t>(std::strtoul(value, nullptr, 10)), 1u);
+            }
+            else if (std::strcmp(argv[i], "--timeout") == 0)
+            {
+                options.timeoutMilliseconds = static_cast<float>(std::atof(value));
+            }
+            else
+            {
+                std::cerr << "Unknown option " << argv[i] << "\n";
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // latency statistics of the frames read since the last report
+    struct LatencyStats
+    {
+        uint64_t frames = 0;
+        double sumMicroseconds = 0.0;
+        double maxMicroseconds = 0.0;
+
+        void Add(double microseconds)
+        {
+            ++frames;
+            sumMicroseconds += microseconds;
+            maxMicroseconds = std::max(maxMicroseconds, microseconds);
+        }
+    };
+}
+
+int main(int argc, char* argv[])
+{
+    ConsumerOptions options;
+    if (!ParseOptions(argc, argv, options))
+    {
+        PrintUsage();
+        return -1;
+    }
+
+    // the writer may not have created the ring yet
+    SharedFrameRingReader reader;
+    const auto openDeadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(static_cast<int>(options.timeoutMilliseconds));
+    while (!reader.Open(options.name))
+    {
+        if (std::chrono::steady_clock::now() >= openDeadline)
+        {
+            std::cerr << "Could not open the shared memory ring " << options.name << "\n";
+            return -1;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    std::error_code errorCode;
+    if (!options.outputDirectory.empty())
+    {
+        std::filesystem::create_directories(options.outputDirectory, errorCode);
+    }
+
+    std::printf("%s: %ux%u, %u slots\n", options.name.c_str(), reader.GetWidth(), reader.GetHeight(), reader.GetSlotCount());
+
+    ImageRGBA8 image;
+    LatencyStats interval;
+    LatencyStats total;
+    auto reportTime = std::chrono::steady_clock::now();
+    uint64_t luminanceChecksum = 0;
+
+    SharedFrameRingReader::Frame frame;
+    while ((options.frames == 0 || total.frames < options.frames) &&
+        reader.WaitForFrame(frame, options.timeoutMilliseconds) == SharedFrameRingReader::Status::Frame)
+    {
+        const double latency = (GetSharedFrameTimestamp() - frame.timestampNanoseconds) / 1000.0;
+
+        // stand-in for the work of a real consumer: the pixels are used in place, without a copy
+        const size_t pixelCount = static_cast<size_t>(reader.GetWidth()) * reader.GetHeight();
+        uint64_t luminance = 0;
+        for (size_t i = 0; i < pixelCount; ++i)
+        {
+            luminance += frame.pixels[4 * i + 1];
+        }
+
+        const bool writeFrame = !options.outputDirectory.empty() && frame.frameNumber % options.writeInterval == 0;
+        if (writeFrame)
+        {
+            image.Resize(reader.GetWidth(), reader.GetHeight());
+            std::memcpy(image.pixels.data(), frame.pixels, pixelCount * sizeof(ColorRGBA8));
+        }
+
+        if (!reader.Release(frame))
+        {
+            // overwritten by the writer while we were reading
+            continue;
+        }
+
+        luminanceChecksum += luminance;
+        interval.Add(latency);
+        total.Add(latency);
+        if (writeFrame)
+        {
+            char fileName[32];
+            std::snprintf(fileName, sizeof(fileName), "frame_%06llu.qoi", static_cast<unsigned long long>(frame.frameNumber));
+            if (!WriteImageFile((std::filesystem::path(options.outputDirectory) / fileName).string(), image))
+            {
+                std::cerr << "Could not write " << fileName << "\n";
+            }
+        }
+
+        const auto now = std::chrono::steady_clock::now();
+        const double seconds = std::chrono::duration<double>(now - reportTime).count();
+        if (seconds >= 1.0)
+        {
+            std::printf("%.1f frames/s, latency: mean %.1f us, max %.1f us\n", interval.frames / seconds,
+                interval.sumMicroseconds / std::max<uint64_t>(interval.frames, 1), interval.maxMicroseconds);
+            interval = LatencyStats();
+            reportTime = now;
+        }
+    }
+
+    const SharedFrameRingReader::Stats& stats = reader.GetStats();
+    std::printf("%llu frames read, %llu skipped, %llu torn, latency: mean %.1f us, max %.1f us (checksum %llu)\n",
+        static_cast<unsigned long long>(stats.framesRead), static_cast<unsigned long long>(stats.framesSkipped),
+        static_cast<unsigned long long>(stats.framesTorn), total.sumMicroseconds / std::max<uint64_t>(total.frames, 1),
+        total.maxMicroseconds, static_cast<unsigned long long>(luminanceChecksum));
+
+    return (options.frames == 0 || total.frames >= options.frames) ? 0 : 1;
+}
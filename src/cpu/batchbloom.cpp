@@ -0,0 +1,209 @@
+#include "cpu/batchbloom.h"
+
+#include "util/boundedqueue.h"
+#include "util/timer.h"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    struct BatchFrame
+    {
+        size_t index = 0;
+        ImageRGBA8 image;
+    };
+
+    uint32_t ResolveThreadCount(uint32_t threadCount)
+    {
+        return threadCount > 0 ? threadCount : std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    BatchBloomPipeline::StageStats CreateStageStats(const std::vector<double>& busyMilliseconds, double totalMilliseconds)
+    {
+        BatchBloomPipeline::StageStats stats = { };
+        stats.threads = static_cast<uint32_t>(busyMilliseconds.size());
+        for (double busy : busyMilliseconds)
+        {
+            stats.busyMilliseconds += busy;
+        }
+        stats.utilization = (totalMilliseconds > 0.0) ? stats.busyMilliseconds / (stats.threads * totalMilliseconds) : 0.0;
+        return stats;
+    }
+}
+
+BatchBloomPipeline::BatchBloomPipeline() noexcept
+    : BatchBloomPipeline(Settings())
+{
+}
+
+BatchBloomPipeline::BatchBloomPipeline(const Settings& settings) noexcept
+    : m_settings(settings)
+    , m_stats{ }
+{
+    m_settings.decodeThreads = ResolveThreadCount(m_settings.decodeThreads);
+    m_settings.bloomThreads = ResolveThreadCount(m_settings.bloomThreads);
+    m_settings.encodeThreads = ResolveThreadCount(m_settings.encodeThreads);
+    m_settings.queueCapacity = std::max(m_settings.queueCapacity, 1u);
+}
+
+bool BatchBloomPipeline::Run(size_t frameCount, const BloomSettings& bloomSettings, const DecodeFunction& decode, const EncodeFunction& encode)
+{
+    BoundedQueue<BatchFrame> decodedFrames(m_settings.queueCapacity);
+    BoundedQueue<BatchFrame> bloomedFrames(m_settings.queueCapacity);
+
+    std::atomic<size_t> nextFrame(0);
+    std::atomic<size_t> framesProcessed(0);
+    std::atomic<size_t> framesFailed(0);
+
+    std::vector<double> decodeBusy(m_settings.decodeThreads, 0.0);
+    std::vector<double> bloomBusy(m_settings.bloomThreads, 0.0);
+    std::vector<double> encodeBusy(m_settings.encodeThreads, 0.0);
+
+    auto decodeWorker = [&](size_t worker)
+    {
+        for (size_t index = nextFrame++; index < frameCount; index = nextFrame++)
+        {
+            BatchFrame frame;
+            frame.index = index;
+
+            Timer timer;
+            timer.Start();
+            bool decoded = false;
+            try
+            {
+                decoded = decode(index, frame.image);
+            }
+            catch (const std::exception& exception)
+            {
+                std::cerr << "Failed to decode frame " << index << ": " << exception.what() << "\n";
+            }
+            timer.Stop();
+            decodeBusy[worker] += timer.GetElapsedTimeMilliseconds();
+
+            if (!decoded || frame.image.width < 2 || frame.image.height < 2)
+            {
+                ++framesFailed;
+                continue;
+            }
+            decodedFrames.Push(std::move(frame));
+        }
+    };
+
+    auto bloomWorker = [&](size_t worker)
+    {
+        // per-thread buffers, reused for all frames of the same size
+        ImageRGBA32F scene;
+        ImageRGBA32F output;
+        BloomBuffers buffers;
+
+        BatchFrame frame;
+        while (decodedFrames.Pop(frame))
+        {
+            Timer timer;
+            timer.Start();
+            bool bloomed = false;
+            try
+            {
+                ConvertImage(frame.image, scene);
+                ApplyBloom(scene, bloomSettings, buffers, output);
+                ConvertImage(output, frame.image);
+                bloomed = true;
+            }
+            catch (const std::exception& exception)
+            {
+                std::cerr << "Failed to apply the bloom to frame " << frame.index << ": " << exception.what() << "\n";
+            }
+            timer.Stop();
+            bloomBusy[worker] += timer.GetElapsedTimeMilliseconds();
+
+            if (!bloomed)
+            {
+                ++framesFailed;
+                continue;
+            }
+            bloomedFrames.Push(std::move(frame));
+        }
+    };
+
+    auto encodeWorker = [&](size_t worker)
+    {
+        BatchFrame frame;
+        while (bloomedFrames.Pop(frame))
+        {
+            Timer timer;
+            timer.Start();
+            bool encoded = false;
+            try
+            {
+                encoded = encode(frame.index, frame.image);
+            }
+            catch (const std::exception& exception)
+            {
+                std::cerr << "Failed to encode frame " << frame.index << ": " << exception.what() << "\n";
+            }
+            timer.Stop();
+            encodeBusy[worker] += timer.GetElapsedTimeMilliseconds();
+
+            if (encoded)
+            {
+                ++framesProcessed;
+            }
+            else
+            {
+                ++framesFailed;
+            }
+        }
+    };
+
+    Timer timer;
+    timer.Start();
+
+    std::vector<std::thread> decodeThreads;
+    std::vector<std::thread> bloomThreads;
+    std::vector<std::thread> encodeThreads;
+    for (size_t i = 0; i < m_settings.decodeThreads; ++i)
+    {
+        decodeThreads.emplace_back(decodeWorker, i);
+    }
+    for (size_t i = 0; i < m_settings.bloomThreads; ++i)
+    {
+        bloomThreads.emplace_back(bloomWorker, i);
+    }
+    for (size_t i = 0; i < m_settings.encodeThreads; ++i)
+    {
+        encodeThreads.emplace_back(encodeWorker, i);
+    }
+
+    // each queue is closed once all threads feeding it are done, which lets the next stage finish
+    for (std::thread& thread : decodeThreads)
+    {
+        thread.join();
+    }
+    decodedFrames.Close();
+    for (std::thread& thread : bloomThreads)
+    {
+        thread.join();
+    }
+    bloomedFrames.Close();
+    for (std::thread& thread : encodeThreads)
+    {
+        thread.join();
+    }
+
+    timer.Stop();
+
+    m_stats.framesProcessed = framesProcessed;
+    m_stats.framesFailed = framesFailed;
+    m_stats.milliseconds = timer.GetElapsedTimeMilliseconds();
+    m_stats.framesPerSecond = (m_stats.milliseconds > 0.0) ? 1000.0 * m_stats.framesProcessed / m_stats.milliseconds : 0.0;
+    m_stats.decode = CreateStageStats(decodeBusy, m_stats.milliseconds);
+    m_stats.bloom = CreateStageStats(bloomBusy, m_stats.milliseconds);
+    m_stats.encode = CreateStageStats(encodeBusy, m_stats.milliseconds);
+
+    return m_stats.framesFailed == 0;
+}
@@ -0,0 +1,175 @@
+#include "cpu/bloom.h"
+
+#include "util/threadpool.h"
+
+#include <algorithm>
+
+namespace
+{
+    // number of rows processed per task
+    constexpr size_t ROWS_PER_TASK = 16;
+}
+
+ColorRGBA32F SampleBilinearClamp(const ImageRGBA32F& image, float u, float v) noexcept
+{
+    const float maxX = static_cast<float>(image.width - 1);
+    const float maxY = static_cast<float>(image.height - 1);
+    const float x = std::clamp(u - 0.5f, 0.f, maxX);
+    const float y = std::clamp(v - 0.5f, 0.f, maxY);
+
+    const uint32_t x0 = static_cast<uint32_t>(x);
+    const uint32_t y0 = static_cast<uint32_t>(y);
+    const uint32_t x1 = std::min(x0 + 1, image.width - 1);
+    const uint32_t y1 = std::min(y0 + 1, image.height - 1);
+    const float fx = x - static_cast<float>(x0);
+    const float fy = y - static_cast<float>(y0);
+
+    const ColorRGBA32F& c00 = image.At(x0, y0);
+    const ColorRGBA32F& c10 = image.At(x1, y0);
+    const ColorRGBA32F& c01 = image.At(x0, y1);
+    const ColorRGBA32F& c11 = image.At(x1, y1);
+
+    auto lerp2D = [fx, fy](float a, float b, float c, float d)
+    {
+        float top = a + fx * (b - a);
+        float bottom = c + fx * (d - c);
+        return top + fy * (bottom - top);
+    };
+
+    return ColorRGBA32F{
+        lerp2D(c00.r, c10.r, c01.r, c11.r),
+        lerp2D(c00.g, c10.g, c01.g, c11.g),
+        lerp2D(c00.b, c10.b, c01.b, c11.b),
+        lerp2D(c00.a, c10.a, c01.a, c11.a)
+    };
+}
+
+BloomSettings CreateDefaultBloomSettings()
+{
+    BloomSettings settings = { };
+    settings.threshold = 0.5f;
+    settings.compositeCoefficient = 0.75f;
+    ComputeGaussianBlurParams(10.f, GAUSSIAN_RADIUS, settings.blurParams);
+
+    return settings;
+}
+
+void ThresholdAndDownsample(const ImageRGBA32F& input, float threshold, ImageRGBA32F& output, ThreadPool* pool)
+{
+    output.Resize(input.width / 2, input.height / 2);
+
+    ParallelFor(pool, 0, output.height, ROWS_PER_TASK, [&](size_t rowBegin, size_t rowEnd)
+    {
+        for (size_t y = rowBegin; y < rowEnd; ++y)
+        {
+            ColorRGBA32F* outputRow = output.Row(static_cast<uint32_t>(y));
+            for (uint32_t x = 0; x < output.width; ++x)
+            {
+                outputRow[x] = ThresholdAndDownsamplePixel(input, threshold, static_cast<int>(x), static_cast<int>(y));
+            }
+        }
+    });
+}
+
+void Blur(const ImageRGBA32F& input, const BlurParams& params, int direction, ImageRGBA32F& output, ThreadPool* pool)
+{
+    output.Resize(input.width, input.height);
+
+    ParallelFor(pool, 0, output.height, ROWS_PER_TASK, [&](size_t rowBegin, size_t rowEnd)
+    {
+        for (size_t y = rowBegin; y < rowEnd; ++y)
+        {
+            ColorRGBA32F* outputRow = output.Row(static_cast<uint32_t>(y));
+            for (uint32_t x = 0; x < output.width; ++x)
+            {
+                outputRow[x] = BlurPixel(input, params, direction, static_cast<int>(x), static_cast<int>(y));
+            }
+        }
+    });
+}
+
+CompositeRowSource ComputeCompositeRowSource(uint32_t sceneHeight, uint32_t bloomHeight, uint32_t y) noexcept
+{
+    // same as the y part of SampleBilinearClamp() for the texel coordinate of the output row
+    const float scaleY = static_cast<float>(bloomHeight) / static_cast<float>(sceneHeight);
+    const float v = (static_cast<float>(y) + 0.5f) * scaleY;
+    const float bloomY = std::clamp(v - 0.5f, 0.f, static_cast<float>(bloomHeight - 1));
+
+    CompositeRowSource source;
+    source.row0 = static_cast<uint32_t>(bloomY);
+    source.row1 = std::min(source.row0 + 1, bloomHeight - 1);
+    source.weight = bloomY - static_cast<float>(source.row0);
+    return source;
+}
+
+void CompositeRow(const ColorRGBA32F* sceneRow, uint32_t sceneWidth, const ColorRGBA32F* bloomRow0, const ColorRGBA32F* bloomRow1,
+    uint32_t bloomWidth, float weight, float coefficient, ColorRGBA32F* outputRow) noexcept
+{
+    const float scaleX = static_cast<float>(bloomWidth) / static_cast<float>(sceneWidth);
+    const float maxX = static_cast<float>(bloomWidth - 1);
+
+    auto lerp2D = [weight](float fx, float a, float b, float c, float d)
+    {
+        float top = a + fx * (b - a);
+        float bottom = c + fx * (d - c);
+        return top + weight * (bottom - top);
+    };
+
+    for (uint32_t x = 0; x < sceneWidth; ++x)
+    {
+        // the x part of SampleBilinearClamp()
+        const float bloomX = std::clamp((static_cast<float>(x) + 0.5f) * scaleX - 0.5f, 0.f, maxX);
+        const uint32_t x0 = static_cast<uint32_t>(bloomX);
+        const uint32_t x1 = std::min(x0 + 1, bloomWidth - 1);
+        const float fx = bloomX - static_cast<float>(x0);
+
+        const ColorRGBA32F& c00 = bloomRow0[x0];
+        const ColorRGBA32F& c10 = bloomRow0[x1];
+        const ColorRGBA32F& c01 = bloomRow1[x0];
+        const ColorRGBA32F& c11 = bloomRow1[x1];
+        const ColorRGBA32F b = {
+            lerp2D(fx, c00.r, c10.r, c01.r, c11.r),
+            lerp2D(fx, c00.g, c10.g, c01.g, c11.g),
+            lerp2D(fx, c00.b, c10.b, c01.b, c11.b),
+            lerp2D(fx, c00.a, c10.a, c01.a, c11.a)
+        };
+        const ColorRGBA32F& s = sceneRow[x];
+
+        // output: tex0 + coefficient * tex1
+        outputRow[x] = ColorRGBA32F{ s.r + coefficient * b.r, s.g + coefficient * b.g, s.b + coefficient * b.b, s.a + coefficient * b.a };
+    }
+}
+
+void Composite(const ImageRGBA32F& scene, const ImageRGBA32F& bloom, float coefficient, ImageRGBA32F& output, ThreadPool* pool)
+{
+    output.Resize(scene.width, scene.height);
+    if (bloom.width == 0 || bloom.height == 0)
+    {
+        output.pixels = scene.pixels;
+        return;
+    }
+
+    ParallelFor(pool, 0, output.height, ROWS_PER_TASK, [&](size_t rowBegin, size_t rowEnd)
+    {
+        for (size_t y = rowBegin; y < rowEnd; ++y)
+        {
+            const CompositeRowSource source = ComputeCompositeRowSource(scene.height, bloom.height, static_cast<uint32_t>(y));
+            CompositeRow(scene.Row(static_cast<uint32_t>(y)), scene.width, bloom.Row(source.row0), bloom.Row(source.row1), bloom.width,
+                source.weight, coefficient, output.Row(static_cast<uint32_t>(y)));
+        }
+    });
+}
+
+void ComputeBloom(const ImageRGBA32F& scene, const BloomSettings& settings, BloomBuffers& buffers, ThreadPool* pool)
+{
+    // same ping-pong as in RenderFrame(): RT1 -> RT2 (horizontal) -> RT1 (vertical)
+    ThresholdAndDownsample(scene, settings.threshold, buffers.bloom, pool);
+    Blur(buffers.bloom, settings.blurParams, 0, buffers.temp, pool);
+    Blur(buffers.temp, settings.blurParams, 1, buffers.bloom, pool);
+}
+
+void ApplyBloom(const ImageRGBA32F& scene, const BloomSettings& settings, BloomBuffers& buffers, ImageRGBA32F& output, ThreadPool* pool)
+{
+    ComputeBloom(scene, settings, buffers, pool);
+    Composite(scene, buffers.bloom, settings.compositeCoefficient, output, pool);
+}
@@ -0,0 +1,347 @@
+#include "cpu/fft.h"
+
+#include "util/threadpool.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+
+#include <xmmintrin.h>
+
+namespace
+{
+    // SIMD width in floats (SSE)
+    constexpr uint32_t SIMD_WIDTH = 4;
+
+    // number of columns transformed together by one task, the rows of a chunk should fit into the L2 cache
+    constexpr uint32_t COLUMNS_PER_TASK = 32;
+
+    // block size of the transposition
+    constexpr uint32_t TRANSPOSE_BLOCK_SIZE = 32;
+
+    void ComputeTwiddles(uint32_t n, uint32_t count, std::vector<float>& twiddlesRe, std::vector<float>& twiddlesIm)
+    {
+        twiddlesRe.resize(count);
+        twiddlesIm.resize(count);
+        for (uint32_t k = 0; k < count; ++k)
+        {
+            // computed in double precision, the error of the twiddles dominates for large transforms otherwise
+            const double angle = -2.0 * 3.14159265358979323846 * k / n;
+            twiddlesRe[k] = static_cast<float>(std::cos(angle));
+            twiddlesIm[k] = static_cast<float>(std::sin(angle));
+        }
+    }
+
+    uint32_t ReverseBits(uint32_t value, uint32_t bitCount) noexcept
+    {
+        uint32_t result = 0;
+        for (uint32_t i = 0; i < bitCount; ++i)
+        {
+            result = (result << 1) | ((value >> i) & 1);
+        }
+        return result;
+    }
+
+    // a, b = a + w * b, a - w * b for count floats (count is a multiple of SIMD_WIDTH)
+    inline void Butterfly(float* aRe, float* aIm, float* bRe, float* bIm, uint32_t count, float wRe, float wIm) noexcept
+    {
+        const __m128 twiddleRe = _mm_set1_ps(wRe);
+        const __m128 twiddleIm = _mm_set1_ps(wIm);
+
+        for (uint32_t i = 0; i < count; i += SIMD_WIDTH)
+        {
+            const __m128 ar = _mm_loadu_ps(aRe + i);
+            const __m128 ai = _mm_loadu_ps(aIm + i);
+            const __m128 br = _mm_loadu_ps(bRe + i);
+            const __m128 bi = _mm_loadu_ps(bIm + i);
+
+            const __m128 tr = _mm_sub_ps(_mm_mul_ps(twiddleRe, br), _mm_mul_ps(twiddleIm, bi));
+            const __m128 ti = _mm_add_ps(_mm_mul_ps(twiddleRe, bi), _mm_mul_ps(twiddleIm, br));
+
+            _mm_storeu_ps(aRe + i, _mm_add_ps(ar, tr));
+            _mm_storeu_ps(aIm + i, _mm_add_ps(ai, ti));
+            _mm_storeu_ps(bRe + i, _mm_sub_ps(ar, tr));
+            _mm_storeu_ps(bIm + i, _mm_sub_ps(ai, ti));
+        }
+    }
+
+    /**
+     * In-place radix-2 FFT of size n along the first n rows of plane, for every column.
+     *
+     * Notes:
+     * - twiddles contain exp(-2 pi i k / n) for k < n / 2, the inverse transform uses their conjugates
+     * - the inverse transform is not normalized
+     */
+    void FftAlongRows(ComplexPlane& plane, uint32_t n, const std::vector<float>& twiddlesRe, const std::vector<float>& twiddlesIm, bool inverse, ThreadPool* pool)
+    {
+        assert((n & (n - 1)) == 0 && n <= plane.rows);
+
+        uint32_t bitCount = 0;
+        while ((1u << bitCount) < n)
+        {
+            ++bitCount;
+        }
+        const float sign = inverse ? -1.f : 1.f;
+
+        ParallelFor(pool, 0, (plane.stride + COLUMNS_PER_TASK - 1) / COLUMNS_PER_TASK, 1, [&](size_t chunkBegin, size_t chunkEnd)
+        {
+            for (size_t chunk = chunkBegin; chunk < chunkEnd; ++chunk)
+            {
+                const uint32_t c0 = static_cast<uint32_t>(chunk) * COLUMNS_PER_TASK;
+                const uint32_t count = std::min(c0 + COLUMNS_PER_TASK, plane.stride) - c0;
+
+                // bit-reversal permutation of the rows
+                for (uint32_t i = 0; i < n; ++i)
+                {
+                    const uint32_t j = ReverseBits(i, bitCount);
+                    if (i < j)
+                    {
+                        std::swap_ranges(plane.Re(i) + c0, plane.Re(i) + c0 + count, plane.Re(j) + c0);
+                        std::swap_ranges(plane.Im(i) + c0, plane.Im(i) + c0 + count, plane.Im(j) + c0);
+                    }
+                }
+
+                // iterative decimation in time
+                for (uint32_t half = 1; half < n; half *= 2)
+                {
+                    const uint32_t twiddleStep = n / (2 * half);
+                    for (uint32_t start = 0; start < n; start += 2 * half)
+                    {
+                        for (uint32_t k = 0; k < half; ++k)
+                        {
+                            const uint32_t a = start + k;
+                            const uint32_t b = a + half;
+                            Butterfly(plane.Re(a) + c0, plane.Im(a) + c0, plane.Re(b) + c0, plane.Im(b) + c0, count,
+                                twiddlesRe[k * twiddleStep], sign * twiddlesIm[k * twiddleStep]);
+                        }
+                    }
+                }
+            }
+        });
+    }
+
+    // dst = transpose(src), dst is resized accordingly
+    void Transpose(const ComplexPlane& src, ComplexPlane& dst, ThreadPool* pool)
+    {
+        dst.Resize(src.columns, src.rows);
+
+        ParallelFor(pool, 0, (dst.rows + TRANSPOSE_BLOCK_SIZE - 1) / TRANSPOSE_BLOCK_SIZE, 1, [&](size_t blockBegin, size_t blockEnd)
+        {
+            for (size_t block = blockBegin; block < blockEnd; ++block)
+            {
+                const uint32_t row0 = static_cast<uint32_t>(block) * TRANSPOSE_BLOCK_SIZE;
+                const uint32_t row1 = std::min(row0 + TRANSPOSE_BLOCK_SIZE, dst.rows);
+
+                for (uint32_t column0 = 0; column0 < dst.columns; column0 += TRANSPOSE_BLOCK_SIZE)
+                {
+                    const uint32_t column1 = std::min(column0 + TRANSPOSE_BLOCK_SIZE, dst.columns);
+                    for (uint32_t row = row0; row < row1; ++row)
+                    {
+                        float* dstRe = dst.Re(row);
+                        float* dstIm = dst.Im(row);
+                        for (uint32_t column = column0; column < column1; ++column)
+                        {
+                            dstRe[column] = src.Re(column)[row];
+                            dstIm[column] = src.Im(column)[row];
+                        }
+                    }
+                }
+            }
+        });
+    }
+}
+
+void ComplexPlane::Resize(uint32_t newRows, uint32_t newColumns)
+{
+    if (rows == newRows && columns == newColumns)
+    {
+        return;
+    }
+
+    rows = newRows;
+    columns = newColumns;
+    stride = (newColumns + SIMD_WIDTH - 1) / SIMD_WIDTH * SIMD_WIDTH;
+    re.assign(static_cast<size_t>(rows) * stride, 0.f);
+    im.assign(static_cast<size_t>(rows) * stride, 0.f);
+}
+
+uint32_t NextPowerOfTwo(uint32_t value) noexcept
+{
+    uint32_t result = 1;
+    while (result < value)
+    {
+        result *= 2;
+    }
+    return result;
+}
+
+RealFft2D::RealFft2D(uint32_t width, uint32_t height)
+    : m_width(width)
+    , m_height(height)
+{
+    assert(width >= 2 && (width & (width - 1)) == 0);
+    assert(height >= 4 && (height & (height - 1)) == 0);
+
+    ComputeTwiddles(height / 2, height / 4, m_twiddlesYRe, m_twiddlesYIm);
+    ComputeTwiddles(width, width / 2, m_twiddlesXRe, m_twiddlesXIm);
+    ComputeTwiddles(height, height / 2 + 1, m_realTwiddlesRe, m_realTwiddlesIm);
+}
+
+void RealFft2D::Forward(const std::vector<float>& input, ComplexPlane& spectrum, ThreadPool* pool)
+{
+    assert(input.size() == static_cast<size_t>(m_width) * m_height);
+
+    const uint32_t halfHeight = m_height / 2;
+    m_rows.Resize(halfHeight + 1, m_width);
+
+    // 1. pack the even rows into the real and the odd rows into the imaginary part
+    for (uint32_t k = 0; k < halfHeight; ++k)
+    {
+        std::memcpy(m_rows.Re(k), input.data() + static_cast<size_t>(2 * k) * m_width, m_width * sizeof(float));
+        std::memcpy(m_rows.Im(k), input.data() + static_cast<size_t>(2 * k + 1) * m_width, m_width * sizeof(float));
+    }
+
+    // 2. complex FFT of size height / 2 along y
+    FftAlongRows(m_rows, halfHeight, m_twiddlesYRe, m_twiddlesYIm, false, pool);
+
+    // 3. separate the spectra of the even and odd rows and combine them into the spectrum of the real signal:
+    //    X[k] = E[k] + w^k O[k] with E[k] = (Z[k] + conj(Z[n - k])) / 2 and O[k] = (Z[k] - conj(Z[n - k])) / 2i
+    //    (k and n - k are processed together since both are needed for either of them)
+    ParallelFor(pool, 0, halfHeight / 2 + 1, 4, [&](size_t pairBegin, size_t pairEnd)
+    {
+        for (size_t pair = pairBegin; pair < pairEnd; ++pair)
+        {
+            const uint32_t k = static_cast<uint32_t>(pair);
+            float* zkRe = m_rows.Re(k);
+            float* zkIm = m_rows.Im(k);
+
+            if (k == 0)
+            {
+                // Z[n] = Z[0], X[0] and X[n] are real
+                float* xnRe = m_rows.Re(halfHeight);
+                float* xnIm = m_rows.Im(halfHeight);
+                for (uint32_t x = 0; x < m_width; ++x)
+                {
+                    const float re = zkRe[x];
+                    const float im = zkIm[x];
+                    zkRe[x] = re + im;
+                    zkIm[x] = 0.f;
+                    xnRe[x] = re - im;
+                    xnIm[x] = 0.f;
+                }
+                continue;
+            }
+
+            const uint32_t mirrored = halfHeight - k;
+            float* zmRe = m_rows.Re(mirrored);
+            float* zmIm = m_rows.Im(mirrored);
+            const float wkRe = m_realTwiddlesRe[k];
+            const float wkIm = m_realTwiddlesIm[k];
+            const float wmRe = m_realTwiddlesRe[mirrored];
+            const float wmIm = m_realTwiddlesIm[mirrored];
+
+            for (uint32_t x = 0; x < m_width; ++x)
+            {
+                const float aRe = zkRe[x];
+                const float aIm = zkIm[x];
+                const float bRe = zmRe[x];
+                const float bIm = zmIm[x];
+
+                // E and O for k (E and O for n - k are their conjugates)
+                const float eRe = 0.5f * (aRe + bRe);
+                const float eIm = 0.5f * (aIm - bIm);
+                const float oRe = 0.5f * (aIm + bIm);
+                const float oIm = -0.5f * (aRe - bRe);
+
+                zkRe[x] = eRe + wkRe * oRe - wkIm * oIm;
+                zkIm[x] = eIm + wkRe * oIm + wkIm * oRe;
+                zmRe[x] = eRe + wmRe * oRe + wmIm * oIm;
+                zmIm[x] = -eIm - wmRe * oIm + wmIm * oRe;
+            }
+        }
+    });
+
+    // 4. complex FFT of size width along x (after transposing, so that the transform runs along the rows again)
+    Transpose(m_rows, spectrum, pool);
+    FftAlongRows(spectrum, m_width, m_twiddlesXRe, m_twiddlesXIm, false, pool);
+}
+
+void RealFft2D::Inverse(ComplexPlane& spectrum, std::vector<float>& output, ThreadPool* pool)
+{
+    assert(spectrum.rows == m_width && spectrum.columns == m_height / 2 + 1);
+
+    const uint32_t halfHeight = m_height / 2;
+
+    // 1. inverse complex FFT along x, transposed back
+    FftAlongRows(spectrum, m_width, m_twiddlesXRe, m_twiddlesXIm, true, pool);
+    Transpose(spectrum, m_rows, pool);
+
+    // 2. undo the separation of even and odd rows: Z[k] = E[k] + i O[k] with E[k] = (X[k] + conj(X[n - k])) / 2
+    //    and O[k] = (X[k] - conj(X[n - k])) conj(w^k) / 2
+    ParallelFor(pool, 0, halfHeight / 2 + 1, 4, [&](size_t pairBegin, size_t pairEnd)
+    {
+        for (size_t pair = pairBegin; pair < pairEnd; ++pair)
+        {
+            const uint32_t k = static_cast<uint32_t>(pair);
+            const uint32_t mirrored = halfHeight - k;
+            float* xkRe = m_rows.Re(k);
+            float* xkIm = m_rows.Im(k);
+            float* xmRe = m_rows.Re(mirrored);
+            float* xmIm = m_rows.Im(mirrored);
+            const float wkRe = m_realTwiddlesRe[k];
+            const float wkIm = -m_realTwiddlesIm[k];
+            const float wmRe = m_realTwiddlesRe[mirrored];
+            const float wmIm = -m_realTwiddlesIm[mirrored];
+
+            for (uint32_t x = 0; x < m_width; ++x)
+            {
+                const float aRe = xkRe[x];
+                const float aIm = xkIm[x];
+                const float bRe = xmRe[x];
+                const float bIm = xmIm[x];
+
+                // for k: E = (a + conj(b)) / 2, D = (a - conj(b)) / 2, O = D * conj(w^k)
+                const float eRe = 0.5f * (aRe + bRe);
+                const float eIm = 0.5f * (aIm - bIm);
+                const float dRe = 0.5f * (aRe - bRe);
+                const float dIm = 0.5f * (aIm + bIm);
+                const float oRe = dRe * wkRe - dIm * wkIm;
+                const float oIm = dRe * wkIm + dIm * wkRe;
+
+                xkRe[x] = eRe - oIm;
+                xkIm[x] = eIm + oRe;
+
+                if (k != 0 && mirrored != k)
+                {
+                    // for n - k the roles of a and b are swapped: E' = conj(E), D' = -conj(D)
+                    const float mRe = -dRe * wmRe - dIm * wmIm;
+                    const float mIm = -dRe * wmIm + dIm * wmRe;
+                    xmRe[x] = eRe - mIm;
+                    xmIm[x] = -eIm + mRe;
+                }
+            }
+        }
+    });
+
+    // 3. inverse complex FFT along y and unpacking of the even and odd rows
+    FftAlongRows(m_rows, halfHeight, m_twiddlesYRe, m_twiddlesYIm, true, pool);
+
+    output.resize(static_cast<size_t>(m_width) * m_height);
+    const float scale = 1.f / (static_cast<float>(halfHeight) * static_cast<float>(m_width));
+    ParallelFor(pool, 0, halfHeight, 16, [&](size_t rowBegin, size_t rowEnd)
+    {
+        for (size_t k = rowBegin; k < rowEnd; ++k)
+        {
+            const float* re = m_rows.Re(static_cast<uint32_t>(k));
+            const float* im = m_rows.Im(static_cast<uint32_t>(k));
+            float* even = output.data() + 2 * k * m_width;
+            float* odd = even + m_width;
+            for (uint32_t x = 0; x < m_width; ++x)
+            {
+                even[x] = scale * re[x];
+                odd[x] = scale * im[x];
+            }
+        }
+    });
+}
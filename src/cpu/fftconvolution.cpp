@@ -0,0 +1,137 @@
+#include "cpu/fftconvolution.h"
+
+#include "util/hash.h"
+#include "util/threadpool.h"
+
+#include <algorithm>
+#include <initializer_list>
+
+namespace
+{
+    // number of rows processed per task
+    constexpr size_t ROWS_PER_TASK = 16;
+}
+
+FftConvolver::FftConvolver()
+    : m_stats{ }
+{
+}
+
+FftConvolver::~FftConvolver() = default;
+
+const ComplexPlane& FftConvolver::GetKernelSpectrum(const Kernel2D& kernel, ThreadPool* pool)
+{
+    const uint32_t width = m_fft->GetWidth();
+    const uint32_t height = m_fft->GetHeight();
+
+    uint64_t key = HashBytes(kernel.pixels.data(), kernel.pixels.size() * sizeof(float));
+    key = HashCombine(key, (static_cast<uint64_t>(kernel.width) << 32) | kernel.height);
+    key = HashCombine(key, (static_cast<uint64_t>(width) << 32) | height);
+
+    auto it = m_kernelCache.find(key);
+    m_stats.kernelCacheHit = (it != m_kernelCache.end());
+    if (m_stats.kernelCacheHit)
+    {
+        return it->second;
+    }
+
+    // place the kernel with its center at the origin, negative offsets wrap around to the end of each dimension
+    m_plane.assign(static_cast<size_t>(width) * height, 0.f);
+    const int centerX = static_cast<int>(kernel.width / 2);
+    const int centerY = static_cast<int>(kernel.height / 2);
+    for (uint32_t j = 0; j < kernel.height; ++j)
+    {
+        const uint32_t y = static_cast<uint32_t>(static_cast<int>(j) - centerY + static_cast<int>(height)) % height;
+        for (uint32_t i = 0; i < kernel.width; ++i)
+        {
+            const uint32_t x = static_cast<uint32_t>(static_cast<int>(i) - centerX + static_cast<int>(width)) % width;
+            m_plane[static_cast<size_t>(y) * width + x] += kernel.At(i, j);
+        }
+    }
+
+    ComplexPlane& spectrum = m_kernelCache[key];
+    m_fft->Forward(m_plane, spectrum, pool);
+    return spectrum;
+}
+
+void FftConvolver::Convolve(const ImageRGBA32F& input, const Kernel2D& kernel, ImageRGBA32F& output, ThreadPool* pool)
+{
+    output.Resize(input.width, input.height);
+
+    // the padding has to hold the spread of the kernel beyond the image borders in one direction each
+    // (the other direction wraps around into the padding as well, but never reaches the image again)
+    const uint32_t width = std::max(NextPowerOfTwo(input.width + kernel.width / 2), 2u);
+    const uint32_t height = std::max(NextPowerOfTwo(input.height + kernel.height / 2), 4u);
+    if (!m_fft || m_fft->GetWidth() != width || m_fft->GetHeight() != height)
+    {
+        m_fft = std::make_unique<RealFft2D>(width, height);
+    }
+    m_stats.fftWidth = width;
+    m_stats.fftHeight = height;
+
+    const ComplexPlane& kernelSpectrum = GetKernelSpectrum(kernel, pool);
+
+    for (float ColorRGBA32F::* channel : { &ColorRGBA32F::r, &ColorRGBA32F::g, &ColorRGBA32F::b })
+    {
+        // 1. extract the channel into the zero-padded plane
+        m_plane.assign(static_cast<size_t>(width) * height, 0.f);
+        ParallelFor(pool, 0, input.height, ROWS_PER_TASK, [&](size_t rowBegin, size_t rowEnd)
+        {
+            for (size_t y = rowBegin; y < rowEnd; ++y)
+            {
+                const ColorRGBA32F* inputRow = input.Row(static_cast<uint32_t>(y));
+                float* planeRow = m_plane.data() + y * width;
+                for (uint32_t x = 0; x < input.width; ++x)
+                {
+                    planeRow[x] = inputRow[x].*channel;
+                }
+            }
+        });
+
+        // 2. multiply the spectra
+        m_fft->Forward(m_plane, m_spectrum, pool);
+        ParallelFor(pool, 0, m_spectrum.rows, ROWS_PER_TASK, [&](size_t rowBegin, size_t rowEnd)
+        {
+            for (size_t row = rowBegin; row < rowEnd; ++row)
+            {
+                float* re = m_spectrum.Re(static_cast<uint32_t>(row));
+                float* im = m_spectrum.Im(static_cast<uint32_t>(row));
+                const float* kernelRe = kernelSpectrum.Re(static_cast<uint32_t>(row));
+                const float* kernelIm = kernelSpectrum.Im(static_cast<uint32_t>(row));
+                for (uint32_t x = 0; x < m_spectrum.columns; ++x)
+                {
+                    const float a = re[x];
+                    const float b = im[x];
+                    re[x] = a * kernelRe[x] - b * kernelIm[x];
+                    im[x] = a * kernelIm[x] + b * kernelRe[x];
+                }
+            }
+        });
+        m_fft->Inverse(m_spectrum, m_plane, pool);
+
+        // 3. write the channel back
+        ParallelFor(pool, 0, output.height, ROWS_PER_TASK, [&](size_t rowBegin, size_t rowEnd)
+        {
+            for (size_t y = rowBegin; y < rowEnd; ++y)
+            {
+                ColorRGBA32F* outputRow = output.Row(static_cast<uint32_t>(y));
+                const float* planeRow = m_plane.data() + y * width;
+                for (uint32_t x = 0; x < output.width; ++x)
+                {
+                    outputRow[x].*channel = planeRow[x];
+                }
+            }
+        });
+    }
+
+    for (ColorRGBA32F& pixel : output.pixels)
+    {
+        pixel.a = 1.f;
+    }
+}
+
+void ComputeFftBloom(const ImageRGBA32F& scene, float threshold, const Kernel2D& kernel, FftConvolver& convolver, BloomBuffers& buffers, ThreadPool* pool)
+{
+    ThresholdAndDownsample(scene, threshold, buffers.temp, pool);
+    convolver.Convolve(buffers.temp, kernel, buffers.bloom, pool);
+}
@@ -0,0 +1,609 @@
+#include "cpu/fixedpointbloom.h"
+
+#include "cpu/bloom.h"
+#include "util/threadpool.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include <tmmintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+// SSE2 is part of x64, pmulhrsw needs SSSE3: like the AVX2 kernels in phong.cpp, GCC and Clang need the target for each
+// function using it (including the functions called by ParallelFor(), lambdas do not get the target of their function)
+#if defined(__GNUC__)
+#define SSSE3_FUNCTION __attribute__((target("ssse3")))
+#else
+#define SSSE3_FUNCTION
+#endif
+
+namespace
+{
+    // number of rows processed per task
+    constexpr size_t ROWS_PER_TASK = 16;
+
+    // Q15 fixed point: 1.0 = 2^15 (not representable, the max. coefficient is 32767 / 32768)
+    constexpr double Q15_ONE = 32768.0;
+    // Q13 fixed point for the composite coefficient, which may be larger than 1
+    constexpr double Q13_ONE = 8192.0;
+
+    // fractional bits of the expanded 8-bit pixel values
+    constexpr int PIXEL_FRACTION_BITS = 7;
+
+    // the product of a value (PIXEL_FRACTION_BITS fractional bits) and a Q13 coefficient has 2 bits less, it is
+    // clamped before it is shifted back (larger values saturate the result anyway)
+    constexpr int Q13_SHIFT = 2;
+    constexpr int MAX_BLOOM_TERM = 32767 >> Q13_SHIFT;
+
+    bool DetectSsse3() noexcept
+    {
+#if defined(_MSC_VER)
+        int info[4];
+        __cpuid(info, 1);
+        return (info[2] & (1 << 9)) != 0;
+#else
+        return __builtin_cpu_supports("ssse3");
+#endif
+    }
+
+    // scalar equivalent of pmulhrsw: (a * b + 2^14) >> 15
+    inline int MultiplyRoundQ15(int a, int b) noexcept
+    {
+        return (a * b + (1 << 14)) >> 15;
+    }
+
+    // rounds the accumulated value (with PIXEL_FRACTION_BITS fractional bits) and saturates to 8 bits
+    inline uint8_t ToUnorm8(int accumulatedValue) noexcept
+    {
+        const int value = (std::min(accumulatedValue, 32767) + (1 << (PIXEL_FRACTION_BITS - 1))) >> PIXEL_FRACTION_BITS;
+        return static_cast<uint8_t>(std::clamp(value, 0, 255));
+    }
+
+    // value in fixed point with the given one, rounded and clamped to [0, 32767] (NaN is 0)
+    inline int16_t ToFixedPoint(double value, double one) noexcept
+    {
+        const double scaled = std::round(value * one);
+        return static_cast<int16_t>((scaled > 0.0) ? std::min(scaled, 32767.0) : 0.0);
+    }
+
+    inline ColorRGBA8 LoadOrZero(const ImageRGBA8& image, int x, int y) noexcept
+    {
+        if (x < 0 || y < 0 || x >= static_cast<int>(image.width) || y >= static_cast<int>(image.height))
+        {
+            return ColorRGBA8{ 0, 0, 0, 0 };
+        }
+        return image.At(static_cast<uint32_t>(x), static_cast<uint32_t>(y));
+    }
+
+    // four RGBA8 pixels expanded to 16 bits with PIXEL_FRACTION_BITS fractional bits (pixels 0-1 in low, 2-3 in high)
+    inline void LoadExpanded(const ColorRGBA8* pixels, __m128i& low, __m128i& high) noexcept
+    {
+        const __m128i value = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pixels));
+        const __m128i zero = _mm_setzero_si128();
+        low = _mm_slli_epi16(_mm_unpacklo_epi8(value, zero), PIXEL_FRACTION_BITS);
+        high = _mm_slli_epi16(_mm_unpackhi_epi8(value, zero), PIXEL_FRACTION_BITS);
+    }
+
+    // rounds and packs the accumulators of four pixels back to RGBA8
+    inline void StoreRounded(__m128i low, __m128i high, ColorRGBA8* pixels) noexcept
+    {
+        // the accumulators are non-negative and below 2^15, so the logical shift is correct
+        const __m128i roundingOffset = _mm_set1_epi16(1 << (PIXEL_FRACTION_BITS - 1));
+        low = _mm_srli_epi16(_mm_add_epi16(low, roundingOffset), PIXEL_FRACTION_BITS);
+        high = _mm_srli_epi16(_mm_add_epi16(high, roundingOffset), PIXEL_FRACTION_BITS);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(pixels), _mm_packus_epi16(low, high));
+    }
+
+    // accumulator += pixels * coefficient for four pixels
+    SSSE3_FUNCTION inline void MultiplyAccumulate(const ColorRGBA8* pixels, __m128i coefficient, __m128i& accumulatorLow, __m128i& accumulatorHigh) noexcept
+    {
+        __m128i low;
+        __m128i high;
+        LoadExpanded(pixels, low, high);
+        accumulatorLow = _mm_adds_epi16(accumulatorLow, _mm_mulhrs_epi16(low, coefficient));
+        accumulatorHigh = _mm_adds_epi16(accumulatorHigh, _mm_mulhrs_epi16(high, coefficient));
+    }
+
+    ///////////////////////
+    // threshold and downsample
+
+    // length(sum / (4 * 255)) > threshold <=> |sum|^2 > (4 * 255 * threshold)^2, which is |sum|^2 > floor((4 * 255 * threshold)^2)
+    // for the integer |sum|^2 (at most 3 * 1020^2), -1 lets all pixels pass for a negative threshold
+    int32_t ComputeThresholdLimit(float threshold) noexcept
+    {
+        if (threshold < 0.f)
+        {
+            return -1;
+        }
+
+        const double limit = static_cast<double>(threshold) * 4.0 * 255.0;
+        const double limitSquared = limit * limit;
+        return (limitSquared < static_cast<double>(std::numeric_limits<int32_t>::max())) ? static_cast<int32_t>(limitSquared)
+            : std::numeric_limits<int32_t>::max();
+    }
+
+    // output pixel x of the two input rows (all four inputs are inside of the image)
+    inline ColorRGBA8 ThresholdAndDownsampleBlock(const ColorRGBA8* row0, const ColorRGBA8* row1, int32_t limit, int x) noexcept
+    {
+        const ColorRGBA8& c00 = row0[2 * x];
+        const ColorRGBA8& c10 = row0[2 * x + 1];
+        const ColorRGBA8& c01 = row1[2 * x];
+        const ColorRGBA8& c11 = row1[2 * x + 1];
+
+        const int r = c00.r + c10.r + c01.r + c11.r;
+        const int g = c00.g + c10.g + c01.g + c11.g;
+        const int b = c00.b + c10.b + c01.b + c11.b;
+
+        if (r * r + g * g + b * b > limit)
+        {
+            return ColorRGBA8{ static_cast<uint8_t>((r + 2) >> 2), static_cast<uint8_t>((g + 2) >> 2), static_cast<uint8_t>((b + 2) >> 2), 255 };
+        }
+        return ColorRGBA8{ 0, 0, 0, 255 };
+    }
+
+    void ThresholdAndDownsampleRow(const ColorRGBA8* row0, const ColorRGBA8* row1, int width, int32_t limit, ColorRGBA8* outputRow) noexcept
+    {
+        for (int x = 0; x < width; ++x)
+        {
+            outputRow[x] = ThresholdAndDownsampleBlock(row0, row1, limit, x);
+        }
+    }
+
+    // four output pixels (eight input pixels per row) at a time
+    SSSE3_FUNCTION void ThresholdAndDownsampleRowSsse3(const ColorRGBA8* row0, const ColorRGBA8* row1, int width, int32_t limit,
+        ColorRGBA8* outputRow) noexcept
+    {
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i rgbMask = _mm_set_epi16(0, -1, -1, -1, 0, -1, -1, -1);
+        const __m128i opaque = _mm_set1_epi32(static_cast<int>(0xff000000u));
+        const __m128i roundingOffset = _mm_set1_epi16(2);
+        const __m128i limitVector = _mm_set1_epi32(limit);
+
+        int x = 0;
+        for (; x + 4 <= width; x += 4)
+        {
+            // channel sums of the 2x2 blocks, two output pixels per register
+            __m128i sums[2];
+            for (int half = 0; half < 2; ++half)
+            {
+                const __m128i top = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row0 + 2 * x + 4 * half));
+                const __m128i bottom = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row1 + 2 * x + 4 * half));
+                const __m128i low = _mm_add_epi16(_mm_unpacklo_epi8(top, zero), _mm_unpacklo_epi8(bottom, zero));
+                const __m128i high = _mm_add_epi16(_mm_unpackhi_epi8(top, zero), _mm_unpackhi_epi8(bottom, zero));
+                sums[half] = _mm_add_epi16(_mm_unpacklo_epi64(low, high), _mm_unpackhi_epi64(low, high));
+            }
+
+            // squared length of the RGB sums per output pixel (r^2 + g^2, b^2 + 0 added pairwise)
+            const __m128i lengthSquared = _mm_hadd_epi32(_mm_madd_epi16(_mm_and_si128(sums[0], rgbMask), sums[0]),
+                _mm_madd_epi16(_mm_and_si128(sums[1], rgbMask), sums[1]));
+            const __m128i passed = _mm_cmpgt_epi32(lengthSquared, limitVector);
+
+            const __m128i average = _mm_packus_epi16(_mm_srli_epi16(_mm_add_epi16(sums[0], roundingOffset), 2),
+                _mm_srli_epi16(_mm_add_epi16(sums[1], roundingOffset), 2));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(outputRow + x), _mm_or_si128(_mm_and_si128(average, passed), opaque));
+        }
+
+        for (; x < width; ++x)
+        {
+            outputRow[x] = ThresholdAndDownsampleBlock(row0, row1, limit, x);
+        }
+    }
+
+    ///////////////////////
+    // blur
+
+    void BlurRow(const ImageRGBA8& input, const FixedPointBlurParams& params, int direction, int y, ColorRGBA8* outputRow) noexcept
+    {
+        for (int x = 0; x < static_cast<int>(input.width); ++x)
+        {
+            outputRow[x] = BlurPixel(input, params, direction, x, y);
+        }
+    }
+
+    SSSE3_FUNCTION void BlurRowSsse3(const ImageRGBA8& input, const FixedPointBlurParams& params, int direction, int y, ColorRGBA8* outputRow) noexcept
+    {
+        const int width = static_cast<int>(input.width);
+        const int height = static_cast<int>(input.height);
+        const int radius = params.radius;
+
+        __m128i coefficients[GAUSSIAN_RADIUS + 1];
+        for (int i = 0; i <= radius; ++i)
+        {
+            coefficients[i] = _mm_set1_epi16(params.coefficients[i]);
+        }
+
+        // SIMD for groups of four pixels whose taps are all inside of the image (in x), the scalar version for the rest
+        const int simdBegin = (direction == 0) ? radius : 0;
+        const int simdEnd = (direction == 0) ? width - radius : width;
+
+        int x = 0;
+        for (; x < simdBegin && x < width; ++x)
+        {
+            outputRow[x] = BlurPixel(input, params, direction, x, y);
+        }
+
+        for (; x + 4 <= simdEnd; x += 4)
+        {
+            __m128i accumulatorLow = _mm_setzero_si128();
+            __m128i accumulatorHigh = _mm_setzero_si128();
+
+            if (direction == 0)
+            {
+                const ColorRGBA8* inputPixels = input.Row(static_cast<uint32_t>(y)) + x;
+                for (int i = -radius; i <= radius; ++i)
+                {
+                    MultiplyAccumulate(inputPixels + i, coefficients[std::abs(i)], accumulatorLow, accumulatorHigh);
+                }
+            }
+            else
+            {
+                // rows outside of the image are zero, i.e., they do not contribute
+                const int iBegin = std::max(-radius, -y);
+                const int iEnd = std::min(radius, height - 1 - y);
+                for (int i = iBegin; i <= iEnd; ++i)
+                {
+                    MultiplyAccumulate(input.Row(static_cast<uint32_t>(y + i)) + x, coefficients[std::abs(i)], accumulatorLow, accumulatorHigh);
+                }
+            }
+
+            StoreRounded(accumulatorLow, accumulatorHigh, outputRow + x);
+        }
+
+        for (; x < width; ++x)
+        {
+            outputRow[x] = BlurPixel(input, params, direction, x, y);
+        }
+    }
+
+    ///////////////////////
+    // composite
+
+    // the two bloom pixels and the interpolation weight between them sampled for an output column (like CompositeRow())
+    struct CompositeColumn
+    {
+        uint32_t x0;
+        uint32_t x1;
+        // Q15 weight of x1, once per channel
+        int16_t weight[4];
+    };
+
+    CompositeColumn ComputeCompositeColumn(uint32_t sceneWidth, uint32_t bloomWidth, uint32_t x) noexcept
+    {
+        // the x part of SampleBilinearClamp(), like CompositeRow()
+        const float scaleX = static_cast<float>(bloomWidth) / static_cast<float>(sceneWidth);
+        const float bloomX = std::clamp((static_cast<float>(x) + 0.5f) * scaleX - 0.5f, 0.f, static_cast<float>(bloomWidth - 1));
+
+        CompositeColumn column;
+        column.x0 = static_cast<uint32_t>(bloomX);
+        column.x1 = std::min(column.x0 + 1, bloomWidth - 1);
+        std::fill(column.weight, column.weight + 4, ToFixedPoint(bloomX - static_cast<float>(column.x0), Q15_ONE));
+        return column;
+    }
+
+    // bloom pixel interpolated between two rows, the channels have PIXEL_FRACTION_BITS fractional bits
+    inline void InterpolatePixel(const ColorRGBA8& top, const ColorRGBA8& bottom, int weight, int16_t interpolated[4]) noexcept
+    {
+        const uint8_t topChannels[4] = { top.r, top.g, top.b, top.a };
+        const uint8_t bottomChannels[4] = { bottom.r, bottom.g, bottom.b, bottom.a };
+        for (int c = 0; c < 4; ++c)
+        {
+            const int a = topChannels[c] << PIXEL_FRACTION_BITS;
+            interpolated[c] = static_cast<int16_t>(a + MultiplyRoundQ15((bottomChannels[c] << PIXEL_FRACTION_BITS) - a, weight));
+        }
+    }
+
+    // scene + coefficient * bloom, with the bloom interpolated between two interpolated pixels
+    inline ColorRGBA8 CompositeBloomPixel(const ColorRGBA8& scene, const int16_t left[4], const int16_t right[4], const CompositeColumn& column,
+        int coefficient) noexcept
+    {
+        const uint8_t sceneChannels[4] = { scene.r, scene.g, scene.b, scene.a };
+        uint8_t result[4];
+        for (int c = 0; c < 4; ++c)
+        {
+            const int bloom = left[c] + MultiplyRoundQ15(right[c] - left[c], column.weight[c]);
+            const int bloomTerm = std::min(MultiplyRoundQ15(bloom, coefficient), MAX_BLOOM_TERM) << Q13_SHIFT;
+            result[c] = ToUnorm8((sceneChannels[c] << PIXEL_FRACTION_BITS) + bloomTerm);
+        }
+        return ColorRGBA8{ result[0], result[1], result[2], result[3] };
+    }
+
+    void InterpolateRows(const ColorRGBA8* row0, const ColorRGBA8* row1, uint32_t width, int weight, int16_t* interpolatedRow) noexcept
+    {
+        for (uint32_t x = 0; x < width; ++x)
+        {
+            InterpolatePixel(row0[x], row1[x], weight, interpolatedRow + 4 * x);
+        }
+    }
+
+    SSSE3_FUNCTION void InterpolateRowsSsse3(const ColorRGBA8* row0, const ColorRGBA8* row1, uint32_t width, int weight, int16_t* interpolatedRow) noexcept
+    {
+        const __m128i weightVector = _mm_set1_epi16(static_cast<int16_t>(weight));
+
+        uint32_t x = 0;
+        for (; x + 4 <= width; x += 4)
+        {
+            __m128i topLow, topHigh, bottomLow, bottomHigh;
+            LoadExpanded(row0 + x, topLow, topHigh);
+            LoadExpanded(row1 + x, bottomLow, bottomHigh);
+            const __m128i low = _mm_add_epi16(topLow, _mm_mulhrs_epi16(_mm_sub_epi16(bottomLow, topLow), weightVector));
+            const __m128i high = _mm_add_epi16(topHigh, _mm_mulhrs_epi16(_mm_sub_epi16(bottomHigh, topHigh), weightVector));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(interpolatedRow + 4 * x), low);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(interpolatedRow + 4 * x + 8), high);
+        }
+
+        for (; x < width; ++x)
+        {
+            InterpolatePixel(row0[x], row1[x], weight, interpolatedRow + 4 * x);
+        }
+    }
+
+    void CompositeInterpolatedRow(const ColorRGBA8* sceneRow, uint32_t sceneWidth, const int16_t* bloomRow, const CompositeColumn* columns, int coefficient,
+        ColorRGBA8* outputRow) noexcept
+    {
+        for (uint32_t x = 0; x < sceneWidth; ++x)
+        {
+            const CompositeColumn& column = columns[x];
+            outputRow[x] = CompositeBloomPixel(sceneRow[x], bloomRow + 4 * column.x0, bloomRow + 4 * column.x1, column, coefficient);
+        }
+    }
+
+    // two output pixels before rounding, with PIXEL_FRACTION_BITS fractional bits
+    SSSE3_FUNCTION inline __m128i CompositeTwoPixels(const ColorRGBA8* scenePixels, const int16_t* bloomRow, const CompositeColumn* columns,
+        __m128i coefficient) noexcept
+    {
+        const __m128i left = _mm_unpacklo_epi64(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(bloomRow + 4 * columns[0].x0)),
+            _mm_loadl_epi64(reinterpret_cast<const __m128i*>(bloomRow + 4 * columns[1].x0)));
+        const __m128i right = _mm_unpacklo_epi64(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(bloomRow + 4 * columns[0].x1)),
+            _mm_loadl_epi64(reinterpret_cast<const __m128i*>(bloomRow + 4 * columns[1].x1)));
+        const __m128i weight = _mm_unpacklo_epi64(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(columns[0].weight)),
+            _mm_loadl_epi64(reinterpret_cast<const __m128i*>(columns[1].weight)));
+
+        const __m128i bloom = _mm_add_epi16(left, _mm_mulhrs_epi16(_mm_sub_epi16(right, left), weight));
+        const __m128i bloomTerm = _mm_slli_epi16(_mm_min_epi16(_mm_mulhrs_epi16(bloom, coefficient), _mm_set1_epi16(MAX_BLOOM_TERM)), Q13_SHIFT);
+        const __m128i scene = _mm_slli_epi16(_mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(scenePixels)), _mm_setzero_si128()),
+            PIXEL_FRACTION_BITS);
+        return _mm_adds_epi16(scene, bloomTerm);
+    }
+
+    SSSE3_FUNCTION void CompositeInterpolatedRowSsse3(const ColorRGBA8* sceneRow, uint32_t sceneWidth, const int16_t* bloomRow, const CompositeColumn* columns,
+        int coefficient, ColorRGBA8* outputRow) noexcept
+    {
+        const __m128i coefficientVector = _mm_set1_epi16(static_cast<int16_t>(coefficient));
+
+        uint32_t x = 0;
+        for (; x + 4 <= sceneWidth; x += 4)
+        {
+            const __m128i low = CompositeTwoPixels(sceneRow + x, bloomRow, columns + x, coefficientVector);
+            const __m128i high = CompositeTwoPixels(sceneRow + x + 2, bloomRow, columns + x + 2, coefficientVector);
+            StoreRounded(low, high, outputRow + x);
+        }
+
+        for (; x < sceneWidth; ++x)
+        {
+            const CompositeColumn& column = columns[x];
+            outputRow[x] = CompositeBloomPixel(sceneRow[x], bloomRow + 4 * column.x0, bloomRow + 4 * column.x1, column, coefficient);
+        }
+    }
+}
+
+FixedPointBlurParams ComputeFixedPointBlurParams(const BlurParams& params) noexcept
+{
+    FixedPointBlurParams result = { };
+    result.radius = std::clamp(params.radius, 0, GAUSSIAN_RADIUS);
+
+    double floatSum = 0.0;
+    int fixedSum = 0;
+    for (int i = 0; i <= result.radius; ++i)
+    {
+        const double scaled = std::round(params.coefficients[i] * Q15_ONE);
+        result.coefficients[i] = static_cast<int16_t>(std::clamp(scaled, 0.0, 32767.0));
+
+        // all coefficients but the center are used twice
+        const int count = (i == 0) ? 1 : 2;
+        floatSum += count * static_cast<double>(params.coefficients[i]);
+        fixedSum += count * result.coefficients[i];
+    }
+
+    // put the rounding error of the sum into the center
+    const int targetSum = static_cast<int>(std::min(std::round(floatSum * Q15_ONE), 32767.0));
+    result.coefficients[0] = static_cast<int16_t>(std::clamp(result.coefficients[0] + targetSum - fixedSum, 0, 32767));
+
+    return result;
+}
+
+double ComputeFixedPointBloomErrorBound(const BlurParams& params) noexcept
+{
+    const FixedPointBlurParams fixedParams = ComputeFixedPointBlurParams(params);
+    const int taps = 2 * fixedParams.radius + 1;
+
+    double fixedSum = 0.0;
+    double coefficientError = 0.0;
+    for (int i = -fixedParams.radius; i <= fixedParams.radius; ++i)
+    {
+        const double fixedCoefficient = fixedParams.coefficients[std::abs(i)] / Q15_ONE;
+        fixedSum += fixedCoefficient;
+        coefficientError += std::fabs(fixedCoefficient - params.coefficients[std::abs(i)]);
+    }
+
+    // 0.5 for rounding the downsampled value to 8 bits
+    double bound = 0.5;
+    for (int pass = 0; pass < 2; ++pass)
+    {
+        // input error weighted by the kernel + coefficient quantization (for values up to 255)
+        // + rounding of each multiplication (0.5 in units of 2^-7) + final rounding
+        bound = bound * fixedSum + 255.0 * coefficientError + taps * 0.5 / (1 << PIXEL_FRACTION_BITS) + 0.5;
+    }
+
+    return bound;
+}
+
+double ComputeFixedPointCompositeErrorBound(float coefficient) noexcept
+{
+    const double fixedCoefficient = ToFixedPoint(coefficient, Q13_ONE) / Q13_ONE;
+
+    // each interpolation: the Q15 weight is off by up to 2^-15 (for differences up to 255) and the multiplication is
+    // rounded (0.5 in units of 2^-7), the error of the first one is carried through the second one
+    const double interpolationError = 2.0 * (255.0 / Q15_ONE + 0.5 / (1 << PIXEL_FRACTION_BITS));
+
+    // the interpolated bloom weighted by the coefficient + coefficient quantization (for values up to 255)
+    // + rounding of the multiplication (0.5 in units of 2^-5) + final rounding, saturation only reduces the error
+    return fixedCoefficient * interpolationError + 255.0 * std::fabs(fixedCoefficient - std::max(static_cast<double>(coefficient), 0.0))
+        + 0.5 * (1 << Q13_SHIFT) / (1 << PIXEL_FRACTION_BITS) + 0.5;
+}
+
+bool IsFixedPointSimdSupported() noexcept
+{
+    static const bool supported = DetectSsse3();
+    return supported;
+}
+
+void ThresholdAndDownsample(const ImageRGBA8& input, float threshold, ImageRGBA8& output, ThreadPool* pool)
+{
+    output.Resize(input.width / 2, input.height / 2);
+
+    const int32_t limit = ComputeThresholdLimit(threshold);
+    const bool simd = IsFixedPointSimdSupported();
+
+    ParallelFor(pool, 0, output.height, ROWS_PER_TASK, [&](size_t rowBegin, size_t rowEnd)
+    {
+        for (size_t row = rowBegin; row < rowEnd; ++row)
+        {
+            const uint32_t y = static_cast<uint32_t>(row);
+            const ColorRGBA8* row0 = input.Row(2 * y);
+            const ColorRGBA8* row1 = input.Row(2 * y + 1);
+            if (simd)
+            {
+                ThresholdAndDownsampleRowSsse3(row0, row1, static_cast<int>(output.width), limit, output.Row(y));
+            }
+            else
+            {
+                ThresholdAndDownsampleRow(row0, row1, static_cast<int>(output.width), limit, output.Row(y));
+            }
+        }
+    });
+}
+
+ColorRGBA8 ThresholdAndDownsamplePixel(const ImageRGBA8& input, float threshold, int x, int y) noexcept
+{
+    return ThresholdAndDownsampleBlock(input.Row(static_cast<uint32_t>(2 * y)), input.Row(static_cast<uint32_t>(2 * y + 1)),
+        ComputeThresholdLimit(threshold), x);
+}
+
+ColorRGBA8 BlurPixel(const ImageRGBA8& input, const FixedPointBlurParams& params, int direction, int x, int y) noexcept
+{
+    const int dx = 1 - direction;
+    const int dy = direction;
+
+    int accumulatedValue[4] = { };
+    for (int i = -params.radius; i <= params.radius; ++i)
+    {
+        const int coefficient = params.coefficients[i < 0 ? -i : i];
+        const ColorRGBA8 value = LoadOrZero(input, x + i * dx, y + i * dy);
+
+        accumulatedValue[0] += MultiplyRoundQ15(value.r << PIXEL_FRACTION_BITS, coefficient);
+        accumulatedValue[1] += MultiplyRoundQ15(value.g << PIXEL_FRACTION_BITS, coefficient);
+        accumulatedValue[2] += MultiplyRoundQ15(value.b << PIXEL_FRACTION_BITS, coefficient);
+        accumulatedValue[3] += MultiplyRoundQ15(value.a << PIXEL_FRACTION_BITS, coefficient);
+    }
+
+    return ColorRGBA8{ ToUnorm8(accumulatedValue[0]), ToUnorm8(accumulatedValue[1]), ToUnorm8(accumulatedValue[2]), ToUnorm8(accumulatedValue[3]) };
+}
+
+void Blur(const ImageRGBA8& input, const FixedPointBlurParams& params, int direction, ImageRGBA8& output, ThreadPool* pool)
+{
+    output.Resize(input.width, input.height);
+
+    const bool simd = IsFixedPointSimdSupported();
+
+    ParallelFor(pool, 0, output.height, ROWS_PER_TASK, [&](size_t rowBegin, size_t rowEnd)
+    {
+        for (size_t row = rowBegin; row < rowEnd; ++row)
+        {
+            const int y = static_cast<int>(row);
+            if (simd)
+            {
+                BlurRowSsse3(input, params, direction, y, output.Row(static_cast<uint32_t>(y)));
+            }
+            else
+            {
+                BlurRow(input, params, direction, y, output.Row(static_cast<uint32_t>(y)));
+            }
+        }
+    });
+}
+
+ColorRGBA8 CompositePixel(const ImageRGBA8& scene, const ImageRGBA8& bloom, float coefficient, uint32_t x, uint32_t y) noexcept
+{
+    if (bloom.width == 0 || bloom.height == 0)
+    {
+        return scene.At(x, y);
+    }
+
+    const CompositeRowSource source = ComputeCompositeRowSource(scene.height, bloom.height, y);
+    const CompositeColumn column = ComputeCompositeColumn(scene.width, bloom.width, x);
+    const int weight = ToFixedPoint(source.weight, Q15_ONE);
+
+    int16_t left[4];
+    int16_t right[4];
+    InterpolatePixel(bloom.At(column.x0, source.row0), bloom.At(column.x0, source.row1), weight, left);
+    InterpolatePixel(bloom.At(column.x1, source.row0), bloom.At(column.x1, source.row1), weight, right);
+    return CompositeBloomPixel(scene.At(x, y), left, right, column, ToFixedPoint(coefficient, Q13_ONE));
+}
+
+void Composite(const ImageRGBA8& scene, const ImageRGBA8& bloom, float coefficient, ImageRGBA8& output, ThreadPool* pool)
+{
+    output.Resize(scene.width, scene.height);
+    if (bloom.width == 0 || bloom.height == 0)
+    {
+        output.pixels = scene.pixels;
+        return;
+    }
+
+    std::vector<CompositeColumn> columns(scene.width);
+    for (uint32_t x = 0; x < scene.width; ++x)
+    {
+        columns[x] = ComputeCompositeColumn(scene.width, bloom.width, x);
+    }
+    const int fixedCoefficient = ToFixedPoint(coefficient, Q13_ONE);
+    const bool simd = IsFixedPointSimdSupported();
+
+    ParallelFor(pool, 0, output.height, ROWS_PER_TASK, [&](size_t rowBegin, size_t rowEnd)
+    {
+        // the bloom rows interpolated for the current output row
+        std::vector<int16_t> bloomRow(4 * static_cast<size_t>(bloom.width));
+        for (size_t row = rowBegin; row < rowEnd; ++row)
+        {
+            const uint32_t y = static_cast<uint32_t>(row);
+            const CompositeRowSource source = ComputeCompositeRowSource(scene.height, bloom.height, y);
+            const int weight = ToFixedPoint(source.weight, Q15_ONE);
+            if (simd)
+            {
+                InterpolateRowsSsse3(bloom.Row(source.row0), bloom.Row(source.row1), bloom.width, weight, bloomRow.data());
+                CompositeInterpolatedRowSsse3(scene.Row(y), scene.width, bloomRow.data(), columns.data(), fixedCoefficient, output.Row(y));
+            }
+            else
+            {
+                InterpolateRows(bloom.Row(source.row0), bloom.Row(source.row1), bloom.width, weight, bloomRow.data());
+                CompositeInterpolatedRow(scene.Row(y), scene.width, bloomRow.data(), columns.data(), fixedCoefficient, output.Row(y));
+            }
+        }
+    });
+}
+
+void ComputeBloom(const ImageRGBA8& scene, float threshold, const FixedPointBlurParams& params, BloomBuffersRGBA8& buffers, ThreadPool* pool)
+{
+    ThresholdAndDownsample(scene, threshold, buffers.bloom, pool);
+    Blur(buffers.bloom, params, 0, buffers.temp, pool);
+    Blur(buffers.temp, params, 1, buffers.bloom, pool);
+}
+
+void ApplyBloom(const ImageRGBA8& scene, float threshold, const FixedPointBlurParams& params, float coefficient, BloomBuffersRGBA8& buffers,
+    ImageRGBA8& output, ThreadPool* pool)
+{
+    ComputeBloom(scene, threshold, params, buffers, pool);
+    Composite(scene, buffers.bloom, coefficient, output, pool);
+}
@@ -0,0 +1,473 @@
+#include "cpu/framestream.h"
+
+#include "util/boundedqueue.h"
+#include "util/threadpool.h"
+#include "util/timer.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <istream>
+#include <limits>
+#include <ostream>
+#include <sstream>
+#include <thread>
+
+namespace
+{
+    // number of rows processed per task (pairs of rows for subsampled chroma)
+    constexpr size_t ROWS_PER_TASK = 16;
+
+    constexpr char Y4M_MAGIC[] = "YUV4MPEG2";
+    constexpr char Y4M_FRAME[] = "FRAME";
+
+    // BT.601
+    constexpr float KR = 0.299f;
+    constexpr float KB = 0.114f;
+    constexpr float KG = 1.f - KR - KB;
+
+    // scale and offset from the 8-bit code values to luma in [0, 1] and chroma in [-0.5, 0.5]
+    struct YuvRange
+    {
+        float lumaOffset;
+        float lumaScale;
+        float chromaScale;
+    };
+
+    YuvRange GetYuvRange(bool fullRange)
+    {
+        return fullRange ? YuvRange{ 0.f, 255.f, 255.f } : YuvRange{ 16.f, 219.f, 224.f };
+    }
+
+    // contributions of the 8-bit code values to R, G and B, so that decoding a pixel needs no divisions
+    struct YuvToRgbTable
+    {
+        float luma[256];
+        float crToR[256];
+        float cbToG[256];
+        float crToG[256];
+        float cbToB[256];
+
+        explicit YuvToRgbTable(const YuvRange& range)
+        {
+            for (int i = 0; i < 256; ++i)
+            {
+                const float chroma = (static_cast<float>(i) - 128.f) / range.chromaScale;
+                luma[i] = (static_cast<float>(i) - range.lumaOffset) / range.lumaScale;
+                crToR[i] = 2.f * (1.f - KR) * chroma;
+                cbToB[i] = 2.f * (1.f - KB) * chroma;
+                cbToG[i] = KB * cbToB[i] / KG;
+                crToG[i] = KR * crToR[i] / KG;
+            }
+        }
+
+        ColorRGBA32F Convert(uint8_t y, uint8_t u, uint8_t v) const noexcept
+        {
+            const float r = luma[y] + crToR[v];
+            const float g = luma[y] - cbToG[u] - crToG[v];
+            const float b = luma[y] + cbToB[u];
+            return ColorRGBA32F{ std::clamp(r, 0.f, 1.f), std::clamp(g, 0.f, 1.f), std::clamp(b, 0.f, 1.f), 1.f };
+        }
+    };
+
+    uint8_t ToCodeValue(float value)
+    {
+        return static_cast<uint8_t>(std::clamp(value, 0.f, 255.f) + 0.5f);
+    }
+
+    uint8_t EncodeLuma(const YuvRange& range, const ColorRGBA32F& c)
+    {
+        const float luma = KR * std::clamp(c.r, 0.f, 1.f) + KG * std::clamp(c.g, 0.f, 1.f) + KB * std::clamp(c.b, 0.f, 1.f);
+        return ToCodeValue(range.lumaOffset + range.lumaScale * luma);
+    }
+
+    // chroma of the given (average) color
+    void EncodeChroma(const YuvRange& range, float r, float g, float b, uint8_t& u, uint8_t& v)
+    {
+        const float luma = KR * r + KG * g + KB * b;
+        u = ToCodeValue(128.f + range.chromaScale * (b - luma) / (2.f * (1.f - KB)));
+        v = ToCodeValue(128.f + range.chromaScale * (r - luma) / (2.f * (1.f - KR)));
+    }
+
+    // width or height of a Y4M header, 0 if the value is not a number or too large
+    uint32_t ParseY4MSize(const std::string& value)
+    {
+        char* end = nullptr;
+        const unsigned long size = std::strtoul(value.c_str(), &end, 10);
+        if (value.empty() || *end != '\0' || size > MAX_FRAME_STREAM_SIZE)
+        {
+            return 0;
+        }
+        return static_cast<uint32_t>(size);
+    }
+}
+
+size_t FrameStreamHeader::GetFrameSize() const noexcept
+{
+    const size_t pixelCount = static_cast<size_t>(width) * height;
+    if (format == FrameStreamFormat::RawRGBA)
+    {
+        return 4 * pixelCount;
+    }
+    if (chromaSubsampled)
+    {
+        return pixelCount + 2 * static_cast<size_t>((width + 1) / 2) * ((height + 1) / 2);
+    }
+    return 3 * pixelCount;
+}
+
+bool ReadY4MHeader(std::istream& input, FrameStreamHeader& header)
+{
+    std::string line;
+    if (!std::getline(input, line))
+    {
+        return false;
+    }
+
+    header = FrameStreamHeader();
+    header.format = FrameStreamFormat::Y4M;
+    header.y4mHeader = line + "\n";
+
+    std::istringstream tokens(line);
+    std::string token;
+    if (!(tokens >> token) || token != Y4M_MAGIC)
+    {
+        return false;
+    }
+
+    while (tokens >> token)
+    {
+        const std::string value = token.substr(1);
+        switch (token[0])
+        {
+        case 'W':
+            header.width = ParseY4MSize(value);
+            break;
+        case 'H':
+            header.height = ParseY4MSize(value);
+            break;
+        case 'C':
+            // the chroma siting of the 4:2:0 variants is ignored, higher bit depths and mono are not supported
+            if (value == "420" || value == "420jpeg" || value == "420paldv" || value == "420mpeg2")
+            {
+                header.chromaSubsampled = true;
+            }
+            else if (value == "444")
+            {
+                header.chromaSubsampled = false;
+            }
+            else
+            {
+                return false;
+            }
+            break;
+        case 'I':
+            // only progressive frames are supported
+            if (value != "p" && value != "?")
+            {
+                return false;
+            }
+            break;
+        case 'X':
+            header.fullRange = header.fullRange || (value == "COLORRANGE=FULL");
+            break;
+        default:
+            break;
+        }
+    }
+
+    // 4:2:0 chroma needs even sizes (the C parameter may follow W and H)
+    const bool evenSize = (header.width % 2 == 0) && (header.height % 2 == 0);
+    return header.width >= 2 && header.height >= 2 && (evenSize || !header.chromaSubsampled);
+}
+
+bool ReadFrame(std::istream& input, const FrameStreamHeader& header, uint8_t* data)
+{
+    if (header.format == FrameStreamFormat::Y4M)
+    {
+        // FRAME followed by optional parameters up to the end of the line
+        char frameTag[sizeof(Y4M_FRAME) - 1];
+        if (!input.read(frameTag, sizeof(frameTag)) || std::memcmp(frameTag, Y4M_FRAME, sizeof(frameTag)) != 0)
+        {
+            return false;
+        }
+        input.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+    }
+
+    return static_cast<bool>(input.read(reinterpret_cast<char*>(data), static_cast<std::streamsize>(header.GetFrameSize())));
+}
+
+bool WriteFrameStreamHeader(std::ostream& output, const FrameStreamHeader& header)
+{
+    if (header.format == FrameStreamFormat::Y4M)
+    {
+        output.write(header.y4mHeader.data(), static_cast<std::streamsize>(header.y4mHeader.size()));
+    }
+    return static_cast<bool>(output);
+}
+
+bool WriteFrame(std::ostream& output, const FrameStreamHeader& header, const uint8_t* data)
+{
+    if (header.format == FrameStreamFormat::Y4M)
+    {
+        output.write(Y4M_FRAME, sizeof(Y4M_FRAME) - 1).put('\n');
+    }
+    return static_cast<bool>(output.write(reinterpret_cast<const char*>(data), static_cast<std::streamsize>(header.GetFrameSize())));
+}
+
+void DecodeFrame(const FrameStreamHeader& header, const uint8_t* data, ImageRGBA32F& image, ThreadPool* pool)
+{
+    image.Resize(header.width, header.height);
+
+    if (header.format == FrameStreamFormat::RawRGBA)
+    {
+        ParallelFor(pool, 0, image.height, ROWS_PER_TASK, [&](size_t rowBegin, size_t rowEnd)
+        {
+            constexpr float scale = 1.f / 255.f;
+            for (size_t y = rowBegin; y < rowEnd; ++y)
+            {
+                const uint8_t* source = data + 4 * y * image.width;
+                ColorRGBA32F* row = image.Row(static_cast<uint32_t>(y));
+                for (uint32_t x = 0; x < image.width; ++x)
+                {
+                    row[x] = ColorRGBA32F{ scale * source[4 * x], scale * source[4 * x + 1], scale * source[4 * x + 2], scale * source[4 * x + 3] };
+                }
+            }
+        });
+        return;
+    }
+
+    const YuvToRgbTable table(GetYuvRange(header.fullRange));
+    const uint32_t chromaShift = header.chromaSubsampled ? 1 : 0;
+    const size_t chromaWidth = (image.width + chromaShift) >> chromaShift;
+    const size_t chromaHeight = (image.height + chromaShift) >> chromaShift;
+    const uint8_t* planeY = data;
+    const uint8_t* planeU = planeY + static_cast<size_t>(image.width) * image.height;
+    const uint8_t* planeV = planeU + chromaWidth * chromaHeight;
+
+    ParallelFor(pool, 0, image.height, ROWS_PER_TASK, [&](size_t rowBegin, size_t rowEnd)
+    {
+        for (size_t y = rowBegin; y < rowEnd; ++y)
+        {
+            const uint8_t* rowY = planeY + y * image.width;
+            const uint8_t* rowU = planeU + (y >> chromaShift) * chromaWidth;
+            const uint8_t* rowV = planeV + (y >> chromaShift) * chromaWidth;
+            ColorRGBA32F* row = image.Row(static_cast<uint32_t>(y));
+            for (uint32_t x = 0; x < image.width; ++x)
+            {
+                row[x] = table.Convert(rowY[x], rowU[x >> chromaShift], rowV[x >> chromaShift]);
+            }
+        }
+    });
+}
+
+void EncodeFrame(const FrameStreamHeader& header, const ImageRGBA32F& image, uint8_t* data, ThreadPool* pool)
+{
+    if (header.format == FrameStreamFormat::RawRGBA)
+    {
+        // same rounding as ConvertImage()
+        ParallelFor(pool, 0, image.height, ROWS_PER_TASK, [&](size_t rowBegin, size_t rowEnd)
+        {
+            auto toUnorm = [](float value)
+            {
+                return static_cast<uint8_t>(std::clamp(value, 0.f, 1.f) * 255.f + 0.5f);
+            };
+
+            for (size_t y = rowBegin; y < rowEnd; ++y)
+            {
+                const ColorRGBA32F* row = image.Row(static_cast<uint32_t>(y));
+                uint8_t* target = data + 4 * y * image.width;
+                for (uint32_t x = 0; x < image.width; ++x)
+                {
+                    target[4 * x] = toUnorm(row[x].r);
+                    target[4 * x + 1] = toUnorm(row[x].g);
+                    target[4 * x + 2] = toUnorm(row[x].b);
+                    target[4 * x + 3] = toUnorm(row[x].a);
+                }
+            }
+        });
+        return;
+    }
+
+    const YuvRange range = GetYuvRange(header.fullRange);
+    const uint32_t chromaShift = header.chromaSubsampled ? 1 : 0;
+    const size_t chromaWidth = (image.width + chromaShift) >> chromaShift;
+    const size_t chromaHeight = (image.height + chromaShift) >> chromaShift;
+    uint8_t* planeY = data;
+    uint8_t* planeU = planeY + static_cast<size_t>(image.width) * image.height;
+    uint8_t* planeV = planeU + chromaWidth * chromaHeight;
+
+    // one task per chroma row, which covers one or two luma rows
+    ParallelFor(pool, 0, chromaHeight, ROWS_PER_TASK >> chromaShift, [&](size_t rowBegin, size_t rowEnd)
+    {
+        for (size_t chromaY = rowBegin; chromaY < rowEnd; ++chromaY)
+        {
+            const uint32_t y0 = static_cast<uint32_t>(chromaY << chromaShift);
+            const uint32_t y1 = std::min(y0 + chromaShift, image.height - 1);
+            const ColorRGBA32F* row0 = image.Row(y0);
+            const ColorRGBA32F* row1 = image.Row(y1);
+
+            for (uint32_t y = y0; y <= y1; ++y)
+            {
+                const ColorRGBA32F* row = image.Row(y);
+                uint8_t* rowY = planeY + static_cast<size_t>(y) * image.width;
+                for (uint32_t x = 0; x < image.width; ++x)
+                {
+                    rowY[x] = EncodeLuma(range, row[x]);
+                }
+            }
+
+            uint8_t* rowU = planeU + chromaY * chromaWidth;
+            uint8_t* rowV = planeV + chromaY * chromaWidth;
+            for (size_t chromaX = 0; chromaX < chromaWidth; ++chromaX)
+            {
+                const uint32_t x0 = static_cast<uint32_t>(chromaX << chromaShift);
+                const uint32_t x1 = std::min(x0 + chromaShift, image.width - 1);
+
+                // average over the (clamped) 2 x 2 block, duplicated pixels at odd sizes are counted twice
+                const ColorRGBA32F* block[4] = { &row0[x0], &row0[x1], &row1[x0], &row1[x1] };
+                float r = 0.f;
+                float g = 0.f;
+                float b = 0.f;
+                for (const ColorRGBA32F* c : block)
+                {
+                    r += std::clamp(c->r, 0.f, 1.f);
+                    g += std::clamp(c->g, 0.f, 1.f);
+                    b += std::clamp(c->b, 0.f, 1.f);
+                }
+                EncodeChroma(range, 0.25f * r, 0.25f * g, 0.25f * b, rowU[chromaX], rowV[chromaX]);
+            }
+        }
+    });
+}
+
+bool FrameStreamProcessor::Process(std::istream& input, std::ostream& output, const FrameStreamHeader& header, const BloomSettings& settings, ThreadPool* pool)
+{
+    m_stats = Stats{ };
+    if (header.width < 2 || header.height < 2 || !WriteFrameStreamHeader(output, header))
+    {
+        return false;
+    }
+
+    const bool success = Process(input, [&](const uint8_t* data) { return WriteFrame(output, header, data); }, header, settings, pool);
+    output.flush();
+    return success && static_cast<bool>(output);
+}
+
+bool FrameStreamProcessor::Process(std::istream& input, const FrameWriteFunction& writeFrame, const FrameStreamHeader& header,
+    const BloomSettings& settings, ThreadPool* pool)
+{
+    m_stats = Stats{ };
+    if (header.width < 2 || header.height < 2)
+    {
+        return false;
+    }
+
+    const size_t frameSize = header.GetFrameSize();
+    for (int i = 0; i < 2; ++i)
+    {
+        m_readBuffers[i].resize(frameSize);
+        m_writeBuffers[i].resize(frameSize);
+    }
+
+    // buffers are passed between the threads by index: free buffers go to the reader / compute thread, full ones
+    // to the compute / writer thread
+    BoundedQueue<int> freeReadBuffers(2);
+    BoundedQueue<int> fullReadBuffers(2);
+    BoundedQueue<int> freeWriteBuffers(2);
+    BoundedQueue<int> fullWriteBuffers(2);
+    for (int i = 0; i < 2; ++i)
+    {
+        freeReadBuffers.Push(i);
+        freeWriteBuffers.Push(i);
+    }
+
+    Timer totalTimer;
+    totalTimer.Start();
+
+    double readMilliseconds = 0.0;
+    double writeMilliseconds = 0.0;
+    bool writeFailed = false;
+
+    std::thread reader([&]()
+    {
+        int buffer;
+        while (freeReadBuffers.Pop(buffer))
+        {
+            Timer timer;
+            timer.Start();
+            const bool success = ReadFrame(input, header, m_readBuffers[buffer].data());
+            timer.Stop();
+            readMilliseconds += timer.GetElapsedTimeMilliseconds();
+
+            if (!success)
+            {
+                break;
+            }
+            fullReadBuffers.Push(buffer);
+        }
+        fullReadBuffers.Close();
+    });
+
+    std::thread writer([&]()
+    {
+        int buffer;
+        while (fullWriteBuffers.Pop(buffer))
+        {
+            Timer timer;
+            timer.Start();
+            const bool success = writeFrame(m_writeBuffers[buffer].data());
+            timer.Stop();
+            writeMilliseconds += timer.GetElapsedTimeMilliseconds();
+
+            if (!success)
+            {
+                // stops the compute thread, which in turn stops the reader
+                writeFailed = true;
+                freeWriteBuffers.Close();
+                break;
+            }
+            freeWriteBuffers.Push(buffer);
+        }
+    });
+
+    int readBuffer;
+    int writeBuffer;
+    while (fullReadBuffers.Pop(readBuffer))
+    {
+        Timer timer;
+        timer.Start();
+        DecodeFrame(header, m_readBuffers[readBuffer].data(), m_scene, pool);
+        freeReadBuffers.Push(readBuffer);
+
+        ApplyBloom(m_scene, settings, m_buffers, m_output, pool);
+        timer.Stop();
+        m_stats.computeMilliseconds += timer.GetElapsedTimeMilliseconds();
+
+        if (!freeWriteBuffers.Pop(writeBuffer))
+        {
+            break;
+        }
+
+        timer.Start();
+        EncodeFrame(header, m_output, m_writeBuffers[writeBuffer].data(), pool);
+        timer.Stop();
+        m_stats.computeMilliseconds += timer.GetElapsedTimeMilliseconds();
+
+        fullWriteBuffers.Push(writeBuffer);
+        ++m_stats.frames;
+    }
+
+    freeReadBuffers.Close();
+    fullWriteBuffers.Close();
+    reader.join();
+    writer.join();
+
+    totalTimer.Stop();
+    m_stats.milliseconds = totalTimer.GetElapsedTimeMilliseconds();
+    m_stats.framesPerSecond = (m_stats.milliseconds > 0.0) ? 1000.0 * m_stats.frames / m_stats.milliseconds : 0.0;
+    m_stats.readMilliseconds = readMilliseconds;
+    m_stats.writeMilliseconds = writeMilliseconds;
+
+    return !writeFailed;
+}
@@ -0,0 +1,62 @@
+#include "cpu/image.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <limits>
+
+ImageError ComputeImageError(const ImageRGBA32F& reference, const ImageRGBA32F& test)
+{
+    assert(reference.HasSize(test.width, test.height));
+
+    double squaredErrorSum = 0.0;
+    double maxError = 0.0;
+    for (size_t i = 0; i < reference.pixels.size(); ++i)
+    {
+        const ColorRGBA32F& a = reference.pixels[i];
+        const ColorRGBA32F& b = test.pixels[i];
+
+        const double diffs[3] = { static_cast<double>(a.r) - b.r, static_cast<double>(a.g) - b.g, static_cast<double>(a.b) - b.b };
+        for (double diff : diffs)
+        {
+            squaredErrorSum += diff * diff;
+            maxError = std::max(maxError, std::abs(diff));
+        }
+    }
+
+    ImageError error;
+    double mse = reference.pixels.empty() ? 0.0 : squaredErrorSum / (3.0 * reference.pixels.size());
+    error.rmse = std::sqrt(mse);
+    error.maxError = maxError;
+    error.psnr = (mse > 0.0) ? 10.0 * std::log10(1.0 / mse) : std::numeric_limits<double>::infinity();
+
+    return error;
+}
+
+void ConvertImage(const ImageRGBA32F& input, ImageRGBA8& output)
+{
+    output.Resize(input.width, input.height);
+
+    auto toUnorm = [](float value)
+    {
+        return static_cast<uint8_t>(std::clamp(value, 0.f, 1.f) * 255.f + 0.5f);
+    };
+
+    for (size_t i = 0; i < input.pixels.size(); ++i)
+    {
+        const ColorRGBA32F& value = input.pixels[i];
+        output.pixels[i] = ColorRGBA8{ toUnorm(value.r), toUnorm(value.g), toUnorm(value.b), toUnorm(value.a) };
+    }
+}
+
+void ConvertImage(const ImageRGBA8& input, ImageRGBA32F& output)
+{
+    output.Resize(input.width, input.height);
+
+    constexpr float scale = 1.f / 255.f;
+    for (size_t i = 0; i < input.pixels.size(); ++i)
+    {
+        const ColorRGBA8& value = input.pixels[i];
+        output.pixels[i] = ColorRGBA32F{ scale * value.r, scale * value.g, scale * value.b, scale * value.a };
+    }
+}
\ No newline at end of file
@@ -0,0 +1,311 @@
+#include "cpu/imagefile.h"
+
+#include "cpu/qoi.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+namespace
+{
+    enum class ImageFileFormat
+    {
+        Unknown,
+        Ppm,
+        Pam,
+        Raw,
+        Qoi
+    };
+
+    constexpr char RAW_IMAGE_MAGIC[4] = { 'R', 'G', 'B', 'A' };
+
+    // max. width and height of an image read from a file, so that a broken header does not lead to huge allocations
+    constexpr uint32_t MAX_IMAGE_SIZE = 1u << 16;
+
+    ImageFileFormat GetImageFileFormat(const std::string& path)
+    {
+        const size_t dot = path.find_last_of('.');
+        if (dot == std::string::npos)
+        {
+            return ImageFileFormat::Unknown;
+        }
+
+        std::string extension = path.substr(dot + 1);
+        std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+
+        if (extension == "ppm")
+        {
+            return ImageFileFormat::Ppm;
+        }
+        else if (extension == "pam")
+        {
+            return ImageFileFormat::Pam;
+        }
+        else if (extension == "rgba")
+        {
+            return ImageFileFormat::Raw;
+        }
+        else if (extension == "qoi")
+        {
+            return ImageFileFormat::Qoi;
+        }
+        return ImageFileFormat::Unknown;
+    }
+
+    // next whitespace separated token of a PNM header, comments (# to the end of the line) are skipped
+    std::string ReadHeaderToken(std::istream& stream)
+    {
+        std::string token;
+        int c = stream.get();
+        while (c != EOF)
+        {
+            if (c == '#')
+            {
+                while (c != EOF && c != '\n')
+                {
+                    c = stream.get();
+                }
+            }
+            else if (std::isspace(c))
+            {
+                if (!token.empty())
+                {
+                    break;
+                }
+            }
+            else
+            {
+                token.push_back(static_cast<char>(c));
+            }
+            c = stream.get();
+        }
+        return token;
+    }
+
+    uint32_t ParseHeaderValue(const std::string& token)
+    {
+        const unsigned long value = std::strtoul(token.c_str(), nullptr, 10);
+        return value <= MAX_IMAGE_SIZE ? static_cast<uint32_t>(value) : 0;
+    }
+
+    // true if the size is valid and the rest of the stream holds the pixels, checked before the image is allocated
+    bool HasPixelData(std::istream& stream, uint32_t width, uint32_t height, uint32_t channels)
+    {
+        if (width == 0 || height == 0 || width > MAX_IMAGE_SIZE || height > MAX_IMAGE_SIZE)
+        {
+            return false;
+        }
+
+        const std::istream::pos_type position = stream.tellg();
+        if (position == std::istream::pos_type(-1) || !stream.seekg(0, std::ios::end))
+        {
+            return false;
+        }
+        const std::istream::pos_type end = stream.tellg();
+        stream.seekg(position);
+
+        // at most 2^34 bytes, no overflow
+        const uint64_t size = static_cast<uint64_t>(width) * height * channels;
+        return stream && end != std::istream::pos_type(-1) && static_cast<uint64_t>(end - position) >= size;
+    }
+
+    // reads width * height pixels with the given number of channels (3 or 4)
+    bool ReadPixels(std::istream& stream, uint32_t channels, ImageRGBA8& image)
+    {
+        if (channels == 4)
+        {
+            return static_cast<bool>(stream.read(reinterpret_cast<char*>(image.pixels.data()), image.pixels.size() * sizeof(ColorRGBA8)));
+        }
+
+        std::vector<uint8_t> row(static_cast<size_t>(image.width) * 3);
+        for (uint32_t y = 0; y < image.height; ++y)
+        {
+            if (!stream.read(reinterpret_cast<char*>(row.data()), row.size()))
+            {
+                return false;
+            }
+
+            ColorRGBA8* pixels = image.Row(y);
+            for (uint32_t x = 0; x < image.width; ++x)
+            {
+                pixels[x] = ColorRGBA8{ row[3 * x], row[3 * x + 1], row[3 * x + 2], 255 };
+            }
+        }
+        return true;
+    }
+
+    bool ReadPpm(std::istream& stream, ImageRGBA8& image)
+    {
+        if (ReadHeaderToken(stream) != "P6")
+        {
+            return false;
+        }
+
+        // the single whitespace character after the max. value is consumed by ReadHeaderToken()
+        const uint32_t width = ParseHeaderValue(ReadHeaderToken(stream));
+        const uint32_t height = ParseHeaderValue(ReadHeaderToken(stream));
+        const uint32_t maxValue = ParseHeaderValue(ReadHeaderToken(stream));
+        if (maxValue != 255 || !HasPixelData(stream, width, height, 3))
+        {
+            return false;
+        }
+
+        image.Resize(width, height);
+        return ReadPixels(stream, 3, image);
+    }
+
+    bool ReadPam(std::istream& stream, ImageRGBA8& image)
+    {
+        if (ReadHeaderToken(stream) != "P7")
+        {
+            return false;
+        }
+
+        uint32_t width = 0;
+        uint32_t height = 0;
+        uint32_t depth = 0;
+        uint32_t maxValue = 0;
+        std::string tupleType;
+        for (std::string token = ReadHeaderToken(stream); token != "ENDHDR"; token = ReadHeaderToken(stream))
+        {
+            if (token.empty())
+            {
+                return false;
+            }
+            else if (token == "WIDTH")
+            {
+                width = ParseHeaderValue(ReadHeaderToken(stream));
+            }
+            else if (token == "HEIGHT")
+            {
+                height = ParseHeaderValue(ReadHeaderToken(stream));
+            }
+            else if (token == "DEPTH")
+            {
+                depth = ParseHeaderValue(ReadHeaderToken(stream));
+            }
+            else if (token == "MAXVAL")
+            {
+                maxValue = ParseHeaderValue(ReadHeaderToken(stream));
+            }
+            else if (token == "TUPLTYPE")
+            {
+                tupleType = ReadHeaderToken(stream);
+            }
+        }
+
+        const bool rgba = (tupleType == "RGB_ALPHA" && depth == 4);
+        const bool rgb = (tupleType == "RGB" && depth == 3);
+        if (maxValue != 255 || (!rgba && !rgb) || !HasPixelData(stream, width, height, depth))
+        {
+            return false;
+        }
+
+        image.Resize(width, height);
+        return ReadPixels(stream, depth, image);
+    }
+
+    bool ReadRaw(std::istream& stream, ImageRGBA8& image)
+    {
+        char magic[4];
+        uint32_t size[2];
+        if (!stream.read(magic, sizeof(magic)) || !stream.read(reinterpret_cast<char*>(size), sizeof(size)) ||
+            std::memcmp(magic, RAW_IMAGE_MAGIC, sizeof(magic)) != 0 || !HasPixelData(stream, size[0], size[1], 4))
+        {
+            return false;
+        }
+
+        image.Resize(size[0], size[1]);
+        return ReadPixels(stream, 4, image);
+    }
+
+    bool ReadQoi(std::istream& stream, ImageRGBA8& image)
+    {
+        const std::vector<char> data((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+        return DecodeQoi(reinterpret_cast<const uint8_t*>(data.data()), data.size(), image);
+    }
+}
+
+bool ReadImageFile(const std::string& path, ImageRGBA8& image)
+{
+    const ImageFileFormat format = GetImageFileFormat(path);
+    std::ifstream file(path, std::ios::binary);
+    if (!file)
+    {
+        return false;
+    }
+
+    switch (format)
+    {
+    case ImageFileFormat::Ppm:
+        return ReadPpm(file, image);
+    case ImageFileFormat::Pam:
+        return ReadPam(file, image);
+    case ImageFileFormat::Raw:
+        return ReadRaw(file, image);
+    case ImageFileFormat::Qoi:
+        return ReadQoi(file, image);
+    default:
+        return false;
+    }
+}
+
+bool WriteImageFile(const std::string& path, const ImageRGBA8& image)
+{
+    const ImageFileFormat format = GetImageFileFormat(path);
+    if (format == ImageFileFormat::Unknown)
+    {
+        return false;
+    }
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (format == ImageFileFormat::Ppm)
+    {
+        file << "P6\n" << image.width << " " << image.height << "\n255\n";
+
+        std::vector<uint8_t> row(static_cast<size_t>(image.width) * 3);
+        for (uint32_t y = 0; y < image.height && file; ++y)
+        {
+            const ColorRGBA8* pixels = image.Row(y);
+            for (uint32_t x = 0; x < image.width; ++x)
+            {
+                row[3 * x] = pixels[x].r;
+                row[3 * x + 1] = pixels[x].g;
+                row[3 * x + 2] = pixels[x].b;
+            }
+            file.write(reinterpret_cast<const char*>(row.data()), row.size());
+        }
+    }
+    else if (format == ImageFileFormat::Qoi)
+    {
+        std::vector<uint8_t> data;
+        QoiEncoder().Encode(image, data);
+        file.write(reinterpret_cast<const char*>(data.data()), data.size());
+    }
+    else
+    {
+        if (format == ImageFileFormat::Pam)
+        {
+            file << "P7\nWIDTH " << image.width << "\nHEIGHT " << image.height << "\nDEPTH 4\nMAXVAL 255\nTUPLTYPE RGB_ALPHA\nENDHDR\n";
+        }
+        else
+        {
+            const uint32_t size[2] = { image.width, image.height };
+            file.write(RAW_IMAGE_MAGIC, sizeof(RAW_IMAGE_MAGIC));
+            file.write(reinterpret_cast<const char*>(size), sizeof(size));
+        }
+        file.write(reinterpret_cast<const char*>(image.pixels.data()), image.pixels.size() * sizeof(ColorRGBA8));
+    }
+
+    file.close();
+    return !file.fail();
+}
+
+bool IsSupportedImageFile(const std::string& path)
+{
+    return GetImageFileFormat(path) != ImageFileFormat::Unknown;
+}
@@ -0,0 +1,185 @@
+#include "cpu/incrementalbloom.h"
+
+#include "util/hash.h"
+#include "util/threadpool.h"
+
+#include <algorithm>
+#include <atomic>
+
+IncrementalBloom::IncrementalBloom(uint32_t tileSize)
+    : m_tileSize(std::max(tileSize, 1u))
+    , m_tilesX(0)
+    , m_tilesY(0)
+    , m_settingsHash(0)
+    , m_hasHistory(false)
+    , m_stats{ }
+{
+}
+
+void IncrementalBloom::Reset() noexcept
+{
+    m_hasHistory = false;
+}
+
+uint32_t IncrementalBloom::DetectChangedTiles(const ImageRGBA32F& scene, ThreadPool* pool)
+{
+    std::atomic<uint32_t> changedCount{ 0 };
+
+    ParallelFor(pool, 0, static_cast<size_t>(m_tilesX) * m_tilesY, 4, [&](size_t tileBegin, size_t tileEnd)
+    {
+        for (size_t tile = tileBegin; tile < tileEnd; ++tile)
+        {
+            // scene region that the half-res tile is computed from
+            const uint32_t tileX = static_cast<uint32_t>(tile % m_tilesX);
+            const uint32_t tileY = static_cast<uint32_t>(tile / m_tilesX);
+            const uint32_t x0 = 2 * tileX * m_tileSize;
+            const uint32_t y0 = 2 * tileY * m_tileSize;
+            const uint32_t x1 = std::min(x0 + 2 * m_tileSize, scene.width);
+            const uint32_t y1 = std::min(y0 + 2 * m_tileSize, scene.height);
+
+            uint64_t hash = HASH_SEED;
+            for (uint32_t y = y0; y < y1; ++y)
+            {
+                hash = HashBytes(scene.Row(y) + x0, (x1 - x0) * sizeof(ColorRGBA32F), hash);
+            }
+
+            const bool changed = !m_hasHistory || hash != m_tileHashes[tile];
+            m_tileHashes[tile] = hash;
+            m_changedTiles[tile] = changed ? 1 : 0;
+            if (changed)
+            {
+                ++changedCount;
+            }
+        }
+    });
+
+    return changedCount.load();
+}
+
+std::vector<uint8_t> IncrementalBloom::DilateTiles(const std::vector<uint8_t>& mask, uint32_t dilationX, uint32_t dilationY) const
+{
+    std::vector<uint8_t> result(mask.size(), 0);
+
+    for (uint32_t tileY = 0; tileY < m_tilesY; ++tileY)
+    {
+        for (uint32_t tileX = 0; tileX < m_tilesX; ++tileX)
+        {
+            if (!mask[static_cast<size_t>(tileY) * m_tilesX + tileX])
+            {
+                continue;
+            }
+
+            const uint32_t xBegin = tileX - std::min(tileX, dilationX);
+            const uint32_t xEnd = std::min(tileX + dilationX + 1, m_tilesX);
+            const uint32_t yBegin = tileY - std::min(tileY, dilationY);
+            const uint32_t yEnd = std::min(tileY + dilationY + 1, m_tilesY);
+            for (uint32_t y = yBegin; y < yEnd; ++y)
+            {
+                std::fill(result.begin() + static_cast<size_t>(y) * m_tilesX + xBegin, result.begin() + static_cast<size_t>(y) * m_tilesX + xEnd, 1);
+            }
+        }
+    }
+
+    return result;
+}
+
+template <typename PixelFunc>
+uint32_t IncrementalBloom::ForEachTilePixel(const std::vector<uint8_t>& mask, ThreadPool* pool, const PixelFunc& func)
+{
+    std::vector<uint32_t> tiles;
+    for (uint32_t tile = 0; tile < mask.size(); ++tile)
+    {
+        if (mask[tile])
+        {
+            tiles.push_back(tile);
+        }
+    }
+
+    const uint32_t width = m_bloom.width;
+    const uint32_t height = m_bloom.height;
+    ParallelFor(pool, 0, tiles.size(), 1, [&](size_t begin, size_t end)
+    {
+        for (size_t i = begin; i < end; ++i)
+        {
+            const uint32_t x0 = (tiles[i] % m_tilesX) * m_tileSize;
+            const uint32_t y0 = (tiles[i] / m_tilesX) * m_tileSize;
+            const uint32_t x1 = std::min(x0 + m_tileSize, width);
+            const uint32_t y1 = std::min(y0 + m_tileSize, height);
+
+            for (uint32_t y = y0; y < y1; ++y)
+            {
+                for (uint32_t x = x0; x < x1; ++x)
+                {
+                    func(x, y);
+                }
+            }
+        }
+    });
+
+    return static_cast<uint32_t>(tiles.size());
+}
+
+const ImageRGBA32F& IncrementalBloom::Process(const ImageRGBA32F& scene, const BloomSettings& settings, ThreadPool* pool)
+{
+    const uint32_t width = scene.width / 2;
+    const uint32_t height = scene.height / 2;
+
+    if (!m_bloom.HasSize(width, height))
+    {
+        m_thresholded.Resize(width, height);
+        m_horizontal.Resize(width, height);
+        m_bloom.Resize(width, height);
+
+        m_tilesX = (width + m_tileSize - 1) / m_tileSize;
+        m_tilesY = (height + m_tileSize - 1) / m_tileSize;
+        m_tileHashes.assign(static_cast<size_t>(m_tilesX) * m_tilesY, 0);
+        m_changedTiles.assign(m_tileHashes.size(), 0);
+        m_hasHistory = false;
+    }
+
+    // a change of the settings invalidates everything (direction and size are not used by the CPU passes)
+    uint64_t settingsHash = HashValue(settings.threshold);
+    settingsHash = HashValue(settings.blurParams.coefficients, settingsHash);
+    settingsHash = HashValue(settings.blurParams.radius, settingsHash);
+    if (settingsHash != m_settingsHash)
+    {
+        m_settingsHash = settingsHash;
+        m_hasHistory = false;
+    }
+
+    m_stats = Stats{ };
+    m_stats.tilesTotal = m_tilesX * m_tilesY;
+    m_stats.tilesChanged = DetectChangedTiles(scene, pool);
+    m_hasHistory = true;
+
+    if (m_stats.tilesChanged == 0)
+    {
+        m_stats.frameSkipped = true;
+        return m_bloom;
+    }
+
+    // number of tiles covered by the blur radius (the apron)
+    const uint32_t apron = (static_cast<uint32_t>(std::max(settings.blurParams.radius, 0)) + m_tileSize - 1) / m_tileSize;
+    const std::vector<uint8_t> horizontalTiles = DilateTiles(m_changedTiles, apron, 0);
+    const std::vector<uint8_t> verticalTiles = DilateTiles(horizontalTiles, 0, apron);
+
+    // 1. threshold and downsample
+    m_stats.tilesThresholded = ForEachTilePixel(m_changedTiles, pool, [&](uint32_t x, uint32_t y)
+    {
+        m_thresholded.At(x, y) = ThresholdAndDownsamplePixel(scene, settings.threshold, static_cast<int>(x), static_cast<int>(y));
+    });
+
+    // 2. horizontal blur
+    m_stats.tilesBlurredHorizontal = ForEachTilePixel(horizontalTiles, pool, [&](uint32_t x, uint32_t y)
+    {
+        m_horizontal.At(x, y) = BlurPixel(m_thresholded, settings.blurParams, 0, static_cast<int>(x), static_cast<int>(y));
+    });
+
+    // 3. vertical blur
+    m_stats.tilesBlurredVertical = ForEachTilePixel(verticalTiles, pool, [&](uint32_t x, uint32_t y)
+    {
+        m_bloom.At(x, y) = BlurPixel(m_horizontal, settings.blurParams, 1, static_cast<int>(x), static_cast<int>(y));
+    });
+
+    return m_bloom;
+}
@@ -0,0 +1,173 @@
+#include "cpu/kernel.h"
+
+#include "util/threadpool.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    constexpr float PI = 3.14159265f;
+
+    // number of rows processed per task
+    constexpr size_t ROWS_PER_TASK = 4;
+}
+
+Kernel2D CreateGaussianKernel2D(const BlurParams& params)
+{
+    const uint32_t size = 2 * static_cast<uint32_t>(params.radius) + 1;
+
+    Kernel2D kernel;
+    kernel.Resize(size, size);
+    for (int j = -params.radius; j <= params.radius; ++j)
+    {
+        for (int i = -params.radius; i <= params.radius; ++i)
+        {
+            kernel.At(i + params.radius, j + params.radius) = params.coefficients[std::abs(i)] * params.coefficients[std::abs(j)];
+        }
+    }
+
+    return kernel;
+}
+
+Kernel2D CreateStarKernel(uint32_t radius, uint32_t rayCount)
+{
+    const uint32_t size = 2 * radius + 1;
+    const float r = static_cast<float>(std::max(radius, 1u));
+    const float coreSigma = std::max(0.05f * r, 0.75f);
+
+    Kernel2D kernel;
+    kernel.Resize(size, size);
+    for (uint32_t y = 0; y < size; ++y)
+    {
+        for (uint32_t x = 0; x < size; ++x)
+        {
+            const float dx = static_cast<float>(x) - static_cast<float>(radius);
+            const float dy = static_cast<float>(y) - static_cast<float>(radius);
+            const float distance = std::sqrt(dx * dx + dy * dy);
+
+            float weight = std::exp(-0.5f * distance * distance / (coreSigma * coreSigma));
+            if (distance <= r)
+            {
+                // distance of the pixel to the closest ray, rays are approx. one pixel wide
+                float angle = std::atan2(dy, dx);
+                float raySpacing = 2.f * PI / static_cast<float>(std::max(rayCount, 1u));
+                float angleToRay = std::fabs(std::remainder(angle, raySpacing));
+                float distanceToRay = distance * std::sin(std::min(angleToRay, 0.5f * PI));
+
+                float falloff = 1.f - distance / r;
+                weight += 0.1f * falloff * falloff * std::max(1.f - distanceToRay, 0.f);
+            }
+
+            // cut off the tail of the core so that the weights outside of the rays are exactly zero
+            kernel.At(x, y) = weight > 1e-4f ? weight : 0.f;
+        }
+    }
+
+    NormalizeKernel(kernel);
+    return kernel;
+}
+
+Kernel2D CreateStreakKernel(uint32_t radiusX, uint32_t radiusY, float angle)
+{
+    const float sigmaY = std::max(0.5f * static_cast<float>(radiusY), 0.5f);
+    const float cosAngle = std::cos(angle);
+    const float sinAngle = std::sin(angle);
+
+    // bounding box of the rotated streak
+    const float rx = static_cast<float>(radiusX);
+    const float ry = static_cast<float>(radiusY);
+    const uint32_t extentX = static_cast<uint32_t>(std::ceil(std::fabs(rx * cosAngle) + std::fabs(ry * sinAngle)));
+    const uint32_t extentY = static_cast<uint32_t>(std::ceil(std::fabs(rx * sinAngle) + std::fabs(ry * cosAngle)));
+
+    Kernel2D kernel;
+    kernel.Resize(2 * extentX + 1, 2 * extentY + 1);
+    for (uint32_t y = 0; y < kernel.height; ++y)
+    {
+        for (uint32_t x = 0; x < kernel.width; ++x)
+        {
+            // coordinates along and across the streak (y points down, so the rotation is counter-clockwise on screen)
+            const float dx = static_cast<float>(x) - static_cast<float>(extentX);
+            const float dy = static_cast<float>(y) - static_cast<float>(extentY);
+            const float u = dx * cosAngle - dy * sinAngle;
+            const float v = dx * sinAngle + dy * cosAngle;
+
+            // Gaussian across the streak and linear falloff towards its ends
+            const float weightV = std::exp(-0.5f * v * v / (sigmaY * sigmaY));
+            kernel.At(x, y) = weightV * std::max(1.f - std::fabs(u) / (rx + 1.f), 0.f);
+        }
+    }
+
+    NormalizeKernel(kernel);
+    return kernel;
+}
+
+void NormalizeKernel(Kernel2D& kernel)
+{
+    double sum = 0.0;
+    for (float weight : kernel.pixels)
+    {
+        sum += weight;
+    }
+
+    if (sum != 0.0)
+    {
+        const float scale = static_cast<float>(1.0 / sum);
+        for (float& weight : kernel.pixels)
+        {
+            weight *= scale;
+        }
+    }
+}
+
+void Convolve2D(const ImageRGBA32F& input, const Kernel2D& kernel, ImageRGBA32F& output, ThreadPool* pool)
+{
+    output.Resize(input.width, input.height);
+
+    const int width = static_cast<int>(input.width);
+    const int height = static_cast<int>(input.height);
+    const int centerX = static_cast<int>(kernel.width / 2);
+    const int centerY = static_cast<int>(kernel.height / 2);
+
+    ParallelFor(pool, 0, output.height, ROWS_PER_TASK, [&](size_t rowBegin, size_t rowEnd)
+    {
+        for (size_t row = rowBegin; row < rowEnd; ++row)
+        {
+            const int y = static_cast<int>(row);
+            ColorRGBA32F* outputRow = output.Row(static_cast<uint32_t>(y));
+            std::fill(outputRow, outputRow + width, ColorRGBA32F{ 0.f, 0.f, 0.f, 1.f });
+
+            for (int j = 0; j < static_cast<int>(kernel.height); ++j)
+            {
+                const int sourceY = y - (j - centerY);
+                if (sourceY < 0 || sourceY >= height)
+                {
+                    continue;
+                }
+
+                const ColorRGBA32F* inputRow = input.Row(static_cast<uint32_t>(sourceY));
+                const float* kernelRow = kernel.Row(static_cast<uint32_t>(j));
+                for (int i = 0; i < static_cast<int>(kernel.width); ++i)
+                {
+                    const float weight = kernelRow[i];
+                    if (weight == 0.f)
+                    {
+                        continue;
+                    }
+
+                    // output pixels x with a source pixel x - offset inside of the image
+                    const int offset = i - centerX;
+                    const int xBegin = std::max(offset, 0);
+                    const int xEnd = std::min(width + offset, width);
+                    for (int x = xBegin; x < xEnd; ++x)
+                    {
+                        const ColorRGBA32F& value = inputRow[x - offset];
+                        outputRow[x].r += weight * value.r;
+                        outputRow[x].g += weight * value.g;
+                        outputRow[x].b += weight * value.b;
+                    }
+                }
+            }
+        }
+    });
+}
@@ -0,0 +1,554 @@
+#include "cpu/occlusionculling.h"
+
+#include "util/threadpool.h"
+#include "util/timer.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include <immintrin.h>
+
+// see phong.cpp
+#if defined(__GNUC__)
+#define AVX2_FUNCTION __attribute__((target("avx2")))
+#else
+#define AVX2_FUNCTION
+#endif
+
+namespace
+{
+    constexpr uint32_t TILE_WIDTH = OcclusionCuller::TILE_WIDTH;
+    constexpr uint32_t TILE_HEIGHT = OcclusionCuller::TILE_HEIGHT;
+    constexpr uint32_t MAX_VIEWPORT_SIZE = 16384;
+    // number of occluder triangles set up and binned as one task, and number of boxes tested as one task
+    constexpr size_t CHUNK_TRIANGLES = 1024;
+    constexpr size_t CHUNK_BOXES = 256;
+
+    // edge functions and bounding box of a triangle, see OcclusionCuller::Triangle
+    struct Edges
+    {
+        const float* a;
+        const float* b;
+        const float* c;
+        float minX, minY, maxX, maxY;
+    };
+
+    /**
+     * Covered pixel range [first[i], last[i]] of the pixel rows rowY + i of a tile row (empty if last[i] < first[i]).
+     *
+     * Notes:
+     * - a pixel is covered if its center lies inside all edges and the bounding box
+     * - the ranges are clamped to the bounding box, so they lie inside the viewport
+     */
+    void ComputeSpans(const Edges& edges, uint32_t rowY, int32_t first[TILE_HEIGHT], int32_t last[TILE_HEIGHT]) noexcept
+    {
+        for (uint32_t i = 0; i < TILE_HEIGHT; ++i)
+        {
+            const float y = static_cast<float>(rowY + i) + 0.5f;
+            float left = edges.minX;
+            float right = edges.maxX;
+            bool empty = y < edges.minY || y > edges.maxY;
+            for (int e = 0; e < 3; ++e)
+            {
+                // x where the edge function of the row is 0
+                const float value = edges.b[e] * y + edges.c[e];
+                if (edges.a[e] > 0.f)
+                {
+                    left = std::max(left, -value / edges.a[e]);
+                }
+                else if (edges.a[e] < 0.f)
+                {
+                    right = std::min(right, -value / edges.a[e]);
+                }
+                else
+                {
+                    empty = empty || value < 0.f;
+                }
+            }
+            // an edge can be almost horizontal, so the bounds are clamped before they are converted
+            first[i] = static_cast<int32_t>(std::ceil(std::min(left, edges.maxX) - 0.5f));
+            last[i] = empty ? -1 : static_cast<int32_t>(std::floor(std::max(right, edges.minX - 1.f) - 0.5f));
+        }
+    }
+
+    AVX2_FUNCTION void ComputeSpansAvx2(const Edges& edges, uint32_t rowY, int32_t first[TILE_HEIGHT], int32_t last[TILE_HEIGHT]) noexcept
+    {
+        const __m256 y = _mm256_add_ps(_mm256_set1_ps(static_cast<float>(rowY) + 0.5f), _mm256_setr_ps(0.f, 1.f, 2.f, 3.f, 4.f, 5.f, 6.f, 7.f));
+        __m256 left = _mm256_set1_ps(edges.minX);
+        __m256 right = _mm256_set1_ps(edges.maxX);
+        __m256 empty = _mm256_or_ps(_mm256_cmp_ps(y, _mm256_set1_ps(edges.minY), _CMP_LT_OQ), _mm256_cmp_ps(y, _mm256_set1_ps(edges.maxY), _CMP_GT_OQ));
+        for (int e = 0; e < 3; ++e)
+        {
+            const __m256 value = _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(edges.b[e]), y), _mm256_set1_ps(edges.c[e]));
+            if (edges.a[e] > 0.f)
+            {
+                left = _mm256_max_ps(left, _mm256_div_ps(_mm256_sub_ps(_mm256_setzero_ps(), value), _mm256_set1_ps(edges.a[e])));
+            }
+            else if (edges.a[e] < 0.f)
+            {
+                right = _mm256_min_ps(right, _mm256_div_ps(_mm256_sub_ps(_mm256_setzero_ps(), value), _mm256_set1_ps(edges.a[e])));
+            }
+            else
+            {
+                empty = _mm256_or_ps(empty, _mm256_cmp_ps(value, _mm256_setzero_ps(), _CMP_LT_OQ));
+            }
+        }
+        left = _mm256_min_ps(left, _mm256_set1_ps(edges.maxX));
+        right = _mm256_max_ps(right, _mm256_set1_ps(edges.minX - 1.f));
+        const __m256 half = _mm256_set1_ps(0.5f);
+        const __m256i firstPixel = _mm256_cvttps_epi32(_mm256_round_ps(_mm256_sub_ps(left, half), _MM_FROUND_TO_POS_INF | _MM_FROUND_NO_EXC));
+        const __m256i lastPixel = _mm256_cvttps_epi32(_mm256_round_ps(_mm256_sub_ps(right, half), _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(first), firstPixel);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(last), _mm256_blendv_epi8(lastPixel, _mm256_set1_epi32(-1), _mm256_castps_si256(empty)));
+    }
+
+    /**
+     * Merges the coverage of a triangle with max. depth z in a tile (the spans of its rows, shifted by tileX) into the
+     * mask and depths of the tile. The pixels in outside (beyond the viewport) count as covered for a full mask.
+     */
+    void MergeCoverage(const int32_t first[TILE_HEIGHT], const int32_t last[TILE_HEIGHT], int32_t tileX, float z,
+        const uint32_t outside[TILE_HEIGHT], uint32_t mask[TILE_HEIGHT], float& z0, float& z1) noexcept
+    {
+        if (z >= z0)
+        {
+            return;
+        }
+
+        uint32_t coverage[TILE_HEIGHT];
+        uint32_t any = 0;
+        for (uint32_t i = 0; i < TILE_HEIGHT; ++i)
+        {
+            const int32_t begin = std::max(first[i] - tileX, 0);
+            const int32_t end = std::min(last[i] - tileX, 31);
+            coverage[i] = (begin <= end) ? ((~0u >> (31 - end)) & (~0u << begin)) : 0u;
+            any |= coverage[i];
+        }
+        if (any == 0)
+        {
+            return;
+        }
+
+        // discard the pixels in the mask if the triangle is closer to z0 than to their depth (quick update heuristic of
+        // the paper), so that a distant occluder does not pull their depth far back
+        if (z - z1 > z0 - z1)
+        {
+            std::fill(mask, mask + TILE_HEIGHT, 0u);
+            z1 = 0.f;
+        }
+        uint32_t full = ~0u;
+        for (uint32_t i = 0; i < TILE_HEIGHT; ++i)
+        {
+            mask[i] |= coverage[i];
+            full &= mask[i] | outside[i];
+        }
+        z1 = std::max(z1, z);
+        if (full == ~0u)
+        {
+            z0 = z1;
+            z1 = 0.f;
+            std::fill(mask, mask + TILE_HEIGHT, 0u);
+        }
+    }
+
+    AVX2_FUNCTION void MergeCoverageAvx2(const int32_t first[TILE_HEIGHT], const int32_t last[TILE_HEIGHT], int32_t tileX, float z,
+        const uint32_t outside[TILE_HEIGHT], uint32_t mask[TILE_HEIGHT], float& z0, float& z1) noexcept
+    {
+        if (z >= z0)
+        {
+            return;
+        }
+
+        // shifts by 32 or more bits give 0
+        const __m256i ones = _mm256_set1_epi32(-1);
+        const __m256i offset = _mm256_set1_epi32(tileX);
+        const __m256i begin = _mm256_max_epi32(_mm256_sub_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(first)), offset), _mm256_setzero_si256());
+        const __m256i end = _mm256_sub_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(last)), offset);
+        const __m256i rightShift = _mm256_max_epi32(_mm256_sub_epi32(_mm256_set1_epi32(31), end), _mm256_setzero_si256());
+        const __m256i coverage = _mm256_and_si256(_mm256_sllv_epi32(ones, begin), _mm256_srlv_epi32(ones, rightShift));
+        if (_mm256_testz_si256(coverage, coverage))
+        {
+            return;
+        }
+
+        __m256i tileMask = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(mask));
+        if (z - z1 > z0 - z1)
+        {
+            tileMask = _mm256_setzero_si256();
+            z1 = 0.f;
+        }
+        tileMask = _mm256_or_si256(tileMask, coverage);
+        z1 = std::max(z1, z);
+        if (_mm256_testc_si256(_mm256_or_si256(tileMask, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(outside))), ones))
+        {
+            z0 = z1;
+            z1 = 0.f;
+            tileMask = _mm256_setzero_si256();
+        }
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(mask), tileMask);
+    }
+
+    // true if the pixels [x0, x1] of the rows [y0, y1] of a tile (relative to the tile) are all in the mask
+    bool IsRectInsideMask(const uint32_t mask[TILE_HEIGHT], uint32_t x0, uint32_t x1, uint32_t y0, uint32_t y1) noexcept
+    {
+        const uint32_t columns = (~0u >> (31 - x1)) & (~0u << x0);
+        for (uint32_t i = y0; i <= y1; ++i)
+        {
+            if ((columns & ~mask[i]) != 0)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    AVX2_FUNCTION bool IsRectInsideMaskAvx2(const uint32_t mask[TILE_HEIGHT], uint32_t x0, uint32_t x1, uint32_t y0, uint32_t y1) noexcept
+    {
+        const __m256i row = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+        const __m256i rows = _mm256_andnot_si256(_mm256_or_si256(_mm256_cmpgt_epi32(_mm256_set1_epi32(static_cast<int32_t>(y0)), row),
+            _mm256_cmpgt_epi32(row, _mm256_set1_epi32(static_cast<int32_t>(y1)))), _mm256_set1_epi32(-1));
+        const __m256i rect = _mm256_and_si256(rows, _mm256_set1_epi32(static_cast<int32_t>((~0u >> (31 - x1)) & (~0u << x0))));
+        return _mm256_testc_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(mask)), rect) != 0;
+    }
+
+    // clip space position of a model space point
+    void Transform(const Matrix4x4& matrix, float x, float y, float z, float clip[4]) noexcept
+    {
+        for (int i = 0; i < 4; ++i)
+        {
+            clip[i] = matrix.m[i][0] * x + matrix.m[i][1] * y + matrix.m[i][2] * z + matrix.m[i][3];
+        }
+    }
+
+    // bit i is set if point i is outside of the clip plane, for 8 points at most
+    uint32_t OutsideClipPlanes(const float (*clip)[4], int count, uint32_t& outsideAll) noexcept
+    {
+        // x, y in [-w, w] and z in [0, w]
+        outsideAll = 0x3f;
+        uint32_t outsideAny = 0;
+        for (int i = 0; i < count; ++i)
+        {
+            const float* p = clip[i];
+            const uint32_t outside = (p[0] < -p[3] ? 0x01u : 0u) | (p[0] > p[3] ? 0x02u : 0u) | (p[1] < -p[3] ? 0x04u : 0u) |
+                (p[1] > p[3] ? 0x08u : 0u) | (p[2] < 0.f ? 0x10u : 0u) | (p[2] > p[3] ? 0x20u : 0u);
+            outsideAll &= outside;
+            outsideAny |= outside;
+        }
+        return outsideAny;
+    }
+}
+
+void OcclusionCuller::RenderOccluders(const std::vector<VertexPosNormal>& occluders, const Matrix4x4& modelViewProj, uint32_t width, uint32_t height,
+    ThreadPool* pool)
+{
+    m_stats = Stats{ };
+    m_width = std::min(width, MAX_VIEWPORT_SIZE);
+    m_height = std::min(height, MAX_VIEWPORT_SIZE);
+    m_tilesX = (m_width + TILE_WIDTH - 1) / TILE_WIDTH;
+    m_tilesY = (m_height + TILE_HEIGHT - 1) / TILE_HEIGHT;
+    m_tiles.resize(static_cast<size_t>(m_tilesX) * m_tilesY);
+
+    Timer timer;
+    timer.Start();
+
+    const size_t triangleCount = occluders.size() / 3;
+    const size_t chunkCount = (triangleCount + CHUNK_TRIANGLES - 1) / CHUNK_TRIANGLES;
+    m_chunks.resize(chunkCount);
+    ParallelFor(pool, 0, chunkCount, 1, [&](size_t chunkBegin, size_t chunkEnd)
+    {
+        for (size_t chunk = chunkBegin; chunk < chunkEnd; ++chunk)
+        {
+            SetUpChunk(occluders, modelViewProj, chunk);
+        }
+    });
+
+    // the tiles are cleared by the rasterization of their row
+    ParallelFor(pool, 0, m_tilesY, 1, [&](size_t rowBegin, size_t rowEnd)
+    {
+        for (size_t row = rowBegin; row < rowEnd; ++row)
+        {
+            RasterizeTileRow(static_cast<uint32_t>(row));
+        }
+    });
+
+    timer.Stop();
+    m_stats.rasterMilliseconds = timer.GetElapsedTimeMilliseconds();
+
+    m_stats.occluderTriangles = triangleCount;
+    for (const Chunk& chunk : m_chunks)
+    {
+        m_stats.occluderTrianglesCulled += chunk.trianglesCulled;
+    }
+}
+
+void OcclusionCuller::SetUpChunk(const std::vector<VertexPosNormal>& occluders, const Matrix4x4& modelViewProj, size_t chunkIndex)
+{
+    Chunk& chunk = m_chunks[chunkIndex];
+    chunk.triangles.clear();
+    chunk.bins.resize(m_tilesY);
+    for (std::vector<uint32_t>& bin : chunk.bins)
+    {
+        bin.clear();
+    }
+    chunk.trianglesCulled = 0;
+
+    const float width = static_cast<float>(m_width);
+    const float height = static_cast<float>(m_height);
+    const size_t first = chunkIndex * CHUNK_TRIANGLES;
+    const size_t last = std::min(first + CHUNK_TRIANGLES, occluders.size() / 3);
+    for (size_t t = first; t < last; ++t)
+    {
+        float clip[3][4];
+        for (int i = 0; i < 3; ++i)
+        {
+            const VertexPosNormal& vertex = occluders[3 * t + i];
+            Transform(modelViewProj, vertex.x, vertex.y, vertex.z, clip[i]);
+        }
+
+        // triangles outside of a clip plane are culled, the ones crossing the near plane are skipped (they would need clipping)
+        uint32_t outsideAll = 0;
+        if ((OutsideClipPlanes(clip, 3, outsideAll) & 0x10) != 0 || outsideAll != 0)
+        {
+            ++chunk.trianglesCulled;
+            continue;
+        }
+
+        // viewport transform of D3D11 (y down), depth in [0, 1]
+        float x[3];
+        float y[3];
+        float z[3];
+        for (int i = 0; i < 3; ++i)
+        {
+            const float invW = 1.f / clip[i][3];
+            x[i] = (0.5f + 0.5f * clip[i][0] * invW) * width;
+            y[i] = (0.5f - 0.5f * clip[i][1] * invW) * height;
+            z[i] = clip[i][2] * invW;
+        }
+
+        // clockwise triangles (on screen, y down) have a positive area and are front faces, back faces are culled
+        const float area = (x[1] - x[0]) * (y[2] - y[0]) - (x[2] - x[0]) * (y[1] - y[0]);
+        Triangle triangle;
+        triangle.minX = std::max(std::min({ x[0], x[1], x[2] }), 0.f);
+        triangle.minY = std::max(std::min({ y[0], y[1], y[2] }), 0.f);
+        triangle.maxX = std::min(std::max({ x[0], x[1], x[2] }), width);
+        triangle.maxY = std::min(std::max({ y[0], y[1], y[2] }), height);
+        // rows of pixel centers covered by the bounding box
+        const int32_t firstRow = static_cast<int32_t>(std::ceil(triangle.minY - 0.5f));
+        const int32_t lastRow = std::min(static_cast<int32_t>(std::floor(triangle.maxY - 0.5f)), static_cast<int32_t>(m_height) - 1);
+        if (!(area > 0.f) || triangle.minX >= triangle.maxX || firstRow > lastRow)
+        {
+            ++chunk.trianglesCulled;
+            continue;
+        }
+
+        for (int e = 0; e < 3; ++e)
+        {
+            const int i = e;
+            const int j = (e + 1) % 3;
+            triangle.edgeA[e] = y[i] - y[j];
+            triangle.edgeB[e] = x[j] - x[i];
+            triangle.edgeC[e] = -(triangle.edgeA[e] * x[i] + triangle.edgeB[e] * y[i]);
+        }
+        triangle.depthA = ((z[1] - z[0]) * (y[2] - y[0]) - (z[2] - z[0]) * (y[1] - y[0])) / area;
+        triangle.depthB = ((x[1] - x[0]) * (z[2] - z[0]) - (x[2] - x[0]) * (z[1] - z[0])) / area;
+        triangle.depthC = z[0] - triangle.depthA * x[0] - triangle.depthB * y[0];
+        triangle.maxZ = std::min(std::max({ z[0], z[1], z[2] }), 1.f);
+
+        const uint32_t index = static_cast<uint32_t>(chunk.triangles.size());
+        chunk.triangles.push_back(triangle);
+        for (int32_t row = firstRow / static_cast<int32_t>(TILE_HEIGHT); row <= lastRow / static_cast<int32_t>(TILE_HEIGHT); ++row)
+        {
+            chunk.bins[row].push_back(index);
+        }
+    }
+}
+
+void OcclusionCuller::RasterizeTileRow(uint32_t tileRow)
+{
+    Tile* tiles = &m_tiles[static_cast<size_t>(tileRow) * m_tilesX];
+    for (uint32_t tileX = 0; tileX < m_tilesX; ++tileX)
+    {
+        std::fill(tiles[tileX].mask, tiles[tileX].mask + TILE_HEIGHT, 0u);
+        tiles[tileX].z0 = 1.f;
+        tiles[tileX].z1 = 0.f;
+    }
+
+    // pixels beyond the viewport in the tiles of the row, and additionally in the last tile of the row
+    const uint32_t rowY = tileRow * TILE_HEIGHT;
+    const uint32_t lastTileColumns = m_width - (m_tilesX - 1) * TILE_WIDTH;
+    uint32_t outside[TILE_HEIGHT];
+    uint32_t outsideLastTile[TILE_HEIGHT];
+    for (uint32_t i = 0; i < TILE_HEIGHT; ++i)
+    {
+        outside[i] = (rowY + i < m_height) ? 0u : ~0u;
+        outsideLastTile[i] = outside[i] | ((lastTileColumns < TILE_WIDTH) ? (~0u << lastTileColumns) : 0u);
+    }
+
+    const bool avx2 = IsAvx2Supported();
+    const float tileMinY = static_cast<float>(rowY);
+    const float tileMaxY = static_cast<float>(rowY + TILE_HEIGHT);
+    for (const Chunk& chunk : m_chunks)
+    {
+        for (uint32_t index : chunk.bins[tileRow])
+        {
+            const Triangle& triangle = chunk.triangles[index];
+            const Edges edges = { triangle.edgeA, triangle.edgeB, triangle.edgeC, triangle.minX, triangle.minY, triangle.maxX, triangle.maxY };
+            int32_t first[TILE_HEIGHT];
+            int32_t last[TILE_HEIGHT];
+            if (avx2)
+            {
+                ComputeSpansAvx2(edges, rowY, first, last);
+            }
+            else
+            {
+                ComputeSpans(edges, rowY, first, last);
+            }
+
+            int32_t minFirst = INT32_MAX;
+            int32_t maxLast = -1;
+            for (uint32_t i = 0; i < TILE_HEIGHT; ++i)
+            {
+                if (first[i] <= last[i])
+                {
+                    minFirst = std::min(minFirst, first[i]);
+                    maxLast = std::max(maxLast, last[i]);
+                }
+            }
+            if (maxLast < 0)
+            {
+                continue;
+            }
+
+            // max. depth of the plane in the part of the bounding box inside the tile row, and in each tile
+            const float y = (triangle.depthB > 0.f) ? std::min(tileMaxY, triangle.maxY) : std::max(tileMinY, triangle.minY);
+            for (uint32_t tileX = static_cast<uint32_t>(minFirst) / TILE_WIDTH; tileX <= static_cast<uint32_t>(maxLast) / TILE_WIDTH; ++tileX)
+            {
+                const float x = (triangle.depthA > 0.f) ? std::min(static_cast<float>((tileX + 1) * TILE_WIDTH), triangle.maxX) :
+                    std::max(static_cast<float>(tileX * TILE_WIDTH), triangle.minX);
+                const float z = std::min(triangle.depthA * x + triangle.depthB * y + triangle.depthC, triangle.maxZ);
+                Tile& tile = tiles[tileX];
+                const uint32_t* tileOutside = (tileX + 1 == m_tilesX) ? outsideLastTile : outside;
+                if (avx2)
+                {
+                    MergeCoverageAvx2(first, last, static_cast<int32_t>(tileX * TILE_WIDTH), z, tileOutside, tile.mask, tile.z0, tile.z1);
+                }
+                else
+                {
+                    MergeCoverage(first, last, static_cast<int32_t>(tileX * TILE_WIDTH), z, tileOutside, tile.mask, tile.z0, tile.z1);
+                }
+            }
+        }
+    }
+}
+
+void OcclusionCuller::TestBoxes(const std::vector<BoundingBox>& boxes, const Matrix4x4& modelViewProj, std::vector<uint8_t>& visible, ThreadPool* pool)
+{
+    Timer timer;
+    timer.Start();
+
+    visible.resize(boxes.size());
+    const size_t chunkCount = (boxes.size() + CHUNK_BOXES - 1) / CHUNK_BOXES;
+    std::vector<size_t> outsideFrustum(chunkCount, 0);
+    ParallelFor(pool, 0, chunkCount, 1, [&](size_t chunkBegin, size_t chunkEnd)
+    {
+        for (size_t chunk = chunkBegin; chunk < chunkEnd; ++chunk)
+        {
+            for (size_t i = chunk * CHUNK_BOXES; i < std::min((chunk + 1) * CHUNK_BOXES, boxes.size()); ++i)
+            {
+                bool outside = false;
+                visible[i] = IsBoxVisible(boxes[i], modelViewProj, outside) ? 1 : 0;
+                outsideFrustum[chunk] += outside ? 1 : 0;
+            }
+        }
+    });
+
+    timer.Stop();
+    m_stats.testMilliseconds = timer.GetElapsedTimeMilliseconds();
+
+    m_stats.boxesTested = boxes.size();
+    m_stats.boxesOutsideFrustum = 0;
+    for (size_t count : outsideFrustum)
+    {
+        m_stats.boxesOutsideFrustum += count;
+    }
+    m_stats.boxesOccluded = static_cast<size_t>(std::count(visible.begin(), visible.end(), 0)) - m_stats.boxesOutsideFrustum;
+}
+
+bool OcclusionCuller::IsBoxVisible(const BoundingBox& box, const Matrix4x4& modelViewProj, bool& outsideFrustum) const noexcept
+{
+    float clip[8][4];
+    for (int i = 0; i < 8; ++i)
+    {
+        Transform(modelViewProj, (i & 1) ? box.max[0] : box.min[0], (i & 2) ? box.max[1] : box.min[1], (i & 4) ? box.max[2] : box.min[2], clip[i]);
+    }
+
+    // outside if all corners are outside of one clip plane, conservatively visible if it crosses the near plane
+    uint32_t outsideAll = 0;
+    const uint32_t outsideAny = OutsideClipPlanes(clip, 8, outsideAll);
+    outsideFrustum = outsideAll != 0;
+    if (outsideFrustum)
+    {
+        return false;
+    }
+    if ((outsideAny & 0x10) != 0)
+    {
+        return true;
+    }
+
+    // all pixels touched by the screen rectangle of the corners, and the depth of the nearest corner
+    float minX = static_cast<float>(m_width);
+    float minY = static_cast<float>(m_height);
+    float maxX = 0.f;
+    float maxY = 0.f;
+    float minZ = 1.f;
+    for (int i = 0; i < 8; ++i)
+    {
+        const float invW = 1.f / clip[i][3];
+        const float x = (0.5f + 0.5f * clip[i][0] * invW) * static_cast<float>(m_width);
+        const float y = (0.5f - 0.5f * clip[i][1] * invW) * static_cast<float>(m_height);
+        minX = std::min(minX, x);
+        minY = std::min(minY, y);
+        maxX = std::max(maxX, x);
+        maxY = std::max(maxY, y);
+        minZ = std::min(minZ, clip[i][2] * invW);
+    }
+    const int32_t x0 = std::max(static_cast<int32_t>(std::floor(minX)), 0);
+    const int32_t y0 = std::max(static_cast<int32_t>(std::floor(minY)), 0);
+    const int32_t x1 = std::min(static_cast<int32_t>(std::ceil(maxX)), static_cast<int32_t>(m_width)) - 1;
+    const int32_t y1 = std::min(static_cast<int32_t>(std::ceil(maxY)), static_cast<int32_t>(m_height)) - 1;
+    if (x0 > x1 || y0 > y1)
+    {
+        outsideFrustum = true;
+        return false;
+    }
+
+    const bool avx2 = IsAvx2Supported();
+    for (uint32_t tileY = static_cast<uint32_t>(y0) / TILE_HEIGHT; tileY <= static_cast<uint32_t>(y1) / TILE_HEIGHT; ++tileY)
+    {
+        const uint32_t rowY = tileY * TILE_HEIGHT;
+        const uint32_t firstRow = std::max(static_cast<uint32_t>(y0), rowY) - rowY;
+        const uint32_t lastRow = std::min(static_cast<uint32_t>(y1), rowY + TILE_HEIGHT - 1) - rowY;
+        for (uint32_t tileX = static_cast<uint32_t>(x0) / TILE_WIDTH; tileX <= static_cast<uint32_t>(x1) / TILE_WIDTH; ++tileX)
+        {
+            const Tile& tile = m_tiles[static_cast<size_t>(tileY) * m_tilesX + tileX];
+            if (minZ >= tile.z0)
+            {
+                continue;
+            }
+            if (minZ < tile.z1)
+            {
+                return true;
+            }
+
+            const uint32_t columnX = tileX * TILE_WIDTH;
+            const uint32_t firstColumn = std::max(static_cast<uint32_t>(x0), columnX) - columnX;
+            const uint32_t lastColumn = std::min(static_cast<uint32_t>(x1), columnX + TILE_WIDTH - 1) - columnX;
+            const bool inside = avx2 ? IsRectInsideMaskAvx2(tile.mask, firstColumn, lastColumn, firstRow, lastRow) :
+                IsRectInsideMask(tile.mask, firstColumn, lastColumn, firstRow, lastRow);
+            if (!inside)
+            {
+                return true;
+            }
+        }
+    }
+    return false;
+}
@@ -0,0 +1,405 @@
+#include "cpu/phong.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+// MSVC compiles AVX2 intrinsics without additional flags, GCC and Clang need the target for each function using them
+#if defined(__GNUC__)
+#define AVX2_FUNCTION __attribute__((target("avx2")))
+#else
+#define AVX2_FUNCTION
+#endif
+
+namespace
+{
+    // same values as UpdateTick(): approx. 10 seconds for one full rotation
+    constexpr float MILLISECONDS_TO_ANGLE = 0.0001f * 6.28f;
+    constexpr float FIELD_OF_VIEW = 1.5f;
+    constexpr float NEAR_PLANE = 0.01f;
+    constexpr float FAR_PLANE = 100.f;
+
+    void Normalize(float v[3]) noexcept
+    {
+        const float invLength = 1.f / std::sqrt(v[0] * v[0] + v[1] * v[1] + v[2] * v[2]);
+        v[0] *= invLength;
+        v[1] *= invLength;
+        v[2] *= invLength;
+    }
+
+    float Dot(const float a[3], const float b[3]) noexcept
+    {
+        return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+    }
+
+    // transposed XMMatrixLookAtLH()
+    Matrix4x4 CreateLookAt(const float eye[3], const float focus[3], const float up[3]) noexcept
+    {
+        float zAxis[3] = { focus[0] - eye[0], focus[1] - eye[1], focus[2] - eye[2] };
+        Normalize(zAxis);
+        float xAxis[3] = { up[1] * zAxis[2] - up[2] * zAxis[1], up[2] * zAxis[0] - up[0] * zAxis[2], up[0] * zAxis[1] - up[1] * zAxis[0] };
+        Normalize(xAxis);
+        const float yAxis[3] = { zAxis[1] * xAxis[2] - zAxis[2] * xAxis[1], zAxis[2] * xAxis[0] - zAxis[0] * xAxis[2], zAxis[0] * xAxis[1] - zAxis[1] * xAxis[0] };
+
+        return Matrix4x4{ {
+            { xAxis[0], xAxis[1], xAxis[2], -Dot(xAxis, eye) },
+            { yAxis[0], yAxis[1], yAxis[2], -Dot(yAxis, eye) },
+            { zAxis[0], zAxis[1], zAxis[2], -Dot(zAxis, eye) },
+            { 0.f, 0.f, 0.f, 1.f } } };
+    }
+
+    // transposed XMMatrixPerspectiveFovLH()
+    Matrix4x4 CreatePerspective(float fieldOfView, float aspectRatio, float nearPlane, float farPlane) noexcept
+    {
+        const float height = 1.f / std::tan(0.5f * fieldOfView);
+        const float width = height / aspectRatio;
+        const float range = farPlane / (farPlane - nearPlane);
+
+        return Matrix4x4{ {
+            { width, 0.f, 0.f, 0.f },
+            { 0.f, height, 0.f, 0.f },
+            { 0.f, 0.f, range, -range * nearPlane },
+            { 0.f, 0.f, 1.f, 0.f } } };
+    }
+
+    // transposed XMMatrixRotationY()
+    Matrix4x4 CreateRotationY(float angle) noexcept
+    {
+        const float s = std::sin(angle);
+        const float c = std::cos(angle);
+
+        return Matrix4x4{ {
+            { c, 0.f, s, 0.f },
+            { 0.f, 1.f, 0.f, 0.f },
+            { -s, 0.f, c, 0.f },
+            { 0.f, 0.f, 0.f, 1.f } } };
+    }
+}
+
+Matrix4x4 MultiplyMatrices(const Matrix4x4& a, const Matrix4x4& b) noexcept
+{
+    Matrix4x4 result;
+    for (int row = 0; row < 4; ++row)
+    {
+        for (int column = 0; column < 4; ++column)
+        {
+            result.m[row][column] = a.m[row][0] * b.m[0][column] + a.m[row][1] * b.m[1][column] + a.m[row][2] * b.m[2][column] + a.m[row][3] * b.m[3][column];
+        }
+    }
+    return result;
+}
+
+void SetUpDefaultScene(uint32_t width, uint32_t height, float timeMilliseconds, SceneTransforms& transforms, SceneLight& light,
+    SceneMaterial& material) noexcept
+{
+    const float cameraPosition[3] = { 0.f, 0.4f, 0.75f };
+    const float cameraFocus[3] = { 0.f, 0.f, 0.f };
+    const float cameraUp[3] = { 0.f, 1.f, 0.f };
+
+    transforms.model = CreateRotationY(timeMilliseconds * MILLISECONDS_TO_ANGLE);
+    transforms.view = CreateLookAt(cameraPosition, cameraFocus, cameraUp);
+    transforms.proj = CreatePerspective(FIELD_OF_VIEW, static_cast<float>(width) / static_cast<float>(height), NEAR_PLANE, FAR_PLANE);
+
+    // XMVector4Transform() with the stored (transposed) view matrix
+    const float lightWorldPosition[4] = { -1.5f, 1.5f, 1.5f, 1.f };
+    for (int i = 0; i < 4; ++i)
+    {
+        light.position[i] = lightWorldPosition[0] * transforms.view.m[0][i] + lightWorldPosition[1] * transforms.view.m[1][i] +
+            lightWorldPosition[2] * transforms.view.m[2][i] + lightWorldPosition[3] * transforms.view.m[3][i];
+    }
+    light.colorAndPower[0] = 1.f;
+    light.colorAndPower[1] = 1.f;
+    light.colorAndPower[2] = 0.7f;
+    light.colorAndPower[3] = 4.5f;
+
+    material = SceneMaterial{ { 0.f, 0.f, 0.f, 1.f }, { 1.f, 1.f, 1.f, 1.f }, { 0.5f, 0.5f, 0.5f, 24.f } };
+}
+
+VertexShaderConstants ComputeVertexShaderConstants(const SceneTransforms& transforms) noexcept
+{
+    return VertexShaderConstants{ MultiplyMatrices(transforms.view, transforms.model), transforms.proj };
+}
+
+ShadedVertex ShadeVertex(const VertexShaderConstants& constants, const VertexPosNormal& vertex) noexcept
+{
+    const Matrix4x4& modelView = constants.modelView;
+    const Matrix4x4& proj = constants.proj;
+
+    ShadedVertex output;
+    float viewPosition[4];
+    for (int i = 0; i < 4; ++i)
+    {
+        viewPosition[i] = modelView.m[i][0] * vertex.x + modelView.m[i][1] * vertex.y + modelView.m[i][2] * vertex.z + modelView.m[i][3];
+    }
+    for (int i = 0; i < 4; ++i)
+    {
+        output.position[i] = proj.m[i][0] * viewPosition[0] + proj.m[i][1] * viewPosition[1] + proj.m[i][2] * viewPosition[2] + proj.m[i][3] * viewPosition[3];
+    }
+    for (int i = 0; i < 3; ++i)
+    {
+        output.viewPosition[i] = viewPosition[i];
+        // upper 3x3 part of the model-view matrix
+        output.viewNormal[i] = modelView.m[i][0] * vertex.nx + modelView.m[i][1] * vertex.ny + modelView.m[i][2] * vertex.nz;
+    }
+    return output;
+}
+
+ColorRGBA32F ShadeBlinnPhong(const SceneLight& light, const SceneMaterial& material, const float viewPosition[3], const float viewNormal[3]) noexcept
+{
+    float l[3] = { light.position[0] - viewPosition[0], light.position[1] - viewPosition[1], light.position[2] - viewPosition[2] };
+    const float dSquared = Dot(l, l);
+    Normalize(l);
+
+    float n[3] = { viewNormal[0], viewNormal[1], viewNormal[2] };
+    Normalize(n);
+    float v[3] = { -viewPosition[0], -viewPosition[1], -viewPosition[2] };
+    Normalize(v);
+    const float nDotL = Dot(n, l);
+
+    const float lightPower = light.colorAndPower[3] / dSquared;
+    const float lambertian = std::max(nDotL, 0.f);
+
+    float h[3] = { l[0] + v[0], l[1] + v[1], l[2] + v[2] };
+    Normalize(h);
+    float specular = (nDotL > 0.f) ? Dot(h, n) : 0.f;
+    if (specular > 0.f)
+    {
+        specular = std::pow(specular, material.specularAndShininess[3]);
+    }
+
+    float color[3];
+    for (int i = 0; i < 3; ++i)
+    {
+        const float diffuseColor = material.diffuse[i] * light.colorAndPower[i];
+        const float specularColor = material.specularAndShininess[i] * light.colorAndPower[i];
+        color[i] = material.ambient[i] + diffuseColor * lambertian * lightPower + specularColor * specular * lightPower;
+    }
+    return ColorRGBA32F{ color[0], color[1], color[2], 1.f };
+}
+
+namespace
+{
+    // pixels shaded at once by the AVX2 kernel
+    constexpr size_t SIMD_WIDTH = 8;
+
+    bool DetectAvx2() noexcept
+    {
+#if defined(_MSC_VER)
+        int info[4];
+        __cpuid(info, 0);
+        if (info[0] < 7)
+        {
+            return false;
+        }
+        // AVX and OSXSAVE, and the OS saves the YMM registers
+        __cpuid(info, 1);
+        const int avxAndOsxsave = (1 << 27) | (1 << 28);
+        if ((info[2] & avxAndOsxsave) != avxAndOsxsave || (_xgetbv(0) & 6) != 6)
+        {
+            return false;
+        }
+        __cpuidex(info, 7, 0);
+        return (info[1] & (1 << 5)) != 0;
+#else
+        return __builtin_cpu_supports("avx2");
+#endif
+    }
+
+    // light and material broadcast to all lanes
+    struct ShadingConstantsAvx2
+    {
+        __m256 lightPosition[3];
+        __m256 lightPower;
+        __m256 ambient[3];
+        __m256 diffuseColor[3];
+        __m256 specularColor[3];
+        __m256 shininess;
+    };
+
+    // 1 / sqrt(x) with one Newton-Raphson step: r * (1.5 - 0.5 * x * r * r)
+    AVX2_FUNCTION inline __m256 ReciprocalSqrt(__m256 x) noexcept
+    {
+        const __m256 r = _mm256_rsqrt_ps(x);
+        const __m256 halfX = _mm256_mul_ps(_mm256_set1_ps(0.5f), x);
+        return _mm256_mul_ps(r, _mm256_sub_ps(_mm256_set1_ps(1.5f), _mm256_mul_ps(halfX, _mm256_mul_ps(r, r))));
+    }
+
+    // log2(x) for positive, normalized x
+    AVX2_FUNCTION inline __m256 Log2(__m256 x) noexcept
+    {
+        // x = m * 2^e with m in [sqrt(0.5), sqrt(2)) (0x3f3504f3 is sqrt(0.5))
+        const __m256i bits = _mm256_castps_si256(x);
+        const __m256i exponent = _mm256_srai_epi32(_mm256_sub_epi32(bits, _mm256_set1_epi32(0x3f3504f3)), 23);
+        const __m256 mantissa = _mm256_castsi256_ps(_mm256_sub_epi32(bits, _mm256_slli_epi32(exponent, 23)));
+
+        // log2(m) = 2 / ln(2) * atanh(t) with t = (m - 1) / (m + 1) in (-0.172, 0.172), atanh(t) = t + t^3 / 3 + t^5 / 5 + t^7 / 7 + ...
+        const __m256 one = _mm256_set1_ps(1.f);
+        const __m256 t = _mm256_div_ps(_mm256_sub_ps(mantissa, one), _mm256_add_ps(mantissa, one));
+        const __m256 t2 = _mm256_mul_ps(t, t);
+        __m256 series = _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(1.f / 7.f), t2), _mm256_set1_ps(1.f / 5.f));
+        series = _mm256_add_ps(_mm256_mul_ps(series, t2), _mm256_set1_ps(1.f / 3.f));
+        series = _mm256_add_ps(_mm256_mul_ps(series, t2), one);
+        const __m256 logMantissa = _mm256_mul_ps(_mm256_mul_ps(series, t), _mm256_set1_ps(2.8853900817779268f));
+        return _mm256_add_ps(_mm256_cvtepi32_ps(exponent), logMantissa);
+    }
+
+    // 2^y for y <= 127, 0 for y < -100 (products of smaller results with the colors would be denormals, which are very slow)
+    AVX2_FUNCTION inline __m256 Exp2(__m256 y) noexcept
+    {
+        const __m256 flushMask = _mm256_cmp_ps(y, _mm256_set1_ps(-100.f), _CMP_GE_OQ);
+        y = _mm256_min_ps(_mm256_max_ps(y, _mm256_set1_ps(-100.f)), _mm256_set1_ps(127.f));
+
+        // 2^y = 2^i * 2^f with f in [-0.5, 0.5], 2^f = sum of (f * ln(2))^k / k! for k = 0..6
+        const __m256 integer = _mm256_round_ps(y, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+        const __m256 f = _mm256_sub_ps(y, integer);
+        __m256 series = _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(1.5403530393381606e-4f), f), _mm256_set1_ps(1.3333558146428443e-3f));
+        series = _mm256_add_ps(_mm256_mul_ps(series, f), _mm256_set1_ps(9.6181291076284772e-3f));
+        series = _mm256_add_ps(_mm256_mul_ps(series, f), _mm256_set1_ps(5.5504108664821580e-2f));
+        series = _mm256_add_ps(_mm256_mul_ps(series, f), _mm256_set1_ps(0.24022650695910071f));
+        series = _mm256_add_ps(_mm256_mul_ps(series, f), _mm256_set1_ps(0.69314718055994531f));
+        series = _mm256_add_ps(_mm256_mul_ps(series, f), _mm256_set1_ps(1.f));
+
+        const __m256i scale = _mm256_slli_epi32(_mm256_add_epi32(_mm256_cvtps_epi32(integer), _mm256_set1_epi32(127)), 23);
+        return _mm256_and_ps(_mm256_mul_ps(series, _mm256_castsi256_ps(scale)), flushMask);
+    }
+
+    // PSMain for 8 pixels in SoA form
+    AVX2_FUNCTION void ShadeBlinnPhong8(const ShadingConstantsAvx2& constants, const float* const viewPosition[3], const float* const viewNormal[3],
+        size_t offset, float* const color[3]) noexcept
+    {
+        const __m256 px = _mm256_loadu_ps(viewPosition[0] + offset);
+        const __m256 py = _mm256_loadu_ps(viewPosition[1] + offset);
+        const __m256 pz = _mm256_loadu_ps(viewPosition[2] + offset);
+
+        __m256 lx = _mm256_sub_ps(constants.lightPosition[0], px);
+        __m256 ly = _mm256_sub_ps(constants.lightPosition[1], py);
+        __m256 lz = _mm256_sub_ps(constants.lightPosition[2], pz);
+        const __m256 dSquared = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(lx, lx), _mm256_mul_ps(ly, ly)), _mm256_mul_ps(lz, lz));
+        const __m256 invLightDistance = ReciprocalSqrt(dSquared);
+        lx = _mm256_mul_ps(lx, invLightDistance);
+        ly = _mm256_mul_ps(ly, invLightDistance);
+        lz = _mm256_mul_ps(lz, invLightDistance);
+
+        __m256 nx = _mm256_loadu_ps(viewNormal[0] + offset);
+        __m256 ny = _mm256_loadu_ps(viewNormal[1] + offset);
+        __m256 nz = _mm256_loadu_ps(viewNormal[2] + offset);
+        const __m256 invNormalLength = ReciprocalSqrt(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(nx, nx), _mm256_mul_ps(ny, ny)), _mm256_mul_ps(nz, nz)));
+        nx = _mm256_mul_ps(nx, invNormalLength);
+        ny = _mm256_mul_ps(ny, invNormalLength);
+        nz = _mm256_mul_ps(nz, invNormalLength);
+
+        // v = normalize(-p)
+        const __m256 invViewDistance = ReciprocalSqrt(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(px, px), _mm256_mul_ps(py, py)), _mm256_mul_ps(pz, pz)));
+        const __m256 negInvViewDistance = _mm256_sub_ps(_mm256_setzero_ps(), invViewDistance);
+        const __m256 vx = _mm256_mul_ps(px, negInvViewDistance);
+        const __m256 vy = _mm256_mul_ps(py, negInvViewDistance);
+        const __m256 vz = _mm256_mul_ps(pz, negInvViewDistance);
+
+        const __m256 nDotL = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(nx, lx), _mm256_mul_ps(ny, ly)), _mm256_mul_ps(nz, lz));
+        const __m256 lightPower = _mm256_div_ps(constants.lightPower, dSquared);
+        const __m256 lambertian = _mm256_max_ps(nDotL, _mm256_setzero_ps());
+
+        __m256 hx = _mm256_add_ps(lx, vx);
+        __m256 hy = _mm256_add_ps(ly, vy);
+        __m256 hz = _mm256_add_ps(lz, vz);
+        const __m256 invHalfLength = ReciprocalSqrt(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(hx, hx), _mm256_mul_ps(hy, hy)), _mm256_mul_ps(hz, hz)));
+        hx = _mm256_mul_ps(hx, invHalfLength);
+        hy = _mm256_mul_ps(hy, invHalfLength);
+        hz = _mm256_mul_ps(hz, invHalfLength);
+
+        // like PSMain: specular = nDotL > 0 ? dot(h, n) : 0, pow() only if specular > 0 (log2 is evaluated for 1 in the other lanes)
+        const __m256 hDotN = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(hx, nx), _mm256_mul_ps(hy, ny)), _mm256_mul_ps(hz, nz));
+        const __m256 specularBase = _mm256_and_ps(hDotN, _mm256_cmp_ps(nDotL, _mm256_setzero_ps(), _CMP_GT_OQ));
+        const __m256 powMask = _mm256_cmp_ps(specularBase, _mm256_setzero_ps(), _CMP_GT_OQ);
+        const __m256 base = _mm256_blendv_ps(_mm256_set1_ps(1.f), specularBase, powMask);
+        const __m256 specular = _mm256_blendv_ps(specularBase, Exp2(_mm256_mul_ps(constants.shininess, Log2(base))), powMask);
+
+        const __m256 diffuseFactor = _mm256_mul_ps(lambertian, lightPower);
+        const __m256 specularFactor = _mm256_mul_ps(specular, lightPower);
+        for (int i = 0; i < 3; ++i)
+        {
+            const __m256 c = _mm256_add_ps(_mm256_add_ps(constants.ambient[i], _mm256_mul_ps(constants.diffuseColor[i], diffuseFactor)),
+                _mm256_mul_ps(constants.specularColor[i], specularFactor));
+            _mm256_storeu_ps(color[i] + offset, c);
+        }
+    }
+
+    AVX2_FUNCTION void ShadeBlinnPhongAvx2(const SceneLight& light, const SceneMaterial& material, const float* const viewPosition[3],
+        const float* const viewNormal[3], size_t count, float* const color[3]) noexcept
+    {
+        ShadingConstantsAvx2 constants;
+        for (int i = 0; i < 3; ++i)
+        {
+            constants.lightPosition[i] = _mm256_set1_ps(light.position[i]);
+            constants.ambient[i] = _mm256_set1_ps(material.ambient[i]);
+            constants.diffuseColor[i] = _mm256_set1_ps(material.diffuse[i] * light.colorAndPower[i]);
+            constants.specularColor[i] = _mm256_set1_ps(material.specularAndShininess[i] * light.colorAndPower[i]);
+        }
+        constants.lightPower = _mm256_set1_ps(light.colorAndPower[3]);
+        constants.shininess = _mm256_set1_ps(material.specularAndShininess[3]);
+
+        const size_t simdCount = count - count % SIMD_WIDTH;
+        for (size_t offset = 0; offset < simdCount; offset += SIMD_WIDTH)
+        {
+            ShadeBlinnPhong8(constants, viewPosition, viewNormal, offset, color);
+        }
+        if (simdCount == count)
+        {
+            return;
+        }
+
+        // remaining pixels, padded with a pixel in front of the camera facing it
+        float tail[9][SIMD_WIDTH];
+        const float padding[6] = { 0.f, 0.f, 1.f, 0.f, 0.f, -1.f };
+        for (int i = 0; i < 3; ++i)
+        {
+            std::fill(tail[i], tail[i] + SIMD_WIDTH, padding[i]);
+            std::fill(tail[3 + i], tail[3 + i] + SIMD_WIDTH, padding[3 + i]);
+            std::copy(viewPosition[i] + simdCount, viewPosition[i] + count, tail[i]);
+            std::copy(viewNormal[i] + simdCount, viewNormal[i] + count, tail[3 + i]);
+        }
+        const float* const tailPosition[3] = { tail[0], tail[1], tail[2] };
+        const float* const tailNormal[3] = { tail[3], tail[4], tail[5] };
+        float* const tailColor[3] = { tail[6], tail[7], tail[8] };
+        ShadeBlinnPhong8(constants, tailPosition, tailNormal, 0, tailColor);
+        for (int i = 0; i < 3; ++i)
+        {
+            std::copy(tail[6 + i], tail[6 + i] + (count - simdCount), color[i] + simdCount);
+        }
+    }
+}
+
+void ShadeBlinnPhongSoA(const SceneLight& light, const SceneMaterial& material, const float* const viewPosition[3], const float* const viewNormal[3],
+    size_t count, float* const color[3]) noexcept
+{
+    if (IsSimdShadingSupported())
+    {
+        ShadeBlinnPhongAvx2(light, material, viewPosition, viewNormal, count, color);
+        return;
+    }
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        const float position[3] = { viewPosition[0][i], viewPosition[1][i], viewPosition[2][i] };
+        const float normal[3] = { viewNormal[0][i], viewNormal[1][i], viewNormal[2][i] };
+        const ColorRGBA32F c = ShadeBlinnPhong(light, material, position, normal);
+        color[0][i] = c.r;
+        color[1][i] = c.g;
+        color[2][i] = c.b;
+    }
+}
+
+bool IsSimdShadingSupported() noexcept
+{
+    return IsAvx2Supported();
+}
+
+bool IsAvx2Supported() noexcept
+{
+    static const bool supported = DetectAvx2();
+    return supported;
+}
@@ -0,0 +1,369 @@
+#include "cpu/qoi.h"
+
+#include "util/threadpool.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include <emmintrin.h>
+
+namespace
+{
+    constexpr uint8_t QOI_OP_INDEX = 0x00;
+    constexpr uint8_t QOI_OP_DIFF = 0x40;
+    constexpr uint8_t QOI_OP_LUMA = 0x80;
+    constexpr uint8_t QOI_OP_RUN = 0xc0;
+    constexpr uint8_t QOI_OP_RGB = 0xfe;
+    constexpr uint8_t QOI_OP_RGBA = 0xff;
+    constexpr uint8_t QOI_MASK_2 = 0xc0;
+
+    constexpr size_t QOI_HEADER_SIZE = 14;
+    constexpr uint8_t QOI_END_MARKER[8] = { 0, 0, 0, 0, 0, 0, 0, 1 };
+    constexpr uint32_t QOI_MAX_RUN = 62;
+    // max. size of an encoded pixel (QOI_OP_RGBA)
+    constexpr size_t QOI_MAX_PIXEL_SIZE = 5;
+    // limit of the reference decoder, protects against huge allocations for broken headers
+    constexpr uint64_t QOI_MAX_PIXELS = 400000000;
+
+    // number of rows encoded as one stripe
+    constexpr uint32_t STRIPE_ROWS = 32;
+
+    uint32_t PackPixel(const ColorRGBA8& c) noexcept
+    {
+        uint32_t value;
+        std::memcpy(&value, &c, sizeof(value));
+        return value;
+    }
+
+    uint32_t QoiHash(const ColorRGBA8& c) noexcept
+    {
+        return (c.r * 3u + c.g * 5u + c.b * 7u + c.a * 11u) % 64u;
+    }
+
+    void WriteHeader(uint32_t width, uint32_t height, uint8_t* data)
+    {
+        const uint8_t header[QOI_HEADER_SIZE] = {
+            'q', 'o', 'i', 'f',
+            static_cast<uint8_t>(width >> 24), static_cast<uint8_t>(width >> 16), static_cast<uint8_t>(width >> 8), static_cast<uint8_t>(width),
+            static_cast<uint8_t>(height >> 24), static_cast<uint8_t>(height >> 16), static_cast<uint8_t>(height >> 8), static_cast<uint8_t>(height),
+            4,  // channels
+            0   // sRGB with linear alpha
+        };
+        std::memcpy(data, header, QOI_HEADER_SIZE);
+    }
+
+    // index hashes of count pixels, four at a time
+    void ComputeHashes(const ColorRGBA8* pixels, size_t count, uint8_t* hashes)
+    {
+        const __m128i weights = _mm_setr_epi16(3, 5, 7, 11, 3, 5, 7, 11);
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i mask = _mm_set1_epi32(63);
+
+        size_t i = 0;
+        for (; i + 4 <= count; i += 4)
+        {
+            const __m128i p = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pixels + i));
+
+            // (3r + 5g, 7b + 11a) for each pixel, then the sum of both halves
+            const __m128i sumsLow = _mm_madd_epi16(_mm_unpacklo_epi8(p, zero), weights);
+            const __m128i sumsHigh = _mm_madd_epi16(_mm_unpackhi_epi8(p, zero), weights);
+            const __m128i even = _mm_castps_si128(_mm_shuffle_ps(_mm_castsi128_ps(sumsLow), _mm_castsi128_ps(sumsHigh), _MM_SHUFFLE(2, 0, 2, 0)));
+            const __m128i odd = _mm_castps_si128(_mm_shuffle_ps(_mm_castsi128_ps(sumsLow), _mm_castsi128_ps(sumsHigh), _MM_SHUFFLE(3, 1, 3, 1)));
+            __m128i hash = _mm_and_si128(_mm_add_epi32(even, odd), mask);
+
+            hash = _mm_packs_epi32(hash, hash);
+            hash = _mm_packus_epi16(hash, hash);
+            const int packed = _mm_cvtsi128_si32(hash);
+            std::memcpy(hashes + i, &packed, 4);
+        }
+
+        for (; i < count; ++i)
+        {
+            hashes[i] = static_cast<uint8_t>(QoiHash(pixels[i]));
+        }
+    }
+
+    // first index in [begin, end) with a pixel different from value (end if there is none)
+    size_t FindRunEnd(const ColorRGBA8* pixels, size_t begin, size_t end, uint32_t value)
+    {
+        const __m128i reference = _mm_set1_epi32(static_cast<int>(value));
+
+        size_t i = begin;
+        for (; i + 4 <= end; i += 4)
+        {
+            const __m128i p = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pixels + i));
+            const int equal = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(p, reference)));
+            if (equal != 0xf)
+            {
+                // position of the first lane that differs
+                const int different = ~equal & 0xf;
+                return i + ((different & 1) ? 0 : (different & 2) ? 1 : (different & 4) ? 2 : 3);
+            }
+        }
+
+        for (; i < end && PackPixel(pixels[i]) == value; ++i)
+        {
+        }
+        return i;
+    }
+
+    // encodes a pixel that differs from the previous one and is not in the index
+    uint8_t* EncodeDifference(const ColorRGBA8& px, const ColorRGBA8& previous, uint8_t* out)
+    {
+        if (px.a != previous.a)
+        {
+            *out++ = QOI_OP_RGBA;
+            *out++ = px.r;
+            *out++ = px.g;
+            *out++ = px.b;
+            *out++ = px.a;
+            return out;
+        }
+
+        // differences with wraparound
+        const int8_t dr = static_cast<int8_t>(px.r - previous.r);
+        const int8_t dg = static_cast<int8_t>(px.g - previous.g);
+        const int8_t db = static_cast<int8_t>(px.b - previous.b);
+        const int8_t drg = static_cast<int8_t>(dr - dg);
+        const int8_t dbg = static_cast<int8_t>(db - dg);
+
+        if (dr > -3 && dr < 2 && dg > -3 && dg < 2 && db > -3 && db < 2)
+        {
+            *out++ = static_cast<uint8_t>(QOI_OP_DIFF | (dr + 2) << 4 | (dg + 2) << 2 | (db + 2));
+        }
+        else if (drg > -9 && drg < 8 && dg > -33 && dg < 32 && dbg > -9 && dbg < 8)
+        {
+            *out++ = static_cast<uint8_t>(QOI_OP_LUMA | (dg + 32));
+            *out++ = static_cast<uint8_t>((drg + 8) << 4 | (dbg + 8));
+        }
+        else
+        {
+            *out++ = QOI_OP_RGB;
+            *out++ = px.r;
+            *out++ = px.g;
+            *out++ = px.b;
+        }
+        return out;
+    }
+
+    uint8_t* EncodeRun(size_t run, uint8_t* out)
+    {
+        while (run > 0)
+        {
+            const size_t length = std::min<size_t>(run, QOI_MAX_RUN);
+            *out++ = static_cast<uint8_t>(QOI_OP_RUN | (length - 1));
+            run -= length;
+        }
+        return out;
+    }
+}
+
+void QoiEncoder::Encode(const ImageRGBA8& image, std::vector<uint8_t>& output, ThreadPool* pool)
+{
+    const uint32_t stripeCount = (image.height + STRIPE_ROWS - 1) / STRIPE_ROWS;
+    m_stripes.resize(stripeCount);
+
+    ParallelFor(pool, 0, stripeCount, 1, [&](size_t stripeBegin, size_t stripeEnd)
+    {
+        for (size_t stripeIndex = stripeBegin; stripeIndex < stripeEnd; ++stripeIndex)
+        {
+            Stripe& stripe = m_stripes[stripeIndex];
+            const uint32_t firstRow = static_cast<uint32_t>(stripeIndex) * STRIPE_ROWS;
+            const size_t pixelCount = static_cast<size_t>(std::min(STRIPE_ROWS, image.height - firstRow)) * image.width;
+            const ColorRGBA8* pixels = image.Row(firstRow);
+
+            stripe.data.resize(pixelCount * QOI_MAX_PIXEL_SIZE);
+            stripe.hashes.resize(pixelCount);
+            ComputeHashes(pixels, pixelCount, stripe.hashes.data());
+
+            // the decoder continues with the state after the previous stripe, of which we only know the last pixel
+            ColorRGBA8 previous = (firstRow == 0) ? ColorRGBA8{ 0, 0, 0, 255 } : pixels[-1];
+            uint32_t index[64];
+            uint64_t validIndexEntries = 0;
+
+            uint8_t* out = stripe.data.data();
+            size_t i = 0;
+            while (i < pixelCount)
+            {
+                const ColorRGBA8& px = pixels[i];
+                const uint32_t value = PackPixel(px);
+                if (value == PackPixel(previous))
+                {
+                    const size_t runEnd = FindRunEnd(pixels, i + 1, pixelCount, value);
+                    out = EncodeRun(runEnd - i, out);
+                    i = runEnd;
+                    continue;
+                }
+
+                const uint32_t hash = stripe.hashes[i];
+                if ((validIndexEntries >> hash & 1) != 0 && index[hash] == value)
+                {
+                    *out++ = static_cast<uint8_t>(QOI_OP_INDEX | hash);
+                }
+                else
+                {
+                    index[hash] = value;
+                    validIndexEntries |= uint64_t(1) << hash;
+                    out = EncodeDifference(px, previous, out);
+                }
+
+                previous = px;
+                ++i;
+            }
+
+            stripe.size = static_cast<size_t>(out - stripe.data.data());
+        }
+    });
+
+    size_t size = QOI_HEADER_SIZE + sizeof(QOI_END_MARKER);
+    for (const Stripe& stripe : m_stripes)
+    {
+        size += stripe.size;
+    }
+
+    output.resize(size);
+    WriteHeader(image.width, image.height, output.data());
+    uint8_t* out = output.data() + QOI_HEADER_SIZE;
+    for (const Stripe& stripe : m_stripes)
+    {
+        std::memcpy(out, stripe.data.data(), stripe.size);
+        out += stripe.size;
+    }
+    std::memcpy(out, QOI_END_MARKER, sizeof(QOI_END_MARKER));
+}
+
+void EncodeQoiReference(const ImageRGBA8& image, std::vector<uint8_t>& output)
+{
+    const size_t pixelCount = image.pixels.size();
+    output.resize(QOI_HEADER_SIZE + pixelCount * QOI_MAX_PIXEL_SIZE + sizeof(QOI_END_MARKER));
+    WriteHeader(image.width, image.height, output.data());
+
+    ColorRGBA8 index[64] = { };
+    ColorRGBA8 previous = { 0, 0, 0, 255 };
+    size_t run = 0;
+
+    uint8_t* out = output.data() + QOI_HEADER_SIZE;
+    for (size_t i = 0; i < pixelCount; ++i)
+    {
+        const ColorRGBA8& px = image.pixels[i];
+        if (PackPixel(px) == PackPixel(previous))
+        {
+            ++run;
+            if (run == QOI_MAX_RUN || i + 1 == pixelCount)
+            {
+                out = EncodeRun(run, out);
+                run = 0;
+            }
+            continue;
+        }
+
+        if (run > 0)
+        {
+            out = EncodeRun(run, out);
+            run = 0;
+        }
+
+        const uint32_t hash = QoiHash(px);
+        if (PackPixel(index[hash]) == PackPixel(px))
+        {
+            *out++ = static_cast<uint8_t>(QOI_OP_INDEX | hash);
+        }
+        else
+        {
+            index[hash] = px;
+            out = EncodeDifference(px, previous, out);
+        }
+        previous = px;
+    }
+
+    std::memcpy(out, QOI_END_MARKER, sizeof(QOI_END_MARKER));
+    out += sizeof(QOI_END_MARKER);
+    output.resize(static_cast<size_t>(out - output.data()));
+}
+
+bool DecodeQoi(const uint8_t* data, size_t size, ImageRGBA8& image)
+{
+    if (size < QOI_HEADER_SIZE + sizeof(QOI_END_MARKER) || std::memcmp(data, "qoif", 4) != 0)
+    {
+        return false;
+    }
+
+    auto readBigEndian = [](const uint8_t* bytes)
+    {
+        return static_cast<uint32_t>(bytes[0]) << 24 | static_cast<uint32_t>(bytes[1]) << 16 | static_cast<uint32_t>(bytes[2]) << 8 | bytes[3];
+    };
+    const uint32_t width = readBigEndian(data + 4);
+    const uint32_t height = readBigEndian(data + 8);
+    const uint8_t channels = data[12];
+    if (width == 0 || height == 0 || (channels != 3 && channels != 4) || static_cast<uint64_t>(width) * height > QOI_MAX_PIXELS)
+    {
+        return false;
+    }
+
+    image.Resize(width, height);
+    ColorRGBA8 index[64] = { };
+    ColorRGBA8 px = { 0, 0, 0, 255 };
+
+    // the end marker is not part of the chunks
+    const uint8_t* in = data + QOI_HEADER_SIZE;
+    const uint8_t* end = data + size - sizeof(QOI_END_MARKER);
+    ColorRGBA8* out = image.pixels.data();
+    ColorRGBA8* outEnd = out + image.pixels.size();
+    while (out < outEnd)
+    {
+        if (in >= end)
+        {
+            return false;
+        }
+
+        const uint8_t op = *in++;
+        if (op == QOI_OP_RGB || op == QOI_OP_RGBA)
+        {
+            const size_t length = (op == QOI_OP_RGB) ? 3 : 4;
+            if (static_cast<size_t>(end - in) < length)
+            {
+                return false;
+            }
+            px.r = in[0];
+            px.g = in[1];
+            px.b = in[2];
+            px.a = (op == QOI_OP_RGBA) ? in[3] : px.a;
+            in += length;
+        }
+        else if ((op & QOI_MASK_2) == QOI_OP_INDEX)
+        {
+            px = index[op];
+        }
+        else if ((op & QOI_MASK_2) == QOI_OP_DIFF)
+        {
+            px.r = static_cast<uint8_t>(px.r + ((op >> 4) & 3) - 2);
+            px.g = static_cast<uint8_t>(px.g + ((op >> 2) & 3) - 2);
+            px.b = static_cast<uint8_t>(px.b + (op & 3) - 2);
+        }
+        else if ((op & QOI_MASK_2) == QOI_OP_LUMA)
+        {
+            if (in >= end)
+            {
+                return false;
+            }
+            const int dg = (op & 0x3f) - 32;
+            const uint8_t second = *in++;
+            px.r = static_cast<uint8_t>(px.r + dg - 8 + ((second >> 4) & 0x0f));
+            px.g = static_cast<uint8_t>(px.g + dg);
+            px.b = static_cast<uint8_t>(px.b + dg - 8 + (second & 0x0f));
+        }
+        else
+        {
+            // run of the previous pixel, the index is not updated
+            const size_t run = std::min<size_t>((op & 0x3f) + 1, static_cast<size_t>(outEnd - out));
+            std::fill_n(out, run, px);
+            out += run;
+            continue;
+        }
+
+        index[QoiHash(px)] = px;
+        *out++ = px;
+    }
+
+    return true;
+}
@@ -0,0 +1,1042 @@
+#include "cpu/rasterizer.h"
+
+#include "util/threadpool.h"
+#include "util/timer.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include <immintrin.h>
+
+// see phong.cpp
+#if defined(__GNUC__)
+#define AVX2_FUNCTION __attribute__((target("avx2")))
+#else
+#define AVX2_FUNCTION
+#endif
+
+namespace
+{
+    constexpr int32_t TILE_SIZE = 64;
+    // D3D11 snaps vertices to 1/256 pixel
+    constexpr int32_t SUBPIXEL_SCALE = 256;
+    // number of triangles set up and binned as one task
+    constexpr size_t CHUNK_TRIANGLES = 256;
+    // x and y are clipped to [-GUARD_BAND * w, GUARD_BAND * w], which keeps the fixed-point positions of the max.
+    // viewport size below 2^24 and the edge functions below 2^50
+    constexpr float GUARD_BAND = 4.f;
+    constexpr uint32_t MAX_VIEWPORT_SIZE = 16384;
+    constexpr uint32_t DEPTH_MAX = (1u << 24) - 1;
+    // tiles are rasterized in blocks of 8x8 pixels, each one has its own depth range
+    constexpr int32_t BLOCK_SIZE = 8;
+    constexpr int32_t TILE_BLOCKS = TILE_SIZE / BLOCK_SIZE;
+    // the depth bounds of triangles are widened by this number of D24 units to cover the rounding of the per-pixel depth
+    constexpr uint32_t DEPTH_MARGIN = 4;
+    constexpr ColorRGBA32F BACKGROUND_COLOR = { 0.f, 0.f, 0.f, 1.f };
+
+    // near, far, left, right, bottom, top
+    constexpr int CLIP_PLANE_COUNT = 6;
+    // each clip plane adds at most one vertex to the (convex) polygon
+    constexpr int MAX_CLIPPED_VERTICES = 3 + CLIP_PLANE_COUNT;
+
+    // signed distance of the vertex to a clip plane, negative outside
+    float GetPlaneDistance(const ShadedVertex& v, int plane) noexcept
+    {
+        const float* p = v.position;
+        switch (plane)
+        {
+        case 0: return p[2];
+        case 1: return p[3] - p[2];
+        case 2: return p[0] + GUARD_BAND * p[3];
+        case 3: return GUARD_BAND * p[3] - p[0];
+        case 4: return p[1] + GUARD_BAND * p[3];
+        default: return GUARD_BAND * p[3] - p[1];
+        }
+    }
+
+    // bit i is set if the vertex is outside of clip plane i
+    uint32_t GetOutcode(const ShadedVertex& v) noexcept
+    {
+        uint32_t outcode = 0;
+        for (int plane = 0; plane < CLIP_PLANE_COUNT; ++plane)
+        {
+            outcode |= (GetPlaneDistance(v, plane) < 0.f) ? (1u << plane) : 0u;
+        }
+        return outcode;
+    }
+
+    ShadedVertex Interpolate(const ShadedVertex& a, const ShadedVertex& b, float t) noexcept
+    {
+        ShadedVertex result;
+        for (int i = 0; i < 4; ++i)
+        {
+            result.position[i] = a.position[i] + t * (b.position[i] - a.position[i]);
+        }
+        for (int i = 0; i < 3; ++i)
+        {
+            result.viewPosition[i] = a.viewPosition[i] + t * (b.viewPosition[i] - a.viewPosition[i]);
+            result.viewNormal[i] = a.viewNormal[i] + t * (b.viewNormal[i] - a.viewNormal[i]);
+        }
+        return result;
+    }
+
+    // Sutherland-Hodgman clipping of a convex polygon against the planes in the mask, returns the new vertex count
+    int ClipPolygon(ShadedVertex* polygon, int count, uint32_t planeMask)
+    {
+        ShadedVertex input[MAX_CLIPPED_VERTICES];
+        for (int plane = 0; plane < CLIP_PLANE_COUNT && count > 0; ++plane)
+        {
+            if ((planeMask & (1u << plane)) == 0)
+            {
+                continue;
+            }
+
+            std::copy(polygon, polygon + count, input);
+            const int inputCount = count;
+            count = 0;
+            for (int i = 0; i < inputCount; ++i)
+            {
+                const ShadedVertex& current = input[i];
+                const ShadedVertex& next = input[(i + 1) % inputCount];
+                const float currentDistance = GetPlaneDistance(current, plane);
+                const float nextDistance = GetPlaneDistance(next, plane);
+
+                if (currentDistance >= 0.f)
+                {
+                    polygon[count++] = current;
+                }
+                if ((currentDistance >= 0.f) != (nextDistance >= 0.f))
+                {
+                    polygon[count++] = Interpolate(current, next, currentDistance / (currentDistance - nextDistance));
+                }
+            }
+        }
+        return count;
+    }
+
+    // floor(numerator / denominator) for a positive denominator
+    int32_t FloorDivide(int32_t numerator, int32_t denominator) noexcept
+    {
+        return (numerator >= 0) ? numerator / denominator : -((-numerator + denominator - 1) / denominator);
+    }
+
+    float Saturate(float value) noexcept
+    {
+        return std::min(std::max(value, 0.f), 1.f);
+    }
+
+    uint32_t QuantizeDepth(float z) noexcept
+    {
+        return static_cast<uint32_t>(Saturate(z) * DEPTH_MAX + 0.5f);
+    }
+
+    // pixels waiting for shading
+    struct ShadingBatch
+    {
+        static constexpr uint32_t CAPACITY = 64;
+
+        // shades the pixels and writes them to the render target in the order they were added, so a later pixel at the
+        // same position overwrites an earlier one like without batching (coarse samples are written to all pixels of
+        // their block)
+        void Shade(const SceneLight& light, const SceneMaterial& material, ImageRGBA32F& color) noexcept
+        {
+            const float* const position[3] = { viewPosition[0], viewPosition[1], viewPosition[2] };
+            const float* const normal[3] = { viewNormal[0], viewNormal[1], viewNormal[2] };
+            float* const shaded[3] = { rgb[0], rgb[1], rgb[2] };
+            ShadeBlinnPhongSoA(light, material, position, normal, count, shaded);
+
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                const ColorRGBA32F pixel = { Saturate(rgb[0][i]), Saturate(rgb[1][i]), Saturate(rgb[2][i]), 1.f };
+                for (int32_t row = y[i]; row < y[i] + size[i]; ++row)
+                {
+                    std::fill(color.Row(row) + x[i], color.Row(row) + x[i] + size[i], pixel);
+                }
+            }
+            count = 0;
+        }
+
+        uint32_t count = 0;
+        // top left pixel and width of the block of pixels of each sample (1 if shaded per pixel)
+        int32_t x[CAPACITY];
+        int32_t y[CAPACITY];
+        int32_t size[CAPACITY];
+        float viewPosition[3][CAPACITY];
+        float viewNormal[3][CAPACITY];
+        float rgb[3][CAPACITY];
+    };
+
+    // triangle fetched from the vertex buffer for the shading pass of the visibility buffer mode
+    struct FetchedTriangle
+    {
+        uint32_t primitive;
+        // homogeneous screen positions (x * w, y * w, w)
+        float homogeneous[3][3];
+        float viewPosition[3][3];
+        float viewNormal[3][3];
+    };
+
+    // triangles tested at once by the prefilter
+    constexpr size_t PREFILTER_WIDTH = 8;
+
+    /**
+     * Writes the indices of the triangles in [first, last) that may survive the setup to candidates and returns their
+     * number (see SoftwareRasterizer). The operations on each lane are the same as in ShadeVertex(), GetOutcode() and
+     * SetUpTriangle(), triangles that need clipping are always kept.
+     */
+    AVX2_FUNCTION size_t PrefilterTrianglesAvx2(const VertexPosNormal* vertices, size_t first, size_t last, const VertexShaderConstants& constants,
+        uint32_t width, uint32_t height, uint32_t* candidates) noexcept
+    {
+        const Matrix4x4& modelView = constants.modelView;
+        const Matrix4x4& proj = constants.proj;
+        const __m256 half = _mm256_set1_ps(0.5f);
+        const __m256 guardBand = _mm256_set1_ps(GUARD_BAND);
+        const __m256 zero = _mm256_setzero_ps();
+        const __m256 screenWidth = _mm256_set1_ps(static_cast<float>(width));
+        const __m256 screenHeight = _mm256_set1_ps(static_cast<float>(height));
+        const __m256 subpixelScale = _mm256_set1_ps(static_cast<float>(SUBPIXEL_SCALE));
+        const __m256i maxPixelX = _mm256_set1_epi32(static_cast<int32_t>(width) - 1);
+        const __m256i maxPixelY = _mm256_set1_epi32(static_cast<int32_t>(height) - 1);
+        // vertex i of the triangle in lane j starts at float (3 * j + i) * 6
+        constexpr int32_t VERTEX_FLOATS = sizeof(VertexPosNormal) / sizeof(float);
+        const __m256i laneOffsets = _mm256_mullo_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7), _mm256_set1_epi32(3 * VERTEX_FLOATS));
+
+        size_t count = 0;
+        for (size_t triangle = first; triangle < last; triangle += PREFILTER_WIDTH)
+        {
+            const size_t lanes = std::min(PREFILTER_WIDTH, last - triangle);
+            const __m256i laneMask = _mm256_cmpgt_epi32(_mm256_set1_epi32(static_cast<int32_t>(lanes)), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+            const float* base = &vertices[3 * triangle].x;
+
+            __m256 clip[3][4];
+            for (int v = 0; v < 3; ++v)
+            {
+                __m256 position[3];
+                for (int c = 0; c < 3; ++c)
+                {
+                    const __m256i offsets = _mm256_add_epi32(laneOffsets, _mm256_set1_epi32(v * VERTEX_FLOATS + c));
+                    position[c] = _mm256_mask_i32gather_ps(zero, base, offsets, _mm256_castsi256_ps(laneMask), 4);
+                }
+
+                // same order of the operations as in ShadeVertex()
+                __m256 viewPosition[4];
+                for (int i = 0; i < 4; ++i)
+                {
+                    viewPosition[i] = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(modelView.m[i][0]), position[0]),
+                        _mm256_mul_ps(_mm256_set1_ps(modelView.m[i][1]), position[1])), _mm256_mul_ps(_mm256_set1_ps(modelView.m[i][2]), position[2])),
+                        _mm256_set1_ps(modelView.m[i][3]));
+                }
+                for (int i = 0; i < 4; ++i)
+                {
+                    clip[v][i] = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(proj.m[i][0]), viewPosition[0]),
+                        _mm256_mul_ps(_mm256_set1_ps(proj.m[i][1]), viewPosition[1])), _mm256_mul_ps(_mm256_set1_ps(proj.m[i][2]), viewPosition[2])),
+                        _mm256_mul_ps(_mm256_set1_ps(proj.m[i][3]), viewPosition[3]));
+                }
+            }
+
+            // outside of a clip plane (see GetPlaneDistance()): all vertices outside of one plane, any vertex outside of any plane
+            __m256 outsideAll = zero;
+            __m256 outsideAny = zero;
+            for (int plane = 0; plane < CLIP_PLANE_COUNT; ++plane)
+            {
+                __m256 all = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+                for (int v = 0; v < 3; ++v)
+                {
+                    const __m256* p = clip[v];
+                    __m256 distance;
+                    switch (plane)
+                    {
+                    case 0: distance = p[2]; break;
+                    case 1: distance = _mm256_sub_ps(p[3], p[2]); break;
+                    case 2: distance = _mm256_add_ps(p[0], _mm256_mul_ps(guardBand, p[3])); break;
+                    case 3: distance = _mm256_sub_ps(_mm256_mul_ps(guardBand, p[3]), p[0]); break;
+                    case 4: distance = _mm256_add_ps(p[1], _mm256_mul_ps(guardBand, p[3])); break;
+                    default: distance = _mm256_sub_ps(_mm256_mul_ps(guardBand, p[3]), p[1]); break;
+                    }
+                    const __m256 outside = _mm256_cmp_ps(distance, zero, _CMP_LT_OQ);
+                    all = _mm256_and_ps(all, outside);
+                    outsideAny = _mm256_or_ps(outsideAny, outside);
+                }
+                outsideAll = _mm256_or_ps(outsideAll, all);
+            }
+
+            // snapped screen positions like in SetUpTriangle() (only used for the lanes that need no clipping)
+            __m256i x[3];
+            __m256i y[3];
+            for (int v = 0; v < 3; ++v)
+            {
+                const __m256 invW = _mm256_div_ps(_mm256_set1_ps(1.f), clip[v][3]);
+                const __m256 screenX = _mm256_mul_ps(_mm256_add_ps(half, _mm256_mul_ps(_mm256_mul_ps(half, clip[v][0]), invW)), screenWidth);
+                const __m256 screenY = _mm256_mul_ps(_mm256_sub_ps(half, _mm256_mul_ps(_mm256_mul_ps(half, clip[v][1]), invW)), screenHeight);
+                const __m256 unclipped = _mm256_andnot_ps(outsideAny, _mm256_castsi256_ps(_mm256_set1_epi32(-1)));
+                x[v] = _mm256_cvttps_epi32(_mm256_and_ps(unclipped, _mm256_floor_ps(_mm256_add_ps(_mm256_mul_ps(screenX, subpixelScale), half))));
+                y[v] = _mm256_cvttps_epi32(_mm256_and_ps(unclipped, _mm256_floor_ps(_mm256_add_ps(_mm256_mul_ps(screenY, subpixelScale), half))));
+            }
+
+            // twice the area, the products of the differences have up to 50 bits, which is exact in double precision
+            const __m256i dx1 = _mm256_sub_epi32(x[1], x[0]);
+            const __m256i dy2 = _mm256_sub_epi32(y[2], y[0]);
+            const __m256i dx2 = _mm256_sub_epi32(x[2], x[0]);
+            const __m256i dy1 = _mm256_sub_epi32(y[1], y[0]);
+            int frontFacing = 0;
+            for (int h = 0; h < 2; ++h)
+            {
+                // lanes 0-3 or 4-7 converted to double (no lambda, it would not get the target of the function)
+                const __m256d dx1d = _mm256_cvtepi32_pd(h == 0 ? _mm256_castsi256_si128(dx1) : _mm256_extracti128_si256(dx1, 1));
+                const __m256d dy2d = _mm256_cvtepi32_pd(h == 0 ? _mm256_castsi256_si128(dy2) : _mm256_extracti128_si256(dy2, 1));
+                const __m256d dx2d = _mm256_cvtepi32_pd(h == 0 ? _mm256_castsi256_si128(dx2) : _mm256_extracti128_si256(dx2, 1));
+                const __m256d dy1d = _mm256_cvtepi32_pd(h == 0 ? _mm256_castsi256_si128(dy1) : _mm256_extracti128_si256(dy1, 1));
+                const __m256d area = _mm256_sub_pd(_mm256_mul_pd(dx1d, dy2d), _mm256_mul_pd(dx2d, dy1d));
+                frontFacing |= _mm256_movemask_pd(_mm256_cmp_pd(area, _mm256_setzero_pd(), _CMP_GT_OQ)) << (4 * h);
+            }
+
+            // pixel centers in the bounding box, floor division by SUBPIXEL_SCALE (a power of two) is an arithmetic shift
+            const int shift = 8;
+            static_assert((1 << shift) == SUBPIXEL_SCALE, "the prefilter assumes 8 bits of subpixel precision");
+            const __m256i halfPixel = _mm256_set1_epi32(SUBPIXEL_SCALE / 2);
+            const __m256i minX = _mm256_max_epi32(_mm256_srai_epi32(_mm256_add_epi32(_mm256_sub_epi32(_mm256_min_epi32(_mm256_min_epi32(x[0], x[1]), x[2]),
+                halfPixel), _mm256_set1_epi32(SUBPIXEL_SCALE - 1)), shift), _mm256_setzero_si256());
+            const __m256i minY = _mm256_max_epi32(_mm256_srai_epi32(_mm256_add_epi32(_mm256_sub_epi32(_mm256_min_epi32(_mm256_min_epi32(y[0], y[1]), y[2]),
+                halfPixel), _mm256_set1_epi32(SUBPIXEL_SCALE - 1)), shift), _mm256_setzero_si256());
+            const __m256i maxX = _mm256_min_epi32(_mm256_srai_epi32(_mm256_sub_epi32(_mm256_max_epi32(_mm256_max_epi32(x[0], x[1]), x[2]), halfPixel), shift),
+                maxPixelX);
+            const __m256i maxY = _mm256_min_epi32(_mm256_srai_epi32(_mm256_sub_epi32(_mm256_max_epi32(_mm256_max_epi32(y[0], y[1]), y[2]), halfPixel), shift),
+                maxPixelY);
+            const __m256i empty = _mm256_or_si256(_mm256_cmpgt_epi32(minX, maxX), _mm256_cmpgt_epi32(minY, maxY));
+            const int covers = ~_mm256_movemask_ps(_mm256_castsi256_ps(empty)) & 0xff;
+
+            // triangles that need clipping are kept, the others have to be front facing and cover a pixel center
+            const int clipped = _mm256_movemask_ps(outsideAny) & ~_mm256_movemask_ps(outsideAll);
+            const int keep = (clipped | (~_mm256_movemask_ps(outsideAny) & frontFacing & covers)) & _mm256_movemask_ps(_mm256_castsi256_ps(laneMask));
+            for (int lane = 0; lane < static_cast<int>(PREFILTER_WIDTH); ++lane)
+            {
+                if (keep & (1 << lane))
+                {
+                    candidates[count++] = static_cast<uint32_t>(triangle + lane);
+                }
+            }
+        }
+        return count;
+    }
+
+    // blocks of 4x4 pixels (or their quarters) are shaded once with the adaptive shading rate, if the specular term at
+    // their center is below the threshold (highlights are always shaded per pixel)
+    constexpr int32_t SHADING_BLOCK_SIZE = 4;
+    constexpr float HIGHLIGHT_THRESHOLD = 0.02f;
+
+    // cache of fetched triangles for the pixels of a tile, direct mapped with a multiplicative hash of the triangle
+    // index (neighbouring triangles of a mesh often differ by a power of two, e.g., rows of a grid)
+    constexpr uint32_t TRIANGLE_CACHE_BITS = 6;
+}
+
+struct SoftwareRasterizer::TileContext
+{
+    // pixel range of the tile
+    int32_t minX, minY, maxX, maxY;
+    // Hi-Z: depth range of the blocks (row by row) and max. depth of the tile
+    uint32_t blockMinDepth[TILE_BLOCKS * TILE_BLOCKS];
+    uint32_t blockMaxDepth[TILE_BLOCKS * TILE_BLOCKS];
+    uint32_t maxDepth;
+    ShadingBatch batch;
+    Stats stats;
+};
+
+SoftwareRasterizer::SoftwareRasterizer(const RasterizerSettings& settings)
+    : m_settings(settings)
+{
+}
+
+void SoftwareRasterizer::Render(const std::vector<VertexPosNormal>& vertices, const SceneTransforms& transforms, const SceneLight& light,
+    const SceneMaterial& material, uint32_t width, uint32_t height, ImageRGBA32F& color, ThreadPool* pool)
+{
+    m_stats = Stats{ };
+    m_width = std::min(width, MAX_VIEWPORT_SIZE);
+    m_height = std::min(height, MAX_VIEWPORT_SIZE);
+    m_tilesX = (m_width + TILE_SIZE - 1) / TILE_SIZE;
+    m_tilesY = (m_height + TILE_SIZE - 1) / TILE_SIZE;
+    color.Resize(m_width, m_height);
+    m_depth.resize(static_cast<size_t>(m_width) * m_height);
+    if (m_settings.visibilityBuffer)
+    {
+        m_visibility.resize(m_depth.size());
+    }
+    else
+    {
+        m_visibility.clear();
+    }
+
+    Timer timer;
+    timer.Start();
+
+    const size_t triangleCount = vertices.size() / 3;
+    const size_t chunkCount = (triangleCount + CHUNK_TRIANGLES - 1) / CHUNK_TRIANGLES;
+    m_chunks.resize(chunkCount);
+    const VertexShaderConstants constants = ComputeVertexShaderConstants(transforms);
+    ParallelFor(pool, 0, chunkCount, 1, [&](size_t chunkBegin, size_t chunkEnd)
+    {
+        for (size_t chunk = chunkBegin; chunk < chunkEnd; ++chunk)
+        {
+            SetUpChunk(vertices, constants, chunk);
+        }
+    });
+
+    timer.Stop();
+    m_stats.setupMilliseconds = timer.GetElapsedTimeMilliseconds();
+    timer.Start();
+
+    const uint32_t tileCount = m_tilesX * m_tilesY;
+    std::vector<Stats> tileStats(tileCount);
+    ParallelFor(pool, 0, tileCount, 1, [&](size_t tileBegin, size_t tileEnd)
+    {
+        for (size_t tile = tileBegin; tile < tileEnd; ++tile)
+        {
+            RasterizeTile(static_cast<uint32_t>(tile), vertices, constants, light, material, color, tileStats[tile]);
+        }
+    });
+
+    timer.Stop();
+    m_stats.rasterMilliseconds = timer.GetElapsedTimeMilliseconds();
+
+    m_stats.triangles = triangleCount;
+    for (const Chunk& chunk : m_chunks)
+    {
+        m_stats.trianglesCulled += chunk.trianglesCulled;
+        m_stats.trianglesClipped += chunk.trianglesClipped;
+        m_stats.trianglesPrefiltered += chunk.trianglesPrefiltered;
+        m_stats.binnedTriangles += chunk.binnedTriangles;
+    }
+    for (const Stats& stats : tileStats)
+    {
+        m_stats.pixelsShaded += stats.pixelsShaded;
+        m_stats.pixelsShadedCoarse += stats.pixelsShadedCoarse;
+        m_stats.trianglesOccluded += stats.trianglesOccluded;
+        m_stats.blocksTested += stats.blocksTested;
+        m_stats.blocksOccluded += stats.blocksOccluded;
+    }
+}
+
+void SoftwareRasterizer::SetUpChunk(const std::vector<VertexPosNormal>& vertices, const VertexShaderConstants& constants, size_t chunkIndex)
+{
+    Chunk& chunk = m_chunks[chunkIndex];
+    chunk.triangles.clear();
+    chunk.bins.resize(static_cast<size_t>(m_tilesX) * m_tilesY);
+    for (std::vector<uint32_t>& bin : chunk.bins)
+    {
+        bin.clear();
+    }
+    chunk.trianglesCulled = 0;
+    chunk.trianglesClipped = 0;
+    chunk.trianglesPrefiltered = 0;
+    chunk.binnedTriangles = 0;
+
+    const size_t first = chunkIndex * CHUNK_TRIANGLES;
+    const size_t last = std::min(first + CHUNK_TRIANGLES, vertices.size() / 3);
+    chunk.candidates.resize(last - first);
+    size_t candidateCount = 0;
+    if (m_settings.prefilterTriangles && IsAvx2Supported())
+    {
+        candidateCount = PrefilterTrianglesAvx2(vertices.data(), first, last, constants, m_width, m_height, chunk.candidates.data());
+        chunk.trianglesPrefiltered = (last - first) - candidateCount;
+        chunk.trianglesCulled = chunk.trianglesPrefiltered;
+    }
+    else
+    {
+        for (size_t triangle = first; triangle < last; ++triangle)
+        {
+            chunk.candidates[candidateCount++] = static_cast<uint32_t>(triangle);
+        }
+    }
+
+    for (size_t candidate = 0; candidate < candidateCount; ++candidate)
+    {
+        const size_t triangle = chunk.candidates[candidate];
+        const ShadedVertex v0 = ShadeVertex(constants, vertices[3 * triangle]);
+        const ShadedVertex v1 = ShadeVertex(constants, vertices[3 * triangle + 1]);
+        const ShadedVertex v2 = ShadeVertex(constants, vertices[3 * triangle + 2]);
+
+        const uint32_t outcode0 = GetOutcode(v0);
+        const uint32_t outcode1 = GetOutcode(v1);
+        const uint32_t outcode2 = GetOutcode(v2);
+        const size_t triangleCountBefore = chunk.triangles.size();
+        if ((outcode0 & outcode1 & outcode2) != 0)
+        {
+            // completely outside of one of the planes
+        }
+        else if ((outcode0 | outcode1 | outcode2) == 0)
+        {
+            SetUpTriangle(v0, v1, v2, static_cast<uint32_t>(triangle), chunk);
+        }
+        else
+        {
+            ++chunk.trianglesClipped;
+            ShadedVertex polygon[MAX_CLIPPED_VERTICES] = { v0, v1, v2 };
+            const int count = ClipPolygon(polygon, 3, outcode0 | outcode1 | outcode2);
+            for (int i = 1; i + 1 < count; ++i)
+            {
+                SetUpTriangle(polygon[0], polygon[i], polygon[i + 1], static_cast<uint32_t>(triangle), chunk);
+            }
+        }
+
+        if (chunk.triangles.size() == triangleCountBefore)
+        {
+            ++chunk.trianglesCulled;
+        }
+    }
+}
+
+void SoftwareRasterizer::SetUpTriangle(const ShadedVertex& v0, const ShadedVertex& v1, const ShadedVertex& v2, uint32_t primitiveId, Chunk& chunk)
+{
+    const ShadedVertex* v[3] = { &v0, &v1, &v2 };
+
+    Triangle triangle;
+    for (int i = 0; i < 3; ++i)
+    {
+        // perspective division and viewport transform (y points down), snapped to the fixed-point grid
+        const float invW = 1.f / v[i]->position[3];
+        const float screenX = (0.5f + 0.5f * v[i]->position[0] * invW) * static_cast<float>(m_width);
+        const float screenY = (0.5f - 0.5f * v[i]->position[1] * invW) * static_cast<float>(m_height);
+        triangle.x[i] = static_cast<int32_t>(std::floor(screenX * SUBPIXEL_SCALE + 0.5f));
+        triangle.y[i] = static_cast<int32_t>(std::floor(screenY * SUBPIXEL_SCALE + 0.5f));
+        triangle.z[i] = v[i]->position[2] * invW;
+        triangle.invW[i] = invW;
+        for (int j = 0; j < 3; ++j)
+        {
+            triangle.viewPosition[i][j] = v[i]->viewPosition[j];
+            triangle.viewNormal[i][j] = v[i]->viewNormal[j];
+        }
+    }
+
+    triangle.primitiveId = primitiveId;
+    triangle.minZ = std::min({ triangle.z[0], triangle.z[1], triangle.z[2] });
+    triangle.maxZ = std::max({ triangle.z[0], triangle.z[1], triangle.z[2] });
+
+    // clockwise triangles (on screen, y down) have a positive area and are front faces, back faces are culled
+    triangle.area = static_cast<int64_t>(triangle.x[1] - triangle.x[0]) * (triangle.y[2] - triangle.y[0]) -
+        static_cast<int64_t>(triangle.x[2] - triangle.x[0]) * (triangle.y[1] - triangle.y[0]);
+    if (triangle.area <= 0)
+    {
+        return;
+    }
+
+    // pixels whose centers lie within the bounding box
+    const int32_t half = SUBPIXEL_SCALE / 2;
+    const int32_t minX = std::min({ triangle.x[0], triangle.x[1], triangle.x[2] });
+    const int32_t maxX = std::max({ triangle.x[0], triangle.x[1], triangle.x[2] });
+    const int32_t minY = std::min({ triangle.y[0], triangle.y[1], triangle.y[2] });
+    const int32_t maxY = std::max({ triangle.y[0], triangle.y[1], triangle.y[2] });
+    triangle.minX = std::max(FloorDivide(minX - half + SUBPIXEL_SCALE - 1, SUBPIXEL_SCALE), 0);
+    triangle.minY = std::max(FloorDivide(minY - half + SUBPIXEL_SCALE - 1, SUBPIXEL_SCALE), 0);
+    triangle.maxX = std::min(FloorDivide(maxX - half, SUBPIXEL_SCALE), static_cast<int32_t>(m_width) - 1);
+    triangle.maxY = std::min(FloorDivide(maxY - half, SUBPIXEL_SCALE), static_cast<int32_t>(m_height) - 1);
+    if (triangle.minX > triangle.maxX || triangle.minY > triangle.maxY)
+    {
+        return;
+    }
+
+    const uint32_t index = static_cast<uint32_t>(chunk.triangles.size());
+    chunk.triangles.push_back(triangle);
+    for (int32_t tileY = triangle.minY / TILE_SIZE; tileY <= triangle.maxY / TILE_SIZE; ++tileY)
+    {
+        for (int32_t tileX = triangle.minX / TILE_SIZE; tileX <= triangle.maxX / TILE_SIZE; ++tileX)
+        {
+            chunk.bins[static_cast<size_t>(tileY) * m_tilesX + tileX].push_back(index);
+            ++chunk.binnedTriangles;
+        }
+    }
+}
+
+void SoftwareRasterizer::RasterizeTile(uint32_t tileIndex, const std::vector<VertexPosNormal>& vertices, const VertexShaderConstants& constants,
+    const SceneLight& light, const SceneMaterial& material, ImageRGBA32F& color, Stats& stats)
+{
+    TileContext tile;
+    tile.minX = static_cast<int32_t>(tileIndex % m_tilesX) * TILE_SIZE;
+    tile.minY = static_cast<int32_t>(tileIndex / m_tilesX) * TILE_SIZE;
+    tile.maxX = std::min(tile.minX + TILE_SIZE, static_cast<int32_t>(m_width)) - 1;
+    tile.maxY = std::min(tile.minY + TILE_SIZE, static_cast<int32_t>(m_height)) - 1;
+    tile.stats = Stats{ };
+
+    // the tile owns its part of the render target and the depth buffer, so they are cleared here as well
+    for (int32_t y = tile.minY; y <= tile.maxY; ++y)
+    {
+        std::fill(color.Row(y) + tile.minX, color.Row(y) + tile.maxX + 1, BACKGROUND_COLOR);
+        uint32_t* depthRow = m_depth.data() + static_cast<size_t>(y) * m_width;
+        std::fill(depthRow + tile.minX, depthRow + tile.maxX + 1, DEPTH_MAX);
+        if (m_settings.visibilityBuffer)
+        {
+            uint32_t* visibilityRow = m_visibility.data() + static_cast<size_t>(y) * m_width;
+            std::fill(visibilityRow + tile.minX, visibilityRow + tile.maxX + 1, NO_PRIMITIVE);
+        }
+    }
+
+    // blocks outside of the viewport (in tiles at the right and bottom border) never occlude anything
+    for (int32_t blockY = 0; blockY < TILE_BLOCKS; ++blockY)
+    {
+        for (int32_t blockX = 0; blockX < TILE_BLOCKS; ++blockX)
+        {
+            const bool inside = tile.minX + blockX * BLOCK_SIZE <= tile.maxX && tile.minY + blockY * BLOCK_SIZE <= tile.maxY;
+            tile.blockMinDepth[blockY * TILE_BLOCKS + blockX] = inside ? DEPTH_MAX : 0;
+            tile.blockMaxDepth[blockY * TILE_BLOCKS + blockX] = inside ? DEPTH_MAX : 0;
+        }
+    }
+    tile.maxDepth = DEPTH_MAX;
+
+    for (const Chunk& chunk : m_chunks)
+    {
+        for (uint32_t triangleIndex : chunk.bins[tileIndex])
+        {
+            RasterizeTriangle(chunk.triangles[triangleIndex], tile, light, material, color);
+        }
+    }
+    if (m_settings.visibilityBuffer)
+    {
+        ShadeVisibilityBuffer(tile, vertices, constants, light, material, color);
+    }
+    tile.batch.Shade(light, material, color);
+    stats = tile.stats;
+}
+
+void SoftwareRasterizer::RasterizeTriangle(const Triangle& triangle, TileContext& tile, const SceneLight& light, const SceneMaterial& material,
+    ImageRGBA32F& color)
+{
+    const int32_t minX = std::max(triangle.minX, tile.minX);
+    const int32_t minY = std::max(triangle.minY, tile.minY);
+    const int32_t maxX = std::min(triangle.maxX, tile.maxX);
+    const int32_t maxY = std::min(triangle.maxY, tile.maxY);
+    if (minX > maxX || minY > maxY)
+    {
+        return;
+    }
+
+    // the whole triangle is behind all pixels of the tile
+    const bool hierarchicalDepth = m_settings.hierarchicalDepth;
+    const bool visibilityBuffer = m_settings.visibilityBuffer;
+    const uint32_t triangleMinDepth = QuantizeDepth(triangle.minZ);
+    const uint32_t triangleMaxDepth = QuantizeDepth(triangle.maxZ);
+    if (hierarchicalDepth && triangleMinDepth >= tile.maxDepth + DEPTH_MARGIN)
+    {
+        ++tile.stats.trianglesOccluded;
+        return;
+    }
+
+    // edge function k is opposite to vertex k and positive inside, pixels on an edge are only covered if it is a top
+    // or left edge (the bias makes the test for other edges strict)
+    int64_t stepX[3];
+    int64_t stepY[3];
+    int64_t bias[3];
+    int64_t startEdge[3];
+    const int64_t startX = static_cast<int64_t>(minX) * SUBPIXEL_SCALE + SUBPIXEL_SCALE / 2;
+    const int64_t startY = static_cast<int64_t>(minY) * SUBPIXEL_SCALE + SUBPIXEL_SCALE / 2;
+    for (int k = 0; k < 3; ++k)
+    {
+        const int64_t ax = triangle.x[(k + 1) % 3];
+        const int64_t ay = triangle.y[(k + 1) % 3];
+        const int64_t bx = triangle.x[(k + 2) % 3];
+        const int64_t by = triangle.y[(k + 2) % 3];
+
+        const bool topLeft = (by < ay) || (by == ay && bx > ax);
+        bias[k] = topLeft ? 0 : -1;
+        startEdge[k] = (ay - by) * (startX - ax) + (bx - ax) * (startY - ay) + bias[k];
+        stepX[k] = (ay - by) * SUBPIXEL_SCALE;
+        stepY[k] = (bx - ax) * SUBPIXEL_SCALE;
+    }
+
+    // screen space barycentrics from the (unbiased) edge functions, depth is affine in screen space
+    const float invArea = 1.f / static_cast<float>(triangle.area);
+    const float z0 = triangle.z[0];
+    const float deltaZ1 = triangle.z[1] - z0;
+    const float deltaZ2 = triangle.z[2] - z0;
+    auto interpolateDepth = [&](int64_t e1, int64_t e2)
+    {
+        return z0 + static_cast<float>(e1 - bias[1]) * invArea * deltaZ1 + static_cast<float>(e2 - bias[2]) * invArea * deltaZ2;
+    };
+
+    // the depth at the corners of the blocks only gives tighter bounds than the vertices if the triangle spans several blocks
+    const bool singleBlock = minX / BLOCK_SIZE == maxX / BLOCK_SIZE && minY / BLOCK_SIZE == maxY / BLOCK_SIZE;
+    bool tileMaxDepthChanged = false;
+
+    for (int32_t blockMinY = minY - (minY - tile.minY) % BLOCK_SIZE; blockMinY <= maxY; blockMinY += BLOCK_SIZE)
+    {
+        for (int32_t blockMinX = minX - (minX - tile.minX) % BLOCK_SIZE; blockMinX <= maxX; blockMinX += BLOCK_SIZE)
+        {
+            // part of the bounding box in the block
+            const int32_t x0 = std::max(minX, blockMinX);
+            const int32_t y0 = std::max(minY, blockMinY);
+            const int32_t x1 = std::min(maxX, blockMinX + BLOCK_SIZE - 1);
+            const int32_t y1 = std::min(maxY, blockMinY + BLOCK_SIZE - 1);
+
+            // edge functions at the corners of the rectangle, no pixel is covered if it is outside of one edge at all corners
+            int64_t e00[3];
+            int64_t e10[3];
+            int64_t e01[3];
+            int64_t e11[3];
+            bool covered = true;
+            for (int k = 0; k < 3; ++k)
+            {
+                e00[k] = startEdge[k] + (x0 - minX) * stepX[k] + (y0 - minY) * stepY[k];
+                e10[k] = e00[k] + (x1 - x0) * stepX[k];
+                e01[k] = e00[k] + (y1 - y0) * stepY[k];
+                e11[k] = e10[k] + (y1 - y0) * stepY[k];
+                covered = covered && std::max({ e00[k], e10[k], e01[k], e11[k] }) >= 0;
+            }
+            if (!covered)
+            {
+                continue;
+            }
+
+            const uint32_t block = static_cast<uint32_t>(((blockMinY - tile.minY) / BLOCK_SIZE) * TILE_BLOCKS + (blockMinX - tile.minX) / BLOCK_SIZE);
+            bool depthTest = true;
+            if (hierarchicalDepth)
+            {
+                // the depth of the triangle in the rectangle also lies between the min. and max. depth at its corners
+                ++tile.stats.blocksTested;
+                uint32_t minDepth = triangleMinDepth;
+                uint32_t maxDepth = triangleMaxDepth;
+                if (!singleBlock && minDepth < tile.blockMaxDepth[block] + DEPTH_MARGIN)
+                {
+                    const float z00 = interpolateDepth(e00[1], e00[2]);
+                    const float z10 = interpolateDepth(e10[1], e10[2]);
+                    const float z01 = interpolateDepth(e01[1], e01[2]);
+                    const float z11 = interpolateDepth(e11[1], e11[2]);
+                    minDepth = QuantizeDepth(std::max(std::min({ z00, z10, z01, z11 }), triangle.minZ));
+                    maxDepth = QuantizeDepth(std::min(std::max({ z00, z10, z01, z11 }), triangle.maxZ));
+                }
+                if (minDepth >= tile.blockMaxDepth[block] + DEPTH_MARGIN)
+                {
+                    ++tile.stats.blocksOccluded;
+                    continue;
+                }
+                // otherwise all covered pixels pass the depth test
+                depthTest = maxDepth + DEPTH_MARGIN >= tile.blockMinDepth[block];
+            }
+
+            // the min. depth of the block is updated with each write, the max. depth only has to be recomputed if a pixel at
+            // the max. depth has been overwritten
+            uint32_t writtenMinDepth = DEPTH_MAX;
+            bool maxDepthOverwritten = false;
+            ShadingBatch& batch = tile.batch;
+            int64_t rowEdge[3] = { e00[0], e00[1], e00[2] };
+            for (int32_t y = y0; y <= y1; ++y)
+            {
+                uint32_t* depthRow = m_depth.data() + static_cast<size_t>(y) * m_width;
+                uint32_t* visibilityRow = visibilityBuffer ? m_visibility.data() + static_cast<size_t>(y) * m_width : nullptr;
+                int64_t e0 = rowEdge[0];
+                int64_t e1 = rowEdge[1];
+                int64_t e2 = rowEdge[2];
+
+                for (int32_t x = x0; x <= x1; ++x, e0 += stepX[0], e1 += stepX[1], e2 += stepX[2])
+                {
+                    if ((e0 | e1 | e2) < 0)
+                    {
+                        continue;
+                    }
+
+                    const float b1 = static_cast<float>(e1 - bias[1]) * invArea;
+                    const float b2 = static_cast<float>(e2 - bias[2]) * invArea;
+                    const uint32_t depth = QuantizeDepth(z0 + b1 * deltaZ1 + b2 * deltaZ2);
+                    if (depthTest && depth >= depthRow[x])
+                    {
+                        continue;
+                    }
+                    maxDepthOverwritten = maxDepthOverwritten || depthRow[x] == tile.blockMaxDepth[block];
+                    writtenMinDepth = std::min(writtenMinDepth, depth);
+                    depthRow[x] = depth;
+                    if (visibilityBuffer)
+                    {
+                        visibilityRow[x] = triangle.primitiveId;
+                        continue;
+                    }
+
+                    // perspective correct interpolation of the attributes
+                    const float w0 = (1.f - b1 - b2) * triangle.invW[0];
+                    const float w1 = b1 * triangle.invW[1];
+                    const float w2 = b2 * triangle.invW[2];
+                    const float invSum = 1.f / (w0 + w1 + w2);
+                    const uint32_t index = batch.count++;
+                    batch.x[index] = x;
+                    batch.y[index] = y;
+                    batch.size[index] = 1;
+                    for (int i = 0; i < 3; ++i)
+                    {
+                        batch.viewPosition[i][index] = (w0 * triangle.viewPosition[0][i] + w1 * triangle.viewPosition[1][i] + w2 * triangle.viewPosition[2][i]) * invSum;
+                        batch.viewNormal[i][index] = (w0 * triangle.viewNormal[0][i] + w1 * triangle.viewNormal[1][i] + w2 * triangle.viewNormal[2][i]) * invSum;
+                    }
+                    if (batch.count == ShadingBatch::CAPACITY)
+                    {
+                        batch.Shade(light, material, color);
+                    }
+                    ++tile.stats.pixelsShaded;
+                }
+
+                rowEdge[0] += stepY[0];
+                rowEdge[1] += stepY[1];
+                rowEdge[2] += stepY[2];
+            }
+
+            tile.blockMinDepth[block] = std::min(tile.blockMinDepth[block], writtenMinDepth);
+            if (hierarchicalDepth && maxDepthOverwritten)
+            {
+                // the max. depth of the tile can only change if the block was at the max.
+                tileMaxDepthChanged = tileMaxDepthChanged || tile.blockMaxDepth[block] == tile.maxDepth;
+                UpdateBlockMaxDepth(tile, block);
+            }
+        }
+    }
+
+    if (tileMaxDepthChanged)
+    {
+        tile.maxDepth = *std::max_element(tile.blockMaxDepth, tile.blockMaxDepth + TILE_BLOCKS * TILE_BLOCKS);
+    }
+}
+
+void SoftwareRasterizer::ShadeVisibilityBuffer(TileContext& tile, const std::vector<VertexPosNormal>& vertices, const VertexShaderConstants& constants,
+    const SceneLight& light, const SceneMaterial& material, ImageRGBA32F& color)
+{
+    FetchedTriangle cache[1u << TRIANGLE_CACHE_BITS];
+    for (FetchedTriangle& entry : cache)
+    {
+        entry.primitive = NO_PRIMITIVE;
+    }
+
+    // interpolated attributes of a covered pixel
+    auto reconstruct = [&](int32_t x, int32_t y, uint32_t primitive, float viewPosition[3], float viewNormal[3])
+    {
+        FetchedTriangle& triangle = cache[(primitive * 2654435761u) >> (32 - TRIANGLE_CACHE_BITS)];
+        if (triangle.primitive != primitive)
+        {
+            triangle.primitive = primitive;
+            ShadedVertex v[3];
+            for (int i = 0; i < 3; ++i)
+            {
+                v[i] = ShadeVertex(constants, vertices[3 * static_cast<size_t>(primitive) + i]);
+            }
+
+            // snapped like in SetUpTriangle() unless the triangle was clipped (then the setup used the clipped vertices)
+            const bool snap = (GetOutcode(v[0]) | GetOutcode(v[1]) | GetOutcode(v[2])) == 0;
+            for (int i = 0; i < 3; ++i)
+            {
+                const float* position = v[i].position;
+                if (snap)
+                {
+                    const float invW = 1.f / position[3];
+                    const float screenX = (0.5f + 0.5f * position[0] * invW) * static_cast<float>(m_width);
+                    const float screenY = (0.5f - 0.5f * position[1] * invW) * static_cast<float>(m_height);
+                    triangle.homogeneous[i][0] = std::floor(screenX * SUBPIXEL_SCALE + 0.5f) / SUBPIXEL_SCALE * position[3];
+                    triangle.homogeneous[i][1] = std::floor(screenY * SUBPIXEL_SCALE + 0.5f) / SUBPIXEL_SCALE * position[3];
+                }
+                else
+                {
+                    triangle.homogeneous[i][0] = (0.5f * position[3] + 0.5f * position[0]) * static_cast<float>(m_width);
+                    triangle.homogeneous[i][1] = (0.5f * position[3] - 0.5f * position[1]) * static_cast<float>(m_height);
+                }
+                triangle.homogeneous[i][2] = position[3];
+                for (int j = 0; j < 3; ++j)
+                {
+                    triangle.viewPosition[i][j] = v[i].viewPosition[j];
+                    triangle.viewNormal[i][j] = v[i].viewNormal[j];
+                }
+            }
+        }
+
+        // the perspective correct barycentrics are proportional to the 2D edge functions of the homogeneous positions
+        // relative to the pixel center (i.e., the homogeneous rasterization of Olano and Greer), which is evaluated
+        // per pixel to avoid the cancellation in the plane equations of small triangles
+        const float pixelX = static_cast<float>(x) + 0.5f;
+        const float pixelY = static_cast<float>(y) + 0.5f;
+        float dx[3];
+        float dy[3];
+        for (int i = 0; i < 3; ++i)
+        {
+            dx[i] = triangle.homogeneous[i][0] - pixelX * triangle.homogeneous[i][2];
+            dy[i] = triangle.homogeneous[i][1] - pixelY * triangle.homogeneous[i][2];
+        }
+        const float b[3] = { dx[1] * dy[2] - dy[1] * dx[2], dx[2] * dy[0] - dy[2] * dx[0], dx[0] * dy[1] - dy[0] * dx[1] };
+        const float invSum = 1.f / (b[0] + b[1] + b[2]);
+
+        for (int i = 0; i < 3; ++i)
+        {
+            viewPosition[i] = (b[0] * triangle.viewPosition[0][i] + b[1] * triangle.viewPosition[1][i] + b[2] * triangle.viewPosition[2][i]) * invSum;
+            viewNormal[i] = (b[0] * triangle.viewNormal[0][i] + b[1] * triangle.viewNormal[1][i] + b[2] * triangle.viewNormal[2][i]) * invSum;
+        }
+    };
+
+    ShadingBatch& batch = tile.batch;
+    auto addSample = [&](int32_t x, int32_t y, int32_t size, const float position[3], const float normal[3])
+    {
+        const uint32_t index = batch.count++;
+        batch.x[index] = x;
+        batch.y[index] = y;
+        batch.size[index] = size;
+        for (int i = 0; i < 3; ++i)
+        {
+            batch.viewPosition[i][index] = position[i];
+            batch.viewNormal[i][index] = normal[i];
+        }
+        if (batch.count == ShadingBatch::CAPACITY)
+        {
+            batch.Shade(light, material, color);
+        }
+        ++tile.stats.pixelsShaded;
+    };
+
+    const float threshold = m_settings.shadingRateThreshold;
+    if (threshold <= 0.f)
+    {
+        for (int32_t y = tile.minY; y <= tile.maxY; ++y)
+        {
+            const uint32_t* visibilityRow = m_visibility.data() + static_cast<size_t>(y) * m_width;
+            for (int32_t x = tile.minX; x <= tile.maxX; ++x)
+            {
+                if (visibilityRow[x] != NO_PRIMITIVE)
+                {
+                    float position[3];
+                    float normal[3];
+                    reconstruct(x, y, visibilityRow[x], position, normal);
+                    addSample(x, y, 1, position, normal);
+                }
+            }
+        }
+        return;
+    }
+
+    // adaptive shading rate: the specular term alone shows the highlights
+    SceneMaterial specularMaterial = material;
+    for (int i = 0; i < 3; ++i)
+    {
+        specularMaterial.ambient[i] = 0.f;
+        specularMaterial.diffuse[i] = 0.f;
+    }
+
+    // triangles and attributes of the pixels of a block (row by row), the attributes are only reconstructed when needed
+    constexpr int32_t BLOCK_PIXELS = SHADING_BLOCK_SIZE * SHADING_BLOCK_SIZE;
+    uint32_t primitives[BLOCK_PIXELS];
+    bool reconstructed[BLOCK_PIXELS];
+    float positions[BLOCK_PIXELS][3];
+    float normals[BLOCK_PIXELS][3];
+    int32_t blockX = 0;
+    int32_t blockY = 0;
+    auto attributes = [&](int32_t i)
+    {
+        if (!reconstructed[i])
+        {
+            reconstruct(blockX + i % SHADING_BLOCK_SIZE, blockY + i / SHADING_BLOCK_SIZE, primitives[i], positions[i], normals[i]);
+            reconstructed[i] = true;
+        }
+    };
+
+    // shades size x size pixels of the block once, if they are all covered, the variance of the (unit) normals and of the
+    // relative depth at the corners is below the threshold, and the specular term at the center is below the threshold
+    auto shadeCoarse = [&](int32_t offsetX, int32_t offsetY, int32_t size)
+    {
+        for (int32_t y = offsetY; y < offsetY + size; ++y)
+        {
+            for (int32_t x = offsetX; x < offsetX + size; ++x)
+            {
+                if (primitives[y * SHADING_BLOCK_SIZE + x] == NO_PRIMITIVE)
+                {
+                    return false;
+                }
+            }
+        }
+
+        const int32_t corners[4] = { offsetY * SHADING_BLOCK_SIZE + offsetX, offsetY * SHADING_BLOCK_SIZE + offsetX + size - 1,
+            (offsetY + size - 1) * SHADING_BLOCK_SIZE + offsetX, (offsetY + size - 1) * SHADING_BLOCK_SIZE + offsetX + size - 1 };
+        float position[3] = { 0.f, 0.f, 0.f };
+        float normal[3] = { 0.f, 0.f, 0.f };
+        for (int32_t corner : corners)
+        {
+            attributes(corner);
+            const float* n = normals[corner];
+            const float invLength = 1.f / std::max(std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]), 1e-12f);
+            for (int i = 0; i < 3; ++i)
+            {
+                position[i] += 0.25f * positions[corner][i];
+                normal[i] += 0.25f * n[i] * invLength;
+            }
+        }
+
+        // the mean squared distance of unit vectors to their mean m is 1 - |m|^2
+        const float normalVariance = 1.f - (normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+        float depthVariance = 0.f;
+        for (int32_t corner : corners)
+        {
+            const float relativeDepth = positions[corner][2] / position[2] - 1.f;
+            depthVariance += 0.25f * relativeDepth * relativeDepth;
+        }
+        if (normalVariance >= threshold || depthVariance >= threshold)
+        {
+            return false;
+        }
+
+        const ColorRGBA32F specular = ShadeBlinnPhong(light, specularMaterial, position, normal);
+        if (std::max({ specular.r, specular.g, specular.b }) >= HIGHLIGHT_THRESHOLD)
+        {
+            return false;
+        }
+
+        addSample(blockX + offsetX, blockY + offsetY, size, position, normal);
+        tile.stats.pixelsShadedCoarse += static_cast<size_t>(size) * size;
+        return true;
+    };
+
+    for (blockY = tile.minY; blockY <= tile.maxY; blockY += SHADING_BLOCK_SIZE)
+    {
+        for (blockX = tile.minX; blockX <= tile.maxX; blockX += SHADING_BLOCK_SIZE)
+        {
+            for (int32_t i = 0; i < BLOCK_PIXELS; ++i)
+            {
+                const int32_t x = blockX + i % SHADING_BLOCK_SIZE;
+                const int32_t y = blockY + i / SHADING_BLOCK_SIZE;
+                primitives[i] = (x <= tile.maxX && y <= tile.maxY) ? m_visibility[static_cast<size_t>(y) * m_width + x] : NO_PRIMITIVE;
+                reconstructed[i] = false;
+            }
+
+            if (shadeCoarse(0, 0, SHADING_BLOCK_SIZE))
+            {
+                continue;
+            }
+
+            // quarters of the block at the coarse rate, or per pixel
+            const int32_t half = SHADING_BLOCK_SIZE / 2;
+            for (int32_t quarter = 0; quarter < 4; ++quarter)
+            {
+                const int32_t offsetX = (quarter % 2) * half;
+                const int32_t offsetY = (quarter / 2) * half;
+                if (shadeCoarse(offsetX, offsetY, half))
+                {
+                    continue;
+                }
+                for (int32_t y = offsetY; y < offsetY + half; ++y)
+                {
+                    for (int32_t x = offsetX; x < offsetX + half; ++x)
+                    {
+                        const int32_t i = y * SHADING_BLOCK_SIZE + x;
+                        if (primitives[i] != NO_PRIMITIVE)
+                        {
+                            attributes(i);
+                            addSample(blockX + x, blockY + y, 1, positions[i], normals[i]);
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+void SoftwareRasterizer::UpdateBlockMaxDepth(TileContext& tile, uint32_t block) const noexcept
+{
+    const int32_t blockMinX = tile.minX + static_cast<int32_t>(block % TILE_BLOCKS) * BLOCK_SIZE;
+    const int32_t blockMinY = tile.minY + static_cast<int32_t>(block / TILE_BLOCKS) * BLOCK_SIZE;
+    const int32_t blockMaxX = std::min(blockMinX + BLOCK_SIZE - 1, tile.maxX);
+    const int32_t blockMaxY = std::min(blockMinY + BLOCK_SIZE - 1, tile.maxY);
+
+    uint32_t maxDepth = 0;
+    for (int32_t y = blockMinY; y <= blockMaxY; ++y)
+    {
+        const uint32_t* depthRow = m_depth.data() + static_cast<size_t>(y) * m_width;
+        for (int32_t x = blockMinX; x <= blockMaxX; ++x)
+        {
+            maxDepth = std::max(maxDepth, depthRow[x]);
+        }
+    }
+    tile.blockMaxDepth[block] = maxDepth;
+}
@@ -0,0 +1,284 @@
+#include "cpu/separablekernel.h"
+
+#include "util/threadpool.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+namespace
+{
+    // number of rows processed per task
+    constexpr size_t ROWS_PER_TASK = 8;
+
+    // the Jacobi iteration stops if no pair of columns is more than this far from orthogonal (relative)
+    constexpr double JACOBI_EPSILON = 1e-12;
+    constexpr uint32_t JACOBI_MAX_SWEEPS = 64;
+
+    /**
+     * One-sided Jacobi SVD of the rows x columns matrix a (row-major), a = U S V^T.
+     *
+     * On return, the columns of a hold U * S (i.e., the column norms are the singular values), and v holds V
+     * (columns x columns, row-major). The columns are not sorted.
+     */
+    void JacobiSvd(std::vector<double>& a, uint32_t rows, uint32_t columns, std::vector<double>& v)
+    {
+        v.assign(static_cast<size_t>(columns) * columns, 0.0);
+        for (uint32_t i = 0; i < columns; ++i)
+        {
+            v[static_cast<size_t>(i) * columns + i] = 1.0;
+        }
+
+        for (uint32_t sweep = 0; sweep < JACOBI_MAX_SWEEPS; ++sweep)
+        {
+            bool rotated = false;
+            for (uint32_t p = 0; p + 1 < columns; ++p)
+            {
+                for (uint32_t q = p + 1; q < columns; ++q)
+                {
+                    double alpha = 0.0;
+                    double beta = 0.0;
+                    double gamma = 0.0;
+                    for (uint32_t r = 0; r < rows; ++r)
+                    {
+                        const double ap = a[static_cast<size_t>(r) * columns + p];
+                        const double aq = a[static_cast<size_t>(r) * columns + q];
+                        alpha += ap * ap;
+                        beta += aq * aq;
+                        gamma += ap * aq;
+                    }
+
+                    if (gamma == 0.0 || std::fabs(gamma) <= JACOBI_EPSILON * std::sqrt(alpha * beta))
+                    {
+                        continue;
+                    }
+                    rotated = true;
+
+                    // rotation that makes columns p and q orthogonal
+                    const double zeta = (beta - alpha) / (2.0 * gamma);
+                    const double t = (zeta >= 0.0 ? 1.0 : -1.0) / (std::fabs(zeta) + std::sqrt(1.0 + zeta * zeta));
+                    const double c = 1.0 / std::sqrt(1.0 + t * t);
+                    const double s = c * t;
+
+                    for (uint32_t r = 0; r < rows; ++r)
+                    {
+                        double& ap = a[static_cast<size_t>(r) * columns + p];
+                        double& aq = a[static_cast<size_t>(r) * columns + q];
+                        const double newP = c * ap - s * aq;
+                        aq = s * ap + c * aq;
+                        ap = newP;
+                    }
+                    for (uint32_t r = 0; r < columns; ++r)
+                    {
+                        double& vp = v[static_cast<size_t>(r) * columns + p];
+                        double& vq = v[static_cast<size_t>(r) * columns + q];
+                        const double newP = c * vp - s * vq;
+                        vq = s * vp + c * vq;
+                        vp = newP;
+                    }
+                }
+            }
+
+            if (!rotated)
+            {
+                break;
+            }
+        }
+    }
+
+    // output(x, y) (+)= sum over i of weights[i] * input(x - (i - center), y), RGB only, zero outside of input
+    void ConvolveRow(const ColorRGBA32F* input, const std::vector<float>& weights, int width, ColorRGBA32F* output)
+    {
+        const int center = static_cast<int>(weights.size() / 2);
+        for (int i = 0; i < static_cast<int>(weights.size()); ++i)
+        {
+            const float weight = weights[i];
+            if (weight == 0.f)
+            {
+                continue;
+            }
+
+            const int offset = i - center;
+            const int xBegin = std::max(offset, 0);
+            const int xEnd = std::min(width + offset, width);
+            for (int x = xBegin; x < xEnd; ++x)
+            {
+                const ColorRGBA32F& value = input[x - offset];
+                output[x].r += weight * value.r;
+                output[x].g += weight * value.g;
+                output[x].b += weight * value.b;
+            }
+        }
+    }
+}
+
+SeparableKernel DecomposeKernel(const Kernel2D& kernel, double tolerance, uint32_t maxRank)
+{
+    SeparableKernel result;
+    result.width = kernel.width;
+    result.height = kernel.height;
+
+    // decompose the transposed matrix if the kernel is wider than high, the Jacobi iteration is cubic in the number of columns
+    const bool transposed = kernel.width > kernel.height;
+    const uint32_t rows = transposed ? kernel.width : kernel.height;
+    const uint32_t columns = transposed ? kernel.height : kernel.width;
+
+    std::vector<double> a(static_cast<size_t>(rows) * columns);
+    for (uint32_t y = 0; y < kernel.height; ++y)
+    {
+        for (uint32_t x = 0; x < kernel.width; ++x)
+        {
+            const size_t index = transposed ? static_cast<size_t>(x) * columns + y : static_cast<size_t>(y) * columns + x;
+            a[index] = kernel.At(x, y);
+        }
+    }
+
+    std::vector<double> v;
+    JacobiSvd(a, rows, columns, v);
+
+    std::vector<double> singularValues(columns, 0.0);
+    for (uint32_t c = 0; c < columns; ++c)
+    {
+        double sum = 0.0;
+        for (uint32_t r = 0; r < rows; ++r)
+        {
+            sum += a[static_cast<size_t>(r) * columns + c] * a[static_cast<size_t>(r) * columns + c];
+        }
+        singularValues[c] = std::sqrt(sum);
+    }
+
+    std::vector<uint32_t> order(columns);
+    std::iota(order.begin(), order.end(), 0u);
+    std::sort(order.begin(), order.end(), [&](uint32_t lhs, uint32_t rhs) { return singularValues[lhs] > singularValues[rhs]; });
+
+    result.singularValues.resize(columns);
+    for (uint32_t k = 0; k < columns; ++k)
+    {
+        result.singularValues[k] = singularValues[order[k]];
+    }
+
+    // the squared error of the rank k approximation is the sum of the remaining squared singular values
+    double totalEnergy = 0.0;
+    for (double sigma : result.singularValues)
+    {
+        totalEnergy += sigma * sigma;
+    }
+    std::vector<double> remainingEnergy(columns + 1, 0.0);
+    for (uint32_t k = columns; k > 0; --k)
+    {
+        remainingEnergy[k - 1] = remainingEnergy[k] + result.singularValues[k - 1] * result.singularValues[k - 1];
+    }
+
+    const uint32_t rankLimit = (maxRank == 0) ? columns : std::min(maxRank, columns);
+    uint32_t rank = 0;
+    while (rank < rankLimit && (totalEnergy == 0.0 ? false : std::sqrt(remainingEnergy[rank] / totalEnergy) > tolerance))
+    {
+        ++rank;
+    }
+    result.relativeError = (totalEnergy > 0.0) ? std::sqrt(remainingEnergy[rank] / totalEnergy) : 0.0;
+
+    // split the singular value evenly between the two 1D kernels
+    for (uint32_t k = 0; k < rank; ++k)
+    {
+        const uint32_t column = order[k];
+        const double sigma = singularValues[column];
+        if (sigma == 0.0)
+        {
+            break;
+        }
+        const double scaleU = 1.0 / std::sqrt(sigma);
+        const double scaleV = std::sqrt(sigma);
+
+        // u (length rows) = column of a / sigma, v (length columns) = column of V
+        std::vector<float> u(rows);
+        std::vector<float> w(columns);
+        for (uint32_t r = 0; r < rows; ++r)
+        {
+            u[r] = static_cast<float>(a[static_cast<size_t>(r) * columns + column] * scaleU);
+        }
+        for (uint32_t r = 0; r < columns; ++r)
+        {
+            w[r] = static_cast<float>(v[static_cast<size_t>(r) * columns + column] * scaleV);
+        }
+
+        SeparableTerm term;
+        term.horizontal = transposed ? std::move(u) : std::move(w);
+        term.vertical = transposed ? std::move(w) : std::move(u);
+        result.terms.push_back(std::move(term));
+    }
+
+    return result;
+}
+
+Kernel2D ReconstructKernel(const SeparableKernel& kernel)
+{
+    Kernel2D result;
+    result.Resize(kernel.width, kernel.height);
+    std::fill(result.pixels.begin(), result.pixels.end(), 0.f);
+
+    for (const SeparableTerm& term : kernel.terms)
+    {
+        for (uint32_t y = 0; y < kernel.height; ++y)
+        {
+            for (uint32_t x = 0; x < kernel.width; ++x)
+            {
+                result.At(x, y) += term.horizontal[x] * term.vertical[y];
+            }
+        }
+    }
+
+    return result;
+}
+
+void ConvolveSeparable(const ImageRGBA32F& input, const SeparableKernel& kernel, ImageRGBA32F& temp, ImageRGBA32F& output, ThreadPool* pool)
+{
+    output.Resize(input.width, input.height);
+    temp.Resize(input.width, input.height);
+    std::fill(output.pixels.begin(), output.pixels.end(), ColorRGBA32F{ 0.f, 0.f, 0.f, 1.f });
+
+    const int width = static_cast<int>(input.width);
+    const int height = static_cast<int>(input.height);
+
+    for (const SeparableTerm& term : kernel.terms)
+    {
+        // horizontal pass into temp
+        ParallelFor(pool, 0, input.height, ROWS_PER_TASK, [&](size_t rowBegin, size_t rowEnd)
+        {
+            for (size_t y = rowBegin; y < rowEnd; ++y)
+            {
+                ColorRGBA32F* tempRow = temp.Row(static_cast<uint32_t>(y));
+                std::fill(tempRow, tempRow + width, ColorRGBA32F{ 0.f, 0.f, 0.f, 0.f });
+                ConvolveRow(input.Row(static_cast<uint32_t>(y)), term.horizontal, width, tempRow);
+            }
+        });
+
+        // vertical pass accumulated into output (row-wise, so that the inner loop runs over contiguous pixels)
+        const int center = static_cast<int>(term.vertical.size() / 2);
+        ParallelFor(pool, 0, input.height, ROWS_PER_TASK, [&](size_t rowBegin, size_t rowEnd)
+        {
+            for (size_t row = rowBegin; row < rowEnd; ++row)
+            {
+                const int y = static_cast<int>(row);
+                ColorRGBA32F* outputRow = output.Row(static_cast<uint32_t>(y));
+
+                for (int j = 0; j < static_cast<int>(term.vertical.size()); ++j)
+                {
+                    const int sourceY = y - (j - center);
+                    const float weight = term.vertical[j];
+                    if (sourceY < 0 || sourceY >= height || weight == 0.f)
+                    {
+                        continue;
+                    }
+
+                    const ColorRGBA32F* tempRow = temp.Row(static_cast<uint32_t>(sourceY));
+                    for (int x = 0; x < width; ++x)
+                    {
+                        outputRow[x].r += weight * tempRow[x].r;
+                        outputRow[x].g += weight * tempRow[x].g;
+                        outputRow[x].b += weight * tempRow[x].b;
+                    }
+                }
+            }
+        });
+    }
+}
@@ -0,0 +1,153 @@
+#include "cpu/sparsebloom.h"
+
+#include "util/threadpool.h"
+
+#include <algorithm>
+
+namespace
+{
+    constexpr uint32_t TILE_SIZE = BLOOM_TILE_SIZE;
+
+    inline uint32_t PackTile(uint32_t tileX, uint32_t tileY) noexcept
+    {
+        return tileX | (tileY << 16);
+    }
+}
+
+void ClassifyBloomTiles(const std::vector<uint8_t>& brightMask, uint32_t tilesX, uint32_t tilesY, uint32_t tileRadius, BloomTileLists& lists)
+{
+    lists.tilesX = tilesX;
+    lists.tilesY = tilesY;
+    lists.horizontal.clear();
+    lists.vertical.clear();
+
+    // bright tiles within the radius in x, per tile (a sliding window over each row)
+    std::vector<uint8_t> horizontalMask(brightMask.size(), 0);
+    for (uint32_t tileY = 0; tileY < tilesY; ++tileY)
+    {
+        const uint8_t* maskRow = brightMask.data() + static_cast<size_t>(tileY) * tilesX;
+        uint8_t* horizontalRow = horizontalMask.data() + static_cast<size_t>(tileY) * tilesX;
+
+        int32_t lastBright = -1 - static_cast<int32_t>(tileRadius);
+        for (uint32_t tileX = 0; tileX < tilesX + tileRadius; ++tileX)
+        {
+            if (tileX < tilesX && maskRow[tileX])
+            {
+                lastBright = static_cast<int32_t>(tileX);
+            }
+            // the tile tileX - tileRadius is done once all tiles up to tileRadius to its right have been seen
+            if (tileX >= tileRadius && static_cast<int32_t>(tileX) - lastBright <= 2 * static_cast<int32_t>(tileRadius))
+            {
+                horizontalRow[tileX - tileRadius] = 1;
+            }
+        }
+    }
+
+    for (uint32_t tileY = 0; tileY < tilesY; ++tileY)
+    {
+        const uint32_t yBegin = tileY - std::min(tileY, tileRadius);
+        const uint32_t yEnd = std::min(tileY + tileRadius + 1, tilesY);
+
+        for (uint32_t tileX = 0; tileX < tilesX; ++tileX)
+        {
+            const size_t tile = static_cast<size_t>(tileY) * tilesX + tileX;
+            if (horizontalMask[tile])
+            {
+                lists.horizontal.push_back(PackTile(tileX, tileY));
+            }
+
+            for (uint32_t y = yBegin; y < yEnd; ++y)
+            {
+                if (horizontalMask[static_cast<size_t>(y) * tilesX + tileX])
+                {
+                    lists.vertical.push_back(PackTile(tileX, tileY));
+                    break;
+                }
+            }
+        }
+    }
+}
+
+template <typename PixelFunc>
+void SparseBloom::ForEachTilePixel(const std::vector<uint32_t>& tiles, uint32_t width, uint32_t height, ThreadPool* pool, const PixelFunc& func)
+{
+    ParallelFor(pool, 0, tiles.size(), 4, [&](size_t begin, size_t end)
+    {
+        for (size_t i = begin; i < end; ++i)
+        {
+            const uint32_t x0 = (tiles[i] & 0xffff) * TILE_SIZE;
+            const uint32_t y0 = (tiles[i] >> 16) * TILE_SIZE;
+            const uint32_t x1 = std::min(x0 + TILE_SIZE, width);
+            const uint32_t y1 = std::min(y0 + TILE_SIZE, height);
+
+            for (uint32_t y = y0; y < y1; ++y)
+            {
+                for (uint32_t x = x0; x < x1; ++x)
+                {
+                    func(x, y);
+                }
+            }
+        }
+    });
+}
+
+void SparseBloom::Process(const ImageRGBA32F& scene, const BloomSettings& settings, BloomBuffers& buffers, ThreadPool* pool)
+{
+    const uint32_t width = scene.width / 2;
+    const uint32_t height = scene.height / 2;
+    const uint32_t tilesX = (width + TILE_SIZE - 1) / TILE_SIZE;
+    const uint32_t tilesY = (height + TILE_SIZE - 1) / TILE_SIZE;
+
+    buffers.bloom.Resize(width, height);
+    buffers.temp.Resize(width, height);
+    m_brightMask.assign(static_cast<size_t>(tilesX) * tilesY, 0);
+
+    // 1. threshold and downsample, one task per row of tiles, each tile is marked if any pixel passes the threshold
+    ParallelFor(pool, 0, tilesY, 1, [&](size_t tileRowBegin, size_t tileRowEnd)
+    {
+        for (size_t tileY = tileRowBegin; tileY < tileRowEnd; ++tileY)
+        {
+            const uint32_t y0 = static_cast<uint32_t>(tileY) * TILE_SIZE;
+            const uint32_t y1 = std::min(y0 + TILE_SIZE, height);
+            uint8_t* maskRow = m_brightMask.data() + tileY * tilesX;
+
+            for (uint32_t y = y0; y < y1; ++y)
+            {
+                ColorRGBA32F* outputRow = buffers.bloom.Row(y);
+                for (uint32_t x = 0; x < width; ++x)
+                {
+                    const ColorRGBA32F value = ThresholdAndDownsamplePixel(scene, settings.threshold, static_cast<int>(x), static_cast<int>(y));
+                    outputRow[x] = value;
+                    if (value.r != 0.f || value.g != 0.f || value.b != 0.f)
+                    {
+                        maskRow[x / TILE_SIZE] = 1;
+                    }
+                }
+            }
+        }
+    });
+
+    const uint32_t tileRadius = (static_cast<uint32_t>(std::max(settings.blurParams.radius, 0)) + TILE_SIZE - 1) / TILE_SIZE;
+    ClassifyBloomTiles(m_brightMask, tilesX, tilesY, tileRadius, m_tileLists);
+
+    // 2. horizontal blur, tiles that are skipped have to read as zero in the vertical pass
+    std::fill(buffers.temp.pixels.begin(), buffers.temp.pixels.end(), ColorRGBA32F{ 0.f, 0.f, 0.f, 0.f });
+    ForEachTilePixel(m_tileLists.horizontal, width, height, pool, [&](uint32_t x, uint32_t y)
+    {
+        buffers.temp.At(x, y) = BlurPixel(buffers.bloom, settings.blurParams, 0, static_cast<int>(x), static_cast<int>(y));
+    });
+
+    // 3. vertical blur, written in place like the ping-pong of ComputeBloom() (only reads temp)
+    ForEachTilePixel(m_tileLists.vertical, width, height, pool, [&](uint32_t x, uint32_t y)
+    {
+        buffers.bloom.At(x, y) = BlurPixel(buffers.temp, settings.blurParams, 1, static_cast<int>(x), static_cast<int>(y));
+    });
+
+    m_stats = Stats{ };
+    m_stats.tilesTotal = tilesX * tilesY;
+    m_stats.tilesBright = static_cast<uint32_t>(std::count(m_brightMask.begin(), m_brightMask.end(), uint8_t(1)));
+    m_stats.tilesBlurredHorizontal = static_cast<uint32_t>(m_tileLists.horizontal.size());
+    m_stats.tilesBlurredVertical = static_cast<uint32_t>(m_tileLists.vertical.size());
+    const uint64_t tilePixels = static_cast<uint64_t>(TILE_SIZE) * TILE_SIZE;
+    m_stats.pixelsSkipped = (2ull * m_stats.tilesTotal - m_stats.tilesBlurredHorizontal - m_stats.tilesBlurredVertical) * tilePixels;
+}
@@ -0,0 +1,287 @@
+#include "cpu/streamingbloom.h"
+
+#include "util/threadpool.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+namespace
+{
+    constexpr char RAW_IMAGE_MAGIC[4] = { 'R', 'G', 'B', 'A' };
+
+    // number of rows processed per task (the passes of a band have few rows)
+    constexpr size_t ROWS_PER_TASK = 1;
+}
+
+ImageRowReader::ImageRowReader(const ImageRGBA32F& image) noexcept
+    : m_image(image)
+    , m_nextRow(0)
+{
+}
+
+bool ImageRowReader::ReadRows(uint32_t count, ColorRGBA32F* pixels)
+{
+    if (m_nextRow + count > m_image.height)
+    {
+        return false;
+    }
+
+    std::memcpy(pixels, m_image.Row(m_nextRow), static_cast<size_t>(count) * m_image.width * sizeof(ColorRGBA32F));
+    m_nextRow += count;
+    return true;
+}
+
+ImageRowWriter::ImageRowWriter(ImageRGBA32F& image, uint32_t width, uint32_t height)
+    : m_image(image)
+    , m_nextRow(0)
+{
+    m_image.Resize(width, height);
+}
+
+bool ImageRowWriter::WriteRows(uint32_t count, const ColorRGBA32F* pixels)
+{
+    if (m_nextRow + count > m_image.height)
+    {
+        return false;
+    }
+
+    std::memcpy(m_image.Row(m_nextRow), pixels, static_cast<size_t>(count) * m_image.width * sizeof(ColorRGBA32F));
+    m_nextRow += count;
+    return true;
+}
+
+bool RawImageFileReader::Open(const std::string& path)
+{
+    m_file.open(path, std::ios::binary);
+
+    char magic[4];
+    uint32_t size[2];
+    if (!m_file.read(magic, sizeof(magic)) || !m_file.read(reinterpret_cast<char*>(size), sizeof(size)) ||
+        std::memcmp(magic, RAW_IMAGE_MAGIC, sizeof(magic)) != 0)
+    {
+        m_file.close();
+        return false;
+    }
+
+    m_width = size[0];
+    m_height = size[1];
+    return true;
+}
+
+bool RawImageFileReader::ReadRows(uint32_t count, ColorRGBA32F* pixels)
+{
+    const size_t pixelCount = static_cast<size_t>(count) * m_width;
+    m_buffer.resize(pixelCount);
+    if (!m_file.read(reinterpret_cast<char*>(m_buffer.data()), pixelCount * sizeof(ColorRGBA8)))
+    {
+        return false;
+    }
+
+    constexpr float scale = 1.f / 255.f;
+    for (size_t i = 0; i < pixelCount; ++i)
+    {
+        const ColorRGBA8& value = m_buffer[i];
+        pixels[i] = ColorRGBA32F{ scale * value.r, scale * value.g, scale * value.b, scale * value.a };
+    }
+    return true;
+}
+
+bool RawImageFileWriter::Open(const std::string& path, uint32_t width, uint32_t height)
+{
+    m_file.open(path, std::ios::binary | std::ios::trunc);
+    m_width = width;
+
+    const uint32_t size[2] = { width, height };
+    return m_file.write(RAW_IMAGE_MAGIC, sizeof(RAW_IMAGE_MAGIC)) && m_file.write(reinterpret_cast<const char*>(size), sizeof(size));
+}
+
+bool RawImageFileWriter::Close()
+{
+    m_file.close();
+    return !m_file.fail();
+}
+
+bool RawImageFileWriter::WriteRows(uint32_t count, const ColorRGBA32F* pixels)
+{
+    const size_t pixelCount = static_cast<size_t>(count) * m_width;
+    m_buffer.resize(pixelCount);
+
+    auto toUnorm = [](float value)
+    {
+        return static_cast<uint8_t>(std::clamp(value, 0.f, 1.f) * 255.f + 0.5f);
+    };
+
+    for (size_t i = 0; i < pixelCount; ++i)
+    {
+        const ColorRGBA32F& value = pixels[i];
+        m_buffer[i] = ColorRGBA8{ toUnorm(value.r), toUnorm(value.g), toUnorm(value.b), toUnorm(value.a) };
+    }
+
+    return WriteRows(count, m_buffer.data());
+}
+
+bool RawImageFileWriter::WriteRows(uint32_t count, const ColorRGBA8* pixels)
+{
+    return static_cast<bool>(m_file.write(reinterpret_cast<const char*>(pixels), static_cast<std::streamsize>(count) * m_width * sizeof(ColorRGBA8)));
+}
+
+void StreamingBloom::RowRing::Resize(uint32_t newWidth, uint32_t newCapacity)
+{
+    width = newWidth;
+    capacity = newCapacity;
+    pixels.resize(static_cast<size_t>(width) * capacity);
+}
+
+StreamingBloom::StreamingBloom(uint32_t bandRows)
+    : m_bandRows(std::max(bandRows, 1u))
+    , m_stats{ }
+{
+}
+
+bool StreamingBloom::Process(RowReader& reader, const BloomSettings& settings, RowWriter& writer, ThreadPool* pool)
+{
+    const uint32_t width = reader.GetWidth();
+    const uint32_t height = reader.GetHeight();
+    const uint32_t halfWidth = width / 2;
+    const uint32_t halfHeight = height / 2;
+    if (halfWidth == 0 || halfHeight == 0)
+    {
+        return false;
+    }
+
+    const BlurParams& blurParams = settings.blurParams;
+    const uint32_t radius = static_cast<uint32_t>(std::max(blurParams.radius, 0));
+
+    // the scene rows from the first row that is not composited yet up to the last row read (2 per half-res row of
+    // the band and the apron), the horizontally blurred rows of the band and the apron on both sides, and the
+    // bloom rows of the band (plus the apron for the last band) and the rows sampled by the bilinear filter of the composite
+    m_sceneRows.Resize(width, 2 * (m_bandRows + radius) + 4);
+    m_horizontalRows.Resize(halfWidth, m_bandRows + 2 * radius);
+    m_bloomRows.Resize(halfWidth, m_bandRows + radius + 4);
+    m_thresholdedRows.Resize(halfWidth, m_bandRows);
+    m_outputRows.resize(static_cast<size_t>(width) * m_sceneRows.capacity);
+
+    m_stats = Stats{ };
+    m_stats.workingSetBytes = (m_sceneRows.pixels.size() + m_horizontalRows.pixels.size() + m_bloomRows.pixels.size() +
+        m_thresholdedRows.pixels.size() + m_outputRows.size()) * sizeof(ColorRGBA32F);
+
+    // reads the scene rows up to (excluding) end in contiguous pieces of the ring
+    uint32_t rowsRead = 0;
+    auto readRows = [&](uint32_t end)
+    {
+        while (rowsRead < end)
+        {
+            const uint32_t count = std::min(end - rowsRead, m_sceneRows.capacity - rowsRead % m_sceneRows.capacity);
+            if (!reader.ReadRows(count, m_sceneRows.Row(rowsRead)))
+            {
+                return false;
+            }
+            rowsRead += count;
+        }
+        return true;
+    };
+
+    // half-res rows [0, horizontalEnd) are blurred horizontally, [0, bloomEnd) vertically, and scene rows [0, outputEnd) are written
+    uint32_t horizontalEnd = 0;
+    uint32_t bloomEnd = 0;
+    uint32_t outputEnd = 0;
+    while (outputEnd < height)
+    {
+        const uint32_t bandEnd = std::min(horizontalEnd + m_bandRows, halfHeight);
+        const bool lastBand = (bandEnd == halfHeight);
+
+        // 1. read the scene rows of the band (for the last band also the rows that are only needed by the composite)
+        if (!readRows(lastBand ? height : 2 * bandEnd))
+        {
+            return false;
+        }
+        assert(rowsRead - outputEnd <= m_sceneRows.capacity);
+
+        // 2. threshold, downsample and horizontal blur
+        ParallelFor(pool, horizontalEnd, bandEnd, ROWS_PER_TASK, [&](size_t rowBegin, size_t rowEnd)
+        {
+            for (size_t y = rowBegin; y < rowEnd; ++y)
+            {
+                const uint32_t bandRow = static_cast<uint32_t>(y) - horizontalEnd;
+                const ColorRGBA32F* sceneRow0 = m_sceneRows.Row(2 * static_cast<uint32_t>(y));
+                const ColorRGBA32F* sceneRow1 = m_sceneRows.Row(2 * static_cast<uint32_t>(y) + 1);
+                ColorRGBA32F* thresholdedRow = m_thresholdedRows.Row(bandRow);
+                for (uint32_t x = 0; x < halfWidth; ++x)
+                {
+                    thresholdedRow[x] = ThresholdAndDownsamplePixel(sceneRow0, sceneRow1, settings.threshold, static_cast<int>(x));
+                }
+
+                ColorRGBA32F* horizontalRow = m_horizontalRows.Row(static_cast<uint32_t>(y));
+                for (uint32_t x = 0; x < halfWidth; ++x)
+                {
+                    horizontalRow[x] = BlurPixel(m_thresholdedRows, blurParams, 0, static_cast<int>(x), static_cast<int>(bandRow));
+                }
+            }
+        });
+
+        // 3. vertical blur of the rows whose apron is complete
+        const uint32_t newBloomEnd = lastBand ? halfHeight : std::max(bloomEnd, bandEnd - std::min(bandEnd, radius));
+        ParallelFor(pool, bloomEnd, newBloomEnd, ROWS_PER_TASK, [&](size_t rowBegin, size_t rowEnd)
+        {
+            for (size_t row = rowBegin; row < rowEnd; ++row)
+            {
+                const int y = static_cast<int>(row);
+                ColorRGBA32F* bloomRow = m_bloomRows.Row(static_cast<uint32_t>(y));
+                std::fill(bloomRow, bloomRow + halfWidth, ColorRGBA32F{ 0.f, 0.f, 0.f, 0.f });
+
+                // same order of operations as BlurPixel(), rows outside of the image are zero and do not contribute
+                for (int i = -blurParams.radius; i <= blurParams.radius; ++i)
+                {
+                    const int sourceY = y + i;
+                    if (sourceY < 0 || sourceY >= static_cast<int>(halfHeight))
+                    {
+                        continue;
+                    }
+
+                    const float coefficient = blurParams.coefficients[i < 0 ? -i : i];
+                    const ColorRGBA32F* horizontalRow = m_horizontalRows.Row(static_cast<uint32_t>(sourceY));
+                    for (uint32_t x = 0; x < halfWidth; ++x)
+                    {
+                        bloomRow[x].r += coefficient * horizontalRow[x].r;
+                        bloomRow[x].g += coefficient * horizontalRow[x].g;
+                        bloomRow[x].b += coefficient * horizontalRow[x].b;
+                        bloomRow[x].a += coefficient * horizontalRow[x].a;
+                    }
+                }
+            }
+        });
+
+        // 4. composite all scene rows whose bloom rows are complete
+        uint32_t compositeEnd = lastBand ? height : outputEnd;
+        while (compositeEnd < rowsRead && ComputeCompositeRowSource(height, halfHeight, compositeEnd).row1 < newBloomEnd)
+        {
+            ++compositeEnd;
+        }
+        assert(outputEnd == compositeEnd || newBloomEnd - ComputeCompositeRowSource(height, halfHeight, outputEnd).row0 <= m_bloomRows.capacity);
+
+        ParallelFor(pool, outputEnd, compositeEnd, ROWS_PER_TASK, [&](size_t rowBegin, size_t rowEnd)
+        {
+            for (size_t y = rowBegin; y < rowEnd; ++y)
+            {
+                const CompositeRowSource source = ComputeCompositeRowSource(height, halfHeight, static_cast<uint32_t>(y));
+                CompositeRow(m_sceneRows.Row(static_cast<uint32_t>(y)), width, m_bloomRows.Row(source.row0), m_bloomRows.Row(source.row1),
+                    halfWidth, source.weight, settings.compositeCoefficient, m_outputRows.data() + (y - outputEnd) * width);
+            }
+        });
+
+        // 5. write the finished rows
+        if (compositeEnd > outputEnd && !writer.WriteRows(compositeEnd - outputEnd, m_outputRows.data()))
+        {
+            return false;
+        }
+
+        m_stats.rowsWritten += compositeEnd - outputEnd;
+        horizontalEnd = bandEnd;
+        bloomEnd = newBloomEnd;
+        outputEnd = compositeEnd;
+    }
+
+    m_stats.rowsRead = rowsRead;
+    return true;
+}
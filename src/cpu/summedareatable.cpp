@@ -0,0 +1,281 @@
+#include "cpu/summedareatable.h"
+
+#include "util/threadpool.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+#include <emmintrin.h>
+
+namespace
+{
+    // number of rows processed per task
+    constexpr size_t ROWS_PER_TASK = 16;
+
+    // number of pixels per task of the column pass
+    constexpr size_t COLUMNS_PER_TASK = 64;
+
+    // a + b for double-float numbers (hi, lo) without losing the rounding error of the high parts (TwoSum)
+    inline void AddCompensated(__m128& hi, __m128& lo, __m128 otherHi, __m128 otherLo) noexcept
+    {
+        const __m128 sum = _mm_add_ps(hi, otherHi);
+        const __m128 bb = _mm_sub_ps(sum, hi);
+        const __m128 error = _mm_add_ps(_mm_sub_ps(hi, _mm_sub_ps(sum, bb)), _mm_sub_ps(otherHi, bb));
+        const __m128 low = _mm_add_ps(_mm_add_ps(lo, otherLo), error);
+
+        // renormalize so that the low part stays small
+        hi = _mm_add_ps(sum, low);
+        lo = _mm_sub_ps(low, _mm_sub_ps(hi, sum));
+    }
+
+    inline ColorRGBA64F Subtract(const ColorRGBA64F& lhs, const ColorRGBA64F& rhs) noexcept
+    {
+        return ColorRGBA64F{ lhs.r - rhs.r, lhs.g - rhs.g, lhs.b - rhs.b, lhs.a - rhs.a };
+    }
+
+    inline ColorRGBA64F Add(const ColorRGBA64F& lhs, const ColorRGBA64F& rhs) noexcept
+    {
+        return ColorRGBA64F{ lhs.r + rhs.r, lhs.g + rhs.g, lhs.b + rhs.b, lhs.a + rhs.a };
+    }
+}
+
+void SummedAreaTable::Build(const ImageRGBA32F& image, SatPrecision precision, ThreadPool* pool)
+{
+    m_precision = precision;
+    m_width = image.width;
+    m_height = image.height;
+
+    const uint32_t tableWidth = m_width + 1;
+    const uint32_t tableHeight = m_height + 1;
+    if (precision == SatPrecision::Double)
+    {
+        m_doubleTable.Resize(tableWidth, tableHeight);
+        m_floatTable = Image<ColorRGBA32F>();
+        m_compensationTable = Image<ColorRGBA32F>();
+    }
+    else
+    {
+        m_floatTable.Resize(tableWidth, tableHeight);
+        m_doubleTable = Image<ColorRGBA64F>();
+        if (precision == SatPrecision::Compensated)
+        {
+            m_compensationTable.Resize(tableWidth, tableHeight);
+        }
+        else
+        {
+            m_compensationTable = Image<ColorRGBA32F>();
+        }
+    }
+
+    // 1. prefix sums over the rows (row 0 and column 0 are zero)
+    ParallelFor(pool, 0, tableHeight, ROWS_PER_TASK, [&](size_t rowBegin, size_t rowEnd)
+    {
+        for (size_t y = rowBegin; y < rowEnd; ++y)
+        {
+            if (y == 0)
+            {
+                // the tables that are not used for the current precision are empty
+                std::fill(m_doubleTable.Row(0), m_doubleTable.Row(0) + m_doubleTable.width, ColorRGBA64F{ 0.0, 0.0, 0.0, 0.0 });
+                std::fill(m_floatTable.Row(0), m_floatTable.Row(0) + m_floatTable.width, ColorRGBA32F{ 0.f, 0.f, 0.f, 0.f });
+                std::fill(m_compensationTable.Row(0), m_compensationTable.Row(0) + m_compensationTable.width, ColorRGBA32F{ 0.f, 0.f, 0.f, 0.f });
+                continue;
+            }
+
+            const float* input = &image.Row(static_cast<uint32_t>(y - 1))->r;
+            if (precision == SatPrecision::Double)
+            {
+                double* row = &m_doubleTable.Row(static_cast<uint32_t>(y))->r;
+                __m128d sumRG = _mm_setzero_pd();
+                __m128d sumBA = _mm_setzero_pd();
+                _mm_storeu_pd(row, sumRG);
+                _mm_storeu_pd(row + 2, sumBA);
+                for (uint32_t x = 0; x < m_width; ++x)
+                {
+                    const __m128 value = _mm_loadu_ps(input + 4 * x);
+                    sumRG = _mm_add_pd(sumRG, _mm_cvtps_pd(value));
+                    sumBA = _mm_add_pd(sumBA, _mm_cvtps_pd(_mm_movehl_ps(value, value)));
+                    _mm_storeu_pd(row + 4 * (x + 1), sumRG);
+                    _mm_storeu_pd(row + 4 * (x + 1) + 2, sumBA);
+                }
+            }
+            else if (precision == SatPrecision::Compensated)
+            {
+                float* row = &m_floatTable.Row(static_cast<uint32_t>(y))->r;
+                float* compensationRow = &m_compensationTable.Row(static_cast<uint32_t>(y))->r;
+                __m128 sum = _mm_setzero_ps();
+                __m128 compensation = _mm_setzero_ps();
+                _mm_storeu_ps(row, sum);
+                _mm_storeu_ps(compensationRow, compensation);
+                for (uint32_t x = 0; x < m_width; ++x)
+                {
+                    AddCompensated(sum, compensation, _mm_loadu_ps(input + 4 * x), _mm_setzero_ps());
+                    _mm_storeu_ps(row + 4 * (x + 1), sum);
+                    _mm_storeu_ps(compensationRow + 4 * (x + 1), compensation);
+                }
+            }
+            else
+            {
+                float* row = &m_floatTable.Row(static_cast<uint32_t>(y))->r;
+                __m128 sum = _mm_setzero_ps();
+                _mm_storeu_ps(row, sum);
+                for (uint32_t x = 0; x < m_width; ++x)
+                {
+                    sum = _mm_add_ps(sum, _mm_loadu_ps(input + 4 * x));
+                    _mm_storeu_ps(row + 4 * (x + 1), sum);
+                }
+            }
+        }
+    });
+
+    // 2. prefix sums over the columns: each row is added to the next one, vectorized and parallelized over the columns
+    ParallelFor(pool, 0, tableWidth, COLUMNS_PER_TASK, [&](size_t columnBegin, size_t columnEnd)
+    {
+        for (uint32_t y = 1; y < tableHeight; ++y)
+        {
+            if (precision == SatPrecision::Double)
+            {
+                const double* previous = &m_doubleTable.Row(y - 1)->r;
+                double* row = &m_doubleTable.Row(y)->r;
+                for (size_t i = 4 * columnBegin; i < 4 * columnEnd; i += 2)
+                {
+                    _mm_storeu_pd(row + i, _mm_add_pd(_mm_loadu_pd(row + i), _mm_loadu_pd(previous + i)));
+                }
+            }
+            else if (precision == SatPrecision::Compensated)
+            {
+                const float* previous = &m_floatTable.Row(y - 1)->r;
+                const float* previousCompensation = &m_compensationTable.Row(y - 1)->r;
+                float* row = &m_floatTable.Row(y)->r;
+                float* compensationRow = &m_compensationTable.Row(y)->r;
+                for (size_t i = 4 * columnBegin; i < 4 * columnEnd; i += 4)
+                {
+                    __m128 hi = _mm_loadu_ps(row + i);
+                    __m128 lo = _mm_loadu_ps(compensationRow + i);
+                    AddCompensated(hi, lo, _mm_loadu_ps(previous + i), _mm_loadu_ps(previousCompensation + i));
+                    _mm_storeu_ps(row + i, hi);
+                    _mm_storeu_ps(compensationRow + i, lo);
+                }
+            }
+            else
+            {
+                const float* previous = &m_floatTable.Row(y - 1)->r;
+                float* row = &m_floatTable.Row(y)->r;
+                for (size_t i = 4 * columnBegin; i < 4 * columnEnd; i += 4)
+                {
+                    _mm_storeu_ps(row + i, _mm_add_ps(_mm_loadu_ps(row + i), _mm_loadu_ps(previous + i)));
+                }
+            }
+        }
+    });
+}
+
+ColorRGBA64F SummedAreaTable::Fetch(uint32_t x, uint32_t y) const noexcept
+{
+    switch (m_precision)
+    {
+    case SatPrecision::Double:
+        return m_doubleTable.At(x, y);
+    case SatPrecision::Compensated:
+    {
+        const ColorRGBA32F& hi = m_floatTable.At(x, y);
+        const ColorRGBA32F& lo = m_compensationTable.At(x, y);
+        return ColorRGBA64F{ static_cast<double>(hi.r) + lo.r, static_cast<double>(hi.g) + lo.g, static_cast<double>(hi.b) + lo.b, static_cast<double>(hi.a) + lo.a };
+    }
+    default:
+    {
+        const ColorRGBA32F& value = m_floatTable.At(x, y);
+        return ColorRGBA64F{ value.r, value.g, value.b, value.a };
+    }
+    }
+}
+
+ColorRGBA64F SummedAreaTable::Sum(int x0, int y0, int x1, int y1) const noexcept
+{
+    const uint32_t left = static_cast<uint32_t>(std::clamp(x0, 0, static_cast<int>(m_width)));
+    const uint32_t top = static_cast<uint32_t>(std::clamp(y0, 0, static_cast<int>(m_height)));
+    const uint32_t right = static_cast<uint32_t>(std::clamp(x1, 0, static_cast<int>(m_width)));
+    const uint32_t bottom = static_cast<uint32_t>(std::clamp(y1, 0, static_cast<int>(m_height)));
+    if (left >= right || top >= bottom)
+    {
+        return ColorRGBA64F{ 0.0, 0.0, 0.0, 0.0 };
+    }
+
+    if (m_precision == SatPrecision::Float)
+    {
+        // evaluated in float like a GPU implementation would
+        const ColorRGBA32F& a = m_floatTable.At(right, bottom);
+        const ColorRGBA32F& b = m_floatTable.At(left, bottom);
+        const ColorRGBA32F& c = m_floatTable.At(right, top);
+        const ColorRGBA32F& d = m_floatTable.At(left, top);
+        return ColorRGBA64F{ a.r - b.r - c.r + d.r, a.g - b.g - c.g + d.g, a.b - b.b - c.b + d.b, a.a - b.a - c.a + d.a };
+    }
+
+    return Add(Subtract(Subtract(Fetch(right, bottom), Fetch(left, bottom)), Fetch(right, top)), Fetch(left, top));
+}
+
+void VariableBoxBlur(const SummedAreaTable& table, const Image<float>& radius, ImageRGBA32F& output, ThreadPool* pool)
+{
+    assert(radius.HasSize(table.GetWidth(), table.GetHeight()));
+    output.Resize(table.GetWidth(), table.GetHeight());
+
+    ParallelFor(pool, 0, output.height, ROWS_PER_TASK, [&](size_t rowBegin, size_t rowEnd)
+    {
+        for (size_t row = rowBegin; row < rowEnd; ++row)
+        {
+            const int y = static_cast<int>(row);
+            const float* radiusRow = radius.Row(static_cast<uint32_t>(y));
+            ColorRGBA32F* outputRow = output.Row(static_cast<uint32_t>(y));
+
+            for (int x = 0; x < static_cast<int>(output.width); ++x)
+            {
+                const float r = std::max(radiusRow[x], 0.f);
+                const int r0 = static_cast<int>(r);
+                const double t = r - static_cast<float>(r0);
+
+                // box averages for the two integer radii around r
+                const ColorRGBA64F sum0 = table.Sum(x - r0, y - r0, x + r0 + 1, y + r0 + 1);
+                const double scale0 = 1.0 / ((2.0 * r0 + 1.0) * (2.0 * r0 + 1.0));
+                ColorRGBA64F average = { sum0.r * scale0, sum0.g * scale0, sum0.b * scale0, 0.0 };
+
+                if (t > 0.0)
+                {
+                    const int r1 = r0 + 1;
+                    const ColorRGBA64F sum1 = table.Sum(x - r1, y - r1, x + r1 + 1, y + r1 + 1);
+                    const double scale1 = 1.0 / ((2.0 * r1 + 1.0) * (2.0 * r1 + 1.0));
+                    average.r += t * (sum1.r * scale1 - average.r);
+                    average.g += t * (sum1.g * scale1 - average.g);
+                    average.b += t * (sum1.b * scale1 - average.b);
+                }
+
+                outputRow[x] = ColorRGBA32F{ static_cast<float>(average.r), static_cast<float>(average.g), static_cast<float>(average.b), 1.f };
+            }
+        }
+    });
+}
+
+void VariableIteratedBoxBlur(const ImageRGBA32F& input, const Image<float>& radius, uint32_t iterations, SatPrecision precision,
+    SummedAreaTable& table, ImageRGBA32F& output, ThreadPool* pool)
+{
+    if (iterations == 0)
+    {
+        output = input;
+        return;
+    }
+
+    table.Build(input, precision, pool);
+    VariableBoxBlur(table, radius, output, pool);
+    for (uint32_t i = 1; i < iterations; ++i)
+    {
+        // the table is a copy of the previous result, so output can be overwritten
+        table.Build(output, precision, pool);
+        VariableBoxBlur(table, radius, output, pool);
+    }
+}
+
+float ComputeBoxRadiusForGaussian(float sigma, uint32_t iterations) noexcept
+{
+    // the variance of a box of width w is (w^2 - 1) / 12, variances add up over the iterations
+    const float width = std::sqrt(12.f * sigma * sigma / static_cast<float>(std::max(iterations, 1u)) + 1.f);
+    return 0.5f * (width - 1.f);
+}
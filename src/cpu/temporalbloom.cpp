@@ -0,0 +1,185 @@
+#include "cpu/temporalbloom.h"
+
+#include "util/threadpool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <utility>
+
+namespace
+{
+    // number of rows processed per task
+    constexpr size_t ROWS_PER_TASK = 16;
+
+    // phase value that selects every pixel
+    constexpr uint32_t ALL_PIXELS = ~0u;
+
+    // order in which the tiles of a 2x2 block are updated with period 4 (ordered dither)
+    constexpr uint32_t CHECKERBOARD_ORDER[4] = { 0, 2, 3, 1 };
+}
+
+TemporalBloom::TemporalBloom(const TemporalBloomSettings& settings)
+    : m_settings(settings)
+    , m_frameIndex(0)
+    , m_hasHistory(false)
+    , m_stats{ 0, 0 }
+{
+    m_settings.period = std::max(m_settings.period, 1u);
+    m_settings.tileSize = std::max(m_settings.tileSize, 1u);
+    m_settings.historyWeight = std::clamp(m_settings.historyWeight, 0.f, 1.f);
+
+    if (m_settings.pattern == TemporalPattern::Checkerboard && m_settings.period > 2)
+    {
+        m_settings.period = 4;
+    }
+}
+
+void TemporalBloom::Reset() noexcept
+{
+    m_hasHistory = false;
+    m_frameIndex = 0;
+}
+
+bool TemporalBloom::IsUpdated(uint32_t x, uint32_t y, uint32_t phase) const noexcept
+{
+    if (phase == ALL_PIXELS)
+    {
+        return true;
+    }
+
+    const uint32_t tileX = x / m_settings.tileSize;
+    const uint32_t tileY = y / m_settings.tileSize;
+
+    if (m_settings.pattern == TemporalPattern::InterleavedRows)
+    {
+        return (tileY % m_settings.period) == phase;
+    }
+
+    if (m_settings.period == 2)
+    {
+        return ((tileX + tileY) & 1) == phase;
+    }
+
+    return CHECKERBOARD_ORDER[(tileY & 1) * 2 + (tileX & 1)] == phase;
+}
+
+void TemporalBloom::Reproject(const ImageRGBA32F& motionVectors, ThreadPool* pool)
+{
+    // the previous bloom becomes the history that we fetch from
+    std::swap(m_bloom, m_history);
+    m_bloom.Resize(m_history.width, m_history.height);
+
+    ParallelFor(pool, 0, m_bloom.height, ROWS_PER_TASK, [&](size_t rowBegin, size_t rowEnd)
+    {
+        for (uint32_t y = static_cast<uint32_t>(rowBegin); y < rowEnd; ++y)
+        {
+            const ColorRGBA32F* motionRow = motionVectors.Row(y);
+            ColorRGBA32F* bloomRow = m_bloom.Row(y);
+            for (uint32_t x = 0; x < m_bloom.width; ++x)
+            {
+                // texel centers are at (x + 0.5, y + 0.5)
+                float u = static_cast<float>(x) + 0.5f - motionRow[x].r;
+                float v = static_cast<float>(y) + 0.5f - motionRow[x].g;
+                bloomRow[x] = SampleBilinearClamp(m_history, u, v);
+            }
+        }
+    });
+}
+
+const ImageRGBA32F& TemporalBloom::Process(const ImageRGBA32F& scene, const BloomSettings& settings, const ImageRGBA32F* motionVectors, ThreadPool* pool)
+{
+    const uint32_t width = scene.width / 2;
+    const uint32_t height = scene.height / 2;
+
+    if (!m_bloom.HasSize(width, height))
+    {
+        m_thresholded.Resize(width, height);
+        m_horizontal.Resize(width, height);
+        m_bloom.Resize(width, height);
+        m_hasHistory = false;
+    }
+
+    const bool fullUpdate = !m_hasHistory || m_settings.period == 1;
+    const uint32_t phase = fullUpdate ? ALL_PIXELS : m_frameIndex % m_settings.period;
+
+    if (!fullUpdate && motionVectors != nullptr && motionVectors->HasSize(width, height))
+    {
+        Reproject(*motionVectors, pool);
+    }
+
+    // calls func(x) for all pixels of row y that are part of the current phase
+    auto forEachUpdatedPixel = [this, width, phase](uint32_t y, auto&& func)
+    {
+        if (phase != ALL_PIXELS && m_settings.pattern == TemporalPattern::InterleavedRows && !IsUpdated(0, y, phase))
+        {
+            return;
+        }
+
+        for (uint32_t x = 0; x < width; ++x)
+        {
+            if (IsUpdated(x, y, phase))
+            {
+                func(x);
+            }
+        }
+    };
+
+    std::atomic<uint64_t> pixelsUpdated{ 0 };
+
+    // 1. threshold and downsample
+    ParallelFor(pool, 0, height, ROWS_PER_TASK, [&](size_t rowBegin, size_t rowEnd)
+    {
+        uint64_t count = 0;
+        for (uint32_t y = static_cast<uint32_t>(rowBegin); y < rowEnd; ++y)
+        {
+            ColorRGBA32F* row = m_thresholded.Row(y);
+            forEachUpdatedPixel(y, [&](uint32_t x)
+            {
+                row[x] = ThresholdAndDownsamplePixel(scene, settings.threshold, static_cast<int>(x), static_cast<int>(y));
+                ++count;
+            });
+        }
+        pixelsUpdated += count;
+    });
+
+    // 2. horizontal blur, reads thresholded values of earlier frames for neighbors outside of the pattern
+    ParallelFor(pool, 0, height, ROWS_PER_TASK, [&](size_t rowBegin, size_t rowEnd)
+    {
+        for (uint32_t y = static_cast<uint32_t>(rowBegin); y < rowEnd; ++y)
+        {
+            ColorRGBA32F* row = m_horizontal.Row(y);
+            forEachUpdatedPixel(y, [&](uint32_t x)
+            {
+                row[x] = BlurPixel(m_thresholded, settings.blurParams, 0, static_cast<int>(x), static_cast<int>(y));
+            });
+        }
+    });
+
+    // 3. vertical blur and blending with the history
+    const float historyWeight = fullUpdate ? 0.f : m_settings.historyWeight;
+    ParallelFor(pool, 0, height, ROWS_PER_TASK, [&](size_t rowBegin, size_t rowEnd)
+    {
+        for (uint32_t y = static_cast<uint32_t>(rowBegin); y < rowEnd; ++y)
+        {
+            ColorRGBA32F* row = m_bloom.Row(y);
+            forEachUpdatedPixel(y, [&](uint32_t x)
+            {
+                const ColorRGBA32F fresh = BlurPixel(m_horizontal, settings.blurParams, 1, static_cast<int>(x), static_cast<int>(y));
+                ColorRGBA32F& history = row[x];
+
+                history.r = fresh.r + historyWeight * (history.r - fresh.r);
+                history.g = fresh.g + historyWeight * (history.g - fresh.g);
+                history.b = fresh.b + historyWeight * (history.b - fresh.b);
+                history.a = fresh.a + historyWeight * (history.a - fresh.a);
+            });
+        }
+    });
+
+    m_stats.pixelsTotal = static_cast<uint64_t>(width) * height;
+    m_stats.pixelsUpdated = pixelsUpdated.load();
+
+    m_hasHistory = true;
+    ++m_frameIndex;
+
+    return m_bloom;
+}
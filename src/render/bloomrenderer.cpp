@@ -0,0 +1,491 @@
+#include "render/bloomrenderer.h"
+
+#include <iostream>
+
+namespace
+{
+    // thread group size of the compute shaders (numthreads(8, 8, 1)), each group processes one bloom tile
+    constexpr uint32_t COMPUTE_GROUP_SIZE = BLOOM_TILE_SIZE;
+    // thread group size of the tile classification shader (numthreads(64, 1, 1))
+    constexpr uint32_t CLASSIFY_GROUP_SIZE = 64;
+
+    // prints the name of the object if it could not be created
+    template <typename Handle>
+    bool CheckCreated(Handle handle, const char* name)
+    {
+        if (handle == Handle::Null)
+        {
+            std::cerr << "Failed to create " << name << "\n";
+            return false;
+        }
+        return true;
+    }
+}
+
+BloomRenderer::~BloomRenderer()
+{
+    Release();
+}
+
+bool BloomRenderer::Initialize(RenderDevice& device, const Resolution& outputResolution, const std::vector<VertexPosNormal>& mesh,
+    const SceneMaterial& material)
+{
+    Release();
+    m_device = &device;
+    m_outputResolution = outputResolution;
+
+    // shaders
+    m_modelVertexShader = device.CreateShader(ShaderDesc{ "shaders/phong.hlsl", "VSMain", ShaderStage::Vertex });
+    m_modelPixelShader = device.CreateShader(ShaderDesc{ "shaders/phong.hlsl", "PSMain", ShaderStage::Pixel });
+    m_quadCompositeVertexShader = device.CreateShader(ShaderDesc{ "shaders/quadcomposite.hlsl", "VSMain", ShaderStage::Vertex });
+    m_quadCompositePixelShader = device.CreateShader(ShaderDesc{ "shaders/quadcomposite.hlsl", "PSMain", ShaderStage::Pixel });
+    m_thresholdDownsampleShader = device.CreateShader(ShaderDesc{ "shaders/thresholddownsample.hlsl", "ThresholdAndDownsample", ShaderStage::Compute });
+    m_blurShader = device.CreateShader(ShaderDesc{ "shaders/blur.hlsl", "Blur", ShaderStage::Compute });
+    m_blurTilesShader = device.CreateShader(ShaderDesc{ "shaders/blur.hlsl", "BlurTiles", ShaderStage::Compute });
+    m_tileClassifyShader = device.CreateShader(ShaderDesc{ "shaders/tileclassify.hlsl", "ClassifyTiles", ShaderStage::Compute });
+    if (!CheckCreated(m_modelVertexShader, "model vertex shader") || !CheckCreated(m_modelPixelShader, "model pixel shader")
+        || !CheckCreated(m_quadCompositeVertexShader, "composition vertex shader") || !CheckCreated(m_quadCompositePixelShader, "composition pixel shader")
+        || !CheckCreated(m_thresholdDownsampleShader, "threshold shader") || !CheckCreated(m_blurShader, "blur shader")
+        || !CheckCreated(m_blurTilesShader, "tile blur shader") || !CheckCreated(m_tileClassifyShader, "tile classification shader"))
+    {
+        return false;
+    }
+
+    m_texturePool = std::make_unique<TexturePool>(device);
+    m_frameGraph = std::make_unique<FrameGraph>(*m_texturePool);
+    if (!CreateTileBuffers())
+    {
+        return false;
+    }
+
+    // depth-stencil states
+    {
+        DepthStencilDesc dsDesc;
+        dsDesc.depthEnable = true;
+        dsDesc.depthWrite = true;
+        dsDesc.depthFunc = ComparisonFunc::Less;
+        m_depthStencilStateWithDepthTest = device.CreateDepthStencilState(dsDesc);
+
+        dsDesc.depthEnable = false;
+        m_depthStencilStateWithoutDepthTest = device.CreateDepthStencilState(dsDesc);
+        if (!CheckCreated(m_depthStencilStateWithDepthTest, "depth/stencil state") || !CheckCreated(m_depthStencilStateWithoutDepthTest, "depth/stencil state"))
+        {
+            return false;
+        }
+    }
+
+    // rasterizer state
+    {
+        RasterizerDesc rasterDesc;
+        rasterDesc.cullMode = CullMode::Back;
+        rasterDesc.depthClip = true;
+        m_defaultRasterizerState = device.CreateRasterizerState(rasterDesc);
+        if (!CheckCreated(m_defaultRasterizerState, "rasterizer state"))
+        {
+            return false;
+        }
+    }
+
+    // default texture sampler, clamp so that texels of the opposite border (or outside of the rendered region) are not filtered in
+    {
+        SamplerDesc sampDesc;
+        sampDesc.filter = Filter::Linear;
+        sampDesc.addressMode = AddressMode::Clamp;
+        sampDesc.maxLod = 1.f;
+        m_defaultSamplerState = device.CreateSamplerState(sampDesc);
+        if (!CheckCreated(m_defaultSamplerState, "texture sampler"))
+        {
+            return false;
+        }
+    }
+
+    // model vertex buffer and input layout
+    {
+        BufferDesc bd;
+        bd.size = static_cast<uint32_t>(sizeof(VertexPosNormal) * mesh.size());
+        bd.bindFlags = BIND_VERTEX_BUFFER;
+        bd.dynamic = true;
+        m_modelVertexBuffer = device.CreateBuffer(bd, mesh.data());
+        m_modelVertexCount = static_cast<uint32_t>(mesh.size());
+
+        m_modelInputLayout = device.CreateInputLayout(m_modelVertexShader, { { "POSITION", Format::R32G32B32Float, 0 }, { "NORMAL", Format::R32G32B32A32Float, 12 } });
+        if (!CheckCreated(m_modelVertexBuffer, "model vertex buffer") || !CheckCreated(m_modelInputLayout, "model input layout"))
+        {
+            return false;
+        }
+    }
+
+    // screen aligned quad
+    {
+        BufferDesc bd;
+        bd.size = static_cast<uint32_t>(sizeof(VertexPosTexCoord) * ScreenAlignedQuad.size());
+        bd.bindFlags = BIND_VERTEX_BUFFER;
+        bd.dynamic = true;
+        m_quadVertexBuffer = device.CreateBuffer(bd, ScreenAlignedQuad.data());
+
+        m_quadInputLayout = device.CreateInputLayout(m_quadCompositeVertexShader, { { "POSITION", Format::R32G32B32Float, 0 }, { "TEXCOORD", Format::R32G32Float, 12 } });
+        if (!CheckCreated(m_quadVertexBuffer, "screen aligned quad vertex buffer") || !CheckCreated(m_quadInputLayout, "screen aligned quad input layout"))
+        {
+            return false;
+        }
+    }
+
+    // constant buffers, the material is constant
+    m_transformConstantBuffer = CreateConstantBuffer(sizeof(SceneTransforms));
+    m_lightSourceConstantBuffer = CreateConstantBuffer(sizeof(SceneLight));
+    m_materialConstantBuffer = CreateConstantBuffer(sizeof(SceneMaterial), &material);
+    m_thresholdConstantBuffer = CreateConstantBuffer(sizeof(ThresholdParams));
+    m_tileClassifyConstantBuffer = CreateConstantBuffer(sizeof(TileClassifyParams));
+    m_blurConstantBuffer = CreateConstantBuffer(sizeof(BlurParams));
+    m_compositionConstantBuffer = CreateConstantBuffer(sizeof(CompositeParams));
+    if (!CheckCreated(m_transformConstantBuffer, "transform constant buffer") || !CheckCreated(m_lightSourceConstantBuffer, "light source constant buffer")
+        || !CheckCreated(m_materialConstantBuffer, "material constant buffer") || !CheckCreated(m_thresholdConstantBuffer, "threshold constant buffer")
+        || !CheckCreated(m_tileClassifyConstantBuffer, "tile classification constant buffer") || !CheckCreated(m_blurConstantBuffer, "blur constant buffer")
+        || !CheckCreated(m_compositionConstantBuffer, "composition constant buffer"))
+    {
+        return false;
+    }
+
+    // two sets of (x, y, z) thread group counts, written by the tile classification through a raw UAV
+    {
+        BufferDesc bd;
+        bd.size = 6 * sizeof(uint32_t);
+        bd.bindFlags = BIND_UNORDERED_ACCESS;
+        bd.indirectArgs = true;
+        m_dispatchArgsBuffer = device.CreateBuffer(bd);
+        m_dispatchArgsView = device.CreateView(m_dispatchArgsBuffer, ViewType::UnorderedAccess);
+        if (!CheckCreated(m_dispatchArgsBuffer, "dispatch arguments buffer") || !CheckCreated(m_dispatchArgsView, "dispatch arguments UAV"))
+        {
+            return false;
+        }
+    }
+
+    // note: the viewports are set in Render() since the internal resolution may change every frame
+    return true;
+}
+
+bool BloomRenderer::Resize(const Resolution& outputResolution)
+{
+    m_outputResolution = outputResolution;
+
+    ReleaseTileBuffers();
+    return CreateTileBuffers();
+}
+
+void BloomRenderer::Release()
+{
+    if (m_device == nullptr)
+    {
+        return;
+    }
+
+    ReleaseTileBuffers();
+    m_frameGraph.reset();
+    m_texturePool.reset();
+
+    RenderDevice& device = *m_device;
+    for (ShaderHandle* shader : { &m_modelVertexShader, &m_modelPixelShader, &m_quadCompositeVertexShader, &m_quadCompositePixelShader,
+        &m_thresholdDownsampleShader, &m_blurShader, &m_blurTilesShader, &m_tileClassifyShader })
+    {
+        device.Release(*shader);
+        *shader = ShaderHandle::Null;
+    }
+
+    device.Release(m_depthStencilStateWithDepthTest);
+    device.Release(m_depthStencilStateWithoutDepthTest);
+    device.Release(m_defaultRasterizerState);
+    device.Release(m_defaultSamplerState);
+    m_depthStencilStateWithDepthTest = DepthStencilStateHandle::Null;
+    m_depthStencilStateWithoutDepthTest = DepthStencilStateHandle::Null;
+    m_defaultRasterizerState = RasterizerStateHandle::Null;
+    m_defaultSamplerState = SamplerStateHandle::Null;
+
+    device.Release(m_modelInputLayout);
+    device.Release(m_quadInputLayout);
+    m_modelInputLayout = InputLayoutHandle::Null;
+    m_quadInputLayout = InputLayoutHandle::Null;
+
+    device.Release(m_dispatchArgsView);
+    m_dispatchArgsView = ViewHandle::Null;
+
+    for (BufferHandle* buffer : { &m_modelVertexBuffer, &m_quadVertexBuffer, &m_transformConstantBuffer, &m_lightSourceConstantBuffer,
+        &m_materialConstantBuffer, &m_thresholdConstantBuffer, &m_tileClassifyConstantBuffer, &m_blurConstantBuffer, &m_compositionConstantBuffer,
+        &m_dispatchArgsBuffer })
+    {
+        device.Release(*buffer);
+        *buffer = BufferHandle::Null;
+    }
+
+    m_device = nullptr;
+}
+
+void BloomRenderer::Render(RenderContext& context, const BloomFrameInputs& inputs)
+{
+    // the render targets have the output resolution, but the scene and bloom only cover the upper left part of size renderResolution
+    const Resolution& renderResolution = inputs.renderResolution;
+    const Resolution halfResolution = { renderResolution.width / 2, renderResolution.height / 2 };
+    const uint32_t dispatchX = DispatchGroupCount(halfResolution.width, COMPUTE_GROUP_SIZE);
+    const uint32_t dispatchY = DispatchGroupCount(halfResolution.height, COMPUTE_GROUP_SIZE);
+
+    FrameGraph& graph = *m_frameGraph;
+    graph.Reset();
+
+    // transient render targets: the scene with full resolution, and two bloom targets with half of it for the threshold and the blur
+    TextureDesc sceneDesc;
+    sceneDesc.width = m_outputResolution.width;
+    sceneDesc.height = m_outputResolution.height;
+    sceneDesc.format = Format::R8G8B8A8Unorm;
+    sceneDesc.bindFlags = BIND_RENDER_TARGET | BIND_SHADER_RESOURCE;
+    const FrameGraphResource scene = graph.CreateTexture("scene", sceneDesc);
+
+    TextureDesc depthDesc;
+    depthDesc.width = m_outputResolution.width;
+    depthDesc.height = m_outputResolution.height;
+    depthDesc.format = Format::D24UnormS8Uint;
+    depthDesc.bindFlags = BIND_DEPTH_STENCIL;
+    const FrameGraphResource depth = graph.CreateTexture("depth", depthDesc);
+
+    TextureDesc bloomDesc;
+    bloomDesc.width = m_outputResolution.width / 2;
+    bloomDesc.height = m_outputResolution.height / 2;
+    bloomDesc.format = Format::R8G8B8A8Unorm;
+    bloomDesc.bindFlags = BIND_SHADER_RESOURCE | BIND_UNORDERED_ACCESS;
+    const FrameGraphResource bloomA = graph.CreateTexture("bloom A", bloomDesc);
+    const FrameGraphResource bloomB = graph.CreateTexture("bloom B", bloomDesc);
+
+    FrameGraphViews backBufferViews;
+    backBufferViews.renderTarget = m_device->GetBackBufferView();
+    const FrameGraphResource backBuffer = graph.Import("back buffer", backBufferViews);
+
+    // first pass: render the mesh with Blinn-Phong lighting
+    graph.AddPass("scene", [this, &inputs, &graph, &renderResolution, scene, depth](RenderContext& context)
+    {
+        context.SetViewport(static_cast<float>(renderResolution.width), static_cast<float>(renderResolution.height));
+        context.SetRasterizerState(m_defaultRasterizerState);
+
+        // clear the render target (bound by the graph)
+        constexpr float backgroundColor[4] = { 0.f, 0.f, 0.f, 1.f };
+        context.ClearRenderTarget(graph.GetView(scene, ViewType::RenderTarget), backgroundColor);
+        context.ClearDepth(graph.GetView(depth, ViewType::DepthStencil), 1.f);
+
+        context.SetDepthStencilState(m_depthStencilStateWithDepthTest);
+
+        // shaders, vertex input layout, vertex buffer and primitive topology
+        context.SetShader(ShaderStage::Vertex, m_modelVertexShader);
+        context.SetShader(ShaderStage::Pixel, m_modelPixelShader);
+        context.SetInputLayout(m_modelInputLayout);
+        context.SetVertexBuffer(m_modelVertexBuffer, sizeof(VertexPosNormal), 0);
+        context.SetPrimitiveTopology(PrimitiveTopology::TriangleList);
+
+        // transformation matrices and light source
+        context.UpdateBuffer(m_transformConstantBuffer, &inputs.transforms, sizeof(SceneTransforms));
+        context.UpdateBuffer(m_lightSourceConstantBuffer, &inputs.light, sizeof(SceneLight));
+
+        const BufferHandle constantBuffers[3] = { m_transformConstantBuffer, m_lightSourceConstantBuffer, m_materialConstantBuffer };
+        context.SetConstantBuffers(ShaderStage::Vertex, 0, 1, &constantBuffers[0]);
+        context.SetConstantBuffers(ShaderStage::Pixel, 0, 2, &constantBuffers[1]);
+
+        context.Draw(m_modelVertexCount);
+
+        // turn depth test off
+        context.SetDepthStencilState(m_depthStencilStateWithoutDepthTest);
+    })
+        .WriteRenderTarget(scene, 0)
+        .WriteDepthStencil(depth);
+
+    // sparse bloom: per-tile flag, tile lists and dispatch arguments (the views are owned by the renderer)
+    FrameGraphResource tileMask = FrameGraphResource::Null;
+    FrameGraphResource horizontalTiles = FrameGraphResource::Null;
+    FrameGraphResource verticalTiles = FrameGraphResource::Null;
+    FrameGraphResource dispatchArgs = FrameGraphResource::Null;
+    if (inputs.sparseBloom)
+    {
+        FrameGraphViews views;
+        views.shaderResource = m_tileMaskBuffer.shaderResourceView;
+        views.unorderedAccess = m_tileMaskBuffer.unorderedAccessView;
+        tileMask = graph.Import("tile mask", views);
+        views.shaderResource = m_horizontalTileBuffer.shaderResourceView;
+        views.unorderedAccess = m_horizontalTileBuffer.unorderedAccessView;
+        horizontalTiles = graph.Import("horizontal tiles", views);
+        views.shaderResource = m_verticalTileBuffer.shaderResourceView;
+        views.unorderedAccess = m_verticalTileBuffer.unorderedAccessView;
+        verticalTiles = graph.Import("vertical tiles", views);
+        views.shaderResource = ViewHandle::Null;
+        views.unorderedAccess = m_dispatchArgsView;
+        dispatchArgs = graph.Import("dispatch arguments", views);
+    }
+
+    // 1. downsample to half resolution and threshold
+    {
+        FrameGraph::PassBuilder pass = graph.AddPass("threshold", [this, &inputs, halfResolution, dispatchX, dispatchY](RenderContext& context)
+        {
+            const ThresholdParams thresholdParams = { inputs.threshold, { static_cast<int>(halfResolution.width), static_cast<int>(halfResolution.height) },
+                static_cast<int>(dispatchX) };
+            context.UpdateBuffer(m_thresholdConstantBuffer, &thresholdParams, sizeof(ThresholdParams));
+
+            context.SetShader(ShaderStage::Compute, m_thresholdDownsampleShader);
+            context.SetConstantBuffers(ShaderStage::Compute, 0, 1, &m_thresholdConstantBuffer);
+
+            context.Dispatch(dispatchX, dispatchY, 1);
+        });
+        pass.ReadShaderResource(scene, ShaderStage::Compute, 0).WriteUnorderedAccess(bloomA, 0);
+        // the tile mask is only written if sparse bloom is enabled
+        if (inputs.sparseBloom)
+        {
+            pass.WriteUnorderedAccess(tileMask, 1);
+        }
+    }
+
+    // 1b. sparse bloom: build the lists of tiles that need to be blurred
+    if (inputs.sparseBloom)
+    {
+        graph.AddPass("classify", [this, &inputs, &graph, bloomB, dispatchX, dispatchY](RenderContext& context)
+        {
+            // reset the tile counts of both sets of dispatch arguments
+            const uint32_t initialDispatchArgs[6] = { 0, 1, 1, 0, 1, 1 };
+            context.UpdateBuffer(m_dispatchArgsBuffer, initialDispatchArgs, sizeof(initialDispatchArgs));
+
+            const TileClassifyParams tileClassifyParams = { { static_cast<int>(dispatchX), static_cast<int>(dispatchY) },
+                (inputs.blurParams.radius + BLOOM_TILE_SIZE - 1) / BLOOM_TILE_SIZE };
+            context.UpdateBuffer(m_tileClassifyConstantBuffer, &tileClassifyParams, sizeof(TileClassifyParams));
+
+            context.SetShader(ShaderStage::Compute, m_tileClassifyShader);
+            context.SetConstantBuffers(ShaderStage::Compute, 0, 1, &m_tileClassifyConstantBuffer);
+
+            context.Dispatch(DispatchGroupCount(dispatchX * dispatchY, CLASSIFY_GROUP_SIZE), 1, 1);
+
+            // tiles that are skipped by the horizontal pass have to read as zero in the vertical pass
+            constexpr float clearColor[4] = { 0.f, 0.f, 0.f, 0.f };
+            context.ClearUnorderedAccessView(graph.GetView(bloomB, ViewType::UnorderedAccess), clearColor);
+        })
+            .ReadShaderResource(tileMask, ShaderStage::Compute, 0)
+            .WriteUnorderedAccess(horizontalTiles, 0)
+            .WriteUnorderedAccess(verticalTiles, 1)
+            .WriteUnorderedAccess(dispatchArgs, 2)
+            .Write(bloomB);
+    }
+
+    // 2. Gaussian blur (in two passes) from bloom A to bloom B and back
+    // (the sparse variant only processes the tiles in the lists, tiles skipped by the vertical pass keep the zero output of the threshold pass)
+    const FrameGraphResource blurInputs[2] = { bloomA, bloomB };
+    const FrameGraphResource blurOutputs[2] = { bloomB, bloomA };
+    const FrameGraphResource tileLists[2] = { horizontalTiles, verticalTiles };
+    for (uint32_t direction = 0; direction < 2; ++direction)
+    {
+        FrameGraph::PassBuilder pass = graph.AddPass((direction == 0) ? "blur horizontal" : "blur vertical",
+            [this, &inputs, halfResolution, direction, dispatchX, dispatchY](RenderContext& context)
+        {
+            BlurParams blurParams = inputs.blurParams;
+            blurParams.direction = static_cast<int>(direction);
+            blurParams.size[0] = static_cast<int>(halfResolution.width);
+            blurParams.size[1] = static_cast<int>(halfResolution.height);
+            context.UpdateBuffer(m_blurConstantBuffer, &blurParams, sizeof(BlurParams));
+
+            context.SetShader(ShaderStage::Compute, inputs.sparseBloom ? m_blurTilesShader : m_blurShader);
+            context.SetConstantBuffers(ShaderStage::Compute, 0, 1, &m_blurConstantBuffer);
+
+            if (inputs.sparseBloom)
+            {
+                // the arguments of the vertical pass follow the three UINTs of the horizontal pass
+                context.DispatchIndirect(m_dispatchArgsBuffer, direction * 3 * sizeof(uint32_t));
+            }
+            else
+            {
+                context.Dispatch(dispatchX, dispatchY, 1);
+            }
+        });
+        pass.ReadShaderResource(blurInputs[direction], ShaderStage::Compute, 0).WriteUnorderedAccess(blurOutputs[direction], 0);
+        if (inputs.sparseBloom)
+        {
+            pass.ReadShaderResource(tileLists[direction], ShaderStage::Compute, 1).Read(dispatchArgs);
+        }
+    }
+
+    // composite the blurred half-res image with the original image in a pixel shader by rendering a fullscreen quad
+    // to the back buffer (no need to clear since we render a fullscreen quad without depth test)
+    graph.AddPass("composite", [this, &inputs, &renderResolution, halfResolution](RenderContext& context)
+    {
+        context.SetViewport(static_cast<float>(m_outputResolution.width), static_cast<float>(m_outputResolution.height));
+
+        context.SetShader(ShaderStage::Vertex, m_quadCompositeVertexShader);
+        context.SetShader(ShaderStage::Pixel, m_quadCompositePixelShader);
+        context.SetInputLayout(m_quadInputLayout);
+        context.SetVertexBuffer(m_quadVertexBuffer, sizeof(VertexPosTexCoord), 0);
+        context.SetPrimitiveTopology(PrimitiveTopology::TriangleList);
+        context.SetSamplers(ShaderStage::Pixel, 0, 1, &m_defaultSamplerState);
+
+        CompositeParams compParams;
+        compParams.uvScale[0] = static_cast<float>(renderResolution.width) / static_cast<float>(m_outputResolution.width);
+        compParams.uvScale[1] = static_cast<float>(renderResolution.height) / static_cast<float>(m_outputResolution.height);
+        // the last rendered texel center of the half-res bloom texture is at (halfResolution - 0.5)
+        compParams.bloomUVMax[0] = (static_cast<float>(halfResolution.width) - 0.5f) / static_cast<float>(m_outputResolution.width / 2);
+        compParams.bloomUVMax[1] = (static_cast<float>(halfResolution.height) - 0.5f) / static_cast<float>(m_outputResolution.height / 2);
+        compParams.coefficient = inputs.compositeCoefficient;
+        context.UpdateBuffer(m_compositionConstantBuffer, &compParams, sizeof(CompositeParams));
+        context.SetConstantBuffers(ShaderStage::Pixel, 0, 1, &m_compositionConstantBuffer);
+
+        context.Draw(static_cast<uint32_t>(ScreenAlignedQuad.size()));
+    })
+        .ReadShaderResource(scene, ShaderStage::Pixel, 0)
+        .ReadShaderResource(bloomA, ShaderStage::Pixel, 1)
+        .WriteRenderTarget(backBuffer, 0);
+
+    if (graph.Compile())
+    {
+        graph.Execute(context);
+    }
+
+    // render targets of an earlier output resolution are released after a few frames
+    m_texturePool->EndFrame();
+}
+
+bool BloomRenderer::CreateTileBuffers()
+{
+    // tile mask and tile lists for the sparse bloom (one entry per tile of the half-res bloom targets)
+    const uint32_t tileCount = DispatchGroupCount(m_outputResolution.width / 2, BLOOM_TILE_SIZE) * DispatchGroupCount(m_outputResolution.height / 2, BLOOM_TILE_SIZE);
+    return CreateStructuredBuffer(tileCount, m_tileMaskBuffer) && CreateStructuredBuffer(tileCount, m_horizontalTileBuffer)
+        && CreateStructuredBuffer(tileCount, m_verticalTileBuffer);
+}
+
+void BloomRenderer::ReleaseTileBuffers()
+{
+    ReleaseStructuredBuffer(m_tileMaskBuffer);
+    ReleaseStructuredBuffer(m_horizontalTileBuffer);
+    ReleaseStructuredBuffer(m_verticalTileBuffer);
+}
+
+bool BloomRenderer::CreateStructuredBuffer(uint32_t elementCount, StructuredBuffer& structuredBuffer)
+{
+    BufferDesc bd;
+    bd.size = elementCount * sizeof(uint32_t);
+    bd.bindFlags = BIND_SHADER_RESOURCE | BIND_UNORDERED_ACCESS;
+    bd.structureStride = sizeof(uint32_t);
+
+    structuredBuffer.buffer = m_device->CreateBuffer(bd);
+    if (!CheckCreated(structuredBuffer.buffer, "structured buffer"))
+    {
+        return false;
+    }
+
+    structuredBuffer.shaderResourceView = m_device->CreateView(structuredBuffer.buffer, ViewType::ShaderResource);
+    structuredBuffer.unorderedAccessView = m_device->CreateView(structuredBuffer.buffer, ViewType::UnorderedAccess);
+    return CheckCreated(structuredBuffer.shaderResourceView, "structured buffer SRV") && CheckCreated(structuredBuffer.unorderedAccessView, "structured buffer UAV");
+}
+
+void BloomRenderer::ReleaseStructuredBuffer(StructuredBuffer& structuredBuffer)
+{
+    m_device->Release(structuredBuffer.unorderedAccessView);
+    m_device->Release(structuredBuffer.shaderResourceView);
+    m_device->Release(structuredBuffer.buffer);
+    structuredBuffer = StructuredBuffer{ };
+}
+
+BufferHandle BloomRenderer::CreateConstantBuffer(uint32_t size, const void* initialData)
+{
+    BufferDesc bd;
+    bd.size = size;
+    bd.bindFlags = BIND_CONSTANT_BUFFER;
+    bd.dynamic = true;
+
+    return m_device->CreateBuffer(bd, initialData);
+}
@@ -0,0 +1,803 @@
+#include "render/cpurenderdevice.h"
+
+#include "bloomparams.h"
+#include "cpu/bloom.h"
+#include "util/threadpool.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+namespace
+{
+    // thread group size of the compute shaders (numthreads(8, 8, 1)) and of the tile classification (numthreads(64, 1, 1))
+    constexpr uint32_t COMPUTE_GROUP_SIZE = BLOOM_TILE_SIZE;
+    constexpr uint32_t CLASSIFY_GROUP_SIZE = 64;
+
+    // structured and raw buffers are accessed as 32-bit values, out-of-bounds reads return 0 and writes are discarded
+    inline uint32_t LoadUint(const std::vector<uint8_t>& buffer, size_t index) noexcept
+    {
+        uint32_t value = 0;
+        if ((index + 1) * sizeof(uint32_t) <= buffer.size())
+        {
+            std::memcpy(&value, buffer.data() + index * sizeof(uint32_t), sizeof(uint32_t));
+        }
+        return value;
+    }
+
+    inline void StoreUint(std::vector<uint8_t>& buffer, size_t index, uint32_t value) noexcept
+    {
+        if ((index + 1) * sizeof(uint32_t) <= buffer.size())
+        {
+            std::memcpy(buffer.data() + index * sizeof(uint32_t), &value, sizeof(uint32_t));
+        }
+    }
+
+    // file name without the directory, so that the shaders are found independent of the path they are loaded from
+    std::string GetFileName(const std::string& path)
+    {
+        const size_t separator = path.find_last_of("/\\");
+        return (separator == std::string::npos) ? path : path.substr(separator + 1);
+    }
+
+    inline uint32_t GetStageIndex(ShaderStage stage) noexcept
+    {
+        return static_cast<uint32_t>(stage);
+    }
+
+    // BlurPixel() of blur.hlsl: unlike the CPU version, texels outside of size are treated as zero
+    inline ColorRGBA32F BlurPixelInRegion(const ImageRGBA32F& input, const BlurParams& params, int x, int y) noexcept
+    {
+        const int radius = std::min(params.radius, GAUSSIAN_RADIUS);
+        const int dx = 1 - params.direction;
+        const int dy = params.direction;
+
+        ColorRGBA32F accumulatedValue = { 0.f, 0.f, 0.f, 0.f };
+        for (int i = -radius; i <= radius; ++i)
+        {
+            const int sampleX = x + i * dx;
+            const int sampleY = y + i * dy;
+            if (sampleX < 0 || sampleY < 0 || sampleX >= params.size[0] || sampleY >= params.size[1])
+            {
+                continue;
+            }
+
+            const float coefficient = params.coefficients[i < 0 ? -i : i];
+            const ColorRGBA32F value = LoadOrZero(input, sampleX, sampleY);
+
+            accumulatedValue.r += coefficient * value.r;
+            accumulatedValue.g += coefficient * value.g;
+            accumulatedValue.b += coefficient * value.b;
+            accumulatedValue.a += coefficient * value.a;
+        }
+
+        return accumulatedValue;
+    }
+}
+
+///////////////////////
+// CpuRenderDevice
+
+CpuRenderDevice::CpuRenderDevice(uint32_t width, uint32_t height, ThreadPool* pool)
+    : m_pool(pool)
+{
+    TextureDesc desc;
+    desc.width = width;
+    desc.height = height;
+    desc.format = Format::R8G8B8A8UnormSrgb;
+    desc.bindFlags = BIND_RENDER_TARGET;
+
+    m_backBuffer = CreateTexture(desc);
+    m_backBufferView = CreateView(m_backBuffer, ViewType::RenderTarget);
+}
+
+BufferHandle CpuRenderDevice::CreateBuffer(const BufferDesc& desc, const void* initialData)
+{
+    if (desc.size == 0)
+    {
+        return BufferHandle::Null;
+    }
+
+    Buffer buffer;
+    buffer.desc = desc;
+    buffer.data.resize(desc.size, 0);
+    if (initialData != nullptr)
+    {
+        std::memcpy(buffer.data.data(), initialData, desc.size);
+    }
+
+    return m_buffers.Add(std::move(buffer));
+}
+
+TextureHandle CpuRenderDevice::CreateTexture(const TextureDesc& desc)
+{
+    if (desc.width == 0 || desc.height == 0 || desc.format == Format::Unknown)
+    {
+        return TextureHandle::Null;
+    }
+
+    Texture texture;
+    texture.desc = desc;
+    // depth buffers are not stored (see above)
+    if (desc.format != Format::D24UnormS8Uint)
+    {
+        texture.image.Resize(desc.width, desc.height);
+        std::fill(texture.image.pixels.begin(), texture.image.pixels.end(), ColorRGBA32F{ 0.f, 0.f, 0.f, 0.f });
+    }
+
+    return m_textures.Add(std::move(texture));
+}
+
+ViewHandle CpuRenderDevice::CreateView(TextureHandle texture, ViewType type)
+{
+    const Texture* object = m_textures.Get(texture);
+    if (object == nullptr)
+    {
+        return ViewHandle::Null;
+    }
+
+    const uint32_t requiredFlags[] = { BIND_RENDER_TARGET, BIND_DEPTH_STENCIL, BIND_SHADER_RESOURCE, BIND_UNORDERED_ACCESS };
+    if ((object->desc.bindFlags & requiredFlags[static_cast<int>(type)]) == 0)
+    {
+        return ViewHandle::Null;
+    }
+
+    return m_views.Add(View{ type, texture, BufferHandle::Null });
+}
+
+ViewHandle CpuRenderDevice::CreateView(BufferHandle buffer, ViewType type)
+{
+    const Buffer* object = m_buffers.Get(buffer);
+    if (object == nullptr)
+    {
+        return ViewHandle::Null;
+    }
+
+    const bool shaderResource = (type == ViewType::ShaderResource && (object->desc.bindFlags & BIND_SHADER_RESOURCE) != 0);
+    const bool unorderedAccess = (type == ViewType::UnorderedAccess && (object->desc.bindFlags & BIND_UNORDERED_ACCESS) != 0);
+    if (!shaderResource && !unorderedAccess)
+    {
+        return ViewHandle::Null;
+    }
+
+    return m_views.Add(View{ type, TextureHandle::Null, buffer });
+}
+
+ShaderHandle CpuRenderDevice::CreateShader(const ShaderDesc& desc)
+{
+    struct KernelEntry
+    {
+        const char* file;
+        const char* entryPoint;
+        ShaderStage stage;
+        Kernel kernel;
+    };
+    static const KernelEntry kernels[] = {
+        { "thresholddownsample.hlsl", "ThresholdAndDownsample", ShaderStage::Compute, Kernel::ThresholdAndDownsample },
+        { "blur.hlsl", "Blur", ShaderStage::Compute, Kernel::Blur },
+        { "blur.hlsl", "BlurTiles", ShaderStage::Compute, Kernel::BlurTiles },
+        { "tileclassify.hlsl", "ClassifyTiles", ShaderStage::Compute, Kernel::ClassifyTiles },
+        { "phong.hlsl", "VSMain", ShaderStage::Vertex, Kernel::PhongVertex },
+        { "phong.hlsl", "PSMain", ShaderStage::Pixel, Kernel::PhongPixel },
+        { "quadcomposite.hlsl", "VSMain", ShaderStage::Vertex, Kernel::QuadCompositeVertex },
+        { "quadcomposite.hlsl", "PSMain", ShaderStage::Pixel, Kernel::QuadCompositePixel } };
+
+    const std::string fileName = GetFileName(desc.file);
+    for (const KernelEntry& entry : kernels)
+    {
+        if (fileName == entry.file && desc.entryPoint == entry.entryPoint && desc.stage == entry.stage)
+        {
+            return m_shaders.Add(Shader{ desc, entry.kernel });
+        }
+    }
+
+    std::cerr << "No CPU kernel for shader " << desc.file << ":" << desc.entryPoint << "\n";
+    return ShaderHandle::Null;
+}
+
+InputLayoutHandle CpuRenderDevice::CreateInputLayout(ShaderHandle vertexShader, const std::vector<VertexElement>& elements)
+{
+    const Shader* shader = m_shaders.Get(vertexShader);
+    if (shader == nullptr || shader->desc.stage != ShaderStage::Vertex || elements.empty())
+    {
+        return InputLayoutHandle::Null;
+    }
+
+    return m_inputLayouts.Add(elements);
+}
+
+DepthStencilStateHandle CpuRenderDevice::CreateDepthStencilState(const DepthStencilDesc& desc)
+{
+    return m_depthStencilStates.Add(desc);
+}
+
+SamplerStateHandle CpuRenderDevice::CreateSamplerState(const SamplerDesc& desc)
+{
+    return m_samplerStates.Add(desc);
+}
+
+RasterizerStateHandle CpuRenderDevice::CreateRasterizerState(const RasterizerDesc& desc)
+{
+    return m_rasterizerStates.Add(desc);
+}
+
+void CpuRenderDevice::Release(BufferHandle buffer)
+{
+    m_buffers.Remove(buffer);
+}
+
+void CpuRenderDevice::Release(TextureHandle texture)
+{
+    m_textures.Remove(texture);
+}
+
+void CpuRenderDevice::Release(ViewHandle view)
+{
+    m_views.Remove(view);
+}
+
+void CpuRenderDevice::Release(ShaderHandle shader)
+{
+    m_shaders.Remove(shader);
+}
+
+void CpuRenderDevice::Release(InputLayoutHandle inputLayout)
+{
+    m_inputLayouts.Remove(inputLayout);
+}
+
+void CpuRenderDevice::Release(DepthStencilStateHandle state)
+{
+    m_depthStencilStates.Remove(state);
+}
+
+void CpuRenderDevice::Release(SamplerStateHandle state)
+{
+    m_samplerStates.Remove(state);
+}
+
+void CpuRenderDevice::Release(RasterizerStateHandle state)
+{
+    m_rasterizerStates.Remove(state);
+}
+
+const BufferDesc* CpuRenderDevice::GetDesc(BufferHandle buffer) const noexcept
+{
+    const Buffer* object = m_buffers.Get(buffer);
+    return (object != nullptr) ? &object->desc : nullptr;
+}
+
+const TextureDesc* CpuRenderDevice::GetDesc(TextureHandle texture) const noexcept
+{
+    const Texture* object = m_textures.Get(texture);
+    return (object != nullptr) ? &object->desc : nullptr;
+}
+
+bool CpuRenderDevice::ResizeBackBuffer(uint32_t width, uint32_t height)
+{
+    Texture* backBuffer = m_textures.Get(m_backBuffer);
+    if (backBuffer == nullptr || width == 0 || height == 0)
+    {
+        return false;
+    }
+
+    backBuffer->desc.width = width;
+    backBuffer->desc.height = height;
+    backBuffer->image.Resize(width, height);
+    return true;
+}
+
+const ImageRGBA32F* CpuRenderDevice::GetTextureImage(TextureHandle texture) const noexcept
+{
+    const Texture* object = m_textures.Get(texture);
+    return (object != nullptr) ? &object->image : nullptr;
+}
+
+const std::vector<uint8_t>* CpuRenderDevice::GetBufferData(BufferHandle buffer) const noexcept
+{
+    const Buffer* object = m_buffers.Get(buffer);
+    return (object != nullptr) ? &object->data : nullptr;
+}
+
+size_t CpuRenderDevice::GetObjectCount() const noexcept
+{
+    return m_buffers.GetSize() + m_textures.GetSize() + m_views.GetSize() + m_shaders.GetSize() + m_inputLayouts.GetSize()
+        + m_depthStencilStates.GetSize() + m_samplerStates.GetSize() + m_rasterizerStates.GetSize();
+}
+
+///////////////////////
+// CpuRenderContext
+
+CpuRenderContext::CpuRenderContext(CpuRenderDevice& device)
+    : m_device(device)
+    , m_viewport{ 0.f, 0.f }
+    , m_renderTarget(ViewHandle::Null)
+    , m_stages{ }
+    , m_unorderedAccessViews{ }
+    , m_vertexBuffer(BufferHandle::Null)
+    , m_vertexStride(0)
+    , m_vertexOffset(0)
+    , m_passName(nullptr)
+{
+}
+
+void CpuRenderContext::SetViewport(float width, float height)
+{
+    m_viewport[0] = width;
+    m_viewport[1] = height;
+}
+
+void CpuRenderContext::SetRasterizerState(RasterizerStateHandle)
+{
+    // implied by the software rasterizer
+}
+
+void CpuRenderContext::SetRenderTargets(uint32_t count, const ViewHandle* renderTargets, ViewHandle)
+{
+    // only a single render target is supported, the depth buffer is implied by the software rasterizer
+    m_renderTarget = (count > 0 && renderTargets != nullptr) ? renderTargets[0] : ViewHandle::Null;
+}
+
+void CpuRenderContext::SetDepthStencilState(DepthStencilStateHandle)
+{
+    // implied by the software rasterizer
+}
+
+void CpuRenderContext::SetShader(ShaderStage stage, ShaderHandle shader)
+{
+    m_stages[GetStageIndex(stage)].shader = shader;
+}
+
+void CpuRenderContext::SetInputLayout(InputLayoutHandle)
+{
+    // the kernels read the vertices in the layout of VertexPosNormal
+}
+
+void CpuRenderContext::SetVertexBuffer(BufferHandle buffer, uint32_t stride, uint32_t offset)
+{
+    m_vertexBuffer = buffer;
+    m_vertexStride = stride;
+    m_vertexOffset = offset;
+}
+
+void CpuRenderContext::SetPrimitiveTopology(PrimitiveTopology)
+{
+    // only triangle lists are supported
+}
+
+void CpuRenderContext::SetConstantBuffers(ShaderStage stage, uint32_t slot, uint32_t count, const BufferHandle* buffers)
+{
+    for (uint32_t i = 0; i < count && slot + i < SLOT_COUNT; ++i)
+    {
+        m_stages[GetStageIndex(stage)].constantBuffers[slot + i] = buffers[i];
+    }
+}
+
+void CpuRenderContext::SetShaderResources(ShaderStage stage, uint32_t slot, uint32_t count, const ViewHandle* views)
+{
+    for (uint32_t i = 0; i < count && slot + i < SLOT_COUNT; ++i)
+    {
+        m_stages[GetStageIndex(stage)].shaderResources[slot + i] = views[i];
+    }
+}
+
+void CpuRenderContext::SetUnorderedAccessViews(uint32_t slot, uint32_t count, const ViewHandle* views)
+{
+    for (uint32_t i = 0; i < count && slot + i < SLOT_COUNT; ++i)
+    {
+        m_unorderedAccessViews[slot + i] = views[i];
+    }
+}
+
+void CpuRenderContext::SetSamplers(ShaderStage stage, uint32_t slot, uint32_t count, const SamplerStateHandle* samplers)
+{
+    for (uint32_t i = 0; i < count && slot + i < SLOT_COUNT; ++i)
+    {
+        m_stages[GetStageIndex(stage)].samplers[slot + i] = samplers[i];
+    }
+}
+
+void CpuRenderContext::ClearRenderTarget(ViewHandle renderTarget, const float color[4])
+{
+    const CpuRenderDevice::View* view = m_device.m_views.Get(renderTarget);
+    CpuRenderDevice::Texture* texture = (view != nullptr && view->type == ViewType::RenderTarget) ? m_device.m_textures.Get(view->texture) : nullptr;
+    if (texture != nullptr)
+    {
+        std::fill(texture->image.pixels.begin(), texture->image.pixels.end(), ColorRGBA32F{ color[0], color[1], color[2], color[3] });
+    }
+}
+
+void CpuRenderContext::ClearDepth(ViewHandle, float)
+{
+    // depth buffers are not stored
+}
+
+void CpuRenderContext::ClearUnorderedAccessView(ViewHandle view, const float values[4])
+{
+    const CpuRenderDevice::View* object = m_device.m_views.Get(view);
+    if (object == nullptr || object->type != ViewType::UnorderedAccess)
+    {
+        return;
+    }
+
+    if (CpuRenderDevice::Texture* texture = m_device.m_textures.Get(object->texture))
+    {
+        std::fill(texture->image.pixels.begin(), texture->image.pixels.end(), ColorRGBA32F{ values[0], values[1], values[2], values[3] });
+    }
+    else if (CpuRenderDevice::Buffer* buffer = m_device.m_buffers.Get(object->buffer))
+    {
+        for (size_t i = 0; i < buffer->data.size() / sizeof(uint32_t); ++i)
+        {
+            StoreUint(buffer->data, i, static_cast<uint32_t>(values[0]));
+        }
+    }
+}
+
+void CpuRenderContext::UpdateBuffer(BufferHandle buffer, const void* data, size_t size)
+{
+    if (CpuRenderDevice::Buffer* object = m_device.m_buffers.Get(buffer))
+    {
+        std::memcpy(object->data.data(), data, std::min(size, object->data.size()));
+    }
+}
+
+void CpuRenderContext::Dispatch(uint32_t groupsX, uint32_t groupsY, uint32_t groupsZ)
+{
+    const CpuRenderDevice::Shader* shader = m_device.m_shaders.Get(m_stages[GetStageIndex(ShaderStage::Compute)].shader);
+    // all kernels are two-dimensional
+    if (shader == nullptr || groupsZ == 0)
+    {
+        return;
+    }
+
+    switch (shader->kernel)
+    {
+    case CpuRenderDevice::Kernel::ThresholdAndDownsample:
+        DispatchThresholdAndDownsample(groupsX, groupsY);
+        break;
+    case CpuRenderDevice::Kernel::Blur:
+        DispatchBlur(groupsX, groupsY, false);
+        break;
+    case CpuRenderDevice::Kernel::BlurTiles:
+        DispatchBlur(groupsX, groupsY, true);
+        break;
+    case CpuRenderDevice::Kernel::ClassifyTiles:
+        DispatchClassifyTiles(groupsX);
+        break;
+    default:
+        break;
+    }
+}
+
+void CpuRenderContext::DispatchIndirect(BufferHandle arguments, uint32_t offset)
+{
+    const CpuRenderDevice::Buffer* buffer = m_device.m_buffers.Get(arguments);
+    if (buffer == nullptr || offset % sizeof(uint32_t) != 0)
+    {
+        return;
+    }
+
+    const size_t index = offset / sizeof(uint32_t);
+    Dispatch(LoadUint(buffer->data, index), LoadUint(buffer->data, index + 1), LoadUint(buffer->data, index + 2));
+}
+
+void CpuRenderContext::Draw(uint32_t vertexCount)
+{
+    const CpuRenderDevice::Shader* vertexShader = m_device.m_shaders.Get(m_stages[GetStageIndex(ShaderStage::Vertex)].shader);
+    const CpuRenderDevice::Shader* pixelShader = m_device.m_shaders.Get(m_stages[GetStageIndex(ShaderStage::Pixel)].shader);
+    if (vertexShader == nullptr || pixelShader == nullptr)
+    {
+        return;
+    }
+
+    if (vertexShader->kernel == CpuRenderDevice::Kernel::PhongVertex && pixelShader->kernel == CpuRenderDevice::Kernel::PhongPixel)
+    {
+        DrawPhong(vertexCount);
+    }
+    else if (vertexShader->kernel == CpuRenderDevice::Kernel::QuadCompositeVertex && pixelShader->kernel == CpuRenderDevice::Kernel::QuadCompositePixel)
+    {
+        DrawQuadComposite();
+    }
+}
+
+void CpuRenderContext::BeginPass(const char* name)
+{
+    m_passName = name;
+    m_passTimer.Start();
+}
+
+void CpuRenderContext::EndPass()
+{
+    if (m_passName == nullptr)
+    {
+        return;
+    }
+
+    m_passTimer.Stop();
+    m_frameTimings.push_back(PassTiming{ m_passName, m_passTimer.GetElapsedTimeMilliseconds() });
+    m_passName = nullptr;
+}
+
+void CpuRenderContext::Present()
+{
+    if (const ImageRGBA32F* backBuffer = m_device.GetTextureImage(m_device.m_backBuffer))
+    {
+        m_device.m_presentedImage = *backBuffer;
+    }
+
+    m_lastFrameTimings.swap(m_frameTimings);
+    m_frameTimings.clear();
+}
+
+const ImageRGBA32F* CpuRenderContext::GetShaderResourceImage(ShaderStage stage, uint32_t slot) const noexcept
+{
+    const CpuRenderDevice::View* view = m_device.m_views.Get(m_stages[GetStageIndex(stage)].shaderResources[slot]);
+    return (view != nullptr && view->type == ViewType::ShaderResource) ? m_device.GetTextureImage(view->texture) : nullptr;
+}
+
+const std::vector<uint8_t>* CpuRenderContext::GetShaderResourceBuffer(ShaderStage stage, uint32_t slot) const noexcept
+{
+    const CpuRenderDevice::View* view = m_device.m_views.Get(m_stages[GetStageIndex(stage)].shaderResources[slot]);
+    return (view != nullptr && view->type == ViewType::ShaderResource) ? m_device.GetBufferData(view->buffer) : nullptr;
+}
+
+ImageRGBA32F* CpuRenderContext::GetUnorderedAccessImage(uint32_t slot) noexcept
+{
+    const CpuRenderDevice::View* view = m_device.m_views.Get(m_unorderedAccessViews[slot]);
+    CpuRenderDevice::Texture* texture = (view != nullptr && view->type == ViewType::UnorderedAccess) ? m_device.m_textures.Get(view->texture) : nullptr;
+    return (texture != nullptr) ? &texture->image : nullptr;
+}
+
+std::vector<uint8_t>* CpuRenderContext::GetUnorderedAccessBuffer(uint32_t slot) noexcept
+{
+    const CpuRenderDevice::View* view = m_device.m_views.Get(m_unorderedAccessViews[slot]);
+    CpuRenderDevice::Buffer* buffer = (view != nullptr && view->type == ViewType::UnorderedAccess) ? m_device.m_buffers.Get(view->buffer) : nullptr;
+    return (buffer != nullptr) ? &buffer->data : nullptr;
+}
+
+ImageRGBA32F* CpuRenderContext::GetRenderTargetImage() noexcept
+{
+    const CpuRenderDevice::View* view = m_device.m_views.Get(m_renderTarget);
+    CpuRenderDevice::Texture* texture = (view != nullptr && view->type == ViewType::RenderTarget) ? m_device.m_textures.Get(view->texture) : nullptr;
+    return (texture != nullptr) ? &texture->image : nullptr;
+}
+
+template <typename T>
+bool CpuRenderContext::GetConstants(ShaderStage stage, uint32_t slot, T& constants) const noexcept
+{
+    const CpuRenderDevice::Buffer* buffer = m_device.m_buffers.Get(m_stages[GetStageIndex(stage)].constantBuffers[slot]);
+    if (buffer == nullptr || buffer->data.size() < sizeof(T))
+    {
+        return false;
+    }
+
+    std::memcpy(&constants, buffer->data.data(), sizeof(T));
+    return true;
+}
+
+void CpuRenderContext::DispatchThresholdAndDownsample(uint32_t groupsX, uint32_t groupsY)
+{
+    ThresholdParams params;
+    const ImageRGBA32F* input = GetShaderResourceImage(ShaderStage::Compute, 0);
+    ImageRGBA32F* output = GetUnorderedAccessImage(0);
+    // the tile mask is optional like in the shader
+    std::vector<uint8_t>* tileMask = GetUnorderedAccessBuffer(1);
+    if (input == nullptr || output == nullptr || !GetConstants(ShaderStage::Compute, 0, params))
+    {
+        return;
+    }
+
+    const uint32_t width = std::min(static_cast<uint32_t>(std::max(params.outputSize[0], 0)), output->width);
+    const uint32_t height = std::min(static_cast<uint32_t>(std::max(params.outputSize[1], 0)), output->height);
+
+    ParallelFor(m_device.m_pool, 0, groupsY, 1, [&](size_t groupRowBegin, size_t groupRowEnd)
+    {
+        for (size_t groupY = groupRowBegin; groupY < groupRowEnd; ++groupY)
+        {
+            for (uint32_t groupX = 0; groupX < groupsX; ++groupX)
+            {
+                bool anyBrightPixel = false;
+                const uint32_t x0 = groupX * COMPUTE_GROUP_SIZE;
+                const uint32_t y0 = static_cast<uint32_t>(groupY) * COMPUTE_GROUP_SIZE;
+                for (uint32_t y = y0; y < std::min(y0 + COMPUTE_GROUP_SIZE, height); ++y)
+                {
+                    for (uint32_t x = x0; x < std::min(x0 + COMPUTE_GROUP_SIZE, width); ++x)
+                    {
+                        const ColorRGBA32F value = ThresholdAndDownsamplePixel(*input, params.threshold, static_cast<int>(x), static_cast<int>(y));
+                        output->At(x, y) = value;
+                        anyBrightPixel = anyBrightPixel || value.r != 0.f || value.g != 0.f || value.b != 0.f;
+                    }
+                }
+
+                if (tileMask != nullptr)
+                {
+                    StoreUint(*tileMask, groupY * static_cast<uint32_t>(std::max(params.tileCountX, 0)) + groupX, anyBrightPixel ? 1 : 0);
+                }
+            }
+        }
+    });
+}
+
+void CpuRenderContext::DispatchBlur(uint32_t groupsX, uint32_t groupsY, bool tiles)
+{
+    BlurParams params;
+    const ImageRGBA32F* input = GetShaderResourceImage(ShaderStage::Compute, 0);
+    const std::vector<uint8_t>* tileList = GetShaderResourceBuffer(ShaderStage::Compute, 1);
+    ImageRGBA32F* output = GetUnorderedAccessImage(0);
+    if (input == nullptr || output == nullptr || (tiles && tileList == nullptr) || !GetConstants(ShaderStage::Compute, 0, params))
+    {
+        return;
+    }
+
+    const uint32_t width = std::min(static_cast<uint32_t>(std::max(params.size[0], 0)), output->width);
+    const uint32_t height = std::min(static_cast<uint32_t>(std::max(params.size[1], 0)), output->height);
+
+    auto blurGroup = [&](uint32_t x0, uint32_t y0)
+    {
+        for (uint32_t y = y0; y < std::min(y0 + COMPUTE_GROUP_SIZE, height); ++y)
+        {
+            for (uint32_t x = x0; x < std::min(x0 + COMPUTE_GROUP_SIZE, width); ++x)
+            {
+                output->At(x, y) = BlurPixelInRegion(*input, params, static_cast<int>(x), static_cast<int>(y));
+            }
+        }
+    };
+
+    if (tiles)
+    {
+        // one group per entry of the tile list
+        ParallelFor(m_device.m_pool, 0, groupsX, 16, [&](size_t begin, size_t end)
+        {
+            for (size_t i = begin; i < end; ++i)
+            {
+                const uint32_t packedTile = LoadUint(*tileList, i);
+                blurGroup((packedTile & 0xffff) * COMPUTE_GROUP_SIZE, (packedTile >> 16) * COMPUTE_GROUP_SIZE);
+            }
+        });
+    }
+    else
+    {
+        ParallelFor(m_device.m_pool, 0, groupsY, 1, [&](size_t groupRowBegin, size_t groupRowEnd)
+        {
+            for (size_t groupY = groupRowBegin; groupY < groupRowEnd; ++groupY)
+            {
+                for (uint32_t groupX = 0; groupX < groupsX; ++groupX)
+                {
+                    blurGroup(groupX * COMPUTE_GROUP_SIZE, static_cast<uint32_t>(groupY) * COMPUTE_GROUP_SIZE);
+                }
+            }
+        });
+    }
+}
+
+void CpuRenderContext::DispatchClassifyTiles(uint32_t groupsX)
+{
+    TileClassifyParams params;
+    const std::vector<uint8_t>* tileMask = GetShaderResourceBuffer(ShaderStage::Compute, 0);
+    std::vector<uint8_t>* horizontalTiles = GetUnorderedAccessBuffer(0);
+    std::vector<uint8_t>* verticalTiles = GetUnorderedAccessBuffer(1);
+    std::vector<uint8_t>* dispatchArgs = GetUnorderedAccessBuffer(2);
+    if (tileMask == nullptr || horizontalTiles == nullptr || verticalTiles == nullptr || dispatchArgs == nullptr
+        || !GetConstants(ShaderStage::Compute, 0, params))
+    {
+        return;
+    }
+
+    const int tileCount = params.tileCount[0] * params.tileCount[1];
+    const int threadCount = std::min(static_cast<int>(groupsX * CLASSIFY_GROUP_SIZE), tileCount);
+
+    // serially, so that the InterlockedAdd() of the shader becomes a plain increment
+    for (int tileIndex = 0; tileIndex < threadCount; ++tileIndex)
+    {
+        const int tileX = tileIndex % params.tileCount[0];
+        const int tileY = tileIndex / params.tileCount[0];
+
+        bool horizontal = false;
+        bool vertical = false;
+        for (int dy = -params.tileRadius; dy <= params.tileRadius; ++dy)
+        {
+            for (int dx = -params.tileRadius; dx <= params.tileRadius; ++dx)
+            {
+                const int neighborX = tileX + dx;
+                const int neighborY = tileY + dy;
+                if (neighborX >= 0 && neighborY >= 0 && neighborX < params.tileCount[0] && neighborY < params.tileCount[1]
+                    && LoadUint(*tileMask, static_cast<size_t>(neighborY) * params.tileCount[0] + neighborX) != 0)
+                {
+                    vertical = true;
+                    horizontal = horizontal || (dy == 0);
+                }
+            }
+        }
+
+        const uint32_t packedTile = static_cast<uint32_t>(tileX) | (static_cast<uint32_t>(tileY) << 16);
+        if (horizontal)
+        {
+            const uint32_t slot = LoadUint(*dispatchArgs, 0);
+            StoreUint(*dispatchArgs, 0, slot + 1);
+            StoreUint(*horizontalTiles, slot, packedTile);
+        }
+        if (vertical)
+        {
+            const uint32_t slot = LoadUint(*dispatchArgs, 3);
+            StoreUint(*dispatchArgs, 3, slot + 1);
+            StoreUint(*verticalTiles, slot, packedTile);
+        }
+    }
+}
+
+void CpuRenderContext::DrawPhong(uint32_t vertexCount)
+{
+    SceneTransforms transforms;
+    SceneLight light;
+    SceneMaterial material;
+    const CpuRenderDevice::Buffer* vertexBuffer = m_device.m_buffers.Get(m_vertexBuffer);
+    ImageRGBA32F* target = GetRenderTargetImage();
+    if (vertexBuffer == nullptr || target == nullptr || m_vertexStride != sizeof(VertexPosNormal) || m_vertexOffset > vertexBuffer->data.size()
+        || !GetConstants(ShaderStage::Vertex, 0, transforms) || !GetConstants(ShaderStage::Pixel, 0, light) || !GetConstants(ShaderStage::Pixel, 1, material))
+    {
+        return;
+    }
+
+    const uint32_t width = static_cast<uint32_t>(m_viewport[0]);
+    const uint32_t height = static_cast<uint32_t>(m_viewport[1]);
+    if (width == 0 || height == 0)
+    {
+        return;
+    }
+
+    // whole triangles of the vertex buffer
+    const size_t availableVertices = (vertexBuffer->data.size() - m_vertexOffset) / sizeof(VertexPosNormal);
+    m_vertices.resize(std::min<size_t>(vertexCount, availableVertices) / 3 * 3);
+    std::memcpy(m_vertices.data(), vertexBuffer->data.data() + m_vertexOffset, m_vertices.size() * sizeof(VertexPosNormal));
+
+    m_rasterizer.Render(m_vertices, transforms, light, material, width, height, m_sceneColor, m_device.m_pool);
+
+    const uint32_t copyWidth = std::min(width, target->width);
+    for (uint32_t y = 0; y < std::min(height, target->height); ++y)
+    {
+        std::memcpy(target->Row(y), m_sceneColor.Row(y), copyWidth * sizeof(ColorRGBA32F));
+    }
+}
+
+void CpuRenderContext::DrawQuadComposite()
+{
+    CompositeParams params;
+    const ImageRGBA32F* scene = GetShaderResourceImage(ShaderStage::Pixel, 0);
+    const ImageRGBA32F* bloom = GetShaderResourceImage(ShaderStage::Pixel, 1);
+    ImageRGBA32F* target = GetRenderTargetImage();
+    if (scene == nullptr || bloom == nullptr || target == nullptr || !GetConstants(ShaderStage::Pixel, 0, params))
+    {
+        return;
+    }
+
+    const float viewportWidth = m_viewport[0];
+    const float viewportHeight = m_viewport[1];
+    const uint32_t width = std::min(static_cast<uint32_t>(viewportWidth), target->width);
+    const uint32_t height = std::min(static_cast<uint32_t>(viewportHeight), target->height);
+
+    ParallelFor(m_device.m_pool, 0, height, 16, [&](size_t rowBegin, size_t rowEnd)
+    {
+        for (size_t y = rowBegin; y < rowEnd; ++y)
+        {
+            ColorRGBA32F* targetRow = target->Row(static_cast<uint32_t>(y));
+            // texture coordinates of the quad at the pixel center
+            const float v = (static_cast<float>(y) + 0.5f) / viewportHeight;
+            const float sceneV = v * params.uvScale[1];
+            const float bloomV = std::min(sceneV, params.bloomUVMax[1]);
+
+            for (uint32_t x = 0; x < width; ++x)
+            {
+                const float u = (static_cast<float>(x) + 0.5f) / viewportWidth;
+                const float sceneU = u * params.uvScale[0];
+                const float bloomU = std::min(sceneU, params.bloomUVMax[0]);
+
+                const ColorRGBA32F s = SampleBilinearClamp(*scene, sceneU * scene->width, sceneV * scene->height);
+                const ColorRGBA32F b = SampleBilinearClamp(*bloom, bloomU * bloom->width, bloomV * bloom->height);
+
+                // output: tex0 + coefficient * tex1
+                targetRow[x] = ColorRGBA32F{ params.coefficient * b.r + s.r, params.coefficient * b.g + s.g, params.coefficient * b.b + s.b,
+                    params.coefficient * b.a + s.a };
+            }
+        }
+    });
+}
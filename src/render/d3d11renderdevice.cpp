@@ -0,0 +1,952 @@
+#define NOMINMAX
+#include "render/d3d11renderdevice.h"
+
+#include <d3dx11.h>
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+namespace
+{
+    DXGI_FORMAT ToDXGIFormat(Format format) noexcept
+    {
+        switch (format)
+        {
+        case Format::R8G8B8A8Unorm:
+            return DXGI_FORMAT_R8G8B8A8_UNORM;
+        case Format::R8G8B8A8UnormSrgb:
+            return DXGI_FORMAT_R8G8B8A8_UNORM_SRGB;
+        case Format::R32Uint:
+            return DXGI_FORMAT_R32_UINT;
+        case Format::R32G32Float:
+            return DXGI_FORMAT_R32G32_FLOAT;
+        case Format::R32G32B32Float:
+            return DXGI_FORMAT_R32G32B32_FLOAT;
+        case Format::R32G32B32A32Float:
+            return DXGI_FORMAT_R32G32B32A32_FLOAT;
+        case Format::D24UnormS8Uint:
+            return DXGI_FORMAT_D24_UNORM_S8_UINT;
+        default:
+            return DXGI_FORMAT_UNKNOWN;
+        }
+    }
+
+    // BindFlags have the values of D3D11_BIND_FLAG
+    UINT ToD3D11BindFlags(uint32_t bindFlags) noexcept
+    {
+        static_assert(BIND_VERTEX_BUFFER == D3D11_BIND_VERTEX_BUFFER && BIND_CONSTANT_BUFFER == D3D11_BIND_CONSTANT_BUFFER
+            && BIND_SHADER_RESOURCE == D3D11_BIND_SHADER_RESOURCE && BIND_UNORDERED_ACCESS == D3D11_BIND_UNORDERED_ACCESS
+            && BIND_RENDER_TARGET == D3D11_BIND_RENDER_TARGET && BIND_DEPTH_STENCIL == D3D11_BIND_DEPTH_STENCIL, "bind flags differ from D3D11_BIND_FLAG");
+        return static_cast<UINT>(bindFlags);
+    }
+
+    D3D11_COMPARISON_FUNC ToD3D11ComparisonFunc(ComparisonFunc func) noexcept
+    {
+        switch (func)
+        {
+        case ComparisonFunc::Never:
+            return D3D11_COMPARISON_NEVER;
+        case ComparisonFunc::Less:
+            return D3D11_COMPARISON_LESS;
+        case ComparisonFunc::LessEqual:
+            return D3D11_COMPARISON_LESS_EQUAL;
+        default:
+            return D3D11_COMPARISON_ALWAYS;
+        }
+    }
+
+    const char* GetShaderProfile(ShaderStage stage) noexcept
+    {
+        switch (stage)
+        {
+        case ShaderStage::Vertex:
+            return "vs_4_0";
+        case ShaderStage::Pixel:
+            return "ps_4_0";
+        default:
+            return "cs_5_0";
+        }
+    }
+
+    template <typename Interface>
+    void SafeRelease(Interface*& object) noexcept
+    {
+        if (object != nullptr)
+        {
+            object->Release();
+            object = nullptr;
+        }
+    }
+}
+
+D3D11RenderDevice::D3D11RenderDevice(HWND window)
+    : m_swapchain(nullptr)
+    , m_device(nullptr)
+    , m_deviceContext(nullptr)
+    , m_backBufferView(ViewHandle::Null)
+{
+    DXGI_SWAP_CHAIN_DESC scd;
+    ZeroMemory(&scd, sizeof(DXGI_SWAP_CHAIN_DESC));
+
+    scd.BufferCount = 1;                                        // one back buffer
+    scd.BufferDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM_SRGB;    // use SRGB for gamma-corrected output
+    scd.BufferUsage = DXGI_USAGE_RENDER_TARGET_OUTPUT;          // how swap chain is to be used
+    scd.OutputWindow = window;                                  // the window to be used
+    scd.SampleDesc.Count = 1;                                   // how many multisamples
+    scd.Windowed = TRUE;                                        // windowed/full-screen mode
+
+    // create a device, device context and swap chain
+    HRESULT result = D3D11CreateDeviceAndSwapChain(NULL,
+        D3D_DRIVER_TYPE_HARDWARE,
+        NULL,
+        NULL,
+        NULL,
+        NULL,
+        D3D11_SDK_VERSION,
+        &scd,
+        &m_swapchain,
+        &m_device,
+        NULL,
+        &m_deviceContext);
+    if (FAILED(result))
+    {
+        std::cerr << "Failed to create device and swapchain\n";
+        return;
+    }
+
+    // use the back buffer to create the render target view
+    ID3D11Texture2D* pBackBuffer = nullptr;
+    m_swapchain->GetBuffer(0, __uuidof(ID3D11Texture2D), (LPVOID*)&pBackBuffer);
+    if (pBackBuffer == nullptr)
+    {
+        std::cerr << "Could not obtain backbuffer from swapchain\n";
+        return;
+    }
+
+    ID3D11RenderTargetView* backBufferView = nullptr;
+    result = m_device->CreateRenderTargetView(pBackBuffer, nullptr, &backBufferView);
+    pBackBuffer->Release();
+    if (SUCCEEDED(result))
+    {
+        m_backBufferView = m_views.Add(View{ ViewType::RenderTarget, backBufferView });
+    }
+}
+
+D3D11RenderDevice::~D3D11RenderDevice()
+{
+    // everything except the back buffer should have been released by the owners, release what is left anyway
+    m_views.ForEach([](ViewHandle, View& view) { SafeRelease(view.view); });
+    m_buffers.ForEach([](BufferHandle, Buffer& buffer) { SafeRelease(buffer.buffer); });
+    m_textures.ForEach([](TextureHandle, Texture& texture) { SafeRelease(texture.texture); });
+    m_shaders.ForEach([](ShaderHandle, Shader& shader)
+    {
+        SafeRelease(shader.shader);
+        SafeRelease(shader.blob);
+    });
+    m_inputLayouts.ForEach([](InputLayoutHandle, ID3D11InputLayout*& inputLayout) { SafeRelease(inputLayout); });
+    m_depthStencilStates.ForEach([](DepthStencilStateHandle, ID3D11DepthStencilState*& state) { SafeRelease(state); });
+    m_samplerStates.ForEach([](SamplerStateHandle, ID3D11SamplerState*& state) { SafeRelease(state); });
+    m_rasterizerStates.ForEach([](RasterizerStateHandle, ID3D11RasterizerState*& state) { SafeRelease(state); });
+
+    SafeRelease(m_swapchain);
+    SafeRelease(m_deviceContext);
+    SafeRelease(m_device);
+}
+
+BufferHandle D3D11RenderDevice::CreateBuffer(const BufferDesc& desc, const void* initialData)
+{
+    D3D11_BUFFER_DESC bd;
+    ZeroMemory(&bd, sizeof(D3D11_BUFFER_DESC));
+
+    bd.ByteWidth = desc.size;
+    bd.Usage = desc.dynamic ? D3D11_USAGE_DYNAMIC : D3D11_USAGE_DEFAULT;
+    bd.BindFlags = ToD3D11BindFlags(desc.bindFlags);
+    bd.CPUAccessFlags = desc.dynamic ? D3D11_CPU_ACCESS_WRITE : 0;
+    if (desc.structureStride != 0)
+    {
+        bd.MiscFlags = D3D11_RESOURCE_MISC_BUFFER_STRUCTURED;
+        bd.StructureByteStride = desc.structureStride;
+    }
+    if (desc.indirectArgs)
+    {
+        bd.MiscFlags = D3D11_RESOURCE_MISC_DRAWINDIRECT_ARGS | D3D11_RESOURCE_MISC_BUFFER_ALLOW_RAW_VIEWS;
+    }
+
+    D3D11_SUBRESOURCE_DATA data = { };
+    data.pSysMem = initialData;
+
+    ID3D11Buffer* buffer = nullptr;
+    if (FAILED(m_device->CreateBuffer(&bd, (initialData != nullptr) ? &data : nullptr, &buffer)))
+    {
+        return BufferHandle::Null;
+    }
+    return m_buffers.Add(Buffer{ desc, buffer });
+}
+
+TextureHandle D3D11RenderDevice::CreateTexture(const TextureDesc& desc)
+{
+    D3D11_TEXTURE2D_DESC textureDesc;
+    ZeroMemory(&textureDesc, sizeof(D3D11_TEXTURE2D_DESC));
+
+    textureDesc.Width = desc.width;
+    textureDesc.Height = desc.height;
+    textureDesc.MipLevels = 1;
+    textureDesc.ArraySize = 1;
+    textureDesc.Format = ToDXGIFormat(desc.format);
+    textureDesc.SampleDesc.Count = 1;
+    textureDesc.Usage = D3D11_USAGE_DEFAULT;
+    textureDesc.BindFlags = ToD3D11BindFlags(desc.bindFlags);
+
+    ID3D11Texture2D* texture = nullptr;
+    if (FAILED(m_device->CreateTexture2D(&textureDesc, NULL, &texture)))
+    {
+        return TextureHandle::Null;
+    }
+    return m_textures.Add(Texture{ desc, texture });
+}
+
+ViewHandle D3D11RenderDevice::CreateView(TextureHandle texture, ViewType type)
+{
+    const Texture* textureEntry = m_textures.Get(texture);
+    if (textureEntry == nullptr)
+    {
+        return ViewHandle::Null;
+    }
+
+    const DXGI_FORMAT format = ToDXGIFormat(textureEntry->desc.format);
+    HRESULT result = E_FAIL;
+    ID3D11View* view = nullptr;
+    switch (type)
+    {
+    case ViewType::RenderTarget:
+    {
+        D3D11_RENDER_TARGET_VIEW_DESC renderTargetViewDesc;
+        ZeroMemory(&renderTargetViewDesc, sizeof(D3D11_RENDER_TARGET_VIEW_DESC));
+        renderTargetViewDesc.Format = format;
+        renderTargetViewDesc.ViewDimension = D3D11_RTV_DIMENSION_TEXTURE2D;
+
+        ID3D11RenderTargetView* renderTargetView = nullptr;
+        result = m_device->CreateRenderTargetView(textureEntry->texture, &renderTargetViewDesc, &renderTargetView);
+        view = renderTargetView;
+    }
+    break;
+    case ViewType::DepthStencil:
+    {
+        D3D11_DEPTH_STENCIL_VIEW_DESC descDSV;
+        ZeroMemory(&descDSV, sizeof(D3D11_DEPTH_STENCIL_VIEW_DESC));
+        descDSV.Format = format;
+        descDSV.ViewDimension = D3D11_DSV_DIMENSION_TEXTURE2D;
+
+        ID3D11DepthStencilView* depthStencilView = nullptr;
+        result = m_device->CreateDepthStencilView(textureEntry->texture, &descDSV, &depthStencilView);
+        view = depthStencilView;
+    }
+    break;
+    case ViewType::ShaderResource:
+    {
+        D3D11_SHADER_RESOURCE_VIEW_DESC srvDesc;
+        ZeroMemory(&srvDesc, sizeof(D3D11_SHADER_RESOURCE_VIEW_DESC));
+        srvDesc.Format = format;
+        srvDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D;
+        srvDesc.Texture2D.MipLevels = 1;
+
+        ID3D11ShaderResourceView* shaderResourceView = nullptr;
+        result = m_device->CreateShaderResourceView(textureEntry->texture, &srvDesc, &shaderResourceView);
+        view = shaderResourceView;
+    }
+    break;
+    case ViewType::UnorderedAccess:
+    {
+        D3D11_UNORDERED_ACCESS_VIEW_DESC uavDesc;
+        ZeroMemory(&uavDesc, sizeof(D3D11_UNORDERED_ACCESS_VIEW_DESC));
+        uavDesc.Format = format;
+        uavDesc.ViewDimension = D3D11_UAV_DIMENSION_TEXTURE2D;
+
+        ID3D11UnorderedAccessView* unorderedAccessView = nullptr;
+        result = m_device->CreateUnorderedAccessView(textureEntry->texture, &uavDesc, &unorderedAccessView);
+        view = unorderedAccessView;
+    }
+    break;
+    }
+
+    if (FAILED(result))
+    {
+        return ViewHandle::Null;
+    }
+    return m_views.Add(View{ type, view });
+}
+
+ViewHandle D3D11RenderDevice::CreateView(BufferHandle buffer, ViewType type)
+{
+    const Buffer* bufferEntry = m_buffers.Get(buffer);
+    if (bufferEntry == nullptr || (type != ViewType::ShaderResource && type != ViewType::UnorderedAccess))
+    {
+        return ViewHandle::Null;
+    }
+
+    // structured views have the element size of the buffer, raw views consist of 32-bit values
+    const BufferDesc& desc = bufferEntry->desc;
+    const bool raw = desc.indirectArgs;
+    const UINT elementCount = desc.size / (raw ? sizeof(uint32_t) : std::max<uint32_t>(desc.structureStride, 1));
+
+    HRESULT result = E_FAIL;
+    ID3D11View* view = nullptr;
+    if (type == ViewType::ShaderResource)
+    {
+        D3D11_SHADER_RESOURCE_VIEW_DESC srvDesc;
+        ZeroMemory(&srvDesc, sizeof(D3D11_SHADER_RESOURCE_VIEW_DESC));
+        if (raw)
+        {
+            srvDesc.Format = DXGI_FORMAT_R32_TYPELESS;
+            srvDesc.ViewDimension = D3D11_SRV_DIMENSION_BUFFEREX;
+            srvDesc.BufferEx.NumElements = elementCount;
+            srvDesc.BufferEx.Flags = D3D11_BUFFEREX_SRV_FLAG_RAW;
+        }
+        else
+        {
+            srvDesc.Format = DXGI_FORMAT_UNKNOWN;
+            srvDesc.ViewDimension = D3D11_SRV_DIMENSION_BUFFER;
+            srvDesc.Buffer.NumElements = elementCount;
+        }
+
+        ID3D11ShaderResourceView* shaderResourceView = nullptr;
+        result = m_device->CreateShaderResourceView(bufferEntry->buffer, &srvDesc, &shaderResourceView);
+        view = shaderResourceView;
+    }
+    else
+    {
+        D3D11_UNORDERED_ACCESS_VIEW_DESC uavDesc;
+        ZeroMemory(&uavDesc, sizeof(D3D11_UNORDERED_ACCESS_VIEW_DESC));
+        uavDesc.Format = raw ? DXGI_FORMAT_R32_TYPELESS : DXGI_FORMAT_UNKNOWN;
+        uavDesc.ViewDimension = D3D11_UAV_DIMENSION_BUFFER;
+        uavDesc.Buffer.NumElements = elementCount;
+        uavDesc.Buffer.Flags = raw ? D3D11_BUFFER_UAV_FLAG_RAW : 0;
+
+        ID3D11UnorderedAccessView* unorderedAccessView = nullptr;
+        result = m_device->CreateUnorderedAccessView(bufferEntry->buffer, &uavDesc, &unorderedAccessView);
+        view = unorderedAccessView;
+    }
+
+    if (FAILED(result))
+    {
+        return ViewHandle::Null;
+    }
+    return m_views.Add(View{ type, view });
+}
+
+ShaderHandle D3D11RenderDevice::CreateShader(const ShaderDesc& desc)
+{
+    ID3D10Blob* blob = nullptr;
+    ID3D10Blob* errorBlob = nullptr;
+    HRESULT result = D3DX11CompileFromFile(desc.file.c_str(), 0, 0, desc.entryPoint.c_str(), GetShaderProfile(desc.stage), 0, 0, 0, &blob, &errorBlob, 0);
+    if (FAILED(result))
+    {
+        if (errorBlob)
+        {
+            OutputDebugStringA((char*)errorBlob->GetBufferPointer());
+            errorBlob->Release();
+        }
+        return ShaderHandle::Null;
+    }
+
+    ID3D11DeviceChild* shader = nullptr;
+    switch (desc.stage)
+    {
+    case ShaderStage::Vertex:
+    {
+        ID3D11VertexShader* vertexShader = nullptr;
+        result = m_device->CreateVertexShader(blob->GetBufferPointer(), blob->GetBufferSize(), NULL, &vertexShader);
+        shader = vertexShader;
+    }
+    break;
+    case ShaderStage::Pixel:
+    {
+        ID3D11PixelShader* pixelShader = nullptr;
+        result = m_device->CreatePixelShader(blob->GetBufferPointer(), blob->GetBufferSize(), NULL, &pixelShader);
+        shader = pixelShader;
+    }
+    break;
+    case ShaderStage::Compute:
+    {
+        ID3D11ComputeShader* computeShader = nullptr;
+        result = m_device->CreateComputeShader(blob->GetBufferPointer(), blob->GetBufferSize(), NULL, &computeShader);
+        shader = computeShader;
+    }
+    break;
+    }
+
+    if (FAILED(result))
+    {
+        blob->Release();
+        return ShaderHandle::Null;
+    }
+    return m_shaders.Add(Shader{ desc, blob, shader });
+}
+
+InputLayoutHandle D3D11RenderDevice::CreateInputLayout(ShaderHandle vertexShader, const std::vector<VertexElement>& elements)
+{
+    const Shader* shader = m_shaders.Get(vertexShader);
+    if (shader == nullptr || shader->desc.stage != ShaderStage::Vertex)
+    {
+        return InputLayoutHandle::Null;
+    }
+
+    std::vector<D3D11_INPUT_ELEMENT_DESC> ied(elements.size());
+    for (size_t i = 0; i < elements.size(); ++i)
+    {
+        ied[i] = { elements[i].semantic.c_str(), 0, ToDXGIFormat(elements[i].format), 0, elements[i].offset, D3D11_INPUT_PER_VERTEX_DATA, 0 };
+    }
+
+    ID3D11InputLayout* inputLayout = nullptr;
+    if (FAILED(m_device->CreateInputLayout(ied.data(), static_cast<UINT>(ied.size()), shader->blob->GetBufferPointer(), shader->blob->GetBufferSize(), &inputLayout)))
+    {
+        return InputLayoutHandle::Null;
+    }
+    return m_inputLayouts.Add(inputLayout);
+}
+
+DepthStencilStateHandle D3D11RenderDevice::CreateDepthStencilState(const DepthStencilDesc& desc)
+{
+    D3D11_DEPTH_STENCIL_DESC dsDesc;
+    ZeroMemory(&dsDesc, sizeof(D3D11_DEPTH_STENCIL_DESC));
+
+    dsDesc.DepthEnable = desc.depthEnable;
+    dsDesc.DepthWriteMask = desc.depthWrite ? D3D11_DEPTH_WRITE_MASK_ALL : D3D11_DEPTH_WRITE_MASK_ZERO;
+    dsDesc.DepthFunc = ToD3D11ComparisonFunc(desc.depthFunc);
+    dsDesc.StencilEnable = false;
+
+    ID3D11DepthStencilState* state = nullptr;
+    if (FAILED(m_device->CreateDepthStencilState(&dsDesc, &state)))
+    {
+        return DepthStencilStateHandle::Null;
+    }
+    return m_depthStencilStates.Add(state);
+}
+
+SamplerStateHandle D3D11RenderDevice::CreateSamplerState(const SamplerDesc& desc)
+{
+    const D3D11_TEXTURE_ADDRESS_MODE addressMode = (desc.addressMode == AddressMode::Wrap) ? D3D11_TEXTURE_ADDRESS_WRAP : D3D11_TEXTURE_ADDRESS_CLAMP;
+
+    D3D11_SAMPLER_DESC sampDesc = { };
+    sampDesc.Filter = (desc.filter == Filter::Point) ? D3D11_FILTER_MIN_MAG_MIP_POINT : D3D11_FILTER_MIN_MAG_MIP_LINEAR;
+    sampDesc.AddressU = addressMode;
+    sampDesc.AddressV = addressMode;
+    sampDesc.AddressW = addressMode;
+    sampDesc.ComparisonFunc = D3D11_COMPARISON_NEVER;
+    sampDesc.MinLOD = 0;
+    sampDesc.MaxLOD = desc.maxLod;
+
+    ID3D11SamplerState* state = nullptr;
+    if (FAILED(m_device->CreateSamplerState(&sampDesc, &state)))
+    {
+        return SamplerStateHandle::Null;
+    }
+    return m_samplerStates.Add(state);
+}
+
+RasterizerStateHandle D3D11RenderDevice::CreateRasterizerState(const RasterizerDesc& desc)
+{
+    D3D11_RASTERIZER_DESC rasterDesc;
+    ZeroMemory(&rasterDesc, sizeof(D3D11_RASTERIZER_DESC));
+
+    rasterDesc.CullMode = (desc.cullMode == CullMode::None) ? D3D11_CULL_NONE : ((desc.cullMode == CullMode::Front) ? D3D11_CULL_FRONT : D3D11_CULL_BACK);
+    rasterDesc.DepthClipEnable = desc.depthClip;
+    rasterDesc.FillMode = D3D11_FILL_SOLID;
+    rasterDesc.FrontCounterClockwise = false;
+
+    ID3D11RasterizerState* state = nullptr;
+    if (FAILED(m_device->CreateRasterizerState(&rasterDesc, &state)))
+    {
+        return RasterizerStateHandle::Null;
+    }
+    return m_rasterizerStates.Add(state);
+}
+
+void D3D11RenderDevice::Release(BufferHandle buffer)
+{
+    if (Buffer* bufferEntry = m_buffers.Get(buffer))
+    {
+        SafeRelease(bufferEntry->buffer);
+        m_buffers.Remove(buffer);
+    }
+}
+
+void D3D11RenderDevice::Release(TextureHandle texture)
+{
+    if (Texture* textureEntry = m_textures.Get(texture))
+    {
+        SafeRelease(textureEntry->texture);
+        m_textures.Remove(texture);
+    }
+}
+
+void D3D11RenderDevice::Release(ViewHandle view)
+{
+    if (View* viewEntry = m_views.Get(view))
+    {
+        SafeRelease(viewEntry->view);
+        m_views.Remove(view);
+    }
+}
+
+void D3D11RenderDevice::Release(ShaderHandle shader)
+{
+    if (Shader* shaderEntry = m_shaders.Get(shader))
+    {
+        SafeRelease(shaderEntry->shader);
+        SafeRelease(shaderEntry->blob);
+        m_shaders.Remove(shader);
+    }
+}
+
+void D3D11RenderDevice::Release(InputLayoutHandle inputLayout)
+{
+    if (ID3D11InputLayout** layout = m_inputLayouts.Get(inputLayout))
+    {
+        SafeRelease(*layout);
+        m_inputLayouts.Remove(inputLayout);
+    }
+}
+
+void D3D11RenderDevice::Release(DepthStencilStateHandle state)
+{
+    if (ID3D11DepthStencilState** stateEntry = m_depthStencilStates.Get(state))
+    {
+        SafeRelease(*stateEntry);
+        m_depthStencilStates.Remove(state);
+    }
+}
+
+void D3D11RenderDevice::Release(SamplerStateHandle state)
+{
+    if (ID3D11SamplerState** stateEntry = m_samplerStates.Get(state))
+    {
+        SafeRelease(*stateEntry);
+        m_samplerStates.Remove(state);
+    }
+}
+
+void D3D11RenderDevice::Release(RasterizerStateHandle state)
+{
+    if (ID3D11RasterizerState** stateEntry = m_rasterizerStates.Get(state))
+    {
+        SafeRelease(*stateEntry);
+        m_rasterizerStates.Remove(state);
+    }
+}
+
+const BufferDesc* D3D11RenderDevice::GetDesc(BufferHandle buffer) const noexcept
+{
+    const Buffer* bufferEntry = m_buffers.Get(buffer);
+    return (bufferEntry != nullptr) ? &bufferEntry->desc : nullptr;
+}
+
+const TextureDesc* D3D11RenderDevice::GetDesc(TextureHandle texture) const noexcept
+{
+    const Texture* textureEntry = m_textures.Get(texture);
+    return (textureEntry != nullptr) ? &textureEntry->desc : nullptr;
+}
+
+bool D3D11RenderDevice::ResizeBackBuffer(uint32_t width, uint32_t height)
+{
+    View* backBufferView = m_views.Get(m_backBufferView);
+    if (backBufferView == nullptr)
+    {
+        return false;
+    }
+
+    // all references to the back buffer have to be released before the swapchain can be resized
+    m_deviceContext->OMSetRenderTargets(0, nullptr, nullptr);
+    SafeRelease(backBufferView->view);
+
+    HRESULT result = m_swapchain->ResizeBuffers(0, width, height, DXGI_FORMAT_UNKNOWN, 0);
+    if (FAILED(result))
+    {
+        std::cerr << "Failed to resize swapchain\n";
+        return false;
+    }
+
+    ID3D11Texture2D* pBackBuffer = nullptr;
+    m_swapchain->GetBuffer(0, __uuidof(ID3D11Texture2D), (LPVOID*)&pBackBuffer);
+    if (pBackBuffer == nullptr)
+    {
+        std::cerr << "Could not obtain backbuffer from swapchain\n";
+        return false;
+    }
+
+    // the view is replaced in place, so that the handle stays valid
+    ID3D11RenderTargetView* renderTargetView = nullptr;
+    result = m_device->CreateRenderTargetView(pBackBuffer, nullptr, &renderTargetView);
+    pBackBuffer->Release();
+    backBufferView->view = renderTargetView;
+    return SUCCEEDED(result);
+}
+
+D3D11RenderContext::D3D11RenderContext(D3D11RenderDevice& device)
+    : m_device(device)
+    , m_deviceContext(device.GetDeviceContext())
+    , m_currentFrame(0)
+    , m_frameBegun(false)
+{
+    D3D11_QUERY_DESC queryDesc = { D3D11_QUERY_TIMESTAMP_DISJOINT, 0 };
+    for (FrameQueries& frame : m_frames)
+    {
+        m_device.GetDevice()->CreateQuery(&queryDesc, &frame.disjoint);
+    }
+}
+
+D3D11RenderContext::~D3D11RenderContext()
+{
+    for (FrameQueries& frame : m_frames)
+    {
+        SafeRelease(frame.disjoint);
+        for (PassQueries& pass : frame.passes)
+        {
+            SafeRelease(pass.begin);
+            SafeRelease(pass.end);
+        }
+    }
+}
+
+template <typename ViewInterface>
+ViewInterface* D3D11RenderContext::GetView(ViewHandle view, ViewType type) const noexcept
+{
+    const D3D11RenderDevice::View* viewEntry = m_device.m_views.Get(view);
+    return (viewEntry != nullptr && viewEntry->type == type) ? static_cast<ViewInterface*>(viewEntry->view) : nullptr;
+}
+
+ID3D11Buffer* D3D11RenderContext::GetBuffer(BufferHandle buffer) const noexcept
+{
+    const D3D11RenderDevice::Buffer* bufferEntry = m_device.m_buffers.Get(buffer);
+    return (bufferEntry != nullptr) ? bufferEntry->buffer : nullptr;
+}
+
+void D3D11RenderContext::SetViewport(float width, float height)
+{
+    D3D11_VIEWPORT viewport = { };
+    viewport.Width = width;
+    viewport.Height = height;
+    viewport.MaxDepth = 1.f;
+    m_deviceContext->RSSetViewports(1, &viewport);
+}
+
+void D3D11RenderContext::SetRasterizerState(RasterizerStateHandle state)
+{
+    ID3D11RasterizerState* const* stateEntry = m_device.m_rasterizerStates.Get(state);
+    m_deviceContext->RSSetState((stateEntry != nullptr) ? *stateEntry : nullptr);
+}
+
+void D3D11RenderContext::SetRenderTargets(uint32_t count, const ViewHandle* renderTargets, ViewHandle depthStencil)
+{
+    ID3D11RenderTargetView* renderTargetViews[MAX_SLOTS] = { };
+    count = std::min(count, MAX_SLOTS);
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        renderTargetViews[i] = GetView<ID3D11RenderTargetView>(renderTargets[i], ViewType::RenderTarget);
+    }
+    m_deviceContext->OMSetRenderTargets(count, renderTargetViews, GetView<ID3D11DepthStencilView>(depthStencil, ViewType::DepthStencil));
+}
+
+void D3D11RenderContext::SetDepthStencilState(DepthStencilStateHandle state)
+{
+    ID3D11DepthStencilState* const* stateEntry = m_device.m_depthStencilStates.Get(state);
+    m_deviceContext->OMSetDepthStencilState((stateEntry != nullptr) ? *stateEntry : nullptr, 0);
+}
+
+void D3D11RenderContext::SetShader(ShaderStage stage, ShaderHandle shader)
+{
+    const D3D11RenderDevice::Shader* shaderEntry = m_device.m_shaders.Get(shader);
+    ID3D11DeviceChild* shaderObject = (shaderEntry != nullptr && shaderEntry->desc.stage == stage) ? shaderEntry->shader : nullptr;
+    switch (stage)
+    {
+    case ShaderStage::Vertex:
+        m_deviceContext->VSSetShader(static_cast<ID3D11VertexShader*>(shaderObject), 0, 0);
+        break;
+    case ShaderStage::Pixel:
+        m_deviceContext->PSSetShader(static_cast<ID3D11PixelShader*>(shaderObject), 0, 0);
+        break;
+    case ShaderStage::Compute:
+        m_deviceContext->CSSetShader(static_cast<ID3D11ComputeShader*>(shaderObject), 0, 0);
+        break;
+    }
+}
+
+void D3D11RenderContext::SetInputLayout(InputLayoutHandle inputLayout)
+{
+    ID3D11InputLayout* const* layout = m_device.m_inputLayouts.Get(inputLayout);
+    m_deviceContext->IASetInputLayout((layout != nullptr) ? *layout : nullptr);
+}
+
+void D3D11RenderContext::SetVertexBuffer(BufferHandle buffer, uint32_t stride, uint32_t offset)
+{
+    ID3D11Buffer* vertexBuffer = GetBuffer(buffer);
+    const UINT strides[1] = { stride };
+    const UINT offsets[1] = { offset };
+    m_deviceContext->IASetVertexBuffers(0, 1, &vertexBuffer, strides, offsets);
+}
+
+void D3D11RenderContext::SetPrimitiveTopology(PrimitiveTopology)
+{
+    m_deviceContext->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+}
+
+void D3D11RenderContext::SetConstantBuffers(ShaderStage stage, uint32_t slot, uint32_t count, const BufferHandle* buffers)
+{
+    ID3D11Buffer* constantBuffers[MAX_SLOTS] = { };
+    count = std::min(count, MAX_SLOTS);
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        constantBuffers[i] = GetBuffer(buffers[i]);
+    }
+
+    switch (stage)
+    {
+    case ShaderStage::Vertex:
+        m_deviceContext->VSSetConstantBuffers(slot, count, constantBuffers);
+        break;
+    case ShaderStage::Pixel:
+        m_deviceContext->PSSetConstantBuffers(slot, count, constantBuffers);
+        break;
+    case ShaderStage::Compute:
+        m_deviceContext->CSSetConstantBuffers(slot, count, constantBuffers);
+        break;
+    }
+}
+
+void D3D11RenderContext::SetShaderResources(ShaderStage stage, uint32_t slot, uint32_t count, const ViewHandle* views)
+{
+    ID3D11ShaderResourceView* shaderResourceViews[MAX_SLOTS] = { };
+    count = std::min(count, MAX_SLOTS);
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        shaderResourceViews[i] = GetView<ID3D11ShaderResourceView>(views[i], ViewType::ShaderResource);
+    }
+
+    switch (stage)
+    {
+    case ShaderStage::Vertex:
+        m_deviceContext->VSSetShaderResources(slot, count, shaderResourceViews);
+        break;
+    case ShaderStage::Pixel:
+        m_deviceContext->PSSetShaderResources(slot, count, shaderResourceViews);
+        break;
+    case ShaderStage::Compute:
+        m_deviceContext->CSSetShaderResources(slot, count, shaderResourceViews);
+        break;
+    }
+}
+
+void D3D11RenderContext::SetUnorderedAccessViews(uint32_t slot, uint32_t count, const ViewHandle* views)
+{
+    constexpr UINT NO_OFFSET = -1;
+
+    ID3D11UnorderedAccessView* unorderedAccessViews[MAX_SLOTS] = { };
+    UINT noOffsets[MAX_SLOTS];
+    count = std::min(count, MAX_SLOTS);
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        unorderedAccessViews[i] = GetView<ID3D11UnorderedAccessView>(views[i], ViewType::UnorderedAccess);
+        noOffsets[i] = NO_OFFSET;
+    }
+    m_deviceContext->CSSetUnorderedAccessViews(slot, count, unorderedAccessViews, noOffsets);
+}
+
+void D3D11RenderContext::SetSamplers(ShaderStage stage, uint32_t slot, uint32_t count, const SamplerStateHandle* samplers)
+{
+    ID3D11SamplerState* samplerStates[MAX_SLOTS] = { };
+    count = std::min(count, MAX_SLOTS);
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        ID3D11SamplerState* const* state = m_device.m_samplerStates.Get(samplers[i]);
+        samplerStates[i] = (state != nullptr) ? *state : nullptr;
+    }
+
+    switch (stage)
+    {
+    case ShaderStage::Vertex:
+        m_deviceContext->VSSetSamplers(slot, count, samplerStates);
+        break;
+    case ShaderStage::Pixel:
+        m_deviceContext->PSSetSamplers(slot, count, samplerStates);
+        break;
+    case ShaderStage::Compute:
+        m_deviceContext->CSSetSamplers(slot, count, samplerStates);
+        break;
+    }
+}
+
+void D3D11RenderContext::ClearRenderTarget(ViewHandle renderTarget, const float color[4])
+{
+    if (ID3D11RenderTargetView* view = GetView<ID3D11RenderTargetView>(renderTarget, ViewType::RenderTarget))
+    {
+        m_deviceContext->ClearRenderTargetView(view, color);
+    }
+}
+
+void D3D11RenderContext::ClearDepth(ViewHandle depthStencil, float depth)
+{
+    if (ID3D11DepthStencilView* view = GetView<ID3D11DepthStencilView>(depthStencil, ViewType::DepthStencil))
+    {
+        m_deviceContext->ClearDepthStencilView(view, D3D11_CLEAR_DEPTH, depth, 0);
+    }
+}
+
+void D3D11RenderContext::ClearUnorderedAccessView(ViewHandle view, const float values[4])
+{
+    if (ID3D11UnorderedAccessView* unorderedAccessView = GetView<ID3D11UnorderedAccessView>(view, ViewType::UnorderedAccess))
+    {
+        m_deviceContext->ClearUnorderedAccessViewFloat(unorderedAccessView, values);
+    }
+}
+
+void D3D11RenderContext::UpdateBuffer(BufferHandle buffer, const void* data, size_t size)
+{
+    const D3D11RenderDevice::Buffer* bufferEntry = m_device.m_buffers.Get(buffer);
+    if (bufferEntry == nullptr)
+    {
+        return;
+    }
+
+    if (bufferEntry->desc.dynamic)
+    {
+        D3D11_MAPPED_SUBRESOURCE ms;
+        if (SUCCEEDED(m_deviceContext->Map(bufferEntry->buffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &ms)))
+        {
+            memcpy(ms.pData, data, std::min<size_t>(size, bufferEntry->desc.size));
+            m_deviceContext->Unmap(bufferEntry->buffer, 0);
+        }
+    }
+    else
+    {
+        m_deviceContext->UpdateSubresource(bufferEntry->buffer, 0, nullptr, data, 0, 0);
+    }
+}
+
+void D3D11RenderContext::Dispatch(uint32_t groupsX, uint32_t groupsY, uint32_t groupsZ)
+{
+    m_deviceContext->Dispatch(groupsX, groupsY, groupsZ);
+}
+
+void D3D11RenderContext::DispatchIndirect(BufferHandle arguments, uint32_t offset)
+{
+    if (ID3D11Buffer* buffer = GetBuffer(arguments))
+    {
+        m_deviceContext->DispatchIndirect(buffer, offset);
+    }
+}
+
+void D3D11RenderContext::Draw(uint32_t vertexCount)
+{
+    m_deviceContext->Draw(vertexCount, 0);
+}
+
+void D3D11RenderContext::BeginPass(const char* name)
+{
+    FrameQueries& frame = m_frames[m_currentFrame];
+    if (!m_frameBegun)
+    {
+        // the slot is reused: timings that are still not available are dropped
+        frame.pending = false;
+        frame.passCount = 0;
+        if (frame.disjoint != nullptr)
+        {
+            m_deviceContext->Begin(frame.disjoint);
+        }
+        m_frameBegun = true;
+    }
+
+    if (frame.passCount == frame.passes.size())
+    {
+        D3D11_QUERY_DESC queryDesc = { D3D11_QUERY_TIMESTAMP, 0 };
+        PassQueries pass = { std::string(), nullptr, nullptr };
+        m_device.GetDevice()->CreateQuery(&queryDesc, &pass.begin);
+        m_device.GetDevice()->CreateQuery(&queryDesc, &pass.end);
+        frame.passes.push_back(pass);
+    }
+
+    PassQueries& pass = frame.passes[frame.passCount];
+    pass.name = name;
+    if (pass.begin != nullptr)
+    {
+        m_deviceContext->End(pass.begin);
+    }
+}
+
+void D3D11RenderContext::EndPass()
+{
+    FrameQueries& frame = m_frames[m_currentFrame];
+    if (!m_frameBegun || frame.passCount == frame.passes.size())
+    {
+        return;
+    }
+
+    PassQueries& pass = frame.passes[frame.passCount];
+    if (pass.end != nullptr)
+    {
+        m_deviceContext->End(pass.end);
+    }
+    ++frame.passCount;
+}
+
+void D3D11RenderContext::Present()
+{
+    if (m_frameBegun)
+    {
+        FrameQueries& frame = m_frames[m_currentFrame];
+        if (frame.disjoint != nullptr)
+        {
+            m_deviceContext->End(frame.disjoint);
+            frame.pending = true;
+        }
+        m_currentFrame = (m_currentFrame + 1) % FRAME_QUERY_COUNT;
+        m_frameBegun = false;
+    }
+
+    // switch the back buffer and the front buffer
+    m_device.GetSwapChain()->Present(0, 0);
+
+    ResolveTimings();
+}
+
+void D3D11RenderContext::ResolveTimings()
+{
+    // the oldest frame is the one in the slot that is used next
+    for (size_t i = 0; i < FRAME_QUERY_COUNT; ++i)
+    {
+        FrameQueries& frame = m_frames[(m_currentFrame + i) % FRAME_QUERY_COUNT];
+        if (!frame.pending)
+        {
+            continue;
+        }
+
+        D3D11_QUERY_DATA_TIMESTAMP_DISJOINT disjointData;
+        if (m_deviceContext->GetData(frame.disjoint, &disjointData, sizeof(disjointData), D3D11_ASYNC_GETDATA_DONOTFLUSH) != S_OK)
+        {
+            // the following frames cannot have completed either
+            return;
+        }
+
+        std::vector<PassTiming> timings;
+        bool available = true;
+        for (size_t pass = 0; pass < frame.passCount && available; ++pass)
+        {
+            UINT64 begin = 0;
+            UINT64 end = 0;
+            available = (m_deviceContext->GetData(frame.passes[pass].begin, &begin, sizeof(begin), D3D11_ASYNC_GETDATA_DONOTFLUSH) == S_OK)
+                && (m_deviceContext->GetData(frame.passes[pass].end, &end, sizeof(end), D3D11_ASYNC_GETDATA_DONOTFLUSH) == S_OK);
+            timings.push_back({ frame.passes[pass].name, static_cast<double>(end - begin) * 1000.0 / static_cast<double>(disjointData.Frequency) });
+        }
+        if (!available)
+        {
+            return;
+        }
+
+        // the timestamps of a disjoint frame (e.g., the GPU clock changed) are not reliable
+        frame.pending = false;
+        if (!disjointData.Disjoint)
+        {
+            m_lastFrameTimings = std::move(timings);
+        }
+    }
+}
@@ -0,0 +1,389 @@
+#include "render/dryrunrenderdevice.h"
+
+#include <algorithm>
+#include <iostream>
+
+namespace
+{
+    inline uint64_t GetTextureMemory(const TextureDesc& desc) noexcept
+    {
+        return static_cast<uint64_t>(desc.width) * desc.height * GetFormatSize(desc.format);
+    }
+}
+
+///////////////////////
+// DryRunRenderDevice
+
+DryRunRenderDevice::DryRunRenderDevice(uint32_t width, uint32_t height)
+    : m_memory(0)
+    , m_peakMemory(0)
+{
+    TextureDesc desc;
+    desc.width = width;
+    desc.height = height;
+    desc.format = Format::R8G8B8A8UnormSrgb;
+    desc.bindFlags = BIND_RENDER_TARGET;
+
+    m_backBuffer = CreateTexture(desc);
+    m_backBufferView = CreateView(m_backBuffer, ViewType::RenderTarget);
+}
+
+BufferHandle DryRunRenderDevice::CreateBuffer(const BufferDesc& desc, const void*)
+{
+    if (desc.size == 0)
+    {
+        return BufferHandle::Null;
+    }
+
+    AddMemory(desc.size);
+    return m_buffers.Add(desc);
+}
+
+TextureHandle DryRunRenderDevice::CreateTexture(const TextureDesc& desc)
+{
+    if (desc.width == 0 || desc.height == 0 || desc.format == Format::Unknown)
+    {
+        return TextureHandle::Null;
+    }
+
+    AddMemory(GetTextureMemory(desc));
+    return m_textures.Add(desc);
+}
+
+ViewHandle DryRunRenderDevice::CreateView(TextureHandle texture, ViewType type)
+{
+    const TextureDesc* desc = m_textures.Get(texture);
+    const uint32_t requiredFlags[] = { BIND_RENDER_TARGET, BIND_DEPTH_STENCIL, BIND_SHADER_RESOURCE, BIND_UNORDERED_ACCESS };
+    if (desc == nullptr || (desc->bindFlags & requiredFlags[static_cast<int>(type)]) == 0)
+    {
+        return ViewHandle::Null;
+    }
+
+    return m_views.Add(View{ type, texture, BufferHandle::Null });
+}
+
+ViewHandle DryRunRenderDevice::CreateView(BufferHandle buffer, ViewType type)
+{
+    const BufferDesc* desc = m_buffers.Get(buffer);
+    if (desc == nullptr)
+    {
+        return ViewHandle::Null;
+    }
+
+    const bool shaderResource = (type == ViewType::ShaderResource && (desc->bindFlags & BIND_SHADER_RESOURCE) != 0);
+    const bool unorderedAccess = (type == ViewType::UnorderedAccess && (desc->bindFlags & BIND_UNORDERED_ACCESS) != 0);
+    if (!shaderResource && !unorderedAccess)
+    {
+        return ViewHandle::Null;
+    }
+
+    return m_views.Add(View{ type, TextureHandle::Null, buffer });
+}
+
+ShaderHandle DryRunRenderDevice::CreateShader(const ShaderDesc& desc)
+{
+    return m_shaders.Add(desc);
+}
+
+InputLayoutHandle DryRunRenderDevice::CreateInputLayout(ShaderHandle vertexShader, const std::vector<VertexElement>& elements)
+{
+    const ShaderDesc* shader = m_shaders.Get(vertexShader);
+    if (shader == nullptr || shader->stage != ShaderStage::Vertex || elements.empty())
+    {
+        return InputLayoutHandle::Null;
+    }
+
+    return m_inputLayouts.Add(elements);
+}
+
+DepthStencilStateHandle DryRunRenderDevice::CreateDepthStencilState(const DepthStencilDesc& desc)
+{
+    return m_depthStencilStates.Add(desc);
+}
+
+SamplerStateHandle DryRunRenderDevice::CreateSamplerState(const SamplerDesc& desc)
+{
+    return m_samplerStates.Add(desc);
+}
+
+RasterizerStateHandle DryRunRenderDevice::CreateRasterizerState(const RasterizerDesc& desc)
+{
+    return m_rasterizerStates.Add(desc);
+}
+
+void DryRunRenderDevice::Release(BufferHandle buffer)
+{
+    if (const BufferDesc* desc = m_buffers.Get(buffer))
+    {
+        m_memory -= desc->size;
+        m_buffers.Remove(buffer);
+    }
+}
+
+void DryRunRenderDevice::Release(TextureHandle texture)
+{
+    if (const TextureDesc* desc = m_textures.Get(texture))
+    {
+        m_memory -= GetTextureMemory(*desc);
+        m_textures.Remove(texture);
+    }
+}
+
+void DryRunRenderDevice::Release(ViewHandle view)
+{
+    m_views.Remove(view);
+}
+
+void DryRunRenderDevice::Release(ShaderHandle shader)
+{
+    m_shaders.Remove(shader);
+}
+
+void DryRunRenderDevice::Release(InputLayoutHandle inputLayout)
+{
+    m_inputLayouts.Remove(inputLayout);
+}
+
+void DryRunRenderDevice::Release(DepthStencilStateHandle state)
+{
+    m_depthStencilStates.Remove(state);
+}
+
+void DryRunRenderDevice::Release(SamplerStateHandle state)
+{
+    m_samplerStates.Remove(state);
+}
+
+void DryRunRenderDevice::Release(RasterizerStateHandle state)
+{
+    m_rasterizerStates.Remove(state);
+}
+
+const BufferDesc* DryRunRenderDevice::GetDesc(BufferHandle buffer) const noexcept
+{
+    return m_buffers.Get(buffer);
+}
+
+const TextureDesc* DryRunRenderDevice::GetDesc(TextureHandle texture) const noexcept
+{
+    return m_textures.Get(texture);
+}
+
+bool DryRunRenderDevice::ResizeBackBuffer(uint32_t width, uint32_t height)
+{
+    TextureDesc* backBuffer = m_textures.Get(m_backBuffer);
+    if (backBuffer == nullptr || width == 0 || height == 0)
+    {
+        return false;
+    }
+
+    m_memory -= GetTextureMemory(*backBuffer);
+    backBuffer->width = width;
+    backBuffer->height = height;
+    AddMemory(GetTextureMemory(*backBuffer));
+    return true;
+}
+
+size_t DryRunRenderDevice::GetObjectCount() const noexcept
+{
+    return m_buffers.GetSize() + m_textures.GetSize() + m_views.GetSize() + m_shaders.GetSize() + m_inputLayouts.GetSize()
+        + m_depthStencilStates.GetSize() + m_samplerStates.GetSize() + m_rasterizerStates.GetSize();
+}
+
+void DryRunRenderDevice::AddMemory(uint64_t bytes) noexcept
+{
+    m_memory += bytes;
+    m_peakMemory = std::max(m_peakMemory, m_memory);
+}
+
+///////////////////////
+// DryRunRenderContext
+
+DryRunRenderContext::DryRunRenderContext(DryRunRenderDevice& device)
+    : m_device(device)
+    , m_shaderResources{ }
+    , m_unorderedAccess{ }
+    , m_renderTargets{ }
+    , m_depthStencil(0)
+    , m_hazardCount(0)
+    , m_passName(nullptr)
+{
+}
+
+void DryRunRenderContext::SetViewport(float, float)
+{
+}
+
+void DryRunRenderContext::SetRasterizerState(RasterizerStateHandle)
+{
+}
+
+void DryRunRenderContext::SetRenderTargets(uint32_t count, const ViewHandle* renderTargets, ViewHandle depthStencil)
+{
+    // D3D11 unbinds the SRVs and UAVs of the new targets
+    for (uint32_t slot = 0; slot < SLOT_COUNT; ++slot)
+    {
+        const uint32_t resource = (slot < count && renderTargets != nullptr) ? GetResource(renderTargets[slot]) : 0;
+        if (resource != 0 && (IsBoundAsShaderResource(resource) || IsBoundAsUnorderedAccess(resource)))
+        {
+            ReportHazard("render target is bound as SRV or UAV");
+        }
+        m_renderTargets[slot] = resource;
+    }
+
+    m_depthStencil = GetResource(depthStencil);
+    if (m_depthStencil != 0 && IsBoundAsShaderResource(m_depthStencil))
+    {
+        ReportHazard("depth-stencil target is bound as SRV");
+    }
+}
+
+void DryRunRenderContext::SetDepthStencilState(DepthStencilStateHandle)
+{
+}
+
+void DryRunRenderContext::SetShader(ShaderStage, ShaderHandle)
+{
+}
+
+void DryRunRenderContext::SetInputLayout(InputLayoutHandle)
+{
+}
+
+void DryRunRenderContext::SetVertexBuffer(BufferHandle, uint32_t, uint32_t)
+{
+}
+
+void DryRunRenderContext::SetPrimitiveTopology(PrimitiveTopology)
+{
+}
+
+void DryRunRenderContext::SetConstantBuffers(ShaderStage, uint32_t, uint32_t, const BufferHandle*)
+{
+}
+
+void DryRunRenderContext::SetShaderResources(ShaderStage stage, uint32_t slot, uint32_t count, const ViewHandle* views)
+{
+    // D3D11 does not bind an SRV of a resource that is bound for writing
+    for (uint32_t i = 0; i < count && slot + i < SLOT_COUNT; ++i)
+    {
+        const uint32_t resource = GetResource(views[i]);
+        if (resource != 0 && (IsBoundAsUnorderedAccess(resource) || IsBoundAsRenderTarget(resource)))
+        {
+            ReportHazard("SRV is bound as UAV or render target");
+        }
+        m_shaderResources[static_cast<uint32_t>(stage)][slot + i] = resource;
+    }
+}
+
+void DryRunRenderContext::SetUnorderedAccessViews(uint32_t slot, uint32_t count, const ViewHandle* views)
+{
+    // D3D11 unbinds the SRVs and render targets of the new UAVs
+    for (uint32_t i = 0; i < count && slot + i < SLOT_COUNT; ++i)
+    {
+        const uint32_t resource = GetResource(views[i]);
+        if (resource != 0 && (IsBoundAsShaderResource(resource) || IsBoundAsRenderTarget(resource)))
+        {
+            ReportHazard("UAV is bound as SRV or render target");
+        }
+        m_unorderedAccess[slot + i] = resource;
+    }
+}
+
+void DryRunRenderContext::SetSamplers(ShaderStage, uint32_t, uint32_t, const SamplerStateHandle*)
+{
+}
+
+void DryRunRenderContext::ClearRenderTarget(ViewHandle, const float[4])
+{
+}
+
+void DryRunRenderContext::ClearDepth(ViewHandle, float)
+{
+}
+
+void DryRunRenderContext::ClearUnorderedAccessView(ViewHandle, const float[4])
+{
+}
+
+void DryRunRenderContext::UpdateBuffer(BufferHandle, const void*, size_t)
+{
+}
+
+void DryRunRenderContext::Dispatch(uint32_t, uint32_t, uint32_t)
+{
+}
+
+void DryRunRenderContext::DispatchIndirect(BufferHandle arguments, uint32_t)
+{
+    if (IsBoundAsUnorderedAccess(static_cast<uint32_t>(arguments) | BUFFER_RESOURCE))
+    {
+        ReportHazard("dispatch arguments are bound as UAV");
+    }
+}
+
+void DryRunRenderContext::Draw(uint32_t)
+{
+}
+
+void DryRunRenderContext::BeginPass(const char* name)
+{
+    m_passName = name;
+    m_passTimer.Start();
+}
+
+void DryRunRenderContext::EndPass()
+{
+    if (m_passName == nullptr)
+    {
+        return;
+    }
+
+    m_passTimer.Stop();
+    m_frameTimings.push_back(PassTiming{ m_passName, m_passTimer.GetElapsedTimeMilliseconds() });
+    m_passName = nullptr;
+}
+
+void DryRunRenderContext::Present()
+{
+    m_lastFrameTimings.swap(m_frameTimings);
+    m_frameTimings.clear();
+}
+
+uint32_t DryRunRenderContext::GetResource(ViewHandle view) const noexcept
+{
+    const DryRunRenderDevice::View* object = m_device.m_views.Get(view);
+    if (object == nullptr)
+    {
+        return 0;
+    }
+    return (object->texture != TextureHandle::Null) ? static_cast<uint32_t>(object->texture) : (static_cast<uint32_t>(object->buffer) | BUFFER_RESOURCE);
+}
+
+bool DryRunRenderContext::IsBoundAsShaderResource(uint32_t resource) const noexcept
+{
+    for (const uint32_t (&stage)[SLOT_COUNT] : m_shaderResources)
+    {
+        if (std::find(stage, stage + SLOT_COUNT, resource) != stage + SLOT_COUNT)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool DryRunRenderContext::IsBoundAsUnorderedAccess(uint32_t resource) const noexcept
+{
+    return std::find(m_unorderedAccess, m_unorderedAccess + SLOT_COUNT, resource) != m_unorderedAccess + SLOT_COUNT;
+}
+
+bool DryRunRenderContext::IsBoundAsRenderTarget(uint32_t resource) const noexcept
+{
+    return resource == m_depthStencil || std::find(m_renderTargets, m_renderTargets + SLOT_COUNT, resource) != m_renderTargets + SLOT_COUNT;
+}
+
+void DryRunRenderContext::ReportHazard(const char* description)
+{
+    std::cerr << "Binding hazard in pass " << (m_passName != nullptr ? m_passName : "(none)") << ": " << description << "\n";
+    ++m_hazardCount;
+}
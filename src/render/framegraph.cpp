@@ -0,0 +1,656 @@
+#include "render/framegraph.h"
+
+#include <algorithm>
+#include <iostream>
+#include <limits>
+
+namespace
+{
+    constexpr size_t NO_PHYSICAL = std::numeric_limits<size_t>::max();
+    // binding keys of imported resources, the keys of physical textures are their index + 1
+    constexpr uint32_t IMPORTED_KEY = 0x80000000u;
+
+    constexpr ShaderStage STAGES[3] = { ShaderStage::Vertex, ShaderStage::Pixel, ShaderStage::Compute };
+
+    bool IsSameDesc(const TextureDesc& a, const TextureDesc& b) noexcept
+    {
+        return a.width == b.width && a.height == b.height && a.format == b.format && a.bindFlags == b.bindFlags;
+    }
+
+    uint64_t GetTextureBytes(const TextureDesc& desc) noexcept
+    {
+        return static_cast<uint64_t>(desc.width) * desc.height * GetFormatSize(desc.format);
+    }
+
+    bool Contains(const std::vector<uint32_t>& keys, uint32_t key) noexcept
+    {
+        return key != 0 && std::find(keys.begin(), keys.end(), key) != keys.end();
+    }
+
+    const char* GetAccessName(int access) noexcept
+    {
+        constexpr const char* names[] = { "shader resource", "unordered access", "render target", "depth-stencil", "read", "write" };
+        return names[access];
+    }
+}
+
+///////////////////////
+// FrameGraph::PassBuilder
+
+FrameGraph::PassBuilder& FrameGraph::PassBuilder::ReadShaderResource(FrameGraphResource resource, ShaderStage stage, uint32_t slot)
+{
+    m_graph.m_passes[m_pass].accesses.push_back({ resource, Access::ShaderResource, stage, slot });
+    return *this;
+}
+
+FrameGraph::PassBuilder& FrameGraph::PassBuilder::WriteUnorderedAccess(FrameGraphResource resource, uint32_t slot)
+{
+    m_graph.m_passes[m_pass].accesses.push_back({ resource, Access::UnorderedAccess, ShaderStage::Compute, slot });
+    return *this;
+}
+
+FrameGraph::PassBuilder& FrameGraph::PassBuilder::WriteRenderTarget(FrameGraphResource resource, uint32_t slot)
+{
+    m_graph.m_passes[m_pass].accesses.push_back({ resource, Access::RenderTarget, ShaderStage::Pixel, slot });
+    return *this;
+}
+
+FrameGraph::PassBuilder& FrameGraph::PassBuilder::WriteDepthStencil(FrameGraphResource resource)
+{
+    m_graph.m_passes[m_pass].accesses.push_back({ resource, Access::DepthStencil, ShaderStage::Pixel, 0 });
+    return *this;
+}
+
+FrameGraph::PassBuilder& FrameGraph::PassBuilder::Read(FrameGraphResource resource)
+{
+    m_graph.m_passes[m_pass].accesses.push_back({ resource, Access::Read, ShaderStage::Compute, 0 });
+    return *this;
+}
+
+FrameGraph::PassBuilder& FrameGraph::PassBuilder::Write(FrameGraphResource resource)
+{
+    m_graph.m_passes[m_pass].accesses.push_back({ resource, Access::Write, ShaderStage::Compute, 0 });
+    return *this;
+}
+
+///////////////////////
+// FrameGraph
+
+FrameGraph::FrameGraph(TexturePool& pool)
+    : m_pool(pool)
+    , m_aliasingEnabled(true)
+    , m_compiled(false)
+    , m_boundShaderResources{ }
+    , m_boundUnorderedAccess{ }
+    , m_boundRenderTargets{ }
+    , m_boundDepthStencil(FrameGraphResource::Null)
+{
+}
+
+FrameGraph::~FrameGraph()
+{
+    ReleasePhysicalTextures();
+}
+
+void FrameGraph::Reset()
+{
+    m_passes.clear();
+    m_resources.clear();
+    m_compiled = false;
+}
+
+FrameGraphResource FrameGraph::CreateTexture(const char* name, const TextureDesc& desc)
+{
+    m_resources.push_back({ name, false, desc, FrameGraphViews{ }, 0, 0, NO_PHYSICAL });
+    return static_cast<FrameGraphResource>(m_resources.size());
+}
+
+FrameGraphResource FrameGraph::Import(const char* name, const FrameGraphViews& views)
+{
+    m_resources.push_back({ name, true, TextureDesc{ }, views, 0, 0, NO_PHYSICAL });
+    return static_cast<FrameGraphResource>(m_resources.size());
+}
+
+FrameGraph::PassBuilder FrameGraph::AddPass(const char* name, std::function<void(RenderContext&)> execute)
+{
+    m_passes.push_back({ name, std::move(execute), { }, false });
+    m_compiled = false;
+    return PassBuilder(*this, m_passes.size() - 1);
+}
+
+bool FrameGraph::Compile()
+{
+    m_compiled = false;
+    m_statistics = FrameGraphStatistics{ };
+    m_statistics.passCount = m_passes.size();
+
+    // validate the accesses: the resource has the view, and a pass does not bind a resource for reading and writing
+    const uint32_t requiredFlags[] = { BIND_SHADER_RESOURCE, BIND_UNORDERED_ACCESS, BIND_RENDER_TARGET, BIND_DEPTH_STENCIL };
+    for (const Pass& pass : m_passes)
+    {
+        for (const PassAccess& access : pass.accesses)
+        {
+            const Resource* resource = GetResource(access.resource);
+            const int accessIndex = static_cast<int>(access.access);
+            if (resource == nullptr || access.slot >= MAX_SLOTS)
+            {
+                std::cerr << "Frame graph pass " << pass.name << ": invalid resource or slot\n";
+                return false;
+            }
+
+            if (accessIndex < 4)
+            {
+                const ViewHandle importedViews[] = { resource->views.shaderResource, resource->views.unorderedAccess, resource->views.renderTarget,
+                    resource->views.depthStencil };
+                const bool hasView = resource->imported ? (importedViews[accessIndex] != ViewHandle::Null) : ((resource->desc.bindFlags & requiredFlags[accessIndex]) != 0);
+                if (!hasView)
+                {
+                    std::cerr << "Frame graph pass " << pass.name << ": " << resource->name << " has no " << GetAccessName(accessIndex) << " view\n";
+                    return false;
+                }
+            }
+
+            for (const PassAccess& other : pass.accesses)
+            {
+                if (other.resource == access.resource && access.access == Access::ShaderResource && IsWrite(other.access)
+                    && other.access != Access::Write)
+                {
+                    std::cerr << "Frame graph pass " << pass.name << ": " << resource->name << " is bound for reading and writing\n";
+                    return false;
+                }
+            }
+        }
+    }
+
+    // cull the passes that do not write anything needed later (imported resources are always needed), a write may
+    // keep parts of the previous contents, so the passes before a needed write are needed as well
+    std::vector<bool> needed(m_resources.size());
+    for (size_t i = 0; i < m_resources.size(); ++i)
+    {
+        needed[i] = m_resources[i].imported;
+    }
+    for (size_t p = m_passes.size(); p-- > 0;)
+    {
+        Pass& pass = m_passes[p];
+        pass.culled = std::none_of(pass.accesses.begin(), pass.accesses.end(), [&needed](const PassAccess& access)
+        {
+            return IsWrite(access.access) && needed[static_cast<size_t>(access.resource) - 1];
+        });
+        if (!pass.culled)
+        {
+            for (const PassAccess& access : pass.accesses)
+            {
+                needed[static_cast<size_t>(access.resource) - 1] = true;
+            }
+        }
+        else
+        {
+            ++m_statistics.culledPassCount;
+        }
+    }
+
+    // lifetimes of the transient resources, which have to be written first
+    std::vector<bool> used(m_resources.size(), false);
+    std::vector<bool> written(m_resources.size(), false);
+    for (size_t p = 0; p < m_passes.size(); ++p)
+    {
+        if (m_passes[p].culled)
+        {
+            continue;
+        }
+
+        for (const PassAccess& access : m_passes[p].accesses)
+        {
+            const size_t index = static_cast<size_t>(access.resource) - 1;
+            Resource& resource = m_resources[index];
+            if (!used[index])
+            {
+                resource.firstPass = p;
+                used[index] = true;
+            }
+            resource.lastPass = p;
+
+            if (IsWrite(access.access))
+            {
+                written[index] = true;
+            }
+        }
+
+        // reads after all writes of the pass, so that a pass may write and read a resource without binding (e.g., clear and read)
+        for (const PassAccess& access : m_passes[p].accesses)
+        {
+            const size_t index = static_cast<size_t>(access.resource) - 1;
+            if (!m_resources[index].imported && !written[index])
+            {
+                std::cerr << "Frame graph pass " << m_passes[p].name << ": " << m_resources[index].name << " is read before it is written\n";
+                return false;
+            }
+        }
+    }
+
+    // assign the transient resources in the order of their first use to the first physical texture with the same
+    // description that is free at that time (this is optimal for resources with the same description)
+    std::vector<size_t> transients;
+    for (size_t i = 0; i < m_resources.size(); ++i)
+    {
+        m_resources[i].physical = NO_PHYSICAL;
+        if (!m_resources[i].imported && used[i])
+        {
+            transients.push_back(i);
+        }
+    }
+    std::stable_sort(transients.begin(), transients.end(), [this](size_t a, size_t b) { return m_resources[a].firstPass < m_resources[b].firstPass; });
+
+    std::vector<TextureDesc> physicalDescs;
+    std::vector<const char*> physicalNames;
+    std::vector<size_t> physicalLastPass;
+    for (size_t index : transients)
+    {
+        Resource& resource = m_resources[index];
+        m_statistics.transientBytes += GetTextureBytes(resource.desc);
+
+        for (size_t p = 0; p < physicalDescs.size() && m_aliasingEnabled; ++p)
+        {
+            if (physicalLastPass[p] < resource.firstPass && IsSameDesc(physicalDescs[p], resource.desc))
+            {
+                resource.physical = p;
+                break;
+            }
+        }
+        if (resource.physical == NO_PHYSICAL)
+        {
+            resource.physical = physicalDescs.size();
+            physicalDescs.push_back(resource.desc);
+            physicalNames.push_back(resource.name.c_str());
+            physicalLastPass.push_back(0);
+            m_statistics.physicalBytes += GetTextureBytes(resource.desc);
+        }
+        physicalLastPass[resource.physical] = resource.lastPass;
+    }
+    m_statistics.transientCount = transients.size();
+    m_statistics.physicalCount = physicalDescs.size();
+
+    if (!AssignPhysicalTextures(physicalDescs, physicalNames))
+    {
+        return false;
+    }
+
+    m_compiled = true;
+    return true;
+}
+
+void FrameGraph::Execute(RenderContext& context)
+{
+    if (!m_compiled)
+    {
+        return;
+    }
+
+    m_statistics.bindCalls = 0;
+    m_statistics.unbindCalls = 0;
+
+    for (const Pass& pass : m_passes)
+    {
+        if (pass.culled)
+        {
+            continue;
+        }
+
+        context.BeginPass(pass.name.c_str());
+        BindPassResources(context, pass);
+        if (pass.execute)
+        {
+            pass.execute(context);
+        }
+        context.EndPass();
+    }
+
+    UnbindAll(context);
+}
+
+ViewHandle FrameGraph::GetView(FrameGraphResource resource, ViewType type) const noexcept
+{
+    const Resource* object = GetResource(resource);
+    if (object == nullptr || (!object->imported && object->physical >= m_physicalTextures.size()))
+    {
+        return ViewHandle::Null;
+    }
+
+    FrameGraphViews views = object->views;
+    if (!object->imported)
+    {
+        const PooledTexture& texture = m_physicalTextures[object->physical];
+        views = { texture.renderTarget, texture.depthStencil, texture.shaderResource, texture.unorderedAccess };
+    }
+
+    switch (type)
+    {
+    case ViewType::RenderTarget:
+        return views.renderTarget;
+    case ViewType::DepthStencil:
+        return views.depthStencil;
+    case ViewType::ShaderResource:
+        return views.shaderResource;
+    default:
+        return views.unorderedAccess;
+    }
+}
+
+void FrameGraph::ReleasePhysicalTextures()
+{
+    for (const PooledTexture& texture : m_physicalTextures)
+    {
+        m_pool.Release(texture);
+    }
+    m_physicalTextures.clear();
+    m_compiled = false;
+}
+
+bool FrameGraph::IsWrite(Access access) noexcept
+{
+    return access != Access::ShaderResource && access != Access::Read;
+}
+
+FrameGraph::Resource* FrameGraph::GetResource(FrameGraphResource resource) noexcept
+{
+    const size_t id = static_cast<size_t>(resource);
+    return (id == 0 || id > m_resources.size()) ? nullptr : &m_resources[id - 1];
+}
+
+const FrameGraph::Resource* FrameGraph::GetResource(FrameGraphResource resource) const noexcept
+{
+    return const_cast<FrameGraph*>(this)->GetResource(resource);
+}
+
+uint32_t FrameGraph::GetBindingKey(FrameGraphResource resource) const noexcept
+{
+    const Resource* object = GetResource(resource);
+    if (object == nullptr)
+    {
+        return 0;
+    }
+    return object->imported ? (IMPORTED_KEY | static_cast<uint32_t>(resource)) : static_cast<uint32_t>(object->physical + 1);
+}
+
+bool FrameGraph::AssignPhysicalTextures(const std::vector<TextureDesc>& descs, const std::vector<const char*>& names)
+{
+    // the pool returns the same textures if the descriptions did not change
+    ReleasePhysicalTextures();
+    for (size_t i = 0; i < descs.size(); ++i)
+    {
+        m_physicalTextures.push_back(m_pool.Acquire(descs[i]));
+        if (m_physicalTextures.back().texture == TextureHandle::Null)
+        {
+            std::cerr << "Failed to create frame graph texture " << names[i] << "\n";
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void FrameGraph::BindPassResources(RenderContext& context, const Pass& pass)
+{
+    // memory the pass reads and writes, and the bindings it declares (the UAVs start with the current bindings)
+    std::vector<uint32_t> readKeys;
+    std::vector<uint32_t> writeKeys;
+    std::vector<uint32_t> outputKeys;
+    FrameGraphResource shaderResources[3][MAX_SLOTS] = { };
+    FrameGraphResource unorderedAccess[MAX_SLOTS];
+    FrameGraphResource renderTargets[MAX_SLOTS] = { };
+    FrameGraphResource depthStencil = FrameGraphResource::Null;
+    std::copy(m_boundUnorderedAccess, m_boundUnorderedAccess + MAX_SLOTS, unorderedAccess);
+    bool declaresRenderTargets = false;
+    bool declaresUnorderedAccess[MAX_SLOTS] = { };
+
+    for (const PassAccess& access : pass.accesses)
+    {
+        const uint32_t key = GetBindingKey(access.resource);
+        switch (access.access)
+        {
+        case Access::ShaderResource:
+            shaderResources[static_cast<int>(access.stage)][access.slot] = access.resource;
+            readKeys.push_back(key);
+            break;
+        case Access::Read:
+            readKeys.push_back(key);
+            break;
+        case Access::UnorderedAccess:
+            unorderedAccess[access.slot] = access.resource;
+            declaresUnorderedAccess[access.slot] = true;
+            writeKeys.push_back(key);
+            break;
+        case Access::RenderTarget:
+            renderTargets[access.slot] = access.resource;
+            declaresRenderTargets = true;
+            writeKeys.push_back(key);
+            outputKeys.push_back(key);
+            break;
+        case Access::DepthStencil:
+            depthStencil = access.resource;
+            declaresRenderTargets = true;
+            writeKeys.push_back(key);
+            outputKeys.push_back(key);
+            break;
+        case Access::Write:
+            writeKeys.push_back(key);
+            break;
+        }
+    }
+
+    // 1. unbind the SRVs of resources the pass writes (the outputs are bound before the SRVs)
+    for (int stage = 0; stage < 3; ++stage)
+    {
+        FrameGraphResource unbound[MAX_SLOTS];
+        std::copy(m_boundShaderResources[stage], m_boundShaderResources[stage] + MAX_SLOTS, unbound);
+        uint32_t first = MAX_SLOTS;
+        uint32_t last = 0;
+        for (uint32_t slot = 0; slot < MAX_SLOTS; ++slot)
+        {
+            if (Contains(writeKeys, GetBindingKey(unbound[slot])))
+            {
+                unbound[slot] = FrameGraphResource::Null;
+                first = std::min(first, slot);
+                last = slot;
+            }
+        }
+        if (first < MAX_SLOTS)
+        {
+            SetShaderResources(context, STAGES[stage], first, last, unbound);
+        }
+    }
+
+    // 2. outputs: UAVs and render targets that hold a resource the pass reads (or binds as another output) are unbound
+    std::vector<uint32_t> unorderedAccessKeys;
+    for (uint32_t slot = 0; slot < MAX_SLOTS; ++slot)
+    {
+        const uint32_t key = GetBindingKey(m_boundUnorderedAccess[slot]);
+        if (!declaresUnorderedAccess[slot] && (Contains(readKeys, key) || Contains(outputKeys, key)))
+        {
+            unorderedAccess[slot] = FrameGraphResource::Null;
+        }
+        if (declaresUnorderedAccess[slot])
+        {
+            unorderedAccessKeys.push_back(GetBindingKey(unorderedAccess[slot]));
+        }
+    }
+
+    if (!declaresRenderTargets)
+    {
+        // keep the render targets unless they conflict
+        bool conflict = Contains(readKeys, GetBindingKey(m_boundDepthStencil)) || Contains(unorderedAccessKeys, GetBindingKey(m_boundDepthStencil));
+        for (uint32_t slot = 0; slot < MAX_SLOTS; ++slot)
+        {
+            const uint32_t key = GetBindingKey(m_boundRenderTargets[slot]);
+            conflict = conflict || Contains(readKeys, key) || Contains(unorderedAccessKeys, key);
+            renderTargets[slot] = m_boundRenderTargets[slot];
+        }
+        depthStencil = m_boundDepthStencil;
+        if (conflict)
+        {
+            std::fill(renderTargets, renderTargets + MAX_SLOTS, FrameGraphResource::Null);
+            depthStencil = FrameGraphResource::Null;
+        }
+    }
+    const bool renderTargetsChanged = !std::equal(renderTargets, renderTargets + MAX_SLOTS, m_boundRenderTargets) || depthStencil != m_boundDepthStencil;
+
+    // the render targets are set before the UAVs unless a new render target is still bound as UAV
+    bool renderTargetInUnorderedAccess = false;
+    for (uint32_t slot = 0; slot < MAX_SLOTS; ++slot)
+    {
+        const uint32_t key = GetBindingKey(m_boundUnorderedAccess[slot]);
+        renderTargetInUnorderedAccess = renderTargetInUnorderedAccess || Contains(outputKeys, key);
+    }
+    if (renderTargetsChanged && !renderTargetInUnorderedAccess)
+    {
+        SetRenderTargets(context, renderTargets, depthStencil);
+    }
+    else if (renderTargetsChanged)
+    {
+        // a render target that becomes a UAV has to be unbound first
+        bool unorderedAccessInRenderTargets = Contains(unorderedAccessKeys, GetBindingKey(m_boundDepthStencil));
+        for (uint32_t slot = 0; slot < MAX_SLOTS; ++slot)
+        {
+            unorderedAccessInRenderTargets = unorderedAccessInRenderTargets || Contains(unorderedAccessKeys, GetBindingKey(m_boundRenderTargets[slot]));
+        }
+        if (unorderedAccessInRenderTargets)
+        {
+            const FrameGraphResource none[MAX_SLOTS] = { };
+            SetRenderTargets(context, none, FrameGraphResource::Null);
+        }
+    }
+
+    uint32_t first = MAX_SLOTS;
+    uint32_t last = 0;
+    for (uint32_t slot = 0; slot < MAX_SLOTS; ++slot)
+    {
+        if (unorderedAccess[slot] != m_boundUnorderedAccess[slot])
+        {
+            first = std::min(first, slot);
+            last = slot;
+        }
+    }
+    if (first < MAX_SLOTS)
+    {
+        SetUnorderedAccessViews(context, first, last, unorderedAccess);
+    }
+
+    if (renderTargetsChanged && renderTargetInUnorderedAccess)
+    {
+        SetRenderTargets(context, renderTargets, depthStencil);
+    }
+
+    // 3. shader resources, the slots the pass does not declare keep their (remaining) bindings
+    for (int stage = 0; stage < 3; ++stage)
+    {
+        first = MAX_SLOTS;
+        last = 0;
+        for (uint32_t slot = 0; slot < MAX_SLOTS; ++slot)
+        {
+            if (shaderResources[stage][slot] == FrameGraphResource::Null)
+            {
+                shaderResources[stage][slot] = m_boundShaderResources[stage][slot];
+            }
+            if (shaderResources[stage][slot] != m_boundShaderResources[stage][slot])
+            {
+                first = std::min(first, slot);
+                last = slot;
+            }
+        }
+        if (first < MAX_SLOTS)
+        {
+            SetShaderResources(context, STAGES[stage], first, last, shaderResources[stage]);
+        }
+    }
+}
+
+void FrameGraph::UnbindAll(RenderContext& context)
+{
+    const FrameGraphResource none[MAX_SLOTS] = { };
+    for (int stage = 0; stage < 3; ++stage)
+    {
+        uint32_t first = MAX_SLOTS;
+        uint32_t last = 0;
+        for (uint32_t slot = 0; slot < MAX_SLOTS; ++slot)
+        {
+            if (m_boundShaderResources[stage][slot] != FrameGraphResource::Null)
+            {
+                first = std::min(first, slot);
+                last = slot;
+            }
+        }
+        if (first < MAX_SLOTS)
+        {
+            SetShaderResources(context, STAGES[stage], first, last, none);
+        }
+    }
+
+    uint32_t first = MAX_SLOTS;
+    uint32_t last = 0;
+    for (uint32_t slot = 0; slot < MAX_SLOTS; ++slot)
+    {
+        if (m_boundUnorderedAccess[slot] != FrameGraphResource::Null)
+        {
+            first = std::min(first, slot);
+            last = slot;
+        }
+    }
+    if (first < MAX_SLOTS)
+    {
+        SetUnorderedAccessViews(context, first, last, none);
+    }
+
+    if (!std::equal(none, none + MAX_SLOTS, m_boundRenderTargets) || m_boundDepthStencil != FrameGraphResource::Null)
+    {
+        SetRenderTargets(context, none, FrameGraphResource::Null);
+    }
+}
+
+void FrameGraph::SetShaderResources(RenderContext& context, ShaderStage stage, uint32_t first, uint32_t last, const FrameGraphResource* resources)
+{
+    ViewHandle views[MAX_SLOTS] = { };
+    bool unbind = true;
+    for (uint32_t slot = first; slot <= last; ++slot)
+    {
+        views[slot - first] = GetView(resources[slot], ViewType::ShaderResource);
+        m_boundShaderResources[static_cast<int>(stage)][slot] = resources[slot];
+        unbind = unbind && (resources[slot] == FrameGraphResource::Null);
+    }
+
+    context.SetShaderResources(stage, first, last - first + 1, views);
+    ++(unbind ? m_statistics.unbindCalls : m_statistics.bindCalls);
+}
+
+void FrameGraph::SetUnorderedAccessViews(RenderContext& context, uint32_t first, uint32_t last, const FrameGraphResource* resources)
+{
+    ViewHandle views[MAX_SLOTS] = { };
+    bool unbind = true;
+    for (uint32_t slot = first; slot <= last; ++slot)
+    {
+        views[slot - first] = GetView(resources[slot], ViewType::UnorderedAccess);
+        m_boundUnorderedAccess[slot] = resources[slot];
+        unbind = unbind && (resources[slot] == FrameGraphResource::Null);
+    }
+
+    context.SetUnorderedAccessViews(first, last - first + 1, views);
+    ++(unbind ? m_statistics.unbindCalls : m_statistics.bindCalls);
+}
+
+void FrameGraph::SetRenderTargets(RenderContext& context, const FrameGraphResource* renderTargets, FrameGraphResource depthStencil)
+{
+    ViewHandle views[MAX_SLOTS] = { };
+    uint32_t count = 0;
+    for (uint32_t slot = 0; slot < MAX_SLOTS; ++slot)
+    {
+        views[slot] = GetView(renderTargets[slot], ViewType::RenderTarget);
+        m_boundRenderTargets[slot] = renderTargets[slot];
+        if (renderTargets[slot] != FrameGraphResource::Null)
+        {
+            count = slot + 1;
+        }
+    }
+    m_boundDepthStencil = depthStencil;
+
+    context.SetRenderTargets(count, views, GetView(depthStencil, ViewType::DepthStencil));
+    ++((count == 0 && depthStencil == FrameGraphResource::Null) ? m_statistics.unbindCalls : m_statistics.bindCalls);
+}
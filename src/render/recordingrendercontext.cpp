@@ -0,0 +1,161 @@
+#include "render/recordingrendercontext.h"
+
+#include <numeric>
+
+const char* GetRenderCallName(RenderCall call) noexcept
+{
+    constexpr const char* names[] = { "SetViewport", "SetRasterizerState", "SetRenderTargets", "SetDepthStencilState", "SetShader", "SetInputLayout",
+        "SetVertexBuffer", "SetPrimitiveTopology", "SetConstantBuffers", "SetShaderResources", "SetUnorderedAccessViews", "SetSamplers",
+        "ClearRenderTarget", "ClearDepth", "ClearUnorderedAccessView", "UpdateBuffer", "Dispatch", "DispatchIndirect", "Draw", "BeginPass", "EndPass",
+        "Present" };
+    static_assert(sizeof(names) / sizeof(names[0]) == static_cast<size_t>(RenderCall::Count), "a name is missing");
+
+    return (call < RenderCall::Count) ? names[static_cast<size_t>(call)] : "";
+}
+
+RecordingRenderContext::RecordingRenderContext(RenderContext& target)
+    : m_target(target)
+    , m_frameCounts{ }
+    , m_lastFrameCounts{ }
+{
+}
+
+void RecordingRenderContext::SetViewport(float width, float height)
+{
+    Count(RenderCall::SetViewport);
+    m_target.SetViewport(width, height);
+}
+
+void RecordingRenderContext::SetRasterizerState(RasterizerStateHandle state)
+{
+    Count(RenderCall::SetRasterizerState);
+    m_target.SetRasterizerState(state);
+}
+
+void RecordingRenderContext::SetRenderTargets(uint32_t count, const ViewHandle* renderTargets, ViewHandle depthStencil)
+{
+    Count(RenderCall::SetRenderTargets);
+    m_target.SetRenderTargets(count, renderTargets, depthStencil);
+}
+
+void RecordingRenderContext::SetDepthStencilState(DepthStencilStateHandle state)
+{
+    Count(RenderCall::SetDepthStencilState);
+    m_target.SetDepthStencilState(state);
+}
+
+void RecordingRenderContext::SetShader(ShaderStage stage, ShaderHandle shader)
+{
+    Count(RenderCall::SetShader);
+    m_target.SetShader(stage, shader);
+}
+
+void RecordingRenderContext::SetInputLayout(InputLayoutHandle inputLayout)
+{
+    Count(RenderCall::SetInputLayout);
+    m_target.SetInputLayout(inputLayout);
+}
+
+void RecordingRenderContext::SetVertexBuffer(BufferHandle buffer, uint32_t stride, uint32_t offset)
+{
+    Count(RenderCall::SetVertexBuffer);
+    m_target.SetVertexBuffer(buffer, stride, offset);
+}
+
+void RecordingRenderContext::SetPrimitiveTopology(PrimitiveTopology topology)
+{
+    Count(RenderCall::SetPrimitiveTopology);
+    m_target.SetPrimitiveTopology(topology);
+}
+
+void RecordingRenderContext::SetConstantBuffers(ShaderStage stage, uint32_t slot, uint32_t count, const BufferHandle* buffers)
+{
+    Count(RenderCall::SetConstantBuffers);
+    m_target.SetConstantBuffers(stage, slot, count, buffers);
+}
+
+void RecordingRenderContext::SetShaderResources(ShaderStage stage, uint32_t slot, uint32_t count, const ViewHandle* views)
+{
+    Count(RenderCall::SetShaderResources);
+    m_target.SetShaderResources(stage, slot, count, views);
+}
+
+void RecordingRenderContext::SetUnorderedAccessViews(uint32_t slot, uint32_t count, const ViewHandle* views)
+{
+    Count(RenderCall::SetUnorderedAccessViews);
+    m_target.SetUnorderedAccessViews(slot, count, views);
+}
+
+void RecordingRenderContext::SetSamplers(ShaderStage stage, uint32_t slot, uint32_t count, const SamplerStateHandle* samplers)
+{
+    Count(RenderCall::SetSamplers);
+    m_target.SetSamplers(stage, slot, count, samplers);
+}
+
+void RecordingRenderContext::ClearRenderTarget(ViewHandle renderTarget, const float color[4])
+{
+    Count(RenderCall::ClearRenderTarget);
+    m_target.ClearRenderTarget(renderTarget, color);
+}
+
+void RecordingRenderContext::ClearDepth(ViewHandle depthStencil, float depth)
+{
+    Count(RenderCall::ClearDepth);
+    m_target.ClearDepth(depthStencil, depth);
+}
+
+void RecordingRenderContext::ClearUnorderedAccessView(ViewHandle view, const float values[4])
+{
+    Count(RenderCall::ClearUnorderedAccessView);
+    m_target.ClearUnorderedAccessView(view, values);
+}
+
+void RecordingRenderContext::UpdateBuffer(BufferHandle buffer, const void* data, size_t size)
+{
+    Count(RenderCall::UpdateBuffer);
+    m_target.UpdateBuffer(buffer, data, size);
+}
+
+void RecordingRenderContext::Dispatch(uint32_t groupsX, uint32_t groupsY, uint32_t groupsZ)
+{
+    Count(RenderCall::Dispatch);
+    m_target.Dispatch(groupsX, groupsY, groupsZ);
+}
+
+void RecordingRenderContext::DispatchIndirect(BufferHandle arguments, uint32_t offset)
+{
+    Count(RenderCall::DispatchIndirect);
+    m_target.DispatchIndirect(arguments, offset);
+}
+
+void RecordingRenderContext::Draw(uint32_t vertexCount)
+{
+    Count(RenderCall::Draw);
+    m_target.Draw(vertexCount);
+}
+
+void RecordingRenderContext::BeginPass(const char* name)
+{
+    Count(RenderCall::BeginPass);
+    m_target.BeginPass(name);
+}
+
+void RecordingRenderContext::EndPass()
+{
+    Count(RenderCall::EndPass);
+    m_target.EndPass();
+}
+
+void RecordingRenderContext::Present()
+{
+    Count(RenderCall::Present);
+    m_target.Present();
+
+    m_lastFrameCounts = m_frameCounts;
+    m_frameCounts.fill(0);
+}
+
+size_t RecordingRenderContext::GetLastFrameCallCount() const noexcept
+{
+    return std::accumulate(m_lastFrameCounts.begin(), m_lastFrameCounts.end(), size_t{ 0 });
+}
@@ -0,0 +1,36 @@
+#include "render/renderdevice.h"
+
+#include <cstdio>
+
+uint32_t GetFormatSize(Format format) noexcept
+{
+    switch (format)
+    {
+    case Format::R8G8B8A8Unorm:
+    case Format::R8G8B8A8UnormSrgb:
+    case Format::R32Uint:
+    case Format::D24UnormS8Uint:
+        return 4;
+    case Format::R32G32Float:
+        return 8;
+    case Format::R32G32B32Float:
+        return 12;
+    case Format::R32G32B32A32Float:
+        return 16;
+    default:
+        return 0;
+    }
+}
+
+std::string FormatPassTimings(const std::vector<PassTiming>& timings)
+{
+    std::string text;
+    for (const PassTiming& timing : timings)
+    {
+        char milliseconds[32];
+        std::snprintf(milliseconds, sizeof(milliseconds), " %.2f ms", timing.milliseconds);
+        text += (text.empty() ? "" : " | ") + timing.name + milliseconds;
+    }
+
+    return text;
+}
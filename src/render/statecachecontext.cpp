@@ -0,0 +1,245 @@
+#include "render/statecachecontext.h"
+
+StateCacheContext::StateCacheContext(RenderContext& target)
+    : m_target(target)
+    , m_droppedCallCount(0)
+{
+    Invalidate();
+}
+
+void StateCacheContext::SetViewport(float width, float height)
+{
+    // both have to be evaluated
+    const bool widthChanged = Update(m_viewport[0], width);
+    const bool heightChanged = Update(m_viewport[1], height);
+    if (widthChanged || heightChanged)
+    {
+        m_target.SetViewport(width, height);
+    }
+    else
+    {
+        ++m_droppedCallCount;
+    }
+}
+
+void StateCacheContext::SetRasterizerState(RasterizerStateHandle state)
+{
+    if (Update(m_rasterizerState, state))
+    {
+        m_target.SetRasterizerState(state);
+    }
+    else
+    {
+        ++m_droppedCallCount;
+    }
+}
+
+void StateCacheContext::SetRenderTargets(uint32_t count, const ViewHandle* renderTargets, ViewHandle depthStencil)
+{
+    m_target.SetRenderTargets(count, renderTargets, depthStencil);
+}
+
+void StateCacheContext::SetDepthStencilState(DepthStencilStateHandle state)
+{
+    if (Update(m_depthStencilState, state))
+    {
+        m_target.SetDepthStencilState(state);
+    }
+    else
+    {
+        ++m_droppedCallCount;
+    }
+}
+
+void StateCacheContext::SetShader(ShaderStage stage, ShaderHandle shader)
+{
+    if (Update(m_stages[static_cast<uint32_t>(stage)].shader, shader))
+    {
+        m_target.SetShader(stage, shader);
+    }
+    else
+    {
+        ++m_droppedCallCount;
+    }
+}
+
+void StateCacheContext::SetInputLayout(InputLayoutHandle inputLayout)
+{
+    if (Update(m_inputLayout, inputLayout))
+    {
+        m_target.SetInputLayout(inputLayout);
+    }
+    else
+    {
+        ++m_droppedCallCount;
+    }
+}
+
+void StateCacheContext::SetVertexBuffer(BufferHandle buffer, uint32_t stride, uint32_t offset)
+{
+    const bool bufferChanged = Update(m_vertexBuffer, buffer);
+    const bool strideChanged = Update(m_vertexStride, stride);
+    const bool offsetChanged = Update(m_vertexOffset, offset);
+    if (bufferChanged || strideChanged || offsetChanged)
+    {
+        m_target.SetVertexBuffer(buffer, stride, offset);
+    }
+    else
+    {
+        ++m_droppedCallCount;
+    }
+}
+
+void StateCacheContext::SetPrimitiveTopology(PrimitiveTopology topology)
+{
+    if (Update(m_primitiveTopology, topology))
+    {
+        m_target.SetPrimitiveTopology(topology);
+    }
+    else
+    {
+        ++m_droppedCallCount;
+    }
+}
+
+void StateCacheContext::SetConstantBuffers(ShaderStage stage, uint32_t slot, uint32_t count, const BufferHandle* buffers)
+{
+    uint32_t first = 0;
+    uint32_t last = 0;
+    if (UpdateRange(m_stages[static_cast<uint32_t>(stage)].constantBuffers, slot, count, buffers, first, last))
+    {
+        m_target.SetConstantBuffers(stage, first, last - first + 1, buffers + (first - slot));
+    }
+    else
+    {
+        ++m_droppedCallCount;
+    }
+}
+
+void StateCacheContext::SetShaderResources(ShaderStage stage, uint32_t slot, uint32_t count, const ViewHandle* views)
+{
+    m_target.SetShaderResources(stage, slot, count, views);
+}
+
+void StateCacheContext::SetUnorderedAccessViews(uint32_t slot, uint32_t count, const ViewHandle* views)
+{
+    m_target.SetUnorderedAccessViews(slot, count, views);
+}
+
+void StateCacheContext::SetSamplers(ShaderStage stage, uint32_t slot, uint32_t count, const SamplerStateHandle* samplers)
+{
+    uint32_t first = 0;
+    uint32_t last = 0;
+    if (UpdateRange(m_stages[static_cast<uint32_t>(stage)].samplers, slot, count, samplers, first, last))
+    {
+        m_target.SetSamplers(stage, first, last - first + 1, samplers + (first - slot));
+    }
+    else
+    {
+        ++m_droppedCallCount;
+    }
+}
+
+void StateCacheContext::ClearRenderTarget(ViewHandle renderTarget, const float color[4])
+{
+    m_target.ClearRenderTarget(renderTarget, color);
+}
+
+void StateCacheContext::ClearDepth(ViewHandle depthStencil, float depth)
+{
+    m_target.ClearDepth(depthStencil, depth);
+}
+
+void StateCacheContext::ClearUnorderedAccessView(ViewHandle view, const float values[4])
+{
+    m_target.ClearUnorderedAccessView(view, values);
+}
+
+void StateCacheContext::UpdateBuffer(BufferHandle buffer, const void* data, size_t size)
+{
+    // a dynamic buffer keeps its bindings when it is mapped with WRITE_DISCARD
+    m_target.UpdateBuffer(buffer, data, size);
+}
+
+void StateCacheContext::Dispatch(uint32_t groupsX, uint32_t groupsY, uint32_t groupsZ)
+{
+    m_target.Dispatch(groupsX, groupsY, groupsZ);
+}
+
+void StateCacheContext::DispatchIndirect(BufferHandle arguments, uint32_t offset)
+{
+    m_target.DispatchIndirect(arguments, offset);
+}
+
+void StateCacheContext::Draw(uint32_t vertexCount)
+{
+    m_target.Draw(vertexCount);
+}
+
+void StateCacheContext::BeginPass(const char* name)
+{
+    m_target.BeginPass(name);
+}
+
+void StateCacheContext::EndPass()
+{
+    m_target.EndPass();
+}
+
+void StateCacheContext::Present()
+{
+    m_target.Present();
+}
+
+void StateCacheContext::Invalidate() noexcept
+{
+    m_viewport[0].valid = false;
+    m_viewport[1].valid = false;
+    m_rasterizerState.valid = false;
+    m_depthStencilState.valid = false;
+    m_inputLayout.valid = false;
+    m_vertexBuffer.valid = false;
+    m_vertexStride.valid = false;
+    m_vertexOffset.valid = false;
+    m_primitiveTopology.valid = false;
+
+    for (StageState& stage : m_stages)
+    {
+        stage.shader.valid = false;
+        for (uint32_t slot = 0; slot < SLOT_COUNT; ++slot)
+        {
+            stage.constantBuffers[slot].valid = false;
+            stage.samplers[slot].valid = false;
+        }
+    }
+}
+
+template <typename T>
+bool StateCacheContext::Update(CachedState<T>& state, const T& value) noexcept
+{
+    if (state.valid && state.value == value)
+    {
+        return false;
+    }
+
+    state.value = value;
+    state.valid = true;
+    return true;
+}
+
+template <typename T>
+bool StateCacheContext::UpdateRange(CachedState<T>* states, uint32_t slot, uint32_t count, const T* values, uint32_t& first, uint32_t& last) noexcept
+{
+    bool changed = false;
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        const uint32_t index = slot + i;
+        if (index >= SLOT_COUNT || Update(states[index], values[i]))
+        {
+            first = changed ? first : index;
+            last = index;
+            changed = true;
+        }
+    }
+    return changed;
+}
@@ -0,0 +1,169 @@
+#include "render/texturepool.h"
+
+#include "util/hash.h"
+
+#include <iostream>
+#include <iterator>
+
+namespace
+{
+    inline bool IsSameDesc(const TextureDesc& a, const TextureDesc& b) noexcept
+    {
+        return a.width == b.width && a.height == b.height && a.format == b.format && a.bindFlags == b.bindFlags;
+    }
+
+    inline uint64_t GetTextureMemory(const TextureDesc& desc) noexcept
+    {
+        return static_cast<uint64_t>(desc.width) * desc.height * GetFormatSize(desc.format);
+    }
+}
+
+TexturePool::TexturePool(RenderDevice& device, uint32_t maxUnusedFrames)
+    : m_device(device)
+    , m_maxUnusedFrames(maxUnusedFrames)
+    , m_frame(0)
+{
+}
+
+TexturePool::~TexturePool()
+{
+    DestroyIf([](const Entry&) { return true; });
+}
+
+PooledTexture TexturePool::Acquire(const TextureDesc& desc)
+{
+    std::vector<Entry>& bucket = m_textures[GetKey(desc)];
+    for (Entry& entry : bucket)
+    {
+        if (!entry.inUse && IsSameDesc(entry.texture.desc, desc))
+        {
+            entry.inUse = true;
+            entry.lastUsedFrame = m_frame;
+            ++m_statistics.hits;
+            ++m_statistics.inUseCount;
+            return entry.texture;
+        }
+    }
+
+    ++m_statistics.misses;
+    Entry entry = { PooledTexture{ }, true, m_frame };
+    PooledTexture& texture = entry.texture;
+    texture.desc = desc;
+    texture.texture = m_device.CreateTexture(desc);
+    if (texture.texture == TextureHandle::Null)
+    {
+        std::cerr << "Failed to create pooled texture\n";
+        return PooledTexture{ };
+    }
+
+    const ViewType types[] = { ViewType::RenderTarget, ViewType::DepthStencil, ViewType::ShaderResource, ViewType::UnorderedAccess };
+    const uint32_t flags[] = { BIND_RENDER_TARGET, BIND_DEPTH_STENCIL, BIND_SHADER_RESOURCE, BIND_UNORDERED_ACCESS };
+    ViewHandle* views[] = { &texture.renderTarget, &texture.depthStencil, &texture.shaderResource, &texture.unorderedAccess };
+    for (size_t type = 0; type < 4; ++type)
+    {
+        if ((desc.bindFlags & flags[type]) == 0)
+        {
+            continue;
+        }
+
+        *views[type] = m_device.CreateView(texture.texture, types[type]);
+        if (*views[type] == ViewHandle::Null)
+        {
+            std::cerr << "Failed to create pooled texture view\n";
+            for (ViewHandle* view : views)
+            {
+                m_device.Release(*view);
+            }
+            m_device.Release(texture.texture);
+            return PooledTexture{ };
+        }
+    }
+
+    ++m_statistics.textureCount;
+    ++m_statistics.inUseCount;
+    m_statistics.bytes += GetTextureMemory(desc);
+    bucket.push_back(entry);
+    return entry.texture;
+}
+
+void TexturePool::Release(const PooledTexture& texture)
+{
+    auto it = m_textures.find(GetKey(texture.desc));
+    if (it == m_textures.end())
+    {
+        return;
+    }
+
+    for (Entry& entry : it->second)
+    {
+        if (entry.inUse && entry.texture.texture == texture.texture)
+        {
+            entry.inUse = false;
+            entry.lastUsedFrame = m_frame;
+            --m_statistics.inUseCount;
+            return;
+        }
+    }
+}
+
+void TexturePool::EndFrame()
+{
+    ++m_frame;
+    const size_t count = m_statistics.textureCount;
+    DestroyIf([this](const Entry& entry) { return !entry.inUse && m_frame - entry.lastUsedFrame >= m_maxUnusedFrames; });
+    m_statistics.evictions += count - m_statistics.textureCount;
+}
+
+void TexturePool::Trim()
+{
+    DestroyIf([](const Entry& entry) { return !entry.inUse; });
+}
+
+void TexturePool::ResetStatistics() noexcept
+{
+    m_statistics.hits = 0;
+    m_statistics.misses = 0;
+    m_statistics.evictions = 0;
+}
+
+uint64_t TexturePool::GetKey(const TextureDesc& desc) noexcept
+{
+    const uint64_t size = (static_cast<uint64_t>(desc.width) << 32) | desc.height;
+    const uint64_t format = (static_cast<uint64_t>(desc.format) << 32) | desc.bindFlags;
+    return HashCombine(HashCombine(HASH_SEED, size), format);
+}
+
+void TexturePool::Destroy(std::vector<Entry>& bucket, size_t index)
+{
+    const PooledTexture& texture = bucket[index].texture;
+    m_device.Release(texture.renderTarget);
+    m_device.Release(texture.depthStencil);
+    m_device.Release(texture.shaderResource);
+    m_device.Release(texture.unorderedAccess);
+    m_device.Release(texture.texture);
+
+    --m_statistics.textureCount;
+    m_statistics.inUseCount -= bucket[index].inUse ? 1 : 0;
+    m_statistics.bytes -= GetTextureMemory(texture.desc);
+
+    bucket[index] = bucket.back();
+    bucket.pop_back();
+}
+
+template <typename Predicate>
+void TexturePool::DestroyIf(const Predicate& predicate)
+{
+    for (auto it = m_textures.begin(); it != m_textures.end();)
+    {
+        std::vector<Entry>& bucket = it->second;
+        for (size_t i = bucket.size(); i-- > 0;)
+        {
+            if (predicate(bucket[i]))
+            {
+                Destroy(bucket, i);
+            }
+        }
+
+        it = bucket.empty() ? m_textures.erase(it) : std::next(it);
+    }
+}
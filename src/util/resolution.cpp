@@ -0,0 +1,110 @@
+#include "util/resolution.h"
+
+#include <algorithm>
+#include <cmath>
+
+Resolution ComputeScaledResolution(const Resolution& outputResolution, float scale) noexcept
+{
+    auto scaleDimension = [scale](uint32_t size) -> uint32_t
+    {
+        uint32_t scaled = static_cast<uint32_t>(static_cast<float>(size) * scale);
+        // keep the size even so that downsampling by a factor of 2 does not drop the last row / column
+        scaled &= ~1u;
+        return std::clamp(scaled, 2u, std::max(size, 2u));
+    };
+
+    return Resolution{ scaleDimension(outputResolution.width), scaleDimension(outputResolution.height) };
+}
+
+DynamicResolutionController::DynamicResolutionController() noexcept
+    : DynamicResolutionController(Settings())
+{
+}
+
+DynamicResolutionController::DynamicResolutionController(const Settings& settings) noexcept
+    : m_settings(settings)
+{
+    m_settings.minScale = std::clamp(m_settings.minScale, 0.01f, 1.f);
+    m_settings.maxScale = std::clamp(m_settings.maxScale, m_settings.minScale, 1.f);
+    m_settings.smoothing = std::clamp(m_settings.smoothing, 0.01f, 1.f);
+
+    Reset();
+}
+
+void DynamicResolutionController::Reset() noexcept
+{
+    m_scale = m_settings.maxScale;
+    m_smoothedFrameTime = 0.f;
+    m_framesSinceChange = 0;
+    m_hasHistory = false;
+}
+
+float DynamicResolutionController::Update(float frameTimeMilliseconds) noexcept
+{
+    // ignore invalid measurements (e.g., the first frame or a timer hiccup)
+    if (!(frameTimeMilliseconds > 0.f) || !std::isfinite(frameTimeMilliseconds))
+    {
+        return m_scale;
+    }
+
+    if (m_hasHistory)
+    {
+        m_smoothedFrameTime += m_settings.smoothing * (frameTimeMilliseconds - m_smoothedFrameTime);
+    }
+    else
+    {
+        m_smoothedFrameTime = frameTimeMilliseconds;
+        m_hasHistory = true;
+    }
+
+    if (++m_framesSinceChange < m_settings.cooldownFrames)
+    {
+        return m_scale;
+    }
+
+    const float target = m_settings.targetFrameTimeMilliseconds;
+    const bool overBudget = m_smoothedFrameTime > target;
+    const bool underBudget = m_smoothedFrameTime < (1.f - m_settings.headroom) * target;
+    if (!overBudget && !underBudget)
+    {
+        return m_scale;
+    }
+
+    // the cost of the scene and bloom passes is roughly proportional to the pixel count, i.e., scale^2
+    // (an increase aims below the headroom, not at the budget, otherwise frames right at the budget would go back and forth
+    // between two steps)
+    const float scaleTarget = overBudget ? target : (1.f - m_settings.headroom) * target;
+    float newScale = m_scale * std::sqrt(scaleTarget / m_smoothedFrameTime);
+    if (overBudget)
+    {
+        // always go down by at least one step if we are over budget
+        newScale = std::min(newScale, m_scale - m_settings.scaleStep);
+    }
+    // quantize both cases the same way, otherwise a step down and a later unchanged quantized scale can differ by a rounding
+    // error and count as a change
+    newScale = std::clamp(QuantizeScale(newScale), m_settings.minScale, m_settings.maxScale);
+
+    if (newScale != m_scale)
+    {
+        // predict the frame time at the new scale so that the moving average does not have to catch up first
+        float ratio = newScale / m_scale;
+        m_smoothedFrameTime *= ratio * ratio;
+
+        m_scale = newScale;
+        m_framesSinceChange = 0;
+    }
+
+    return m_scale;
+}
+
+float DynamicResolutionController::QuantizeScale(float scale) const noexcept
+{
+    if (m_settings.scaleStep <= 0.f)
+    {
+        return scale;
+    }
+
+    // round down so that we do not overshoot the budget when increasing the resolution
+    // (the small epsilon avoids dropping a step because of floating point error)
+    return std::floor(scale / m_settings.scaleStep + 1e-4f) * m_settings.scaleStep;
+}
\ No newline at end of file
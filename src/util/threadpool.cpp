@@ -0,0 +1,119 @@
+#include "util/threadpool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+
+ThreadPool::ThreadPool(size_t threadCount)
+    : m_shutdown(false)
+{
+    if (threadCount == 0)
+    {
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    // the thread calling ParallelFor() participates, so we need one worker less
+    for (size_t i = 1; i < threadCount; ++i)
+    {
+        m_workers.emplace_back(&ThreadPool::WorkerLoop, this);
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_shutdown = true;
+    }
+    m_taskAvailable.notify_all();
+
+    for (std::thread& worker : m_workers)
+    {
+        worker.join();
+    }
+}
+
+void ThreadPool::Submit(std::function<void()> task)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_tasks.push_back(std::move(task));
+    }
+    m_taskAvailable.notify_one();
+}
+
+void ThreadPool::ParallelFor(size_t begin, size_t end, size_t grainSize, const std::function<void(size_t, size_t)>& func)
+{
+    if (begin >= end)
+    {
+        return;
+    }
+
+    grainSize = std::max<size_t>(grainSize, 1);
+    const size_t chunkCount = (end - begin + grainSize - 1) / grainSize;
+    if (chunkCount == 1 || m_workers.empty())
+    {
+        func(begin, end);
+        return;
+    }
+
+    // shared between the calling thread and the helper tasks, which may still be queued after all chunks are done
+    struct SharedState
+    {
+        std::atomic<size_t> nextChunk{ 0 };
+        std::atomic<size_t> finishedChunks{ 0 };
+        std::mutex mutex;
+        std::condition_variable done;
+    };
+    auto state = std::make_shared<SharedState>();
+
+    auto processChunks = [state, begin, end, grainSize, chunkCount, &func]()
+    {
+        size_t chunk;
+        while ((chunk = state->nextChunk.fetch_add(1)) < chunkCount)
+        {
+            size_t chunkBegin = begin + chunk * grainSize;
+            func(chunkBegin, std::min(chunkBegin + grainSize, end));
+
+            if (state->finishedChunks.fetch_add(1) + 1 == chunkCount)
+            {
+                std::lock_guard<std::mutex> lock(state->mutex);
+                state->done.notify_all();
+            }
+        }
+    };
+
+    // note: func is only accessed while chunks are left, i.e., before this function returns
+    size_t helperCount = std::min(m_workers.size(), chunkCount - 1);
+    for (size_t i = 0; i < helperCount; ++i)
+    {
+        Submit(processChunks);
+    }
+
+    processChunks();
+
+    std::unique_lock<std::mutex> lock(state->mutex);
+    state->done.wait(lock, [&state, chunkCount]() { return state->finishedChunks.load() == chunkCount; });
+}
+
+void ThreadPool::WorkerLoop()
+{
+    while (true)
+    {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_taskAvailable.wait(lock, [this]() { return m_shutdown || !m_tasks.empty(); });
+
+            if (m_shutdown && m_tasks.empty())
+            {
+                return;
+            }
+
+            task = std::move(m_tasks.front());
+            m_tasks.pop_front();
+        }
+
+        task();
+    }
+}